@@ -414,6 +414,9 @@ extern "C"
 
 #define RTK_BT_API_MEM_PRE_ALLOC            1
 
+/* commands of rtk_bt_send_cmd_async not completed or not polled, kept below API_TASK_IO_MSG_QUEUE_SIZE */
+#define BT_API_ASYNC_CMD_NUM                16
+
 #if defined(RTK_BT_API_MEM_PRE_ALLOC) && RTK_BT_API_MEM_PRE_ALLOC
 #define BT_API_SEM_POOL_SIZE                8
 #define BT_EVT_SMALL_POOL_SIZE              32
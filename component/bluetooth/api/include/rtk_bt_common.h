@@ -22,6 +22,8 @@ extern "C"
 #define RTK_BT_API_BR_BASE          0x80
 #define RTK_BT_API_COMMON_BASE      0xE0
 #define RTK_BT_API_TASK_EXIT        0xFF
+#define RTK_BT_API_TASK_ISO_DATA    0xFD
+#define RTK_BT_API_TASK_GATTS_NTF   0xFC
 #define RTK_BT_EVENT_TASK_EXIT      0xFF
 #define RTK_BT_DRC_EVENT_TASK_EXIT  0xFE
 
@@ -1180,6 +1182,33 @@ typedef enum {
  */
 typedef rtk_bt_evt_cb_ret_t (*rtk_bt_evt_cb_t)(uint8_t evt_code, void *data, uint32_t data_len);
 
+/**
+ * @typedef   rtk_bt_cmd_async_cb_t
+ * @brief     Completion callback of a command sent by @ref rtk_bt_send_cmd_async. It is called
+ *            in the BT API task, it shall not block and shall not call the BT APIs which wait for
+ *            the BT API task, @ref rtk_bt_send_cmd_async may be called.
+ * @note      Commands still pending in the stack when BT is disabled complete with
+ *            RTK_BT_ERR_UNHANDLED from the task calling @ref rtk_bt_disable, after the BT API task
+ *            has exited. The callback then runs in that task, and commands it sends fail with
+ *            RTK_BT_ERR_NOT_READY.
+ * @param[in] ticket: Ticket of the command
+ * @param[in] ret: Result of the command, what the blocking API would return
+ * @param[in] user_data: User data given with the command
+ */
+typedef void (*rtk_bt_cmd_async_cb_t)(uint32_t ticket, uint16_t ret, void *user_data);
+
+/**
+ * @struct    rtk_bt_cmd_async_result_t
+ * @brief     Completion of a command sent by @ref rtk_bt_send_cmd_async without callback.
+ */
+typedef struct {
+	uint32_t ticket;                    /*!< Ticket of the command */
+	uint8_t group;                      /*!< API cmd group */
+	uint8_t act;                        /*!< API cmd act */
+	uint16_t ret;                       /*!< Result of the command */
+	void *user_data;                    /*!< User data given with the command */
+} rtk_bt_cmd_async_result_t;
+
 
 /************************** Data structures for API internal use ***********************/
 typedef struct {
@@ -1263,6 +1292,42 @@ uint16_t rtk_bt_evt_register_callback(uint8_t group, rtk_bt_evt_cb_t cb);
  */
 uint16_t rtk_bt_evt_unregister_callback(uint8_t group);
 
+/**
+ * @brief     Send an API command to the BT API task without waiting for it. The command is
+ *            handled as by the blocking API of the group and act, and its completion is given to
+ *            the callback, or queued for @ref rtk_bt_cmd_async_poll if there is no callback.
+ *            At most @ref BT_API_ASYNC_CMD_NUM commands are sent and not completed, or completed
+ *            and not polled, at the same time.
+ * @note      The param is copied, the buffers it points to shall stay valid until completion and
+ *            the results written through them are valid after it. The completion may come before
+ *            this function returns.
+ * @param[in] group: API cmd group, e.g. RTK_BT_LE_GP_GAP
+ * @param[in] act: API cmd act of the group
+ * @param[in] param: Parameter of the act
+ * @param[in] param_len: Length of param
+ * @param[in] cb: Completion callback, NULL to queue the completion
+ * @param[in] user_data: User data given back with the completion
+ * @param[out] p_ticket: Ticket of the command, not 0, may be NULL
+ * @return
+ *            - 0  : Succeed
+ *            - RTK_BT_ERR_QUEUE_FULL: Too many commands not completed or not polled
+ *            - others: Error code
+ */
+uint16_t rtk_bt_send_cmd_async(uint8_t group, uint8_t act, void *param, uint32_t param_len,
+							   rtk_bt_cmd_async_cb_t cb, void *user_data, uint32_t *p_ticket);
+
+/**
+ * @brief     Get the completion of a command sent by @ref rtk_bt_send_cmd_async without callback,
+ *            in the order of completion.
+ * @param[out] p_result: Completion
+ * @param[in] timeout: Milliseconds to wait, BT_TIMEOUT_NONE or BT_TIMEOUT_FOREVER
+ * @return
+ *            - 0  : Succeed
+ *            - RTK_BT_ERR_SYNC_TIMEOUT: No completion within timeout
+ *            - others: Error code
+ */
+uint16_t rtk_bt_cmd_async_poll(rtk_bt_cmd_async_result_t *p_result, uint32_t timeout);
+
 /**
  * @}
  */
@@ -1280,8 +1345,16 @@ void bt_evt_mem_pool_deinit(void);
 
 uint16_t rtk_bt_send_cmd(uint8_t group, uint8_t act, void *param, uint32_t param_len);
 
+void rtk_bt_cmd_complete(rtk_bt_cmd_t *pcmd);
+
 void bt_wait_cmd_send_complete(void);
 
+uint16_t bt_api_async_init(void);
+
+void bt_api_async_deinit(void);
+
+uint32_t bt_api_async_send_num(void);
+
 uint16_t rtk_bt_evt_init(void);
 
 uint16_t rtk_bt_evt_deinit(void);
@@ -0,0 +1,116 @@
+/**
+ * @file      rtk_bt_gatts_ntf_chan.h
+ * @author
+ * @brief     Bluetooth GATT server notification channel definition
+ * @copyright Copyright (c) 2024. Realtek Semiconductor Corporation. All rights reserved.
+ */
+
+#ifndef __RTK_BT_GATTS_NTF_CHAN_H__
+#define __RTK_BT_GATTS_NTF_CHAN_H__
+
+#include <rtk_bt_def.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Number of connections which can have a notification channel open at the same time. */
+#define RTK_BT_GATTS_NTF_CHAN_NUM               4
+
+/**
+ * @struct    rtk_bt_gatts_ntf_chan_stats_t
+ * @brief     Statistics of a channel opened with @ref rtk_bt_gatts_ntf_chan_open.
+ */
+typedef struct {
+	uint32_t commit_num;                /*!< Calls of @ref rtk_bt_gatts_ntf_chan_commit which queued notifications. */
+	uint32_t queued_num;                /*!< Notifications committed. */
+	uint32_t sent_num;                  /*!< Notifications handed to the lower stack. */
+	uint32_t complete_num;              /*!< Notifications the lower stack reported as sent. */
+	uint32_t fail_num;                  /*!< Notifications dropped because the lower stack refused them or the link is gone. */
+	uint32_t sent_bytes;                /*!< Bytes of value handed to the lower stack. */
+	uint32_t queue_full_num;            /*!< Reservations refused because the ring was full. */
+	uint32_t credit_stall_num;          /*!< Times the ring waited for the lower stack to give back credits. */
+	uint16_t queue_bytes;               /*!< Bytes of the ring in use now, including notifications not yet completed. */
+	uint16_t queue_bytes_max;           /*!< Most bytes of the ring in use at the same time. */
+} rtk_bt_gatts_ntf_chan_stats_t;
+
+/**
+ * @defgroup  bt_gatts_ntf_chan BT GATT Server Notification Channel APIs
+ * @brief     Notifications written in place into a ring per connection and sent by the BT API
+ *            task as credits allow, without a BT API command or a complete event per notification.
+ *            Only one task may reserve and commit on a channel.
+ * @ingroup   BT_APIs
+ * @{
+ */
+
+/**
+ * @brief     Open a notification channel on a connection.
+ * @param[in] conn_handle: Connection handle.
+ * @param[in] cid: L2CAP channel of the notifications, 0 for the ATT fixed channel.
+ * @param[in] ring_size: Bytes of the ring, rounded up to a power of two. Each notification uses
+ *            8 bytes plus its value, rounded up to 8 bytes.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_gatts_ntf_chan_open(uint16_t conn_handle, uint16_t cid, uint16_t ring_size);
+
+/**
+ * @brief     Close a notification channel, the notifications not yet sent are dropped.
+ *            It waits for a reserve or commit in flight in another task, but the values returned
+ *            by @ref rtk_bt_gatts_ntf_chan_reserve and not yet committed are freed with the ring,
+ *            so close from the producing task or after it stopped writing to them.
+ * @param[in] conn_handle: Connection handle.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_gatts_ntf_chan_close(uint16_t conn_handle);
+
+/**
+ * @brief     Reserve space for one notification in the ring of a channel. The value is written
+ *            through the returned pointer and sent after @ref rtk_bt_gatts_ntf_chan_commit.
+ *            Several notifications can be reserved before one commit.
+ * @param[in]  conn_handle: Connection handle.
+ * @param[in]  app_id: Service app ID.
+ * @param[in]  index: Attribute index in the service.
+ * @param[in]  len: Length of the value, at most ATT MTU - 3.
+ * @param[out] pp_value: Where the value is written, valid until the commit or the close.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - RTK_BT_ERR_QUEUE_FULL: The ring is full, commit or try again later.
+ *            - RTK_BT_ERR_NO_CONNECTION: The link of the channel is disconnected.
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_gatts_ntf_chan_reserve(uint16_t conn_handle, uint16_t app_id, uint16_t index, uint16_t len, uint8_t **pp_value);
+
+/**
+ * @brief     Queue all the notifications reserved since the last commit.
+ * @param[in] conn_handle: Connection handle.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_gatts_ntf_chan_commit(uint16_t conn_handle);
+
+/**
+ * @brief     Read the statistics of a channel.
+ * @param[in]  conn_handle: Connection handle.
+ * @param[out] p_stats: Statistics of the channel.
+ * @param[in]  reset: Clear the counters after reading them.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_gatts_ntf_chan_stats_get(uint16_t conn_handle, rtk_bt_gatts_ntf_chan_stats_t *p_stats, bool reset);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTK_BT_GATTS_NTF_CHAN_H__ */
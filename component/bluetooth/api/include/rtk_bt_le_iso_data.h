@@ -0,0 +1,169 @@
+/**
+ * @file      rtk_bt_le_iso_data.h
+ * @author
+ * @brief     Bluetooth LE ISO direct data path definition
+ * @copyright Copyright (c) 2024. Realtek Semiconductor Corporation. All rights reserved.
+ */
+
+#ifndef __RTK_BT_LE_ISO_DATA_H__
+#define __RTK_BT_LE_ISO_DATA_H__
+
+#include <rtk_bt_def.h>
+#include <bt_api_config.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if (defined(RTK_BLE_ISO_SUPPORT) && RTK_BLE_ISO_SUPPORT) || (defined(RTK_BLE_AUDIO_SUPPORT) && RTK_BLE_AUDIO_SUPPORT)
+
+/* Number of CIS/BIS streams which can be opened on the direct data path at the same time. */
+#define RTK_BT_LE_ISO_DATA_STREAM_NUM           8
+
+/* An SDU arriving later than 1.5 SDU intervals after the previous one is counted as late. */
+#define RTK_BT_LE_ISO_DATA_LATE_NUM             3
+#define RTK_BT_LE_ISO_DATA_LATE_DEN             2
+
+/**
+ * @struct    rtk_bt_le_iso_data_rx_t
+ * @brief     ISO SDU lent by the stack to @ref rtk_bt_le_iso_data_rx_cb_t.
+ */
+typedef struct {
+	uint16_t iso_conn_handle;       /*!< Connection handle of the CIS or BIS. */
+	uint8_t pkt_status_flag;        /*!< 0: valid data, 1: possibly invalid data, 2: lost data. */
+	bool ts_flag;                   /*!< Whether time_stamp is valid. */
+	uint32_t time_stamp;            /*!< A time in microseconds, valid when ts_flag is true. */
+	uint16_t pkt_seq_num;           /*!< Sequence number of the SDU. */
+	uint16_t iso_sdu_len;           /*!< Length of the SDU. */
+	uint8_t *p_sdu;                 /*!< Start of the SDU inside the stack buffer. */
+	uint8_t *p_buf;                 /*!< Stack buffer to give back with @ref rtk_bt_le_iso_data_release. */
+} rtk_bt_le_iso_data_rx_t;
+
+/**
+ * @typedef   rtk_bt_le_iso_data_rx_cb_t
+ * @brief     Called in the stack context for every received SDU.
+ *            Return true to keep p_rx->p_buf until @ref rtk_bt_le_iso_data_release is called,
+ *            false to let the stack release it as soon as the callback returns.
+ *            The controller stops delivering SDUs while all of its receive buffers are held.
+ */
+typedef bool (*rtk_bt_le_iso_data_rx_cb_t)(rtk_bt_le_iso_data_rx_t *p_rx);
+
+/**
+ * @struct    rtk_bt_le_iso_data_timing_t
+ * @brief     Timing of the SDUs of one direction of a stream, measured by the host when an SDU
+ *            is received from the controller or queued by the application.
+ */
+typedef struct {
+	uint32_t sdu_num;               /*!< SDUs counted. */
+	uint32_t late_num;              /*!< SDUs which came more than 1.5 SDU intervals after the previous one. */
+	uint32_t interval_min_us;       /*!< Shortest time between two SDUs. */
+	uint32_t interval_max_us;       /*!< Longest time between two SDUs. */
+	uint32_t jitter_max_us;         /*!< Largest distance of a time between two SDUs from the SDU interval. */
+} rtk_bt_le_iso_data_timing_t;
+
+/**
+ * @struct    rtk_bt_le_iso_data_stats_t
+ * @brief     Statistics of a stream opened with @ref rtk_bt_le_iso_data_stream_open.
+ */
+typedef struct {
+	rtk_bt_le_iso_data_timing_t rx;     /*!< Received SDUs. */
+	uint32_t rx_error_num;              /*!< SDUs reported as possibly invalid data. */
+	uint32_t rx_lost_num;               /*!< SDUs reported as lost data. */
+	uint32_t rx_seq_gap_num;            /*!< SDUs missing from the sequence numbers received. */
+	rtk_bt_le_iso_data_timing_t tx;     /*!< SDUs queued by @ref rtk_bt_le_iso_data_enqueue or sent by the data send API. */
+	uint32_t tx_sent_num;               /*!< SDUs handed to the controller. */
+	uint32_t tx_fail_num;               /*!< SDUs dropped because the lower stack refused them. */
+	uint32_t tx_queue_full_num;         /*!< SDUs refused because the queue was full. */
+	uint32_t tx_credit_stall_num;       /*!< Times the queue waited for controller buffers. */
+	uint16_t tx_queue_depth;            /*!< SDUs in the queue now. */
+	uint16_t tx_queue_depth_max;        /*!< Most SDUs in the queue at the same time. */
+} rtk_bt_le_iso_data_stats_t;
+
+/**
+ * @defgroup  bt_le_iso_data BT LE ISO Direct Data APIs
+ * @brief     Zero copy receive and queued send of ISO SDUs, bypassing the BT API task
+ *            and the event task for each SDU.
+ * @ingroup   BT_APIs
+ * @{
+ */
+
+/**
+ * @brief     Open a stream on the direct data path for a CIS or BIS once its data path is set up.
+ * @param[in] iso_conn_handle: Connection handle of the CIS or BIS.
+ * @param[in] sdu_interval_us: SDU interval of the stream, used for the jitter and late statistics.
+ * @param[in] max_sdu: Largest SDU which will be queued for sending.
+ * @param[in] tx_depth: SDUs the send queue holds, 0 for a receive only stream.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_le_iso_data_stream_open(uint16_t iso_conn_handle, uint32_t sdu_interval_us, uint16_t max_sdu, uint8_t tx_depth);
+
+/**
+ * @brief     Close a stream, the SDUs still in the send queue are dropped.
+ * @param[in] iso_conn_handle: Connection handle of the CIS or BIS.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_le_iso_data_stream_close(uint16_t iso_conn_handle);
+
+/**
+ * @brief     Register the callback which receives the SDUs of all streams instead of
+ *            RTK_BT_LE_ISO_EVT_DATA_RECEIVE_IND or RTK_BT_LE_AUDIO_EVT_ISO_DATA_RECEIVE_IND.
+ * @param[in] callback: Receive callback, NULL to go back to the events.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_le_iso_data_rx_register(rtk_bt_le_iso_data_rx_cb_t callback);
+
+/**
+ * @brief     Give back a buffer kept by @ref rtk_bt_le_iso_data_rx_cb_t.
+ * @param[in] p_buf: rtk_bt_le_iso_data_rx_t::p_buf of the SDU.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_le_iso_data_release(uint8_t *p_buf);
+
+/**
+ * @brief     Copy an SDU into the send queue of a stream, it is sent when the controller has buffers.
+ *            Only one task may queue SDUs on a stream.
+ * @param[in] iso_conn_handle: Connection handle of the CIS or BIS.
+ * @param[in] p_data: SDU to send.
+ * @param[in] data_len: Length of the SDU, at most the max_sdu of the stream.
+ * @param[in] ts_flag: Whether time_stamp is valid.
+ * @param[in] time_stamp: A time in microseconds.
+ * @param[in] pkt_seq_num: Sequence number of the SDU.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - RTK_BT_ERR_QUEUE_FULL: The queue is full, the SDU is not sent.
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_le_iso_data_enqueue(uint16_t iso_conn_handle, uint8_t *p_data, uint16_t data_len,
+									bool ts_flag, uint32_t time_stamp, uint16_t pkt_seq_num);
+
+/**
+ * @brief     Read the statistics of a stream.
+ * @param[in]  iso_conn_handle: Connection handle of the CIS or BIS.
+ * @param[out] p_stats: Statistics of the stream.
+ * @param[in]  reset: Clear the counters after reading them.
+ * @return
+ *            - RTK_BT_OK  : Succeed
+ *            - Others: Failed
+ */
+uint16_t rtk_bt_le_iso_data_stats_get(uint16_t iso_conn_handle, rtk_bt_le_iso_data_stats_t *p_stats, bool reset);
+
+/**
+ * @}
+ */
+
+#endif /* RTK_BLE_ISO_SUPPORT || RTK_BLE_AUDIO_SUPPORT */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTK_BT_LE_ISO_DATA_H__ */
@@ -0,0 +1,210 @@
+/*
+*******************************************************************************
+* Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+*/
+
+#include "platform_autoconf.h"
+#include <string.h>
+#include <stdio.h>
+#include <osif.h>
+#include <bt_api_config.h>
+#include <rtk_bt_def.h>
+#include <rtk_bt_common.h>
+#include <rtk_bt_device.h>
+
+/*
+ * API commands sent without waiting for the BT API task. The command and a copy of its param are
+ * allocated together and handed to the BT API task like a blocking one, with no semaphore. The
+ * stack completes both kinds with rtk_bt_cmd_complete, which gives the semaphore of a blocking
+ * command, and runs the callback or queues the result of an asynchronous one before freeing it.
+ */
+
+typedef struct {
+	rtk_bt_cmd_t cmd;                   /* first, the BT API task only knows the command */
+	uint32_t ticket;
+	rtk_bt_cmd_async_cb_t cb;
+	void *user_data;
+} bt_api_async_cmd_t;
+
+/* param copy after the command, aligned for any param structure */
+#define BT_API_ASYNC_PARAM_OFFSET       ((sizeof(bt_api_async_cmd_t) + 7) & ~(uint32_t)7)
+
+extern uint16_t bt_stack_api_send(void *pcmd);
+
+static void *async_done_q = NULL;
+static uint32_t async_ticket = 0;
+/* commands sent and not completed, or completed and not polled, bounds the queue of results */
+static uint32_t async_cmd_num = 0;
+/* calls of rtk_bt_send_cmd_async not returned yet, waited for by bt_wait_cmd_send_complete */
+static uint32_t async_send_num = 0;
+
+uint16_t bt_api_async_init(void)
+{
+	if (async_done_q) {
+		return RTK_BT_ERR_ALREADY_DONE;
+	}
+
+	if (false == osif_msg_queue_create(&async_done_q, BT_API_ASYNC_CMD_NUM, sizeof(rtk_bt_cmd_async_result_t))) {
+		return RTK_BT_ERR_OS_OPERATION;
+	}
+	async_cmd_num = 0;
+
+	return RTK_BT_OK;
+}
+
+void bt_api_async_deinit(void)
+{
+	rtk_bt_cmd_async_result_t result;
+
+	if (!async_done_q) {
+		return;
+	}
+
+	/* the pending commands were completed by the stack deinit, drop the results not polled */
+	while (osif_msg_recv(async_done_q, &result, BT_TIMEOUT_NONE));
+	osif_msg_queue_delete(async_done_q);
+	async_done_q = NULL;
+	async_cmd_num = 0;
+}
+
+uint32_t bt_api_async_send_num(void)
+{
+	return async_send_num;
+}
+
+static void bt_api_async_cmd_release(void)
+{
+	uint32_t flags = osif_lock();
+	async_cmd_num--;
+	osif_unlock(flags);
+}
+
+uint16_t rtk_bt_send_cmd_async(uint8_t group, uint8_t act, void *param, uint32_t param_len,
+							   rtk_bt_cmd_async_cb_t cb, void *user_data, uint32_t *p_ticket)
+{
+	uint16_t ret = RTK_BT_OK;
+	uint32_t flags = 0;
+	uint32_t ticket = 0;
+	bool reserved = false;
+	bt_api_async_cmd_t *pasync = NULL;
+
+	if (param_len && !param) {
+		return RTK_BT_ERR_POINTER_INVALID;
+	}
+
+	flags = osif_lock();
+	async_send_num++;
+	if (async_cmd_num < BT_API_ASYNC_CMD_NUM) {
+		async_cmd_num++;
+		reserved = true;
+	}
+	osif_unlock(flags);
+
+	/* check if bt deinit started */
+	if (!rtk_bt_is_enable() || !async_done_q) {
+		ret = RTK_BT_ERR_NOT_READY;
+		goto end;
+	}
+
+	if (!reserved) {
+		ret = RTK_BT_ERR_QUEUE_FULL;
+		goto end;
+	}
+
+	pasync = (bt_api_async_cmd_t *)osif_mem_alloc(RAM_TYPE_DATA_ON, BT_API_ASYNC_PARAM_OFFSET + param_len);
+	if (!pasync) {
+		ret = RTK_BT_ERR_NO_MEMORY;
+		goto end;
+	}
+	memset(pasync, 0, sizeof(bt_api_async_cmd_t));
+	pasync->cmd.group = group;
+	pasync->cmd.act = act;
+	pasync->cmd.param_len = param_len;
+	if (param_len) {
+		pasync->cmd.param = (uint8_t *)pasync + BT_API_ASYNC_PARAM_OFFSET;
+		memcpy(pasync->cmd.param, param, param_len);
+	}
+	pasync->cb = cb;
+	pasync->user_data = user_data;
+
+	flags = osif_lock();
+	if (++async_ticket == 0) {
+		async_ticket = 1;
+	}
+	ticket = async_ticket;
+	osif_unlock(flags);
+	pasync->ticket = ticket;
+
+	if (bt_stack_api_send(&pasync->cmd)) {
+		osif_mem_free(pasync);
+		ret = RTK_BT_ERR_MSG_SEND;
+		goto end;
+	}
+
+	if (p_ticket) {
+		*p_ticket = ticket;
+	}
+
+end:
+	flags = osif_lock();
+	async_send_num--;
+	if (ret && reserved) {
+		async_cmd_num--;
+	}
+	osif_unlock(flags);
+
+	return ret;
+}
+
+uint16_t rtk_bt_cmd_async_poll(rtk_bt_cmd_async_result_t *p_result, uint32_t timeout)
+{
+	if (!p_result) {
+		return RTK_BT_ERR_POINTER_INVALID;
+	}
+
+	if (!async_done_q) {
+		return RTK_BT_ERR_NOT_READY;
+	}
+
+	if (false == osif_msg_recv(async_done_q, p_result, timeout)) {
+		return RTK_BT_ERR_SYNC_TIMEOUT;
+	}
+	bt_api_async_cmd_release();
+
+	return RTK_BT_OK;
+}
+
+void rtk_bt_cmd_complete(rtk_bt_cmd_t *pcmd)
+{
+	bt_api_async_cmd_t *pasync = (bt_api_async_cmd_t *)pcmd;
+	rtk_bt_cmd_async_result_t result;
+	rtk_bt_cmd_async_cb_t cb;
+
+	/* a blocking command, its caller reads pcmd->ret */
+	if (pcmd->psem) {
+		osif_sem_give(pcmd->psem);
+		return;
+	}
+
+	result.ticket = pasync->ticket;
+	result.group = pcmd->group;
+	result.act = pcmd->act;
+	result.ret = pcmd->ret;
+	result.user_data = pasync->user_data;
+	cb = pasync->cb;
+	osif_mem_free(pasync);
+
+	if (cb) {
+		/* released first, the callback may send the next command */
+		bt_api_async_cmd_release();
+		cb(result.ticket, result.ret, result.user_data);
+		return;
+	}
+
+	/* cannot be full, a result keeps its place in async_cmd_num until it is polled */
+	if (false == osif_msg_send(async_done_q, &result, BT_TIMEOUT_NONE)) {
+		BT_LOGE("%s: result of ticket %u lost\r\n", __func__, (unsigned int)result.ticket);
+		bt_api_async_cmd_release();
+	}
+}
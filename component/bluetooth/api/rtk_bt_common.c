@@ -427,7 +427,7 @@ void bt_wait_cmd_send_complete(void)
 {
 	int i = 0;
 
-	while (api_task_msg_num) {
+	while (api_task_msg_num || bt_api_async_send_num()) {
 		osif_delay(5);
 		i++;
 		if (200 == i) {
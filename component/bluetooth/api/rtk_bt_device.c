@@ -52,6 +52,11 @@ uint16_t rtk_bt_enable(rtk_bt_app_conf_t *app_default_conf)
 		goto evt_fail;
 	}
 
+	err = bt_api_async_init();
+	if (err) {
+		goto async_fail;
+	}
+
 #if defined(RTK_BLE_MESH_SUPPORT) && RTK_BLE_MESH_SUPPORT
 	if (app_default_conf->app_profile_support & RTK_BT_PROFILE_MESH) {
 		mesh_stack_is_init = true;
@@ -75,6 +80,8 @@ stack_fail:
 		mesh_stack_is_init = false;
 	}
 #endif
+	bt_api_async_deinit();
+async_fail:
 	rtk_bt_evt_deinit();
 evt_fail:
 #if defined(RTK_BT_API_MEM_PRE_ALLOC) && RTK_BT_API_MEM_PRE_ALLOC
@@ -110,6 +117,8 @@ uint16_t rtk_bt_disable(void)
 		return err;
 	}
 
+	bt_api_async_deinit();
+
 #if defined(RTK_BT_API_MEM_PRE_ALLOC) && RTK_BT_API_MEM_PRE_ALLOC
 	bt_api_sem_pool_deinit();
 	bt_evt_mem_pool_deinit();
@@ -61,7 +61,6 @@ static void *api_task_sem = NULL;
 static void *api_task_hdl = NULL;
 static void *api_task_io_msg_q = NULL;
 static void *api_task_evt_msg_q = NULL;
-static struct list_head g_cmd_pending_list;
 
 static uint16_t bt_stack_act_handler(rtk_bt_cmd_t *p_cmd);
 
@@ -86,6 +85,18 @@ static void bt_stack_api_taskentry(void *ctx)
 							if (io_msg.subtype == RTK_BT_API_TASK_EXIT) {
 								goto out;
 							}
+#if (defined(RTK_BLE_ISO_SUPPORT) && RTK_BLE_ISO_SUPPORT) || (defined(RTK_BLE_AUDIO_SUPPORT) && RTK_BLE_AUDIO_SUPPORT)
+							/* SDUs queued on the direct ISO data path */
+							if (io_msg.subtype == RTK_BT_API_TASK_ISO_DATA) {
+								bt_stack_le_iso_data_drain();
+								break;
+							}
+#endif
+							/* notifications committed on a GATT server notification channel */
+							if (io_msg.subtype == RTK_BT_API_TASK_GATTS_NTF) {
+								bt_stack_gatts_ntf_chan_drain();
+								break;
+							}
 							bt_stack_act_handler((rtk_bt_cmd_t *)io_msg.u.buf);
 							break;
 
@@ -1050,6 +1061,10 @@ uint16_t bt_stack_act_handler(rtk_bt_cmd_t *p_cmd)
 		break;
 	default:
 		BT_LOGE("bt_stack_le_act_handle:unknown group: %d \r\n", p_cmd->group);
+		/* no group handler completes it, an asynchronous command would never be freed */
+		ret = RTK_BT_ERR_NO_CASE_ELEMENT;
+		p_cmd->ret = ret;
+		rtk_bt_cmd_complete(p_cmd);
 		break;
 	}
 
@@ -1182,50 +1197,3 @@ uint16_t bt_stack_api_send(void *pcmd)
 {
 	return bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, 0, pcmd);
 }
-
-rtk_bt_cmd_t *bt_stack_pending_cmd_search(uint32_t msg_type)
-{
-	rtk_bt_cmd_t *cmd;
-
-	list_for_each_entry(cmd, &g_cmd_pending_list, list, rtk_bt_cmd_t) {
-		if (cmd->user_data == msg_type) {
-			return cmd;
-		}
-	}
-
-	return NULL;
-}
-
-void bt_stack_pending_cmd_insert(rtk_bt_cmd_t *p_cmd)
-{
-	BT_LOGD("insert cmd: msg_type = 0x%x\r\n", (unsigned int)p_cmd->user_data);
-	list_add_tail(&p_cmd->list, &g_cmd_pending_list);
-}
-
-void bt_stack_pending_cmd_delete(rtk_bt_cmd_t *p_cmd)
-{
-	rtk_bt_cmd_t *cmd, *next;
-	BT_LOGD("delete cmd: msg_type = 0x%x\r\n", (unsigned int)p_cmd->user_data);
-	list_for_each_entry_safe(cmd, next, &g_cmd_pending_list, list, rtk_bt_cmd_t) {
-		if (p_cmd == cmd) {
-			list_del(&p_cmd->list);
-		}
-	}
-}
-
-void bt_stack_pending_cmd_deinit(void)
-{
-	rtk_bt_cmd_t *cmd, *next;
-	BT_LOGD("delete cmd pending list\r\n");
-
-	list_for_each_entry_safe(cmd, next, &g_cmd_pending_list, list, rtk_bt_cmd_t) {
-		cmd->ret = RTK_BT_ERR_UNHANDLED;
-		osif_sem_give(cmd->psem);
-		list_del(&cmd->list);
-	}
-}
-
-void bt_stack_pending_cmd_init(void)
-{
-	INIT_LIST_HEAD(&g_cmd_pending_list);
-}
\ No newline at end of file
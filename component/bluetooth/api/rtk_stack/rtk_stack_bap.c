@@ -12,6 +12,7 @@
 #include <rtk_bt_common.h>
 #include <rtk_bt_device.h>
 #include <rtk_stack_le_audio_internal.h>
+#include <rtk_stack_internal.h>
 #include <rtk_stack_config.h>
 #include <rtk_bt_le_audio_def.h>
 #include <rtk_bt_bap.h>
@@ -1642,34 +1643,13 @@ uint16_t bt_stack_le_audio_data_send(void *data)
 
 	BT_DUMPD(__func__, param->p_data, param->data_len);
 
-#if 0
-	static bool is_odd = false;
-	static uint32_t last_even_time = 0, now_even_time = 0, last_odd_time = 0, now_odd_time = 0;
-	if (is_odd) {
-		now_odd_time = osif_sys_time_get();
-		if (last_odd_time != 0 && (now_odd_time - last_odd_time > 11 || now_odd_time - last_odd_time < 9)) {
-			BT_LOGE("%s gap_iso_send_data iso_conn_handle = 0x%x,pkt_seq_num %d,last_odd_time %d, now_odd_time %d,delta_time %d\r\n", __func__,
-					param->iso_conn_handle, param->pkt_seq_num, (int)last_odd_time, (int)now_odd_time, (int)(now_odd_time - last_odd_time));
-		}
-		last_odd_time = now_odd_time;
-		is_odd = false;
-	} else {
-		now_even_time = osif_sys_time_get();
-		if (last_even_time != 0 && (now_even_time - last_even_time > 11 || now_even_time - last_even_time < 9)) {
-			BT_LOGE("%s gap_iso_send_data iso_conn_handle = 0x%x,pkt_seq_num %d,last_even_time %d, now_even_time %d,delta_time %d\r\n", __func__,
-					param->iso_conn_handle, param->pkt_seq_num, (int)last_even_time, (int)now_even_time, (int)(now_even_time - last_even_time));
-		}
-		last_even_time = now_even_time;
-		is_odd = true;
-	}
-
-#endif
 	cause = gap_iso_send_data(param->p_data,
 							  param->iso_conn_handle,
 							  param->data_len,
 							  param->ts_flag,
 							  param->time_stamp,
 							  param->pkt_seq_num);
+	bt_stack_le_iso_data_tx_record(param->iso_conn_handle, (uint16_t)cause);
 	if (GAP_CAUSE_SUCCESS != cause) {
 		if (cause == GAP_CAUSE_ERROR_CREDITS) {
 			BT_LOGE("%s gap_iso_send_data warning (cause = 0x%x,iso_conn_handle = 0x%x)\r\n", __func__, cause, param->iso_conn_handle);
@@ -4063,7 +4043,7 @@ uint16_t bt_stack_bap_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -4084,6 +4064,10 @@ void bt_stack_le_audio_data_direct_callback(uint8_t cb_type, void *p_cb_data)
 			BT_DUMPD("", p_data->p_bt_direct_iso->p_buf + p_data->p_bt_direct_iso->offset, p_data->p_bt_direct_iso->iso_sdu_len);
 			BT_LOGD("%s pkt_seq_num=%d\r\n", __func__, p_data->p_bt_direct_iso->pkt_seq_num);
 		}
+		/* lent to the direct data callback when one is registered */
+		if (bt_stack_le_iso_data_rx_ind(p_data->p_bt_direct_iso)) {
+			break;
+		}
 		/* Send event */
 		p_evt = rtk_bt_event_create(RTK_BT_LE_GP_BAP,
 									RTK_BT_LE_AUDIO_EVT_ISO_DATA_RECEIVE_IND,
@@ -4225,6 +4209,7 @@ uint16_t bt_stack_bap_init(void *p_conf)
 			return RTK_BT_ERR_LOWER_STACK_API;
 		}
 	}
+	bt_stack_le_iso_data_init();
 	gap_register_direct_cb(bt_stack_le_audio_data_direct_callback);
 	stack_bap_init_flag = 1;
 
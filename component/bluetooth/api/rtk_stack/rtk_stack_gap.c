@@ -52,7 +52,7 @@ uint16_t app_ecfc_callback(void *p_buf, T_GAP_ECFC_MSG msg)
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = p_rsp->cause;
 				*param->p_proto_id = p_rsp->proto_id;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 		}
 		break;
@@ -67,7 +67,7 @@ uint16_t app_ecfc_callback(void *p_buf, T_GAP_ECFC_MSG msg)
 			if (param->psm == p_rsp->psm) {
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = p_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 		}
 		break;
@@ -99,7 +99,7 @@ uint16_t app_ecfc_callback(void *p_buf, T_GAP_ECFC_MSG msg)
 			if (param->proto_id == p_rsp->proto_id) {
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = p_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 		}
 		break;
@@ -147,7 +147,7 @@ uint16_t app_ecfc_callback(void *p_buf, T_GAP_ECFC_MSG msg)
 			if (param->conn_handle == p_rsp->conn_handle && param->cid == p_rsp->cid) {
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = p_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 		}
 		break;
@@ -174,7 +174,7 @@ uint16_t app_ecfc_callback(void *p_buf, T_GAP_ECFC_MSG msg)
 			if (param->conn_handle == p_rsp->conn_handle && param->cid == p_rsp->cid) {
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = p_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 		}
 		break;
@@ -394,11 +394,11 @@ uint16_t bt_stack_gap_act_handle(rtk_bt_cmd_t *p_cmd)
 			    should be deleted here */
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = ret;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 	} else {
 		p_cmd->ret = ret;
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	}
 
 	return ret;
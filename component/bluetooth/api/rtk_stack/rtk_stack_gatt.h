@@ -52,6 +52,7 @@ typedef struct {
 	uint8_t *data;
 	uint16_t cid;
 	uint8_t flag;
+	uint8_t tag;                        /* send order of a notification on its link, see bt_stack_gatts_send_value */
 } rtk_bt_gatts_req_t;
 
 /***************************** GATT Client related ***************************/
@@ -502,7 +502,7 @@ uint16_t bt_stack_gattc_act_handle(rtk_bt_cmd_t *p_cmd)
 
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -1893,7 +1893,7 @@ uint16_t bt_stack_gattc_act_handle(rtk_bt_cmd_t *p_cmd)
 
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -15,6 +15,7 @@
 #include <rtk_bt_gatts.h>
 #include <rtk_bt_common.h>
 #include <rtk_stack_gatt.h>
+#include <rtk_stack_internal.h>
 
 #include <gap.h>
 #include <gap_conn_le.h>
@@ -294,43 +295,66 @@ end:
 	return ret;
 }
 
-static uint16_t _send_data(bool notify, rtk_bt_gatts_req_t *req)
+/* notifications handed to the lower stack per link, the lower stack completes them in this order.
+ * Notifications on the air at the same time hold a credit each, so their tags differ by less than
+ * the credits and 8 bits tell which was sent first */
+static uint8_t bt_stack_gatts_ntf_tag[RTK_BLE_GAP_MAX_LINKS];
+
+/* hand a notification or indication to the lower stack, credits are checked by the caller,
+ * a notification sent gets the next tag of its link in p_tag */
+uint16_t bt_stack_gatts_send_value(uint16_t conn_handle, uint16_t cid, uint16_t app_id, uint16_t index,
+								   uint8_t *data, uint16_t len, bool notify, uint8_t *p_tag)
 {
 	T_GATT_PDU_TYPE type = notify ? GATT_PDU_TYPE_NOTIFICATION : GATT_PDU_TYPE_INDICATION;
-	uint16_t len = req->len;
 	struct rtk_bt_gatt_service *node = NULL;
 	uint8_t conn_id;
 	bool sent;
-	uint16_t credits = 0;
-
-	le_get_gap_param(GAP_PARAM_LE_REMAIN_CREDITS, &credits);
-	if (!credits) {
-		return RTK_BT_ERR_NO_CREDITS;
-	}
 
-	if (!le_get_conn_id_by_handle(req->conn_handle, &conn_id)) {
+	if (!le_get_conn_id_by_handle(conn_handle, &conn_id)) {
 		return RTK_BT_ERR_PARAM_INVALID;
 	}
 
-	node = bt_stack_gatts_find_service_node_by_app_id(req->app_id);
+	node = bt_stack_gatts_find_service_node_by_app_id(app_id);
 	if (!node) {
 		return RTK_BT_ERR_NO_ENTRY;
 	}
 
 #if defined(RTK_BLE_MGR_LIB) && RTK_BLE_MGR_LIB
+	(void)conn_id;
 	/* In EATT, if dynamic created L2CAP channel is used here, please make sure data_len <= L2CAP_MTU_of_this_channel - 3*/
-	sent = gatt_svc_send_data(req->conn_handle, req->cid, (T_SERVER_ID)node->server_info,
-							  req->index, (uint8_t *)req->data, len, type);
+	sent = gatt_svc_send_data(conn_handle, cid, (T_SERVER_ID)node->server_info,
+							  index, data, len, type);
 #else
-	sent = server_send_data(conn_id, node->server_info, req->index, (uint8_t *)req->data, len, type);
+	(void)cid;
+	sent = server_send_data(conn_id, node->server_info, index, data, len, type);
 #endif
 
-	if (sent) { /* send to stack OK */
+	if (!sent) {
+		return RTK_BT_ERR_LOWER_STACK_API;
+	}
+	if (notify && p_tag) {
+		*p_tag = bt_stack_gatts_ntf_tag[conn_id]++;
+	}
+
+	return RTK_BT_OK;
+}
+
+static uint16_t _send_data(bool notify, rtk_bt_gatts_req_t *req)
+{
+	uint16_t credits = 0;
+	uint16_t ret;
+
+	le_get_gap_param(GAP_PARAM_LE_REMAIN_CREDITS, &credits);
+	if (!credits) {
+		return RTK_BT_ERR_NO_CREDITS;
+	}
+
+	ret = bt_stack_gatts_send_value(req->conn_handle, req->cid, req->app_id, req->index, (uint8_t *)req->data, req->len, notify, &req->tag);
+	if (ret == RTK_BT_OK) { /* send to stack OK */
 		req->flag = REQ_FLAG_ALREADY_SENT;
-		return RTK_BT_OK;
 	}
 
-	return RTK_BT_ERR_LOWER_STACK_API;
+	return ret;
 }
 
 static void _handle_indicate_pending_queue(void)
@@ -383,6 +407,26 @@ static rtk_bt_gatts_req_t *bt_stack_gatts_remove_sent_req(bool notify, uint16_t
 
 	return NULL;
 }
+
+/* a notification channel and the BT API command may both have a notification with the same app_id
+ * and index on the air, the completion is for the one sent first on the link */
+static bool bt_stack_gatts_ntf_is_chan(uint8_t conn_id, uint16_t app_id, uint16_t index)
+{
+	rtk_bt_gatts_req_t *req;
+	uint8_t chan_tag;
+
+	if (!bt_stack_gatts_ntf_chan_oldest(conn_id, app_id, index, &chan_tag)) {
+		return false;
+	}
+	list_for_each_entry(req, &g_rtk_bt_gatts_priv->notify_queue[conn_id].pending_list, list, rtk_bt_gatts_req_t) {
+		if ((req->app_id == app_id) && (req->index == index)) {
+			return (int8_t)(chan_tag - req->tag) < 0;
+		}
+	}
+
+	return true;
+}
+
 #if defined(RTK_BLE_MGR_LIB) && RTK_BLE_MGR_LIB
 static void bt_stack_gatts_send_data_cb(T_EXT_SEND_DATA_RESULT result);
 #endif
@@ -489,14 +533,24 @@ static bool _send_data_complete_cb(T_SERVER_ID server_id, uint16_t index, uint8_
 		return false;
 	}
 
+	if (notify && bt_stack_gatts_ntf_is_chan(conn_id, p_srv_node->app_id, index)) {
+		return bt_stack_gatts_ntf_chan_sent(conn_id, p_srv_node->app_id, index, cause);
+	}
+
 	req = bt_stack_gatts_remove_sent_req(notify, conn_id, p_srv_node->app_id, index);
+	if (!req) {
+		return false;
+	}
 
-	if (!req || !_indicate_data_send_compelete(notify, cause, req)) {
+	if (!_indicate_data_send_compelete(notify, cause, req)) {
 		return false;
 	}
 
 	if (!notify) {
 		_handle_indicate_pending_queue();
+	} else {
+		/* the credit it gave back may be waited for by a notification channel */
+		bt_stack_gatts_ntf_chan_drain();
 	}
 
 	return true;
@@ -712,6 +766,7 @@ void bt_stack_gatts_queue_clear_all(rtk_bt_gatt_queue_t *p_queue)
 
 void bt_stack_gatts_disconnect_queue_clear(uint8_t conn_id)
 {
+	bt_stack_gatts_ntf_chan_disconnect(conn_id);
 	bt_stack_gatts_queue_clear_all(&g_rtk_bt_gatts_priv->notify_queue[conn_id]);
 	bt_stack_gatts_queue_clear_all(&g_rtk_bt_gatts_priv->indicate_queue[conn_id]);
 }
@@ -732,6 +787,7 @@ void bt_stack_gatts_deinit(void)
 		bt_stack_gatts_disconnect_queue_clear(i);
 	}
 
+	bt_stack_gatts_ntf_chan_deinit();
 	osif_mem_free(g_rtk_bt_gatts_priv);
 	g_rtk_bt_gatts_priv = NULL;
 }
@@ -1388,6 +1444,6 @@ uint16_t bt_stack_gatts_act_handle(rtk_bt_cmd_t *p_cmd)
 
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
\ No newline at end of file
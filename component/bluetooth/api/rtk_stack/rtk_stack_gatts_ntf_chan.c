@@ -0,0 +1,518 @@
+/*
+ *******************************************************************************
+ * Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ */
+#include <string.h>
+#include <stdio.h>
+#include <osif.h>
+#include <bt_api_config.h>
+#include <app_msg.h>
+#include <gap_le.h>
+#include <bt_types.h>
+#include <rtk_bt_common.h>
+#include <rtk_bt_gatts_ntf_chan.h>
+#include <rtk_stack_internal.h>
+
+/*
+ * GATT server notification channel. The application writes notifications in place into a single
+ * producer single consumer byte ring per connection and publishes them with one commit. The BT API
+ * task sends them while the lower stack has credits and frees them when the lower stack reports
+ * them sent, which is also when credits come back, so a stalled ring is drained from the send data
+ * complete callback without a timer.
+ */
+
+#define BT_GATTS_NTF_RING_MIN           64
+#define BT_GATTS_NTF_RING_MAX           0x8000
+
+/* record flags */
+#define BT_GATTS_NTF_REC_PAD            0x01    /* rest of the ring is unused, the next record is at its start */
+#define BT_GATTS_NTF_REC_DONE           0x02    /* not sent, freed without a send data complete callback */
+
+/* records start on 8 bytes, so the room left at the end of the ring always fits a pad record */
+#define BT_GATTS_NTF_REC_SIZE(len)      ((uint32_t)((sizeof(bt_gatts_ntf_rec_t) + (len) + 7) & ~7))
+
+typedef struct {
+	uint16_t app_id;
+	uint16_t index;
+	uint16_t len;
+	uint8_t flags;
+	uint8_t tag;                    /* send order on the link, set when the record is sent */
+} bt_gatts_ntf_rec_t;
+
+typedef struct {
+	bt_stack_ring_ref_t ref;        /* held by the producer and the API task around each access to the ring */
+	uint8_t disconnected;
+	bool stalled;
+	uint16_t conn_handle;
+	uint8_t conn_id;
+	uint16_t cid;
+	uint8_t *p_ring;
+	uint32_t size;
+	/* free running byte offsets: head and resv written by the producer, send and tail by the API task */
+	uint32_t head;                  /* end of the committed records */
+	uint32_t resv;                  /* end of the reserved records */
+	uint32_t send;                  /* next record to send */
+	uint32_t tail;                  /* oldest record sent and not completed */
+	rtk_bt_gatts_ntf_chan_stats_t stats;
+} bt_gatts_ntf_chan_t;
+
+static bt_gatts_ntf_chan_t bt_gatts_ntf_chan[RTK_BT_GATTS_NTF_CHAN_NUM];
+static uint8_t bt_gatts_ntf_drain_posted = 0;
+static uint8_t bt_gatts_ntf_chan_next = 0;      /* first channel of the next drain round */
+
+static bt_gatts_ntf_chan_t *bt_stack_gatts_ntf_chan_find(uint16_t conn_handle)
+{
+	bt_gatts_ntf_chan_t *p_chan;
+
+	for (uint8_t i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		p_chan = &bt_gatts_ntf_chan[i];
+		if (bt_stack_ring_ref_is_open(&p_chan->ref) && p_chan->conn_handle == conn_handle) {
+			return p_chan;
+		}
+	}
+
+	return NULL;
+}
+
+/* find a channel and keep it from being freed until bt_stack_ring_ref_put() */
+static bt_gatts_ntf_chan_t *bt_stack_gatts_ntf_chan_hold(uint16_t conn_handle)
+{
+	bt_gatts_ntf_chan_t *p_chan = bt_stack_gatts_ntf_chan_find(conn_handle);
+
+	if (!p_chan || !bt_stack_ring_ref_hold(&p_chan->ref)) {
+		return NULL;
+	}
+	/* closed and opened again for another connection between the find and the hold */
+	if (p_chan->conn_handle != conn_handle) {
+		bt_stack_ring_ref_put(&p_chan->ref);
+		return NULL;
+	}
+
+	return p_chan;
+}
+
+static inline bt_gatts_ntf_rec_t *bt_stack_gatts_ntf_rec(bt_gatts_ntf_chan_t *p_chan, uint32_t offset)
+{
+	return (bt_gatts_ntf_rec_t *)(p_chan->p_ring + (offset & (p_chan->size - 1)));
+}
+
+/* bytes from a record to the next one */
+static inline uint32_t bt_stack_gatts_ntf_rec_span(bt_gatts_ntf_chan_t *p_chan, uint32_t offset, bt_gatts_ntf_rec_t *p_rec)
+{
+	if (p_rec->flags & BT_GATTS_NTF_REC_PAD) {
+		return p_chan->size - (offset & (p_chan->size - 1));
+	}
+
+	return BT_GATTS_NTF_REC_SIZE(p_rec->len);
+}
+
+/* free the records at the tail which need no send data complete callback */
+static void bt_stack_gatts_ntf_chan_reclaim(bt_gatts_ntf_chan_t *p_chan)
+{
+	bt_gatts_ntf_rec_t *p_rec;
+	uint32_t tail = p_chan->tail;
+
+	while (tail != p_chan->send) {
+		p_rec = bt_stack_gatts_ntf_rec(p_chan, tail);
+		if (!(p_rec->flags & (BT_GATTS_NTF_REC_PAD | BT_GATTS_NTF_REC_DONE))) {
+			break;
+		}
+		tail += bt_stack_gatts_ntf_rec_span(p_chan, tail, p_rec);
+	}
+	__atomic_store_n(&p_chan->tail, tail, __ATOMIC_RELEASE);
+}
+
+/* drop everything committed, the link is gone */
+static void bt_stack_gatts_ntf_chan_flush(bt_gatts_ntf_chan_t *p_chan)
+{
+	bt_gatts_ntf_rec_t *p_rec;
+	uint32_t head = __atomic_load_n(&p_chan->head, __ATOMIC_ACQUIRE);
+	uint32_t offset = p_chan->send;
+
+	while (offset != head) {
+		p_rec = bt_stack_gatts_ntf_rec(p_chan, offset);
+		if (!(p_rec->flags & BT_GATTS_NTF_REC_PAD)) {
+			p_chan->stats.fail_num++;
+		}
+		offset += bt_stack_gatts_ntf_rec_span(p_chan, offset, p_rec);
+	}
+	/* the ones sent will not be completed either */
+	p_chan->send = head;
+	__atomic_store_n(&p_chan->tail, head, __ATOMIC_RELEASE);
+}
+
+/* send the record at p_chan->send, returns false when nothing was sent */
+static bool bt_stack_gatts_ntf_chan_send_one(bt_gatts_ntf_chan_t *p_chan, uint32_t head, bool *p_no_credits)
+{
+	bt_gatts_ntf_rec_t *p_rec;
+	uint16_t credits = 0;
+	uint16_t ret;
+
+	while (p_chan->send != head) {
+		p_rec = bt_stack_gatts_ntf_rec(p_chan, p_chan->send);
+		if (p_rec->flags & BT_GATTS_NTF_REC_PAD) {
+			p_chan->send += bt_stack_gatts_ntf_rec_span(p_chan, p_chan->send, p_rec);
+			continue;
+		}
+
+		le_get_gap_param(GAP_PARAM_LE_REMAIN_CREDITS, &credits);
+		if (!credits) {
+			if (!p_chan->stalled) {
+				p_chan->stalled = true;
+				p_chan->stats.credit_stall_num++;
+			}
+			*p_no_credits = true;
+			return false;
+		}
+		p_chan->stalled = false;
+
+		ret = bt_stack_gatts_send_value(p_chan->conn_handle, p_chan->cid, p_rec->app_id, p_rec->index,
+										BT_STRUCT_TAIL(p_rec, bt_gatts_ntf_rec_t), p_rec->len, true, &p_rec->tag);
+		if (ret == RTK_BT_OK) {
+			p_chan->stats.sent_num++;
+			p_chan->stats.sent_bytes += p_rec->len;
+		} else {
+			BT_LOGE("%s send fail (ret = 0x%x,conn_handle = 0x%x)\r\n", __func__, ret, p_chan->conn_handle);
+			p_rec->flags |= BT_GATTS_NTF_REC_DONE;
+			p_chan->stats.fail_num++;
+		}
+		p_chan->send += BT_GATTS_NTF_REC_SIZE(p_rec->len);
+		return true;
+	}
+
+	return false;
+}
+
+void bt_stack_gatts_ntf_chan_drain(void)
+{
+	bt_gatts_ntf_chan_t *p_chan;
+	bool held[RTK_BT_GATTS_NTF_CHAN_NUM];
+	bool progress, no_credits = false;
+	uint8_t start, i;
+
+	/* commits from here on post a new message */
+	__atomic_store_n(&bt_gatts_ntf_drain_posted, 0, __ATOMIC_SEQ_CST);
+
+	for (i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		held[i] = bt_stack_ring_ref_hold(&bt_gatts_ntf_chan[i].ref);
+	}
+
+	/* one notification per channel per round, starting after the channel which sent last,
+	 * so the links share the credits given back one at a time */
+	do {
+		progress = false;
+		start = bt_gatts_ntf_chan_next;
+		for (uint8_t n = 0; n < RTK_BT_GATTS_NTF_CHAN_NUM && !no_credits; n++) {
+			i = (start + n) % RTK_BT_GATTS_NTF_CHAN_NUM;
+			p_chan = &bt_gatts_ntf_chan[i];
+			/* a channel being closed is skipped, its close waits for the put below */
+			if (!held[i] || !bt_stack_ring_ref_is_open(&p_chan->ref)) {
+				continue;
+			}
+			if (p_chan->disconnected) {
+				bt_stack_gatts_ntf_chan_flush(p_chan);
+				continue;
+			}
+			if (bt_stack_gatts_ntf_chan_send_one(p_chan, __atomic_load_n(&p_chan->head, __ATOMIC_ACQUIRE), &no_credits)) {
+				bt_stack_gatts_ntf_chan_reclaim(p_chan);
+				progress = true;
+				bt_gatts_ntf_chan_next = (i + 1) % RTK_BT_GATTS_NTF_CHAN_NUM;
+			}
+		}
+	} while (progress && !no_credits);
+
+	for (i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		if (held[i]) {
+			bt_stack_ring_ref_put(&bt_gatts_ntf_chan[i].ref);
+		}
+	}
+}
+
+/* the oldest notification of the link on the air from a channel, if it is for app_id and index */
+bool bt_stack_gatts_ntf_chan_oldest(uint8_t conn_id, uint16_t app_id, uint16_t index, uint8_t *p_tag)
+{
+	bt_gatts_ntf_chan_t *p_chan;
+	bt_gatts_ntf_rec_t *p_rec;
+	bool match = false;
+
+	for (uint8_t i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM && !match; i++) {
+		p_chan = &bt_gatts_ntf_chan[i];
+		if (p_chan->conn_id != conn_id || p_chan->disconnected || !bt_stack_ring_ref_hold(&p_chan->ref)) {
+			continue;
+		}
+		bt_stack_gatts_ntf_chan_reclaim(p_chan);
+		if (p_chan->tail != p_chan->send) {
+			p_rec = bt_stack_gatts_ntf_rec(p_chan, p_chan->tail);
+			if (p_rec->app_id == app_id && p_rec->index == index) {
+				*p_tag = p_rec->tag;
+				match = true;
+			}
+		}
+		bt_stack_ring_ref_put(&p_chan->ref);
+	}
+
+	return match;
+}
+
+/* send data complete callback of a notification from a channel */
+bool bt_stack_gatts_ntf_chan_sent(uint8_t conn_id, uint16_t app_id, uint16_t index, uint16_t cause)
+{
+	bt_gatts_ntf_chan_t *p_chan = NULL;
+	bt_gatts_ntf_rec_t *p_rec;
+	bool match = false;
+
+	for (uint8_t i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		p_chan = &bt_gatts_ntf_chan[i];
+		if (p_chan->conn_id != conn_id || p_chan->disconnected || !bt_stack_ring_ref_hold(&p_chan->ref)) {
+			continue;
+		}
+		bt_stack_gatts_ntf_chan_reclaim(p_chan);
+		/* the lower stack completes the notifications of a link in the order they were sent */
+		if (p_chan->tail != p_chan->send) {
+			p_rec = bt_stack_gatts_ntf_rec(p_chan, p_chan->tail);
+			if (p_rec->app_id == app_id && p_rec->index == index) {
+				if (cause) {
+					p_chan->stats.fail_num++;
+				} else {
+					p_chan->stats.complete_num++;
+				}
+				p_rec->flags |= BT_GATTS_NTF_REC_DONE;
+				bt_stack_gatts_ntf_chan_reclaim(p_chan);
+				match = true;
+			}
+		}
+		bt_stack_ring_ref_put(&p_chan->ref);
+		if (match) {
+			break;
+		}
+	}
+	if (!match) {
+		return false;
+	}
+
+	/* credits came back with it */
+	bt_stack_gatts_ntf_chan_drain();
+
+	return true;
+}
+
+void bt_stack_gatts_ntf_chan_disconnect(uint8_t conn_id)
+{
+	bt_gatts_ntf_chan_t *p_chan;
+
+	for (uint8_t i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		p_chan = &bt_gatts_ntf_chan[i];
+		if (p_chan->conn_id == conn_id && !p_chan->disconnected && bt_stack_ring_ref_hold(&p_chan->ref)) {
+			__atomic_store_n(&p_chan->disconnected, 1, __ATOMIC_RELEASE);
+			bt_stack_gatts_ntf_chan_flush(p_chan);
+			bt_stack_ring_ref_put(&p_chan->ref);
+		}
+	}
+}
+
+/* called once bt_stack_ring_ref_close() has seen the last hold go */
+static void bt_stack_gatts_ntf_chan_free(bt_gatts_ntf_chan_t *p_chan)
+{
+	if (p_chan->p_ring) {
+		osif_mem_free(p_chan->p_ring);
+		p_chan->p_ring = NULL;
+	}
+	bt_stack_ring_ref_free(&p_chan->ref);
+}
+
+void bt_stack_gatts_ntf_chan_deinit(void)
+{
+	for (uint8_t i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		if (bt_stack_ring_ref_close(&bt_gatts_ntf_chan[i].ref)) {
+			bt_stack_gatts_ntf_chan_free(&bt_gatts_ntf_chan[i]);
+		}
+	}
+	__atomic_store_n(&bt_gatts_ntf_drain_posted, 0, __ATOMIC_SEQ_CST);
+}
+
+uint16_t rtk_bt_gatts_ntf_chan_open(uint16_t conn_handle, uint16_t cid, uint16_t ring_size)
+{
+	bt_gatts_ntf_chan_t *p_chan = NULL;
+	uint8_t *p_ring = NULL;
+	uint32_t size = BT_GATTS_NTF_RING_MIN;
+	uint8_t conn_id;
+
+	if (ring_size > BT_GATTS_NTF_RING_MAX) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	if (bt_stack_le_gap_get_conn_id(conn_handle, &conn_id) != RTK_BT_OK) {
+		return RTK_BT_ERR_NO_CONNECTION;
+	}
+	if (bt_stack_gatts_ntf_chan_find(conn_handle)) {
+		return RTK_BT_ERR_ALREADY_DONE;
+	}
+
+	/* a power of two, so the free running offsets wrap onto the same byte */
+	while (size < ring_size) {
+		size <<= 1;
+	}
+	p_ring = (uint8_t *)osif_mem_alloc(RAM_TYPE_DATA_ON, size);
+	if (!p_ring) {
+		return RTK_BT_ERR_NO_MEMORY;
+	}
+
+	for (uint8_t i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		if (bt_stack_ring_ref_claim(&bt_gatts_ntf_chan[i].ref)) {
+			p_chan = &bt_gatts_ntf_chan[i];
+			break;
+		}
+	}
+	if (!p_chan) {
+		osif_mem_free(p_ring);
+		return RTK_BT_ERR_NO_RESOURCE;
+	}
+
+	p_chan->conn_handle = conn_handle;
+	p_chan->conn_id = conn_id;
+	p_chan->cid = cid ? cid : L2C_FIXED_CID_ATT;
+	p_chan->p_ring = p_ring;
+	p_chan->size = size;
+	p_chan->head = 0;
+	p_chan->resv = 0;
+	p_chan->send = 0;
+	p_chan->tail = 0;
+	p_chan->stalled = false;
+	p_chan->disconnected = 0;
+	memset(&p_chan->stats, 0, sizeof(p_chan->stats));
+	bt_stack_ring_ref_open(&p_chan->ref);
+
+	return RTK_BT_OK;
+}
+
+uint16_t rtk_bt_gatts_ntf_chan_close(uint16_t conn_handle)
+{
+	bt_gatts_ntf_chan_t *p_chan = bt_stack_gatts_ntf_chan_find(conn_handle);
+
+	/* waits for a reserve, commit or drain in flight on the ring */
+	if (!p_chan || !bt_stack_ring_ref_close(&p_chan->ref)) {
+		return RTK_BT_ERR_NO_ENTRY;
+	}
+	bt_stack_gatts_ntf_chan_free(p_chan);
+
+	return RTK_BT_OK;
+}
+
+uint16_t rtk_bt_gatts_ntf_chan_reserve(uint16_t conn_handle, uint16_t app_id, uint16_t index, uint16_t len, uint8_t **pp_value)
+{
+	bt_gatts_ntf_chan_t *p_chan;
+	bt_gatts_ntf_rec_t *p_rec;
+	uint32_t resv, pad, need;
+	uint16_t ret = RTK_BT_OK;
+
+	if (!pp_value || !len) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	p_chan = bt_stack_gatts_ntf_chan_hold(conn_handle);
+	if (!p_chan) {
+		return RTK_BT_ERR_NO_ENTRY;
+	}
+	if (__atomic_load_n(&p_chan->disconnected, __ATOMIC_ACQUIRE)) {
+		ret = RTK_BT_ERR_NO_CONNECTION;
+		goto end;
+	}
+	need = BT_GATTS_NTF_REC_SIZE(len);
+	if (need > p_chan->size / 2) {
+		ret = RTK_BT_ERR_PARAM_INVALID;
+		goto end;
+	}
+
+	resv = p_chan->resv;
+	/* a record does not wrap, the end of the ring is skipped when it is too short */
+	pad = p_chan->size - (resv & (p_chan->size - 1));
+	if (pad >= need) {
+		pad = 0;
+	}
+	if (resv + pad + need - __atomic_load_n(&p_chan->tail, __ATOMIC_ACQUIRE) > p_chan->size) {
+		p_chan->stats.queue_full_num++;
+		ret = RTK_BT_ERR_QUEUE_FULL;
+		goto end;
+	}
+
+	if (pad) {
+		p_rec = bt_stack_gatts_ntf_rec(p_chan, resv);
+		p_rec->flags = BT_GATTS_NTF_REC_PAD;
+		resv += pad;
+	}
+	p_rec = bt_stack_gatts_ntf_rec(p_chan, resv);
+	p_rec->app_id = app_id;
+	p_rec->index = index;
+	p_rec->len = len;
+	p_rec->flags = 0;
+	p_chan->resv = resv + need;
+	*pp_value = BT_STRUCT_TAIL(p_rec, bt_gatts_ntf_rec_t);
+
+end:
+	bt_stack_ring_ref_put(&p_chan->ref);
+	return ret;
+}
+
+uint16_t rtk_bt_gatts_ntf_chan_commit(uint16_t conn_handle)
+{
+	bt_gatts_ntf_chan_t *p_chan;
+	bt_gatts_ntf_rec_t *p_rec;
+	uint32_t head, offset, used;
+	uint32_t num = 0;
+
+	p_chan = bt_stack_gatts_ntf_chan_hold(conn_handle);
+	if (!p_chan) {
+		return RTK_BT_ERR_NO_ENTRY;
+	}
+	head = p_chan->head;
+	if (head == p_chan->resv) {
+		goto end;
+	}
+
+	offset = head;
+	while (offset != p_chan->resv) {
+		p_rec = bt_stack_gatts_ntf_rec(p_chan, offset);
+		if (!(p_rec->flags & BT_GATTS_NTF_REC_PAD)) {
+			num++;
+		}
+		offset += bt_stack_gatts_ntf_rec_span(p_chan, offset, p_rec);
+	}
+	__atomic_store_n(&p_chan->head, p_chan->resv, __ATOMIC_SEQ_CST);
+
+	p_chan->stats.commit_num++;
+	p_chan->stats.queued_num += num;
+	used = p_chan->resv - __atomic_load_n(&p_chan->tail, __ATOMIC_ACQUIRE);
+	if (used > p_chan->stats.queue_bytes_max) {
+		p_chan->stats.queue_bytes_max = (uint16_t)used;
+	}
+	/* wake the API task once, however many commits were made before it runs; when the message
+	 * cannot be sent the next commit or send data complete callback tries again */
+	bt_stack_ring_kick(&bt_gatts_ntf_drain_posted, RTK_BT_API_TASK_GATTS_NTF);
+
+end:
+	bt_stack_ring_ref_put(&p_chan->ref);
+	return RTK_BT_OK;
+}
+
+uint16_t rtk_bt_gatts_ntf_chan_stats_get(uint16_t conn_handle, rtk_bt_gatts_ntf_chan_stats_t *p_stats, bool reset)
+{
+	bt_gatts_ntf_chan_t *p_chan;
+
+	if (!p_stats) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	p_chan = bt_stack_gatts_ntf_chan_hold(conn_handle);
+	if (!p_chan) {
+		return RTK_BT_ERR_NO_ENTRY;
+	}
+
+	/* counters are updated without a lock by the contexts they belong to, a reset may lose an update in flight */
+	memcpy(p_stats, &p_chan->stats, sizeof(*p_stats));
+	p_stats->queue_bytes = (uint16_t)(__atomic_load_n(&p_chan->head, __ATOMIC_ACQUIRE) -
+									  __atomic_load_n(&p_chan->tail, __ATOMIC_ACQUIRE));
+	if (reset) {
+		memset(&p_chan->stats, 0, sizeof(p_chan->stats));
+	}
+	bt_stack_ring_ref_put(&p_chan->ref);
+
+	return RTK_BT_OK;
+}
@@ -223,7 +223,7 @@ uint16_t bt_stack_gmap_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
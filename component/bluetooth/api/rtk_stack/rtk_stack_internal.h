@@ -16,12 +16,36 @@ extern "C" {
 #include <rtk_bt_common.h>
 #include <app_msg.h>
 
+/* state of a stream or channel with a ring shared by an application producer and the BT API task */
+#define BT_STACK_RING_FREE              0
+#define BT_STACK_RING_OPEN              1
+#define BT_STACK_RING_BUSY              2   /* being opened or closed */
+
+typedef struct {
+	uint8_t state;
+	uint8_t users;                      /* holds on the ring in flight */
+} bt_stack_ring_ref_t;
+
+/* FREE to BUSY, the opener sets the entry up and then calls bt_stack_ring_ref_open */
+bool bt_stack_ring_ref_claim(bt_stack_ring_ref_t *p_ref);
+void bt_stack_ring_ref_open(bt_stack_ring_ref_t *p_ref);
+bool bt_stack_ring_ref_is_open(bt_stack_ring_ref_t *p_ref);
+/* keep the ring from being freed, fails when the entry is not open */
+bool bt_stack_ring_ref_hold(bt_stack_ring_ref_t *p_ref);
+void bt_stack_ring_ref_put(bt_stack_ring_ref_t *p_ref);
+/* OPEN to BUSY and wait for the holds in flight, the caller then frees the ring and calls bt_stack_ring_ref_free */
+bool bt_stack_ring_ref_close(bt_stack_ring_ref_t *p_ref);
+void bt_stack_ring_ref_free(bt_stack_ring_ref_t *p_ref);
+/* post subtype to the BT API task unless *p_posted says it is already posted, false when it could not be posted */
+bool bt_stack_ring_kick(uint8_t *p_posted, uint16_t subtype);
+
 uint16_t bt_stack_gap_init(void);
 void bt_stack_pending_cmd_init(void);
 void bt_stack_pending_cmd_deinit(void);
 rtk_bt_cmd_t *bt_stack_pending_cmd_search(uint32_t msg_type);
 void bt_stack_pending_cmd_insert(rtk_bt_cmd_t *p_cmd);
 void bt_stack_pending_cmd_delete(rtk_bt_cmd_t *p_cmd);
+uint32_t bt_stack_pending_cmd_num(void);
 bool bt_stack_profile_check(rtk_bt_profile_t profile);
 
 uint16_t bt_stack_le_gap_wait_ready(void);
@@ -33,6 +57,13 @@ uint16_t bt_stack_le_gap_get_conn_id(uint16_t conn_handle, uint8_t *p_conn_id);
 uint16_t bt_stack_gatts_init(rtk_bt_app_conf_t *app_conf);
 void bt_stack_gatts_deinit(void);
 void bt_stack_gatts_disconnect_queue_clear(uint8_t conn_id);
+uint16_t bt_stack_gatts_send_value(uint16_t conn_handle, uint16_t cid, uint16_t app_id, uint16_t index,
+								   uint8_t *data, uint16_t len, bool notify, uint8_t *p_tag);
+void bt_stack_gatts_ntf_chan_deinit(void);
+void bt_stack_gatts_ntf_chan_drain(void);
+bool bt_stack_gatts_ntf_chan_oldest(uint8_t conn_id, uint16_t app_id, uint16_t index, uint8_t *p_tag);
+bool bt_stack_gatts_ntf_chan_sent(uint8_t conn_id, uint16_t app_id, uint16_t index, uint16_t cause);
+void bt_stack_gatts_ntf_chan_disconnect(uint8_t conn_id);
 uint16_t bt_stack_gattc_init(rtk_bt_app_conf_t *app_conf);
 void  bt_stack_gattc_deinit(void);
 uint16_t bt_stack_le_gatts_get_tx_pending_num(uint16_t conn_handle, uint16_t *tx_pending_num);
@@ -84,6 +115,14 @@ void bt_stack_le_iso_deinit(void);
 uint16_t bt_stack_le_iso_act_handle(rtk_bt_cmd_t *p_cmd);
 #endif
 
+#if (defined(RTK_BLE_ISO_SUPPORT) && RTK_BLE_ISO_SUPPORT) || (defined(RTK_BLE_AUDIO_SUPPORT) && RTK_BLE_AUDIO_SUPPORT)
+void bt_stack_le_iso_data_init(void);
+void bt_stack_le_iso_data_deinit(void);
+bool bt_stack_le_iso_data_rx_ind(void *p_data);
+void bt_stack_le_iso_data_tx_record(uint16_t iso_conn_handle, uint16_t cause);
+void bt_stack_le_iso_data_drain(void);
+#endif
+
 #if defined(RTK_BLE_AUDIO_SUPPORT) && RTK_BLE_AUDIO_SUPPORT
 uint16_t bt_stack_le_audio_init(rtk_bt_app_conf_t *papp_conf, void *io_msg_q, void *evt_msg_q);
 void bt_stack_le_audio_deinit(void);
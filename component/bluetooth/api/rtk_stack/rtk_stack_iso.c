@@ -45,6 +45,10 @@ void bt_stack_le_iso_data_direct_callback(uint8_t cb_type, void *p_cb_data)
 		if (p_data->p_bt_direct_iso->iso_sdu_len) {
 			BT_DUMPD("", p_data->p_bt_direct_iso->p_buf + p_data->p_bt_direct_iso->offset, p_data->p_bt_direct_iso->iso_sdu_len);
 		}
+		/* lent to the direct data callback when one is registered */
+		if (bt_stack_le_iso_data_rx_ind(p_data->p_bt_direct_iso)) {
+			break;
+		}
 		/* Send event */
 		p_evt = rtk_bt_event_create(RTK_BT_LE_GP_ISO,
 									RTK_BT_LE_ISO_EVT_DATA_RECEIVE_IND,
@@ -119,7 +123,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_start_setting_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_START_SETTING: find no pending command \r\n", __func__);
 		}
@@ -149,7 +153,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_create_cis_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_CREATE_CIS: find no pending command \r\n", __func__);
 		}
@@ -165,7 +169,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_remove_cig_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_REMOVE_CIG: find no pending command \r\n", __func__);
 		}
@@ -344,7 +348,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_setup_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_SETUP_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -400,7 +404,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_remove_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_REMOVE_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -451,7 +455,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 				p_tx_sync_info->time_stamp = p_data->p_cig_mgr_read_iso_tx_sync_rsp->time_stamp;
 				p_tx_sync_info->time_offset = p_data->p_cig_mgr_read_iso_tx_sync_rsp->time_offset;
 			}
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_READ_ISO_TX_SYNC: find no pending command \r\n", __func__);
 		}
@@ -507,7 +511,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 				p_link_quality_info->rx_unreceived_packets = p_data->p_cig_mgr_read_iso_link_quality_rsp->rx_unreceived_packets;
 				p_link_quality_info->duplicate_packets = p_data->p_cig_mgr_read_iso_link_quality_rsp->duplicate_packets;
 			}
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_READ_ISO_LINK_QUALITY: find no pending command \r\n", __func__);
 		}
@@ -542,7 +546,7 @@ T_APP_RESULT bt_stack_le_iso_cig_initiator_cb(uint8_t cig_id, uint8_t cb_type, v
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = 0;//p_data->p_cig_mgr_disconnect_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_DISCONNECT_INFO: find no pending command\r\n", __func__);
 		}
@@ -811,7 +815,7 @@ T_APP_RESULT bt_stack_le_iso_cig_acceptor_cb(uint8_t cb_type, void *p_cb_data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_setup_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_SETUP_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -870,7 +874,7 @@ T_APP_RESULT bt_stack_le_iso_cig_acceptor_cb(uint8_t cb_type, void *p_cb_data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_remove_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_REMOVE_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -921,7 +925,7 @@ T_APP_RESULT bt_stack_le_iso_cig_acceptor_cb(uint8_t cb_type, void *p_cb_data)
 				p_tx_sync_info->time_stamp = p_data->p_cig_mgr_read_iso_tx_sync_rsp->time_stamp;
 				p_tx_sync_info->time_offset = p_data->p_cig_mgr_read_iso_tx_sync_rsp->time_offset;
 			}
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_READ_ISO_TX_SYNC: find no pending command \r\n", __func__);
 		}
@@ -977,7 +981,7 @@ T_APP_RESULT bt_stack_le_iso_cig_acceptor_cb(uint8_t cb_type, void *p_cb_data)
 				p_link_quality_info->rx_unreceived_packets = p_data->p_cig_mgr_read_iso_link_quality_rsp->rx_unreceived_packets;
 				p_link_quality_info->duplicate_packets = p_data->p_cig_mgr_read_iso_link_quality_rsp->duplicate_packets;
 			}
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_READ_ISO_LINK_QUALITY: find no pending command \r\n", __func__);
 		}
@@ -1010,7 +1014,7 @@ T_APP_RESULT bt_stack_le_iso_cig_acceptor_cb(uint8_t cb_type, void *p_cb_data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = 0;//p_data->p_cig_mgr_disconnect_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_DISCONNECT_INFO: find no pending command\r\n", __func__);
 		}
@@ -1115,7 +1119,7 @@ T_APP_RESULT bt_stack_le_iso_cig_acceptor_cb(uint8_t cb_type, void *p_cb_data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_accept_cis_info->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_ACCEPT_CIS_INFO: find no pending command \r\n", __func__);
 		}
@@ -1139,7 +1143,7 @@ T_APP_RESULT bt_stack_le_iso_cig_acceptor_cb(uint8_t cb_type, void *p_cb_data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_cig_mgr_reject_cis_info->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_CIG_MGR_REJECT_CIS_INFO: find no pending command \r\n", __func__);
 		}
@@ -1167,7 +1171,7 @@ static void rtk_stack_iso_handle_bis_broadcaster_state_evt(uint8_t big_handle, u
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] BIG_ISOC_BROADCAST_STATE_BROADCASTING: find no pending command \r\n", __func__);
 		}
@@ -1184,7 +1188,7 @@ static void rtk_stack_iso_handle_bis_broadcaster_state_evt(uint8_t big_handle, u
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = 0;//cause;//cause is 0x116 (HCI_ERR_LOCAL_HOST_TERMINATE) when broadcaster terminate big
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] BIG_ISOC_BROADCAST_STATE_IDLE: find no pending command \r\n", __func__);
 		}
@@ -1237,7 +1241,7 @@ T_APP_RESULT bt_stack_le_iso_big_broadcaster_cb(uint8_t big_handle, uint8_t cb_t
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_big_mgr_setup_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_BIG_MGR_SETUP_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -1269,7 +1273,7 @@ T_APP_RESULT bt_stack_le_iso_big_broadcaster_cb(uint8_t big_handle, uint8_t cb_t
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_big_mgr_remove_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_BIG_MGR_REMOVE_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -1379,7 +1383,7 @@ T_APP_RESULT bt_stack_le_iso_big_broadcaster_cb(uint8_t big_handle, uint8_t cb_t
 				p_tx_sync_info->time_stamp = p_data->p_big_mgr_read_iso_tx_sync_rsp->time_stamp;
 				p_tx_sync_info->time_offset = p_data->p_big_mgr_read_iso_tx_sync_rsp->time_offset;
 			}
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_BIG_MGR_READ_ISO_TX_SYNC: find no pending command \r\n", __func__);
 		}
@@ -1411,7 +1415,7 @@ void rtk_stack_iso_handle_big_receiver_sync_state_evt(uint8_t big_handle, uint8_
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] BIG_SYNC_RECEIVER_SYNC_STATE_TERMINATED: find no pending command \r\n", __func__);
 		}
@@ -1426,7 +1430,7 @@ void rtk_stack_iso_handle_big_receiver_sync_state_evt(uint8_t big_handle, uint8_
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] BIG_SYNC_RECEIVER_SYNC_STATE_SYNCHRONIZED: find no pending command \r\n", __func__);
 		}
@@ -1498,7 +1502,7 @@ T_APP_RESULT bt_stack_le_iso_big_receiver_cb(uint8_t big_handle, uint8_t cb_type
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_big_mgr_setup_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_BIG_MGR_SETUP_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -1530,7 +1534,7 @@ T_APP_RESULT bt_stack_le_iso_big_receiver_cb(uint8_t big_handle, uint8_t cb_type
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_big_mgr_remove_data_path_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_BIG_MGR_REMOVE_DATA_PATH: find no pending command \r\n", __func__);
 		}
@@ -1634,7 +1638,7 @@ T_APP_RESULT bt_stack_le_iso_big_receiver_cb(uint8_t big_handle, uint8_t cb_type
 				p_link_quality_info->crc_error_packets = p_data->p_big_mgr_read_iso_link_quality_rsp->crc_error_packets;
 				p_link_quality_info->rx_unreceived_packets = p_data->p_big_mgr_read_iso_link_quality_rsp->rx_unreceived_packets;
 			}
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] MSG_BIG_MGR_READ_ISO_LINK_QUALITY: find no pending command \r\n", __func__);
 		}
@@ -1792,35 +1796,13 @@ static uint16_t bt_stack_le_iso_data_send(void *data)
 
 	BT_DUMPD(__func__, param->p_data, param->data_len);
 
-#if 0
-	static bool is_odd = false;
-	static uint32_t last_even_time = 0, now_even_time = 0, last_odd_time = 0, now_odd_time = 0;
-	if (is_odd) {
-		now_odd_time = osif_sys_time_get();
-		if (last_odd_time != 0 && (now_odd_time - last_odd_time > 11 || now_odd_time - last_odd_time < 9)) {
-			BT_LOGE("%s gap_iso_send_data iso_conn_handle = 0x%x,pkt_seq_num %d,last_odd_time %d, now_odd_time %d,delta_time %d\r\n", __func__,
-					param->iso_conn_handle, param->pkt_seq_num, (int)last_odd_time, (int)now_odd_time, (int)(now_odd_time - last_odd_time));
-		}
-		last_odd_time = now_odd_time;
-		is_odd = false;
-	} else {
-		now_even_time = osif_sys_time_get();
-		if (last_even_time != 0 && (now_even_time - last_even_time > 11 || now_even_time - last_even_time < 9)) {
-			BT_LOGE("%s gap_iso_send_data iso_conn_handle = 0x%x,pkt_seq_num %d,last_even_time %d, now_even_time %d,delta_time %d\r\n", __func__,
-					param->iso_conn_handle, param->pkt_seq_num, (int)last_even_time, (int)now_even_time, (int)(now_even_time - last_even_time));
-		}
-		last_even_time = now_even_time;
-		is_odd = true;
-	}
-
-#endif
-
 	cause = gap_iso_send_data(param->p_data,
 							  param->iso_conn_handle,
 							  param->data_len,
 							  param->ts_flag,
 							  param->time_stamp,
 							  param->pkt_seq_num);
+	bt_stack_le_iso_data_tx_record(param->iso_conn_handle, (uint16_t)cause);
 	if (GAP_CAUSE_SUCCESS != cause) {
 		if (cause == GAP_CAUSE_ERROR_CREDITS) {
 			BT_LOGE("%s gap_iso_send_data warning (cause = 0x%x,iso_conn_handle = 0x%x)\r\n", __func__, cause, param->iso_conn_handle);
@@ -2698,7 +2680,7 @@ uint16_t bt_stack_le_iso_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 async_handle:
 	if (ret) {
@@ -2706,7 +2688,7 @@ async_handle:
 		    should be deleted here */
 		bt_stack_pending_cmd_delete(p_cmd);
 		p_cmd->ret = ret;
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	}
 	return ret;
 }
@@ -2746,6 +2728,7 @@ uint16_t bt_stack_le_iso_init(void *p_conf)
 		BT_LOGE("%s cig_mgr_init fail (cause = 0x%x)\r\n", __func__, cause);
 		return RTK_BT_FAIL;
 	}
+	bt_stack_le_iso_data_init();
 	gap_register_direct_cb(bt_stack_le_iso_data_direct_callback);
 	/* initiator */
 	if (RTK_BLE_ISO_ROLE_CIS_INITIATOR == p_le_iso_app_conf->iso_role) {
@@ -2806,6 +2789,7 @@ void bt_stack_le_iso_deinit(void)
 		return;
 	}
 	gap_register_direct_cb(NULL);
+	bt_stack_le_iso_data_deinit();
 	if (bt_le_iso_priv_data.ini.mtx) {
 		osif_mutex_delete(bt_le_iso_priv_data.ini.mtx);
 	}
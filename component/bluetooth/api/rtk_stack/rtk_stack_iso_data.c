@@ -0,0 +1,450 @@
+/*
+ *******************************************************************************
+ * Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ */
+#include <string.h>
+#include <stdio.h>
+#include <osif.h>
+#include <bt_api_config.h>
+#if (defined(RTK_BLE_ISO_SUPPORT) && RTK_BLE_ISO_SUPPORT) || (defined(RTK_BLE_AUDIO_SUPPORT) && RTK_BLE_AUDIO_SUPPORT)
+#include <ameba_soc.h>
+#include <app_msg.h>
+#include <gap_iso_data.h>
+#include <bt_direct_msg.h>
+#include <rtk_bt_common.h>
+#include <rtk_bt_le_iso_data.h>
+#include <rtk_stack_internal.h>
+
+/*
+ * Direct ISO data path. Received SDUs are lent to the registered callback in the context the
+ * lower stack delivers them in. SDUs to send are copied into a single producer single consumer
+ * ring per stream and handed to the controller by the BT API task, which is woken by the
+ * producer and, while the controller has no free ISO buffer, by a retry timer. The producer and
+ * the BT API task hold the stream while they use its ring, close waits for them to let go.
+ */
+
+/* the stack has no event for ISO buffers given back by the controller, poll while it is out of them */
+#define BT_ISO_DATA_CREDIT_RETRY_MS     1
+
+typedef struct {
+	uint16_t len;
+	uint16_t pkt_seq_num;
+	uint32_t time_stamp;
+	bool ts_flag;
+} bt_iso_data_slot_t;
+
+typedef struct {
+	bt_stack_ring_ref_t ref;
+	bool tx_stalled;
+	bool rx_seq_valid;
+	uint16_t iso_conn_handle;
+	uint16_t max_sdu;
+	uint32_t sdu_interval_us;
+	/* ring of depth slots of slot_size bytes, head written by the producer, tail by the API task */
+	uint8_t *p_ring;
+	uint16_t depth;
+	uint16_t slot_size;
+	uint16_t head;
+	uint16_t tail;
+	uint16_t rx_next_seq;
+	uint32_t rx_last_us;
+	uint32_t tx_last_us;
+	rtk_bt_le_iso_data_stats_t stats;
+} bt_iso_data_stream_t;
+
+static bt_iso_data_stream_t bt_iso_data_stream[RTK_BT_LE_ISO_DATA_STREAM_NUM];
+static rtk_bt_le_iso_data_rx_cb_t bt_iso_data_rx_cb = NULL;
+static uint8_t bt_iso_data_drain_posted = 0;
+static void *bt_iso_data_retry_timer = NULL;
+
+static bt_iso_data_stream_t *bt_stack_le_iso_data_find(uint16_t iso_conn_handle)
+{
+	bt_iso_data_stream_t *p_stream;
+
+	for (uint8_t i = 0; i < RTK_BT_LE_ISO_DATA_STREAM_NUM; i++) {
+		p_stream = &bt_iso_data_stream[i];
+		if (bt_stack_ring_ref_is_open(&p_stream->ref) && p_stream->iso_conn_handle == iso_conn_handle) {
+			return p_stream;
+		}
+	}
+
+	return NULL;
+}
+
+/* find the stream and keep its ring until bt_stack_ring_ref_put */
+static bt_iso_data_stream_t *bt_stack_le_iso_data_hold(uint16_t iso_conn_handle)
+{
+	bt_iso_data_stream_t *p_stream;
+
+	for (uint8_t i = 0; i < RTK_BT_LE_ISO_DATA_STREAM_NUM; i++) {
+		p_stream = &bt_iso_data_stream[i];
+		if (!bt_stack_ring_ref_hold(&p_stream->ref)) {
+			continue;
+		}
+		if (p_stream->iso_conn_handle == iso_conn_handle) {
+			return p_stream;
+		}
+		bt_stack_ring_ref_put(&p_stream->ref);
+	}
+
+	return NULL;
+}
+
+static inline bt_iso_data_slot_t *bt_stack_le_iso_data_slot(bt_iso_data_stream_t *p_stream, uint16_t idx)
+{
+	return (bt_iso_data_slot_t *)(p_stream->p_ring + (uint32_t)(idx & (p_stream->depth - 1)) * p_stream->slot_size);
+}
+
+static void bt_stack_le_iso_data_timing(rtk_bt_le_iso_data_timing_t *p_timing, uint32_t *p_last_us, uint32_t sdu_interval_us)
+{
+	uint32_t now_us = DTimestamp_Get();
+	uint32_t delta_us, jitter_us;
+
+	if (p_timing->sdu_num) {
+		delta_us = now_us - *p_last_us;
+		if (p_timing->sdu_num == 1 || delta_us < p_timing->interval_min_us) {
+			p_timing->interval_min_us = delta_us;
+		}
+		if (delta_us > p_timing->interval_max_us) {
+			p_timing->interval_max_us = delta_us;
+		}
+		jitter_us = delta_us > sdu_interval_us ? delta_us - sdu_interval_us : sdu_interval_us - delta_us;
+		if (jitter_us > p_timing->jitter_max_us) {
+			p_timing->jitter_max_us = jitter_us;
+		}
+		if ((uint64_t)delta_us * RTK_BT_LE_ISO_DATA_LATE_DEN > (uint64_t)sdu_interval_us * RTK_BT_LE_ISO_DATA_LATE_NUM) {
+			p_timing->late_num++;
+		}
+	}
+	*p_last_us = now_us;
+	p_timing->sdu_num++;
+}
+
+/* wake the API task once, however many SDUs were queued before it runs */
+static void bt_stack_le_iso_data_kick(void)
+{
+	if (!bt_stack_ring_kick(&bt_iso_data_drain_posted, RTK_BT_API_TASK_ISO_DATA)) {
+		osif_timer_restart(&bt_iso_data_retry_timer, BT_ISO_DATA_CREDIT_RETRY_MS);
+	}
+}
+
+static void bt_stack_le_iso_data_retry_timeout(void *arg)
+{
+	(void)arg;
+	bt_stack_le_iso_data_kick();
+}
+
+/* returns false when the controller ran out of buffers before the ring was empty */
+static bool bt_stack_le_iso_data_send_ring(bt_iso_data_stream_t *p_stream)
+{
+	bt_iso_data_slot_t *p_slot;
+	T_GAP_CAUSE cause;
+	uint16_t tail = p_stream->tail;
+	uint16_t head = __atomic_load_n(&p_stream->head, __ATOMIC_SEQ_CST);
+
+	while (tail != head) {
+		p_slot = bt_stack_le_iso_data_slot(p_stream, tail);
+		cause = gap_iso_send_data((uint8_t *)BT_STRUCT_TAIL(p_slot, bt_iso_data_slot_t), p_stream->iso_conn_handle,
+								  p_slot->len, p_slot->ts_flag, p_slot->time_stamp, p_slot->pkt_seq_num);
+		if (cause == GAP_CAUSE_ERROR_CREDITS) {
+			if (!p_stream->tx_stalled) {
+				p_stream->tx_stalled = true;
+				p_stream->stats.tx_credit_stall_num++;
+			}
+			return false;
+		}
+		p_stream->tx_stalled = false;
+		if (cause == GAP_CAUSE_SUCCESS) {
+			p_stream->stats.tx_sent_num++;
+		} else {
+			BT_LOGE("%s gap_iso_send_data fail (cause = 0x%x,iso_conn_handle = 0x%x)\r\n", __func__, cause, p_stream->iso_conn_handle);
+			p_stream->stats.tx_fail_num++;
+		}
+		tail++;
+		__atomic_store_n(&p_stream->tail, tail, __ATOMIC_RELEASE);
+	}
+
+	return true;
+}
+
+void bt_stack_le_iso_data_drain(void)
+{
+	bt_iso_data_stream_t *p_stream;
+	bool stalled = false;
+
+	/* SDUs queued from here on post a new message */
+	__atomic_store_n(&bt_iso_data_drain_posted, 0, __ATOMIC_SEQ_CST);
+
+	for (uint8_t i = 0; i < RTK_BT_LE_ISO_DATA_STREAM_NUM; i++) {
+		p_stream = &bt_iso_data_stream[i];
+		if (!bt_stack_ring_ref_hold(&p_stream->ref)) {
+			continue;
+		}
+		if (p_stream->depth && !bt_stack_le_iso_data_send_ring(p_stream)) {
+			stalled = true;
+		}
+		bt_stack_ring_ref_put(&p_stream->ref);
+	}
+
+	if (stalled) {
+		osif_timer_restart(&bt_iso_data_retry_timer, BT_ISO_DATA_CREDIT_RETRY_MS);
+	}
+}
+
+bool bt_stack_le_iso_data_rx_ind(void *p_data)
+{
+	T_BT_DIRECT_ISO_DATA_IND *p_ind = (T_BT_DIRECT_ISO_DATA_IND *)p_data;
+	rtk_bt_le_iso_data_rx_cb_t callback;
+	bt_iso_data_stream_t *p_stream;
+	rtk_bt_le_iso_data_rx_t rx;
+	uint16_t gap;
+
+	p_stream = bt_stack_le_iso_data_find(p_ind->conn_handle);
+	if (p_stream) {
+		bt_stack_le_iso_data_timing(&p_stream->stats.rx, &p_stream->rx_last_us, p_stream->sdu_interval_us);
+		if (p_ind->pkt_status_flag == ISOCH_DATA_PKT_STATUS_POSSIBLE_ERROR_DATA) {
+			p_stream->stats.rx_error_num++;
+		} else if (p_ind->pkt_status_flag == ISOCH_DATA_PKT_STATUS_LOST_DATA) {
+			p_stream->stats.rx_lost_num++;
+		}
+		gap = (uint16_t)(p_ind->pkt_seq_num - p_stream->rx_next_seq);
+		if (p_stream->rx_seq_valid && gap && gap < 0x8000) {
+			p_stream->stats.rx_seq_gap_num += gap;
+		}
+		p_stream->rx_next_seq = p_ind->pkt_seq_num + 1;
+		p_stream->rx_seq_valid = true;
+	}
+
+	callback = __atomic_load_n(&bt_iso_data_rx_cb, __ATOMIC_ACQUIRE);
+	if (!callback) {
+		return false;
+	}
+
+	rx.iso_conn_handle = p_ind->conn_handle;
+	rx.pkt_status_flag = (uint8_t)p_ind->pkt_status_flag;
+	rx.ts_flag = p_ind->ts_flag;
+	rx.time_stamp = p_ind->time_stamp;
+	rx.pkt_seq_num = p_ind->pkt_seq_num;
+	rx.iso_sdu_len = p_ind->iso_sdu_len;
+	rx.p_sdu = p_ind->p_buf + p_ind->offset;
+	rx.p_buf = p_ind->p_buf;
+	if (!callback(&rx)) {
+		gap_iso_data_cfm(p_ind->p_buf);
+	}
+
+	return true;
+}
+
+/* statistics of the SDUs sent by the BT API command, cause is the T_GAP_CAUSE of gap_iso_send_data */
+void bt_stack_le_iso_data_tx_record(uint16_t iso_conn_handle, uint16_t cause)
+{
+	bt_iso_data_stream_t *p_stream = bt_stack_le_iso_data_find(iso_conn_handle);
+
+	if (!p_stream) {
+		return;
+	}
+	bt_stack_le_iso_data_timing(&p_stream->stats.tx, &p_stream->tx_last_us, p_stream->sdu_interval_us);
+	if (cause == GAP_CAUSE_SUCCESS) {
+		p_stream->stats.tx_sent_num++;
+	} else if (cause == GAP_CAUSE_ERROR_CREDITS) {
+		p_stream->stats.tx_credit_stall_num++;
+	} else {
+		p_stream->stats.tx_fail_num++;
+	}
+}
+
+/* called once bt_stack_ring_ref_close has waited for the producer and the API task */
+static void bt_stack_le_iso_data_stream_free(bt_iso_data_stream_t *p_stream)
+{
+	if (p_stream->p_ring) {
+		osif_mem_free(p_stream->p_ring);
+		p_stream->p_ring = NULL;
+	}
+	bt_stack_ring_ref_free(&p_stream->ref);
+}
+
+void bt_stack_le_iso_data_init(void)
+{
+	if (!bt_iso_data_retry_timer) {
+		osif_timer_create(&bt_iso_data_retry_timer, "iso_data_retry", 0, BT_ISO_DATA_CREDIT_RETRY_MS, false,
+						  bt_stack_le_iso_data_retry_timeout);
+	}
+}
+
+void bt_stack_le_iso_data_deinit(void)
+{
+	__atomic_store_n(&bt_iso_data_rx_cb, NULL, __ATOMIC_RELEASE);
+	if (bt_iso_data_retry_timer) {
+		osif_timer_stop(&bt_iso_data_retry_timer);
+		osif_timer_delete(&bt_iso_data_retry_timer);
+		bt_iso_data_retry_timer = NULL;
+	}
+	for (uint8_t i = 0; i < RTK_BT_LE_ISO_DATA_STREAM_NUM; i++) {
+		if (bt_stack_ring_ref_close(&bt_iso_data_stream[i].ref)) {
+			bt_stack_le_iso_data_stream_free(&bt_iso_data_stream[i]);
+		}
+	}
+	__atomic_store_n(&bt_iso_data_drain_posted, 0, __ATOMIC_SEQ_CST);
+}
+
+uint16_t rtk_bt_le_iso_data_stream_open(uint16_t iso_conn_handle, uint32_t sdu_interval_us, uint16_t max_sdu, uint8_t tx_depth)
+{
+	bt_iso_data_stream_t *p_stream = NULL;
+	uint8_t *p_ring = NULL;
+	uint16_t depth = 0, slot_size = 0;
+
+	if (!iso_conn_handle || !sdu_interval_us || (tx_depth && !max_sdu)) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	if (bt_stack_le_iso_data_find(iso_conn_handle)) {
+		return RTK_BT_ERR_ALREADY_DONE;
+	}
+
+	if (tx_depth) {
+		/* a power of two, so the free running indexes wrap onto the same slot */
+		depth = 1;
+		while (depth < tx_depth) {
+			depth <<= 1;
+		}
+		slot_size = (uint16_t)((sizeof(bt_iso_data_slot_t) + max_sdu + 3) & ~3);
+		p_ring = (uint8_t *)osif_mem_alloc(RAM_TYPE_DATA_ON, (uint32_t)depth * slot_size);
+		if (!p_ring) {
+			return RTK_BT_ERR_NO_MEMORY;
+		}
+	}
+
+	for (uint8_t i = 0; i < RTK_BT_LE_ISO_DATA_STREAM_NUM; i++) {
+		if (bt_stack_ring_ref_claim(&bt_iso_data_stream[i].ref)) {
+			p_stream = &bt_iso_data_stream[i];
+			break;
+		}
+	}
+	if (!p_stream) {
+		if (p_ring) {
+			osif_mem_free(p_ring);
+		}
+		return RTK_BT_ERR_NO_RESOURCE;
+	}
+
+	p_stream->iso_conn_handle = iso_conn_handle;
+	p_stream->sdu_interval_us = sdu_interval_us;
+	p_stream->max_sdu = max_sdu;
+	p_stream->p_ring = p_ring;
+	p_stream->depth = depth;
+	p_stream->slot_size = slot_size;
+	p_stream->head = 0;
+	p_stream->tail = 0;
+	p_stream->tx_stalled = false;
+	p_stream->rx_seq_valid = false;
+	memset(&p_stream->stats, 0, sizeof(p_stream->stats));
+	bt_stack_ring_ref_open(&p_stream->ref);
+
+	return RTK_BT_OK;
+}
+
+uint16_t rtk_bt_le_iso_data_stream_close(uint16_t iso_conn_handle)
+{
+	bt_iso_data_stream_t *p_stream = bt_stack_le_iso_data_find(iso_conn_handle);
+
+	/* waits for an enqueue in flight on another task and for the API task */
+	if (!p_stream || !bt_stack_ring_ref_close(&p_stream->ref)) {
+		return RTK_BT_ERR_NO_ENTRY;
+	}
+	bt_stack_le_iso_data_stream_free(p_stream);
+
+	return RTK_BT_OK;
+}
+
+uint16_t rtk_bt_le_iso_data_rx_register(rtk_bt_le_iso_data_rx_cb_t callback)
+{
+	__atomic_store_n(&bt_iso_data_rx_cb, callback, __ATOMIC_RELEASE);
+
+	return RTK_BT_OK;
+}
+
+uint16_t rtk_bt_le_iso_data_release(uint8_t *p_buf)
+{
+	if (!p_buf) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+
+	return gap_iso_data_cfm(p_buf) ? RTK_BT_OK : RTK_BT_ERR_LOWER_STACK_API;
+}
+
+uint16_t rtk_bt_le_iso_data_enqueue(uint16_t iso_conn_handle, uint8_t *p_data, uint16_t data_len,
+									bool ts_flag, uint32_t time_stamp, uint16_t pkt_seq_num)
+{
+	bt_iso_data_stream_t *p_stream;
+	bt_iso_data_slot_t *p_slot;
+	uint16_t head, tail, depth;
+	uint16_t ret = RTK_BT_OK;
+
+	if (!p_data || !data_len) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	p_stream = bt_stack_le_iso_data_hold(iso_conn_handle);
+	if (!p_stream) {
+		return RTK_BT_ERR_NO_ENTRY;
+	}
+	if (!p_stream->depth) {
+		ret = RTK_BT_ERR_NO_ENTRY;
+		goto end;
+	}
+	if (data_len > p_stream->max_sdu) {
+		ret = RTK_BT_ERR_PARAM_INVALID;
+		goto end;
+	}
+
+	bt_stack_le_iso_data_timing(&p_stream->stats.tx, &p_stream->tx_last_us, p_stream->sdu_interval_us);
+	head = p_stream->head;
+	tail = __atomic_load_n(&p_stream->tail, __ATOMIC_ACQUIRE);
+	if ((uint16_t)(head - tail) >= p_stream->depth) {
+		p_stream->stats.tx_queue_full_num++;
+		ret = RTK_BT_ERR_QUEUE_FULL;
+		goto end;
+	}
+
+	p_slot = bt_stack_le_iso_data_slot(p_stream, head);
+	p_slot->len = data_len;
+	p_slot->pkt_seq_num = pkt_seq_num;
+	p_slot->time_stamp = time_stamp;
+	p_slot->ts_flag = ts_flag;
+	memcpy(BT_STRUCT_TAIL(p_slot, bt_iso_data_slot_t), p_data, data_len);
+	__atomic_store_n(&p_stream->head, (uint16_t)(head + 1), __ATOMIC_SEQ_CST);
+
+	depth = (uint16_t)(head + 1 - tail);
+	if (depth > p_stream->stats.tx_queue_depth_max) {
+		p_stream->stats.tx_queue_depth_max = depth;
+	}
+	bt_stack_le_iso_data_kick();
+
+end:
+	bt_stack_ring_ref_put(&p_stream->ref);
+	return ret;
+}
+
+uint16_t rtk_bt_le_iso_data_stats_get(uint16_t iso_conn_handle, rtk_bt_le_iso_data_stats_t *p_stats, bool reset)
+{
+	bt_iso_data_stream_t *p_stream;
+
+	if (!p_stats) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	p_stream = bt_stack_le_iso_data_find(iso_conn_handle);
+	if (!p_stream) {
+		return RTK_BT_ERR_NO_ENTRY;
+	}
+
+	/* counters are updated without a lock by the contexts they belong to, a reset may lose an update in flight */
+	memcpy(p_stats, &p_stream->stats, sizeof(*p_stats));
+	p_stats->tx_queue_depth = (uint16_t)(__atomic_load_n(&p_stream->head, __ATOMIC_ACQUIRE) -
+										 __atomic_load_n(&p_stream->tail, __ATOMIC_ACQUIRE));
+	if (reset) {
+		memset(&p_stream->stats, 0, sizeof(p_stream->stats));
+	}
+
+	return RTK_BT_OK;
+}
+
+#endif /* RTK_BLE_ISO_SUPPORT || RTK_BLE_AUDIO_SUPPORT */
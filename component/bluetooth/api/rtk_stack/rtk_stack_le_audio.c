@@ -1410,6 +1410,7 @@ void bt_stack_le_audio_deinit(void)
 	BT_LOGD("%s\n", __func__);
 
 	gap_register_direct_cb(NULL);
+	bt_stack_le_iso_data_deinit();
 	ble_audio_deinit();
 	bt_stack_le_audio_common_deinit();
 }
@@ -409,7 +409,7 @@ static void bt_stack_le_gap_handle_ext_adv_state_evt(uint8_t adv_handle, T_GAP_E
 			BT_LOGD("app_handle_ext_adv_state_evt: async_cmd complete.\r\n");
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = 0;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 	}
 
@@ -550,7 +550,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 			bt_stack_pending_cmd_delete(p_cmd);
 			if ((uint8_t)wl_op->op == (uint8_t)p_data->p_le_modify_white_list_rsp->operation) {
 				p_cmd->ret = p_data->p_le_modify_white_list_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			} else {
 				BT_LOGE("[%s] GAP_MSG_LE_MODIFY_WHITE_LIST: api operation mismatch with callback \r\n", __func__);
 			}
@@ -566,7 +566,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_le_set_rand_addr_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_SET_RAND_ADDR: find no pending command \r\n", __func__);
 		}
@@ -577,7 +577,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_le_set_host_chann_classif_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_SET_HOST_CHANN_CLASSIF: find no pending command \r\n", __func__);
 		}
@@ -592,7 +592,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 			p_cmd->ret = p_data->p_le_read_rssi_rsp->cause;
 			*read_rssi->p_rssi = p_data->p_le_read_rssi_rsp->rssi;
 			// BT_LOGA("RSSI IS: %d\r\n", p_data->p_le_read_rssi_rsp->rssi);
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_READ_RSSI: find no pending command \r\n", __func__);
 		}
@@ -755,7 +755,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_le_set_data_len_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_SET_DATA_LEN: find no pending command \r\n", __func__);
 		}
@@ -873,7 +873,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 			bt_stack_pending_cmd_delete(p_cmd);
 			if (ptr->operation == (rtk_bt_le_pa_sync_advlist_op_t)p_data->p_le_pa_sync_modify_periodic_adv_list_rsp->operation) {
 				p_cmd->ret = p_data->p_le_pa_sync_modify_periodic_adv_list_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			} else {
 				BT_LOGE("[%s] GAP_MSG_LE_PA_SYNC_MODIFY_PERIODIC_ADV_LIST: api operation mismatch with callback \r\n", __func__);
 			}
@@ -996,7 +996,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 				le_ext_adv_enable(1, &p_data->p_le_ext_adv_start_setting_rsp->adv_handle);
 			} else {
 				p_cmd->ret = p_data->p_le_ext_adv_start_setting_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 #if defined(RTK_BLE_MESH_SUPPORT) && RTK_BLE_MESH_SUPPORT && defined(RTK_BLE_MESH_BASED_ON_CODED_PHY) && RTK_BLE_MESH_BASED_ON_CODED_PHY
 			if (rtk_bt_mesh_is_enable()) {
@@ -1015,7 +1015,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_le_ext_adv_start_setting_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 
 #if defined(RTK_BLE_MESH_SUPPORT) && RTK_BLE_MESH_SUPPORT && defined(RTK_BLE_MESH_BASED_ON_CODED_PHY) && RTK_BLE_MESH_BASED_ON_CODED_PHY
@@ -1059,7 +1059,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 		break;
 	}
@@ -1071,7 +1071,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			// For rtk stack extended ADV:
 			// le_ext_adv_set_adv_enable_param --> le_ext_adv_start_setting --> wait GAP_MSG_LE_EXT_ADV_START_SETTING --> le_ext_adv_enable --> wait GAP_MSG_LE_EXT_ADV_ENABLE
@@ -1119,7 +1119,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 												  PA_ADV_ENABLE_ENABLE_PERIODIC_ADVERTISING | PA_ADV_ENABLE_INCLUDE_ADI);
 			} else {
 				p_cmd->ret = p_data->p_le_pa_adv_start_setting_rsp->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 			break;
 		}
@@ -1128,7 +1128,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_le_pa_adv_start_setting_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 
 		break;
@@ -1147,7 +1147,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_le_pa_adv_set_periodic_adv_enable_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_PA_ADV_SET_PERIODIC_ADV_ENABLE: find no pending command \r\n", __func__);
 		}
@@ -1182,7 +1182,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 				}
 				p_cmd->ret = rsp->cause;
 				bt_stack_pending_cmd_delete(p_cmd);
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			} else {
 				BT_LOGE("[%s] GAP_LE_RF_ENHANCED_READ_TRANSMIT_POWER_LEVEL: find no pending command \r\n", __func__);
 			}
@@ -1198,7 +1198,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 				if (param->conn_handle == le_get_conn_handle(rsp->conn_id)) {
 					p_cmd->ret = rsp->cause;
 					bt_stack_pending_cmd_delete(p_cmd);
-					osif_sem_give(p_cmd->psem);
+					rtk_bt_cmd_complete(p_cmd);
 				}
 			} else {
 				BT_LOGE("[%s] GAP_LE_RF_READ_REMOTE_TRANSMIT_POWER_LEVEL: find no pending command \r\n", __func__);
@@ -1215,7 +1215,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 				if (param->conn_handle == le_get_conn_handle(rsp->conn_id)) {
 					p_cmd->ret = rsp->cause;
 					bt_stack_pending_cmd_delete(p_cmd);
-					osif_sem_give(p_cmd->psem);
+					rtk_bt_cmd_complete(p_cmd);
 				}
 			} else {
 				BT_LOGE("[%s] GAP_LE_RF_SET_TRANSMIT_POWER_REPORTING_ENABLE: find no pending command \r\n", __func__);
@@ -1254,7 +1254,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_RECEIVER_TEST: find no pending command \r\n", __func__);
 		}
@@ -1267,7 +1267,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_TRANSMITTER_TEST: find no pending command \r\n", __func__);
 		}
@@ -1281,7 +1281,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->p_le_dtm_test_end_rsp->cause;
 			*((uint16_t *)p_cmd->param) = p_data->p_le_dtm_test_end_rsp->num_pkts;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_TRANSMITTER_TEST: find no pending command \r\n", __func__);
 		}
@@ -1295,7 +1295,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_ENHANCED_RECEIVER_TEST: find no pending command \r\n", __func__);
 		}
@@ -1308,7 +1308,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_ENHANCED_TRANSMITTER_TEST: find no pending command \r\n", __func__);
 		}
@@ -1323,7 +1323,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_RECEIVER_TEST_V3: find no pending command \r\n", __func__);
 		}
@@ -1336,7 +1336,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_TRANSMITTER_TEST_V3: find no pending command \r\n", __func__);
 		}
@@ -1351,7 +1351,7 @@ static T_APP_RESULT bt_stack_le_gap_callback(uint8_t type, void *data)
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = p_data->le_cause.cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_DTM_TRANSMITTER_TEST_V4: find no pending command \r\n", __func__);
 		}
@@ -1472,7 +1472,7 @@ static void bt_stack_le_gap_handle_read_antenna_evt(uint8_t type, void *data)
 		antenna->num_antennae = p_rsp->num_antennae;
 		antenna->max_switching_pattern_length = p_rsp->max_switching_pattern_length;
 		antenna->max_cte_length = p_rsp->max_cte_length;
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	} else {
 		BT_LOGE("GAP_MSG_LE_AOX_READ_ANTENNA_INFORMATION: find no pending command \r\n");
 	}
@@ -1501,7 +1501,7 @@ static void bt_stack_le_gap_handle_connless_cte_rx_enable_evt(uint8_t type, void
 	if (p_cmd) {
 		bt_stack_pending_cmd_delete(p_cmd);
 		p_cmd->ret = p_rsp->cause;
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	} else {
 		BT_LOGE("GAP_MSG_LE_AOX_CONNLESS_RECEIVER_SET_IQ_SAMPLING_ENABLE: find no pending command \r\n");
 	}
@@ -1576,11 +1576,11 @@ static void bt_stack_le_gap_handle_conn_cte_set_rx_params_evt(uint8_t type, void
 			if (ret) {
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = ret;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 		} else {
 			p_cmd->ret = p_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 	} else {
 		BT_LOGE("GAP_MSG_LE_AOX_SET_CONN_CTE_RECEIVE_PARAMS: find no pending command\r\n");
@@ -1605,7 +1605,7 @@ static void bt_stack_le_gap_handle_conn_cte_req_evt(uint8_t type, void *data)
 	if (p_cmd) {
 		bt_stack_pending_cmd_delete(p_cmd);
 		p_cmd->ret = p_rsp->cause;
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	} else {
 		BT_LOGE("GAP_MSG_LE_AOX_CONN_CTE_REQUEST_ENABLE: find no pending command \r\n");
 	}
@@ -1649,11 +1649,11 @@ static void bt_stack_le_gap_handle_conn_cte_set_tx_param_evt(uint8_t type, void
 			if (ret) {
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = ret;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			}
 		} else {
 			p_cmd->ret = p_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 	} else {
 		BT_LOGE("GAP_MSG_LE_AOX_SET_CONN_CTE_TRANSMIT_PARAMS: find no pending command \r\n");
@@ -1676,7 +1676,7 @@ static void bt_stack_le_gap_handle_conn_cte_rsp_enable_evt(uint8_t type, void *d
 	if (p_cmd) {
 		bt_stack_pending_cmd_delete(p_cmd);
 		p_cmd->ret = p_rsp->cause;
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	} else {
 		BT_LOGE("GAP_MSG_LE_AOX_CONN_CTE_RESPONSE_ENABLE: find no pending command \r\n");
 	}
@@ -1704,7 +1704,7 @@ static void bt_stack_le_gap_handle_connless_cte_tx_set_param_evt(uint8_t type, v
 			p_cmd->ret = le_aox_connless_transmitter_set_cte_transmit_enable(p_rsp->adv_handle,
 																			 AOX_CONNLESS_TRANSMITTER_CTE_ENABLE_ADV_WITH_CTE_ENABLED);
 		}
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	} else {
 		BT_LOGE("GAP_MSG_LE_AOX_CONNLESS_TRANSMITTER_SET_CTE_TRANSMIT_PARAMS: find no pending command \r\n");
 	}
@@ -2062,7 +2062,7 @@ static T_APP_RESULT bt_stack_le_coc_callback(uint8_t coc_msg_type, void *coc_dat
 			if (reg_param->le_psm == reg_psm->le_psm) {
 				bt_stack_pending_cmd_delete(p_cmd);
 				p_cmd->ret = reg_psm->cause;
-				osif_sem_give(p_cmd->psem);
+				rtk_bt_cmd_complete(p_cmd);
 			} else {
 				BT_LOGE("[GAP_COC_MSG_LE_REG_PSM] Error: le_psm mismatched\r\n");
 			}
@@ -2076,7 +2076,7 @@ static T_APP_RESULT bt_stack_le_coc_callback(uint8_t coc_msg_type, void *coc_dat
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = sec_reg->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		}
 		break;
 	}
@@ -4746,7 +4746,7 @@ static T_APP_RESULT privacy_msg_callback(uint8_t msg_type, T_LE_PRIVACY_CB_DATA
 		if (p_cmd) {
 			bt_stack_pending_cmd_delete(p_cmd);
 			p_cmd->ret = msg_data.p_le_privacy_set_mode_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGD("[%s] GAP_MSG_LE_PRIVACY_SET_MODE: find no pending command \r\n", __func__);
 		}
@@ -4766,7 +4766,7 @@ static T_APP_RESULT privacy_msg_callback(uint8_t msg_type, T_LE_PRIVACY_CB_DATA
 			bt_stack_pending_cmd_delete(p_cmd);
 			memcpy(read_peer->peer_rpa, msg_data.p_le_privacy_read_peer_resolv_addr_rsp->peer_resolv_addr, 6);
 			p_cmd->ret = msg_data.p_le_privacy_read_peer_resolv_addr_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_PRIVACY_READ_PEER_RESOLV_ADDR: find no pending command \r\n", __func__);
 		}
@@ -4782,7 +4782,7 @@ static T_APP_RESULT privacy_msg_callback(uint8_t msg_type, T_LE_PRIVACY_CB_DATA
 			memcpy(read_rpa->local_rpa,
 				   msg_data.p_le_privacy_read_local_resolv_addr_rsp->local_resolv_addr, 6);
 			p_cmd->ret = msg_data.p_le_privacy_read_local_resolv_addr_rsp->cause;
-			osif_sem_give(p_cmd->psem);
+			rtk_bt_cmd_complete(p_cmd);
 		} else {
 			BT_LOGE("[%s] GAP_MSG_LE_PRIVACY_READ_LOCAL_RESOLV_ADDR: find no pending command \r\n", __func__);
 		}
@@ -6860,7 +6860,7 @@ uint16_t bt_stack_le_gap_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 
 async_handle:
@@ -6869,7 +6869,7 @@ async_handle:
 		    should be deleted here */
 		bt_stack_pending_cmd_delete(p_cmd);
 		p_cmd->ret = ret;
-		osif_sem_give(p_cmd->psem);
+		rtk_bt_cmd_complete(p_cmd);
 	}
 	return ret;
 }
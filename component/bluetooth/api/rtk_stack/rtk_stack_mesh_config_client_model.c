@@ -316,7 +316,7 @@ uint16_t bt_mesh_config_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif // end of RTK_BLE_MESH_PROVISIONER_SUPPORT
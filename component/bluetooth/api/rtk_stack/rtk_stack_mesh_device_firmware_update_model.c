@@ -287,7 +287,7 @@ uint16_t bt_mesh_dfu_initiator_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_DFU_INITIATOR_ROLE
@@ -581,7 +581,7 @@ uint16_t bt_mesh_dfu_standalone_updater_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_DFU_STANDALONE_UPDATER_ROLE
@@ -73,7 +73,7 @@ uint16_t bt_mesh_generic_default_transition_time_client_model_act_handle(rtk_bt_
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
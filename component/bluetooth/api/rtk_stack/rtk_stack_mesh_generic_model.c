@@ -95,7 +95,7 @@ uint16_t bt_mesh_generic_level_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_GENERIC_LEVEL_CLIENT_MODEL
@@ -158,7 +158,7 @@ uint16_t bt_mesh_generic_power_on_off_client_model_act_handle(rtk_bt_cmd_t *p_cm
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_GENERIC_POWER_ONOFF_CLIENT_MODEL
@@ -271,7 +271,7 @@ uint16_t bt_mesh_generic_power_level_client_model_act_handle(rtk_bt_cmd_t *p_cmd
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_GENERIC_POWER_LEVEL_CLIENT_MODEL
@@ -326,7 +326,7 @@ uint16_t bt_mesh_generic_battery_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_GENERIC_BATTERY_CLIENT_MODEL
@@ -408,7 +408,7 @@ uint16_t bt_mesh_generic_location_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_GENERIC_LOCATION_CLIENT_MODEL
@@ -588,7 +588,7 @@ uint16_t bt_mesh_generic_property_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -1135,7 +1135,7 @@ uint16_t bt_mesh_generic_user_property_server_model_act_handle(rtk_bt_cmd_t *p_c
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -1270,7 +1270,7 @@ uint16_t bt_mesh_generic_admin_property_server_model_act_handle(rtk_bt_cmd_t *p_
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -1401,7 +1401,7 @@ uint16_t bt_mesh_generic_manu_property_server_model_act_handle(rtk_bt_cmd_t *p_c
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -72,7 +72,7 @@ uint16_t bt_mesh_generic_onoff_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif // end of BT_MESH_ENABLE_GENERIC_ON_OFF_CLIENT_MODEL
@@ -134,7 +134,7 @@ uint16_t bt_mesh_health_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif // end of RTK_BLE_MESH_PROVISIONER_SUPPORT
@@ -342,7 +342,7 @@ uint16_t bt_mesh_health_server_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif // end of RTK_BLE_MESH_DEVICE_SUPPORT
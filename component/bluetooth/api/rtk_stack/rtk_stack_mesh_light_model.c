@@ -154,7 +154,7 @@ uint16_t bt_mesh_light_lightness_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_LIGHT_LIGHTNESS_CLIENT_MODEL
@@ -280,7 +280,7 @@ uint16_t bt_mesh_light_ctl_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_LIGHT_CTL_CLIENT_MODEL
@@ -443,7 +443,7 @@ uint16_t bt_mesh_light_hsl_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_LIGHT_HSL_CLIENT_MODEL
@@ -562,7 +562,7 @@ uint16_t bt_mesh_light_xyl_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_LIGHT_XYL_CLIENT_MODEL
@@ -682,7 +682,7 @@ uint16_t bt_mesh_light_lc_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 
@@ -104,7 +104,7 @@ uint16_t bt_mesh_scene_client_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif  // BT_MESH_ENABLE_SCENE_CLIENT_MODEL
@@ -241,7 +241,7 @@ uint16_t bt_mesh_scene_server_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif // end of BT_MESH_ENABLE_SCENE_SERVER_MODEL
@@ -375,7 +375,7 @@ uint16_t bt_mesh_scene_setup_server_model_act_handle(rtk_bt_cmd_t *p_cmd)
 	}
 end:
 	p_cmd->ret = ret;
-	osif_sem_give(p_cmd->psem);
+	rtk_bt_cmd_complete(p_cmd);
 	return ret;
 }
 #endif // end of BT_MESH_ENABLE_SCENE_SETUP_SERVER_MODEL
@@ -0,0 +1,95 @@
+/*
+ *******************************************************************************
+ * Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ */
+#include <string.h>
+#include <stdio.h>
+#include <osif.h>
+#include <rtk_bt_def.h>
+#include <rtk_bt_common.h>
+#include <rtk_stack_internal.h>
+
+/*
+ * Commands waiting for a lower stack callback, hashed by the message type of the callback in
+ * p_cmd->user_data. A bucket keeps the order of insertion, so the oldest command waiting for a
+ * message type is found first as with a single list, without walking the commands of the other
+ * message types. A command is in a bucket if and only if its list.next is not NULL.
+ */
+
+#define BT_STACK_PENDING_CMD_HASH_SIZE      32
+
+static struct list_head g_cmd_pending_tbl[BT_STACK_PENDING_CMD_HASH_SIZE];
+static uint32_t g_cmd_pending_num = 0;
+
+static struct list_head *bt_stack_pending_cmd_bucket(uint32_t msg_type)
+{
+	/* message types are small and dense in each group, a multiplicative hash spreads them */
+	return &g_cmd_pending_tbl[(uint32_t)(msg_type * 0x9E3779B1u) >> 27];
+}
+
+rtk_bt_cmd_t *bt_stack_pending_cmd_search(uint32_t msg_type)
+{
+	rtk_bt_cmd_t *cmd;
+	struct list_head *bucket = bt_stack_pending_cmd_bucket(msg_type);
+
+	list_for_each_entry(cmd, bucket, list, rtk_bt_cmd_t) {
+		if (cmd->user_data == msg_type) {
+			return cmd;
+		}
+	}
+
+	return NULL;
+}
+
+void bt_stack_pending_cmd_insert(rtk_bt_cmd_t *p_cmd)
+{
+	BT_LOGD("insert cmd: msg_type = 0x%x\r\n", (unsigned int)p_cmd->user_data);
+	if (p_cmd->list.next) {
+		list_del(&p_cmd->list);
+		g_cmd_pending_num--;
+	}
+	list_add_tail(&p_cmd->list, bt_stack_pending_cmd_bucket(p_cmd->user_data));
+	g_cmd_pending_num++;
+}
+
+void bt_stack_pending_cmd_delete(rtk_bt_cmd_t *p_cmd)
+{
+	BT_LOGD("delete cmd: msg_type = 0x%x\r\n", (unsigned int)p_cmd->user_data);
+	if (p_cmd->list.next) {
+		list_del(&p_cmd->list);
+		g_cmd_pending_num--;
+	}
+}
+
+uint32_t bt_stack_pending_cmd_num(void)
+{
+	return g_cmd_pending_num;
+}
+
+void bt_stack_pending_cmd_deinit(void)
+{
+	rtk_bt_cmd_t *cmd, *next;
+	uint32_t i;
+	BT_LOGD("delete cmd pending list\r\n");
+
+	for (i = 0; i < BT_STACK_PENDING_CMD_HASH_SIZE; i++) {
+		list_for_each_entry_safe(cmd, next, &g_cmd_pending_tbl[i], list, rtk_bt_cmd_t) {
+			/* off the list first, an asynchronous command is freed by its completion */
+			list_del(&cmd->list);
+			cmd->ret = RTK_BT_ERR_UNHANDLED;
+			rtk_bt_cmd_complete(cmd);
+		}
+	}
+	g_cmd_pending_num = 0;
+}
+
+void bt_stack_pending_cmd_init(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < BT_STACK_PENDING_CMD_HASH_SIZE; i++) {
+		INIT_LIST_HEAD(&g_cmd_pending_tbl[i]);
+	}
+	g_cmd_pending_num = 0;
+}
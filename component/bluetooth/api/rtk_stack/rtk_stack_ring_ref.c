@@ -0,0 +1,86 @@
+/*
+ *******************************************************************************
+ * Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ */
+#include <osif.h>
+#include <bt_api_config.h>
+#include <rtk_bt_common.h>
+#include <rtk_stack_internal.h>
+
+/*
+ * Lifetime of a stream or channel whose ring is written by an application producer and read by
+ * the BT API task. Both hold the entry around every access to the ring; close moves it out of
+ * OPEN first, so no new hold succeeds, then waits for the holds in flight before the ring is freed.
+ * The holder counts its hold before it checks the state and close changes the state before it
+ * checks the count, so at least one of them sees the other.
+ */
+
+extern uint16_t bt_stack_msg_send(uint16_t type, uint16_t subtype, void *msg);
+
+bool bt_stack_ring_ref_claim(bt_stack_ring_ref_t *p_ref)
+{
+	uint8_t state = BT_STACK_RING_FREE;
+
+	return __atomic_compare_exchange_n(&p_ref->state, &state, BT_STACK_RING_BUSY, false,
+									   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+void bt_stack_ring_ref_open(bt_stack_ring_ref_t *p_ref)
+{
+	__atomic_store_n(&p_ref->state, BT_STACK_RING_OPEN, __ATOMIC_RELEASE);
+}
+
+bool bt_stack_ring_ref_is_open(bt_stack_ring_ref_t *p_ref)
+{
+	return __atomic_load_n(&p_ref->state, __ATOMIC_ACQUIRE) == BT_STACK_RING_OPEN;
+}
+
+bool bt_stack_ring_ref_hold(bt_stack_ring_ref_t *p_ref)
+{
+	__atomic_add_fetch(&p_ref->users, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&p_ref->state, __ATOMIC_SEQ_CST) != BT_STACK_RING_OPEN) {
+		__atomic_sub_fetch(&p_ref->users, 1, __ATOMIC_SEQ_CST);
+		return false;
+	}
+
+	return true;
+}
+
+void bt_stack_ring_ref_put(bt_stack_ring_ref_t *p_ref)
+{
+	__atomic_sub_fetch(&p_ref->users, 1, __ATOMIC_SEQ_CST);
+}
+
+bool bt_stack_ring_ref_close(bt_stack_ring_ref_t *p_ref)
+{
+	uint8_t state = BT_STACK_RING_OPEN;
+
+	if (!__atomic_compare_exchange_n(&p_ref->state, &state, BT_STACK_RING_BUSY, false,
+									 __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+		return false;
+	}
+	while (__atomic_load_n(&p_ref->users, __ATOMIC_SEQ_CST)) {
+		osif_delay(1);
+	}
+
+	return true;
+}
+
+void bt_stack_ring_ref_free(bt_stack_ring_ref_t *p_ref)
+{
+	__atomic_store_n(&p_ref->state, BT_STACK_RING_FREE, __ATOMIC_RELEASE);
+}
+
+bool bt_stack_ring_kick(uint8_t *p_posted, uint16_t subtype)
+{
+	if (__atomic_exchange_n(p_posted, 1, __ATOMIC_SEQ_CST)) {
+		return true;
+	}
+	if (bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, subtype, NULL) != RTK_BT_OK) {
+		__atomic_store_n(p_posted, 0, __ATOMIC_SEQ_CST);
+		return false;
+	}
+
+	return true;
+}
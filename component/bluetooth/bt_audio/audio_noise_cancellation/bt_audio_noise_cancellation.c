@@ -10,32 +10,30 @@
 #include <aivoice_interface.h>
 #include <aivoice_afe_config.h>
 #include <string.h>
-#include "ringbuffer.h"
 #include "rtk_bt_common.h"
-#include "speex/speex_resampler.h"
+#include "bt_audio_voice_out.h"
 
-#define RESAMPLE_CHANNEL 1
-#define RESAMPLE_IN_SAMPLE_RATE 16000
-#define RESAMPLE_OUT_SAMPLE_RATE 8000
+/* AFE output frames the ring holds */
+#define AFE_RING_FRAME_NUM 4
 
 struct aivoice {
 	const struct rtk_aivoice_iface *iface;
 	void *handle;
 	uint32_t codec_index;
-	SpeexResamplerState *presampler;
 	unsigned int frame_bytes_per_channel;
-	void *afe_out_8k_buffer;
-	RingBuffer *afe_rbuffer;
+	struct bt_audio_voice_decim decim;
+	struct bt_audio_voice_ring afe_ring;
+	uint8_t *afe_ring_buf;
+	void *bounce_buffer;
 };
 
 static struct aivoice gaivoice = {
 	.iface = NULL,
 	.handle = NULL,
 	.codec_index = RTK_BT_AUDIO_CODEC_MAX,
-	.presampler = NULL,
 	.frame_bytes_per_channel = 0,
-	.afe_out_8k_buffer = NULL,
-	.afe_rbuffer = NULL,
+	.afe_ring_buf = NULL,
+	.bounce_buffer = NULL,
 };
 
 static uint8_t record_channel = 0;
@@ -49,33 +47,30 @@ static int aivoice_callback_process(void *userdata,
 	(void)len;
 	struct aivoice_evout_afe *afe_out;
 	unsigned int frame_bytes_8k = gaivoice.frame_bytes_per_channel / 2;
+	void *frame;
 
 	switch (event_type) {
 	case AIVOICE_EVOUT_AFE:
 		afe_out = (struct aivoice_evout_afe *)msg;
 
 		if (gaivoice.codec_index == RTK_BT_AUDIO_CODEC_CVSD) {
-			int error;
-			spx_uint32_t in_len_frames = gaivoice.frame_bytes_per_channel / (16 / 8);
-			spx_uint32_t out_len_frames = in_len_frames / 2;
-			/* do resample from 16k to 8k */
-			error = speex_resampler_process_int(gaivoice.presampler, 0, (spx_int16_t *)afe_out->data, &in_len_frames, (spx_int16_t *)gaivoice.afe_out_8k_buffer,
-												&out_len_frames);
-			if (error != RESAMPLER_ERR_SUCCESS) {
-				BT_LOGE("[BT AUDIO] speex_resampler_process_int fail 0x%x \r\n", error);
+			frame = bt_audio_voice_ring_reserve(&gaivoice.afe_ring, frame_bytes_8k);
+			if (!frame) {
+				BT_LOGE("[BT AUDIO] gaivoice.afe_ring size is not enough(8k) \r\n");
 				break;
 			}
-			if (RingBuffer_Space(gaivoice.afe_rbuffer) >= frame_bytes_8k) {
-				RingBuffer_Write(gaivoice.afe_rbuffer, (uint8_t *)gaivoice.afe_out_8k_buffer, frame_bytes_8k);
-			} else {
-				BT_LOGE("[BT AUDIO] gaivoice.afe_rbuffer size is not enough(8k) \r\n");
-			}
+			/* decimate from 16k to 8k straight into the ring */
+			bt_audio_voice_decim_process(&gaivoice.decim, (const int16_t *)afe_out->data,
+										 gaivoice.frame_bytes_per_channel / sizeof(int16_t), (int16_t *)frame);
+			bt_audio_voice_ring_commit(&gaivoice.afe_ring, frame_bytes_8k);
 		} else {
-			if (RingBuffer_Space(gaivoice.afe_rbuffer) >= gaivoice.frame_bytes_per_channel) {
-				RingBuffer_Write(gaivoice.afe_rbuffer, (uint8_t *)afe_out->data, gaivoice.frame_bytes_per_channel);
-			} else {
-				BT_LOGE("[BT AUDIO] gaivoice.afe_rbuffer size is not enough(16k) \r\n");
+			frame = bt_audio_voice_ring_reserve(&gaivoice.afe_ring, gaivoice.frame_bytes_per_channel);
+			if (!frame) {
+				BT_LOGE("[BT AUDIO] gaivoice.afe_ring size is not enough(16k) \r\n");
+				break;
 			}
+			memcpy(frame, afe_out->data, gaivoice.frame_bytes_per_channel);
+			bt_audio_voice_ring_commit(&gaivoice.afe_ring, gaivoice.frame_bytes_per_channel);
 		}
 		break;
 
@@ -86,17 +81,37 @@ static int aivoice_callback_process(void *userdata,
 	return 0;
 }
 
+void *rtk_bt_audio_noise_cancellation_frame_get(uint32_t size)
+{
+	if (!gaivoice.afe_ring_buf) {
+		return NULL;
+	}
+	if (size > gaivoice.frame_bytes_per_channel) {
+		BT_LOGE("[BT AUDIO] frame size %d is larger than afe frame \r\n", (int)size);
+		return NULL;
+	}
+
+	return (void *)bt_audio_voice_ring_peek(&gaivoice.afe_ring, size, gaivoice.bounce_buffer);
+}
+
+void rtk_bt_audio_noise_cancellation_frame_release(uint32_t size)
+{
+	if (gaivoice.afe_ring_buf) {
+		bt_audio_voice_ring_release(&gaivoice.afe_ring, size);
+	}
+}
+
 uint32_t rtk_bt_audio_noise_cancellation_data_get(void *buffer, uint32_t size)
 {
-	uint32_t read_size = 0;
-	if (gaivoice.afe_rbuffer) {
-		if (RingBuffer_Available(gaivoice.afe_rbuffer) >= size) {
-			RingBuffer_Read(gaivoice.afe_rbuffer, buffer, size);
-			read_size = size;
-		}
+	void *frame = rtk_bt_audio_noise_cancellation_frame_get(size);
+
+	if (!frame) {
+		return 0;
 	}
+	memcpy(buffer, frame, size);
+	rtk_bt_audio_noise_cancellation_frame_release(size);
 
-	return read_size;
+	return size;
 }
 
 uint16_t rtk_bt_audio_noise_cancellation_new(uint32_t codec_index, uint32_t channels)
@@ -129,29 +144,16 @@ uint16_t rtk_bt_audio_noise_cancellation_new(uint32_t codec_index, uint32_t chan
 	config.afe = &afe_param;
 	gaivoice.frame_bytes_per_channel = afe_param.frame_size * sizeof(short);
 	if (codec_index == RTK_BT_AUDIO_CODEC_CVSD) {
-		int error;
-		gaivoice.afe_out_8k_buffer = (void *)osif_mem_alloc(RAM_TYPE_DATA_ON, gaivoice.frame_bytes_per_channel / 2);
-		if (!gaivoice.afe_out_8k_buffer) {
-			BT_LOGE("[BT AUDIO] Unable to allocate afe_out_8k_buffer \r\n");
-			return 1;
-		}
-		/* init resample instanse */
-		gaivoice.presampler = speex_resampler_init(
-								  RESAMPLE_CHANNEL,
-								  RESAMPLE_IN_SAMPLE_RATE,
-								  RESAMPLE_OUT_SAMPLE_RATE,
-								  1,
-								  &error);
-		if (error != RESAMPLER_ERR_SUCCESS) {
-			BT_LOGE("[BT AUDIO] Unable to create resampler \r\n");
-			goto fail;
-		}
+		bt_audio_voice_decim_init(&gaivoice.decim);
 	}
-	gaivoice.afe_rbuffer = RingBuffer_Create(NULL, gaivoice.frame_bytes_per_channel * 4, LOCAL_RINGBUFF, 1);
-	if (!gaivoice.afe_rbuffer) {
+	/* a multiple of the 8k and 16k frames, which are then written without wrapping */
+	gaivoice.afe_ring_buf = (uint8_t *)osif_mem_alloc(RAM_TYPE_DATA_ON, gaivoice.frame_bytes_per_channel * AFE_RING_FRAME_NUM);
+	gaivoice.bounce_buffer = osif_mem_alloc(RAM_TYPE_DATA_ON, gaivoice.frame_bytes_per_channel);
+	if (!gaivoice.afe_ring_buf || !gaivoice.bounce_buffer) {
 		BT_LOGE("[BT AUDIO] create ringbuffer failed \r\n");
 		goto fail;
 	}
+	bt_audio_voice_ring_init(&gaivoice.afe_ring, gaivoice.afe_ring_buf, gaivoice.frame_bytes_per_channel * AFE_RING_FRAME_NUM);
 
 	void *handle = aivoice->create(&config);
 	if (!handle) {
@@ -168,20 +170,13 @@ uint16_t rtk_bt_audio_noise_cancellation_new(uint32_t codec_index, uint32_t chan
 
 	return 0;
 fail:
-	if (gaivoice.afe_rbuffer) {
-		RingBuffer_Destroy(gaivoice.afe_rbuffer);
-		gaivoice.afe_rbuffer = NULL;
+	if (gaivoice.afe_ring_buf) {
+		osif_mem_free(gaivoice.afe_ring_buf);
+		gaivoice.afe_ring_buf = NULL;
 	}
-	if (codec_index == RTK_BT_AUDIO_CODEC_CVSD) {
-		if (gaivoice.afe_out_8k_buffer) {
-			osif_mem_free(gaivoice.afe_out_8k_buffer);
-			gaivoice.afe_out_8k_buffer = NULL;
-		}
-		if (gaivoice.presampler) {
-			speex_resampler_destroy(gaivoice.presampler);
-			gaivoice.presampler = NULL;
-		}
-		gaivoice.codec_index = RTK_BT_AUDIO_CODEC_MAX;
+	if (gaivoice.bounce_buffer) {
+		osif_mem_free(gaivoice.bounce_buffer);
+		gaivoice.bounce_buffer = NULL;
 	}
 
 	return 1;
@@ -206,21 +201,15 @@ uint16_t rtk_bt_audio_noise_cancellation_destroy(void)
 		gaivoice.iface->destroy(gaivoice.handle);
 		gaivoice.iface = NULL;
 		gaivoice.handle = NULL;
-		if (gaivoice.afe_rbuffer) {
-			RingBuffer_Destroy(gaivoice.afe_rbuffer);
-			gaivoice.afe_rbuffer = NULL;
+		if (gaivoice.afe_ring_buf) {
+			osif_mem_free(gaivoice.afe_ring_buf);
+			gaivoice.afe_ring_buf = NULL;
 		}
-		if (gaivoice.codec_index == RTK_BT_AUDIO_CODEC_CVSD) {
-			if (gaivoice.afe_out_8k_buffer) {
-				osif_mem_free(gaivoice.afe_out_8k_buffer);
-				gaivoice.afe_out_8k_buffer = NULL;
-			}
-			if (gaivoice.presampler) {
-				speex_resampler_destroy(gaivoice.presampler);
-				gaivoice.presampler = NULL;
-			}
-			gaivoice.codec_index = RTK_BT_AUDIO_CODEC_MAX;
+		if (gaivoice.bounce_buffer) {
+			osif_mem_free(gaivoice.bounce_buffer);
+			gaivoice.bounce_buffer = NULL;
 		}
+		gaivoice.codec_index = RTK_BT_AUDIO_CODEC_MAX;
 	}
 	BT_LOGE("[BT AUDIO] aivoice instance is destroyed \r\n");
 
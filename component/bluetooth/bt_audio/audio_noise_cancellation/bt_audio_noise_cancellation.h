@@ -48,6 +48,21 @@ int rtk_bt_audio_noise_cancellation_feed(void *data, uint32_t bytes);
  */
 uint32_t rtk_bt_audio_noise_cancellation_data_get(void *buffer, uint32_t size);
 
+/**
+ * @brief     get noise cancellation handled data in place, so the encoder reads it from the ring.
+ * @param[in] size: voice data length, at most one AFE frame
+ * @return
+ *            pointer of voice data valid until rtk_bt_audio_noise_cancellation_frame_release,
+ *            NULL if less than size bytes are handled
+ */
+void *rtk_bt_audio_noise_cancellation_frame_get(uint32_t size);
+
+/**
+ * @brief     release the voice data from rtk_bt_audio_noise_cancellation_frame_get.
+ * @param[in] size: voice data length
+ */
+void rtk_bt_audio_noise_cancellation_frame_release(uint32_t size);
+
 /**
  * @brief     destory noise cancellation interface
  * @param[in] none
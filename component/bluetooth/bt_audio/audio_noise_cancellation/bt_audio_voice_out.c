@@ -0,0 +1,134 @@
+/*
+*******************************************************************************
+* Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+*/
+#include <string.h>
+#include "bt_audio_voice_out.h"
+
+/*
+ * Half-band low pass of 39 taps in Q15, least squares fit flat to 3.5 kHz at 16k. The center tap is
+ * 0.5 and every other side tap is zero, so an 8k output sample costs 10 multiplies of pre-added
+ * symmetric pairs. -6 dB at 4 kHz, below -46 dB from 4.6 kHz.
+ */
+static const int16_t bt_audio_voice_decim_coef[BT_AUDIO_VOICE_DECIM_COEF_NUM] = {
+	10384, -3339, 1862, -1189, 792, -529, 345, -215, 124, -61
+};
+
+/* p is the first of BT_AUDIO_VOICE_DECIM_HIST_NUM + 1 input samples, the center is in the middle */
+static inline int16_t bt_audio_voice_decim_one(const int16_t *p)
+{
+	const int16_t *c = p + BT_AUDIO_VOICE_DECIM_HIST_NUM / 2;
+	int32_t acc = (int32_t)c[0] << 14;
+	uint32_t i;
+
+	for (i = 0; i < BT_AUDIO_VOICE_DECIM_COEF_NUM; i++) {
+		acc += (int32_t)bt_audio_voice_decim_coef[i] * ((int32_t)c[-(int32_t)(2 * i + 1)] + c[2 * i + 1]);
+	}
+	acc = (acc + (1 << 14)) >> 15;
+	if (acc > 32767) {
+		acc = 32767;
+	} else if (acc < -32768) {
+		acc = -32768;
+	}
+
+	return (int16_t)acc;
+}
+
+void bt_audio_voice_decim_init(struct bt_audio_voice_decim *decim)
+{
+	memset(decim->hist, 0, sizeof(decim->hist));
+}
+
+void bt_audio_voice_decim_process(struct bt_audio_voice_decim *decim, const int16_t *in,
+								  uint32_t in_samples, int16_t *out)
+{
+	int16_t stitch[2 * BT_AUDIO_VOICE_DECIM_HIST_NUM];
+	uint32_t k;
+
+	/* output k ends on input 2k + 1, the first ones reach back into the previous frame */
+	memcpy(stitch, decim->hist, sizeof(decim->hist));
+	memcpy(stitch + BT_AUDIO_VOICE_DECIM_HIST_NUM, in, sizeof(decim->hist));
+	for (k = 0; k < BT_AUDIO_VOICE_DECIM_HIST_NUM / 2; k++) {
+		out[k] = bt_audio_voice_decim_one(stitch + 2 * k + 1);
+	}
+	for (; k < in_samples / 2; k++) {
+		out[k] = bt_audio_voice_decim_one(in + 2 * k + 1 - BT_AUDIO_VOICE_DECIM_HIST_NUM);
+	}
+	memcpy(decim->hist, in + in_samples - BT_AUDIO_VOICE_DECIM_HIST_NUM, sizeof(decim->hist));
+}
+
+void bt_audio_voice_ring_init(struct bt_audio_voice_ring *ring, uint8_t *buf, uint32_t size)
+{
+	ring->buf = buf;
+	ring->size = size;
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+static uint32_t bt_audio_voice_ring_used(struct bt_audio_voice_ring *ring, uint32_t head, uint32_t tail)
+{
+	return (head >= tail) ? head - tail : head + 2 * ring->size - tail;
+}
+
+static uint32_t bt_audio_voice_ring_offset(struct bt_audio_voice_ring *ring, uint32_t pos)
+{
+	return (pos >= ring->size) ? pos - ring->size : pos;
+}
+
+static uint32_t bt_audio_voice_ring_advance(struct bt_audio_voice_ring *ring, uint32_t pos, uint32_t len)
+{
+	pos += len;
+	return (pos >= 2 * ring->size) ? pos - 2 * ring->size : pos;
+}
+
+uint32_t bt_audio_voice_ring_available(struct bt_audio_voice_ring *ring)
+{
+	return bt_audio_voice_ring_used(ring, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+}
+
+void *bt_audio_voice_ring_reserve(struct bt_audio_voice_ring *ring, uint32_t len)
+{
+	uint32_t head = ring->head;
+	uint32_t offset = bt_audio_voice_ring_offset(ring, head);
+
+	if (ring->size - bt_audio_voice_ring_used(ring, head, __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) < len) {
+		return NULL;
+	}
+	/* frames of a size dividing the ring never wrap */
+	if (offset + len > ring->size) {
+		return NULL;
+	}
+
+	return ring->buf + offset;
+}
+
+void bt_audio_voice_ring_commit(struct bt_audio_voice_ring *ring, uint32_t len)
+{
+	__atomic_store_n(&ring->head, bt_audio_voice_ring_advance(ring, ring->head, len), __ATOMIC_RELEASE);
+}
+
+const void *bt_audio_voice_ring_peek(struct bt_audio_voice_ring *ring, uint32_t len, void *bounce)
+{
+	uint32_t tail = ring->tail;
+	uint32_t offset = bt_audio_voice_ring_offset(ring, tail);
+	uint32_t first;
+
+	if (bt_audio_voice_ring_used(ring, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), tail) < len) {
+		return NULL;
+	}
+	if (offset + len <= ring->size) {
+		return ring->buf + offset;
+	}
+
+	first = ring->size - offset;
+	memcpy(bounce, ring->buf + offset, first);
+	memcpy((uint8_t *)bounce + first, ring->buf, len - first);
+
+	return bounce;
+}
+
+void bt_audio_voice_ring_release(struct bt_audio_voice_ring *ring, uint32_t len)
+{
+	__atomic_store_n(&ring->tail, bt_audio_voice_ring_advance(ring, ring->tail, len), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,115 @@
+/*
+*******************************************************************************
+* Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+*/
+
+#ifndef __BT_AUDIO_VOICE_OUT_H__
+#define __BT_AUDIO_VOICE_OUT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* unique side coefficients of the half-band filter, 4 * 10 - 1 = 39 taps */
+#define BT_AUDIO_VOICE_DECIM_COEF_NUM   10
+/* input samples kept between frames, the span of the filter less one */
+#define BT_AUDIO_VOICE_DECIM_HIST_NUM   (4 * BT_AUDIO_VOICE_DECIM_COEF_NUM - 2)
+
+/**
+ * @struct    bt_audio_voice_decim
+ * @brief     16k to 8k decimator of the voice output, a symmetric half-band FIR of which only the
+ *            output samples are computed.
+ */
+struct bt_audio_voice_decim {
+	int16_t hist[BT_AUDIO_VOICE_DECIM_HIST_NUM];
+};
+
+/**
+ * @struct    bt_audio_voice_ring
+ * @brief     Single producer single consumer byte ring of voice frames, written and read in place.
+ *            head and tail wrap at twice the size, so a full ring differs from an empty one
+ *            for any size. The size is a multiple of the frame the producer reserves.
+ */
+struct bt_audio_voice_ring {
+	uint8_t *buf;
+	uint32_t size;
+	uint32_t head;                      /* bytes committed by the producer, modulo 2 * size */
+	uint32_t tail;                      /* bytes released by the consumer, modulo 2 * size */
+};
+
+/**
+ * @brief     reset the decimator history to silence.
+ * @param[in] decim: decimator
+ */
+void bt_audio_voice_decim_init(struct bt_audio_voice_decim *decim);
+
+/**
+ * @brief     decimate a frame from 16k to 8k.
+ * @param[in] decim: decimator
+ * @param[in] in: 16k samples
+ * @param[in] in_samples: number of 16k samples, even and at least BT_AUDIO_VOICE_DECIM_HIST_NUM
+ * @param[out] out: in_samples / 2 8k samples, may be the reserved space of a ring
+ */
+void bt_audio_voice_decim_process(struct bt_audio_voice_decim *decim, const int16_t *in,
+								  uint32_t in_samples, int16_t *out);
+
+/**
+ * @brief     initialize an empty ring.
+ * @param[in] ring: ring
+ * @param[in] buf: memory of the ring
+ * @param[in] size: bytes of buf
+ */
+void bt_audio_voice_ring_init(struct bt_audio_voice_ring *ring, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief     bytes committed and not released.
+ * @param[in] ring: ring
+ * @return
+ *            bytes available to the consumer
+ */
+uint32_t bt_audio_voice_ring_available(struct bt_audio_voice_ring *ring);
+
+/**
+ * @brief     reserve contiguous space for the producer to write a frame in.
+ * @param[in] ring: ring
+ * @param[in] len: frame length
+ * @return
+ *            space of len bytes, NULL if the ring is full
+ */
+void *bt_audio_voice_ring_reserve(struct bt_audio_voice_ring *ring, uint32_t len);
+
+/**
+ * @brief     publish the frame written in the space from @ref bt_audio_voice_ring_reserve.
+ * @param[in] ring: ring
+ * @param[in] len: frame length
+ */
+void bt_audio_voice_ring_commit(struct bt_audio_voice_ring *ring, uint32_t len);
+
+/**
+ * @brief     look at the oldest len bytes in place, they are copied to bounce only when they wrap
+ *            around the end of the ring.
+ * @param[in] ring: ring
+ * @param[in] len: bytes to read
+ * @param[in] bounce: at least len bytes
+ * @return
+ *            the bytes, valid until @ref bt_audio_voice_ring_release, NULL if fewer are available
+ */
+const void *bt_audio_voice_ring_peek(struct bt_audio_voice_ring *ring, uint32_t len, void *bounce);
+
+/**
+ * @brief     give the bytes from @ref bt_audio_voice_ring_peek back to the producer.
+ * @param[in] ring: ring
+ * @param[in] len: bytes read
+ */
+void bt_audio_voice_ring_release(struct bt_audio_voice_ring *ring, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BT_AUDIO_VOICE_OUT_H__ */
@@ -5,6 +5,7 @@
 */
 #include <bt_api_config.h>
 #include <stdio.h>
+#include <string.h>
 #include <osif.h>
 #include <bt_audio_codec_wrapper.h>
 #include <bt_audio_debug.h>
@@ -14,6 +15,51 @@
 #include <lc3_codec_entity.h>
 #include <cvsd_codec_entity.h>
 
+#define BT_AUDIO_CODEC_RING_MASK (BT_AUDIO_CODEC_RING_SLOT_NUM - 1)
+
+/* the ring functions are called with the entity mutex taken */
+static bool bt_audio_codec_ring_put(struct bt_audio_codec_ring *ring, void *buffer)
+{
+	if ((uint16_t)(ring->head - ring->tail) >= BT_AUDIO_CODEC_RING_SLOT_NUM) {
+		return false;
+	}
+	ring->slot[ring->head & BT_AUDIO_CODEC_RING_MASK] = buffer;
+	ring->head++;
+
+	return true;
+}
+
+/* buffers are mostly freed in the order they were got,
+   otherwise the slot of the freed buffer is given to the oldest one */
+static bool bt_audio_codec_ring_take(struct bt_audio_codec_ring *ring, void *buffer)
+{
+	for (uint16_t i = ring->tail; i != ring->head; i++) {
+		if (ring->slot[i & BT_AUDIO_CODEC_RING_MASK] == buffer) {
+			ring->slot[i & BT_AUDIO_CODEC_RING_MASK] = ring->slot[ring->tail & BT_AUDIO_CODEC_RING_MASK];
+			ring->tail++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool bt_audio_codec_ring_find(struct bt_audio_codec_ring *ring, void *buffer)
+{
+	for (uint16_t i = ring->tail; i != ring->head; i++) {
+		if (ring->slot[i & BT_AUDIO_CODEC_RING_MASK] == buffer) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static uint16_t bt_audio_codec_ring_count(struct bt_audio_codec_ring *ring)
+{
+	return (uint16_t)(ring->head - ring->tail);
+}
+
 /* bt_audio_handle_media_data_packet should be invoked before decode */
 uint16_t bt_audio_handle_media_data_packet(PAUDIO_CODEC_ENTITY pentity,
 										   uint8_t *packet,
@@ -66,6 +112,59 @@ uint16_t bt_audio_decode_process_data(PAUDIO_CODEC_ENTITY pentity,
 	return RTK_BT_AUDIO_OK;
 }
 
+uint16_t bt_audio_decode_process_frames(PAUDIO_CODEC_ENTITY pentity,
+										uint8_t *data,
+										uint32_t frame_size,
+										uint8_t frame_num,
+										int16_t *pcm,
+										uint32_t pcm_size,
+										uint32_t *ppcm_frame_size, struct audio_param *paudio_param)
+{
+	struct dec_codec_buffer *pbuffer = NULL;
+	uint32_t pcm_offset = 0;
+	uint32_t pcm_len = 0;
+	uint16_t ret = RTK_BT_AUDIO_OK;
+
+	if (!pentity) {
+		BT_LOGE("[BT_AUDIO] Find match codec entity fail \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
+	if (!pentity->active_flag) {
+		BT_LOGE("[BT_AUDIO] codec entity is not active \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
+	if (!pcm || !ppcm_frame_size) {
+		BT_LOGE("[BT_AUDIO] pcm buffer is NULL \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
+	osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
+	for (uint8_t i = 0; i < frame_num; i++) {
+		ppcm_frame_size[i] = 0;
+		/* the buffer never leaves the wrapper, it is not put in decode_ring */
+		pbuffer = pentity->get_decode_buffer((void *)pentity);
+		if (!pbuffer) {
+			BT_LOGE("[BT_AUDIO] get decode buffer fail ! \r\n");
+			ret = RTK_BT_AUDIO_FAIL;
+			continue;
+		}
+		if (pentity->decoding_func((void *)pentity, data ? &data[i * frame_size] : NULL, frame_size, pbuffer, &pcm_len, paudio_param)) {
+			BT_LOGE("[BT_AUDIO] decode fail ! \r\n");
+			ret = RTK_BT_AUDIO_FAIL;
+		} else if (pcm_len > pcm_size - pcm_offset) {
+			BT_LOGE("[BT_AUDIO] pcm buffer too small for frame %d ! \r\n", (int)i);
+			ret = RTK_BT_AUDIO_FAIL;
+		} else {
+			memcpy((void *)((uint8_t *)pcm + pcm_offset), (void *)pbuffer->pbuffer, pcm_len);
+			pcm_offset += pcm_len;
+			ppcm_frame_size[i] = pcm_len;
+		}
+		pentity->free_decode_buffer((void *)pentity, pbuffer);
+	}
+	osif_mutex_give(pentity->mutex);
+
+	return ret;
+}
+
 struct dec_codec_buffer *bt_audio_get_decode_buffer(PAUDIO_CODEC_ENTITY pentity)
 {
 	struct dec_codec_buffer *pbuffer = NULL;
@@ -79,13 +178,22 @@ struct dec_codec_buffer *bt_audio_get_decode_buffer(PAUDIO_CODEC_ENTITY pentity)
 		return NULL;
 	}
 	osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
+	/* checked again under the mutex, bt_audio_unregister_codec may have cleared it meanwhile */
+	if (!pentity->active_flag) {
+		osif_mutex_give(pentity->mutex);
+		return NULL;
+	}
 	pbuffer = pentity->get_decode_buffer((void *)pentity);
 	if (!pbuffer) {
 		BT_LOGE("[BT_AUDIO] get decode buffer fail ! \r\n");
 		osif_mutex_give(pentity->mutex);
 		return NULL;
 	}
-	pentity->decode_lock = true;
+	if (!bt_audio_codec_ring_put(&pentity->decode_ring, (void *)pbuffer)) {
+		BT_LOGE("[BT_AUDIO] too many decode buffers in use ! \r\n");
+		pentity->free_decode_buffer((void *)pentity, pbuffer);
+		pbuffer = NULL;
+	}
 	osif_mutex_give(pentity->mutex);
 
 	return pbuffer;
@@ -98,8 +206,14 @@ uint16_t bt_audio_free_decode_buffer(PAUDIO_CODEC_ENTITY pentity, struct dec_cod
 		return RTK_BT_AUDIO_FAIL;
 	}
 	osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
+	if (!bt_audio_codec_ring_find(&pentity->decode_ring, (void *)buffer)) {
+		osif_mutex_give(pentity->mutex);
+		BT_LOGE("[BT_AUDIO] decode buffer is not in use \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
 	pentity->free_decode_buffer((void *)pentity, buffer);
-	pentity->decode_lock = false;
+	/* bt_audio_unregister_codec reads the count under the mutex, it sees the buffer freed */
+	bt_audio_codec_ring_take(&pentity->decode_ring, (void *)buffer);
 	osif_mutex_give(pentity->mutex);
 
 	return RTK_BT_AUDIO_OK;
@@ -131,6 +245,60 @@ uint16_t bt_audio_encode_process_data(PAUDIO_CODEC_ENTITY pentity,
 	return RTK_BT_AUDIO_OK;
 }
 
+uint16_t bt_audio_encode_process_frames(PAUDIO_CODEC_ENTITY pentity,
+										int16_t *pcm,
+										uint32_t pcm_frame_size,
+										uint8_t frame_num,
+										uint8_t *out,
+										uint32_t out_size,
+										uint32_t *pout_frame_size)
+{
+	struct enc_codec_buffer *pbuffer = NULL;
+	uint32_t out_offset = 0;
+	uint32_t actual_len = 0;
+	uint8_t encoded_num = 0;
+	uint16_t ret = RTK_BT_AUDIO_OK;
+
+	if (!pentity) {
+		BT_LOGE("[BT_AUDIO] Find match codec entity fail \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
+	if (!pentity->active_flag) {
+		BT_LOGE("[BT_AUDIO] codec entity is not active \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
+	if (!pcm || !out || !pout_frame_size) {
+		BT_LOGE("[BT_AUDIO] pcm or out buffer is NULL \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
+	osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
+	for (uint8_t i = 0; i < frame_num; i++) {
+		pout_frame_size[i] = 0;
+		/* the buffer never leaves the wrapper, it is not put in encode_ring */
+		pbuffer = pentity->get_encode_buffer((void *)pentity);
+		if (!pbuffer) {
+			BT_LOGE("[BT_AUDIO] get encode buffer fail ! \r\n");
+			ret = RTK_BT_AUDIO_FAIL;
+			continue;
+		}
+		if (pentity->encoding_func((void *)pentity, (int16_t *)((uint8_t *)pcm + i * pcm_frame_size), pcm_frame_size, pbuffer, &encoded_num, &actual_len)) {
+			BT_LOGE("[BT_AUDIO] encode fail ! \r\n");
+			ret = RTK_BT_AUDIO_FAIL;
+		} else if (actual_len > out_size - out_offset) {
+			BT_LOGE("[BT_AUDIO] out buffer too small for frame %d ! \r\n", (int)i);
+			ret = RTK_BT_AUDIO_FAIL;
+		} else {
+			memcpy((void *)(out + out_offset), (void *)pbuffer->pbuffer, actual_len);
+			out_offset += actual_len;
+			pout_frame_size[i] = actual_len;
+		}
+		pentity->free_encode_buffer((void *)pentity, pbuffer);
+	}
+	osif_mutex_give(pentity->mutex);
+
+	return ret;
+}
+
 struct enc_codec_buffer *bt_audio_get_encode_buffer(PAUDIO_CODEC_ENTITY pentity)
 {
 	struct enc_codec_buffer *pbuffer = NULL;
@@ -144,13 +312,22 @@ struct enc_codec_buffer *bt_audio_get_encode_buffer(PAUDIO_CODEC_ENTITY pentity)
 		return NULL;
 	}
 	osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
+	/* checked again under the mutex, bt_audio_unregister_codec may have cleared it meanwhile */
+	if (!pentity->active_flag) {
+		osif_mutex_give(pentity->mutex);
+		return NULL;
+	}
 	pbuffer = pentity->get_encode_buffer((void *)pentity);
 	if (pbuffer == NULL) {
 		BT_LOGE("[BT_AUDIO] get encode buffer fail ! \r\n");
 		osif_mutex_give(pentity->mutex);
 		return NULL;
 	}
-	pentity->encode_lock = true;
+	if (!bt_audio_codec_ring_put(&pentity->encode_ring, (void *)pbuffer)) {
+		BT_LOGE("[BT_AUDIO] too many encode buffers in use ! \r\n");
+		pentity->free_encode_buffer((void *)pentity, pbuffer);
+		pbuffer = NULL;
+	}
 	osif_mutex_give(pentity->mutex);
 
 	return pbuffer;
@@ -163,8 +340,14 @@ uint16_t bt_audio_free_encode_buffer(PAUDIO_CODEC_ENTITY pentity, struct enc_cod
 		return RTK_BT_AUDIO_FAIL;
 	}
 	osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
+	if (!bt_audio_codec_ring_find(&pentity->encode_ring, (void *)buffer)) {
+		osif_mutex_give(pentity->mutex);
+		BT_LOGE("[BT_AUDIO] encode buffer is not in use \r\n");
+		return RTK_BT_AUDIO_FAIL;
+	}
 	pentity->free_encode_buffer((void *)pentity, buffer);
-	pentity->encode_lock = false;
+	/* bt_audio_unregister_codec reads the count under the mutex, it sees the buffer freed */
+	bt_audio_codec_ring_take(&pentity->encode_ring, (void *)buffer);
 	osif_mutex_give(pentity->mutex);
 
 	return RTK_BT_AUDIO_OK;
@@ -374,12 +557,21 @@ uint16_t bt_audio_unregister_codec(uint32_t type, PAUDIO_CODEC_ENTITY pentity)
 		return RTK_BT_AUDIO_FAIL;
 	}
 	pentity->active_flag = 0;
-	/* wait for decode buffer and encode buffer free */
-	while (pentity->decode_lock || pentity->encode_lock) {
-		BT_LOGE("[BT_AUDIO] wait for decode buffer and encode buffer free,decode_lock=%d,encode_lock=%d\r\n", pentity->decode_lock, pentity->encode_lock);
+	/* wait for decode buffer and encode buffer free, the rings are only read with the mutex taken */
+	while (1) {
+		uint16_t decode_count, encode_count;
+
+		osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
+		decode_count = bt_audio_codec_ring_count(&pentity->decode_ring);
+		encode_count = bt_audio_codec_ring_count(&pentity->encode_ring);
+		if (!decode_count && !encode_count) {
+			break;
+		}
+		osif_mutex_give(pentity->mutex);
+		BT_LOGE("[BT_AUDIO] wait for decode buffer and encode buffer free,decode=%d,encode=%d\r\n",
+				(int)decode_count, (int)encode_count);
 		osif_delay(5);
 	}
-	osif_mutex_take(pentity->mutex, 0xFFFFFFFFUL);
 	pentity->deinit(pentity);
 	osif_mutex_give(pentity->mutex);
 	osif_mutex_delete(pentity->mutex);
@@ -604,8 +604,8 @@ uint16_t rtk_bt_audio_sbc_register(uint32_t type, PAUDIO_CODEC_ENTITY p_entity)
 	p_entity->decoder_num_samples_per_frame = sbc_decoder_num_samples_per_frame;
 	p_entity->decoder_num_channels = sbc_decoder_num_channels;
 	p_entity->decoder_sample_rate = sbc_decoder_sample_rate;
-	p_entity->encode_lock = false;
-	p_entity->decode_lock = false;
+	memset((void *)&p_entity->encode_ring, 0, sizeof(p_entity->encode_ring));
+	memset((void *)&p_entity->decode_ring, 0, sizeof(p_entity->decode_ring));
 	memset((void *)&p_entity->sbc, 0, sizeof(p_entity->sbc));
 	osif_unlock(lock_flag);
 	ret = 0;
@@ -10,6 +10,14 @@
 
 #define BT_AUDIO_CODEC_REG_MAX_PARAM_LEN 128
 #define BT_AUDIO_MAX_DATA_SIZE 1024
+/* buffers an entity can have handed out at the same time, a power of two, getting one more fails
+   until one is freed. Define it in bt_api_config.h for applications holding more buffers */
+#ifndef BT_AUDIO_CODEC_RING_SLOT_NUM
+#define BT_AUDIO_CODEC_RING_SLOT_NUM 8
+#endif
+#if (BT_AUDIO_CODEC_RING_SLOT_NUM & (BT_AUDIO_CODEC_RING_SLOT_NUM - 1))
+#error "BT_AUDIO_CODEC_RING_SLOT_NUM shall be a power of two"
+#endif
 
 struct enc_codec_buffer {
 	struct list_head            list;
@@ -36,6 +44,14 @@ struct dec_codec_buffer {
 	void                        *offload_buffer;
 };
 
+/** @brief codec buffers handed out by an entity, only accessed with the entity mutex taken,
+    so buffers may be got and freed from any task */
+struct bt_audio_codec_ring {
+	void                        *slot[BT_AUDIO_CODEC_RING_SLOT_NUM];
+	uint16_t                    head;              //!< incremented when a buffer is got
+	uint16_t                    tail;              //!< incremented when a buffer is freed
+};
+
 /** @brief application priv obj struct*/
 struct audio_codec_entity_priv {
 	struct list_head            list;
@@ -45,8 +61,8 @@ struct audio_codec_entity_priv {
 	int32_t                     record_num;
 	int32_t                     encode_num;
 	int32_t                     decode_num;
-	bool                        encode_lock;
-	bool                        decode_lock;
+	struct bt_audio_codec_ring  encode_ring;
+	struct bt_audio_codec_ring  decode_ring;
 	uint32_t                    type;
 	int                         stream_in_num;     //!< indicate application enqueue data/command num.
 	union {
@@ -223,10 +239,28 @@ uint16_t bt_audio_handle_media_data_packet(PAUDIO_CODEC_ENTITY pentity,
 uint16_t bt_audio_decode_process_data(PAUDIO_CODEC_ENTITY pentity, struct dec_codec_buffer *pdecoder_buffer, uint8_t *data, uint32_t size, uint32_t *ppcm_size,
 									  struct audio_param *paudio_param);
 
+/**
+ * @brief     decode frames of a media packet to pcm, the entity is locked once for all frames
+ * @param[in] pentity:codec entity
+ * @param[in] data: poniter to the first frame
+ * @param[in] frame_size: size of each frame
+ * @param[in] frame_num: frame number
+ * @param[in] pcm: pcm buffer, the pcm of the decoded frames is written back to back
+ * @param[in] pcm_size: pcm buffer size(In bytes)
+ * @param[in] ppcm_frame_size: array of frame_num, pcm length of each frame, 0 for a frame which is not decoded
+ * @param[in] paudio_param: audio parameter
+ * @return
+ *                              - 0  : Succeed
+ *                              - others: Error code, some frames are not decoded
+ */
+uint16_t bt_audio_decode_process_frames(PAUDIO_CODEC_ENTITY pentity, uint8_t *data, uint32_t frame_size, uint8_t frame_num, int16_t *pcm, uint32_t pcm_size,
+										uint32_t *ppcm_frame_size, struct audio_param *paudio_param);
+
 /**
  * @brief     get decode buffer from specific application memory management
  * @param[in] pentity:codec entity
- * @return buffer: point to buffer , NULL: allocate fail
+ * @return buffer: point to buffer , NULL: allocate fail, or BT_AUDIO_CODEC_RING_SLOT_NUM(8 by default)
+ *         buffers of the entity are not freed yet
  */
 struct dec_codec_buffer *bt_audio_get_decode_buffer(PAUDIO_CODEC_ENTITY pentity);
 
@@ -255,10 +289,27 @@ uint16_t bt_audio_free_decode_buffer(PAUDIO_CODEC_ENTITY pentity, struct dec_cod
 uint16_t bt_audio_encode_process_data(PAUDIO_CODEC_ENTITY pentity, struct enc_codec_buffer *pencoder_buffer, int16_t *data, uint32_t size, uint8_t *p_frame_num,
 									  uint32_t *p_actual_len);
 
+/**
+ * @brief     encode pcm frames, the entity is locked once for all frames
+ * @param[in] pentity:codec entity
+ * @param[in] pcm: pcm buffer, pcm frames back to back
+ * @param[in] pcm_frame_size: size of each pcm frame(In bytes)
+ * @param[in] frame_num: pcm frame number
+ * @param[in] out: buffer the encoded data of all pcm frames is written to back to back
+ * @param[in] out_size: out buffer size
+ * @param[in] pout_frame_size: array of frame_num, encoded length of each pcm frame, 0 for a frame which is not encoded
+ * @return
+ *                              - 0  : Succeed
+ *                              - others: Error code, some frames are not encoded
+ */
+uint16_t bt_audio_encode_process_frames(PAUDIO_CODEC_ENTITY pentity, int16_t *pcm, uint32_t pcm_frame_size, uint8_t frame_num, uint8_t *out, uint32_t out_size,
+										uint32_t *pout_frame_size);
+
 /**
  * @brief     get encode buffer from specific application memory management
  * @param[in] pentity:codec entity
- * @return buffer: point to buffer , NULL: allocate fail
+ * @return buffer: point to buffer , NULL: allocate fail, or BT_AUDIO_CODEC_RING_SLOT_NUM(8 by default)
+ *         buffers of the entity are not freed yet
  */
 struct enc_codec_buffer *bt_audio_get_encode_buffer(PAUDIO_CODEC_ENTITY pentity);
 
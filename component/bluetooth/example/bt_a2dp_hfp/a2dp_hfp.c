@@ -2472,7 +2472,6 @@ static uint16_t rtk_bt_hfp_sbc_parse_decoder_struct(rtk_bt_hfp_codec_t *phfp_cod
 
 #if defined(CONFIG_BT_AUDIO_NOISE_CANCELLATION) && CONFIG_BT_AUDIO_NOISE_CANCELLATION
 static int16_t record_buffer[MAX_RECORD_FRAME_SAMPLES_PER_CHANNLE * AUDIO_RECORD_CHANNELS] = {0};
-static int16_t nc_buffer[MAX_RECORD_FRAME_SAMPLES_PER_CHANNLE * AUDIO_RECORD_CHANNELS] = {0};
 
 static void nc_task_entry(void *ctx)
 {
@@ -2496,6 +2495,8 @@ static void hfp_task_entry(void *ctx)
 	(void)ctx;
 	struct enc_codec_buffer *penc_codec_buffer_t = NULL;
 	rtk_bt_hfp_sco_data_send_t sco_data_t = {0};
+	void *pnc_frame = NULL;
+	uint32_t nc_frame_size = 0;
 
 	hfp_task.run = 1;
 	osif_sem_give(hfp_task.sem);
@@ -2504,10 +2505,12 @@ static void hfp_task_entry(void *ctx)
 		if (bt_hfp_demo_sco_send_sem) {
 			osif_sem_take(bt_hfp_demo_sco_send_sem, BT_TIMEOUT_FOREVER);
 		}
-		if (rtk_bt_audio_noise_cancellation_data_get(nc_buffer,
-													 audio_hfp_codec_conf.codec_index == RTK_BT_AUDIO_CODEC_CVSD ? BT_ENCODE_FRAME_BYTES : (2 * BT_ENCODE_FRAME_BYTES))) {
-			penc_codec_buffer_t = rtk_bt_audio_data_encode(audio_hfp_codec_conf.codec_index, hfp_demo_codec_entity,
-														   nc_buffer, audio_hfp_codec_conf.codec_index == RTK_BT_AUDIO_CODEC_CVSD ? BT_ENCODE_FRAME_BYTES : (2 * BT_ENCODE_FRAME_BYTES));
+		nc_frame_size = audio_hfp_codec_conf.codec_index == RTK_BT_AUDIO_CODEC_CVSD ? BT_ENCODE_FRAME_BYTES : (2 * BT_ENCODE_FRAME_BYTES);
+		pnc_frame = rtk_bt_audio_noise_cancellation_frame_get(nc_frame_size);
+		if (pnc_frame) {
+			/* encode straight from the noise cancellation output */
+			penc_codec_buffer_t = rtk_bt_audio_data_encode(audio_hfp_codec_conf.codec_index, hfp_demo_codec_entity, pnc_frame, nc_frame_size);
+			rtk_bt_audio_noise_cancellation_frame_release(nc_frame_size);
 			if (!penc_codec_buffer_t) {
 				BT_LOGE("[HFP]get encode buffer fail \r\n");
 				continue;
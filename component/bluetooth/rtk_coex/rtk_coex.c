@@ -21,30 +21,124 @@
 struct rtk_bt_coex_priv_t *p_rtk_bt_coex_priv = NULL;
 bool bt_coex_initialized = false;
 
+#define BT_COEX_CONN_HASH(handle)          ((handle) & (BT_COEX_CONN_HASH_NUM - 1))
+#define BT_COEX_PROFILE_HASH(handle, cid)  (((cid) ^ ((handle) << 2)) & (BT_COEX_PROFILE_HASH_NUM - 1))
+
 static struct rtk_bt_coex_conn_t  *bt_coex_find_link_by_handle(uint16_t conn_handle)
 {
-	bool b_find = false;
-	struct list_head *plist = NULL;
+	struct rtk_bt_coex_conn_t *p_conn = p_rtk_bt_coex_priv->conn_hash[BT_COEX_CONN_HASH(conn_handle)];
+
+	while (p_conn && (p_conn->conn_handle & 0xFFF) != conn_handle) {
+		p_conn = p_conn->hash_next;
+	}
+
+	return p_conn;
+}
+
+static struct rtk_bt_coex_conn_t *bt_coex_add_link(uint16_t conn_handle)
+{
 	struct rtk_bt_coex_conn_t *p_conn = NULL;
+	uint8_t i;
 
-	if (!list_empty(&p_rtk_bt_coex_priv->conn_list)) {
-		plist = p_rtk_bt_coex_priv->conn_list.next;
-		while (plist != &p_rtk_bt_coex_priv->conn_list) {
-			p_conn = (struct rtk_bt_coex_conn_t *)plist;
-			if ((p_conn->conn_handle & 0xFFF) == conn_handle) {
-				b_find = true;
-				break;
-			} else {
-				plist = plist->next;
-			}
-		}
+	p_conn = (struct rtk_bt_coex_conn_t *) osif_mem_alloc(RAM_TYPE_DATA_ON, sizeof(struct rtk_bt_coex_conn_t));
+	if (!p_conn) {
+		return NULL;
 	}
+	memset(p_conn, 0, sizeof(struct rtk_bt_coex_conn_t));
+	p_conn->conn_handle = conn_handle;
+	INIT_LIST_HEAD(&p_conn->profile_list);
+	for (i = 0; i < BT_COEX_MONITOR_NUM; i++) {
+		INIT_LIST_HEAD(&p_conn->monitor[i].list);
+		p_conn->monitor[i].p_conn = p_conn;
+		p_conn->monitor[i].profile_idx = (i == BT_COEX_MONITOR_A2DP) ? PROFILE_A2DP : PROFILE_PAN;
+	}
+	list_add_tail(&p_conn->list, &p_rtk_bt_coex_priv->conn_list);
+	p_conn->hash_next = p_rtk_bt_coex_priv->conn_hash[BT_COEX_CONN_HASH(conn_handle & 0xFFF)];
+	p_rtk_bt_coex_priv->conn_hash[BT_COEX_CONN_HASH(conn_handle & 0xFFF)] = p_conn;
 
-	if (b_find) {
-		return p_conn;
+	return p_conn;
+}
+
+static void bt_coex_del_link(struct rtk_bt_coex_conn_t *p_conn)
+{
+	struct rtk_bt_coex_conn_t **pp_conn = &p_rtk_bt_coex_priv->conn_hash[BT_COEX_CONN_HASH(p_conn->conn_handle & 0xFFF)];
+	uint8_t i;
+
+	/* the monitor nodes go with the link, whatever the profile refcounts say */
+	osif_mutex_take(p_rtk_bt_coex_priv->monitor_mutex, 0xFFFFFFFFUL);
+	for (i = 0; i < BT_COEX_MONITOR_NUM; i++) {
+		list_del_init(&p_conn->monitor[i].list);
+	}
+	osif_mutex_give(p_rtk_bt_coex_priv->monitor_mutex);
+
+	while (*pp_conn && *pp_conn != p_conn) {
+		pp_conn = &(*pp_conn)->hash_next;
+	}
+	if (*pp_conn) {
+		*pp_conn = p_conn->hash_next;
+	}
+	list_del(&p_conn->list);
+	osif_mem_free(p_conn);
+}
+
+/* channel the ACL data of dir arrives on: rx data carries our scid, tx data the peer dcid */
+static struct rtk_bt_coex_profile_info_t *bt_coex_find_profile_by_cid(struct rtk_bt_coex_conn_t *p_conn, uint16_t cid, uint8_t dir)
+{
+	uint16_t conn_handle = p_conn->conn_handle;
+	struct rtk_bt_coex_profile_info_t *p_profile = p_rtk_bt_coex_priv->profile_hash[dir][BT_COEX_PROFILE_HASH(conn_handle, cid)];
+
+	while (p_profile && (p_profile->conn_handle != conn_handle || (dir == DIR_IN ? p_profile->scid : p_profile->dcid) != cid)) {
+		p_profile = p_profile->hash_next[dir];
+	}
+
+	return p_profile;
+}
+
+static void bt_coex_profile_unhash(struct rtk_bt_coex_profile_info_t *p_profile, uint8_t dir)
+{
+	uint16_t cid = (dir == DIR_IN) ? p_profile->scid : p_profile->dcid;
+	struct rtk_bt_coex_profile_info_t **pp_profile = NULL;
+
+	if (cid == 0) {
+		return;
+	}
+
+	pp_profile = &p_rtk_bt_coex_priv->profile_hash[dir][BT_COEX_PROFILE_HASH(p_profile->conn_handle, cid)];
+	while (*pp_profile && *pp_profile != p_profile) {
+		pp_profile = &(*pp_profile)->hash_next[dir];
+	}
+	if (*pp_profile) {
+		*pp_profile = p_profile->hash_next[dir];
+	}
+	p_profile->hash_next[dir] = NULL;
+}
+
+/* set scid (DIR_IN) or dcid (DIR_OUT) and keep the profile indexed under it, a zero cid is not indexed */
+static void bt_coex_profile_set_cid(struct rtk_bt_coex_profile_info_t *p_profile, uint8_t dir, uint16_t cid)
+{
+	struct rtk_bt_coex_profile_info_t **pp_head = NULL;
+
+	bt_coex_profile_unhash(p_profile, dir);
+	if (dir == DIR_IN) {
+		p_profile->scid = cid;
 	} else {
-		return NULL;
+		p_profile->dcid = cid;
+	}
+	if (cid == 0) {
+		return;
 	}
+
+	pp_head = &p_rtk_bt_coex_priv->profile_hash[dir][BT_COEX_PROFILE_HASH(p_profile->conn_handle, cid)];
+	p_profile->hash_next[dir] = *pp_head;
+	*pp_head = p_profile;
+}
+
+static void bt_coex_del_profile(struct rtk_bt_coex_profile_info_t *p_profile)
+{
+	bt_coex_profile_unhash(p_profile, DIR_IN);
+	bt_coex_profile_unhash(p_profile, DIR_OUT);
+	list_del(&p_profile->list);
+	osif_mem_free(p_profile);
 }
 
 static void bt_coex_send_vendor_cmd(uint16_t cmd_id, uint8_t *pbuf, uint8_t len)
@@ -137,15 +231,8 @@ static void bt_coex_setup_check_timer(struct rtk_bt_coex_conn_t *p_conn, uint16_
 		return;
 	}
 
-	p_monitor_node = (struct rtk_bt_coex_monitor_node_t *)osif_mem_alloc(RAM_TYPE_DATA_ON, sizeof(struct rtk_bt_coex_monitor_node_t));
-	if (!p_monitor_node) {
-		return;
-	}
-
-
+	p_monitor_node = &p_conn->monitor[(profile_idx == PROFILE_A2DP) ? BT_COEX_MONITOR_A2DP : BT_COEX_MONITOR_PAN];
 	p_monitor_node->b_first_add = 1;
-	p_monitor_node->p_conn = p_conn;
-	p_monitor_node->profile_idx = profile_idx;
 
 	p_conn->a2dp_cnt = 0;
 	p_conn->a2dp_pre_cnt = 0;
@@ -153,42 +240,21 @@ static void bt_coex_setup_check_timer(struct rtk_bt_coex_conn_t *p_conn, uint16_
 	p_conn->pan_pre_cnt = 0;
 
 	osif_mutex_take(p_rtk_bt_coex_priv->monitor_mutex, 0xFFFFFFFFUL);
-	list_add_tail(&p_monitor_node->list, &p_rtk_bt_coex_priv->monitor_list);
+	if (list_empty(&p_monitor_node->list)) {
+		list_add_tail(&p_monitor_node->list, &p_rtk_bt_coex_priv->monitor_list);
+	}
 	osif_mutex_give(p_rtk_bt_coex_priv->monitor_mutex);
 }
 
 static void bt_coex_del_check_timer(struct rtk_bt_coex_conn_t *p_conn, uint16_t profile_idx)
 {
-	struct rtk_bt_coex_monitor_node_t *p_monitor_node = NULL;
-	struct list_head *plist = NULL;
-
 	if (profile_idx != PROFILE_A2DP && profile_idx != PROFILE_PAN) {
 		return;
 	}
 
 	osif_mutex_take(p_rtk_bt_coex_priv->monitor_mutex, 0xFFFFFFFFUL);
-	if (!list_empty(&p_rtk_bt_coex_priv->monitor_list)) {
-		plist = p_rtk_bt_coex_priv->monitor_list.next;
-		while (plist != &p_rtk_bt_coex_priv->monitor_list) {
-			p_monitor_node = (struct rtk_bt_coex_monitor_node_t *)plist;
-			if ((p_monitor_node->p_conn == p_conn) && (p_monitor_node->profile_idx == profile_idx)) {
-				break;
-			} else {
-				plist = plist->next;
-			}
-		}
-	}
+	list_del_init(&p_conn->monitor[(profile_idx == PROFILE_A2DP) ? BT_COEX_MONITOR_A2DP : BT_COEX_MONITOR_PAN].list);
 	osif_mutex_give(p_rtk_bt_coex_priv->monitor_mutex);
-
-	if (!p_monitor_node) {
-		return;
-	}
-
-	osif_mutex_take(p_rtk_bt_coex_priv->monitor_mutex, 0xFFFFFFFFUL);
-	list_del(&p_monitor_node->list);
-	osif_mutex_give(p_rtk_bt_coex_priv->monitor_mutex);
-
-	osif_mem_free(p_monitor_node);
 }
 
 static void bt_coex_update_profile_info(struct rtk_bt_coex_conn_t *p_conn, uint8_t profile_index, bool b_is_add)
@@ -245,14 +311,10 @@ static void bt_coex_handle_connection_complet_evt(uint8_t *p_evt_data)
 
 	if (!p_conn) {
 		DBG_BT_COEX("bt_coex_handle_connection_complet_evt: alloc new connection \r\n");
-		p_conn = (struct rtk_bt_coex_conn_t *) osif_mem_alloc(RAM_TYPE_DATA_ON, sizeof(struct rtk_bt_coex_conn_t));
+		p_conn = bt_coex_add_link(conn_handle);
 		if (!p_conn) {
 			return;
 		}
-		memset(p_conn, 0, sizeof(struct rtk_bt_coex_conn_t));
-		p_conn->conn_handle = conn_handle;
-		INIT_LIST_HEAD(&p_conn->profile_list);
-		list_add_tail(&p_conn->list, &p_rtk_bt_coex_priv->conn_list);
 	}
 
 	p_conn->profile_bitmap = 0;
@@ -295,8 +357,7 @@ static void bt_coex_handle_disconnection_complete_evt(uint8_t *pdata)
 				p_profile = (struct rtk_bt_coex_profile_info_t *)plist;
 				bt_coex_update_profile_info(p_conn, p_profile->idx, false);
 				plist = plist->next;
-				list_del(&p_profile->list);
-				osif_mem_free(p_profile);
+				bt_coex_del_profile(p_profile);
 			}
 		}
 		break;
@@ -313,8 +374,7 @@ static void bt_coex_handle_disconnection_complete_evt(uint8_t *pdata)
 		break;
 	}
 
-	list_del(&p_conn->list);
-	osif_mem_free(p_conn);
+	bt_coex_del_link(p_conn);
 
 	DBG_BT_COEX("exit bt_coex_handle_disconnection_complete_evt \r\n");
 }
@@ -342,14 +402,10 @@ static void bt_coex_le_connect_complete_evt(uint8_t enhance, uint8_t *pdata)
 	p_conn = bt_coex_find_link_by_handle(conn_handle);
 
 	if (!p_conn) {
-		p_conn = (struct rtk_bt_coex_conn_t *) osif_mem_alloc(RAM_TYPE_DATA_ON, sizeof(struct rtk_bt_coex_conn_t));
+		p_conn = bt_coex_add_link(conn_handle);
 		if (!p_conn) {
 			return;
 		}
-		memset(p_conn, 0, sizeof(struct rtk_bt_coex_conn_t));
-		p_conn->conn_handle = conn_handle;
-		INIT_LIST_HEAD(&p_conn->profile_list);
-		list_add_tail(&p_conn->list, &p_rtk_bt_coex_priv->conn_list);
 	}
 
 	p_conn->profile_bitmap = 0;
@@ -414,14 +470,10 @@ static void rtk_handle_le_cis_established_evt(uint8_t *pdata)
 
 	p_conn = bt_coex_find_link_by_handle(conn_handle);
 	if (!p_conn) {
-		p_conn = (struct rtk_bt_coex_conn_t *) osif_mem_alloc(RAM_TYPE_DATA_ON, sizeof(struct rtk_bt_coex_conn_t));
+		p_conn = bt_coex_add_link(conn_handle);
 		if (!p_conn) {
 			return;
 		}
-		memset(p_conn, 0, sizeof(struct rtk_bt_coex_conn_t));
-		p_conn->conn_handle = conn_handle;
-		INIT_LIST_HEAD(&p_conn->profile_list);
-		list_add_tail(&p_conn->list, &p_rtk_bt_coex_priv->conn_list);
 	}
 
 	p_conn->profile_bitmap = 0;
@@ -449,14 +501,10 @@ static void rtk_handle_le_big_complete_evt(uint8_t *pdata)
 
 	p_conn = bt_coex_find_link_by_handle((uint16_t)big_handle);
 	if (!p_conn) {
-		p_conn = (struct rtk_bt_coex_conn_t *) osif_mem_alloc(RAM_TYPE_DATA_ON, sizeof(struct rtk_bt_coex_conn_t));
+		p_conn = bt_coex_add_link(big_handle);
 		if (!p_conn) {
 			return;
 		}
-		memset(p_conn, 0, sizeof(struct rtk_bt_coex_conn_t));
-		p_conn->conn_handle = big_handle;
-		INIT_LIST_HEAD(&p_conn->profile_list);
-		list_add_tail(&p_conn->list, &p_rtk_bt_coex_priv->conn_list);
 	}
 
 	p_conn->profile_bitmap = 0;
@@ -482,8 +530,7 @@ static void rtk_handle_le_terminate_big_complete_evt(uint8_t *pdata)
 		if (p_conn->profile_bitmap & BIT(PROFILE_LE_AUDIO)) {
 			bt_coex_update_profile_info(p_conn, PROFILE_LE_AUDIO, false);
 		}
-		list_del(&p_conn->list);
-		osif_mem_free(p_conn);
+		bt_coex_del_link(p_conn);
 	}
 }
 
@@ -504,14 +551,10 @@ static void rtk_handle_le_big_sync_establish_evt(uint8_t *pdata)
 
 	p_conn = bt_coex_find_link_by_handle((uint16_t)big_handle);
 	if (!p_conn) {
-		p_conn = (struct rtk_bt_coex_conn_t *) osif_mem_alloc(RAM_TYPE_DATA_ON, sizeof(struct rtk_bt_coex_conn_t));
+		p_conn = bt_coex_add_link(big_handle);
 		if (!p_conn) {
 			return;
 		}
-		memset(p_conn, 0, sizeof(struct rtk_bt_coex_conn_t));
-		p_conn->conn_handle = big_handle;
-		INIT_LIST_HEAD(&p_conn->profile_list);
-		list_add_tail(&p_conn->list, &p_rtk_bt_coex_priv->conn_list);
 	}
 
 	p_conn->profile_bitmap = 0;
@@ -537,8 +580,7 @@ static void rtk_handle_le_big_sync_lost_evt(uint8_t *pdata)
 		if (p_conn->profile_bitmap & BIT(PROFILE_LE_AUDIO)) {
 			bt_coex_update_profile_info(p_conn, PROFILE_LE_AUDIO, false);
 		}
-		list_del(&p_conn->list);
-		osif_mem_free(p_conn);
+		bt_coex_del_link(p_conn);
 	}
 }
 
@@ -684,16 +726,7 @@ static struct rtk_bt_coex_profile_info_t *bt_coex_find_profile(struct rtk_bt_coe
 					DBG_BT_COEX("bt_coex_find_profile for tx l2cap connect req: dir %d, p_profile->scid = 0x%x\r\n", dir, p_profile->scid);
 					break;
 				}
-			} else if (scid == 0) { /* for packet_counter_handle */
-				if ((dir == DIR_IN) && (dcid == p_profile->scid)) {
-					b_find = true;
-					break;
-				}
-				if ((dir == DIR_OUT) && (dcid == p_profile->dcid)) {
-					b_find = true;
-					break;
-				}
-			} else { /* for l2cap connect rsp */
+			} else { /* for l2cap connect rsp, data packets go through bt_coex_find_profile_by_cid */
 				if ((dir == DIR_IN) && (scid == p_profile->scid)) {
 					b_find = true;
 					DBG_BT_COEX("bt_coex_find_profile for rx l2cap connect rsp: dir %d, p_profile->scid = 0x%x\r\n", dir, p_profile->scid);
@@ -743,13 +776,14 @@ static void bt_coex_handle_l2cap_conn_req(struct rtk_bt_coex_conn_t *p_conn, uin
 
 	memset(p_profile, 0, sizeof(struct rtk_bt_coex_profile_info_t));
 
+	p_profile->conn_handle = p_conn->conn_handle;
 	p_profile->psm = psm;
 	p_profile->idx = idx;
 
 	if (dir == DIR_OUT) {
-		p_profile->scid = scid;
+		bt_coex_profile_set_cid(p_profile, DIR_IN, scid);
 	} else if (dir == DIR_IN) {
-		p_profile->dcid = scid;
+		bt_coex_profile_set_cid(p_profile, DIR_OUT, scid);
 	}
 
 	if (psm == PSM_AVDTP) {
@@ -793,9 +827,9 @@ static void bt_coex_handle_l2cap_conn_rsp(struct rtk_bt_coex_conn_t *p_conn, uin
 
 	if (!res) {
 		if (dir == DIR_IN) {
-			p_profile->dcid = dcid;
+			bt_coex_profile_set_cid(p_profile, DIR_OUT, dcid);
 		} else if (dir == DIR_OUT) {
-			p_profile->scid = dcid;
+			bt_coex_profile_set_cid(p_profile, DIR_IN, dcid);
 		}
 
 		DBG_BT_COEX("bt_coex_handle_l2cap_conn_rsp: idx = 0x%x, scid = 0x%x, dcid = 0x%x\r\n", p_profile->idx, p_profile->scid, p_profile->dcid);
@@ -854,8 +888,7 @@ static void bt_coex_handle_handle_l2cap_dis_conn_req(struct rtk_bt_coex_conn_t *
 	DBG_BT_COEX("bt_coex_handle_handle_l2cap_dis_conn_req: p_profile->idx = 0x%x \r\n", p_profile->idx);
 	bt_coex_update_profile_info(p_conn, p_profile->idx, false);
 
-	list_del(&p_profile->list);
-	osif_mem_free(p_profile);
+	bt_coex_del_profile(p_profile);
 }
 
 
@@ -892,7 +925,7 @@ static void bt_coex_packet_counter_handle(struct rtk_bt_coex_conn_t *p_conn, uin
 {
 	struct rtk_bt_coex_profile_info_t *p_profile = NULL;
 
-	p_profile = bt_coex_find_profile(p_conn, 0, cid, dir);
+	p_profile = bt_coex_find_profile_by_cid(p_conn, cid, dir);
 
 	if (!p_profile) {
 		return;
@@ -948,12 +981,13 @@ static void bt_coex_process_acl_data(uint8_t *pdata, uint16_t len, uint8_t dir)
 
 	conn_handle = conn_handle & 0xFFF;
 
-	p_conn = bt_coex_find_link_by_handle(conn_handle);
-	if (!p_conn) {
+	/* continuation fragments carry no L2CAP header */
+	if (flags == 0x01) {
 		return;
 	}
 
-	if (flags == 0x01) {
+	p_conn = bt_coex_find_link_by_handle(conn_handle);
+	if (!p_conn) {
 		return;
 	}
 
@@ -1444,7 +1478,7 @@ void bt_coex_send_w2b_sw_mailbox(uint8_t *user_data, uint16_t length)
 						connect_timeout = bt_coex_count_setup_link_timeout(bt_coex_get_max_connect_intvl());
 						DBG_BT_COEX("setup_link_timer start(conn_to=%d)\r\n", connect_timeout);
 						if ((p_rtk_bt_coex_priv->setup_link_timer == NULL) && (connect_timeout > 0)) {
-							if (true == osif_timer_create(&p_rtk_bt_coex_priv->setup_link_timer, "bt_coex_setup_link_timer", NULL, connect_timeout, false,
+							if (true == osif_timer_create(&p_rtk_bt_coex_priv->setup_link_timer, "bt_coex_setup_link_timer", 0, connect_timeout, false,
 														  bt_coex_setup_link_timer_handler)) {
 								osif_timer_start(&p_rtk_bt_coex_priv->setup_link_timer);
 							} else {
@@ -1541,7 +1575,7 @@ void bt_coex_send_w2b_sw_mailbox(uint8_t *user_data, uint16_t length)
 			return;
 		}
 
-		if (true == osif_timer_create(&p_rtk_bt_coex_priv->monitor_timer, "bt_coex_monitor_timer", NULL, BT_COEX_MONITOR_INTERVAL, true,
+		if (true == osif_timer_create(&p_rtk_bt_coex_priv->monitor_timer, "bt_coex_monitor_timer", 0, BT_COEX_MONITOR_INTERVAL, true,
 									  bt_coex_monitor_timer_handler)) {
 			osif_timer_start(&p_rtk_bt_coex_priv->monitor_timer);
 		}
@@ -1558,7 +1592,6 @@ void bt_coex_send_w2b_sw_mailbox(uint8_t *user_data, uint16_t length)
 	void bt_coex_deinit(void)
 	{
 		struct list_head *plist = NULL;
-		struct rtk_bt_coex_monitor_node_t *p_monitor = NULL;
 		struct rtk_bt_coex_conn_t *p_conn = NULL;
 
 		DBG_BT_COEX("Deinit \r\n");
@@ -1566,25 +1599,12 @@ void bt_coex_send_w2b_sw_mailbox(uint8_t *user_data, uint16_t length)
 
 		osif_timer_stop(&p_rtk_bt_coex_priv->monitor_timer);
 
-		osif_mutex_take(p_rtk_bt_coex_priv->monitor_mutex, 0xFFFFFFFFUL);
-		if (!list_empty(&p_rtk_bt_coex_priv->monitor_list)) {
-			plist = p_rtk_bt_coex_priv->monitor_list.next;
-			while (plist != &p_rtk_bt_coex_priv->monitor_list) {
-				p_monitor = (struct rtk_bt_coex_monitor_node_t *)plist;
-				plist = plist->next;
-				list_del(&p_monitor->list);
-				osif_mem_free(p_monitor);
-			}
-		}
-		osif_mutex_give(p_rtk_bt_coex_priv->monitor_mutex);
-
-		plist = NULL;
+		/* monitor nodes are part of their link and unlinked with it */
 		if (!list_empty(&p_rtk_bt_coex_priv->conn_list)) {
 			plist = p_rtk_bt_coex_priv->conn_list.next;
 			while (plist != &p_rtk_bt_coex_priv->conn_list) {
 				p_conn = (struct rtk_bt_coex_conn_t *)plist;
 				plist = plist->next;
-				list_del(&p_conn->list);
 				{
 					struct list_head *p_profile_list = NULL;
 					struct rtk_bt_coex_profile_info_t *p_profile = NULL;
@@ -1592,11 +1612,10 @@ void bt_coex_send_w2b_sw_mailbox(uint8_t *user_data, uint16_t length)
 					while (p_profile_list != &p_conn->profile_list) {
 						p_profile = (struct rtk_bt_coex_profile_info_t *)p_profile_list;
 						p_profile_list = p_profile_list->next;
-						list_del(&p_profile->list);
-						osif_mem_free(p_profile);
+						bt_coex_del_profile(p_profile);
 					}
 				}
-				osif_mem_free(p_conn);
+				bt_coex_del_link(p_conn);
 			}
 		}
 
@@ -27,6 +27,8 @@
 #define A2DP_MEDIA     0x02
 
 #define BT_COEX_MONITOR_INTERVAL    1000
+#define BT_COEX_CONN_HASH_NUM       8   /* buckets of the handle index, power of 2 */
+#define BT_COEX_PROFILE_HASH_NUM    16  /* buckets of the (handle, cid) index per direction, power of 2 */
 #define BT_LE_BUSY_CONN_INTERVAL    0x10    //20ms, units: 1.25ms
 #define BT_HID_BUSY_INTERVAL        60  //units: 1.25ms
 
@@ -316,6 +318,8 @@ enum rtk_coex_mailbox_mp_report_opcode {
 };
 struct rtk_bt_coex_profile_info_t {
 	struct list_head list;
+	struct rtk_bt_coex_profile_info_t *hash_next[2];    /* chains of profile_hash[DIR_IN] by scid, [DIR_OUT] by dcid */
+	uint16_t conn_handle;
 	uint16_t psm;
 	uint16_t dcid;
 	uint16_t scid;
@@ -323,8 +327,24 @@ struct rtk_bt_coex_profile_info_t {
 	uint8_t  flags;
 };
 
+struct rtk_bt_coex_conn_t;
+
+struct rtk_bt_coex_monitor_node_t {
+	struct list_head list;
+	struct rtk_bt_coex_conn_t *p_conn;
+	uint16_t profile_idx;
+	uint8_t b_first_add;
+};
+
+enum {
+	BT_COEX_MONITOR_A2DP = 0,
+	BT_COEX_MONITOR_PAN = 1,
+	BT_COEX_MONITOR_NUM = 2
+};
+
 struct rtk_bt_coex_conn_t {
 	struct list_head list;
+	struct rtk_bt_coex_conn_t *hash_next;
 	uint16_t conn_handle;
 	uint8_t type;       /* __hci_conn_type：0:l2cap, 1:sco/esco, 2:le */
 	uint16_t connect_interval;
@@ -336,17 +356,15 @@ struct rtk_bt_coex_conn_t {
 	uint32_t a2dp_pre_cnt;
 	uint32_t pan_cnt;
 	uint32_t pan_pre_cnt;
-};
-
-struct rtk_bt_coex_monitor_node_t {
-	struct list_head list;
-	struct rtk_bt_coex_conn_t *p_conn;
-	uint16_t profile_idx;
-	uint8_t b_first_add;
+	/* linked on monitor_list while the profile is up, counters above are read through p_conn */
+	struct rtk_bt_coex_monitor_node_t monitor[BT_COEX_MONITOR_NUM];
 };
 
 struct rtk_bt_coex_priv_t {
 	struct list_head conn_list;
+	/* the ACL path looks links and channels up here, conn_list and profile_list stay for the rare walks */
+	struct rtk_bt_coex_conn_t *conn_hash[BT_COEX_CONN_HASH_NUM];
+	struct rtk_bt_coex_profile_info_t *profile_hash[2][BT_COEX_PROFILE_HASH_NUM];
 	struct list_head monitor_list;
 	void *monitor_mutex;
 	void *monitor_timer;
@@ -17,6 +17,7 @@
 #include "app_msg.h"
 #include "generic_types.h"
 #include "blob_client_app.h"
+#include "blob_client_sched.h"
 // RTK porting:for RTK_BT_MESH_IO_MSG_SUBTYPE_xxx define
 #include <rtk_bt_mesh_def.h>
 
@@ -29,6 +30,13 @@
 #define BLOB_BLOCK_GET_RETRY_PERIOD                 2000
 #define BLOB_BLOCK_TRANSFER_CANCEL_PERIOD           2000
 #define BLOB_BLOCK_REPORT_PERIOD                    ((30 * 2 + 7) * 1000)
+/* servers answer a group message within 500 ms, the others are asked one by one after this */
+#define BLOB_GROUP_STATUS_PERIOD                    1000
+
+/* chunk pacing, servers reassemble MESH_TRANS_RX_CTX_COUNT segmented messages at the same time */
+#define BLOB_CHUNK_WINDOW_MAX                       2
+#define BLOB_CHUNK_INTERVAL_STEP                    50
+#define BLOB_CHUNK_INTERVAL_MAX                     800
 
 /* transfer capabilities */
 #define BLOB_CLIENT_MTU                             376
@@ -52,6 +60,7 @@ typedef struct _blob_recvs_node_t
     uint16_t *pmissing_chunks;
     uint16_t current_missing_chunks_len;
     blob_node_phase_t node_phase;
+    uint8_t sched_index;
 } blob_recvs_node_t, *blob_recvs_node_p;
 
 typedef enum
@@ -94,8 +103,10 @@ struct
     uint16_t chunk_size;
     uint16_t current_total_chunks;
     uint16_t current_chunk_size;
-    uint8_t *sending_chunks;
-    uint8_t current_sending_chunks_len;
+    blob_sched_t sched;
+    uint8_t *psched_buf;                // Space will be allocated
+    plt_timer_t pace_timer;
+    bool group_status;                  // block start or block get sent to the multicast addr
 } blob_client_ctx;
 
 // RTK porting:do not need extern xxx_handle
@@ -257,9 +268,26 @@ void blob_recvs_node_clear_all(void)
     blob_recvs_node_p pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
     while (pnode)
     {
+        /* the delete frees the node */
+        blob_recvs_node_p pnext = pnode->pnext;
         blob_recvs_node_delete_by_addr(pnode->addr);
+        pnode = pnext;
+    }
+}
+
+static blob_recvs_node_t *blob_recvs_node_get_by_sched_index(uint8_t sched_index)
+{
+    blob_recvs_node_p pnode = (blob_recvs_node_t *)blob_client_ctx.blob_recvs_list.pfirst;
+    while (pnode != NULL)
+    {
+        if (pnode->sched_index == sched_index)
+        {
+            return pnode;
+        }
         pnode = pnode->pnext;
     }
+
+    return NULL;
 }
 
 #if 0
@@ -394,6 +422,41 @@ void blob_client_retry_timer_stop(void)
     }
 }
 
+void blob_client_pace_timeout(void *pargs)
+{
+    (void)pargs;
+    bt_stack_msg_send(IO_MSG_TYPE_LE_MESH, RTK_BT_MESH_IO_MSG_SUBTYPE_BLOB_CLIENT_CHUNK_TRANSFER, NULL);
+}
+
+static bool blob_client_pace_timer_start(uint32_t period_ms)
+{
+    if (NULL == blob_client_ctx.pace_timer)
+    {
+        blob_client_ctx.pace_timer = plt_timer_create("blob_pc", period_ms, false, 0,
+                                                      blob_client_pace_timeout);
+        if (NULL == blob_client_ctx.pace_timer)
+        {
+            printe("blob_client_pace_timer_start: create blob pace timer failed!");
+            return false;
+        }
+        plt_timer_start(blob_client_ctx.pace_timer, 0);
+    }
+    else
+    {
+        plt_timer_change_period(blob_client_ctx.pace_timer, period_ms, 0);
+    }
+    return true;
+}
+
+static void blob_client_pace_timer_stop(void)
+{
+    if (blob_client_ctx.pace_timer)
+    {
+        plt_timer_delete(blob_client_ctx.pace_timer, 0);
+        blob_client_ctx.pace_timer = NULL;
+    }
+}
+
 static bool blob_client_blob_init(uint32_t blob_size, blob_transfer_mode_t transfer_mode,
                                   bool skip_caps_retrieve)
 {
@@ -607,13 +670,38 @@ INIT:
         printe("blob_client_blob_init: block data alloc failed");
         return false;
     }
+
+    /* chunk scheduler over the missing chunks of all nodes */
+    uint8_t node_num = blob_client_ctx.blob_recvs_list.count;
+    uint16_t max_total_chunks = BLOB_DIV_ROUND_UP(blob_client_ctx.block_size,
+                                                  blob_client_ctx.chunk_size);
+    blob_sched_param_t sched_param;
+    sched_param.window_max = BLOB_CHUNK_WINDOW_MAX;
+    sched_param.group_tx_times = mesh_node.trans_retrans_count + 1;
+    sched_param.interval_step = BLOB_CHUNK_INTERVAL_STEP;
+    sched_param.interval_max = BLOB_CHUNK_INTERVAL_MAX;
+    if (blob_client_ctx.psched_buf != NULL)
+    {
+        plt_free(blob_client_ctx.psched_buf, RAM_TYPE_DATA_ON);
+    }
+    blob_client_ctx.psched_buf = plt_zalloc(blob_sched_mem_size(node_num, max_total_chunks),
+                                            RAM_TYPE_DATA_ON);
+    if (!blob_client_ctx.psched_buf ||
+        !blob_sched_init(&blob_client_ctx.sched, blob_client_ctx.psched_buf, node_num,
+                         max_total_chunks, &sched_param))
+    {
+        printe("blob_client_blob_init: chunk scheduler init failed, node num %d", node_num);
+        return false;
+    }
+
     printi("blob_client_blob_init: blob size %d, block size log %d, total blocks %d, max chunk size %d, max total chunks %d, transfer node",
            blob_client_ctx.blob_size, blob_client_ctx.block_size_log, blob_client_ctx.total_blocks,
-           blob_client_ctx.chunk_size, BLOB_DIV_ROUND_UP(blob_client_ctx.block_size,
-                                                         blob_client_ctx.chunk_size));
+           blob_client_ctx.chunk_size, max_total_chunks);
     pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
+    node_num = 0;
     while (pnode)
     {
+        pnode->sched_index = node_num++;
         printi("addr 0x%04x", pnode->addr);
         pnode = pnode->pnext;
     }
@@ -633,10 +721,12 @@ void blob_client_transfer_ctx_clear(void)
         plt_free(blob_client_ctx.pblock_data, RAM_TYPE_DATA_ON);
         blob_client_ctx.pblock_data = NULL;
     }
-    if (blob_client_ctx.sending_chunks != NULL)
+    blob_client_pace_timer_stop();
+    blob_client_ctx.group_status = false;
+    if (blob_client_ctx.psched_buf != NULL)
     {
-        plt_free(blob_client_ctx.sending_chunks, RAM_TYPE_DATA_ON);
-        blob_client_ctx.sending_chunks = NULL;
+        plt_free(blob_client_ctx.psched_buf, RAM_TYPE_DATA_ON);
+        blob_client_ctx.psched_buf = NULL;
     }
 }
 
@@ -744,15 +834,22 @@ static bool blob_client_active_transfer_start_send(void)
     return false;
 }
 
+static bool blob_client_node_block_start_ready(blob_recvs_node_p pnode)
+{
+    return pnode->active &&
+           (pnode->node_phase == BLOB_NODE_PHASE_TRANSFER_STARTED ||
+            pnode->node_phase == BLOB_NODE_PHASE_BLOCK_GETTED ||
+            pnode->node_phase == BLOB_NODE_PHASE_CHUNK_TRANSFERRED);
+}
+
 static bool blob_client_active_block_start_send(void)
 {
     blob_recvs_node_p pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
     while (pnode)
     {
-        if (pnode->active &&
-            (pnode->node_phase == BLOB_NODE_PHASE_TRANSFER_STARTED ||
-             pnode->node_phase == BLOB_NODE_PHASE_BLOCK_GETTED ||
-             pnode->node_phase == BLOB_NODE_PHASE_CHUNK_TRANSFERRED))
+        /* nodes left starting did not answer the block start sent to the multicast addr */
+        if (blob_client_node_block_start_ready(pnode) ||
+            (pnode->active && pnode->node_phase == BLOB_NODE_PHASE_BLOCK_STARTING))
         {
             blob_client_ctx.retry_count = 0;
             blob_client_retry_timer_start(BLOB_BLOCK_START_RETRY_PERIOD);
@@ -776,7 +873,9 @@ static bool blob_client_active_block_get_send(void)
     blob_recvs_node_p pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
     while (pnode)
     {
-        if (pnode->active && pnode->node_phase == BLOB_NODE_PHASE_CHUNK_TRANSFERRING)
+        /* nodes left getting did not answer the block get sent to the multicast addr */
+        if (pnode->active && (pnode->node_phase == BLOB_NODE_PHASE_CHUNK_TRANSFERRING ||
+                              pnode->node_phase == BLOB_NODE_PHASE_BLOCK_GETTING))
         {
             blob_client_ctx.retry_count = 0;
             blob_client_retry_timer_start(BLOB_BLOCK_GET_RETRY_PERIOD);
@@ -793,6 +892,86 @@ static bool blob_client_active_block_get_send(void)
     return false;
 }
 
+/* send block start or block get once to the multicast addr instead of to each node, the nodes
+ * which do not answer within BLOB_GROUP_STATUS_PERIOD are asked one by one afterwards */
+static bool blob_client_group_status_send(void)
+{
+    bool block_start = (blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_START);
+    uint8_t node_num = 0;
+    blob_recvs_node_p pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
+
+    if (!MESH_IS_SUBSCRIBE_ADDR(blob_client_ctx.multicast_addr))
+    {
+        return false;
+    }
+
+    while (pnode)
+    {
+        if (block_start ? blob_client_node_block_start_ready(pnode) :
+            (pnode->active && pnode->node_phase == BLOB_NODE_PHASE_CHUNK_TRANSFERRING))
+        {
+            node_num++;
+        }
+        pnode = pnode->pnext;
+    }
+    if (node_num < 2)
+    {
+        /* a single node answers a unicast message sooner */
+        return false;
+    }
+
+    pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
+    while (pnode)
+    {
+        if (block_start && blob_client_node_block_start_ready(pnode))
+        {
+            pnode->node_phase = BLOB_NODE_PHASE_BLOCK_STARTING;
+        }
+        else if (!block_start && pnode->active &&
+                 pnode->node_phase == BLOB_NODE_PHASE_CHUNK_TRANSFERRING)
+        {
+            pnode->node_phase = BLOB_NODE_PHASE_BLOCK_GETTING;
+        }
+        pnode = pnode->pnext;
+    }
+
+    blob_client_ctx.group_status = true;
+    blob_client_ctx.pcur_recvs_node = NULL;
+    blob_client_ctx.retry_count = 0;
+    blob_client_retry_timer_start(BLOB_GROUP_STATUS_PERIOD);
+    if (block_start)
+    {
+        printi("blob block start: multicast addr 0x%04x, node num %d, app key index %d, block num %d, chunk size %d",
+               blob_client_ctx.multicast_addr, node_num, blob_client_ctx.app_key_index,
+               blob_client_ctx.block_num, blob_client_ctx.chunk_size);
+        blob_block_start(blob_client_ctx.multicast_addr, blob_client_ctx.app_key_index,
+                         blob_client_ctx.block_num, blob_client_ctx.chunk_size);
+    }
+    else
+    {
+        printi("blob block get: multicast addr 0x%04x, node num %d, app key index %d",
+               blob_client_ctx.multicast_addr, node_num, blob_client_ctx.app_key_index);
+        blob_block_get(blob_client_ctx.multicast_addr, blob_client_ctx.app_key_index);
+    }
+    return true;
+}
+
+static bool blob_client_group_status_pending(void)
+{
+    blob_node_phase_t wait_phase = (blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_START) ?
+                                   BLOB_NODE_PHASE_BLOCK_STARTING : BLOB_NODE_PHASE_BLOCK_GETTING;
+    blob_recvs_node_p pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
+    while (pnode)
+    {
+        if (pnode->active && pnode->node_phase == wait_phase)
+        {
+            return true;
+        }
+        pnode = pnode->pnext;
+    }
+    return false;
+}
+
 void blob_client_handle_transfer(bool ret)
 {
     if (blob_client_ctx.blob_client_cb)
@@ -873,81 +1052,122 @@ static void blob_client_block_send(uint16_t block_num)
     /* block start */
     blob_client_ctx.current_total_chunks = BLOB_DIV_ROUND_UP(blob_client_ctx.block_size,
                                                              blob_client_ctx.chunk_size);
-    if (!blob_client_active_block_start_send())
+    blob_client_ctx.group_status = false;
+    if (!blob_client_group_status_send() && !blob_client_active_block_start_send())
     {
         printe("blob_client_block_send: fail, block num %d", block_num);
         blob_client_handle_transfer(false);
     }
 }
 
-void blob_client_active_chunk_transfer(void)
+static uint8_t blob_client_chunk_seg_num(uint16_t chunk_size)
 {
-    uint16_t chunk_num = blob_client_ctx.current_total_chunks;
-    for (uint16_t i = 0; i < blob_client_ctx.current_total_chunks; ++i)
+    /* each segment carries 12 bytes of the access payload and the 4 bytes TransMIC */
+    uint16_t len = ACCESS_OPCODE_SIZE(MESH_MSG_BLOB_CHUNK_TRANSFER) + sizeof(uint16_t) + chunk_size;
+    if (len <= ACCESS_PAYLOAD_UNSEG_MAX_SIZE)
     {
-        if (plt_bit_pool_get(blob_client_ctx.sending_chunks, i))
-        {
-            chunk_num = i;
-            break;
-        }
+        return 1;
     }
+    return BLOB_DIV_ROUND_UP(len + 4, 12);
+}
+
+void blob_client_active_chunk_transfer(void)
+{
+    blob_sched_tx_t tx;
 
-    if (chunk_num == blob_client_ctx.current_total_chunks)
+    if (blob_client_ctx.phase != BLOB_CLIENT_PHASE_BLOB_CHUNK_TRANSFER)
     {
-        printi("blob_client_active_chunk_transfer: no more chunks to transfer");
-        if (blob_client_ctx.transfer_mode == BLOB_TRANSFER_MODE_PUSH)
-        {
-            blob_client_ctx.phase = BLOB_CLIENT_PHASE_BLOB_BLOCK_GET;
-            blob_client_procedure_timer_start();
-            if (!blob_client_active_block_get_send())
-            {
-                printe("blob_client_active_chunk_transfer: no node in list");
-                blob_client_handle_transfer(false);
-            }
-        }
-        else if (blob_client_ctx.transfer_mode == BLOB_TRANSFER_MODE_PULL)
-        {
-            blob_client_retry_timer_start(BLOB_BLOCK_REPORT_PERIOD);
-            if (!blob_client_procedure_timer_is_active())
-            {
-                blob_client_procedure_timer_start();
-            }
-            printi("blob_client_active_chunk_transfer: wait partial block report until block report timer expires or client timer expires");
-        }
+        /* send callback or pacing of a chunk sent before the block status */
+        return;
     }
-    else
+
+    while (blob_sched_next(&blob_client_ctx.sched, &tx))
     {
         /* set chunk data */
-        blob_client_ctx.chunk_num = chunk_num;
-        if (chunk_num == blob_client_ctx.current_total_chunks - 1)
+        blob_client_ctx.chunk_num = tx.chunk_num;
+        if (tx.chunk_num == blob_client_ctx.current_total_chunks - 1)
         {
-            blob_client_ctx.current_chunk_size = blob_client_ctx.block_size - chunk_num *
+            blob_client_ctx.current_chunk_size = blob_client_ctx.block_size - tx.chunk_num *
                                                  blob_client_ctx.chunk_size;
         }
         else
         {
             blob_client_ctx.current_chunk_size = blob_client_ctx.chunk_size;
         }
-        blob_client_ctx.pchunk_data = blob_client_ctx.pblock_data + chunk_num * blob_client_ctx.chunk_size;
-        printi("blob_client_active_chunk_transfer: dst 0x%04x, block num %d/%d, chunk num %d/%d, chunk size %d",
-               blob_client_ctx.multicast_addr, blob_client_ctx.block_num, blob_client_ctx.total_blocks,
-               blob_client_ctx.chunk_num, blob_client_ctx.current_total_chunks,
-               blob_client_ctx.current_chunk_size);
-        blob_recvs_node_p pnode = (blob_recvs_node_p)blob_client_ctx.blob_recvs_list.pfirst;
-        uint16_t dst = MESH_IS_SUBSCRIBE_ADDR(blob_client_ctx.multicast_addr) ?
-                       blob_client_ctx.multicast_addr : pnode->addr;
-        if (MESH_MSG_SEND_CAUSE_SUCCESS == blob_chunk_transfer(dst, blob_client_ctx.app_key_index,
-                                                               blob_client_ctx.chunk_num, blob_client_ctx.pchunk_data,
-                                                               blob_client_ctx.current_chunk_size))
+        blob_client_ctx.pchunk_data = blob_client_ctx.pblock_data + tx.chunk_num * blob_client_ctx.chunk_size;
+
+        uint16_t dst = blob_client_ctx.multicast_addr;
+        if (tx.node_index != BLOB_SCHED_NODE_GROUP)
         {
-            plt_bit_pool_set(blob_client_ctx.sending_chunks, blob_client_ctx.chunk_num, 0);
+            blob_recvs_node_p pnode = blob_recvs_node_get_by_sched_index(tx.node_index);
+            if (pnode == NULL)
+            {
+                /* the receiver left the list, drop its chunks so the round does not pick it again */
+                printe("blob_client_active_chunk_transfer: no receiver for sched index %d, chunk num %d skipped",
+                       tx.node_index, tx.chunk_num);
+                blob_sched_node_remove(&blob_client_ctx.sched, tx.node_index);
+                continue;
+            }
+            dst = pnode->addr;
+        }
+        printi("blob_client_active_chunk_transfer: dst 0x%04x, block num %d/%d, chunk num %d/%d, chunk size %d, need %d, in flight %d",
+               dst, blob_client_ctx.block_num, blob_client_ctx.total_blocks,
+               blob_client_ctx.chunk_num, blob_client_ctx.current_total_chunks,
+               blob_client_ctx.current_chunk_size, blob_client_ctx.sched.pneed[tx.chunk_num],
+               blob_client_ctx.sched.inflight);
+        mesh_msg_send_cause_t cause = blob_chunk_transfer(dst, blob_client_ctx.app_key_index,
+                                                          blob_client_ctx.chunk_num, blob_client_ctx.pchunk_data,
+                                                          blob_client_ctx.current_chunk_size);
+        if (MESH_MSG_SEND_CAUSE_SUCCESS == cause)
+        {
+            blob_sched_tx_commit(&blob_client_ctx.sched, &tx);
+        }
+        else if (blob_client_ctx.sched.inflight > 0 &&
+                 (cause == MESH_MSG_SEND_CAUSE_NO_BUFFER_AVAILABLE ||
+                  cause == MESH_MSG_SEND_CAUSE_NO_MEMORY ||
+                  cause == MESH_MSG_SEND_CAUSE_TRANS_TX_BUSY))
+        {
+            /* continue when a chunk in flight is sent */
+            printw("blob_client_active_chunk_transfer: stack busy %d, in flight %d", cause,
+                   blob_client_ctx.sched.inflight);
+            blob_sched_tx_refused(&blob_client_ctx.sched);
+            return;
         }
         else
         {
-            printe("blob_client_active_chunk_transfer: chunk send failed");
+            printe("blob_client_active_chunk_transfer: chunk send failed %d", cause);
+            blob_client_handle_transfer(false);
+            return;
+        }
+    }
+
+    if (!blob_sched_round_done(&blob_client_ctx.sched))
+    {
+        return;
+    }
+
+    printi("blob_client_active_chunk_transfer: no more chunks to transfer, group %d, unicast %d, window %d, interval %d, loss %d",
+           blob_client_ctx.sched.group_tx_num, blob_client_ctx.sched.unicast_tx_num,
+           blob_client_ctx.sched.window, blob_client_ctx.sched.interval, blob_client_ctx.sched.loss);
+    if (blob_client_ctx.transfer_mode == BLOB_TRANSFER_MODE_PUSH)
+    {
+        blob_client_ctx.phase = BLOB_CLIENT_PHASE_BLOB_BLOCK_GET;
+        blob_client_procedure_timer_start();
+        if (!blob_client_group_status_send() && !blob_client_active_block_get_send())
+        {
+            printe("blob_client_active_chunk_transfer: no node in list");
             blob_client_handle_transfer(false);
         }
     }
+    else if (blob_client_ctx.transfer_mode == BLOB_TRANSFER_MODE_PULL)
+    {
+        blob_client_retry_timer_start(BLOB_BLOCK_REPORT_PERIOD);
+        if (!blob_client_procedure_timer_is_active())
+        {
+            blob_client_procedure_timer_start();
+        }
+        printi("blob_client_active_chunk_transfer: wait partial block report until block report timer expires or client timer expires");
+    }
 }
 
 bool blob_client_blob_transfer(uint16_t multicast_addr, uint8_t app_key_index, uint8_t transfer_ttl,
@@ -1056,6 +1276,7 @@ void blob_client_send_cb(mesh_model_info_p pmodel_info, mesh_msg_send_stat_t sta
 
     if (access_opcode == MESH_MSG_BLOB_CHUNK_TRANSFER)
     {
+        bool lost = false;
         if (stat == MESH_MSG_SEND_STAT_SENT ||
             stat == MESH_MSG_SEND_STAT_ACKED ||
             stat == MESH_MSG_SEND_STAT_ACKED_OBO)
@@ -1072,6 +1293,7 @@ void blob_client_send_cb(mesh_model_info_p pmodel_info, mesh_msg_send_stat_t sta
             else if (MESH_IS_UNICAST_ADDR(blob_client_ctx.multicast_addr))
             {
                 printi("blob_client_send_cb: may fail but this chunk will be retrans in app layer");
+                lost = true;
             }
         }
         else
@@ -1082,6 +1304,14 @@ void blob_client_send_cb(mesh_model_info_p pmodel_info, mesh_msg_send_stat_t sta
             /* stop blob data send procedure ? */
         }
 
+        blob_sched_tx_done(&blob_client_ctx.sched, lost);
+        if (blob_client_ctx.sched.interval > 0 &&
+            blob_client_pace_timer_start(blob_client_ctx.sched.interval))
+        {
+            /* the pace timer sends the next chunk */
+            return;
+        }
+
         // RTK porting:call common API for send T_IO_MSG msg to app main task and process msg through app main task
         if (bt_stack_msg_send(IO_MSG_TYPE_LE_MESH, RTK_BT_MESH_IO_MSG_SUBTYPE_BLOB_CLIENT_CHUNK_TRANSFER, NULL)) {
             printe("blob_client_send_cb: send evt queue fail");
@@ -1102,22 +1332,10 @@ void blob_client_missing_chunks_update(blob_node_phase_t node_phase)
                pnode->node_phase, pnode->current_missing_chunks_len);
         if (pnode->active && pnode->node_phase == node_phase)
         {
-            if (pnode->current_missing_chunks_len == blob_client_ctx.current_total_chunks)
-            {
-                /* missing all chunk */
-                for (uint16_t i = 0; i < blob_client_ctx.current_total_chunks; ++i)
-                {
-                    plt_bit_pool_set(blob_client_ctx.sending_chunks, i, 1);
-                }
-                break;
-            }
-            else
-            {
-                for (uint16_t i = 0; i < pnode->current_missing_chunks_len; ++i)
-                {
-                    plt_bit_pool_set(blob_client_ctx.sending_chunks, pnode->pmissing_chunks[i], 1);
-                }
-            }
+            /* missing all chunk when the length is the total chunks */
+            blob_sched_node_missing_set(&blob_client_ctx.sched, pnode->sched_index,
+                                        (pnode->current_missing_chunks_len == blob_client_ctx.current_total_chunks) ?
+                                        NULL : pnode->pmissing_chunks, pnode->current_missing_chunks_len);
         }
         pnode = pnode->pnext;
     }
@@ -1125,8 +1343,7 @@ void blob_client_missing_chunks_update(blob_node_phase_t node_phase)
 
 uint32_t blob_client_missing_chunks_num_get(void)
 {
-    return plt_bit_pool_count(blob_client_ctx.sending_chunks,
-                              blob_client_ctx.current_sending_chunks_len);
+    return blob_sched_missing_num_get(&blob_client_ctx.sched);
 }
 
 void blob_client_data_send(void)
@@ -1164,23 +1381,15 @@ void blob_client_data_send(void)
     /* all node received blob block start message, start chunk transfer */
     blob_client_ctx.current_total_chunks = BLOB_DIV_ROUND_UP(blob_client_ctx.block_size,
                                                              blob_client_ctx.chunk_size);
-    blob_client_ctx.current_sending_chunks_len = (blob_client_ctx.current_total_chunks % 8) ?
-                                                 (blob_client_ctx.current_total_chunks / 8 + 1) :
-                                                 (blob_client_ctx.current_total_chunks / 8);
-    if (blob_client_ctx.sending_chunks)
-    {
-        plt_free(blob_client_ctx.sending_chunks, RAM_TYPE_DATA_ON);
-        blob_client_ctx.sending_chunks = NULL;
-    }
-    blob_client_ctx.sending_chunks = plt_zalloc(blob_client_ctx.current_sending_chunks_len,
-                                                RAM_TYPE_DATA_ON);
-    if (!blob_client_ctx.sending_chunks)
-    {
-        printe("blob_client_data_send: sending chunks alloc failed");
-        blob_client_handle_transfer(false);
-        return;
-    }
-
+    blob_sched_block_start(&blob_client_ctx.sched, blob_client_ctx.current_total_chunks,
+                           blob_client_chunk_seg_num(blob_client_ctx.chunk_size),
+                           MESH_IS_SUBSCRIBE_ADDR(blob_client_ctx.multicast_addr),
+                           blob_client_ctx.transfer_mode == BLOB_TRANSFER_MODE_PULL);
+    printi("blob_client_data_send: total chunks %d, unicast max %d, window %d, interval %d",
+           blob_client_ctx.current_total_chunks, blob_client_ctx.sched.unicast_max,
+           blob_client_ctx.sched.window, blob_client_ctx.sched.interval);
+
+    blob_client_ctx.group_status = false;
     blob_client_retry_timer_stop();
     blob_client_procedure_timer_stop();
 
@@ -1299,6 +1508,7 @@ void blob_client_handle_missing_chunks(void)
 {
     if (blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_GET)
     {
+        blob_client_ctx.group_status = false;
         blob_client_missing_chunks_update(BLOB_NODE_PHASE_BLOCK_GETTED);
         if (blob_client_missing_chunks_num_get())
         {
@@ -1312,7 +1522,8 @@ void blob_client_handle_missing_chunks(void)
                 }
                 pnode = pnode->pnext;
             }
-            /* continue chunk transfer */
+            /* continue chunk transfer, paced by the chunks the nodes missed in the last round */
+            blob_sched_round_start(&blob_client_ctx.sched);
             blob_client_active_chunk_transfer();
         }
         else
@@ -1391,6 +1602,10 @@ static void blob_client_handle_node_fail(blob_cb_procedure_t procedure, uint16_t
             }
             pnode->active = false;
             pnode->node_phase = BLOB_NODE_PHASE_FAILED;
+            if (blob_client_ctx.psched_buf != NULL)
+            {
+                blob_sched_node_remove(&blob_client_ctx.sched, pnode->sched_index);
+            }
         }
     }
 }
@@ -1594,7 +1809,14 @@ void blob_client_handle_retry_timeout(void)
     }
     else if (blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_START)
     {
-        if (pnode->active && pnode->node_phase == BLOB_NODE_PHASE_BLOCK_STARTING)
+        if (blob_client_ctx.group_status)
+        {
+            /* ask the nodes which did not answer the multicast block start one by one */
+            printi("blob_client_handle_retry_timeout: blob block start to multicast addr 0x%04x not answered by all nodes",
+                   blob_client_ctx.multicast_addr);
+            blob_client_ctx.group_status = false;
+        }
+        else if (pnode->active && pnode->node_phase == BLOB_NODE_PHASE_BLOCK_STARTING)
         {
             if (blob_client_ctx.retry_count >= BLOB_RETRY_TIMES)
             {
@@ -1631,7 +1853,14 @@ void blob_client_handle_retry_timeout(void)
     }
     else if (blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_GET)
     {
-        if (pnode->active && pnode->node_phase == BLOB_NODE_PHASE_BLOCK_GETTING)
+        if (blob_client_ctx.group_status)
+        {
+            /* ask the nodes which did not answer the multicast block get one by one */
+            printi("blob_client_handle_retry_timeout: blob block get to multicast addr 0x%04x not answered by all nodes",
+                   blob_client_ctx.multicast_addr);
+            blob_client_ctx.group_status = false;
+        }
+        else if (pnode->active && pnode->node_phase == BLOB_NODE_PHASE_BLOCK_GETTING)
         {
             if (blob_client_ctx.retry_count >= BLOB_RETRY_TIMES)
             {
@@ -1806,7 +2035,10 @@ int32_t blob_client_app_handle_data(const mesh_model_info_p pmodel_info, uint32_
                 return MODEL_SUCCESS;
             }
 
-            blob_client_retry_timer_stop();
+            if (!blob_client_ctx.group_status && pnode == blob_client_ctx.pcur_recvs_node)
+            {
+                blob_client_retry_timer_stop();
+            }
             pnode->transfer_status = pdata->status;
             if (pdata->status != BLOB_TRANSFER_STATUS_SUCCESS)
             {
@@ -1885,7 +2117,25 @@ int32_t blob_client_app_handle_data(const mesh_model_info_p pmodel_info, uint32_
                 }
             }
 
-            // move on
+            // move on, group_status is only set during block start and block get
+            if (blob_client_ctx.group_status)
+            {
+                if (blob_client_group_status_pending())
+                {
+                    return MODEL_SUCCESS;
+                }
+                /* all nodes answered the multicast message */
+                blob_client_ctx.group_status = false;
+                blob_client_retry_timer_stop();
+            }
+            else if (pnode != blob_client_ctx.pcur_recvs_node &&
+                     (blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_START ||
+                      blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_GET))
+            {
+                /* late answer to a multicast message, the node is not asked again */
+                return MODEL_SUCCESS;
+            }
+
             if (blob_client_ctx.phase == BLOB_CLIENT_PHASE_BLOB_BLOCK_START)
             {
                 if (blob_client_active_block_start_send())
@@ -1946,16 +2196,15 @@ int32_t blob_client_app_handle_data(const mesh_model_info_p pmodel_info, uint32_
                     printi("blob partial block report: 0x%04x missing chunks", pdata->src);
                     dprinti((uint8_t *)pnode->pmissing_chunks, pnode->current_missing_chunks_len * sizeof(uint16_t));
 
-                    uint32_t sending_chunk_num = blob_client_missing_chunks_num_get();
-                    printi("sending chunk num %d", sending_chunk_num);
+                    bool sending_idle = blob_sched_round_done(&blob_client_ctx.sched);
+                    printi("sending chunk num %d, idle %d", blob_client_missing_chunks_num_get(),
+                           sending_idle);
 
                     /* update sending list */
-                    for (uint16_t i = 0; i < pnode->current_missing_chunks_len; ++i)
-                    {
-                        plt_bit_pool_set(blob_client_ctx.sending_chunks, pnode->pmissing_chunks[i], 1);
-                    }
+                    blob_sched_node_missing_set(&blob_client_ctx.sched, pnode->sched_index,
+                                                pnode->pmissing_chunks, pnode->current_missing_chunks_len);
 
-                    if (sending_chunk_num == 0)
+                    if (sending_idle)
                     {
                         blob_client_active_chunk_transfer();
                     }
@@ -0,0 +1,363 @@
+/**
+*********************************************************************************************************
+*               Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+*********************************************************************************************************
+* @file      blob_client_sched.c
+* @brief     Smart mesh blob client chunk scheduler
+* @details
+* @author
+* @date      2024-10-18
+* @version   v1.0
+* *********************************************************************************************************
+*/
+
+#include <string.h>
+#include "blob_client_sched.h"
+
+static bool blob_sched_bit_get(const uint8_t *pool, uint16_t bit)
+{
+    return (pool[bit >> 3] >> (bit & 0x07)) & 0x01;
+}
+
+static void blob_sched_bit_set(uint8_t *pool, uint16_t bit)
+{
+    pool[bit >> 3] |= (uint8_t)(1 << (bit & 0x07));
+}
+
+static void blob_sched_bit_clear(uint8_t *pool, uint16_t bit)
+{
+    pool[bit >> 3] &= (uint8_t)~(1 << (bit & 0x07));
+}
+
+static uint8_t blob_sched_bit_count(uint8_t byte)
+{
+    uint8_t count = 0;
+    while (byte)
+    {
+        byte &= byte - 1;
+        count++;
+    }
+    return count;
+}
+
+static uint8_t *blob_sched_node_bitmap(const blob_sched_t *psched, uint8_t node_index)
+{
+    return psched->pmissing + node_index * psched->bitmap_len;
+}
+
+uint32_t blob_sched_mem_size(uint8_t node_num, uint16_t max_total_chunks)
+{
+    uint32_t bitmap_len = (max_total_chunks + 7) / 8;
+    return node_num * bitmap_len + max_total_chunks + bitmap_len;
+}
+
+bool blob_sched_init(blob_sched_t *psched, uint8_t *pbuf, uint8_t node_num,
+                     uint16_t max_total_chunks, const blob_sched_param_t *pparam)
+{
+    /* node_num is at most BLOB_SCHED_NODE_NUM_MAX by its type, so no index is the group one */
+    if (node_num == 0 || max_total_chunks == 0 || pparam->window_max == 0 || pbuf == NULL)
+    {
+        return false;
+    }
+
+    memset(psched, 0, sizeof(blob_sched_t));
+    psched->param = *pparam;
+    psched->node_num = node_num;
+    psched->max_total_chunks = max_total_chunks;
+    psched->bitmap_len = (max_total_chunks + 7) / 8;
+    psched->pmissing = pbuf;
+    psched->pneed = psched->pmissing + node_num * psched->bitmap_len;
+    psched->psent = psched->pneed + max_total_chunks;
+    /* start at full speed, the first reports slow it down if the receivers lose chunks */
+    psched->window = pparam->window_max;
+    psched->interval = 0;
+    return true;
+}
+
+void blob_sched_block_start(blob_sched_t *psched, uint16_t total_chunks, uint8_t seg_num,
+                            bool group_enable, bool request_mode)
+{
+    psched->total_chunks = MIN(total_chunks, psched->max_total_chunks);
+    psched->seg_num = seg_num;
+    psched->group_enable = group_enable;
+    psched->request_mode = request_mode;
+    memset(psched->pmissing, 0, psched->node_num * psched->bitmap_len);
+    memset(psched->pneed, 0, psched->max_total_chunks);
+    blob_sched_round_start(psched);
+}
+
+static void blob_sched_node_clear(blob_sched_t *psched, uint8_t node_index)
+{
+    uint8_t *pbitmap = blob_sched_node_bitmap(psched, node_index);
+    for (uint16_t i = 0; i < psched->total_chunks; ++i)
+    {
+        if (blob_sched_bit_get(pbitmap, i))
+        {
+            psched->pneed[i]--;
+        }
+    }
+    memset(pbitmap, 0, psched->bitmap_len);
+}
+
+static void blob_sched_node_chunk_add(blob_sched_t *psched, uint8_t *pbitmap, uint16_t chunk_num)
+{
+    if (chunk_num >= psched->total_chunks || blob_sched_bit_get(pbitmap, chunk_num))
+    {
+        return;
+    }
+
+    blob_sched_bit_set(pbitmap, chunk_num);
+    psched->pneed[chunk_num]++;
+    if (psched->request_mode && chunk_num <= psched->cursor)
+    {
+        /* asked again for a chunk the round went past */
+        psched->cursor = chunk_num;
+        psched->node_cursor = 0;
+    }
+}
+
+void blob_sched_node_missing_set(blob_sched_t *psched, uint8_t node_index, const uint16_t *pchunks,
+                                 uint16_t len)
+{
+    if (node_index >= psched->node_num)
+    {
+        return;
+    }
+
+    uint8_t *pbitmap = blob_sched_node_bitmap(psched, node_index);
+    if (!psched->request_mode)
+    {
+        /* chunks sent to the receiver in the last round, and those it still misses */
+        uint32_t sent = 0;
+        uint32_t lost = 0;
+        for (uint16_t i = 0; i < psched->bitmap_len; ++i)
+        {
+            sent += blob_sched_bit_count(psched->psent[i] & pbitmap[i]);
+        }
+        if (pchunks == NULL)
+        {
+            lost = sent;
+        }
+        else
+        {
+            for (uint16_t i = 0; i < len; ++i)
+            {
+                if (pchunks[i] < psched->total_chunks &&
+                    blob_sched_bit_get(psched->psent, pchunks[i]) &&
+                    blob_sched_bit_get(pbitmap, pchunks[i]))
+                {
+                    lost++;
+                }
+            }
+        }
+        psched->round_tx += sent;
+        psched->round_lost += MIN(lost, sent);
+        blob_sched_node_clear(psched, node_index);
+    }
+
+    if (pchunks == NULL)
+    {
+        for (uint16_t i = 0; i < psched->total_chunks; ++i)
+        {
+            blob_sched_node_chunk_add(psched, pbitmap, i);
+        }
+    }
+    else
+    {
+        for (uint16_t i = 0; i < len; ++i)
+        {
+            blob_sched_node_chunk_add(psched, pbitmap, pchunks[i]);
+        }
+    }
+}
+
+void blob_sched_node_remove(blob_sched_t *psched, uint8_t node_index)
+{
+    if (node_index < psched->node_num)
+    {
+        blob_sched_node_clear(psched, node_index);
+    }
+}
+
+uint32_t blob_sched_missing_num_get(const blob_sched_t *psched)
+{
+    uint32_t num = 0;
+    for (uint16_t i = 0; i < psched->total_chunks; ++i)
+    {
+        if (psched->pneed[i])
+        {
+            num++;
+        }
+    }
+    return num;
+}
+
+static void blob_sched_pace_update(blob_sched_t *psched)
+{
+    uint16_t loss = psched->round_lost * 1000 / psched->round_tx;
+    psched->loss = psched->loss_valid ? (psched->loss * 3 + loss) / 4 : loss;
+    psched->loss_valid = true;
+
+    if (psched->loss > BLOB_SCHED_LOSS_HIGH)
+    {
+        /* fewer chunk messages in flight first, then wait between them */
+        if (psched->window > 1)
+        {
+            psched->window /= 2;
+        }
+        else if (psched->interval == 0)
+        {
+            psched->interval = psched->param.interval_step;
+        }
+        else
+        {
+            psched->interval = MIN(psched->interval * 2, psched->param.interval_max);
+        }
+    }
+    else if (psched->loss < BLOB_SCHED_LOSS_LOW)
+    {
+        if (psched->interval > 0)
+        {
+            psched->interval = (psched->interval / 2 >= psched->param.interval_step) ?
+                               psched->interval / 2 : 0;
+        }
+        else if (psched->window < psched->param.window_max)
+        {
+            psched->window++;
+        }
+    }
+}
+
+static void blob_sched_unicast_max_update(blob_sched_t *psched)
+{
+    if (!psched->group_enable)
+    {
+        psched->unicast_max = psched->node_num;
+    }
+    else if (psched->seg_num <= 1)
+    {
+        /* an unsegmented message is not acknowledged, unicast gains nothing */
+        psched->unicast_max = 0;
+    }
+    else
+    {
+        /* air time of a chunk to the group: each segment is sent group_tx_times times, to one
+         * receiver: the segments until they are acknowledged, and the wait for the acknowledgment */
+        uint32_t loss = MIN(psched->loss, 900);
+        uint32_t group_cost = psched->seg_num * psched->param.group_tx_times * 1000;
+        uint32_t unicast_cost = psched->seg_num * 1000000 / (1000 - loss) + BLOB_SCHED_ACK_COST * 1000;
+        psched->unicast_max = MIN(group_cost / unicast_cost, psched->node_num);
+    }
+}
+
+void blob_sched_round_start(blob_sched_t *psched)
+{
+    if (!psched->request_mode && psched->round_tx > 0)
+    {
+        blob_sched_pace_update(psched);
+    }
+    psched->round_tx = 0;
+    psched->round_lost = 0;
+    psched->window_cut = false;
+    blob_sched_unicast_max_update(psched);
+    memset(psched->psent, 0, psched->bitmap_len);
+    psched->cursor = 0;
+    psched->node_cursor = 0;
+}
+
+static bool blob_sched_find(const blob_sched_t *psched, blob_sched_tx_t *ptx)
+{
+    uint16_t chunk_num = psched->cursor;
+    uint8_t node_index = psched->node_cursor;
+    for (; chunk_num < psched->total_chunks; ++chunk_num, node_index = 0)
+    {
+        if (psched->pneed[chunk_num] == 0)
+        {
+            continue;
+        }
+
+        if (psched->group_enable && psched->pneed[chunk_num] > psched->unicast_max)
+        {
+            ptx->chunk_num = chunk_num;
+            ptx->node_index = BLOB_SCHED_NODE_GROUP;
+            return true;
+        }
+
+        for (; node_index < psched->node_num; ++node_index)
+        {
+            if (blob_sched_bit_get(blob_sched_node_bitmap(psched, node_index), chunk_num))
+            {
+                ptx->chunk_num = chunk_num;
+                ptx->node_index = node_index;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool blob_sched_next(blob_sched_t *psched, blob_sched_tx_t *ptx)
+{
+    if (psched->inflight >= psched->window)
+    {
+        return false;
+    }
+    return blob_sched_find(psched, ptx);
+}
+
+void blob_sched_tx_commit(blob_sched_t *psched, const blob_sched_tx_t *ptx)
+{
+    psched->inflight++;
+    blob_sched_bit_set(psched->psent, ptx->chunk_num);
+    if (ptx->node_index == BLOB_SCHED_NODE_GROUP)
+    {
+        psched->group_tx_num++;
+        psched->cursor = ptx->chunk_num + 1;
+        psched->node_cursor = 0;
+        if (psched->request_mode)
+        {
+            for (uint8_t i = 0; i < psched->node_num; ++i)
+            {
+                blob_sched_bit_clear(blob_sched_node_bitmap(psched, i), ptx->chunk_num);
+            }
+            psched->pneed[ptx->chunk_num] = 0;
+        }
+    }
+    else
+    {
+        psched->unicast_tx_num++;
+        psched->cursor = ptx->chunk_num;
+        psched->node_cursor = ptx->node_index + 1;
+        if (psched->request_mode)
+        {
+            blob_sched_bit_clear(blob_sched_node_bitmap(psched, ptx->node_index), ptx->chunk_num);
+            psched->pneed[ptx->chunk_num]--;
+        }
+    }
+}
+
+void blob_sched_tx_refused(blob_sched_t *psched)
+{
+    psched->window = MAX(psched->inflight, 1);
+}
+
+void blob_sched_tx_done(blob_sched_t *psched, bool lost)
+{
+    if (psched->inflight > 0)
+    {
+        psched->inflight--;
+    }
+
+    if (lost && !psched->window_cut && psched->window > 1)
+    {
+        /* a receiver did not acknowledge the segments, do not wait for the status round */
+        psched->window /= 2;
+        psched->window_cut = true;
+    }
+}
+
+bool blob_sched_round_done(const blob_sched_t *psched)
+{
+    blob_sched_tx_t tx;
+    return psched->inflight == 0 && !blob_sched_find(psched, &tx);
+}
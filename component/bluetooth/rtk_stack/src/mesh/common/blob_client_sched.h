@@ -0,0 +1,206 @@
+/**
+*********************************************************************************************************
+*               Copyright(c) 2024, Realtek Semiconductor Corporation. All rights reserved.
+*********************************************************************************************************
+* @file      blob_client_sched.h
+* @brief     Smart mesh blob client chunk scheduler
+* @details   Merges the missing chunks of all receivers of a block, chooses the group address or
+*            unicast addresses for each chunk by how many receivers still need it, and paces the
+*            chunk messages by the loss the receivers report. It only depends on basic types, the
+*            memory is given by the caller.
+* @author
+* @date      2024-10-18
+* @version   v1.0
+* *********************************************************************************************************
+*/
+
+#ifndef _BLOB_CLIENT_SCHED_H
+#define _BLOB_CLIENT_SCHED_H
+
+#include "platform_types.h"
+
+BEGIN_DECLS
+
+/**
+ * @addtogroup BLOB_CLIENT_SCHED
+ * @{
+ */
+
+/** node index of a chunk sent to the group address */
+#define BLOB_SCHED_NODE_GROUP                       0xFF
+#define BLOB_SCHED_NODE_NUM_MAX                     0xFF
+
+/** loss in per mille above which the pace is slowed down, below which it is sped up */
+#define BLOB_SCHED_LOSS_HIGH                        100
+#define BLOB_SCHED_LOSS_LOW                         20
+
+/** segments of air time an acknowledged message costs on top of its segments: the acknowledgment,
+ *  and the acknowledgment timer of the receiver during which the window does not move */
+#define BLOB_SCHED_ACK_COST                         8
+
+typedef struct
+{
+    uint8_t window_max; //!< chunk messages handed to the stack at the same time
+    uint8_t group_tx_times; //!< transmissions of each segment of a message sent to a group address
+    uint16_t interval_step; //!< ms, pacing step
+    uint16_t interval_max; //!< ms, longest wait between two chunk messages
+} blob_sched_param_t;
+
+typedef struct
+{
+    uint16_t chunk_num;
+    uint8_t node_index; //!< @ref BLOB_SCHED_NODE_GROUP or index of the receiver
+} blob_sched_tx_t;
+
+typedef struct
+{
+    blob_sched_param_t param;
+    uint8_t node_num;
+    uint16_t max_total_chunks;
+    uint16_t bitmap_len; //!< bytes of one chunk bitmap
+    uint8_t *pmissing; //!< chunk bitmap of each receiver
+    uint8_t *pneed; //!< count of receivers which miss each chunk
+    uint8_t *psent; //!< chunks sent in this round
+
+    /* current block */
+    uint16_t total_chunks;
+    uint8_t seg_num; //!< segments of one chunk message
+    bool group_enable; //!< false when the receivers have no common group address
+    bool request_mode; //!< pull mode, the receivers ask for chunks and a request is served once
+    uint8_t unicast_max; //!< chunks needed by this many receivers or less are sent by unicast
+    uint16_t cursor;
+    uint8_t node_cursor;
+
+    /* pacing */
+    uint8_t window;
+    uint8_t inflight;
+    uint16_t interval; //!< ms to wait after a chunk message is sent
+    bool window_cut; //!< window already cut in this round
+    bool loss_valid;
+    uint16_t loss; //!< per mille, smoothed over rounds
+    uint32_t round_tx; //!< chunks to receivers sent in this round
+    uint32_t round_lost; //!< and still reported missing
+
+    /* statistics */
+    uint32_t group_tx_num;
+    uint32_t unicast_tx_num;
+} blob_sched_t;
+
+/**
+ * @brief memory needed by the scheduler
+ *
+ * @param[in] node_num: receivers number
+ * @param[in] max_total_chunks: most chunks of a block
+ * @return bytes
+ */
+uint32_t blob_sched_mem_size(uint8_t node_num, uint16_t max_total_chunks);
+
+/**
+ * @brief initialize the scheduler
+ *
+ * @param[in] psched: scheduler
+ * @param[in] pbuf: memory of @ref blob_sched_mem_size bytes
+ * @param[in] node_num: receivers number, at most @ref BLOB_SCHED_NODE_NUM_MAX
+ * @param[in] max_total_chunks: most chunks of a block
+ * @param[in] pparam: pacing parameters
+ * @return true
+ * @return false
+ */
+bool blob_sched_init(blob_sched_t *psched, uint8_t *pbuf, uint8_t node_num,
+                     uint16_t max_total_chunks, const blob_sched_param_t *pparam);
+
+/**
+ * @brief start a block, all receivers miss nothing until they report, the pace is kept
+ *
+ * @param[in] psched: scheduler
+ * @param[in] total_chunks: chunks of the block
+ * @param[in] seg_num: segments of one chunk message
+ * @param[in] group_enable: chunks may be sent to the group address
+ * @param[in] request_mode: pull mode
+ */
+void blob_sched_block_start(blob_sched_t *psched, uint16_t total_chunks, uint8_t seg_num,
+                            bool group_enable, bool request_mode);
+
+/**
+ * @brief set the chunks a receiver misses, in request mode the chunks are added to its requests
+ *        and a request is dropped once the chunk is sent to the receiver
+ *
+ * @param[in] psched: scheduler
+ * @param[in] node_index: receiver
+ * @param[in] pchunks: chunk numbers, NULL for all chunks of the block
+ * @param[in] len: chunk numbers count
+ */
+void blob_sched_node_missing_set(blob_sched_t *psched, uint8_t node_index, const uint16_t *pchunks,
+                                 uint16_t len);
+
+/**
+ * @brief a receiver leaves the transfer
+ *
+ * @param[in] psched: scheduler
+ * @param[in] node_index: receiver
+ */
+void blob_sched_node_remove(blob_sched_t *psched, uint8_t node_index);
+
+/**
+ * @brief chunks which at least one receiver misses
+ *
+ * @param[in] psched: scheduler
+ * @return chunks number
+ */
+uint32_t blob_sched_missing_num_get(const blob_sched_t *psched);
+
+/**
+ * @brief start a new round over the missing chunks, the pace is adapted to the loss the receivers
+ *        reported for the last round
+ *
+ * @param[in] psched: scheduler
+ */
+void blob_sched_round_start(blob_sched_t *psched);
+
+/**
+ * @brief look at the next chunk message of the round
+ *
+ * @param[in] psched: scheduler
+ * @param[out] ptx: chunk and destination
+ * @return false when the window is full or the round has no more chunks
+ */
+bool blob_sched_next(blob_sched_t *psched, blob_sched_tx_t *ptx);
+
+/**
+ * @brief the stack accepted the chunk message from @ref blob_sched_next
+ *
+ * @param[in] psched: scheduler
+ * @param[in] ptx: chunk message
+ */
+void blob_sched_tx_commit(blob_sched_t *psched, const blob_sched_tx_t *ptx);
+
+/**
+ * @brief the stack had no room for the chunk message from @ref blob_sched_next, the window
+ *        shrinks to the messages in flight
+ *
+ * @param[in] psched: scheduler
+ */
+void blob_sched_tx_refused(blob_sched_t *psched);
+
+/**
+ * @brief a chunk message was sent
+ *
+ * @param[in] psched: scheduler
+ * @param[in] lost: a unicast message was not acknowledged
+ */
+void blob_sched_tx_done(blob_sched_t *psched, bool lost);
+
+/**
+ * @brief check whether all chunk messages of the round are sent
+ *
+ * @param[in] psched: scheduler
+ * @return true
+ * @return false
+ */
+bool blob_sched_round_done(const blob_sched_t *psched);
+
+/** @} */
+
+END_DECLS
+
+#endif /* _BLOB_CLIENT_SCHED_H */
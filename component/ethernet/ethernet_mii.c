@@ -18,6 +18,9 @@ ETH_InitTypeDef eth_initstruct;
 volatile u32 g_rmii_tx_call = 0;
 volatile u32 g_rmii_tx_submit = 0;
 volatile u32 g_rmii_tx_getbuf_null = 0;
+volatile u32 g_rmii_tx_copy = 0;
+volatile u32 g_rmii_rx_loan = 0;
+volatile u32 g_rmii_rx_copy = 0;
 
 /* Optional override of MDC/MDIO pins (board-dependent). 0xFF means "use ETHERNET_PAD table". */
 u8 g_eth_mdc_pin = 0xFF;
@@ -30,8 +33,12 @@ u8 g_eth_mdio_pin = 0xFF;
 
 #define ETH_LINKCHANGE          8
 
-#define MII_TX_DESC_NO					4
+#define MII_TX_DESC_NO					8
 #define MII_RX_DESC_NO					4
+/* rx buffers that can be loaned to lwIP while the ring stays full */
+#define MII_RX_LOAN_NO					8
+#define MII_RX_BUF_NO					(MII_RX_DESC_NO + MII_RX_LOAN_NO)
+#define MII_RX_BUF_SIZE					CACHE_LINE_ALIGNMENT(ETH_PKT_MAX_SIZE)
 
 SRAM_NOCACHE_DATA_SECTION
 u8 rmii_tx_desc[MII_TX_DESC_NO][ETH_TX_DESC_SIZE]__attribute__((aligned(32)));
@@ -46,6 +53,29 @@ extern struct netif  *pnetif_eth;
 static u8 *pTmpTxPktBuf = NULL;
 static u8 *pTmpRxPktBuf = NULL;
 
+#if LWIP_SUPPORT_CUSTOM_PBUF
+/* rx buffer wrapped as custom pbuf, so that frame is passed to lwIP without copy */
+struct mii_rx_pbuf {
+	struct pbuf_custom pc;
+	u8 *buf;
+	struct mii_rx_pbuf *next;
+};
+
+static struct mii_rx_pbuf mii_rx_pbuf[MII_RX_BUF_NO];
+/* buffer attached to each rx descriptor */
+static struct mii_rx_pbuf *mii_rx_ring[MII_RX_DESC_NO];
+/* buffers neither in ring nor loaned to lwIP */
+static struct mii_rx_pbuf *mii_rx_free_list = NULL;
+#endif
+
+/* pbuf referred by tx descriptors, held on last descriptor of pkt until HW releases it */
+static struct pbuf *mii_tx_pbuf[MII_TX_DESC_NO];
+/* per descriptor buffer for segments that can not be sent in place */
+static u8 *mii_tx_bounce[MII_TX_DESC_NO];
+static u8 mii_tx_dirty_idx = 0;
+static u8 mii_tx_used_num = 0;
+static volatile u32 mii_tx_done = 0;
+
 int dhcp_ethernet_mii = 1;
 int ethernet_if_default = 1;
 int link_is_up = 0;
@@ -68,6 +98,92 @@ void mii_patch_function(prehandler_func_t pfunc1)
 	rmii_rx_prehandler = pfunc1;
 }
 
+#if LWIP_SUPPORT_CUSTOM_PBUF
+static void mii_rx_pbuf_free(struct pbuf *p)
+{
+	struct mii_rx_pbuf *rx_pbuf = (struct mii_rx_pbuf *) p;
+
+	rtos_critical_enter(RTOS_CRITICAL_NETWORK);
+	rx_pbuf->next = mii_rx_free_list;
+	mii_rx_free_list = rx_pbuf;
+	rtos_critical_exit(RTOS_CRITICAL_NETWORK);
+}
+
+static void mii_rx_pbuf_init(void)
+{
+	int i;
+
+	mii_rx_free_list = NULL;
+
+	/* first MII_RX_DESC_NO buffers are attached to descriptors by Ethernet_init */
+	for (i = 0; i < MII_RX_BUF_NO; i++) {
+		mii_rx_pbuf[i].pc.custom_free_function = mii_rx_pbuf_free;
+		mii_rx_pbuf[i].buf = eth_initstruct.ETH_RxPktBuf + i * MII_RX_BUF_SIZE;
+
+		if (i < MII_RX_DESC_NO) {
+			mii_rx_ring[i] = &mii_rx_pbuf[i];
+		} else {
+			mii_rx_pbuf[i].next = mii_rx_free_list;
+			mii_rx_free_list = &mii_rx_pbuf[i];
+		}
+	}
+}
+
+/*
+ * Loan the buffer of current rx descriptor to lwIP and attach a free buffer to the descriptor
+ * instead. Return NULL if all spare buffers are still held by lwIP, frame is copied then.
+ */
+static struct pbuf *mii_rx_pbuf_loan(u8 *buf, u32 len)
+{
+	u8 rx_idx = eth_initstruct.ETH_RxDescCurrentNum;
+	struct mii_rx_pbuf *rx_pbuf, *spare;
+	struct pbuf *p;
+
+	rtos_critical_enter(RTOS_CRITICAL_NETWORK);
+	spare = mii_rx_free_list;
+	if (spare) {
+		mii_rx_free_list = spare->next;
+	}
+	rtos_critical_exit(RTOS_CRITICAL_NETWORK);
+
+	if (spare == NULL) {
+		return NULL;
+	}
+
+	rx_pbuf = mii_rx_ring[rx_idx];
+	p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &rx_pbuf->pc, buf, MII_RX_BUF_SIZE - (buf - rx_pbuf->buf));
+	if (p == NULL) {
+		mii_rx_pbuf_free(&spare->pc.pbuf);
+		return NULL;
+	}
+
+	/* write back lines lwIP dirtied while holding spare buffer, so they are not evicted over rx data */
+	DCache_CleanInvalidate((u32)spare->buf, MII_RX_BUF_SIZE);
+	mii_rx_ring[rx_idx] = spare;
+	eth_initstruct.ETH_RxDesc[rx_idx].addr = (u32)spare->buf;
+
+	return p;
+}
+#endif
+
+/* free pbufs of the descriptors HW has sent, called with rmii_tx_mutex taken */
+static void mii_tx_reclaim(void)
+{
+	while (mii_tx_used_num) {
+		if (((volatile u32)(eth_initstruct.ETH_TxDesc[mii_tx_dirty_idx].dw1)) & FEMAC_TX_DSC_BIT_OWN) {
+			break;
+		}
+
+		if (mii_tx_pbuf[mii_tx_dirty_idx]) {
+			pbuf_free(mii_tx_pbuf[mii_tx_dirty_idx]);
+			mii_tx_pbuf[mii_tx_dirty_idx] = NULL;
+		}
+
+		mii_tx_dirty_idx = (mii_tx_dirty_idx + 1) % MII_TX_DESC_NO;
+		mii_tx_used_num--;
+	}
+}
+
 void mii_rx_thread(void *param)
 {
 	(void) param;
@@ -81,6 +197,13 @@ void mii_rx_thread(void *param)
 			RTK_LOGE(TAG, "%s, Take Semaphore Fail\n", __FUNCTION__);
 			break;
 		}
+		if (mii_tx_done) {
+			mii_tx_done = 0;
+			rtos_mutex_take(rmii_tx_mutex, MUTEX_WAIT_TIMEOUT);
+			mii_tx_reclaim();
+			rtos_mutex_give(rmii_tx_mutex);
+		}
+
 		// continues read the rx ring until its empty
 		while (1) {
 			buf = Ethernet_GetRXPktInfo(&eth_initstruct, &len);
@@ -94,7 +217,16 @@ void mii_rx_thread(void *param)
 						p = NULL;
 					}
 				} else {
-					p = ethernetif_rmii_buf_copy(len - 2, buf);
+#if LWIP_SUPPORT_CUSTOM_PBUF
+					p = mii_rx_pbuf_loan(buf, len - 2);
+					if (p != NULL) {
+						g_rmii_rx_loan++;
+					} else
+#endif
+					{
+						p = ethernetif_rmii_buf_copy(len - 2, buf);
+						g_rmii_rx_copy++;
+					}
 					if (p != NULL) {
 						ethernetif_rmii_netif_recv(p);
 					}
@@ -196,6 +328,9 @@ void mii_intr_handler(u32 Event, u32 Data)
 	switch (Event) {
 	case ETH_TXDONE:
 		// RTK_LOGI(TAG, "ETH_TXDONE\n");
+		// let rx thread free the pbufs that have been sent
+		mii_tx_done = 1;
+		rtos_sema_give(mii_rx_sema);
 		break;
 	case ETH_RXDONE:
 		// RTK_LOGI(TAG, "ETH_RXDONE\n");
@@ -255,7 +390,8 @@ void ethernet_demo(void *param)
 	}
 
 	pTmpTxPktBuf = (u8 *)rtos_mem_zmalloc(/*MII_TX_DESC_CNT*/MII_TX_DESC_NO * ETH_PKT_MAX_SIZE);
-	pTmpRxPktBuf = (u8 *)rtos_mem_zmalloc(/*MII_RX_DESC_CNT*/MII_RX_DESC_NO * ETH_PKT_MAX_SIZE);
+	/* rx buffers are cache line aligned, they are handed to lwIP and back to HW in place */
+	pTmpRxPktBuf = (u8 *)rtos_mem_zmalloc(MII_RX_BUF_NO * MII_RX_BUF_SIZE + CACHE_LINE_SIZE);
 
 
 	if (pTmpTxPktBuf == NULL || pTmpRxPktBuf == NULL) {
@@ -271,7 +407,19 @@ void ethernet_demo(void *param)
 	peth_initstruct->ETH_TxDesc = (ETH_TxDescTypeDef *)rmii_tx_desc;
 	peth_initstruct->ETH_RxDesc = (ETH_RxDescTypeDef *)rmii_rx_desc;
 	peth_initstruct->ETH_TxPktBuf = (u8 *)pTmpTxPktBuf;
-	peth_initstruct->ETH_RxPktBuf = (u8 *)pTmpRxPktBuf;
+	peth_initstruct->ETH_RxPktBuf = (u8 *)CACHE_LINE_ALIGNMENT(pTmpRxPktBuf);
+	peth_initstruct->ETH_RxBufSize = MII_RX_BUF_SIZE;
+
+	for (int i = 0; i < MII_TX_DESC_NO; i++) {
+		mii_tx_bounce[i] = pTmpTxPktBuf + i * peth_initstruct->ETH_TxBufSize;
+		mii_tx_pbuf[i] = NULL;
+	}
+	mii_tx_dirty_idx = 0;
+	mii_tx_used_num = 0;
+
+#if LWIP_SUPPORT_CUSTOM_PBUF
+	mii_rx_pbuf_init();
+#endif
 
 	if (wifi_get_mac_address(0, &efuse_mac, 1) == RTK_SUCCESS) {
 		memcpy(eth_mac, efuse_mac.octet, ETH_MAC_ADDR_LEN);
@@ -421,39 +569,95 @@ void ethernet_mii_init(void)
 
 #ifndef CONFIG_RMII_VERIFY
 	if (RTK_SUCCESS != rtos_task_create(NULL, "DHCP_START_MII", mii_intr_thread, NULL, 2048, 3)) {
-		RTK_LOGE(TAG, "\n\r%s Create simulation_task Err!");
+		RTK_LOGE(TAG, "\n\r%s Create simulation_task Err!", __FUNCTION__);
 	}
 #endif
 	if (RTK_SUCCESS != rtos_task_create(NULL, "ETHERNET DEMO", ethernet_demo, NULL, 2048, 2)) {
-		RTK_LOGE(TAG, "\n\r%s Create simulation_task Err!!");
+		RTK_LOGE(TAG, "\n\r%s Create simulation_task Err!!", __FUNCTION__);
 	}
 
 }
 
+/*
+ * Each pbuf segment gets its own tx descriptor and is sent in place, the pbuf is referenced
+ * until HW releases the descriptors. Segments whose payload may not be in RAM (PBUF_ROM/PBUF_REF)
+ * are copied to the bounce buffer of their descriptor, and a chain longer than the ring is
+ * copied to a single descriptor.
+ */
 int rltk_mii_send(struct pbuf *p)
 {
-	u32 ret = 0;
-	u32 size = 0;
+	u8 *sg_buf[MII_TX_DESC_NO];
+	u32 sg_len[MII_TX_DESC_NO];
+	u32 sg_num = 0;
+	u8 tx_idx;
 	struct pbuf *q;
-	u8 *rmii_buf = NULL;
+	int ret = 0;
 
 	g_rmii_tx_call++;
+
+	for (q = p; q != NULL; q = q->next) {
+		if (q->len) {
+			sg_num++;
+		}
+	}
+
+	if (sg_num > MII_TX_DESC_NO) {
+		if (p->tot_len > eth_initstruct.ETH_TxBufSize) {
+			return -1;
+		}
+		sg_num = 1;
+	}
+
 	rtos_mutex_take(rmii_tx_mutex, MUTEX_WAIT_TIMEOUT);
-	rmii_buf = Ethernet_GetTXPktInfo(&eth_initstruct);
-	if (rmii_buf) {/*copy from lwip to rmii*/
+
+	mii_tx_reclaim();
+
+	if ((u32)(MII_TX_DESC_NO - mii_tx_used_num) < sg_num) {
+		g_rmii_tx_getbuf_null++;
+		ret = -1;
+		goto exit;
+	}
+
+	tx_idx = eth_initstruct.ETH_TxDescCurrentNum;
+
+	if ((sg_num == 1) && (p->len != p->tot_len)) {
+		/* too many segments, collapse to one descriptor */
+		pbuf_copy_partial(p, mii_tx_bounce[tx_idx], p->tot_len, 0);
+		sg_buf[0] = mii_tx_bounce[tx_idx];
+		sg_len[0] = p->tot_len;
+		g_rmii_tx_copy++;
+	} else {
+		u32 i = 0;
+
 		for (q = p; q != NULL; q = q->next) {
-			memcpy(rmii_buf, (void *)q->payload, q->len);
-			rmii_buf += q->len;
-			size += q->len;
+			if (q->len == 0) {
+				continue;
+			}
+
+			if (q->type_internal & PBUF_TYPE_FLAG_STRUCT_DATA_CONTIGUOUS) {
+				sg_buf[i] = (u8 *)q->payload;
+			} else {
+				sg_buf[i] = mii_tx_bounce[(tx_idx + i) % MII_TX_DESC_NO];
+				memcpy(sg_buf[i], q->payload, q->len);
+				g_rmii_tx_copy++;
+			}
+			sg_len[i] = q->len;
+			i++;
 		}
-		Ethernet_UpdateTXDESCAndSend(&eth_initstruct, size);
-		g_rmii_tx_submit++;
-		ret = 0;
-	} else {
+	}
+
+	if (Ethernet_UpdateTXDESCSGAndSend(&eth_initstruct, sg_buf, sg_len, sg_num) == 0) {
 		g_rmii_tx_getbuf_null++;
 		ret = -1;
+		goto exit;
 	}
 
+	pbuf_ref(p);
+	mii_tx_pbuf[(tx_idx + sg_num - 1) % MII_TX_DESC_NO] = p;
+	mii_tx_used_num += sg_num;
+	g_rmii_tx_submit++;
+
+exit:
 	rtos_mutex_give(rmii_tx_mutex);
 
 	return ret;
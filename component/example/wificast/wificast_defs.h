@@ -18,6 +18,7 @@
 #define WIFI_CAST_OTA_DATA                     BIT(6)
 #define WIFI_CAST_DEBUG_COMMAND                BIT(5)
 #define WIFI_CAST_DEBUG_LOG                    BIT(4)
+#define WIFI_CAST_OTA_REPAIR                   BIT(3)
 
 /**
  * @brief Wifi cast application example frame head.
@@ -0,0 +1,51 @@
+#include "wificast_fec.h"
+
+int wificast_fec_plan(const uint32_t *miss_mask, uint16_t seq_num, struct wificast_fec_group *groups, int max_groups)
+{
+	int group_num = 0;
+	int i;
+	uint16_t seq;
+
+	for (seq = 0; seq < seq_num; seq++) {
+		if (miss_mask[seq] == 0) {
+			continue;
+		}
+
+		/* first fit: join a group none of whose losers also miss this chunk */
+		for (i = 0; i < group_num; i++) {
+			if ((groups[i].num < WIFICAST_FEC_GROUP_MAX) && ((groups[i].node_mask & miss_mask[seq]) == 0)) {
+				break;
+			}
+		}
+
+		if (i == group_num) {
+			if (group_num == max_groups) {
+				continue;
+			}
+			groups[i].num = 0;
+			groups[i].node_mask = 0;
+			group_num++;
+		}
+
+		groups[i].seq[groups[i].num++] = seq;
+		groups[i].node_mask |= miss_mask[seq];
+	}
+
+	return group_num;
+}
+
+void wificast_fec_xor(uint8_t *dst, const uint8_t *src, uint16_t len)
+{
+	uint16_t i = 0;
+
+	/* word at a time when both are aligned, chunks are 4 byte multiples except the last */
+	if ((((uintptr_t)dst | (uintptr_t)src) & 0x3) == 0) {
+		for (; i + 4 <= len; i += 4) {
+			*(uint32_t *)(dst + i) ^= *(const uint32_t *)(src + i);
+		}
+	}
+
+	for (; i < len; i++) {
+		dst[i] ^= src[i];
+	}
+}
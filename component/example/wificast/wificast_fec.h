@@ -0,0 +1,42 @@
+#ifndef _WIFICAST_FEC_H_
+#define _WIFICAST_FEC_H_
+
+#include <stdint.h>
+
+/*
+ * XOR repair planning for bulk transfers over wifi_cast broadcast, independent of
+ * the payload and of the wifi_cast API. The sender knows the losses of every node
+ * from its feedback, one bit per node in a 32 bit mask, so a fleet using it is
+ * bounded by 32 nodes as well as by MAX_NODE_NUM of the wifi_cast node table.
+ */
+
+/* max chunks XOR-ed into one repair packet */
+#define WIFICAST_FEC_GROUP_MAX		8
+
+/**
+ * @brief Repair group, the chunks in seq[] are XOR-ed into one repair packet.
+ * Every node misses at most one chunk of a group, so every node can
+ * recover its missing chunk from the repair packet and the chunks it has.
+ */
+struct wificast_fec_group {
+	uint16_t num;                          /* chunk number in this group */
+	uint16_t seq[WIFICAST_FEC_GROUP_MAX];  /* chunk offset in window */
+	uint32_t node_mask;                    /* nodes missing one of the chunks */
+};
+
+/**
+ * @brief  Plan repair groups for one window of chunks.
+ * @param  miss_mask: per chunk bit mask of nodes missing it, bit n is node n.
+ * @param  seq_num: chunk number in window.
+ * @param  groups: output groups, a chunk nobody misses is put in no group.
+ * @param  max_groups: size of groups.
+ * @return group number, chunks not fitting in max_groups are left for next round.
+ */
+int wificast_fec_plan(const uint32_t *miss_mask, uint16_t seq_num, struct wificast_fec_group *groups, int max_groups);
+
+/**
+ * @brief  XOR len bytes of src into dst.
+ */
+void wificast_fec_xor(uint8_t *dst, const uint8_t *src, uint16_t len);
+
+#endif /* _WIFICAST_FEC_H_ */
@@ -246,23 +246,24 @@ static void example_ota_status_response_cb(u8 *src_mac, u8 *data)
 {
 	RTK_LOGI(TAG, "%s, recv status response from"MAC_FMT"\n", __func__, MAC_ARG(src_mac));
 
-	struct example_ota_status *status = NULL;
-	status = (struct example_ota_status *)rtos_mem_zmalloc(sizeof(struct example_ota_status) + WIFI_CAST_OTA_PROGRESS_MAX);
-	if (!status) {
+	struct example_ota_feedback feedback = {0};
+	feedback.status = (struct example_ota_status *)rtos_mem_zmalloc(sizeof(struct example_ota_status) + WIFI_CAST_OTA_PROGRESS_MAX);
+	if (!feedback.status) {
 		RTK_LOGE(TAG, "%s, status malloc failed\n", __func__);
 		return;
 	}
 
-	memcpy(status, data, sizeof(struct example_ota_status) + WIFI_CAST_OTA_PROGRESS_MAX);
+	memcpy(feedback.mac, src_mac, ETH_ALEN);
+	memcpy(feedback.status, data, sizeof(struct example_ota_status) + WIFI_CAST_OTA_PROGRESS_MAX);
 
 	if (g_ota_request_q) {
-		if (RTK_SUCCESS != rtos_queue_send(g_ota_request_q, &status, 0)) {
+		if (RTK_SUCCESS != rtos_queue_send(g_ota_request_q, &feedback, 0)) {
 			RTK_LOGE(TAG, "%s, send queue failed\n", __func__);
-			rtos_mem_free(status);
+			rtos_mem_free(feedback.status);
 			return;
 		}
 	} else {
-		rtos_mem_free(status);
+		rtos_mem_free(feedback.status);
 	}
 }
 
@@ -287,6 +288,69 @@ static void example_ota_data_cb(u8 *data, u16 data_len)
 	g_ota_status->written_size += size;
 }
 
+static u16 example_ota_chunk_len(struct example_ota_status *status, u32 seq)
+{
+	return (seq == (u32)(status->packet_num - 1)) ? (status->total_size - seq * WIFI_CAST_OTA_PACKET_SIZE) : WIFI_CAST_OTA_PACKET_SIZE;
+}
+
+static void example_ota_repair_cb(u8 *data, u16 data_len)
+{
+	if (!g_ota_status || g_ota_status->status != WIFI_CAST_OTA_ONGOING) {
+		return;
+	}
+	struct ota_repair_head *hdr = (struct ota_repair_head *)data;
+	u8 *chunk;
+	u8 *recovered;
+	u32 missing_seq = 0;
+	int missing_num = 0;
+
+	if (data_len < sizeof(struct ota_repair_head) + WIFI_CAST_OTA_PACKET_SIZE || hdr->num > WIFICAST_FEC_GROUP_MAX) {
+		return;
+	}
+
+	for (int i = 0; i < hdr->num; i++) {
+		if (hdr->seq[i] >= g_ota_status->packet_num) {
+			return;
+		}
+		if (!WIFI_CAST_OTA_GET_BITS(g_ota_status->progress_array, hdr->seq[i])) {
+			missing_seq = hdr->seq[i];
+			missing_num++;
+		}
+	}
+
+	/* nothing to recover, or more than one unknown chunk in this repair */
+	if (missing_num != 1) {
+		return;
+	}
+
+	recovered = (u8 *)rtos_mem_malloc(sizeof(struct ota_packet_head) + WIFI_CAST_OTA_PACKET_SIZE);
+	chunk = (u8 *)rtos_mem_malloc(WIFI_CAST_OTA_PACKET_SIZE);
+	if (!recovered || !chunk) {
+		RTK_LOGE(TAG, "%s, malloc failed\n", __func__);
+		goto exit;
+	}
+
+	/* missing chunk = repair ^ all the other chunks, read back from flash */
+	memcpy(recovered + sizeof(struct ota_packet_head), data + sizeof(struct ota_repair_head), WIFI_CAST_OTA_PACKET_SIZE);
+	for (int i = 0; i < hdr->num; i++) {
+		if (hdr->seq[i] == missing_seq) {
+			continue;
+		}
+		memset(chunk, 0x0, WIFI_CAST_OTA_PACKET_SIZE);
+		flash_stream_read(&flash_obj, g_ota_status->image_addr + hdr->seq[i] * WIFI_CAST_OTA_PACKET_SIZE,
+						  example_ota_chunk_len(g_ota_status, hdr->seq[i]), chunk);
+		wificast_fec_xor(recovered + sizeof(struct ota_packet_head), chunk, WIFI_CAST_OTA_PACKET_SIZE);
+	}
+
+	((struct ota_packet_head *)recovered)->seq = missing_seq;
+	RTK_LOGD(TAG, "%s, recover ota packet, seq: %d\n", __func__, missing_seq);
+	example_ota_data_cb(recovered, sizeof(struct ota_packet_head) + example_ota_chunk_len(g_ota_status, missing_seq));
+
+exit:
+	rtos_mem_free(recovered);
+	rtos_mem_free(chunk);
+}
+
 static void example_recv_cb_task(void *param)
 {
 	(void)param;
@@ -310,6 +374,8 @@ static void example_recv_cb_task(void *param)
 			RTK_LOGD(TAG, MAC_FMT", len: %d, type: %x\n", MAC_ARG(recv_data->mac), recv_data->data_len, hdr->type);
 			if (hdr->type & WIFI_CAST_OTA_DATA) {
 				example_ota_data_cb(recv_data->data + sizeof(struct example_frame_head), hdr->len);
+			} else if (hdr->type & WIFI_CAST_OTA_REPAIR) {
+				example_ota_repair_cb(recv_data->data + sizeof(struct example_frame_head), hdr->len);
 			} else if (hdr->type & WIFI_CAST_SCAN_REQUEST) {
 				example_ota_scan_request_cb(recv_data->mac);
 				if (do_switch_channel) {
@@ -433,71 +499,187 @@ exit:
 	return total_size;
 }
 
-static void	example_ota_request_status(u8(*progress_array)[WIFI_CAST_OTA_PROGRESS_MAX],
-									   struct example_ota_status *status, struct example_ota_result *result)
+/* collect one status response per unfinished receiver, stop as soon as all of them answered */
+static int example_ota_request_status(struct example_ota_status *status, struct example_ota_result *result,
+									  struct example_ota_feedback *feedback, u8 (*done_mac)[ETH_ALEN])
 {
-	struct example_ota_status *recv_status = NULL;
-	u32 delay_ms = 1000;
-	for (int i = 0; i < 3; i++) {
+	struct example_ota_feedback recv = {0};
+	u32 expect_num = result->unfinished_num;
+	int feedback_num = 0;
+	int known;
+
+	for (int i = 0; i < WIFI_CAST_OTA_FEEDBACK_RETRY && (u32)feedback_num < expect_num; i++) {
 		example_send(WIFI_CAST_OTA_STATUS_REQUEST, WIFI_CAST_BROADCAST_MAC, (u8 *)status, sizeof(struct example_ota_status));
 		RTK_LOGI(TAG, "%s, send ota request\n", __func__);
-		delay_ms = 1000;
+		u32 start_ms = rtos_time_get_current_system_time_ms();
 		do {
-			if (RTK_SUCCESS == rtos_queue_receive(g_ota_request_q, &recv_status, 50)) {
-				RTK_LOGI(TAG, "%s, recv ota req response, written_size: %d, progress_index: %d\n", __func__, recv_status->written_size, recv_status->progress_index);
-				if (recv_status->written_size == status->total_size) {
-					result->unfinished_num--;
-					result->successed_num++;
-				} else {
-					if (recv_status->written_size == 0) {
-						memset(progress_array, 0x0, status->packet_num / 8 + 1);
-					} else {
-						for (int i = 0; i < WIFI_CAST_OTA_PROGRESS_MAX
-							 && (recv_status->progress_index * WIFI_CAST_OTA_PROGRESS_MAX  + i) * 8 < status->packet_num; i++) {
-							progress_array[recv_status->progress_index][i] &= recv_status->progress_array[0][i];
-						}
-					}
+			if (RTK_SUCCESS != rtos_queue_receive(g_ota_request_q, &recv, 50)) {
+				continue;
+			}
+			RTK_LOGI(TAG, "%s, recv ota req response, written_size: %d, progress_index: %d\n", __func__,
+					 recv.status->written_size, recv.status->progress_index);
+
+			/* a receiver answers every request, count it only once */
+			known = 0;
+			for (int j = 0; j < feedback_num; j++) {
+				if (!memcmp(feedback[j].mac, recv.mac, ETH_ALEN)) {
+					known = 1;
 				}
-				rtos_mem_free(recv_status);
 			}
-			delay_ms -= 50;
-		} while (delay_ms > 0);
+			for (u32 j = 0; j < result->successed_num; j++) {
+				if (!memcmp(done_mac[j], recv.mac, ETH_ALEN)) {
+					known = 1;
+				}
+			}
+
+			if (known) {
+				rtos_mem_free(recv.status);
+			} else if (recv.status->written_size == status->total_size) {
+				if (result->successed_num < MAX_NODE_NUM) {
+					memcpy(done_mac[result->successed_num], recv.mac, ETH_ALEN);
+				}
+				result->unfinished_num--;
+				result->successed_num++;
+				expect_num--;
+				rtos_mem_free(recv.status);
+			} else if (feedback_num < MAX_NODE_NUM) {
+				feedback[feedback_num++] = recv;
+			} else {
+				rtos_mem_free(recv.status);
+			}
+		} while ((u32)feedback_num < expect_num &&
+				 (rtos_time_get_current_system_time_ms() - start_ms) < WIFI_CAST_OTA_FEEDBACK_WAIT_MS);
 	}
+
+	return feedback_num;
 }
 
-static void example_image_send(struct example_ota_status *status, struct example_ota_result *result)
+static void example_ota_send_chunk(struct example_ota_status *status, u8 *data, u32 seq)
 {
-	u8(*progress_array)[WIFI_CAST_OTA_PROGRESS_MAX] = rtos_mem_malloc(status->packet_num / 8 + 1);
-	if (!progress_array) {
-		RTK_LOGE(TAG, "%s, malloc failed\n", __func__);
+	struct ota_packet_head *hdr = (struct ota_packet_head *)data;
+	u16 data_len = example_ota_chunk_len(status, seq);
+
+	hdr->seq = seq;
+	flash_stream_read(&flash_obj, ctx->otactrl->FlashAddr + seq * WIFI_CAST_OTA_PACKET_SIZE, data_len, data + sizeof(struct ota_packet_head));
+	if (WIFI_CAST_OK != example_send(WIFI_CAST_OTA_DATA, WIFI_CAST_BROADCAST_MAC, data, data_len + sizeof(struct ota_packet_head))) {
+		rtos_time_delay_ms(2);
+	}
+}
+
+/* XOR the chunks of each group so that every receiver can recover its own loss from one packet */
+static void example_ota_send_repair(struct example_ota_status *status, struct example_ota_feedback *feedback, int feedback_num, u8 *data)
+{
+	struct ota_repair_head *hdr = (struct ota_repair_head *)data;
+	u8 *payload = data + sizeof(struct ota_repair_head);
+	struct wificast_fec_group *groups = NULL;
+	u32 *miss_mask = NULL;
+	u8 *chunk = NULL;
+	u8 window = 0xff;
+	u32 base;
+	u16 seq_num;
+	int group_num;
+
+	/* plan on the lowest window reported, receivers reporting a later window have all of it */
+	for (int n = 0; n < feedback_num; n++) {
+		if (feedback[n].status->progress_index < window) {
+			window = feedback[n].status->progress_index;
+		}
+	}
+	base = window * WIFI_CAST_OTA_WINDOW_SIZE;
+	if (base >= status->packet_num) {
 		return;
 	}
-	u16 data_len = WIFI_CAST_OTA_PACKET_SIZE;
-	u8 *data = (u8 *)rtos_mem_zmalloc(data_len + sizeof(struct ota_packet_head));
-	if (!data) {
-		rtos_mem_free(progress_array);
+	seq_num = ((status->packet_num - base) < WIFI_CAST_OTA_WINDOW_SIZE) ? (status->packet_num - base) : WIFI_CAST_OTA_WINDOW_SIZE;
+
+	miss_mask = (u32 *)rtos_mem_zmalloc(seq_num * sizeof(u32));
+	groups = (struct wificast_fec_group *)rtos_mem_malloc(WIFI_CAST_OTA_REPAIR_GROUP_MAX * sizeof(struct wificast_fec_group));
+	chunk = (u8 *)rtos_mem_malloc(WIFI_CAST_OTA_PACKET_SIZE);
+	if (!miss_mask || !groups || !chunk) {
+		RTK_LOGE(TAG, "%s, malloc failed\n", __func__);
+		goto exit;
+	}
+
+	for (int n = 0; n < feedback_num; n++) {
+		if (feedback[n].status->progress_index != window) {
+			continue;
+		}
+		for (u16 i = 0; i < seq_num; i++) {
+			if (!WIFI_CAST_OTA_GET_BITS(feedback[n].status->progress_array[0], i)) {
+				miss_mask[i] |= BIT(n);
+			}
+		}
+	}
+
+	group_num = wificast_fec_plan(miss_mask, seq_num, groups, WIFI_CAST_OTA_REPAIR_GROUP_MAX);
+	RTK_LOGI(TAG, "%s, window: %d, repair packets: %d\n", __func__, window, group_num);
+
+	for (int g = 0; g < group_num; g++) {
+		/* nothing to combine, plain data is the same and cheaper */
+		if (groups[g].num == 1) {
+			example_ota_send_chunk(status, data, base + groups[g].seq[0]);
+			continue;
+		}
+
+		memset(data, 0x0, sizeof(struct ota_repair_head) + WIFI_CAST_OTA_PACKET_SIZE);
+		hdr->num = groups[g].num;
+		for (int i = 0; i < groups[g].num; i++) {
+			hdr->seq[i] = base + groups[g].seq[i];
+			memset(chunk, 0x0, WIFI_CAST_OTA_PACKET_SIZE);
+			flash_stream_read(&flash_obj, ctx->otactrl->FlashAddr + hdr->seq[i] * WIFI_CAST_OTA_PACKET_SIZE,
+							  example_ota_chunk_len(status, hdr->seq[i]), chunk);
+			wificast_fec_xor(payload, chunk, WIFI_CAST_OTA_PACKET_SIZE);
+		}
+		if (WIFI_CAST_OK != example_send(WIFI_CAST_OTA_REPAIR, WIFI_CAST_BROADCAST_MAC, data,
+										 sizeof(struct ota_repair_head) + WIFI_CAST_OTA_PACKET_SIZE)) {
+			rtos_time_delay_ms(2);
+		}
+	}
+
+exit:
+	rtos_mem_free(miss_mask);
+	rtos_mem_free(groups);
+	rtos_mem_free(chunk);
+}
+
+static void example_image_send(struct example_ota_status *status, struct example_ota_result *result)
+{
+	struct example_ota_feedback feedback[MAX_NODE_NUM];
+	u8 (*done_mac)[ETH_ALEN] = rtos_mem_zmalloc(MAX_NODE_NUM * ETH_ALEN);
+	u8 *data = (u8 *)rtos_mem_zmalloc(sizeof(struct ota_repair_head) + WIFI_CAST_OTA_PACKET_SIZE);
+	int feedback_num;
+	u8 first_pass;
+
+	if (!data || !done_mac) {
+		rtos_mem_free(data);
+		rtos_mem_free(done_mac);
 		RTK_LOGE(TAG, "%s, malloc failed\n", __func__);
 		return;
 	}
 	u32 start_tick = rtos_time_get_current_system_time_ms();
 
 	for (int round = 0; round < WIFI_CAST_OTA_ROUND_MAX && result->unfinished_num > 0; round++) {
-		memset(progress_array, 0xff, status->packet_num / 8 + 1);
-		example_ota_request_status(progress_array, status, result);
-		dump_buf("progress:", progress_array[0], status->packet_num / 8 + 1);
-		for (int seq = 0; seq < status->packet_num && result->unfinished_num > 0; seq++) {
-			if (!WIFI_CAST_OTA_GET_BITS(progress_array, seq)) {
-				struct ota_packet_head *hdr = (struct ota_packet_head *)data;
-				hdr->seq = seq;
-				data_len = (seq == status->packet_num - 1) ?
-						   (status->total_size - seq * WIFI_CAST_OTA_PACKET_SIZE) : WIFI_CAST_OTA_PACKET_SIZE;
-				flash_stream_read(&flash_obj, ctx->otactrl->FlashAddr + seq * WIFI_CAST_OTA_PACKET_SIZE, data_len, data + sizeof(struct ota_packet_head));
-				if (WIFI_CAST_OK != example_send(WIFI_CAST_OTA_DATA, WIFI_CAST_BROADCAST_MAC, data, data_len + sizeof(struct ota_packet_head))) {
-					rtos_time_delay_ms(2);
-				}
+		feedback_num = example_ota_request_status(status, result, feedback, done_mac);
+
+		/* a receiver with nothing written needs the whole image, send it plain */
+		first_pass = 0;
+		for (int n = 0; n < feedback_num; n++) {
+			if (feedback[n].status->written_size == 0) {
+				first_pass = 1;
 			}
 		}
-		RTK_LOGI(TAG, "%s, round: %d\n", __func__, round);
+
+		if (first_pass) {
+			for (u32 seq = 0; seq < status->packet_num && result->unfinished_num > 0; seq++) {
+				example_ota_send_chunk(status, data, seq);
+			}
+		} else if (feedback_num > 0) {
+			example_ota_send_repair(status, feedback, feedback_num, data);
+		}
+
+		for (int n = 0; n < feedback_num; n++) {
+			rtos_mem_free(feedback[n].status);
+		}
+		RTK_LOGI(TAG, "%s, round: %d, feedback: %d\n", __func__, round, feedback_num);
 	}
 
 	if (result->successed_num == 0) {
@@ -507,7 +689,7 @@ static void example_image_send(struct example_ota_status *status, struct example
 		RTK_LOGI(TAG, "%s, devices upgrade completed, unfinished_num: %d, successed_num: %d, spend time: %d ms\n",
 				 __func__, result->unfinished_num, result->successed_num, rtos_time_get_current_system_time_ms() - start_tick);
 	}
-	rtos_mem_free(progress_array);
+	rtos_mem_free(done_mac);
 	rtos_mem_free(data);
 }
 
@@ -540,7 +722,7 @@ static void example_ota_task(void *param)
 	status.packet_num = (image_size + WIFI_CAST_OTA_PACKET_SIZE - 1) / WIFI_CAST_OTA_PACKET_SIZE;
 	status.total_size = image_size;
 	result.unfinished_num = info_num;
-	rtos_queue_create(&g_ota_request_q, result.unfinished_num, sizeof(struct example_ota_status *));
+	rtos_queue_create(&g_ota_request_q, result.unfinished_num, sizeof(struct example_ota_feedback));
 	RTK_LOGI(TAG, "%s, start send image, total_size: %d bytes, packet_num: %d\n", __func__, status.total_size, status.packet_num);
 	example_image_send(&status, &result);
 
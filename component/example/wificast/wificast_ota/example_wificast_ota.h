@@ -7,10 +7,15 @@
 #include "sys_api.h"
 #include "ameba_ota.h"
 #include "kv.h"
+#include "../wificast_fec.h"
 
 #define WIFI_CAST_OTA_PROGRESS_MAX		200
 #define WIFI_CAST_OTA_PACKET_SIZE		256
 #define WIFI_CAST_OTA_ROUND_MAX			50
+#define WIFI_CAST_OTA_WINDOW_SIZE		(WIFI_CAST_OTA_PROGRESS_MAX * 8)	/* chunks covered by one status bitmap */
+#define WIFI_CAST_OTA_REPAIR_GROUP_MAX	256	/* repair packets planned per round */
+#define WIFI_CAST_OTA_FEEDBACK_RETRY	3
+#define WIFI_CAST_OTA_FEEDBACK_WAIT_MS	1000
 
 //upgrade status
 #define WIFI_CAST_OTA_ONGOING	0x1
@@ -39,6 +44,15 @@ struct ota_packet_head {
 	u32 seq;    /* packet sequence */
 } __attribute__((packed));
 
+/**
+ * @brief OTA repair packet head, followed by XOR of the chunks in seq[]
+ */
+struct ota_repair_head {
+	u16 num;    /* chunk number in seq[] */
+	u16 rsvd;
+	u32 seq[WIFICAST_FEC_GROUP_MAX];    /* XOR-ed chunk sequences */
+} __attribute__((packed));
+
 /**
  * @brief OTA status
  */
@@ -55,6 +69,14 @@ struct example_ota_status {
 	u8 progress_array[0][WIFI_CAST_OTA_PROGRESS_MAX]; /* upgrade process bitmap */
 } __attribute__((packed));
 
+/**
+ * @brief OTA status response from one receiver
+ */
+struct example_ota_feedback {
+	u8 mac[ETH_ALEN];                   /* receiver mac address */
+	struct example_ota_status *status;  /* receiver status with one progress window */
+};
+
 /**
  * @brief OTA result
  */
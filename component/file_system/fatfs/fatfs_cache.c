@@ -0,0 +1,369 @@
+/*
+ *  Sector cache with write-back coalescing and read-ahead for FatFs disk drivers
+ *
+ *  Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ *  This module is a confidential and proprietary property of RealTek and
+ *  possession or use of this module requires written permission of RealTek.
+ */
+#include <string.h>
+#include "vfs.h"
+#include "vfs_fatfs.h"
+#include "os_wrapper.h"
+#include "fatfs_cache.h"
+
+#if FATFS_CACHE_SECTORS
+
+#define CACHE_SS	FF_MAX_SS
+
+typedef struct {
+	LBA_t	sector;
+	DWORD	stamp;		/* last access, smallest is evicted first */
+	BYTE	valid;
+	BYTE	dirty;
+} fatfs_cache_line_t;
+
+typedef struct {
+	fatfs_cache_line_t line[FATFS_CACHE_SECTORS];
+	BYTE	*data;			/* FATFS_CACHE_SECTORS sectors, one per line */
+	BYTE	*burst;			/* staging for one multi-sector transfer */
+	LBA_t	sector_count;	/* media size, 0 if unknown and no read-ahead */
+	LBA_t	next_read;		/* sector following the last read, to detect sequential access */
+	DWORD	clock;
+	UINT	ndirty;
+	fatfs_cache_stats_t stats;
+} fatfs_cache_t;
+
+static fatfs_cache_t *fatfs_cache[_VOLUMES];
+
+static fatfs_cache_t *fatfs_cache_get(BYTE pdrv)
+{
+	fatfs_cache_t *c = fatfs_cache[pdrv];
+	DWORD sector_count = 0;
+
+	if (c) {
+		return c;
+	}
+
+	c = (fatfs_cache_t *)rtos_mem_zmalloc(sizeof(fatfs_cache_t) + (FATFS_CACHE_SECTORS + FATFS_CACHE_BURST) * CACHE_SS);
+	if (c == NULL) {
+		VFS_DBG(VFS_WARNING, "FATFS cache alloc fail, drive %d uncached", pdrv);
+		return NULL;
+	}
+	c->data = (BYTE *)(c + 1);
+	c->burst = c->data + FATFS_CACHE_SECTORS * CACHE_SS;
+
+#if _USE_IOCTL == 1
+	if (disk.drv[pdrv]->disk_ioctl && disk.drv[pdrv]->disk_ioctl(GET_SECTOR_COUNT, &sector_count) == RES_OK) {
+		c->sector_count = sector_count;
+	}
+#endif
+
+	fatfs_cache[pdrv] = c;
+	return c;
+}
+
+static int fatfs_cache_find(fatfs_cache_t *c, LBA_t sector)
+{
+	int i;
+
+	for (i = 0; i < FATFS_CACHE_SECTORS; i++) {
+		if (c->line[i].valid && c->line[i].sector == sector) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void fatfs_cache_touch(fatfs_cache_t *c, int idx)
+{
+	c->line[idx].stamp = ++c->clock;
+}
+
+/* write all dirty lines back, consecutive sectors go out as one command.
+ * Runs do not cross FATFS_CACHE_BURST aligned boundaries, which keeps them inside one
+ * erase block on flash backed drives. */
+static DRESULT fatfs_cache_flush(BYTE pdrv, fatfs_cache_t *c)
+{
+	ll_diskio_drv *drv = disk.drv[pdrv];
+	BYTE order[FATFS_CACHE_SECTORS];
+	UINT n = 0, i, j, run;
+	DRESULT res;
+
+	if (c->ndirty == 0) {
+		return RES_OK;
+	}
+
+	/* insertion sort of dirty lines by sector */
+	for (i = 0; i < FATFS_CACHE_SECTORS; i++) {
+		if (!c->line[i].dirty) {
+			continue;
+		}
+		for (j = n; j > 0 && c->line[order[j - 1]].sector > c->line[i].sector; j--) {
+			order[j] = order[j - 1];
+		}
+		order[j] = (BYTE)i;
+		n++;
+	}
+
+	for (i = 0; i < n; i += run) {
+		LBA_t start = c->line[order[i]].sector;
+
+		run = 1;
+		while (i + run < n && run < FATFS_CACHE_BURST &&
+			   c->line[order[i + run]].sector == start + run &&
+			   ((start + run) & (FATFS_CACHE_BURST - 1)) != 0) {
+			run++;
+		}
+
+		if (run == 1) {
+			res = drv->disk_write(c->data + order[i] * CACHE_SS, start, 1);
+		} else {
+			for (j = 0; j < run; j++) {
+				memcpy(c->burst + j * CACHE_SS, c->data + order[i + j] * CACHE_SS, CACHE_SS);
+			}
+			res = drv->disk_write(c->burst, start, run);
+		}
+		c->stats.write_cmds++;
+		if (res != RES_OK) {
+			return res;
+		}
+
+		for (j = 0; j < run; j++) {
+			c->line[order[i + j]].dirty = 0;
+		}
+		c->ndirty -= run;
+	}
+
+	return RES_OK;
+}
+
+/* pick a line for a new sector: a free one, else the least recently used clean one.
+ * When every line is dirty they are all written back first. */
+static int fatfs_cache_victim(BYTE pdrv, fatfs_cache_t *c)
+{
+	int i, idx = -1;
+
+	for (i = 0; i < FATFS_CACHE_SECTORS; i++) {
+		if (!c->line[i].valid) {
+			return i;
+		}
+		if (!c->line[i].dirty && (idx < 0 || c->line[i].stamp < c->line[idx].stamp)) {
+			idx = i;
+		}
+	}
+
+	if (idx < 0) {
+		if (fatfs_cache_flush(pdrv, c) != RES_OK) {
+			return -1;
+		}
+		idx = 0;
+		for (i = 1; i < FATFS_CACHE_SECTORS; i++) {
+			if (c->line[i].stamp < c->line[idx].stamp) {
+				idx = i;
+			}
+		}
+	}
+
+	return idx;
+}
+
+static DRESULT fatfs_cache_fill(BYTE pdrv, fatfs_cache_t *c, LBA_t sector, UINT count)
+{
+	UINT i;
+	int idx;
+	DRESULT res;
+
+	/* write back first if the new sectors do not fit in clean lines,
+	 * eviction must not flush while c->burst holds the read data */
+	if (FATFS_CACHE_SECTORS - c->ndirty < count) {
+		res = fatfs_cache_flush(pdrv, c);
+		if (res != RES_OK) {
+			return res;
+		}
+	}
+
+	res = disk.drv[pdrv]->disk_read(c->burst, sector, count);
+	c->stats.read_cmds++;
+	if (res != RES_OK) {
+		return res;
+	}
+
+	for (i = 0; i < count; i++) {
+		idx = fatfs_cache_victim(pdrv, c);
+		if (idx < 0) {
+			return RES_ERROR;
+		}
+		memcpy(c->data + idx * CACHE_SS, c->burst + i * CACHE_SS, CACHE_SS);
+		c->line[idx].sector = sector + i;
+		c->line[idx].valid = 1;
+		c->line[idx].dirty = 0;
+		fatfs_cache_touch(c, idx);
+	}
+
+	return RES_OK;
+}
+
+DRESULT fatfs_cache_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count)
+{
+	ll_diskio_drv *drv = disk.drv[pdrv];
+	fatfs_cache_t *c = fatfs_cache_get(pdrv);
+	UINT i, run, ahead;
+	int idx;
+	DRESULT res;
+
+	if (c == NULL) {
+		return drv->disk_read(buff, sector, count);
+	}
+
+	c->stats.read_reqs++;
+
+	/* big reads go straight to the driver, dirty cached sectors are laid over the result */
+	if (count >= FATFS_CACHE_BURST) {
+		res = drv->disk_read(buff, sector, count);
+		c->stats.read_cmds++;
+		c->stats.misses += count;
+		if (res != RES_OK) {
+			return res;
+		}
+		for (i = 0; c->ndirty && i < FATFS_CACHE_SECTORS; i++) {
+			if (c->line[i].dirty && c->line[i].sector >= sector && c->line[i].sector < sector + count) {
+				memcpy(buff + (c->line[i].sector - sector) * CACHE_SS, c->data + i * CACHE_SS, CACHE_SS);
+			}
+		}
+		c->next_read = sector + count;
+		return RES_OK;
+	}
+
+	for (i = 0; i < count; i++) {
+		idx = fatfs_cache_find(c, sector + i);
+		if (idx < 0) {
+			/* fetch the missing run in one command, sequential streams also read ahead.
+			 * The run stops before any cached sector, which may be newer than the media. */
+			run = 1;
+			while (i + run < count && run < FATFS_CACHE_BURST && fatfs_cache_find(c, sector + i + run) < 0) {
+				run++;
+			}
+			ahead = 0;
+			if (sector == c->next_read && c->sector_count) {
+				while (run + ahead < FATFS_CACHE_BURST && sector + i + run + ahead < c->sector_count &&
+					   fatfs_cache_find(c, sector + i + run + ahead) < 0) {
+					ahead++;
+				}
+			}
+
+			res = fatfs_cache_fill(pdrv, c, sector + i, run + ahead);
+			if (res != RES_OK) {
+				return res;
+			}
+			c->stats.misses += run;
+			c->stats.read_ahead += ahead;
+
+			idx = fatfs_cache_find(c, sector + i);
+			if (idx < 0) {
+				return RES_ERROR;
+			}
+		} else {
+			c->stats.hits++;
+		}
+		memcpy(buff + i * CACHE_SS, c->data + idx * CACHE_SS, CACHE_SS);
+		fatfs_cache_touch(c, idx);
+	}
+
+	c->next_read = sector + count;
+	return RES_OK;
+}
+
+DRESULT fatfs_cache_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
+{
+	ll_diskio_drv *drv = disk.drv[pdrv];
+	fatfs_cache_t *c = fatfs_cache_get(pdrv);
+	UINT i;
+	int idx;
+	DRESULT res;
+
+	if (c == NULL) {
+		return drv->disk_write(buff, sector, count);
+	}
+
+	c->stats.write_reqs++;
+
+	/* big writes are already multi-sector, write through and refresh cached copies */
+	if (count >= FATFS_CACHE_BURST) {
+		res = drv->disk_write(buff, sector, count);
+		c->stats.write_cmds++;
+		if (res != RES_OK) {
+			return res;
+		}
+		for (i = 0; i < FATFS_CACHE_SECTORS; i++) {
+			if (c->line[i].valid && c->line[i].sector >= sector && c->line[i].sector < sector + count) {
+				memcpy(c->data + i * CACHE_SS, buff + (c->line[i].sector - sector) * CACHE_SS, CACHE_SS);
+				if (c->line[i].dirty) {
+					c->line[i].dirty = 0;
+					c->ndirty--;
+				}
+			}
+		}
+		return RES_OK;
+	}
+
+	for (i = 0; i < count; i++) {
+		idx = fatfs_cache_find(c, sector + i);
+		if (idx < 0) {
+			idx = fatfs_cache_victim(pdrv, c);
+			if (idx < 0) {
+				return RES_ERROR;
+			}
+			c->line[idx].sector = sector + i;
+			c->line[idx].valid = 1;
+		}
+		memcpy(c->data + idx * CACHE_SS, buff + i * CACHE_SS, CACHE_SS);
+		if (!c->line[idx].dirty) {
+			c->line[idx].dirty = 1;
+			c->ndirty++;
+		}
+		fatfs_cache_touch(c, idx);
+	}
+
+	return RES_OK;
+}
+
+DRESULT fatfs_cache_sync(BYTE pdrv)
+{
+	fatfs_cache_t *c = fatfs_cache[pdrv];
+
+	if (c == NULL) {
+		return RES_OK;
+	}
+	return fatfs_cache_flush(pdrv, c);
+}
+
+/* drop the cache of a drive, dirty sectors are written back first if flush is set.
+ * Without flush (media changed or re-initialized) they are discarded. */
+void fatfs_cache_release(BYTE pdrv, BYTE flush)
+{
+	fatfs_cache_t *c = fatfs_cache[pdrv];
+
+	if (c == NULL) {
+		return;
+	}
+
+	if (flush && fatfs_cache_flush(pdrv, c) != RES_OK) {
+		VFS_DBG(VFS_ERROR, "FATFS cache write back fail, drive %d", pdrv);
+	}
+
+	fatfs_cache[pdrv] = NULL;
+	rtos_mem_free(c);
+}
+
+int fatfs_cache_get_stats(BYTE pdrv, fatfs_cache_stats_t *stats)
+{
+	if (pdrv >= _VOLUMES || fatfs_cache[pdrv] == NULL || stats == NULL) {
+		return -1;
+	}
+
+	memcpy(stats, &fatfs_cache[pdrv]->stats, sizeof(fatfs_cache_stats_t));
+	return 0;
+}
+
+#endif
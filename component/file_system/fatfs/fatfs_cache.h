@@ -0,0 +1,47 @@
+#ifndef _FATFS_CACHE_H
+#define _FATFS_CACHE_H
+
+#include "ff.h"
+#include "diskio.h"
+
+/* Sector cache between FatFs and the low level disk drivers.
+ * Drivers with ll_diskio_drv.cache_en set get FATFS_CACHE_SECTORS cached sectors:
+ * - small writes stay dirty in the cache and are written back sorted, merged into
+ *   multi-sector transfers of up to FATFS_CACHE_BURST sectors on CTRL_SYNC or eviction
+ * - a read that continues the previous one fetches FATFS_CACHE_BURST sectors ahead
+ * - requests of FATFS_CACHE_BURST sectors or more bypass the cache
+ * The cache is only touched under the FatFs volume lock (FF_FS_REENTRANT). */
+
+#ifndef FATFS_CACHE_SECTORS
+#define FATFS_CACHE_SECTORS		16	/* cached sectors per drive, 0 removes the cache */
+#endif
+
+#ifndef FATFS_CACHE_BURST
+#define FATFS_CACHE_BURST		8	/* sectors per coalesced write-back / read-ahead, 2^x */
+#endif
+
+#if FATFS_CACHE_SECTORS && (FF_MAX_SS != FF_MIN_SS)
+#error "FatFs disk cache needs a fixed sector size"
+#endif
+
+#if FATFS_CACHE_SECTORS && (FATFS_CACHE_BURST > FATFS_CACHE_SECTORS)
+#error "FATFS_CACHE_BURST can not exceed FATFS_CACHE_SECTORS"
+#endif
+
+typedef struct {
+	DWORD read_reqs;		/* disk_read calls from FatFs */
+	DWORD write_reqs;		/* disk_write calls from FatFs */
+	DWORD read_cmds;		/* read commands issued to the driver */
+	DWORD write_cmds;		/* write commands issued to the driver */
+	DWORD hits;				/* sectors served from the cache */
+	DWORD misses;			/* sectors read from the driver */
+	DWORD read_ahead;		/* sectors fetched ahead of the request */
+} fatfs_cache_stats_t;
+
+DRESULT fatfs_cache_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count);
+DRESULT fatfs_cache_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count);
+DRESULT fatfs_cache_sync(BYTE pdrv);
+void fatfs_cache_release(BYTE pdrv, BYTE flush);
+int fatfs_cache_get_stats(BYTE pdrv, fatfs_cache_stats_t *stats);
+
+#endif
@@ -92,15 +92,32 @@ DRESULT FLASH_disk_read(BYTE *buff, DWORD sector, UINT count)
 #if _USE_WRITE == 1
 DRESULT FLASH_disk_write(const BYTE *buff, DWORD sector, UINT count)
 {
-	u8 sector_index = sector % SECTOR_NUM;
+	u8 sector_index;
+	u32 block_addr, sector_num;
 	u8 *flash_sector_buffer = (u8 *)rtos_mem_malloc(FLASH_BLOCK_SIZE);
 
-	//deal with fisrt flash sector
-	flash_stream_read(&flash, FLASH_APP_BASE + (sector / SECTOR_NUM) * FLASH_BLOCK_SIZE, FLASH_BLOCK_SIZE, flash_sector_buffer);
-	memcpy(flash_sector_buffer + (sector_index * SECTOR_SIZE_FLASH), (BYTE *)buff,
-		   ((count + sector_index <= SECTOR_NUM) ? count : (u32)(SECTOR_NUM - sector_index))*SECTOR_SIZE_FLASH);
-	flash_erase_sector(&flash, FLASH_APP_BASE + (sector / SECTOR_NUM) * FLASH_BLOCK_SIZE);
-	flash_stream_write(&flash, FLASH_APP_BASE + (sector / SECTOR_NUM) * FLASH_BLOCK_SIZE, FLASH_BLOCK_SIZE, flash_sector_buffer);
+	if (flash_sector_buffer == NULL) {
+		return RES_ERROR;
+	}
+
+	//read-modify-write every flash sector the request touches, skip the read when it is fully covered
+	while (count) {
+		sector_index = sector % SECTOR_NUM;
+		sector_num = (count + sector_index <= SECTOR_NUM) ? count : (u32)(SECTOR_NUM - sector_index);
+		block_addr = FLASH_APP_BASE + (sector / SECTOR_NUM) * FLASH_BLOCK_SIZE;
+
+		if (sector_num < SECTOR_NUM) {
+			flash_stream_read(&flash, block_addr, FLASH_BLOCK_SIZE, flash_sector_buffer);
+		}
+		memcpy(flash_sector_buffer + (sector_index * SECTOR_SIZE_FLASH), (BYTE *)buff, sector_num * SECTOR_SIZE_FLASH);
+		flash_erase_sector(&flash, block_addr);
+		flash_stream_write(&flash, block_addr, FLASH_BLOCK_SIZE, flash_sector_buffer);
+
+		buff += sector_num * SECTOR_SIZE_FLASH;
+		sector += sector_num;
+		count -= sector_num;
+	}
+
 	rtos_mem_free(flash_sector_buffer);
 	flash_sector_buffer = NULL;
 	return RES_OK;
@@ -118,7 +135,8 @@ ll_diskio_drv FLASH_disk_Driver = {
 #if _USE_IOCTL == 1
 	.disk_ioctl = FLASH_disk_ioctl,
 #endif
-	.TAG	= (unsigned char *)"FLASH"
+	.TAG	= (unsigned char *)"FLASH",
+	.cache_en = 1
 };
 
 #ifdef CONFIG_FATFS_SECOND_FLASH
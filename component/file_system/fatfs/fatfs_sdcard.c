@@ -250,7 +250,8 @@ ll_diskio_drv SD_disk_Driver = {
 #if _USE_IOCTL == 1
 	.disk_ioctl = SD_disk_ioctl,
 #endif
-	.TAG	= (unsigned char *)"SD"
+	.TAG	= (unsigned char *)"SD",
+	.cache_en = 1
 };
 #endif
 
@@ -405,7 +406,8 @@ ll_diskio_drv SD_disk_spi_Driver = {
 #if _USE_IOCTL == 1
 	.disk_ioctl = SD_disk_spi_ioctl,
 #endif
-	.TAG	= (unsigned char *)"SD_SPI"
+	.TAG	= (unsigned char *)"SD_SPI",
+	.cache_en = 1
 };
 #endif
 #endif
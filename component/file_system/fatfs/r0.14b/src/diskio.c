@@ -9,6 +9,7 @@
 
 #include "diskio.h"		/* FatFs lower layer API */
 #include "vfs_fatfs.h"
+#include "fatfs_cache.h"
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -46,6 +47,10 @@ DSTATUS disk_initialize(
 	if (disk.nbr <= 0 || (signed char) pdrv < 0 || pdrv >= disk.nbr) {
 		return stat;
 	}
+#if FATFS_CACHE_SECTORS
+	/* media may have changed, cached sectors are stale */
+	fatfs_cache_release(pdrv, 0);
+#endif
 	stat = disk.drv[pdrv]->disk_initialize();
 	return stat;
 }
@@ -65,6 +70,9 @@ DSTATUS disk_deinitialize(
 	if (disk.nbr <= 0 || (signed char) pdrv < 0 || pdrv >= disk.nbr) {
 		return stat;
 	}
+#if FATFS_CACHE_SECTORS
+	fatfs_cache_release(pdrv, 1);
+#endif
 	stat = disk.drv[pdrv]->disk_deinitialize();
 	return stat;
 }
@@ -96,6 +104,11 @@ DRESULT disk_read(
 		return RES_NOTRDY;
 	}
 
+#if FATFS_CACHE_SECTORS
+	if (disk.drv[pdrv]->cache_en) {
+		return fatfs_cache_read(pdrv, buff, sector, count);
+	}
+#endif
 	res = disk.drv[pdrv]->disk_read(buff, sector, count);
 
 	return res;
@@ -128,6 +141,11 @@ DRESULT disk_write(
 		return RES_NOTRDY;
 	}
 
+#if FATFS_CACHE_SECTORS
+	if (disk.drv[pdrv]->cache_en) {
+		return fatfs_cache_write(pdrv, buff, sector, count);
+	}
+#endif
 	res = disk.drv[pdrv]->disk_write(buff, sector, count);
 
 	return res;
@@ -156,6 +174,14 @@ DRESULT disk_ioctl(
 		return RES_NOTRDY;
 	}
 
+#if FATFS_CACHE_SECTORS
+	if (cmd == CTRL_SYNC && disk.drv[pdrv]->cache_en) {
+		res = fatfs_cache_sync(pdrv);
+		if (res != RES_OK) {
+			return res;
+		}
+	}
+#endif
 	res = disk.drv[pdrv]->disk_ioctl(cmd, buff);
 
 	return res;
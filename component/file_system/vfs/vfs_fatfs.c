@@ -5,6 +5,7 @@
 #include "time.h"
 #include "os_wrapper.h"
 #include "diag.h"
+#include "fatfs_cache.h"
 
 int fatfs_mount_flag = 0;
 int fatfs2_mount_flag = 0;
@@ -40,6 +41,9 @@ int FATFS_RegisterDiskDriver(ll_diskio_drv *drv)
 int FATFS_UnRegisterDiskDriver(unsigned char drv_num)
 {
 	if (drv_num < _VOLUMES && disk.drv[drv_num]) {
+#if FATFS_CACHE_SECTORS
+		fatfs_cache_release(drv_num, 1);
+#endif
 		disk.drv[drv_num] = NULL;
 		disk.nbr--;
 		return 0;
@@ -87,10 +91,174 @@ int fatfs_get_interface(int interface)
 	return drv_id;
 }
 
+#if FF_USE_FASTSEEK
+/* Every open file larger than a few clusters gets a cluster link map (CLMT), so seeks and
+ * cluster crossings look the chain up in RAM instead of walking the FAT on the media.
+ * The map is built lazily on the first seek. A write past the end of the map goes to FatFs
+ * one cluster at a time with the map detached and appends each cluster FatFs links to the
+ * chain, so a growing file is never walked again. The map is dropped when the file shrinks
+ * or a seek expands it. */
+#define FATFS_CLMT_MIN_CLUSTERS		4
+#define FATFS_CLMT_INIT_SIZE		32		/* DWORDs, enough for 15 fragments */
+#define FATFS_CLMT_MAX_SIZE			1024
+
+typedef struct {
+	FIL fil;			/* must stay first, finfo->file is used as FIL * */
+	BYTE clmt_off;		/* chain too fragmented for the map, growing it won't help */
+	DWORD clmt_size;	/* DWORDs allocated for fil.cltbl, cltbl[0] holds the DWORDs used */
+	DWORD clmt_clust;	/* clusters of the chain in the map */
+} fatfs_fil_t;
+
+#define FATFS_FIL_SIZE	sizeof(fatfs_fil_t)
+
+static void fatfs_clmt_drop(FIL *fil)
+{
+	fatfs_fil_t *ffil = (fatfs_fil_t *)fil;
+
+	if (fil->cltbl) {
+		rtos_mem_free(fil->cltbl);
+		fil->cltbl = NULL;
+	}
+	ffil->clmt_size = 0;
+	ffil->clmt_clust = 0;
+}
+
+static void fatfs_clmt_build(FIL *fil)
+{
+	fatfs_fil_t *ffil = (fatfs_fil_t *)fil;
+	DWORD size = FATFS_CLMT_INIT_SIZE;
+	DWORD *tbl;
+	FRESULT res;
+
+	if (fil->cltbl || ffil->clmt_off || f_size(fil) <= (FSIZE_t)FATFS_CLMT_MIN_CLUSTERS * fil->obj.fs->csize * FF_MAX_SS) {
+		return;
+	}
+
+	while (size <= FATFS_CLMT_MAX_SIZE) {
+		tbl = (DWORD *)rtos_mem_malloc(size * sizeof(DWORD));
+		if (tbl == NULL) {
+			return;
+		}
+		tbl[0] = size;
+		fil->cltbl = tbl;
+		res = f_lseek(fil, CREATE_LINKMAP);
+		if (res == FR_OK) {
+			ffil->clmt_size = size;
+			ffil->clmt_clust = 0;
+			for (tbl = fil->cltbl + 1; *tbl; tbl += 2) {
+				ffil->clmt_clust += *tbl;
+			}
+			return;
+		}
+
+		/* on FR_NOT_ENOUGH_CORE the required size is returned in tbl[0] */
+		size = (res == FR_NOT_ENOUGH_CORE) ? tbl[0] : FATFS_CLMT_MAX_SIZE + 1;
+		fil->cltbl = NULL;
+		rtos_mem_free(tbl);
+	}
+
+	/* every attempt walks the whole chain, don't repeat it on each seek */
+	ffil->clmt_off = 1;
+}
+
+/* add the cluster following the last one in the map, returns -1 when the map can't hold it */
+static int fatfs_clmt_append(FIL *fil, DWORD clst)
+{
+	fatfs_fil_t *ffil = (fatfs_fil_t *)fil;
+	DWORD used = fil->cltbl[0];		/* size item, fragments and terminator */
+	DWORD size;
+	DWORD *tbl;
+
+	/* length and first cluster of the last fragment are just before the terminator */
+	if (used > 2 && fil->cltbl[used - 2] + fil->cltbl[used - 3] == clst) {
+		fil->cltbl[used - 3]++;
+		ffil->clmt_clust++;
+		return 0;
+	}
+
+	if (used + 2 > ffil->clmt_size) {
+		if (used + 2 > FATFS_CLMT_MAX_SIZE) {
+			ffil->clmt_off = 1;
+			return -1;
+		}
+		size = (ffil->clmt_size * 2 < FATFS_CLMT_MAX_SIZE) ? ffil->clmt_size * 2 : FATFS_CLMT_MAX_SIZE;
+		tbl = (DWORD *)rtos_mem_malloc(size * sizeof(DWORD));
+		if (tbl == NULL) {
+			return -1;
+		}
+		memcpy(tbl, fil->cltbl, used * sizeof(DWORD));
+		rtos_mem_free(fil->cltbl);
+		fil->cltbl = tbl;
+		ffil->clmt_size = size;
+	}
+	fil->cltbl[used - 1] = 1;
+	fil->cltbl[used] = clst;
+	fil->cltbl[used + 1] = 0;
+	fil->cltbl[0] = used + 2;
+	ffil->clmt_clust++;
+	return 0;
+}
+
+/* fast seek can't stretch the chain, so what lies past the map is written without it */
+static FRESULT fatfs_clmt_write(FIL *fil, const void *buf, UINT btw, UINT *bw)
+{
+	fatfs_fil_t *ffil = (fatfs_fil_t *)fil;
+	FSIZE_t csz = (FSIZE_t)fil->obj.fs->csize * FF_MAX_SS;
+	FSIZE_t mapped;
+	DWORD *tbl;
+	UINT n, wn;
+	FRESULT res;
+
+	*bw = 0;
+	while (btw) {
+		tbl = fil->cltbl;
+		mapped = (FSIZE_t)ffil->clmt_clust * csz;
+		if (tbl == NULL) {
+			n = btw;
+		} else if (f_tell(fil) < mapped) {
+			n = (mapped - f_tell(fil) < btw) ? (UINT)(mapped - f_tell(fil)) : btw;
+		} else {
+			/* up to the end of the new cluster, fil->clust is then the cluster FatFs linked */
+			n = (csz - f_tell(fil) % csz < btw) ? (UINT)(csz - f_tell(fil) % csz) : btw;
+			fil->cltbl = NULL;
+		}
+		res = f_write(fil, (const BYTE *)buf + *bw, n, &wn);
+		*bw += wn;
+		btw -= wn;
+		if (tbl && fil->cltbl == NULL) {
+			fil->cltbl = tbl;
+			if (wn && fatfs_clmt_append(fil, fil->clust) < 0) {
+				fatfs_clmt_drop(fil);
+			}
+		}
+		if (res != FR_OK || wn < n) {
+			return res;		/* disk full when FR_OK */
+		}
+	}
+	return FR_OK;
+}
+
+static FRESULT fatfs_lseek(FIL *fil, FSIZE_t ofs)
+{
+	/* fast seek clips at the file size, expanding the file needs the FAT walk */
+	if (ofs > f_size(fil)) {
+		fatfs_clmt_drop(fil);
+	} else {
+		fatfs_clmt_build(fil);
+	}
+	return f_lseek(fil, ofs);
+}
+#else
+#define FATFS_FIL_SIZE	sizeof(FIL)
+#define fatfs_clmt_drop(fil)
+#define fatfs_lseek(fil, ofs)	f_lseek(fil, ofs)
+#define fatfs_clmt_write(fil, buf, btw, bw)	f_write(fil, buf, btw, bw)
+#endif
+
 int fatfs_open(void *fs, const char *filename, const char *mode, vfs_file *finfo)
 {
 	(void) fs;
-	FIL *fil = rtos_mem_malloc(sizeof(FIL));
+	FIL *fil = rtos_mem_zmalloc(FATFS_FIL_SIZE);
 	uint8_t mode_mapping = 0;
 	FRESULT res = FR_OK;
 	if (fil == NULL) {
@@ -132,7 +300,7 @@ int fatfs_read(void *fs, unsigned char *buf, unsigned int size, unsigned int cou
 {
 	(void) fs;
 	FIL *fil = (FIL *)finfo->file;
-	size_t br;
+	size_t br = 0;
 	FRESULT res = f_read(fil, buf, size * count, (UINT *)&br);
 	if (res > 0) {
 		VFS_DBG(VFS_ERROR, "vfs-fatfs fread error %d \r\n", res);
@@ -145,8 +313,10 @@ int fatfs_write(void *fs, unsigned char *buf, unsigned int size, unsigned int co
 {
 	(void) fs;
 	FIL *fil = (FIL *)finfo->file;
-	size_t bw;
-	FRESULT res = f_write(fil, buf, size * count, (UINT *)&bw);
+	size_t bw = 0;
+	FRESULT res;
+
+	res = fatfs_clmt_write(fil, buf, size * count, (UINT *)&bw);
 	if (res > 0) {
 		VFS_DBG(VFS_ERROR, "vfs-fatfs fwrite error %d \r\n", res);
 		return -res;
@@ -159,6 +329,7 @@ int fatfs_close(void *fs, vfs_file *finfo)
 	(void) fs;
 	FIL *fil = (FIL *)finfo->file;
 	FRESULT res = f_close(fil);
+	fatfs_clmt_drop(fil);
 	rtos_mem_free(fil);
 	if (res > 0) {
 		VFS_DBG(VFS_ERROR, "vfs-fatfs fclose error %d \r\n", res);
@@ -177,15 +348,15 @@ int fatfs_seek(void *fs, long int offset, int origin, vfs_file *finfo)
 	int pos = 0;
 	switch (origin) {
 	case SEEK_SET:
-		res = f_lseek(fil, offset);
+		res = fatfs_lseek(fil, offset);
 		pos = offset;
 		break;
 	case SEEK_CUR:
-		res = f_lseek(fil, curr + offset);
+		res = fatfs_lseek(fil, curr + offset);
 		pos = curr + offset;
 		break;
 	case SEEK_END:
-		res = f_lseek(fil, size - offset);
+		res = fatfs_lseek(fil, size - offset);
 		pos = size - offset;
 		break;
 	}
@@ -200,7 +371,7 @@ void fatfs_rewind(void *fs, vfs_file *finfo)
 {
 	(void) fs;
 	FIL *fil = (FIL *)finfo->file;
-	f_lseek(fil, 0);
+	fatfs_lseek(fil, 0);
 }
 
 int fatfs_fgetops(void *fs, vfs_file *finfo)
@@ -217,7 +388,7 @@ int fatfs_fsetops(void *fs, unsigned int offset, vfs_file *finfo)
 	(void) fs;
 	FIL *fil = (FIL *)finfo->file;
 	int value = 0;
-	value = f_lseek(fil, offset);
+	value = fatfs_lseek(fil, offset);
 
 	if (value > 0) {
 		VFS_DBG(VFS_ERROR, "vfs-fatfs fsetops error %d \r\n", value);
@@ -288,6 +459,10 @@ int fatfs_ftruncate(void *fs, vfs_file *finfo, off_t length)
 	(void) fs;
 	FIL *fil = (FIL *)finfo->file;
 	FRESULT res = FR_INT_ERR;
+	fatfs_clmt_drop(fil);
+#if FF_USE_FASTSEEK
+	((fatfs_fil_t *)fil)->clmt_off = 0;
+#endif
 	res = f_lseek(fil, length);
 	if (res > 0) {
 		return -1;
@@ -22,6 +22,7 @@ typedef struct {
 #endif /* _USE_IOCTL == 1 */
 	unsigned char	*TAG;
 	unsigned char drv_num;
+	unsigned char cache_en;                                /*!< Cache sectors and coalesce writes in diskio layer, see fatfs_cache.h */
 } ll_diskio_drv;
 
 typedef struct {
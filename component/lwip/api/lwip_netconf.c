@@ -1,6 +1,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "lwip/prot/dhcp.h"
 #include "lwip_netconf.h"
+#include "lwip/memp.h"
 #include "atcmd_service.h"
 #include "wifi_intf_drv_to_upper.h"
 #include "ameba_pmu.h"
@@ -737,3 +738,30 @@ uint8_t LwIP_IP_Address_Request(uint8_t idx)
 #endif
 	return ret;
 }
+
+/**
+  * @brief  Print size, placement and counters of every lwIP memory pool
+  * @param  None
+  * @retval None
+  */
+void LwIP_memp_dump(void)
+{
+#if MEMP_POOL_COUNTERS
+	struct memp_info info;
+	int i;
+
+	RTK_LOGS(NOTAG, RTK_LOG_INFO, "%-16s %5s %4s %5s %5s %5s %10s %8s %8s\n",
+			 "pool", "size", "num", "mem", "used", "max", "alloc", "fail", "fallback");
+	for (i = 0; i < MEMP_MAX; i++) {
+		if (memp_get_info((memp_t)i, &info) != ERR_OK) {
+			continue;
+		}
+		RTK_LOGS(NOTAG, RTK_LOG_INFO, "%-16s %5u %4u %5s %5u %5u %10u %8u %8u\n",
+				 info.name ? info.name : "?", info.size, info.num, info.num ? (info.psram ? "psram" : "sram") : "heap",
+				 info.counters.used, info.counters.max, (unsigned int)info.counters.alloc,
+				 (unsigned int)info.counters.fail, (unsigned int)info.counters.fallback);
+	}
+#else
+	RTK_LOGS(NOTAG, RTK_LOG_INFO, "MEMP_POOL_COUNTERS disabled\n");
+#endif
+}
@@ -157,6 +157,7 @@ int LwIP_netif_get_idx(struct netif *pnetif);
 struct netif *LwIP_idx_get_netif(uint8_t idx);
 int LwIP_Check_Connectivity(uint8_t idx);
 uint8_t LwIP_IP_Address_Request(uint8_t idx);
+void LwIP_memp_dump(void);
 
 #ifdef __cplusplus
 }
@@ -186,6 +186,29 @@ extern unsigned int sys_now(void);
 #define LWIP_HOOK_FILENAME              "rtk_otbr_lwip_hook.h"
 #endif
 
+/* Dedicated memory pools, overflowing to the heap when exhausted */
+#if defined(CONFIG_LWIP_MEMP_POOLS) && CONFIG_LWIP_MEMP_POOLS
+#undef MEMP_MEM_MALLOC
+#define MEMP_MEM_MALLOC                 0
+#define MEMP_POOL_FALLBACK              1
+#define MEMP_POOL_RUNTIME_ALLOC         1
+#define MEMP_POOL_STORAGE_ALLOC(size, psram)  sys_memp_pool_storage_alloc(size, psram)
+#define PBUF_POOL_SIZE                  CONFIG_LWIP_PBUF_POOL_SIZE
+#define MEMP_NUM_PBUF                   CONFIG_LWIP_MEMP_NUM_PBUF
+#define MEMP_NUM_TCP_SEG                CONFIG_LWIP_MEMP_NUM_TCP_SEG
+#define MEMP_NUM_NETBUF                 8
+#define MEMP_NUM_TCPIP_MSG_API          8
+#define MEMP_NUM_TCPIP_MSG_INPKT        16
+#define MEMP_NUM_SYS_TIMEOUT            (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 8)
+#if defined(CONFIG_LWIP_MEMP_POOLS_IN_PSRAM) && CONFIG_LWIP_MEMP_POOLS_IN_PSRAM
+#define MEMP_PSRAM_POOLS                MEMP_PSRAM(PBUF_POOL) MEMP_PSRAM(PBUF) MEMP_PSRAM(TCP_SEG)
+#endif
+/* pool sizes are no hard limit with the heap fallback */
+#define LWIP_DISABLE_TCP_SANITY_CHECKS  1
+#endif
+/* per pool counters, read with memp_get_info() or LwIP_memp_dump() */
+#define MEMP_POOL_COUNTERS              1
+
 #if defined(LWIP_NETCONN_SEM_PER_THREAD) && LWIP_NETCONN_SEM_PER_THREAD
 #define LWIP_NETCONN_THREAD_SEM_GET()     sys_thread_sem_get()
 #define LWIP_NETCONN_THREAD_SEM_ALLOC()   sys_thread_sem_init()
@@ -54,5 +54,8 @@ sys_sem_t *sys_thread_sem_get(void);
 sys_sem_t *sys_thread_sem_init(void);
 void sys_thread_sem_deinit(void);
 
+/* storage of the lwIP memory pools, psram selects TYPE_DRAM, NULL if not available */
+void *sys_memp_pool_storage_alloc(size_t size, int psram);
+
 #endif /* __SYS_RTXC_H__ */
 
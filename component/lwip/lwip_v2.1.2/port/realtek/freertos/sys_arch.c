@@ -557,6 +557,11 @@ u32_t sys_jiffies(void)
     return rtos_time_get_current_system_time_ms();
 }
 
+void *sys_memp_pool_storage_alloc(size_t size, int psram)
+{
+    return rtos_heap_types_malloc((uint32_t)size, psram ? TYPE_DRAM : TYPE_SRAM);
+}
+
 #if LWIP_NETCONN_SEM_PER_THREAD
 sys_sem_t *sys_thread_sem_init(void)
 {
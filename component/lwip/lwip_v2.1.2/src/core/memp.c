@@ -93,6 +93,75 @@ const struct memp_desc *const memp_pools[MEMP_MAX] = {
 #define MEMP_OVERFLOW_CHECK 1
 #endif
 
+/* Added by Realtek start */
+#if !MEMP_MEM_MALLOC
+#if MEMP_POOL_RUNTIME_ALLOC
+#define MEMP_DESC_BASE(desc) (*(desc)->base)
+#else
+#define MEMP_DESC_BASE(desc) ((desc)->base)
+#endif
+
+/* distance between two elements of a pool */
+#define MEMP_ELEMENT_SIZE(desc) (MEMP_SIZE + MEMP_ALIGN_SIZE((desc)->size))
+#endif /* !MEMP_MEM_MALLOC */
+
+#if !MEMP_MEM_MALLOC && MEMP_POOL_RUNTIME_ALLOC
+#ifndef MEMP_PSRAM_POOLS
+#define MEMP_PSRAM_POOLS
+#endif
+/* pools requested in PSRAM, indexed by memp_t */
+#define MEMP_PSRAM(name) [MEMP_##name] = 1,
+static const u8_t memp_psram_wanted[MEMP_MAX] = { 0, MEMP_PSRAM_POOLS };
+#undef MEMP_PSRAM
+/* pools actually placed in PSRAM */
+static u8_t memp_psram_placed[MEMP_MAX];
+
+/**
+ * Allocate the storage of a pool if not done yet. A pool wanted in PSRAM
+ * goes to SRAM when PSRAM is missing or full. When both fail the pool stays
+ * empty and every allocation takes the fallback path (or fails).
+ *
+ * @return 1 if the storage is in PSRAM
+ */
+static u8_t
+memp_alloc_storage(const struct memp_desc *desc, u8_t psram)
+{
+  size_t len = LWIP_MEM_ALIGN_BUFFER((size_t)desc->num * MEMP_ELEMENT_SIZE(desc));
+
+  if ((*desc->base != NULL) || (desc->num == 0)) {
+    return 0;
+  }
+  if (psram) {
+    *desc->base = (u8_t *)MEMP_POOL_STORAGE_ALLOC(len, 1);
+    if (*desc->base != NULL) {
+      return 1;
+    }
+  }
+  *desc->base = (u8_t *)MEMP_POOL_STORAGE_ALLOC(len, 0);
+  LWIP_ERROR("memp_init: no memory for pool storage", (*desc->base != NULL), return 0;);
+  return 0;
+}
+#endif /* !MEMP_MEM_MALLOC && MEMP_POOL_RUNTIME_ALLOC */
+
+#if !MEMP_MEM_MALLOC && MEMP_POOL_FALLBACK
+/**
+ * Check if an element comes from the storage of its pool or from the heap.
+ */
+static int
+memp_in_pool(const struct memp_desc *desc, const struct memp *memp)
+{
+  mem_ptr_t start;
+
+  if (MEMP_DESC_BASE(desc) == NULL) {
+    return 0;
+  }
+  start = (mem_ptr_t)LWIP_MEM_ALIGN(MEMP_DESC_BASE(desc));
+  return ((mem_ptr_t)memp >= start) &&
+         ((mem_ptr_t)memp < start + (mem_ptr_t)desc->num * MEMP_ELEMENT_SIZE(desc));
+}
+#endif /* !MEMP_MEM_MALLOC && MEMP_POOL_FALLBACK */
+/* Added by Realtek end */
+
 #if MEMP_SANITY_CHECK && !MEMP_MEM_MALLOC
 /**
  * Check that memp-lists don't form a circle, using "Floyd's cycle-finding algorithm".
@@ -154,7 +223,12 @@ memp_overflow_check_all(void)
   SYS_ARCH_PROTECT(old_level);
 
   for (i = 0; i < MEMP_MAX; ++i) {
-    p = (struct memp *)LWIP_MEM_ALIGN(memp_pools[i]->base);
+    /* Modified by Realtek start */
+    if (MEMP_DESC_BASE(memp_pools[i]) == NULL) {
+      continue;
+    }
+    p = (struct memp *)LWIP_MEM_ALIGN(MEMP_DESC_BASE(memp_pools[i]));
+    /* Modified by Realtek end */
     for (j = 0; j < memp_pools[i]->num; ++j) {
       memp_overflow_check_element(p, memp_pools[i]);
       p = LWIP_ALIGNMENT_CAST(struct memp *, ((u8_t *)p + MEMP_SIZE + memp_pools[i]->size + MEM_SANITY_REGION_AFTER_ALIGNED));
@@ -181,7 +255,16 @@ memp_init_pool(const struct memp_desc *desc)
   struct memp *memp;
 
   *desc->tab = NULL;
-  memp = (struct memp *)LWIP_MEM_ALIGN(desc->base);
+  /* Added by Realtek start */
+#if MEMP_POOL_RUNTIME_ALLOC
+  /* custom pools and pools not allocated by memp_init() go to SRAM */
+  memp_alloc_storage(desc, 0);
+  if (*desc->base == NULL) {
+    return;
+  }
+#endif /* MEMP_POOL_RUNTIME_ALLOC */
+  /* Added by Realtek end */
+  memp = (struct memp *)LWIP_MEM_ALIGN(MEMP_DESC_BASE(desc));
 #if MEMP_MEM_INIT
   /* force memset on pool memory */
   memset(memp, 0, (size_t)desc->num * (MEMP_SIZE + desc->size
@@ -227,6 +310,11 @@ memp_init(void)
 
   /* for every pool: */
   for (i = 0; i < LWIP_ARRAYSIZE(memp_pools); i++) {
+    /* Added by Realtek start */
+#if !MEMP_MEM_MALLOC && MEMP_POOL_RUNTIME_ALLOC
+    memp_psram_placed[i] = memp_alloc_storage(memp_pools[i], memp_psram_wanted[i]);
+#endif
+    /* Added by Realtek end */
     memp_init_pool(memp_pools[i]);
 
 #if LWIP_STATS && MEMP_STATS
@@ -248,6 +336,9 @@ do_memp_malloc_pool_fn(const struct memp_desc *desc, const char *file, const int
 #endif
 {
   struct memp *memp;
+#if !MEMP_MEM_MALLOC && MEMP_POOL_FALLBACK
+  u8_t fallback = 0;
+#endif
   SYS_ARCH_DECL_PROTECT(old_level);
 
 #if MEMP_MEM_MALLOC
@@ -257,15 +348,31 @@ do_memp_malloc_pool_fn(const struct memp_desc *desc, const char *file, const int
   SYS_ARCH_PROTECT(old_level);
 
   memp = *desc->tab;
+  /* Added by Realtek start */
+#if MEMP_POOL_FALLBACK
+  if (memp == NULL) {
+    /* pool exhausted, take the element from the heap */
+    SYS_ARCH_UNPROTECT(old_level);
+    memp = (struct memp *)mem_malloc(MEMP_ELEMENT_SIZE(desc));
+    SYS_ARCH_PROTECT(old_level);
+    fallback = (memp != NULL);
+  }
+#endif /* MEMP_POOL_FALLBACK */
+  /* Added by Realtek end */
 #endif /* MEMP_MEM_MALLOC */
 
   if (memp != NULL) {
 #if !MEMP_MEM_MALLOC
+#if MEMP_POOL_FALLBACK
+    if (!fallback)
+#endif
+    {
 #if MEMP_OVERFLOW_CHECK == 1
-    memp_overflow_check_element(memp, desc);
+      memp_overflow_check_element(memp, desc);
 #endif /* MEMP_OVERFLOW_CHECK */
 
-    *desc->tab = memp->next;
+      *desc->tab = memp->next;
+    }
 #if MEMP_OVERFLOW_CHECK
     memp->next = NULL;
 #endif /* MEMP_OVERFLOW_CHECK */
@@ -275,6 +382,10 @@ do_memp_malloc_pool_fn(const struct memp_desc *desc, const char *file, const int
     memp->line = line;
 #if MEMP_MEM_MALLOC
     memp_overflow_init_element(memp, desc);
+#elif MEMP_POOL_FALLBACK
+    if (fallback) {
+      memp_overflow_init_element(memp, desc);
+    }
 #endif /* MEMP_MEM_MALLOC */
 #endif /* MEMP_OVERFLOW_CHECK */
     LWIP_ASSERT("memp_malloc: memp properly aligned",
@@ -285,12 +396,27 @@ do_memp_malloc_pool_fn(const struct memp_desc *desc, const char *file, const int
       desc->stats->max = desc->stats->used;
     }
 #endif
+    /* Added by Realtek start */
+#if MEMP_POOL_COUNTERS
+    desc->counters->alloc++;
+    desc->counters->used++;
+    if (desc->counters->used > desc->counters->max) {
+      desc->counters->max = desc->counters->used;
+    }
+#if !MEMP_MEM_MALLOC && MEMP_POOL_FALLBACK
+    desc->counters->fallback += fallback;
+#endif
+#endif /* MEMP_POOL_COUNTERS */
+    /* Added by Realtek end */
     SYS_ARCH_UNPROTECT(old_level);
     /* cast through u8_t* to get rid of alignment warnings */
     return ((u8_t *)memp + MEMP_SIZE);
   } else {
 #if MEMP_STATS
     desc->stats->err++;
+#endif
+#if MEMP_POOL_COUNTERS
+    desc->counters->fail++; /* Added by Realtek */
 #endif
     SYS_ARCH_UNPROTECT(old_level);
     LWIP_DEBUGF(MEMP_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("memp_malloc: out of memory in pool %s\n", desc->desc));
@@ -376,12 +502,24 @@ do_memp_free_pool(const struct memp_desc *desc, void *mem)
 #if MEMP_STATS
   desc->stats->used--;
 #endif
+#if MEMP_POOL_COUNTERS
+  desc->counters->used--; /* Added by Realtek */
+#endif
 
 #if MEMP_MEM_MALLOC
   LWIP_UNUSED_ARG(desc);
   SYS_ARCH_UNPROTECT(old_level);
   mem_free(memp);
 #else /* MEMP_MEM_MALLOC */
+  /* Added by Realtek start */
+#if MEMP_POOL_FALLBACK
+  if (!memp_in_pool(desc, memp)) {
+    SYS_ARCH_UNPROTECT(old_level);
+    mem_free(memp);
+    return;
+  }
+#endif /* MEMP_POOL_FALLBACK */
+  /* Added by Realtek end */
   memp->next = *desc->tab;
   *desc->tab = memp;
 
@@ -445,3 +583,61 @@ memp_free(memp_t type, void *mem)
   }
 #endif
 }
+
+/* Added by Realtek start */
+#if MEMP_POOL_COUNTERS
+/**
+ * Get size, placement and counters of a pool.
+ *
+ * @param type the pool to query
+ * @param info filled with a consistent snapshot of the counters
+ *
+ * @return ERR_OK, or ERR_ARG for an invalid type
+ */
+err_t
+memp_get_info(memp_t type, struct memp_info *info)
+{
+  const struct memp_desc *desc;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  LWIP_ERROR("memp_get_info: invalid arguments", (type < MEMP_MAX) && (info != NULL), return ERR_ARG;);
+
+  desc = memp_pools[type];
+  info->name = desc->desc;
+  info->size = desc->size;
+#if MEMP_MEM_MALLOC
+  info->num = 0;
+  info->psram = 0;
+#else
+  info->num = (MEMP_DESC_BASE(desc) != NULL) ? desc->num : 0;
+#if MEMP_POOL_RUNTIME_ALLOC
+  info->psram = memp_psram_placed[type];
+#else
+  info->psram = 0;
+#endif
+#endif /* MEMP_MEM_MALLOC */
+
+  SYS_ARCH_PROTECT(old_level);
+  info->counters = *desc->counters;
+  SYS_ARCH_UNPROTECT(old_level);
+
+  return ERR_OK;
+}
+
+/**
+ * Restart the high-water mark of every pool from its current usage.
+ */
+void
+memp_reset_max(void)
+{
+  u16_t i;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  SYS_ARCH_PROTECT(old_level);
+  for (i = 0; i < MEMP_MAX; i++) {
+    memp_pools[i]->counters->max = memp_pools[i]->counters->used;
+  }
+  SYS_ARCH_UNPROTECT(old_level);
+}
+#endif /* MEMP_POOL_COUNTERS */
+/* Added by Realtek end */
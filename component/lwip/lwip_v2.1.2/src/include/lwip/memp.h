@@ -39,6 +39,7 @@
 #define LWIP_HDR_MEMP_H
 
 #include "lwip/opt.h"
+#include "lwip/err.h" /* Added by Realtek */
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,12 +71,37 @@ extern const struct memp_desc* const memp_pools[MEMP_MAX];
 
 #define LWIP_MEMPOOL_DECLARE(name,num,size,desc) \
   LWIP_MEMPOOL_DECLARE_STATS_INSTANCE(memp_stats_ ## name) \
+  LWIP_MEMPOOL_DECLARE_COUNTERS_INSTANCE(memp_counters_ ## name) \
   const struct memp_desc memp_ ## name = { \
     DECLARE_LWIP_MEMPOOL_DESC(desc) \
     LWIP_MEMPOOL_DECLARE_STATS_REFERENCE(memp_stats_ ## name) \
+    LWIP_MEMPOOL_DECLARE_COUNTERS_REFERENCE(memp_counters_ ## name) \
     LWIP_MEM_ALIGN_SIZE(size) \
   };
 
+/* Added by Realtek start */
+#elif MEMP_POOL_RUNTIME_ALLOC /* MEMP_MEM_MALLOC */
+
+/* Realtek: the storage of the pool is allocated by memp_init(), in SRAM or PSRAM */
+#define LWIP_MEMPOOL_DECLARE(name,num,size,desc) \
+  static u8_t *memp_memory_ ## name ## _base; \
+    \
+  LWIP_MEMPOOL_DECLARE_STATS_INSTANCE(memp_stats_ ## name) \
+  LWIP_MEMPOOL_DECLARE_COUNTERS_INSTANCE(memp_counters_ ## name) \
+    \
+  static struct memp *memp_tab_ ## name; \
+    \
+  const struct memp_desc memp_ ## name = { \
+    DECLARE_LWIP_MEMPOOL_DESC(desc) \
+    LWIP_MEMPOOL_DECLARE_STATS_REFERENCE(memp_stats_ ## name) \
+    LWIP_MEMPOOL_DECLARE_COUNTERS_REFERENCE(memp_counters_ ## name) \
+    LWIP_MEM_ALIGN_SIZE(size), \
+    (num), \
+    &memp_memory_ ## name ## _base, \
+    &memp_tab_ ## name \
+  };
+/* Added by Realtek end */
+
 #else /* MEMP_MEM_MALLOC */
 
 /**
@@ -96,12 +122,14 @@ extern const struct memp_desc* const memp_pools[MEMP_MAX];
   LWIP_DECLARE_MEMORY_ALIGNED(memp_memory_ ## name ## _base, ((num) * (MEMP_SIZE + MEMP_ALIGN_SIZE(size)))); \
     \
   LWIP_MEMPOOL_DECLARE_STATS_INSTANCE(memp_stats_ ## name) \
+  LWIP_MEMPOOL_DECLARE_COUNTERS_INSTANCE(memp_counters_ ## name) \
     \
   static struct memp *memp_tab_ ## name; \
     \
   const struct memp_desc memp_ ## name = { \
     DECLARE_LWIP_MEMPOOL_DESC(desc) \
     LWIP_MEMPOOL_DECLARE_STATS_REFERENCE(memp_stats_ ## name) \
+    LWIP_MEMPOOL_DECLARE_COUNTERS_REFERENCE(memp_counters_ ## name) \
     LWIP_MEM_ALIGN_SIZE(size), \
     (num), \
     memp_memory_ ## name ## _base, \
@@ -148,6 +176,25 @@ void *memp_malloc(memp_t type);
 #endif
 void  memp_free(memp_t type, void *mem);
 
+/* Added by Realtek start */
+#if MEMP_POOL_COUNTERS
+/** Snapshot of one pool, see memp_get_info() */
+struct memp_info {
+  const char *name;
+  /** element size */
+  u16_t size;
+  /** elements in the pool, 0 when every element comes from the heap */
+  u16_t num;
+  /** pool storage is in PSRAM */
+  u8_t psram;
+  struct memp_counters counters;
+};
+
+err_t memp_get_info(memp_t type, struct memp_info *info);
+void  memp_reset_max(void);
+#endif /* MEMP_POOL_COUNTERS */
+/* Added by Realtek end */
+
 #ifdef __cplusplus
 }
 #endif
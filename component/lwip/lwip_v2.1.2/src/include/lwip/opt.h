@@ -271,6 +271,46 @@
 #define MEMP_MEM_MALLOC                 0
 #endif
 
+/* Added by Realtek start */
+/**
+ * MEMP_POOL_FALLBACK==1: When a pool is exhausted, allocate the element with
+ * mem_malloc instead of failing. memp_free recognizes such elements by their
+ * address and gives them back to the heap. Only used when MEMP_MEM_MALLOC==0.
+ */
+#if !defined MEMP_POOL_FALLBACK || defined __DOXYGEN__
+#define MEMP_POOL_FALLBACK              0
+#endif
+
+/**
+ * MEMP_POOL_RUNTIME_ALLOC==1: Allocate the storage of every pool in memp_init()
+ * with MEMP_POOL_STORAGE_ALLOC(size, psram) instead of declaring static arrays,
+ * so that each pool can be placed in SRAM or PSRAM. Pools listed in
+ * MEMP_PSRAM_POOLS (as MEMP_PSRAM(name) entries) are allocated with psram set.
+ * Only used when MEMP_MEM_MALLOC==0.
+ */
+#if !defined MEMP_POOL_RUNTIME_ALLOC || defined __DOXYGEN__
+#define MEMP_POOL_RUNTIME_ALLOC         0
+#endif
+
+/**
+ * MEMP_POOL_STORAGE_ALLOC(size, psram): allocator of the pool storage when
+ * MEMP_POOL_RUNTIME_ALLOC==1. Must return NULL when the memory requested
+ * (PSRAM if psram is set) is not available.
+ */
+#if !defined MEMP_POOL_STORAGE_ALLOC || defined __DOXYGEN__
+#define MEMP_POOL_STORAGE_ALLOC(size, psram) mem_malloc((mem_size_t)(size))
+#endif
+
+/**
+ * MEMP_POOL_COUNTERS==1: Keep allocation, failure, fallback and high-water
+ * counters for every pool, independently of LWIP_STATS, and provide
+ * memp_get_info() to read them.
+ */
+#if !defined MEMP_POOL_COUNTERS || defined __DOXYGEN__
+#define MEMP_POOL_COUNTERS              0
+#endif
+/* Added by Realtek end */
+
 /**
  * MEMP_MEM_INIT==1: Force use of memset to initialize pool memory.
  * Useful if pool are moved in uninitialized section of memory. This will ensure
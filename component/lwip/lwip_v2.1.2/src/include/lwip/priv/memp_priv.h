@@ -104,16 +104,40 @@ typedef enum {
 #define MEMP_POOL_LAST   ((memp_t) MEMP_POOL_HELPER_LAST)
 #endif /* MEM_USE_POOLS && MEMP_USE_CUSTOM_POOLS */
 
+/* Added by Realtek start */
+#if MEMP_POOL_COUNTERS
+/** Always-on usage counters of a pool, independent of LWIP_STATS */
+struct memp_counters {
+  /** successful allocations, heap fallbacks included */
+  u32_t alloc;
+  /** allocations that returned NULL */
+  u32_t fail;
+  /** allocations served by mem_malloc because the pool was empty */
+  u32_t fallback;
+  /** elements in use, heap fallbacks included */
+  u16_t used;
+  /** high-water mark of used */
+  u16_t max;
+};
+#endif /* MEMP_POOL_COUNTERS */
+/* Added by Realtek end */
+
 /** Memory pool descriptor */
 struct memp_desc {
-#if defined(LWIP_DEBUG) || MEMP_OVERFLOW_CHECK || LWIP_STATS_DISPLAY
+#if defined(LWIP_DEBUG) || MEMP_OVERFLOW_CHECK || LWIP_STATS_DISPLAY || MEMP_POOL_COUNTERS
   /** Textual description */
   const char *desc;
-#endif /* LWIP_DEBUG || MEMP_OVERFLOW_CHECK || LWIP_STATS_DISPLAY */
+#endif /* LWIP_DEBUG || MEMP_OVERFLOW_CHECK || LWIP_STATS_DISPLAY || MEMP_POOL_COUNTERS */
 #if MEMP_STATS
   /** Statistics */
   struct stats_mem *stats;
 #endif
+/* Added by Realtek start */
+#if MEMP_POOL_COUNTERS
+  /** Usage counters */
+  struct memp_counters *counters;
+#endif
+/* Added by Realtek end */
 
   /** Element size */
   u16_t size;
@@ -123,14 +147,19 @@ struct memp_desc {
   u16_t num;
 
   /** Base address */
+#if MEMP_POOL_RUNTIME_ALLOC
+  /* Realtek: storage is allocated by memp_init() */
+  u8_t **base;
+#else
   u8_t *base;
+#endif
 
   /** First free element of each pool. Elements form a linked list. */
   struct memp **tab;
 #endif /* MEMP_MEM_MALLOC */
 };
 
-#if defined(LWIP_DEBUG) || MEMP_OVERFLOW_CHECK || LWIP_STATS_DISPLAY
+#if defined(LWIP_DEBUG) || MEMP_OVERFLOW_CHECK || LWIP_STATS_DISPLAY || MEMP_POOL_COUNTERS
 #define DECLARE_LWIP_MEMPOOL_DESC(desc) (desc),
 #else
 #define DECLARE_LWIP_MEMPOOL_DESC(desc)
@@ -144,6 +173,16 @@ struct memp_desc {
 #define LWIP_MEMPOOL_DECLARE_STATS_REFERENCE(name)
 #endif
 
+/* Added by Realtek start */
+#if MEMP_POOL_COUNTERS
+#define LWIP_MEMPOOL_DECLARE_COUNTERS_INSTANCE(name) static struct memp_counters name;
+#define LWIP_MEMPOOL_DECLARE_COUNTERS_REFERENCE(name) &name,
+#else
+#define LWIP_MEMPOOL_DECLARE_COUNTERS_INSTANCE(name)
+#define LWIP_MEMPOOL_DECLARE_COUNTERS_REFERENCE(name)
+#endif
+/* Added by Realtek end */
+
 void memp_init_pool(const struct memp_desc *desc);
 
 #if MEMP_OVERFLOW_CHECK
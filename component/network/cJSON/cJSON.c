@@ -245,6 +245,11 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
 		if (!(item->type & cJSON_IsReference) && (item->child != NULL)) {
 			cJSON_Delete(item->child);
 		}
+		if (item->type & cJSON_InArena) {
+			/* the node and its strings are released with the arena, heap items below it are not */
+			item = next;
+			continue;
+		}
 		if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL)) {
 			global_hooks.deallocate(item->valuestring);
 		}
@@ -273,6 +278,7 @@ typedef struct {
 	size_t offset;
 	size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
 	internal_hooks hooks;
+	cJSON_Arena *arena; /* in-place parse: nodes come from the arena and strings are decoded inside content */
 } parse_buffer;
 
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
@@ -283,6 +289,30 @@ typedef struct {
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
+/* Allocate a node for the parser, from the arena of an in-place parse. */
+static cJSON *parse_new_item(parse_buffer *const input_buffer)
+{
+	cJSON_Arena *arena = input_buffer->arena;
+	cJSON *node = NULL;
+
+	if (arena == NULL) {
+		return cJSON_New_Item(&(input_buffer->hooks));
+	}
+
+	if ((arena->size - arena->used) < sizeof(cJSON)) {
+		return NULL;
+	}
+	node = (cJSON *)(void *)(arena->buffer + arena->used);
+	arena->used += sizeof(cJSON);
+	if (arena->used > arena->peak) {
+		arena->peak = arena->used;
+	}
+	memset(node, '\0', sizeof(cJSON));
+	node->type = cJSON_InArena;
+
+	return node;
+}
+
 /* Parse the input text to generate a number, and populate the result into item. */
 static cJSON_bool parse_number(cJSON *const item, parse_buffer *const input_buffer)
 {
@@ -345,7 +375,7 @@ loop_end:
 		item->valueint = (int)number;
 	}
 
-	item->type = cJSON_Number;
+	item->type = cJSON_Number | (item->type & cJSON_InArena);
 
 	input_buffer->offset += (size_t)(after_end - number_c_string);
 	return true;
@@ -376,6 +406,10 @@ CJSON_PUBLIC(char *) cJSON_SetValuestring(cJSON *object, const char *valuestring
 		strcpy(object->valuestring, valuestring);
 		return object->valuestring;
 	}
+	/* the string of an arena node lives in the parsed input and cannot grow */
+	if (object->type & cJSON_InArena) {
+		return NULL;
+	}
 	copy = (char *) cJSON_strdup((const unsigned char *)valuestring, &global_hooks);
 	if (copy == NULL) {
 		return NULL;
@@ -706,11 +740,22 @@ static cJSON_bool parse_string(cJSON *const item, parse_buffer *const input_buff
 			goto fail; /* string ended unexpectedly */
 		}
 
-		/* This is at most how much we need for the output */
-		allocation_length = (size_t)(input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-		output = (unsigned char *)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-		if (output == NULL) {
-			goto fail; /* allocation failure */
+		if (input_buffer->arena != NULL) {
+			/* decode over the literal itself: an escape sequence never yields more bytes than it takes, and the
+			 * closing quote leaves room for the terminator */
+			output = (unsigned char *)input_pointer;
+			if (skipped_bytes == 0) {
+				input_pointer = input_end;
+				output_pointer = (unsigned char *)input_end;
+				goto terminate;
+			}
+		} else {
+			/* This is at most how much we need for the output */
+			allocation_length = (size_t)(input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
+			output = (unsigned char *)input_buffer->hooks.allocate(allocation_length + sizeof(""));
+			if (output == NULL) {
+				goto fail; /* allocation failure */
+			}
 		}
 	}
 
@@ -765,10 +810,11 @@ static cJSON_bool parse_string(cJSON *const item, parse_buffer *const input_buff
 		}
 	}
 
+terminate:
 	/* zero terminate the output */
 	*output_pointer = '\0';
 
-	item->type = cJSON_String;
+	item->type = cJSON_String | (item->type & cJSON_InArena);
 	item->valuestring = (char *)output;
 
 	input_buffer->offset = (size_t)(input_end - input_buffer->content);
@@ -777,7 +823,7 @@ static cJSON_bool parse_string(cJSON *const item, parse_buffer *const input_buff
 	return true;
 
 fail:
-	if (output != NULL) {
+	if ((output != NULL) && (input_buffer->arena == NULL)) {
 		input_buffer->hooks.deallocate(output);
 	}
 
@@ -962,9 +1008,10 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
 }
 
 /* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+static cJSON *parse_root(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated,
+						 cJSON_Arena *arena)
 {
-	parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+	parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0 };
 	cJSON *item = NULL;
 
 	/* reset error position */
@@ -979,8 +1026,9 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
 	buffer.length = buffer_length;
 	buffer.offset = 0;
 	buffer.hooks = global_hooks;
+	buffer.arena = arena;
 
-	item = cJSON_New_Item(&global_hooks);
+	item = parse_new_item(&buffer);
 	if (item == NULL) { /* memory fail */
 		goto fail;
 	}
@@ -1029,6 +1077,127 @@ fail:
 	return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+	return parse_root(value, buffer_length, return_parse_end, require_null_terminated, NULL);
+}
+
+/* nodes are multiples of the double alignment, only the start of the buffer needs aligning */
+#define arena_alignment sizeof(double)
+
+CJSON_PUBLIC(void) cJSON_InitArena(cJSON_Arena *arena, void *buffer, size_t size)
+{
+	size_t skip = 0;
+
+	if (arena == NULL) {
+		return;
+	}
+
+	memset(arena, '\0', sizeof(cJSON_Arena));
+	if ((buffer != NULL) && (size > 0)) {
+		skip = (arena_alignment - ((size_t)buffer % arena_alignment)) % arena_alignment;
+		if (skip < size) {
+			arena->buffer = (unsigned char *)buffer + skip;
+			arena->size = size - skip;
+		}
+	}
+}
+
+CJSON_PUBLIC(size_t) cJSON_ArenaSize(const char *value, size_t buffer_length)
+{
+	const unsigned char *pointer = (const unsigned char *)value;
+	const unsigned char *end = pointer + buffer_length;
+	const unsigned char *next = NULL;
+	/* the root, plus one node per element: the first one of every non-empty container and one after each comma */
+	size_t nodes = 1;
+
+	if (value == NULL) {
+		return 0;
+	}
+
+	for (; (pointer < end) && (*pointer != '\0'); pointer++) {
+		switch (*pointer) {
+		case '\"':
+			/* brackets and commas inside strings do not count */
+			for (pointer++; (pointer < end) && (*pointer != '\"'); pointer++) {
+				if ((*pointer == '\\') && ((pointer + 1) < end)) {
+					pointer++;
+				}
+			}
+			if (pointer == end) {
+				pointer--;
+			}
+			break;
+		case ',':
+			nodes++;
+			break;
+		case '[':
+		case '{':
+			for (next = pointer + 1; (next < end) && (*next <= 32) && (*next != '\0'); next++) {
+			}
+			if ((next < end) && (*next != ']') && (*next != '}')) {
+				nodes++;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	return nodes * sizeof(cJSON) + arena_alignment - 1;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseInPlace(char *value, size_t buffer_length, cJSON_Arena *arena)
+{
+	cJSON *item = NULL;
+	size_t used = 0;
+	void *buffer = NULL;
+	size_t size = 0;
+
+	if ((value == NULL) || (arena == NULL)) {
+		return NULL;
+	}
+
+	if (arena->buffer == NULL) {
+		size = cJSON_ArenaSize(value, buffer_length);
+		buffer = global_hooks.allocate(size);
+		if (buffer == NULL) {
+			return NULL;
+		}
+		cJSON_InitArena(arena, buffer, size);
+		/* buffer may have been moved forward for alignment, the allocation is freed as it was returned */
+		arena->allocation = buffer;
+	}
+
+	used = arena->used;
+	item = parse_root(value, buffer_length, NULL, false, arena);
+	if (item == NULL) {
+		/* nodes of a failed parse are not referenced by anything */
+		arena->used = used;
+	}
+
+	return item;
+}
+
+CJSON_PUBLIC(void) cJSON_ResetArena(cJSON_Arena *arena)
+{
+	if (arena != NULL) {
+		arena->used = 0;
+	}
+}
+
+CJSON_PUBLIC(void) cJSON_FreeArena(cJSON_Arena *arena)
+{
+	if (arena == NULL) {
+		return;
+	}
+
+	if (arena->allocation != NULL) {
+		global_hooks.deallocate(arena->allocation);
+	}
+	memset(arena, '\0', sizeof(cJSON_Arena));
+}
+
 /* Default options for cJSON_Parse */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
 {
@@ -1164,19 +1333,19 @@ static cJSON_bool parse_value(cJSON *const item, parse_buffer *const input_buffe
 	/* parse the different types of values */
 	/* null */
 	if (can_read(input_buffer, 4) && (strncmp((const char *)buffer_at_offset(input_buffer), "null", 4) == 0)) {
-		item->type = cJSON_NULL;
+		item->type = cJSON_NULL | (item->type & cJSON_InArena);
 		input_buffer->offset += 4;
 		return true;
 	}
 	/* false */
 	if (can_read(input_buffer, 5) && (strncmp((const char *)buffer_at_offset(input_buffer), "false", 5) == 0)) {
-		item->type = cJSON_False;
+		item->type = cJSON_False | (item->type & cJSON_InArena);
 		input_buffer->offset += 5;
 		return true;
 	}
 	/* true */
 	if (can_read(input_buffer, 4) && (strncmp((const char *)buffer_at_offset(input_buffer), "true", 4) == 0)) {
-		item->type = cJSON_True;
+		item->type = cJSON_True | (item->type & cJSON_InArena);
 		item->valueint = 1;
 		input_buffer->offset += 4;
 		return true;
@@ -1302,7 +1471,7 @@ static cJSON_bool parse_array(cJSON *const item, parse_buffer *const input_buffe
 	/* loop through the comma separated array elements */
 	do {
 		/* allocate next item */
-		cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+		cJSON *new_item = parse_new_item(input_buffer);
 		if (new_item == NULL) {
 			goto fail; /* allocation failure */
 		}
@@ -1338,7 +1507,7 @@ success:
 		head->prev = current_item;
 	}
 
-	item->type = cJSON_Array;
+	item->type = cJSON_Array | (item->type & cJSON_InArena);
 	item->child = head;
 
 	input_buffer->offset++;
@@ -1439,7 +1608,7 @@ static cJSON_bool parse_object(cJSON *const item, parse_buffer *const input_buff
 	/* loop through the comma separated array elements */
 	do {
 		/* allocate next item */
-		cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+		cJSON *new_item = parse_new_item(input_buffer);
 		if (new_item == NULL) {
 			goto fail; /* allocation failure */
 		}
@@ -1491,7 +1660,7 @@ success:
 		head->prev = current_item;
 	}
 
-	item->type = cJSON_Object;
+	item->type = cJSON_Object | (item->type & cJSON_InArena);
 	item->child = head;
 
 	input_buffer->offset++;
@@ -1782,6 +1951,10 @@ static cJSON_bool add_item_to_object(cJSON *const object, const char *const stri
 		new_key = (char *)cast_away_const(string);
 		new_type = item->type | cJSON_StringIsConst;
 	} else {
+		if (item->type & cJSON_InArena) {
+			/* nothing would free a heap key of an arena node */
+			return false;
+		}
 		new_key = (char *)cJSON_strdup((const unsigned char *)string, hooks);
 		if (new_key == NULL) {
 			return false;
@@ -1790,7 +1963,7 @@ static cJSON_bool add_item_to_object(cJSON *const object, const char *const stri
 		new_type = item->type & ~cJSON_StringIsConst;
 	}
 
-	if (!(item->type & cJSON_StringIsConst) && (item->string != NULL)) {
+	if (!(item->type & (cJSON_StringIsConst | cJSON_InArena)) && (item->string != NULL)) {
 		hooks->deallocate(item->string);
 	}
 
@@ -2073,7 +2246,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON
 
 static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSON *replacement, cJSON_bool case_sensitive)
 {
-	if ((replacement == NULL) || (string == NULL)) {
+	if ((replacement == NULL) || (string == NULL) || (replacement->type & cJSON_InArena)) {
 		return false;
 	}
 
@@ -2396,7 +2569,7 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
 		goto fail;
 	}
 	/* Copy over all vars */
-	newitem->type = item->type & (~cJSON_IsReference);
+	newitem->type = item->type & (~(cJSON_IsReference | cJSON_InArena));
 	newitem->valueint = item->valueint;
 	newitem->valuedouble = item->valuedouble;
 	if (item->valuestring) {
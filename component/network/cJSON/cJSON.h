@@ -98,6 +98,7 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+#define cJSON_InArena 1024 /* node, key and value string are owned by a cJSON_Arena */
 
 /* The cJSON structure: */
 typedef struct cJSON {
@@ -129,6 +130,16 @@ typedef struct cJSON_Hooks {
 
 typedef int cJSON_bool;
 
+/* Memory of the trees built by cJSON_ParseInPlace. Nodes are carved from one buffer and released all at once by
+ * cJSON_ResetArena, key and string values point into the parsed input. */
+typedef struct cJSON_Arena {
+	unsigned char *buffer;
+	size_t size;
+	size_t used;
+	size_t peak; /* highest used since cJSON_InitArena */
+	void *allocation; /* what the cJSON hooks returned when cJSON_ParseInPlace allocated the buffer, else NULL */
+} cJSON_Arena;
+
 /* Limits how deeply nested arrays/objects can be before cJSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef CJSON_NESTING_LIMIT
@@ -150,6 +161,20 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
 
+/* Arena parse: no allocation per value. Strings are unescaped inside value itself, which must stay valid and unchanged
+ * for the lifetime of the tree, and is modified even if the parse fails. With an arena initialized on a NULL buffer,
+ * the first parse allocates a buffer of cJSON_ArenaSize bytes; otherwise parsing fails when the arena is full.
+ * The tree is read with the usual accessors and cJSON_ResetArena releases it at once. cJSON_Delete frees only the heap
+ * items added into an arena tree, arena nodes accept constant keys only, cJSON_Duplicate returns an ordinary heap tree. */
+CJSON_PUBLIC(void) cJSON_InitArena(cJSON_Arena *arena, void *buffer, size_t size);
+/* Arena bytes needed to parse value, counted by a scan of the structure without building anything. */
+CJSON_PUBLIC(size_t) cJSON_ArenaSize(const char *value, size_t buffer_length);
+CJSON_PUBLIC(cJSON *) cJSON_ParseInPlace(char *value, size_t buffer_length, cJSON_Arena *arena);
+/* Drop every tree parsed into the arena, the buffer is kept for the next parse. */
+CJSON_PUBLIC(void) cJSON_ResetArena(cJSON_Arena *arena);
+/* Reset and give back a buffer allocated by cJSON_ParseInPlace. */
+CJSON_PUBLIC(void) cJSON_FreeArena(cJSON_Arena *arena);
+
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. */
@@ -106,6 +106,22 @@ int coap_send(char *to_address, uint16_t port, int socket, sn_coap_hdr_s *coap_m
 */
 int coap_recv(int socket, struct sockaddr_in *from_address, void *buf, uint32_t buf_size);
 
+/**
+* \brief	Streaming block payload callback that writes each received block to a VFS file at its offset,
+* 			register it with **sn_coap_protocol_set_block_payload_callback()** to receive big blockwise payloads with one block of RAM
+* \param 	*handle : CoAP handle the block was received on
+* \param 	*src_addr_ptr : address the block was received from
+* \param 	offset : byte offset of the block in the whole payload
+* \param 	*payload_ptr : block payload
+* \param 	payload_len : block payload length
+* \param 	last : 1 if this is the last block, the file is flushed then
+* \param 	*ctx : FILE pointer opened for writing by the application on a **find_vfs_tag()** prefixed path
+* \return 	0 = if block is written
+* \return 	-1 = if seek or write failed, the transfer is aborted
+*/
+int8_t coap_block_file_sink(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint32_t offset, uint8_t *payload_ptr, uint16_t payload_len,
+							uint8_t last, void *ctx);
+
 /**
 * \brief	Print CoAP message header (for debug use)
 * \param 	*parsed_hdr : pointer to constructed CoAP message header
@@ -35,6 +35,22 @@ extern "C" {
 
 #include "sn_coap_header.h"
 
+/**
+ * \brief Streaming block payload callback, see sn_coap_protocol_set_block_payload_callback().
+ *
+ * \param handle Pointer to CoAP library handle
+ * \param src_addr_ptr Address from where the block has been received
+ * \param offset Byte offset of this block in the whole payload (block number * block size)
+ * \param payload_ptr Payload of the block, only valid during the call
+ * \param payload_len Length of the block payload
+ * \param last 1 if this is the last block (more bit not set), otherwise 0
+ * \param ctx Context given when registering the callback
+ *
+ * \return 0 to continue the transfer, negative value to abort it
+ */
+typedef int8_t (*sn_coap_block_payload_cb)(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint32_t offset,
+        uint8_t *payload_ptr, uint16_t payload_len, uint8_t last, void *ctx);
+
 /**
  * \fn struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), void (*used_free_func_ptr)(void *), uint8_t (*used_tx_callback_ptr)(uint8_t *, uint16_t, sn_nsdl_addr_s *, void *), int8_t (*used_rx_callback_ptr)(sn_coap_hdr_s *, sn_nsdl_addr_s *, void *)); 
  *
@@ -209,6 +225,24 @@ extern void sn_coap_protocol_clear_retransmission_buffer(struct coap_s *handle);
  */
 extern void sn_coap_protocol_block_remove(struct coap_s *handle, sn_nsdl_addr_s *source_address, uint16_t payload_length, void *payload);
 
+/**
+ * \fn int8_t sn_coap_protocol_set_block_payload_callback(struct coap_s *handle, sn_coap_block_payload_cb block_cb, void *ctx)
+ *
+ * \brief If block transfer is enabled, received Block1 requests and Block2 responses are handed to block_cb
+ *        one block at a time as they arrive, instead of being stored and concatenated into one payload.
+ *        Memory use is then bounded by one block regardless of the whole payload size.
+ *        When the last block has been delivered, the message is returned with status
+ *        COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED and an empty payload.
+ *        If block_cb returns a negative value the transfer is aborted and the message is dropped.
+ *
+ * \param handle Pointer to CoAP library handle
+ * \param block_cb Callback for received blocks, NULL restores store-and-concatenate behavior
+ * \param ctx Context passed to block_cb
+ * \return  0 = success\n
+ *         -1 = failure
+ */
+extern int8_t sn_coap_protocol_set_block_payload_callback(struct coap_s *handle, sn_coap_block_payload_cb block_cb, void *ctx);
+
 /**
  * \fn void sn_coap_protocol_delete_retransmission(struct coap_s *handle, uint16_t msg_id)
  *
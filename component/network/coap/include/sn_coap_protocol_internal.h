@@ -133,6 +133,11 @@ struct sn_coap_hdr_;
 #define COAP_OPTION_URI_PORT_NONE                   (-1) /**< Internal value to represent no Uri-Port option */
 #define COAP_OPTION_BLOCK_NONE                      (-1) /**< Internal value to represent no Block1/2 option */
 
+/* * For stored message lookup * */
+#ifndef SN_COAP_HASH_BUCKETS
+#define SN_COAP_HASH_BUCKETS                        8  /**< Buckets for (address, port, message ID) lookup, must be 2^x */
+#endif
+
 
 #if SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwising is not used at all, this part of code will not be compiled */
 int8_t prepare_blockwise_message(struct coap_s *handle, struct sn_coap_hdr_ *coap_hdr_ptr);
@@ -148,10 +153,14 @@ typedef struct coap_send_msg_ {
 	struct coap_s       *coap;              /* CoAP library handle */
 	void                *param;             /* Extra parameter that will be passed to TX/RX callback functions */
 
+	uint16_t            msg_id;             /* Message ID of stored packet, lookup key */
+
 	ns_list_link_t      link;
+	ns_list_link_t      hash_link;          /* Link in (address, port, message ID) bucket */
 } coap_send_msg_s;
 
 typedef NS_LIST_HEAD(coap_send_msg_s, link) coap_send_msg_list_t;
+typedef NS_LIST_HEAD(coap_send_msg_s, hash_link) coap_send_msg_bucket_t;
 
 /* Structure which is stored to Linked list for message duplication detection purposes */
 typedef struct coap_duplication_info_ {
@@ -166,9 +175,11 @@ typedef struct coap_duplication_info_ {
 	struct coap_s       *coap;  /* CoAP library handle */
 
 	ns_list_link_t     link;
+	ns_list_link_t     hash_link;
 } coap_duplication_info_s;
 
 typedef NS_LIST_HEAD(coap_duplication_info_s, link) coap_duplication_info_list_t;
+typedef NS_LIST_HEAD(coap_duplication_info_s, hash_link) coap_duplication_info_bucket_t;
 
 /* Structure which is stored to Linked list for blockwise messages sending purposes */
 typedef struct coap_blockwise_msg_ {
@@ -195,9 +206,11 @@ typedef struct coap_blockwise_payload_ {
 	struct coap_s       *coap;  /* CoAP library handle */
 
 	ns_list_link_t     link;
+	ns_list_link_t     hash_link;
 } coap_blockwise_payload_s;
 
 typedef NS_LIST_HEAD(coap_blockwise_payload_s, link) coap_blockwise_payload_list_t;
+typedef NS_LIST_HEAD(coap_blockwise_payload_s, hash_link) coap_blockwise_payload_bucket_t;
 
 struct coap_s {
 	void *(*sn_coap_protocol_malloc)(uint16_t);
@@ -208,17 +221,22 @@ struct coap_s {
 
 #if ENABLE_RESENDINGS /* If Message resending is not used at all, this part of code will not be compiled */
 	coap_send_msg_list_t linked_list_resent_msgs; /* Active resending messages are stored to this Linked list */
+	coap_send_msg_bucket_t hash_resent_msgs[SN_COAP_HASH_BUCKETS]; /* Same messages hashed by (address, port, message ID) */
 	uint16_t count_resent_msgs;
 #endif
 
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
 	coap_duplication_info_list_t  linked_list_duplication_msgs; /* Messages for duplicated messages detection is stored to this Linked list */
+	coap_duplication_info_bucket_t hash_duplication_msgs[SN_COAP_HASH_BUCKETS]; /* Same infos hashed by (address, port, message ID) */
 	uint16_t                      count_duplication_msgs;
 #endif
 
 #if SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwise is not used at all, this part of code will not be compiled */
 	coap_blockwise_msg_list_t     linked_list_blockwise_sent_msgs; /* Blockwise message to to be sent is stored to this Linked list */
 	coap_blockwise_payload_list_t linked_list_blockwise_received_payloads; /* Blockwise payload to to be received is stored to this Linked list */
+	coap_blockwise_payload_bucket_t hash_blockwise_received_payloads[SN_COAP_HASH_BUCKETS]; /* Same payloads hashed by (address, port) */
+	sn_coap_block_payload_cb      sn_coap_block_payload_callback; /* If set, received blocks are streamed here instead of stored */
+	void                          *sn_coap_block_payload_ctx;
 #endif
 
 	uint32_t system_time;    /* System time seconds */
@@ -136,6 +136,37 @@ int coap_recv(int socket, struct sockaddr_in *from_address, void *buf, uint32_t
 	return recvfrom(socket, buf, buf_size, 0, (struct sockaddr *) from_address, (socklen_t *)&addr_len);
 }
 
+///////////////////////////////////////////blockwise file sink///////////////////////////////////////////
+int8_t coap_block_file_sink(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint32_t offset, uint8_t *payload_ptr, uint16_t payload_len,
+							uint8_t last, void *ctx)
+{
+	(void) handle;
+	(void) src_addr_ptr;
+
+	FILE *file = (FILE *)ctx;
+
+	if (file == NULL) {
+		return -1;
+	}
+
+	// Blocks normally arrive in order, only seek when a block is repeated or skipped
+	if ((uint32_t)ftell(file) != offset && fseek(file, (long)offset, SEEK_SET) != 0) {
+		tr_debug("ERROR: seek block offset %u", (unsigned int)offset);
+		return -1;
+	}
+
+	if (payload_len && fwrite(payload_ptr, 1, payload_len, file) != payload_len) {
+		tr_debug("ERROR: write block offset %u", (unsigned int)offset);
+		return -1;
+	}
+
+	if (last) {
+		fflush(file);
+	}
+
+	return 0;
+}
+
 /////////////////////////////////////////print header///////////////////////////////////////////
 void coap_print_hdr(sn_coap_hdr_s *parsed_hdr)
 {
@@ -40,22 +40,23 @@
 /* * * * * * * * * * * * * * * * * * * * */
 
 static void                  sn_coap_protocol_send_rst(struct coap_s *handle, uint16_t msg_id, sn_nsdl_addr_s *addr_ptr, void *param);
+static uint8_t               sn_coap_protocol_hash(const uint8_t *addr_ptr, uint8_t addr_len, uint16_t port, uint16_t msg_id);
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT/* If Message duplication detection is not used at all, this part of code will not be compiled */
 static void                  sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id);
 static int8_t                sn_coap_protocol_linked_list_duplication_info_search(struct coap_s *handle, sn_nsdl_addr_s *scr_addr_ptr, uint16_t msg_id);
-static void                  sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, uint8_t *scr_addr_ptr, uint16_t port, uint16_t msg_id);
+static void                  sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, coap_duplication_info_s *removed_duplication_info_ptr);
 static void                  sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle);
 #endif
 #if SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwising is not used at all, this part of code will not be compiled */
 static void                  sn_coap_protocol_linked_list_blockwise_msg_remove(struct coap_s *handle, coap_blockwise_msg_s *removed_msg_ptr);
 static void                  sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *handle, sn_nsdl_addr_s *addr_ptr, uint16_t stored_payload_len,
 		uint8_t *stored_payload_ptr);
-static uint8_t              *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr,
-		uint16_t *payload_length);
+static coap_blockwise_payload_s *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr);
 static void                  sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle, coap_blockwise_payload_s *removed_payload_ptr);
-static void                  sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(struct coap_s *handle);
 static uint32_t              sn_coap_protocol_linked_list_blockwise_payloads_get_len(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr);
 static void                  sn_coap_protocol_linked_list_blockwise_remove_old_data(struct coap_s *handle);
+static int8_t                sn_coap_protocol_block_payload_deliver(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr,
+		int32_t block);
 static sn_coap_hdr_s        *sn_coap_handle_blockwise_message(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr,
 		void *param);
 static int8_t                sn_coap_convert_block_size(uint16_t block_size);
@@ -64,8 +65,10 @@ static sn_coap_hdr_s        *sn_coap_protocol_copy_header(struct coap_s *handle,
 #if ENABLE_RESENDINGS
 static uint8_t               sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint16_t send_packet_data_len,
 		uint8_t *send_packet_data_ptr, uint32_t sending_time, void *param);
+static coap_send_msg_s      *sn_coap_protocol_linked_list_send_msg_lookup(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id);
 static sn_nsdl_transmit_s   *sn_coap_protocol_linked_list_send_msg_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id);
 static void                  sn_coap_protocol_linked_list_send_msg_remove(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id);
+static void                  sn_coap_protocol_linked_list_send_msg_unlink(struct coap_s *handle, coap_send_msg_s *removed_msg_ptr);
 static coap_send_msg_s      *sn_coap_protocol_allocate_mem_for_msg(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint16_t packet_data_len);
 static void                  sn_coap_protocol_release_allocated_send_msg_mem(struct coap_s *handle, coap_send_msg_s *freed_send_msg_ptr);
 static uint16_t              sn_coap_count_linked_list_size(const coap_send_msg_list_t *linked_list_ptr);
@@ -90,14 +93,7 @@ int8_t sn_coap_protocol_destroy(struct coap_s *handle)
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
 	ns_list_foreach_safe(coap_duplication_info_s, tmp, &handle->linked_list_duplication_msgs) {
 		if (tmp->coap == handle) {
-			if (tmp->addr_ptr) {
-				handle->sn_coap_protocol_free(tmp->addr_ptr);
-				tmp->addr_ptr = 0;
-			}
-			ns_list_remove(&handle->linked_list_duplication_msgs, tmp);
-			handle->count_duplication_msgs--;
-			handle->sn_coap_protocol_free(tmp);
-			tmp = 0;
+			sn_coap_protocol_linked_list_duplication_info_remove(handle, tmp);
 		}
 	}
 #endif
@@ -119,17 +115,7 @@ int8_t sn_coap_protocol_destroy(struct coap_s *handle)
 	}
 	ns_list_foreach_safe(coap_blockwise_payload_s, tmp, &handle->linked_list_blockwise_received_payloads) {
 		if (tmp->coap == handle) {
-			if (tmp->addr_ptr) {
-				handle->sn_coap_protocol_free(tmp->addr_ptr);
-				tmp->addr_ptr = 0;
-			}
-			if (tmp->payload_ptr) {
-				handle->sn_coap_protocol_free(tmp->payload_ptr);
-				tmp->payload_ptr = 0;
-			}
-			ns_list_remove(&handle->linked_list_blockwise_received_payloads, tmp);
-			handle->sn_coap_protocol_free(tmp);
-			tmp = 0;
+			sn_coap_protocol_linked_list_blockwise_payload_remove(handle, tmp);
 		}
 	}
 #endif
@@ -172,6 +158,9 @@ struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), vo
 
 	/* * * * Create Linked list for storing active resending messages  * * * */
 	ns_list_init(&handle->linked_list_resent_msgs);
+	for (uint8_t i = 0; i < SN_COAP_HASH_BUCKETS; i++) {
+		ns_list_init(&handle->hash_resent_msgs[i]);
+	}
 	handle->sn_coap_resending_queue_msgs = SN_COAP_RESENDING_QUEUE_SIZE_MSGS;
 	handle->sn_coap_resending_queue_bytes = SN_COAP_RESENDING_QUEUE_SIZE_BYTES;
 	handle->sn_coap_resending_intervall = DEFAULT_RESPONSE_TIMEOUT;
@@ -183,6 +172,9 @@ struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), vo
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
 	/* * * * Create Linked list for storing Duplication info * * * */
 	ns_list_init(&handle->linked_list_duplication_msgs);
+	for (uint8_t i = 0; i < SN_COAP_HASH_BUCKETS; i++) {
+		ns_list_init(&handle->hash_duplication_msgs[i]);
+	}
 	handle->sn_coap_duplication_buffer_size = SN_COAP_DUPLICATION_MAX_MSGS_COUNT;
 #endif
 
@@ -190,6 +182,9 @@ struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), vo
 
 	ns_list_init(&handle->linked_list_blockwise_sent_msgs);
 	ns_list_init(&handle->linked_list_blockwise_received_payloads);
+	for (uint8_t i = 0; i < SN_COAP_HASH_BUCKETS; i++) {
+		ns_list_init(&handle->hash_blockwise_received_payloads[i]);
+	}
 	handle->sn_coap_block_data_size = SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE;
 
 #endif /* ENABLE_RESENDINGS */
@@ -232,6 +227,22 @@ int8_t sn_coap_protocol_set_block_size(struct coap_s *handle, uint16_t block_siz
 
 }
 
+int8_t sn_coap_protocol_set_block_payload_callback(struct coap_s *handle, sn_coap_block_payload_cb block_cb, void *ctx)
+{
+	(void) handle;
+	(void) block_cb;
+	(void) ctx;
+#if SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+	if (handle == NULL) {
+		return -1;
+	}
+	handle->sn_coap_block_payload_callback = block_cb;
+	handle->sn_coap_block_payload_ctx = ctx;
+	return 0;
+#endif
+	return -1;
+}
+
 int8_t sn_coap_protocol_set_duplicate_buffer_size(struct coap_s *handle, uint8_t message_count)
 {
 	(void) handle;
@@ -296,9 +307,8 @@ void sn_coap_protocol_clear_retransmission_buffer(struct coap_s *handle)
 		return;
 	}
 	ns_list_foreach_safe(coap_send_msg_s, tmp, &handle->linked_list_resent_msgs) {
-		ns_list_remove(&handle->linked_list_resent_msgs, tmp);
+		sn_coap_protocol_linked_list_send_msg_unlink(handle, tmp);
 		sn_coap_protocol_release_allocated_send_msg_mem(handle, tmp);
-		--handle->count_resent_msgs;
 	}
 #endif
 }
@@ -310,15 +320,10 @@ int8_t sn_coap_protocol_delete_retransmission(struct coap_s *handle, uint16_t ms
 		return -1;
 	}
 	ns_list_foreach_safe(coap_send_msg_s, tmp, &handle->linked_list_resent_msgs) {
-		if (tmp->send_msg_ptr && tmp->send_msg_ptr->packet_ptr) {
-			uint16_t temp_msg_id = (tmp->send_msg_ptr->packet_ptr[2] << 8);
-			temp_msg_id += (uint16_t)tmp->send_msg_ptr->packet_ptr[3];
-			if (temp_msg_id == msg_id) {
-				ns_list_remove(&handle->linked_list_resent_msgs, tmp);
-				--handle->count_resent_msgs;
-				sn_coap_protocol_release_allocated_send_msg_mem(handle, tmp);
-				return 0;
-			}
+		if (tmp->msg_id == msg_id) {
+			sn_coap_protocol_linked_list_send_msg_unlink(handle, tmp);
+			sn_coap_protocol_release_allocated_send_msg_mem(handle, tmp);
+			return 0;
 		}
 	}
 #endif
@@ -603,8 +608,7 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *handle, sn_nsdl_addr_s *src
 				coap_duplication_info_s *stored_duplication_info_ptr = ns_list_get_first(&handle->linked_list_duplication_msgs);
 
 				/* Remove oldest stored duplication message for getting room for new duplication message */
-				sn_coap_protocol_linked_list_duplication_info_remove(handle, stored_duplication_info_ptr->addr_ptr, stored_duplication_info_ptr->port,
-						stored_duplication_info_ptr->msg_id);
+				sn_coap_protocol_linked_list_duplication_info_remove(handle, stored_duplication_info_ptr);
 			}
 
 			/* Store Duplication info to Linked list */
@@ -726,10 +730,6 @@ int8_t sn_coap_protocol_exec(struct coap_s *handle, uint32_t current_time)
 				if (stored_msg_ptr->resending_counter > handle->sn_coap_resending_count) {
 					coap_version_e coap_version = COAP_VERSION_UNKNOWN;
 
-					/* Get message ID from stored sending message */
-					uint16_t temp_msg_id = (stored_msg_ptr->send_msg_ptr->packet_ptr[2] << 8);
-					temp_msg_id += (uint16_t)stored_msg_ptr->send_msg_ptr->packet_ptr[3];
-
 					/* If RX callback have been defined.. */
 					if (stored_msg_ptr->coap->sn_coap_rx_callback != 0) {
 						sn_coap_hdr_s *tmp_coap_hdr_ptr;
@@ -745,7 +745,8 @@ int8_t sn_coap_protocol_exec(struct coap_s *handle, uint32_t current_time)
 						}
 					}
 					/* Remove message from Linked list */
-					sn_coap_protocol_linked_list_send_msg_remove(handle, stored_msg_ptr->send_msg_ptr->dst_addr_ptr, temp_msg_id);
+					sn_coap_protocol_linked_list_send_msg_unlink(handle, stored_msg_ptr);
+					sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
 				} else {
 					/* Send message  */
 					stored_msg_ptr->coap->sn_coap_tx_callback(stored_msg_ptr->send_msg_ptr->packet_ptr,
@@ -833,51 +834,70 @@ static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle
 
 	stored_msg_ptr->coap = handle;
 	stored_msg_ptr->param = param;
+	stored_msg_ptr->msg_id = ((uint16_t)send_packet_data_ptr[2] << 8) | send_packet_data_ptr[3];
 
-	/* Storing Resending message to Linked list */
+	/* Storing Resending message to Linked list and to its lookup bucket */
 	ns_list_add_to_end(&handle->linked_list_resent_msgs, stored_msg_ptr);
+	ns_list_add_to_end(&handle->hash_resent_msgs[sn_coap_protocol_hash(dst_addr_ptr->addr_ptr, dst_addr_ptr->addr_len,
+					   dst_addr_ptr->port, stored_msg_ptr->msg_id)], stored_msg_ptr);
 	++handle->count_resent_msgs;
 	return 1;
 }
 
 /**************************************************************************//**
- * \fn static sn_nsdl_transmit_s *sn_coap_protocol_linked_list_send_msg_search(sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
+ * \fn static coap_send_msg_s *sn_coap_protocol_linked_list_send_msg_lookup(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
  *
- * \brief Searches stored resending message from Linked list
+ * \brief Finds stored resending message from its lookup bucket
  *
  * \param *src_addr_ptr is searching key for searched message
  *
  * \param msg_id is searching key for searched message
  *
- * \return Return value is pointer to found stored resending message in Linked
- *         list or NULL if message not found
+ * \return Return value is pointer to found stored resending message or NULL if message not found
  *****************************************************************************/
 
-static sn_nsdl_transmit_s *sn_coap_protocol_linked_list_send_msg_search(struct coap_s *handle,
+static coap_send_msg_s *sn_coap_protocol_linked_list_send_msg_lookup(struct coap_s *handle,
 		sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
 {
-	/* Loop all stored resending messages Linked list */
-	ns_list_foreach(coap_send_msg_s, stored_msg_ptr, &handle->linked_list_resent_msgs) {
-		/* Get message ID from stored resending message */
-		uint16_t temp_msg_id = (stored_msg_ptr->send_msg_ptr->packet_ptr[2] << 8);
-		temp_msg_id += (uint16_t)stored_msg_ptr->send_msg_ptr->packet_ptr[3];
+	uint8_t bucket = sn_coap_protocol_hash(src_addr_ptr->addr_ptr, src_addr_ptr->addr_len, src_addr_ptr->port, msg_id);
 
-		/* If message's Message ID is same than is searched */
-		if (temp_msg_id == msg_id) {
-			/* If message's Source address is same than is searched */
-			if (0 == memcmp(src_addr_ptr->addr_ptr, stored_msg_ptr->send_msg_ptr->dst_addr_ptr->addr_ptr, src_addr_ptr->addr_len)) {
-				/* If message's Source address port is same than is searched */
-				if (stored_msg_ptr->send_msg_ptr->dst_addr_ptr->port == src_addr_ptr->port) {
-					/* * * Message found, return pointer to that stored resending message * * * */
-					return stored_msg_ptr->send_msg_ptr;
-				}
-			}
+	/* Loop only the messages sharing the hash of the searched key */
+	ns_list_foreach(coap_send_msg_s, stored_msg_ptr, &handle->hash_resent_msgs[bucket]) {
+		sn_nsdl_addr_s *dst_addr_ptr = stored_msg_ptr->send_msg_ptr->dst_addr_ptr;
+
+		if (stored_msg_ptr->msg_id == msg_id &&
+			dst_addr_ptr->port == src_addr_ptr->port &&
+			dst_addr_ptr->addr_len == src_addr_ptr->addr_len &&
+			0 == memcmp(src_addr_ptr->addr_ptr, dst_addr_ptr->addr_ptr, src_addr_ptr->addr_len)) {
+			return stored_msg_ptr;
 		}
 	}
 
 	/* Message not found */
 	return NULL;
 }
+
+/**************************************************************************//**
+ * \fn static sn_nsdl_transmit_s *sn_coap_protocol_linked_list_send_msg_search(sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
+ *
+ * \brief Searches stored resending message from Linked list
+ *
+ * \param *src_addr_ptr is searching key for searched message
+ *
+ * \param msg_id is searching key for searched message
+ *
+ * \return Return value is pointer to found stored resending message in Linked
+ *         list or NULL if message not found
+ *****************************************************************************/
+
+static sn_nsdl_transmit_s *sn_coap_protocol_linked_list_send_msg_search(struct coap_s *handle,
+		sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
+{
+	coap_send_msg_s *stored_msg_ptr = sn_coap_protocol_linked_list_send_msg_lookup(handle, src_addr_ptr, msg_id);
+
+	return stored_msg_ptr ? stored_msg_ptr->send_msg_ptr : NULL;
+}
+
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_send_msg_remove(sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
  *
@@ -889,32 +909,32 @@ static sn_nsdl_transmit_s *sn_coap_protocol_linked_list_send_msg_search(struct c
 
 static void sn_coap_protocol_linked_list_send_msg_remove(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
 {
-	/* Loop all stored resending messages in Linked list */
-	ns_list_foreach(coap_send_msg_s, stored_msg_ptr, &handle->linked_list_resent_msgs) {
-		/* Get message ID from stored resending message */
-		uint16_t temp_msg_id = (stored_msg_ptr->send_msg_ptr->packet_ptr[2] << 8);
-		temp_msg_id += (uint16_t)stored_msg_ptr->send_msg_ptr->packet_ptr[3];
+	coap_send_msg_s *stored_msg_ptr = sn_coap_protocol_linked_list_send_msg_lookup(handle, src_addr_ptr, msg_id);
 
-		/* If message's Message ID is same than is searched */
-		if (temp_msg_id == msg_id) {
-			/* If message's Source address is same than is searched */
-			if (0 == memcmp(src_addr_ptr->addr_ptr, stored_msg_ptr->send_msg_ptr->dst_addr_ptr->addr_ptr, src_addr_ptr->addr_len)) {
-				/* If message's Source address port is same than is searched */
-				if (stored_msg_ptr->send_msg_ptr->dst_addr_ptr->port == src_addr_ptr->port) {
-					/* * * Message found * * */
+	if (stored_msg_ptr != NULL) {
+		sn_coap_protocol_linked_list_send_msg_unlink(handle, stored_msg_ptr);
 
-					/* Remove message from Linked list */
-					ns_list_remove(&handle->linked_list_resent_msgs, stored_msg_ptr);
-					--handle->count_resent_msgs;
+		/* Free memory of stored message */
+		sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
+	}
+}
 
-					/* Free memory of stored message */
-					sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_linked_list_send_msg_unlink(struct coap_s *handle, coap_send_msg_s *removed_msg_ptr)
+ *
+ * \brief Removes stored resending message from Linked list and its lookup bucket, memory is not freed
+ *
+ * \param *removed_msg_ptr is message to be removed
+ *****************************************************************************/
 
-					return;
-				}
-			}
-		}
-	}
+static void sn_coap_protocol_linked_list_send_msg_unlink(struct coap_s *handle, coap_send_msg_s *removed_msg_ptr)
+{
+	sn_nsdl_addr_s *dst_addr_ptr = removed_msg_ptr->send_msg_ptr->dst_addr_ptr;
+
+	ns_list_remove(&handle->linked_list_resent_msgs, removed_msg_ptr);
+	ns_list_remove(&handle->hash_resent_msgs[sn_coap_protocol_hash(dst_addr_ptr->addr_ptr, dst_addr_ptr->addr_len,
+				   dst_addr_ptr->port, removed_msg_ptr->msg_id)], removed_msg_ptr);
+	--handle->count_resent_msgs;
 }
 #endif /* ENABLE_RESENDINGS */
 
@@ -938,6 +958,35 @@ static void sn_coap_protocol_send_rst(struct coap_s *handle, uint16_t msg_id, sn
 	handle->sn_coap_tx_callback(packet_ptr, 4, addr_ptr, param);
 
 }
+
+/**************************************************************************//**
+ * \fn static uint8_t sn_coap_protocol_hash(const uint8_t *addr_ptr, uint8_t addr_len, uint16_t port, uint16_t msg_id)
+ *
+ * \brief Maps (address, port, message ID) to a lookup bucket, FNV-1a over the key bytes
+ *
+ * \param *addr_ptr is pointer to Address key
+ * \param addr_len is length of Address key
+ * \param port is Port key
+ * \param msg_id is Message ID key, 0 when only address and port are used
+ *
+ * \return Bucket index, 0 ... SN_COAP_HASH_BUCKETS - 1
+ *****************************************************************************/
+
+static uint8_t sn_coap_protocol_hash(const uint8_t *addr_ptr, uint8_t addr_len, uint16_t port, uint16_t msg_id)
+{
+	uint32_t hash = 2166136261u;
+	uint8_t i;
+
+	for (i = 0; i < addr_len; i++) {
+		hash = (hash ^ addr_ptr[i]) * 16777619u;
+	}
+	hash = (hash ^ (port & 0xFF)) * 16777619u;
+	hash = (hash ^ (port >> 8)) * 16777619u;
+	hash = (hash ^ (msg_id & 0xFF)) * 16777619u;
+	hash = (hash ^ (msg_id >> 8)) * 16777619u;
+
+	return (uint8_t)((hash ^ (hash >> 16)) & (SN_COAP_HASH_BUCKETS - 1));
+}
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
 
 /**************************************************************************//**
@@ -985,6 +1034,8 @@ static void sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *h
 	/* * * * Storing Duplication info to Linked list * * * */
 
 	ns_list_add_to_end(&handle->linked_list_duplication_msgs, stored_duplication_info_ptr);
+	ns_list_add_to_end(&handle->hash_duplication_msgs[sn_coap_protocol_hash(addr_ptr->addr_ptr, addr_ptr->addr_len, addr_ptr->port, msg_id)],
+					   stored_duplication_info_ptr);
 	++handle->count_duplication_msgs;
 }
 
@@ -1002,12 +1053,15 @@ static void sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *h
 static int8_t sn_coap_protocol_linked_list_duplication_info_search(struct coap_s *handle,
 		sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
 {
-	/* Loop all nodes in Linked list for searching Message ID */
-	ns_list_foreach(coap_duplication_info_s, stored_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
+	uint8_t bucket = sn_coap_protocol_hash(addr_ptr->addr_ptr, addr_ptr->addr_len, addr_ptr->port, msg_id);
+
+	/* Loop only the nodes sharing the hash of the searched key */
+	ns_list_foreach(coap_duplication_info_s, stored_duplication_info_ptr, &handle->hash_duplication_msgs[bucket]) {
 		/* If message's Message ID is same than is searched */
 		if (stored_duplication_info_ptr->msg_id == msg_id) {
 			/* If message's Source address is same than is searched */
-			if (0 == memcmp(addr_ptr->addr_ptr, stored_duplication_info_ptr->addr_ptr, addr_ptr->addr_len)) {
+			if (stored_duplication_info_ptr->addr_len == addr_ptr->addr_len &&
+				0 == memcmp(addr_ptr->addr_ptr, stored_duplication_info_ptr->addr_ptr, addr_ptr->addr_len)) {
 				/* If message's Source address port is same than is searched */
 				if (stored_duplication_info_ptr->port == addr_ptr->port) {
 					/* * * Correct Duplication info found * * * */
@@ -1021,42 +1075,24 @@ static int8_t sn_coap_protocol_linked_list_duplication_info_search(struct coap_s
 }
 
 /**************************************************************************//**
- * \fn static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, uint8_t *addr_ptr, uint16_t port, uint16_t msg_id)
+ * \fn static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, coap_duplication_info_s *removed_duplication_info_ptr)
  *
- * \brief Removes stored Duplication info from Linked list
+ * \brief Removes stored Duplication info from Linked list and its lookup bucket
  *
- * \param *addr_ptr is pointer to Address key to be removed
- *
- * \param port is Port key to be removed
- *
- * \param msg_id is Message ID key to be removed
+ * \param *removed_duplication_info_ptr is Duplication info to be removed
  *****************************************************************************/
 
-static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, uint8_t *addr_ptr, uint16_t port, uint16_t msg_id)
+static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, coap_duplication_info_s *removed_duplication_info_ptr)
 {
-	/* Loop all stored duplication messages in Linked list */
-	ns_list_foreach(coap_duplication_info_s, removed_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
-		/* If message's Address is same than is searched */
-		if (handle == removed_duplication_info_ptr->coap && 0 == memcmp(addr_ptr, removed_duplication_info_ptr->addr_ptr, removed_duplication_info_ptr->addr_len)) {
-			/* If message's Address prt is same than is searched */
-			if (removed_duplication_info_ptr->port == port) {
-				/* If Message ID is same than is searched */
-				if (removed_duplication_info_ptr->msg_id == msg_id) {
-					/* * * * Correct Duplication info found, remove it from Linked list * * * */
-					ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
-					--handle->count_duplication_msgs;
-
-					/* Free memory of stored Duplication info */
-					handle->sn_coap_protocol_free(removed_duplication_info_ptr->addr_ptr);
-					removed_duplication_info_ptr->addr_ptr = 0;
-					handle->sn_coap_protocol_free(removed_duplication_info_ptr);
-					removed_duplication_info_ptr = 0;
-
-					return;
-				}
-			}
-		}
-	}
+	ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
+	ns_list_remove(&handle->hash_duplication_msgs[sn_coap_protocol_hash(removed_duplication_info_ptr->addr_ptr, removed_duplication_info_ptr->addr_len,
+				   removed_duplication_info_ptr->port, removed_duplication_info_ptr->msg_id)], removed_duplication_info_ptr);
+	--handle->count_duplication_msgs;
+
+	/* Free memory of stored Duplication info */
+	handle->sn_coap_protocol_free(removed_duplication_info_ptr->addr_ptr);
+	removed_duplication_info_ptr->addr_ptr = 0;
+	handle->sn_coap_protocol_free(removed_duplication_info_ptr);
 }
 
 /**************************************************************************//**
@@ -1071,14 +1107,7 @@ static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct
 	ns_list_foreach_safe(coap_duplication_info_s, removed_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
 		if ((handle->system_time - removed_duplication_info_ptr->timestamp)  > SN_COAP_DUPLICATION_MAX_TIME_MSGS_STORED) {
 			/* * * * Old Duplication info found, remove it from Linked list * * * */
-			ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
-			--handle->count_duplication_msgs;
-
-			/* Free memory of stored Duplication info */
-			handle->sn_coap_protocol_free(removed_duplication_info_ptr->addr_ptr);
-			removed_duplication_info_ptr->addr_ptr = 0;
-			handle->sn_coap_protocol_free(removed_duplication_info_ptr);
-			removed_duplication_info_ptr = 0;
+			sn_coap_protocol_linked_list_duplication_info_remove(handle, removed_duplication_info_ptr);
 		}
 	}
 }
@@ -1167,6 +1196,7 @@ static void sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *
 
 	stored_blockwise_payload_ptr->timestamp = handle->system_time;
 
+	stored_blockwise_payload_ptr->addr_len = addr_ptr->addr_len;
 	memcpy(stored_blockwise_payload_ptr->addr_ptr, addr_ptr->addr_ptr, addr_ptr->addr_len);
 	stored_blockwise_payload_ptr->port = addr_ptr->port;
 	memcpy(stored_blockwise_payload_ptr->payload_ptr, stored_payload_ptr, stored_payload_len);
@@ -1177,62 +1207,41 @@ static void sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *
 	/* * * * Storing Payload to Linked list  * * * */
 
 	ns_list_add_to_end(&handle->linked_list_blockwise_received_payloads, stored_blockwise_payload_ptr);
+	ns_list_add_to_end(&handle->hash_blockwise_received_payloads[sn_coap_protocol_hash(addr_ptr->addr_ptr, addr_ptr->addr_len, addr_ptr->port, 0)],
+					   stored_blockwise_payload_ptr);
 }
 
 /**************************************************************************//**
- * \fn static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_search(sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length)
+ * \fn static coap_blockwise_payload_s *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr)
  *
- * \brief Searches stored blockwise payload from Linked list (Address as key)
+ * \brief Searches oldest stored blockwise payload from Linked list (Address as key)
  *
  * \param *addr_ptr is pointer to Address key to be searched
- * \param *payload_length is pointer to returned Payload length
  *
- * \return Return value is pointer to found stored blockwise payload in Linked
- *         list or NULL if payload not found
+ * \return Return value is pointer to found stored blockwise payload or NULL if payload not found
  *****************************************************************************/
 
-static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length)
+static coap_blockwise_payload_s *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr)
 {
-	/* Loop all stored blockwise payloads in Linked list */
-	ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
-		/* If payload's Source address is same than is searched */
-		if (0 == memcmp(src_addr_ptr->addr_ptr, stored_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) {
-			/* If payload's Source address port is same than is searched */
-			if (stored_payload_info_ptr->port == src_addr_ptr->port) {
-				/* * * Correct Payload found * * * */
-				*payload_length = stored_payload_info_ptr->payload_len;
-
-				return stored_payload_info_ptr->payload_ptr;
-			}
+	uint8_t bucket = sn_coap_protocol_hash(src_addr_ptr->addr_ptr, src_addr_ptr->addr_len, src_addr_ptr->port, 0);
+
+	/* Bucket keeps storing order, so first match is the oldest payload of this source */
+	ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->hash_blockwise_received_payloads[bucket]) {
+		if (stored_payload_info_ptr->port == src_addr_ptr->port &&
+			stored_payload_info_ptr->addr_len == src_addr_ptr->addr_len &&
+			0 == memcmp(src_addr_ptr->addr_ptr, stored_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) {
+			return stored_payload_info_ptr;
 		}
 	}
 
 	return NULL;
 }
 
-/**************************************************************************//**
- * \fn static void sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(struct coap_s *handle)
- *
- * \brief Removes current stored blockwise paylod from Linked list
- *****************************************************************************/
-
-static void sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(struct coap_s *handle)
-{
-	coap_blockwise_payload_s *removed_payload_ptr;
-
-	/* Remove oldest node in Linked list*/
-	removed_payload_ptr = ns_list_get_first(&handle->linked_list_blockwise_received_payloads);
-
-	if (removed_payload_ptr != NULL) {
-		sn_coap_protocol_linked_list_blockwise_payload_remove(handle, removed_payload_ptr);
-	}
-}
-
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle,
  *                                                      coap_blockwise_msg_s *removed_msg_ptr)
  *
- * \brief Removes stored blockwise payload from Linked list
+ * \brief Removes stored blockwise payload from Linked list and its lookup bucket
  *
  * \param removed_payload_ptr is payload to be removed
  *****************************************************************************/
@@ -1241,6 +1250,8 @@ static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s
 		coap_blockwise_payload_s *removed_payload_ptr)
 {
 	ns_list_remove(&handle->linked_list_blockwise_received_payloads, removed_payload_ptr);
+	ns_list_remove(&handle->hash_blockwise_received_payloads[sn_coap_protocol_hash(removed_payload_ptr->addr_ptr, removed_payload_ptr->addr_len,
+				   removed_payload_ptr->port, 0)], removed_payload_ptr);
 
 	/* Free memory of stored payload */
 	if (removed_payload_ptr->addr_ptr != NULL) {
@@ -1270,21 +1281,43 @@ static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s
 static uint32_t sn_coap_protocol_linked_list_blockwise_payloads_get_len(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr)
 {
 	uint32_t ret_whole_payload_len = 0;
-	/* Loop all stored blockwise payloads in Linked list */
-	ns_list_foreach(coap_blockwise_payload_s, searched_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
-		/* If payload's Source address is same than is searched */
-		if (0 == memcmp(src_addr_ptr->addr_ptr, searched_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) {
-			/* If payload's Source address port is same than is searched */
-			if (searched_payload_info_ptr->port == src_addr_ptr->port) {
-				/* * * Correct Payload found * * * */
-				ret_whole_payload_len += searched_payload_info_ptr->payload_len;
-			}
+	uint8_t bucket = sn_coap_protocol_hash(src_addr_ptr->addr_ptr, src_addr_ptr->addr_len, src_addr_ptr->port, 0);
+
+	/* Loop only the payloads sharing the hash of the searched source */
+	ns_list_foreach(coap_blockwise_payload_s, searched_payload_info_ptr, &handle->hash_blockwise_received_payloads[bucket]) {
+		if (searched_payload_info_ptr->port == src_addr_ptr->port &&
+			searched_payload_info_ptr->addr_len == src_addr_ptr->addr_len &&
+			0 == memcmp(src_addr_ptr->addr_ptr, searched_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) {
+			ret_whole_payload_len += searched_payload_info_ptr->payload_len;
 		}
 	}
 
 	return ret_whole_payload_len;
 }
 
+/**************************************************************************//**
+ * \fn static int8_t sn_coap_protocol_block_payload_deliver(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr, int32_t block)
+ *
+ * \brief Hands received block payload to streaming block callback
+ *
+ * \param *src_addr_ptr is pointer to source address of the block
+ * \param *received_coap_msg_ptr is pointer to received block message
+ * \param block is Block1 or Block2 option value of the received message
+ *
+ * \return Return value of the callback, negative aborts the transfer
+ *****************************************************************************/
+
+static int8_t sn_coap_protocol_block_payload_deliver(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr,
+		int32_t block)
+{
+	uint32_t block_number = (uint32_t)block >> 4;
+	uint16_t block_size = 1u << ((block & 0x07) + 4);
+	uint8_t last = (block & 0x08) ? 0 : 1;
+
+	return handle->sn_coap_block_payload_callback(handle, src_addr_ptr, block_number * block_size, received_coap_msg_ptr->payload_ptr,
+			received_coap_msg_ptr->payload_len, last, handle->sn_coap_block_payload_ctx);
+}
+
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_blockwise_remove_old_data(struct coap_s *handle)
  *
@@ -1421,10 +1454,13 @@ void sn_coap_protocol_block_remove(struct coap_s *handle, sn_nsdl_addr_s *source
 		return;
 	}
 
-	/* Loop all stored blockwise payloads in Linked list */
-	ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
+	uint8_t bucket = sn_coap_protocol_hash(source_address->addr_ptr, source_address->addr_len, source_address->port, 0);
+
+	/* Loop only the payloads sharing the hash of the source */
+	ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->hash_blockwise_received_payloads[bucket]) {
 		/* If payload's Source address is not the same than is searched */
-		if (memcmp(source_address->addr_ptr, stored_payload_info_ptr->addr_ptr, source_address->addr_len)) {
+		if (stored_payload_info_ptr->addr_len != source_address->addr_len ||
+			memcmp(source_address->addr_ptr, stored_payload_info_ptr->addr_ptr, source_address->addr_len)) {
 			continue;
 		}
 
@@ -1571,7 +1607,15 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 				received_coap_msg_ptr->payload_len = handle->sn_coap_block_data_size;
 			}
 
-			sn_coap_protocol_linked_list_blockwise_payload_store(handle, src_addr_ptr, received_coap_msg_ptr->payload_len, received_coap_msg_ptr->payload_ptr);
+			if (handle->sn_coap_block_payload_callback) {
+				if (sn_coap_protocol_block_payload_deliver(handle, src_addr_ptr, received_coap_msg_ptr, received_coap_msg_ptr->options_list_ptr->block1) < 0) {
+					tr_debug("sn_coap_handle_blockwise_message - block1 received, aborted by block callback");
+					sn_coap_parser_release_allocated_coap_msg_mem(handle, received_coap_msg_ptr);
+					return NULL;
+				}
+			} else {
+				sn_coap_protocol_linked_list_blockwise_payload_store(handle, src_addr_ptr, received_coap_msg_ptr->payload_len, received_coap_msg_ptr->payload_ptr);
+			}
 			/* If not last block (more value is set) */
 			/* Block option length can be 1-3 bytes. First 4-20 bits are for block number. Last 4 bits are ALWAYS more bit + block size. */
 			if (received_coap_msg_ptr->options_list_ptr->block1 & 0x08) {
@@ -1641,14 +1685,18 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 
 				received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVING;
 
+			} else if (handle->sn_coap_block_payload_callback) {
+				/* * * All blocks were already streamed to block callback, nothing to gather * * */
+				received_coap_msg_ptr->payload_ptr = NULL;
+				received_coap_msg_ptr->payload_len = 0;
+				received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED;
 			} else {
 				tr_debug("sn_coap_handle_blockwise_message - block1 received, last block received");
 				/* * * This is the last block when whole Blockwise payload from received * * */
 				/* * * blockwise messages is gathered and returned to User               * * */
 
 				/* Store last Blockwise payload to Linked list */
-				uint16_t payload_len            = 0;
-				uint8_t *payload_ptr            = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len);
+				coap_blockwise_payload_s *stored_payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr);
 				uint32_t whole_payload_len      = sn_coap_protocol_linked_list_blockwise_payloads_get_len(handle, src_addr_ptr);
 				uint8_t *temp_whole_payload_ptr = NULL;
 
@@ -1666,11 +1714,11 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 				received_coap_msg_ptr->payload_len = whole_payload_len;
 
 				/* Copy stored Blockwise payloads to returned whole Blockwise payload pointer */
-				while (payload_ptr != NULL) {
-					memcpy(temp_whole_payload_ptr, payload_ptr, payload_len);
-					temp_whole_payload_ptr += payload_len;
-					sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(handle);
-					payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len);
+				while (stored_payload_ptr != NULL) {
+					memcpy(temp_whole_payload_ptr, stored_payload_ptr->payload_ptr, stored_payload_ptr->payload_len);
+					temp_whole_payload_ptr += stored_payload_ptr->payload_len;
+					sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_payload_ptr);
+					stored_payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr);
 				}
 				received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED;
 			}
@@ -1687,9 +1735,17 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 			tr_debug("sn_coap_handle_blockwise_message - send block2 request");
 			uint32_t block_number = 0;
 
-			/* Store blockwise payload to Linked list */
+			/* Store blockwise payload to Linked list, or stream it to block callback */
 			//todo: add block number to stored values - just to make sure all packets are in order
-			sn_coap_protocol_linked_list_blockwise_payload_store(handle, src_addr_ptr, received_coap_msg_ptr->payload_len, received_coap_msg_ptr->payload_ptr);
+			if (handle->sn_coap_block_payload_callback) {
+				if (sn_coap_protocol_block_payload_deliver(handle, src_addr_ptr, received_coap_msg_ptr, received_coap_msg_ptr->options_list_ptr->block2) < 0) {
+					tr_debug("sn_coap_handle_blockwise_message - block2 received, aborted by block callback");
+					sn_coap_parser_release_allocated_coap_msg_mem(handle, received_coap_msg_ptr);
+					return NULL;
+				}
+			} else {
+				sn_coap_protocol_linked_list_blockwise_payload_store(handle, src_addr_ptr, received_coap_msg_ptr->payload_len, received_coap_msg_ptr->payload_ptr);
+			}
 
 			/* If not last block (more value is set) */
 			if (received_coap_msg_ptr->options_list_ptr->block2 & 0x08) {
@@ -1714,6 +1770,16 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 					return 0;
 				}
 
+				/* Next block is a GET of the same resource, an empty confirmable message would be taken for a ping and reset */
+				src_coap_blockwise_ack_msg_ptr->msg_type = COAP_MSG_TYPE_CONFIRMABLE;
+				src_coap_blockwise_ack_msg_ptr->msg_code = COAP_MSG_CODE_REQUEST_GET;
+				src_coap_blockwise_ack_msg_ptr->uri_path_ptr = previous_blockwise_msg_ptr->coap_msg_ptr->uri_path_ptr;
+				src_coap_blockwise_ack_msg_ptr->uri_path_len = previous_blockwise_msg_ptr->coap_msg_ptr->uri_path_len;
+				src_coap_blockwise_ack_msg_ptr->token_ptr = previous_blockwise_msg_ptr->coap_msg_ptr->token_ptr;
+				src_coap_blockwise_ack_msg_ptr->token_len = previous_blockwise_msg_ptr->coap_msg_ptr->token_len;
+				previous_blockwise_msg_ptr->coap_msg_ptr->uri_path_ptr = NULL;
+				previous_blockwise_msg_ptr->coap_msg_ptr->token_ptr = NULL;
+
 				ns_list_remove(&handle->linked_list_blockwise_sent_msgs, previous_blockwise_msg_ptr);
 				if (previous_blockwise_msg_ptr->coap_msg_ptr) {
 					if (previous_blockwise_msg_ptr->coap_msg_ptr->payload_ptr) {
@@ -1813,14 +1879,20 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 				dst_ack_packet_data_ptr = 0;
 			}
 
+			//Last block received, already streamed to block callback
+			else if (handle->sn_coap_block_payload_callback) {
+				received_coap_msg_ptr->payload_ptr = NULL;
+				received_coap_msg_ptr->payload_len = 0;
+				received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED;
+			}
+
 			//Last block received
 			else {
 				/* * * This is the last block when whole Blockwise payload from received * * */
 				/* * * blockwise messages is gathered and returned to User               * * */
 
 				/* Store last Blockwise payload to Linked list */
-				uint16_t payload_len            = 0;
-				uint8_t *payload_ptr            = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len);
+				coap_blockwise_payload_s *stored_payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr);
 				uint16_t whole_payload_len      = sn_coap_protocol_linked_list_blockwise_payloads_get_len(handle, src_addr_ptr);
 				uint8_t *temp_whole_payload_ptr = NULL;
 
@@ -1833,13 +1905,13 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 				received_coap_msg_ptr->payload_len = whole_payload_len;
 
 				/* Copy stored Blockwise payloads to returned whole Blockwise payload pointer */
-				while (payload_ptr != NULL) {
-					memcpy(temp_whole_payload_ptr, payload_ptr, payload_len);
+				while (stored_payload_ptr != NULL) {
+					memcpy(temp_whole_payload_ptr, stored_payload_ptr->payload_ptr, stored_payload_ptr->payload_len);
 
-					temp_whole_payload_ptr += payload_len;
+					temp_whole_payload_ptr += stored_payload_ptr->payload_len;
 
-					sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(handle);
-					payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len);
+					sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_payload_ptr);
+					stored_payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr);
 				}
 				received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED;
 
@@ -95,444 +95,672 @@ static char *str_strip(char *str, unsigned int str_len)
 	return strip;
 }
 
-/* TAG Format:
- *    STag ::= '<' Name (S Attribute)* S? '>'
- *    ETag ::= '</' Name S? '>'
- *    EmptyElemTag ::= '<' Name (S Attribute)* S? '/>'
- */
-static void _parse_tag(char *tag, char **prefix, char **name, char **uri, char **attr)
+#define XML_IS_SPACE(c)	(((c) == ' ') || ((c) == '\t') || ((c) == '\r') || ((c) == '\n'))
+
+static char *xml_memmem(char *buf, char *end, const char *str)
 {
-	char *prefix_char, *ns_tag, *ns_front;
-	int have_prefix = 0;
-	int have_uri = 0;
+	int str_len = strlen(str);
 
-	prefix_char = (char *)strchr(tag, ':');
+	for (; (end - buf) >= str_len; buf ++) {
+		if ((*buf == *str) && (memcmp(buf, str, str_len) == 0)) {
+			return buf;
+		}
+	}
 
-	if (prefix_char) {
-		char *tag_sep = (char *)strchr(tag, ' ');
+	return NULL;
+}
 
-		if (!tag_sep) {
-			have_prefix = 1;
-		} else if (prefix_char < tag_sep) {
-			have_prefix = 1;
+/* [prefix:]name of str_len chars in end tag against open element */
+static int xml_name_match(char *str, int str_len, char *prefix, char *name)
+{
+	int len;
+
+	if (prefix) {
+		len = strlen(prefix);
+
+		if ((str_len <= len) || (memcmp(str, prefix, len) != 0) || (str[len] != ':')) {
+			return 0;
 		}
-	}
 
-	if (have_prefix) {
-		*prefix = str_strip(tag, prefix_char - tag);
-		ns_tag = (char *) xml_malloc(strlen(" xmlns:") + strlen(*prefix) + 1);
-		sprintf(ns_tag, " xmlns:%s", *prefix);
-		ns_front = xml_strstr(tag, ns_tag);
-		xml_free(ns_tag);
-	} else {
-		*prefix = NULL;
-		ns_tag = " xmlns";
-		ns_front = xml_strstr(tag, ns_tag);
+		str += len + 1;
+		str_len -= len + 1;
 	}
 
-	if (ns_front) {
-		have_uri = 1;
-	}
+	return ((int) strlen(name) == str_len) && (memcmp(str, name, str_len) == 0);
+}
 
-	if (have_prefix && have_uri) {
-		char *uri_front, *uri_rear, *tag_sep, ns_sep;
-		int uri_len;
+/* xmlns:prefix="uri" or xmlns="uri" declared in attr */
+static char *xml_attr_uri(char *attr, char *attr_end, char *prefix, int *uri_len)
+{
+	char *pos = attr;
 
-		tag_sep = (char *)strchr(prefix_char + 1, ' ');
-		*name = str_strip(prefix_char + 1, tag_sep - (prefix_char + 1));
+	while (pos < attr_end) {
+		char *key, *key_end, *value, quote;
 
-		if (attr) {
-			*attr = str_strip(tag_sep, tag + strlen(tag) - tag_sep);
+		while ((pos < attr_end) && XML_IS_SPACE(*pos)) {
+			pos ++;
 		}
 
-		if (*((char *)(strchr(ns_front, '=') + 1)) == '\'') {
-			ns_sep = '\'';
-		} else {
-			ns_sep = '\"';
+		key = pos;
+
+		while ((pos < attr_end) && (*pos != '=') && !XML_IS_SPACE(*pos)) {
+			pos ++;
 		}
 
-		uri_front = (char *) strchr(ns_front, ns_sep) + 1;
-		uri_rear = (char *) strchr(uri_front, ns_sep);
-		uri_len = uri_rear - uri_front;
-		*uri = (char *) xml_malloc(uri_len + 1);
-		memcpy(*uri, uri_front, uri_len);
-		(*uri)[uri_len] = '\0';
-	} else if (have_prefix) {
-		char *tag_sep;
+		key_end = pos;
 
-		*uri = NULL;
-		tag_sep = (char *) strchr(prefix_char + 1, ' ');
+		while ((pos < attr_end) && (XML_IS_SPACE(*pos) || (*pos == '='))) {
+			pos ++;
+		}
 
-		if (tag_sep) {
-			*name = str_strip(prefix_char + 1, tag_sep - (prefix_char + 1));
+		if ((pos >= attr_end) || ((*pos != '\"') && (*pos != '\''))) {
+			break;
+		}
 
-			if (attr) {
-				*attr = str_strip(tag_sep, tag + strlen(tag) - tag_sep);
-			}
-		} else {
-			*name = str_strip(prefix_char + 1, tag + strlen(tag) - (prefix_char + 1));
+		quote = *pos ++;
+		value = pos;
 
-			if (attr) {
-				*attr = NULL;
+		while ((pos < attr_end) && (*pos != quote)) {
+			pos ++;
+		}
+
+		if (pos >= attr_end) {
+			break;
+		}
+
+		if (prefix) {
+			int prefix_len = strlen(prefix);
+
+			if (((key_end - key) == (prefix_len + 6)) && (memcmp(key, "xmlns:", 6) == 0) &&
+				(memcmp(key + 6, prefix, prefix_len) == 0)) {
+				*uri_len = pos - value;
+				return value;
 			}
+		} else if (((key_end - key) == 5) && (memcmp(key, "xmlns", 5) == 0)) {
+			*uri_len = pos - value;
+			return value;
 		}
-	} else if (have_uri) {
-		char *uri_front, *uri_rear, *tag_sep, ns_sep;
-		int uri_len;
 
-		tag_sep = (char *) strchr(tag, ' ');
-		*name = str_strip(tag, tag_sep - tag);
+		pos ++;
+	}
+
+	*uri_len = 0;
+	return NULL;
+}
+
+/* Single pass tokenizer working in place on doc_buf.
+ * Names, attributes and text are NUL-terminated inside doc_buf by overwriting the delimiter
+ * following them, so doc_buf must be writable and is no longer a valid document afterwards.
+ * Prolog, comments, DOCTYPE and processing instructions are skipped, CDATA is delivered as text.
+ * Entities are not decoded.
+ * Return 0 for a complete document, -1 if malformed, otherwise the non-zero value of a callback.
+ */
+int xml_sax_parse(char *doc_buf, int doc_len, const struct xml_sax_handler *handler, void *ctx)
+{
+	char *stack_prefix[XML_SAX_MAX_DEPTH], *stack_name[XML_SAX_MAX_DEPTH];
+	char *pos = doc_buf, *end = doc_buf + doc_len;
+	int depth = 0, element_num = 0, ret = 0;
+
+	while (pos < end) {
+		char *tag_front, *tag_rear;
 
-		if (attr) {
-			*attr = str_strip(tag_sep, tag + strlen(tag) - tag_sep);
+		if (*pos != '<') {
+			char *text = pos;
+
+			if ((pos = (char *) memchr(text, '<', end - text)) == NULL) {
+				break;
+			}
+
+			if (depth && handler->text) {
+				*pos = '\0';
+
+				if ((ret = handler->text(ctx, text, pos - text)) != 0) {
+					return ret;
+				}
+			}
 		}
 
-		if (*((char *)(strchr(ns_front, '=') + 1)) == '\'') {
-			ns_sep = '\'';
-		} else {
-			ns_sep = '\"';
+		/* pos is at '<' which may have been replaced by text terminator */
+		tag_front = pos + 1;
+
+		if (tag_front >= end) {
+			return -1;
 		}
 
-		uri_front = (char *) strchr(ns_front, ns_sep) + 1;
-		uri_rear = (char *) strchr(uri_front, ns_sep);
-		uri_len = uri_rear - uri_front;
-		*uri = (char *) xml_malloc(uri_len + 1);
-		memcpy(*uri, uri_front, uri_len);
-		(*uri)[uri_len] = '\0';
-	} else {
-		char *tag_sep;
+		if (*tag_front == '?') {
+			/* <? ... ?> */
+			if ((tag_rear = xml_memmem(tag_front, end, "?>")) == NULL) {
+				return -1;
+			}
+			pos = tag_rear + 2;
+		} else if (*tag_front == '!') {
+			if (((end - tag_front) >= 3) && (memcmp(tag_front, "!--", 3) == 0)) {
+				/* <!-- ... --> */
+				if ((tag_rear = xml_memmem(tag_front + 3, end, "-->")) == NULL) {
+					return -1;
+				}
+				pos = tag_rear + 3;
+			} else if (((end - tag_front) >= 8) && (memcmp(tag_front, "![CDATA[", 8) == 0)) {
+				/* <![CDATA[ ... ]]> */
+				char *text = tag_front + 8;
 
-		*uri = NULL;
-		tag_sep = (char *) strchr(tag, ' ');
+				if ((tag_rear = xml_memmem(text, end, "]]>")) == NULL) {
+					return -1;
+				}
 
-		if (tag_sep) {
-			*name = str_strip(tag, tag_sep - tag);
+				if (depth && handler->text) {
+					*tag_rear = '\0';
 
-			if (attr) {
-				*attr = str_strip(tag_sep, tag + strlen(tag) - tag_sep);
+					if ((ret = handler->text(ctx, text, tag_rear - text)) != 0) {
+						return ret;
+					}
+				}
+				pos = tag_rear + 3;
+			} else {
+				/* <!DOCTYPE ... [ ... ]> */
+				int subset = 0;
+
+				for (tag_rear = tag_front; tag_rear < end; tag_rear ++) {
+					if (*tag_rear == '[') {
+						subset ++;
+					} else if ((*tag_rear == ']') && subset) {
+						subset --;
+					} else if ((*tag_rear == '>') && !subset) {
+						break;
+					}
+				}
+
+				if (tag_rear >= end) {
+					return -1;
+				}
+				pos = tag_rear + 1;
+			}
+		} else if (*tag_front == '/') {
+			/* ETag ::= '</' Name S? '>' */
+			char *name = tag_front + 1, *name_end;
+
+			for (name_end = name; (name_end < end) && (*name_end != '>') && !XML_IS_SPACE(*name_end); name_end ++);
+
+			for (tag_rear = name_end; (tag_rear < end) && XML_IS_SPACE(*tag_rear); tag_rear ++);
+
+			if ((tag_rear >= end) || (*tag_rear != '>') || (depth == 0) ||
+				!xml_name_match(name, name_end - name, stack_prefix[depth - 1], stack_name[depth - 1])) {
+				return -1;
+			}
+
+			depth --;
+
+			if (handler->end_element && ((ret = handler->end_element(ctx, stack_prefix[depth], stack_name[depth])) != 0)) {
+				return ret;
 			}
+			pos = tag_rear + 1;
 		} else {
-			*name = str_strip(tag, strlen(tag));
+			/* STag ::= '<' Name (S Attribute)* S? '>'
+			 * EmptyElemTag ::= '<' Name (S Attribute)* S? '/>'
+			 */
+			char *name = tag_front, *name_end, *prefix = NULL, *attr = NULL, *attr_end, *uri = NULL;
+			int empty = 0, uri_len = 0;
+
+			for (name_end = name; (name_end < end) && (*name_end != '>') && (*name_end != '/') && !XML_IS_SPACE(*name_end); name_end ++);
+
+			/* closing '>' outside of quoted attribute value */
+			for (tag_rear = name_end; (tag_rear < end) && (*tag_rear != '>'); tag_rear ++) {
+				if ((*tag_rear == '\"') || (*tag_rear == '\'')) {
+					char *quote = (char *) memchr(tag_rear + 1, *tag_rear, end - (tag_rear + 1));
+
+					if (quote == NULL) {
+						return -1;
+					}
+					tag_rear = quote;
+				}
+			}
+
+			if ((tag_rear >= end) || (name_end == name)) {
+				return -1;
+			}
+
+			attr_end = tag_rear;
+
+			if (*(tag_rear - 1) == '/') {
+				empty = 1;
+				attr_end --;
+			}
+
+			for (attr = name_end; (attr < attr_end) && XML_IS_SPACE(*attr); attr ++);
+
+			for (; (attr_end > attr) && XML_IS_SPACE(*(attr_end - 1)); attr_end --);
+
+			if (attr == attr_end) {
+				attr = NULL;
+			}
+
+			if ((prefix = (char *) memchr(name, ':', name_end - name)) != NULL) {
+				*prefix = '\0';
+				prefix = name;
+				name = prefix + strlen(prefix) + 1;
+			}
 
 			if (attr) {
-				*attr = NULL;
+				uri = xml_attr_uri(attr, attr_end, prefix, &uri_len);
+				*attr_end = '\0';
+			}
+
+			*name_end = '\0';
+			element_num ++;
+
+			if (handler->start_element && ((ret = handler->start_element(ctx, prefix, name, attr, uri, uri_len)) != 0)) {
+				return ret;
+			}
+
+			if (empty) {
+				if (handler->end_element && ((ret = handler->end_element(ctx, prefix, name)) != 0)) {
+					return ret;
+				}
+			} else {
+				if (depth == XML_SAX_MAX_DEPTH) {
+					return -1;
+				}
+
+				stack_prefix[depth] = prefix;
+				stack_name[depth] = name;
+				depth ++;
 			}
+			pos = tag_rear + 1;
 		}
 	}
+
+	if (depth || (element_num == 0)) {
+		return -1;
+	}
+
+	return 0;
 }
 
-static void parse_tag(char *tag, char **prefix, char **name, char **uri)
+struct xml_arena_blk {
+	struct xml_arena_blk *next;
+	unsigned int size;
+	unsigned int used;
+};
+
+static void *xml_arena_alloc(struct xml_doc *doc, unsigned int size)
 {
-	_parse_tag(tag, prefix, name, uri, NULL);
+	struct xml_arena_blk *blk = (struct xml_arena_blk *) doc->arena;
+	void *buf;
+
+	size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+	if ((blk == NULL) || ((blk->size - blk->used) < size)) {
+		unsigned int blk_size = (size > XML_ARENA_BLK_SIZE) ? size : XML_ARENA_BLK_SIZE;
+
+		if ((blk = (struct xml_arena_blk *) xml_malloc(sizeof(struct xml_arena_blk) + blk_size)) == NULL) {
+			return NULL;
+		}
+
+		blk->size = blk_size;
+		blk->used = 0;
+		blk->next = (struct xml_arena_blk *) doc->arena;
+		doc->arena = blk;
+	}
+
+	buf = (char *)(blk + 1) + blk->used;
+	blk->used += size;
+
+	return buf;
 }
 
-int xml_doc_name(char *doc_buf, int doc_len, char **doc_prefix, char **doc_name, char **doc_uri)
+/* DOM builder on top of xml_sax_parse.
+ * With doc set, nodes are allocated from its arena and strings point into the parsed buffer,
+ * otherwise every node owns heap copies as created by xml_new_element()/xml_new_text().
+ */
+struct xml_dom {
+	struct xml_doc *doc;
+	struct xml_node *root;
+	struct xml_node *cur;
+	char *text;
+	int text_len;
+	/* xml_parse_doc: only build the first element matching these */
+	char *match_prefix;
+	char *match_name;
+	char *match_uri;
+	int match;
+};
+
+static char *xml_dom_strdup(struct xml_dom *dom, char *str, int str_len)
 {
-	char *xml_buf, *cur_pos, *tag_front, *tag_rear;
-	char *start_tag, *end_tag1, *end_tag2;
-	int tag_len, ret = -1;
+	char *buf;
 
-	xml_buf = (char *) xml_malloc(doc_len + 1);
-	memcpy(xml_buf, doc_buf, doc_len);
-	xml_buf[doc_len] = '\0';
+	if (dom->doc) {
+		buf = (char *) xml_arena_alloc(dom->doc, str_len + 1);
+	} else {
+		buf = (char *) xml_malloc(str_len + 1);
+	}
 
-	cur_pos = xml_buf;
-
-	while (cur_pos < (xml_buf + doc_len)) {
-		if ((tag_front = (char *) strchr(cur_pos, '<')) != NULL) {
-			tag_front ++;
-
-			if ((tag_rear = (char *) strchr(tag_front, '>')) != NULL) {
-				char *prefix = NULL, *name = NULL, *uri = NULL;
-
-				//Element without content
-				if (*(tag_rear - 1) == '/') {
-					tag_len = tag_rear - 1 - tag_front;
-					start_tag = (char *) xml_malloc(tag_len + 1);
-					memcpy(start_tag, tag_front, tag_len);
-					start_tag[tag_len] = '\0';
-					parse_tag(start_tag, &prefix, &name, &uri);
-					xml_free(start_tag);
-					*doc_name = name;
-					*doc_prefix = prefix;
-					*doc_uri = uri;
-					ret = 0;
-					cur_pos = xml_buf + doc_len;
-				}
-				//Element with content
-				else {
-					tag_len = tag_rear - tag_front;
-					start_tag = (char *) xml_malloc(tag_len + 1);
-					memcpy(start_tag, tag_front, tag_len);
-					start_tag[tag_len] = '\0';
-					parse_tag(start_tag, &prefix, &name, &uri);
-					xml_free(start_tag);
-
-					if (prefix) {
-						end_tag1 = (char *) xml_malloc(strlen(prefix) + strlen(name) + 5);
-						sprintf(end_tag1, "</%s:%s>", prefix, name);
-						end_tag2 = (char *) xml_malloc(strlen(prefix) + strlen(name) + 5);
-						sprintf(end_tag2, "</%s:%s ", prefix, name);
-					} else {
-						end_tag1 = (char *) xml_malloc(strlen(name) + 4);
-						sprintf(end_tag1, "</%s>", name);
-						end_tag2 = (char *) xml_malloc(strlen(name) + 4);
-						sprintf(end_tag2, "</%s ", name);
-					}
+	if (buf) {
+		memcpy(buf, str, str_len);
+		buf[str_len] = '\0';
+	}
 
-					if (xml_strstr(tag_rear + 1, end_tag1) || xml_strstr(tag_rear + 1, end_tag2)) {
-						*doc_name = name;
-						*doc_prefix = prefix;
-						*doc_uri = uri;
-						ret = 0;
-						cur_pos = xml_buf + doc_len;
-					} else {
-						xml_free(name);
-						if (prefix) {
-							xml_free(prefix);
-						}
-						if (uri)	{
-							xml_free(uri);
-						}
-						cur_pos = tag_rear + 1;
-					}
+	return buf;
+}
 
-					xml_free(end_tag1);
-					xml_free(end_tag2);
-				}
-			} else {
-				cur_pos = xml_buf + doc_len;
-			}
-		} else {
-			cur_pos = xml_buf + doc_len;
-		}
+/* str is NUL-terminated in the parsed buffer, in-situ tree refers to it directly */
+static char *xml_dom_str(struct xml_dom *dom, char *str)
+{
+	if (dom->doc) {
+		return str;
 	}
 
-	xml_free(xml_buf);
+	return xml_dom_strdup(dom, str, strlen(str));
+}
 
-	return ret;
+static struct xml_node *xml_dom_new_node(struct xml_dom *dom)
+{
+	struct xml_node *node;
+
+	if (dom->doc) {
+		node = (struct xml_node *) xml_arena_alloc(dom->doc, sizeof(struct xml_node));
+	} else {
+		node = (struct xml_node *) xml_malloc(sizeof(struct xml_node));
+	}
+
+	if (node) {
+		memset(node, 0, sizeof(struct xml_node));
+	}
+
+	return node;
 }
 
-struct xml_node *_xml_parse_doc(char *doc_buf, int doc_len, struct xml_node *root)
+/* attach node to tree before filling it, so that a failed copy is released with the tree */
+static void xml_dom_add_node(struct xml_dom *dom, struct xml_node *node)
 {
-	char *xml_buf, *cur_pos;
+	if (dom->cur) {
+		xml_add_child(dom->cur, node);
+	} else {
+		dom->root = node;
+	}
+}
 
-	xml_buf = (char *) xml_malloc(doc_len + 1);
-	memcpy(xml_buf, doc_buf, doc_len);
-	xml_buf[doc_len] = '\0';
+static int xml_dom_start_element(void *ctx, char *prefix, char *name, char *attr, char *uri, int uri_len)
+{
+	struct xml_dom *dom = (struct xml_dom *) ctx;
+	struct xml_node *node;
 
-	cur_pos = xml_buf;
+	dom->text = NULL;
 
-	while (cur_pos < (xml_buf + doc_len)) {
-		char *tag_front, *tag_rear;
-		struct xml_node *node;
-
-		if ((tag_front = (char *) strchr(cur_pos, '<')) != NULL) {
-			tag_front ++;
-
-			if ((tag_rear = (char *) strchr(tag_front, '>')) != NULL) {
-				char *doc_front, *doc_rear, *start_tag, *end_tag1, *end_tag2;
-				char *prefix = NULL, *name = NULL, *uri = NULL, *attr = NULL;
-				int tag_len;
-
-				//Element without content
-				if (*(tag_rear - 1) == '/') {
-					doc_front = tag_rear + 1;
-					tag_len = tag_rear - 1 - tag_front;
-					start_tag = (char *) xml_malloc(tag_len + 1);
-					memcpy(start_tag, tag_front, tag_len);
-					start_tag[tag_len] = '\0';
-					_parse_tag(start_tag, &prefix, &name, &uri, &attr);
-					node = _xml_new_element(prefix, name, uri, attr);
-
-					if (root) {
-						xml_add_child(root, node);
-						cur_pos = doc_front;
-					} else {
-						root = node;
-						cur_pos = xml_buf + doc_len;
-					}
-				}
-				//Element with content
-				else {
-					doc_front = tag_rear + 1;
-					tag_len = tag_rear - tag_front;
-					start_tag = (char *) xml_malloc(tag_len + 1);
-					memcpy(start_tag, tag_front, tag_len);
-					start_tag[tag_len] = '\0';
-					_parse_tag(start_tag, &prefix, &name, &uri, &attr);
-
-					if (prefix) {
-						end_tag1 = (char *) xml_malloc(strlen(prefix) + strlen(name) + 5);
-						sprintf(end_tag1, "</%s:%s>", prefix, name);
-						end_tag2 = (char *) xml_malloc(strlen(prefix) + strlen(name) + 5);
-						sprintf(end_tag2, "</%s:%s ", prefix, name);
-					} else {
-						end_tag1 = (char *) xml_malloc(strlen(name) + 4);
-						sprintf(end_tag1, "</%s>", name);
-						end_tag2 = (char *) xml_malloc(strlen(name) + 4);
-						sprintf(end_tag2, "</%s ", name);
-					}
+	if (dom->match && !dom->root) {
+		if ((strcmp(name, dom->match_name) != 0) ||
+			((prefix == NULL) != (dom->match_prefix == NULL)) || (prefix && (strcmp(prefix, dom->match_prefix) != 0)) ||
+			((uri == NULL) != (dom->match_uri == NULL)) ||
+			(uri && (((int) strlen(dom->match_uri) != uri_len) || (memcmp(uri, dom->match_uri, uri_len) != 0)))) {
+			return 0;
+		}
 
-					if (xml_strstr(doc_front, end_tag1)) {
-						doc_rear = xml_strstr(doc_front, end_tag1);
-					} else if (xml_strstr(doc_front, end_tag2)) {
-						doc_rear = xml_strstr(doc_front, end_tag2);
-					} else {
-						doc_rear = NULL;
-					}
+		/* xml_parse_doc only keeps namespace attribute of document element */
+		if ((dom->root = xml_new_element(dom->match_prefix, dom->match_name, dom->match_uri)) == NULL) {
+			return -1;
+		}
 
-					if (doc_rear) {
-						node = _xml_new_element(prefix, name, uri, attr);
-
-						if (root) {
-							xml_add_child(root, node);
-							_xml_parse_doc(doc_front, doc_rear - doc_front, node);
-							cur_pos = (char *) strchr(doc_rear, '>') + 1;
-						} else {
-							root = node;
-							_xml_parse_doc(doc_front, doc_rear - doc_front, node);
-							cur_pos = xml_buf + doc_len;
-						}
-					} else {
-						cur_pos = doc_front;
-					}
+		dom->cur = dom->root;
+		return 0;
+	}
 
-					xml_free(end_tag1);
-					xml_free(end_tag2);
-				}
+	if ((node = xml_dom_new_node(dom)) == NULL) {
+		return -1;
+	}
 
-				xml_free(start_tag);
-				xml_free(name);
-				if (prefix) {
-					xml_free(prefix);
-				}
-				if (uri) {
-					xml_free(uri);
-				}
-				if (attr) {
-					xml_free(attr);
-				}
-			} else {
-				if (root && !root->child && (strlen(cur_pos) > 0)) {
-					node = xml_new_text(cur_pos);
-					xml_add_child(root, node);
-				}
+	xml_dom_add_node(dom, node);
+	dom->cur = node;
 
-				cur_pos = xml_buf + doc_len;
-			}
-		} else {
-			if (root && !root->child && (strlen(cur_pos) > 0)) {
-				node = xml_new_text(cur_pos);
-				xml_add_child(root, node);
-			}
+	if ((node->name = xml_dom_str(dom, name)) == NULL) {
+		return -1;
+	}
 
-			cur_pos = xml_buf + doc_len;
+	if (prefix && ((node->prefix = xml_dom_str(dom, prefix)) == NULL)) {
+		return -1;
+	}
+
+	if (attr && ((node->attr = xml_dom_str(dom, attr)) == NULL)) {
+		return -1;
+	}
+
+	if (uri && ((node->uri = xml_dom_strdup(dom, uri, uri_len)) == NULL)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+static int xml_dom_end_element(void *ctx, char *prefix, char *name)
+{
+	struct xml_dom *dom = (struct xml_dom *) ctx;
+	struct xml_node *node;
+
+	(void) prefix;
+	(void) name;
+
+	if (dom->cur == NULL) {
+		return 0;
+	}
+
+	/* text is only kept for element without element child */
+	if (dom->text && (dom->cur->child == NULL)) {
+		if ((node = xml_dom_new_node(dom)) == NULL) {
+			return -1;
+		}
+
+		xml_add_child(dom->cur, node);
+
+		if ((node->text = xml_dom_str(dom, dom->text)) == NULL) {
+			return -1;
 		}
 	}
 
-	xml_free(xml_buf);
+	dom->text = NULL;
+	dom->cur = dom->cur->parent;
 
-	return root;
+	/* document element closed, ignore the rest */
+	return (dom->cur == NULL) ? 1 : 0;
 }
 
-/* Note: xml_parse_doc can handle attribute only for namespace */
-struct xml_node *xml_parse_doc(char *doc_buf, int doc_len, char *doc_prefix, char *doc_name, char *doc_uri)
+static int xml_dom_text(void *ctx, char *text, int text_len)
 {
-	struct xml_node *root = NULL;
-	char *xml_buf, *start_tag, *end_tag, *empty_tag, *front, *rear;
+	struct xml_dom *dom = (struct xml_dom *) ctx;
+
+	if ((dom->cur == NULL) || (dom->cur->child != NULL) || (text_len == 0)) {
+		return 0;
+	}
+
+	if (dom->text) {
+		/* text split by comment or CDATA, join in place over the consumed markup between them */
+		memmove(dom->text + dom->text_len, text, text_len);
+		dom->text_len += text_len;
+		dom->text[dom->text_len] = '\0';
+		return 0;
+	}
+
+	dom->text = text;
+	dom->text_len = text_len;
+
+	return 0;
+}
+
+static const struct xml_sax_handler xml_dom_handler = {
+	xml_dom_start_element,
+	xml_dom_end_element,
+	xml_dom_text,
+};
+
+static int xml_dom_parse(char *doc_buf, int doc_len, struct xml_dom *dom)
+{
+	char *xml_buf;
+	int ret;
+
+	/* doc_buf may be read-only, tokenize a single working copy */
+	if ((xml_buf = (char *) xml_malloc(doc_len + 1)) == NULL) {
+		return -1;
+	}
 
-	xml_buf = (char *) xml_malloc(doc_len + 1);
 	memcpy(xml_buf, doc_buf, doc_len);
 	xml_buf[doc_len] = '\0';
 
-	if (doc_prefix && doc_uri) {
-		start_tag = (char *) xml_malloc(2 * strlen(doc_prefix) + strlen(doc_name) + strlen(doc_uri) + 14);
-		sprintf(start_tag, "<%s:%s xmlns:%s=\"%s\">", doc_prefix, doc_name, doc_prefix, doc_uri);
-		empty_tag = (char *) xml_malloc(2 * strlen(doc_prefix) + strlen(doc_name) + strlen(doc_uri) + 15);
-		sprintf(empty_tag, "<%s:%s xmlns:%s=\"%s\"/>", doc_prefix, doc_name, doc_prefix, doc_uri);
-
-	} else if (doc_prefix) {
-		start_tag = (char *) xml_malloc(strlen(doc_prefix) + strlen(doc_name) + 4);
-		sprintf(start_tag, "<%s:%s>", doc_prefix, doc_name);
-		empty_tag = (char *) xml_malloc(strlen(doc_prefix) + strlen(doc_name) + 5);
-		sprintf(empty_tag, "<%s:%s/>", doc_prefix, doc_name);
-	} else if (doc_uri) {
-		start_tag = (char *) xml_malloc(strlen(doc_name) + strlen(doc_uri) + 12);
-		sprintf(start_tag, "<%s xmlns=\"%s\">", doc_name, doc_uri);
-		empty_tag = (char *) xml_malloc(strlen(doc_name) + strlen(doc_uri) + 13);
-		sprintf(empty_tag, "<%s xmlns=\"%s\"/>", doc_name, doc_uri);
-	} else {
-		start_tag = (char *) xml_malloc(strlen(doc_name) + 3);
-		sprintf(start_tag, "<%s>", doc_name);
-		empty_tag = (char *) xml_malloc(strlen(doc_name) + 4);
-		sprintf(empty_tag, "<%s/>", doc_name);
+	ret = xml_sax_parse(xml_buf, doc_len, &xml_dom_handler, dom);
+
+	xml_free(xml_buf);
+
+	/* 1: document element closed */
+	if ((ret != 1) && dom->root) {
+		xml_delete_tree(dom->root);
+		dom->root = NULL;
 	}
 
-	if (doc_prefix) {
-		end_tag = (char *) xml_malloc(strlen(doc_prefix) + strlen(doc_name) + 5);
-		sprintf(end_tag, "</%s:%s>", doc_prefix, doc_name);
-	} else {
-		end_tag = (char *) xml_malloc(strlen(doc_name) + 4);
-		sprintf(end_tag, "</%s>", doc_name);
+	return (ret == 1) ? 0 : -1;
+}
+
+struct xml_doc_name_ctx {
+	char *prefix;
+	char *name;
+	char *uri;
+	int uri_len;
+	int depth;
+};
+
+static int xml_doc_name_start(void *ctx, char *prefix, char *name, char *attr, char *uri, int uri_len)
+{
+	struct xml_doc_name_ctx *name_ctx = (struct xml_doc_name_ctx *) ctx;
+
+	(void) attr;
+
+	if (name_ctx->depth == 0) {
+		name_ctx->prefix = prefix;
+		name_ctx->name = name;
+		name_ctx->uri = uri;
+		name_ctx->uri_len = uri_len;
 	}
 
-	//Root element with content
-	if ((front = xml_strstr(xml_buf, start_tag)) != NULL) {
-		front += strlen(start_tag);
+	name_ctx->depth ++;
 
-		if ((rear = xml_strstr(front, end_tag)) != NULL) {
-			int xml_len = rear - front;
+	return 0;
+}
 
-			root = xml_new_element(doc_prefix, doc_name, doc_uri);
-			_xml_parse_doc(front, xml_len, root);
-		}
+static int xml_doc_name_end(void *ctx, char *prefix, char *name)
+{
+	struct xml_doc_name_ctx *name_ctx = (struct xml_doc_name_ctx *) ctx;
+
+	(void) prefix;
+	(void) name;
+
+	name_ctx->depth --;
+
+	return (name_ctx->depth == 0) ? 1 : 0;
+}
+
+int xml_doc_name(char *doc_buf, int doc_len, char **doc_prefix, char **doc_name, char **doc_uri)
+{
+	struct xml_sax_handler handler = {xml_doc_name_start, xml_doc_name_end, NULL};
+	struct xml_doc_name_ctx name_ctx;
+	char *xml_buf;
+	int ret = -1;
+
+	if ((xml_buf = (char *) xml_malloc(doc_len + 1)) == NULL) {
+		return -1;
 	}
-	//Root element without content
-	else if ((front = xml_strstr(xml_buf, empty_tag)) != NULL) {
-		root = xml_new_element(doc_prefix, doc_name, doc_uri);
+
+	memcpy(xml_buf, doc_buf, doc_len);
+	xml_buf[doc_len] = '\0';
+	memset(&name_ctx, 0, sizeof(struct xml_doc_name_ctx));
+
+	if (xml_sax_parse(xml_buf, doc_len, &handler, &name_ctx) == 1) {
+		*doc_name = (char *) xml_malloc(strlen(name_ctx.name) + 1);
+		strcpy(*doc_name, name_ctx.name);
+		*doc_prefix = NULL;
+		*doc_uri = NULL;
+
+		if (name_ctx.prefix) {
+			*doc_prefix = (char *) xml_malloc(strlen(name_ctx.prefix) + 1);
+			strcpy(*doc_prefix, name_ctx.prefix);
+		}
+
+		if (name_ctx.uri) {
+			*doc_uri = (char *) xml_malloc(name_ctx.uri_len + 1);
+			memcpy(*doc_uri, name_ctx.uri, name_ctx.uri_len);
+			(*doc_uri)[name_ctx.uri_len] = '\0';
+		}
+
+		ret = 0;
 	}
 
-	xml_free(start_tag);
-	xml_free(end_tag);
-	xml_free(empty_tag);
 	xml_free(xml_buf);
 
-	return root;
+	return ret;
+}
+
+/* Note: xml_parse_doc can handle attribute only for namespace */
+struct xml_node *xml_parse_doc(char *doc_buf, int doc_len, char *doc_prefix, char *doc_name, char *doc_uri)
+{
+	struct xml_dom dom;
+
+	memset(&dom, 0, sizeof(struct xml_dom));
+	dom.match = 1;
+	dom.match_prefix = doc_prefix;
+	dom.match_name = doc_name;
+	dom.match_uri = doc_uri;
+
+	xml_dom_parse(doc_buf, doc_len, &dom);
+
+	return dom.root;
 }
 
 struct xml_node *xml_parse(char *doc_buf, int doc_len)
 {
-	char *proc_inst, *comment, *pos, *prolog_end;
-	proc_inst = doc_buf;
-	comment = doc_buf;
-
-	/* Remove XML Prolog */
-	pos = doc_buf;
-	while (pos < (doc_buf + doc_len)) {
-		if ((proc_inst = xml_strstr(pos, "<?")) != NULL) {
-			pos = (char *) strchr(proc_inst, '>') + 1;
-		} else {
-			proc_inst = pos;
-			break;
-		}
+	struct xml_dom dom;
+
+	/* Prolog is skipped by tokenizer */
+	memset(&dom, 0, sizeof(struct xml_dom));
+	xml_dom_parse(doc_buf, doc_len, &dom);
+
+	return dom.root;
+}
+
+/* Nodes are allocated from arena of doc and refer to doc_buf, which is modified in place and
+ * must stay valid until xml_delete_doc(). The tree is read-only, use xml_copy_tree() to get
+ * a tree that can be modified or deleted by xml_delete_tree().
+ */
+struct xml_doc *xml_parse_insitu(char *doc_buf, int doc_len)
+{
+	struct xml_doc *doc;
+	struct xml_dom dom;
+
+	if ((doc = (struct xml_doc *) xml_malloc(sizeof(struct xml_doc))) == NULL) {
+		return NULL;
 	}
-	pos = doc_buf;
-	while (pos < (doc_buf + doc_len)) {
-		if ((comment = xml_strstr(pos, "<!")) != NULL) {
-			pos = (char *) strchr(comment, '>') + 1;
-		} else {
-			comment = pos;
-			break;
-		}
+
+	doc->root = NULL;
+	doc->arena = NULL;
+	memset(&dom, 0, sizeof(struct xml_dom));
+	dom.doc = doc;
+
+	if (xml_sax_parse(doc_buf, doc_len, &xml_dom_handler, &dom) != 1) {
+		xml_delete_doc(doc);
+		return NULL;
 	}
-	if (proc_inst > comment) {
-		prolog_end = proc_inst;
-	} else {
-		prolog_end = comment;
+
+	doc->root = dom.root;
+
+	return doc;
+}
+
+void xml_delete_doc(struct xml_doc *doc)
+{
+	struct xml_arena_blk *blk = (struct xml_arena_blk *) doc->arena;
+
+	while (blk) {
+		struct xml_arena_blk *next = blk->next;
+
+		xml_free(blk);
+		blk = next;
 	}
 
-	return _xml_parse_doc(prolog_end, doc_buf + doc_len - prolog_end, NULL);
+	xml_free(doc);
 }
 
 static struct xml_node *xml_new_node(void)
@@ -763,29 +991,31 @@ void xml_set_text(struct xml_node *node, char *text)
 	}
 }
 
-static void _xml_element_count(struct xml_node *root, char *name, int *count)
+/* node array of set grows by doubling when count reaches a power of two */
+static int xml_set_add(struct xml_node_set *node_set, struct xml_node *node)
 {
-	if (xml_is_element(root)) {
-		struct xml_node *child = root->child;
+	int count = node_set->count;
 
-		if (strcmp(root->name, name) == 0) {
-			(*count) ++;
+	if ((count == 0) || ((count >= XML_SET_INIT_NUM) && ((count & (count - 1)) == 0))) {
+		int size = (count == 0) ? XML_SET_INIT_NUM : (count * 2);
+		struct xml_node **set_node = (struct xml_node **) xml_malloc(size * sizeof(struct xml_node *));
+
+		if (set_node == NULL) {
+			return -1;
 		}
 
-		while (child) {
-			_xml_element_count(child, name, count);
-			child = child->next;
+		if (node_set->node) {
+			memcpy(set_node, node_set->node, count * sizeof(struct xml_node *));
+			xml_free(node_set->node);
 		}
-	}
-}
 
-static int xml_element_count(struct xml_node *root, char *name)
-{
-	int count = 0;
+		node_set->node = set_node;
+	}
 
-	_xml_element_count(root, name, &count);
+	node_set->node[node_set->count] = node;
+	node_set->count ++;
 
-	return count;
+	return 0;
 }
 
 static void _xml_find_element(struct xml_node *root, char *name, struct xml_node_set *node_set)
@@ -794,8 +1024,7 @@ static void _xml_find_element(struct xml_node *root, char *name, struct xml_node
 		struct xml_node *child = root->child;
 
 		if (strcmp(root->name, name) == 0) {
-			node_set->node[node_set->count] = root;
-			node_set->count ++;
+			xml_set_add(node_set, root);
 		}
 
 		while (child) {
@@ -808,128 +1037,35 @@ static void _xml_find_element(struct xml_node *root, char *name, struct xml_node
 struct xml_node_set *xml_find_element(struct xml_node *root, char *name)
 {
 	struct xml_node_set *node_set = NULL;
-	int node_count;
 
 	node_set = (struct xml_node_set *) xml_malloc(sizeof(struct xml_node_set));
 	node_set->count = 0;
-	node_count = xml_element_count(root, name);
-
-	if (node_count) {
-		node_set->node = (struct xml_node **) xml_malloc(node_count * sizeof(struct xml_node *));
-	} else {
-		node_set->node = NULL;
-	}
+	node_set->node = NULL;
 
 	_xml_find_element(root, name, node_set);
 
 	return node_set;
 }
 
-static void _xml_path_count(struct xml_node *root, char *path, int *count)
+/* path step "prefix:name" or "name" of step_len chars */
+static int xml_path_match(struct xml_node *node, char *step, int step_len)
 {
-	if (xml_is_element(root)) {
-		char *front = NULL, *rear = NULL;
-
-		if ((front = (char *) strchr(path, '/')) != NULL) {
-			int prefix_len, name_len;
-			char *prefix, *name, *prefix_char;
-			int prefix_matched = 0, name_matched = 0;
-
-			front ++;
-			prefix_char = (char *) strchr(front, ':');
-
-			if ((rear = (char *) strchr(front, '/')) != NULL) {
-				if (prefix_char && (prefix_char < rear)) {
-					prefix_len = prefix_char - front;
-					prefix = (char *) xml_malloc(prefix_len + 1);
-					memcpy(prefix, front, prefix_len);
-					prefix[prefix_len] = '\0';
-
-					name_len = rear - (prefix_char + 1);
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, prefix_char + 1, name_len);
-					name[name_len] = '\0';
-				} else {
-					prefix = NULL;
-					name_len = rear - front;
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, front, name_len);
-					name[name_len] = '\0';
-				}
-
-				if ((!prefix && !root->prefix) ||
-					(prefix && root->prefix && (strcmp(root->prefix, prefix) == 0))) {
-					prefix_matched = 1;
-				} else {
-					prefix_matched = 0;
-				}
+	char *prefix_char = (char *) memchr(step, ':', step_len);
 
-				if (strcmp(root->name, name) == 0) {
-					name_matched = 1;
-				} else {
-					name_matched = 0;
-				}
-
-				if (prefix_matched && name_matched) {
-					struct xml_node *child = root->child;
-
-					while (child) {
-						_xml_path_count(child, rear, count);
-						child = child->next;
-					}
-				}
-			} else {
-				if (prefix_char) {
-					prefix_len = prefix_char - front;
-					prefix = (char *) xml_malloc(prefix_len + 1);
-					memcpy(prefix, front, prefix_len);
-					prefix[prefix_len] = '\0';
-
-					name_len = strlen(path) - (prefix_char + 1 - path);
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, prefix_char + 1, name_len);
-					name[name_len] = '\0';
-				} else {
-					prefix = NULL;
-					name_len = strlen(path) - (front - path);
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, front, name_len);
-					name[name_len] = '\0';
-				}
-
-				if ((!prefix && !root->prefix) ||
-					(prefix && root->prefix && (strcmp(root->prefix, prefix) == 0))) {
-					prefix_matched = 1;
-				} else {
-					prefix_matched = 0;
-				}
-
-				if (strcmp(root->name, name) == 0) {
-					name_matched = 1;
-				} else {
-					name_matched = 0;
-				}
-
-				if (prefix_matched && name_matched) {
-					(*count) ++;
-				}
-			}
+	if (prefix_char) {
+		int prefix_len = prefix_char - step;
 
-			if (prefix) {
-				xml_free(prefix);
-			}
-			xml_free(name);
+		if (!node->prefix || (strncmp(node->prefix, step, prefix_len) != 0) || (node->prefix[prefix_len] != '\0')) {
+			return 0;
 		}
-	}
-}
-
-static int xml_path_count(struct xml_node *root, char *path)
-{
-	int count = 0;
 
-	_xml_path_count(root, path, &count);
+		step = prefix_char + 1;
+		step_len -= prefix_len + 1;
+	} else if (node->prefix) {
+		return 0;
+	}
 
-	return count;
+	return (strncmp(node->name, step, step_len) == 0) && (node->name[step_len] == '\0');
 }
 
 static void _xml_find_path(struct xml_node *root, char *path, struct xml_node_set *node_set)
@@ -938,95 +1074,23 @@ static void _xml_find_path(struct xml_node *root, char *path, struct xml_node_se
 		char *front = NULL, *rear = NULL;
 
 		if ((front = (char *) strchr(path, '/')) != NULL) {
-			int prefix_len, name_len;
-			char *prefix, *name, *prefix_char;
-			int prefix_matched = 0, name_matched = 0;
-
 			front ++;
-			prefix_char = (char *) strchr(front, ':');
-
-			if ((rear = (char *) strchr(front, '/')) != NULL) {
-				if (prefix_char && (prefix_char < rear)) {
-					prefix_len = prefix_char - front;
-					prefix = (char *) xml_malloc(prefix_len + 1);
-					memcpy(prefix, front, prefix_len);
-					prefix[prefix_len] = '\0';
-
-					name_len = rear - (prefix_char + 1);
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, prefix_char + 1, name_len);
-					name[name_len] = '\0';
-				} else {
-					prefix = NULL;
-					name_len = rear - front;
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, front, name_len);
-					name[name_len] = '\0';
-				}
-
-				if ((!prefix && !root->prefix) ||
-					(prefix && root->prefix && (strcmp(root->prefix, prefix) == 0))) {
-					prefix_matched = 1;
-				} else {
-					prefix_matched = 0;
-				}
+			rear = (char *) strchr(front, '/');
 
-				if (strcmp(root->name, name) == 0) {
-					name_matched = 1;
-				} else {
-					name_matched = 0;
-				}
+			if (!xml_path_match(root, front, rear ? (rear - front) : (int) strlen(front))) {
+				return;
+			}
 
-				if (prefix_matched && name_matched) {
-					struct xml_node *child = root->child;
+			if (rear) {
+				struct xml_node *child = root->child;
 
-					while (child) {
-						_xml_find_path(child, rear, node_set);
-						child = child->next;
-					}
+				while (child) {
+					_xml_find_path(child, rear, node_set);
+					child = child->next;
 				}
 			} else {
-				if (prefix_char) {
-					prefix_len = prefix_char - front;
-					prefix = (char *) xml_malloc(prefix_len + 1);
-					memcpy(prefix, front, prefix_len);
-					prefix[prefix_len] = '\0';
-
-					name_len = strlen(path) - (prefix_char + 1 - path);
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, prefix_char + 1, name_len);
-					name[name_len] = '\0';
-				} else {
-					prefix = NULL;
-					name_len = strlen(path) - (front - path);
-					name = (char *) xml_malloc(name_len + 1);
-					memcpy(name, front, name_len);
-					name[name_len] = '\0';
-				}
-
-				if ((!prefix && !root->prefix) ||
-					(prefix && root->prefix && (strcmp(root->prefix, prefix) == 0))) {
-					prefix_matched = 1;
-				} else {
-					prefix_matched = 0;
-				}
-
-				if (strcmp(root->name, name) == 0) {
-					name_matched = 1;
-				} else {
-					name_matched = 0;
-				}
-
-				if (prefix_matched && name_matched) {
-					node_set->node[node_set->count] = root;
-					node_set->count ++;
-				}
+				xml_set_add(node_set, root);
 			}
-
-			if (prefix) {
-				xml_free(prefix);
-			}
-			xml_free(name);
 		}
 	}
 }
@@ -1034,17 +1098,10 @@ static void _xml_find_path(struct xml_node *root, char *path, struct xml_node_se
 struct xml_node_set *xml_find_path(struct xml_node *root, char *path)
 {
 	struct xml_node_set *node_set = NULL;
-	int node_count;
 
 	node_set = (struct xml_node_set *) xml_malloc(sizeof(struct xml_node_set));
 	node_set->count = 0;
-	node_count = xml_path_count(root, path);
-
-	if (node_count) {
-		node_set->node = (struct xml_node **) xml_malloc(node_count * sizeof(struct xml_node *));
-	} else {
-		node_set->node = NULL;
-	}
+	node_set->node = NULL;
 
 	_xml_find_path(root, path, node_set);
 
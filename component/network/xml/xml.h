@@ -18,10 +18,39 @@ struct xml_node_set {
 	struct xml_node **node;
 };
 
+#ifndef XML_SAX_MAX_DEPTH
+#define XML_SAX_MAX_DEPTH	24
+#endif
+
+#ifndef XML_ARENA_BLK_SIZE
+#define XML_ARENA_BLK_SIZE	1024
+#endif
+
+#define XML_SET_INIT_NUM	4
+
+/* Callbacks of xml_sax_parse, return non-zero to stop parsing.
+ * Strings are NUL-terminated in the parsed buffer except uri, which has uri_len chars and
+ * points into attr. uri is the namespace declared on the element itself.
+ */
+struct xml_sax_handler {
+	int (*start_element)(void *ctx, char *prefix, char *name, char *attr, char *uri, int uri_len);
+	int (*end_element)(void *ctx, char *prefix, char *name);
+	int (*text)(void *ctx, char *text, int text_len);
+};
+
+/* Tree parsed in place by xml_parse_insitu, release with xml_delete_doc */
+struct xml_doc {
+	struct xml_node *root;
+	void *arena;
+};
+
 void xml_free(void *buf);
 int xml_doc_name(char *doc_buf, int doc_len, char **doc_prefix, char **doc_name, char **doc_uri);
 struct xml_node *xml_parse_doc(char *doc_buf, int doc_len, char *prefix, char *doc_name, char *uri);
 struct xml_node *xml_parse(char *doc_buf, int doc_len);
+int xml_sax_parse(char *doc_buf, int doc_len, const struct xml_sax_handler *handler, void *ctx);
+struct xml_doc *xml_parse_insitu(char *doc_buf, int doc_len);
+void xml_delete_doc(struct xml_doc *doc);
 struct xml_node *xml_new_element(char *prefix, char *name, char *uri);
 struct xml_node *xml_new_text(char *text);
 int xml_is_element(struct xml_node *node);
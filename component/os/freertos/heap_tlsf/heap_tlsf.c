@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * heap_5 compatible port over two TLSF instances. malloc and free cost a few bit scans whatever the
+ * number of free blocks, so the time spent with the scheduler suspended no longer grows with
+ * fragmentation.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "ameba.h"
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "heap_tlsf.h"
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* blocks handed out must keep the alignment heap_5 guarantees */
+typedef char heap_tlsf_align_check[(TLSF_ALIGN_SIZE == portBYTE_ALIGNMENT) ? 1 : -1];
+
+PRIVILEGED_DATA static tlsf_t *pxHeapTlsf[HEAP_TLSF_NUM];
+PRIVILEGED_DATA static size_t xHeapTlsfBase[HEAP_TLSF_NUM];
+
+/* totals over both instances, as reported by heap_5 */
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+static const char *const pcHeapTlsfName[HEAP_TLSF_NUM] = {"SRAM", "PSRAM"};
+
+static int prvHeapIndex(size_t xAddress)
+{
+#ifdef PSRAM_BASE
+	if (xAddress >= PSRAM_BASE) {
+		return HEAP_TLSF_PSRAM;
+	}
+#else
+	(void) xAddress;
+#endif
+	return HEAP_TLSF_SRAM;
+}
+
+/* heap_5 only hands out blocks at or above startAddr, an instance qualifies when all its regions do */
+static BaseType_t prvHeapQualifies(int i, uint32_t startAddr)
+{
+	return (pxHeapTlsf[i] != NULL) && (xHeapTlsfBase[i] >= startAddr);
+}
+
+static int prvHeapOwner(const void *pv)
+{
+	int i;
+
+	for (i = 0; i < HEAP_TLSF_NUM; i++) {
+		if ((pxHeapTlsf[i] != NULL) && tlsf_owns(pxHeapTlsf[i], pv)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void prvUpdateFreeBytes(void)
+{
+	int i;
+
+	xFreeBytesRemaining = 0;
+	for (i = 0; i < HEAP_TLSF_NUM; i++) {
+		if (pxHeapTlsf[i] != NULL) {
+			xFreeBytesRemaining += tlsf_free_size(pxHeapTlsf[i]);
+		}
+	}
+
+	if (xFreeBytesRemaining < xMinimumEverFreeBytesRemaining) {
+		xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocBase(size_t xWantedSize, uint32_t startAddr)
+{
+	void *pvReturn = NULL;
+	int i;
+
+	/* The heap must be initialised before the first call to
+	 * prvPortMalloc(). */
+	configASSERT(xMinimumEverFreeBytesRemaining);
+
+	vTaskSuspendAll();
+	{
+		/* instances are tried from the lowest address up, like the first fit walk of heap_5 */
+		for (i = 0; (i < HEAP_TLSF_NUM) && (pvReturn == NULL); i++) {
+			if (prvHeapQualifies(i, startAddr)) {
+				pvReturn = tlsf_malloc(pxHeapTlsf[i], xWantedSize);
+			}
+		}
+
+		if (pvReturn != NULL) {
+			prvUpdateFreeBytes();
+		}
+
+		traceMALLOC(pvReturn, xWantedSize);
+	}
+	(void) xTaskResumeAll();
+
+#if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if (pvReturn == NULL) {
+			extern void vApplicationMallocFailedHook(size_t xWantedSize);
+			vApplicationMallocFailedHook(xWantedSize);
+		} else {
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+#endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+
+	configASSERT((((size_t) pvReturn) & (size_t) portBYTE_ALIGNMENT_MASK) == 0);
+	return pvReturn;
+}
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+	return pvPortMallocBase(xWantedSize, 0);
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree(void *pv)
+{
+	int i;
+
+	if (pv == NULL) {
+		return;
+	}
+
+	vTaskSuspendAll();
+	{
+		i = prvHeapOwner(pv);
+		configASSERT(i >= 0);
+
+		if (i >= 0) {
+			traceFREE(pv, tlsf_block_size(pv));
+			tlsf_free(pxHeapTlsf[i], pv);
+			prvUpdateFreeBytes();
+		}
+	}
+	(void) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortReAllocBase(void *pv, size_t xWantedSize, uint32_t startAddr)
+{
+	void *pvReturn = NULL;
+	size_t xOldSize;
+	int i;
+
+	if (pv == NULL) {
+		return xWantedSize ? pvPortMallocBase(xWantedSize, startAddr) : NULL;
+	}
+
+	if (xWantedSize == 0) {
+		vPortFree(pv);
+		return NULL;
+	}
+
+	vTaskSuspendAll();
+	{
+		/* resize within the owning instance when it is of the requested memory type */
+		i = prvHeapOwner(pv);
+		configASSERT(i >= 0);
+
+		if ((i >= 0) && prvHeapQualifies(i, startAddr)) {
+			pvReturn = tlsf_realloc(pxHeapTlsf[i], pv, xWantedSize);
+			prvUpdateFreeBytes();
+		}
+	}
+	(void) xTaskResumeAll();
+
+	if (pvReturn != NULL) {
+		return pvReturn;
+	}
+
+	/* other memory type or the owning instance is full */
+	pvReturn = pvPortMallocBase(xWantedSize, startAddr);
+	if (pvReturn != NULL) {
+		xOldSize = tlsf_block_size(pv);
+		memcpy(pvReturn, pv, (xOldSize < xWantedSize) ? xOldSize : xWantedSize);
+		vPortFree(pv);
+	}
+
+	return pvReturn;
+}
+
+void *pvPortReAlloc(void *pv, size_t xWantedSize)
+{
+	return pvPortReAllocBase(pv, xWantedSize, 0);
+}
+
+void *pvPortCalloc(size_t xWantedCnt, size_t xWantedSize)
+{
+	void *p;
+
+	/* allocate 'xWantedCnt' objects of size 'xWantedSize' */
+	p = pvPortMalloc(xWantedCnt * xWantedSize);
+	if (p) {
+		/* zero the memory */
+		memset(p, 0, xWantedCnt * xWantedSize);
+	}
+	return p;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize(void)
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void xPortResetHeapMinimumEverFreeHeapSize(void)
+{
+	int i;
+
+	vTaskSuspendAll();
+	{
+		for (i = 0; i < HEAP_TLSF_NUM; i++) {
+			if (pxHeapTlsf[i] != NULL) {
+				tlsf_reset_min_free(pxHeapTlsf[i]);
+			}
+		}
+		xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+	}
+	(void) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions(const HeapRegion_t *const pxHeapRegions)
+{
+	const HeapRegion_t *pxHeapRegion;
+	size_t xAddress;
+	int i, ret;
+
+	/* Can only call once! */
+	configASSERT(xMinimumEverFreeBytesRemaining == 0);
+
+	for (pxHeapRegion = pxHeapRegions; pxHeapRegion->xSizeInBytes > 0; pxHeapRegion++) {
+		xAddress = (size_t) pxHeapRegion->pucStartAddress;
+		i = prvHeapIndex(xAddress);
+
+		if (pxHeapTlsf[i] == NULL) {
+			pxHeapTlsf[i] = tlsf_create(pxHeapRegion->pucStartAddress, pxHeapRegion->xSizeInBytes);
+			configASSERT(pxHeapTlsf[i]);
+			xHeapTlsfBase[i] = xAddress;
+		} else {
+			/* Check blocks are passed in with increasing start addresses. */
+			configASSERT(xAddress > xHeapTlsfBase[i]);
+			ret = tlsf_add_pool(pxHeapTlsf[i], pxHeapRegion->pucStartAddress, pxHeapRegion->xSizeInBytes);
+			configASSERT(ret == 0);
+			(void) ret;
+		}
+	}
+
+	xMinimumEverFreeBytesRemaining = (size_t) -1;
+	prvUpdateFreeBytes();
+
+	/* Check something was actually defined before it is accessed. */
+	configASSERT(xFreeBytesRemaining);
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats(HeapStats_t *pxHeapStats)
+{
+	tlsf_stats_t xStats;
+	size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
+	size_t xAllocs = 0, xFrees = 0;
+	int i;
+
+	vTaskSuspendAll();
+	{
+		for (i = 0; i < HEAP_TLSF_NUM; i++) {
+			if (pxHeapTlsf[i] == NULL) {
+				continue;
+			}
+
+			tlsf_get_stats(pxHeapTlsf[i], &xStats);
+			xBlocks += xStats.free_blocks;
+			xAllocs += xStats.alloc_count;
+			xFrees += xStats.free_count;
+
+			if (xStats.free_blocks == 0) {
+				continue;
+			}
+			if (xStats.largest_free_block > xMaxSize) {
+				xMaxSize = xStats.largest_free_block;
+			}
+			if (xStats.smallest_free_block < xMinSize) {
+				xMinSize = xStats.smallest_free_block;
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+	}
+	(void) xTaskResumeAll();
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+	pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+	pxHeapStats->xNumberOfSuccessfulAllocations = xAllocs;
+	pxHeapStats->xNumberOfSuccessfulFrees = xFrees;
+}
+/*-----------------------------------------------------------*/
+
+int heap_tlsf_get_stats(int index, tlsf_stats_t *stats)
+{
+	if ((index < 0) || (index >= HEAP_TLSF_NUM) || (pxHeapTlsf[index] == NULL)) {
+		return -1;
+	}
+
+	vTaskSuspendAll();
+	tlsf_get_stats(pxHeapTlsf[index], stats);
+	(void) xTaskResumeAll();
+
+	return 0;
+}
+
+void heap_tlsf_dump(void)
+{
+	tlsf_stats_t xStats;
+	int i;
+
+	for (i = 0; i < HEAP_TLSF_NUM; i++) {
+		if (heap_tlsf_get_stats(i, &xStats) != 0) {
+			continue;
+		}
+
+		/* fragmentation: share of the free space that the largest block cannot serve */
+		RTK_LOGS(NOTAG, RTK_LOG_INFO, "[%s] total %u, free %u, high-water %u, largest free %u, free blocks %u, fragmentation %u%%, misses %u\n",
+				 pcHeapTlsfName[i], (unsigned)xStats.total_size, (unsigned)xStats.free_size,
+				 (unsigned)(xStats.total_size - xStats.min_free_size), (unsigned)xStats.largest_free_block, (unsigned)xStats.free_blocks,
+				 xStats.free_size ? (unsigned)(100 - (uint64_t)xStats.largest_free_block * 100 / xStats.free_size) : 0U,
+				 (unsigned)xStats.fail_count);
+	}
+}
+
+int heap_tlsf_check(void)
+{
+	int i, err = 0;
+
+	vTaskSuspendAll();
+	for (i = 0; i < HEAP_TLSF_NUM; i++) {
+		if (pxHeapTlsf[i] != NULL) {
+			err += tlsf_check(pxHeapTlsf[i]);
+		}
+	}
+	(void) xTaskResumeAll();
+
+	return err;
+}
+/*-----------------------------------------------------------*/
+
+#if defined (CONFIG_AMEBADPLUS) || defined (CONFIG_AMEBALITE) || defined (CONFIG_AMEBAD) || defined (CONFIG_RTL8720F)
+void vApplicationMallocFailedHook(size_t xWantedSize)
+{
+	char *pcCurrentTask = "NoTsk";
+#if defined (CONFIG_ARM_CORE_CM0)
+	const char *core_name = "KM0";
+#elif defined (CONFIG_ARM_CORE_CM4)
+	const char *core_name = "KM4";
+#elif defined (CONFIG_RSICV_CORE_KR4)
+	const char *core_name = "KR4";
+#elif defined (CONFIG_ARM_CORE_CA32)
+	const char *core_name = "CA32";
+#endif
+
+	if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+		pcCurrentTask = pcTaskGetName(NULL);
+	}
+
+	taskENTER_CRITICAL();
+
+	RTK_LOGS(NOTAG, RTK_LOG_ERROR, "Malloc failed. Core:[%s], Task:[%s], [free heap size: %d] [xWantedSize:%u]\r\n",
+			 core_name, pcCurrentTask, xPortGetFreeHeapSize(), xWantedSize);
+	heap_tlsf_dump();
+
+	for (;;);
+}
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __HEAP_TLSF_H__
+#define __HEAP_TLSF_H__
+
+#include "tlsf.h"
+
+/*
+ * FreeRTOS heap on top of TLSF, a drop-in replacement of heap_5 selected by CONFIG_HEAP_TLSF.
+ * Heap regions below PSRAM_BASE form the SRAM instance, the others the PSRAM instance, so the
+ * startAddr of pvPortMallocBase (rtos_heap_types_malloc) picks an instance instead of walking the
+ * free list past every SRAM block.
+ */
+
+enum {
+	HEAP_TLSF_SRAM = 0,
+	HEAP_TLSF_PSRAM,
+	HEAP_TLSF_NUM,
+};
+
+/**
+ * @brief  Statistics of one instance.
+ * @param  index: HEAP_TLSF_SRAM or HEAP_TLSF_PSRAM
+ * @retval 0 on success, -1 if the instance has no region
+ */
+int heap_tlsf_get_stats(int index, tlsf_stats_t *stats);
+
+/**
+ * @brief  Print size, high-water mark and fragmentation of every instance.
+ */
+void heap_tlsf_dump(void);
+
+/**
+ * @brief  Run tlsf_check on every instance, meant for debugging.
+ * @retval number of inconsistencies found
+ */
+int heap_tlsf_check(void);
+
+#endif
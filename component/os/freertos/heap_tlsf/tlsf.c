@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "tlsf.h"
+
+#define TLSF_SL_INDEX_COUNT		(1U << TLSF_SL_INDEX_COUNT_LOG2)
+#define TLSF_FL_INDEX_SHIFT		(TLSF_SL_INDEX_COUNT_LOG2 + TLSF_ALIGN_SHIFT)
+#define TLSF_FL_INDEX_COUNT		(TLSF_FL_INDEX_MAX - TLSF_FL_INDEX_SHIFT + 1)
+#define TLSF_SMALL_BLOCK_SIZE	((size_t)1 << TLSF_FL_INDEX_SHIFT)
+#define TLSF_MAX_POOLS			4
+
+#define TLSF_ALIGN_UP(x)		(((size_t)(x) + TLSF_ALIGN_SIZE - 1) & ~((size_t)TLSF_ALIGN_SIZE - 1))
+#define TLSF_ALIGN_DOWN(x)		((size_t)(x) & ~((size_t)TLSF_ALIGN_SIZE - 1))
+
+#define TLSF_BLOCK_FREE			((size_t)1)
+#define TLSF_SIZE_MASK			(~((size_t)TLSF_ALIGN_SIZE - 1))
+
+/* Every block starts with a header padded to the alignment, the payload follows it. The size covers
+ * header and payload, so the physical successor is at block + size. While a block is free its payload
+ * holds the links of its size class list. Each pool ends with a zero sized used block that stops
+ * merging. */
+typedef struct tlsf_block {
+	struct tlsf_block *prev_phys;
+	size_t size;
+} tlsf_block_t;
+
+typedef struct {
+	tlsf_block_t *next;
+	tlsf_block_t *prev;
+} tlsf_links_t;
+
+#define TLSF_HDR_SIZE			TLSF_ALIGN_UP(sizeof(tlsf_block_t))
+#define TLSF_MIN_BLOCK_SIZE		(TLSF_HDR_SIZE + TLSF_ALIGN_UP(sizeof(tlsf_links_t)))
+
+struct tlsf_control {
+	uint32_t fl_bitmap;
+	uint32_t sl_bitmap[TLSF_FL_INDEX_COUNT];
+	tlsf_block_t *blocks[TLSF_FL_INDEX_COUNT][TLSF_SL_INDEX_COUNT];
+	struct {
+		uint8_t *start;
+		uint8_t *end;
+	} pool[TLSF_MAX_POOLS];
+	uint32_t pool_count;
+	size_t total_size;
+	size_t free_size;
+	size_t min_free_size;
+	size_t free_blocks;
+	size_t alloc_count;
+	size_t free_count;
+	size_t fail_count;
+};
+
+#define TLSF_CONTROL_SIZE		TLSF_ALIGN_UP(sizeof(struct tlsf_control))
+
+typedef char tlsf_sl_fits_bitmap[(TLSF_SL_INDEX_COUNT <= 32) ? 1 : -1];
+typedef char tlsf_fl_fits_bitmap[(TLSF_FL_INDEX_COUNT <= 32) ? 1 : -1];
+
+static inline int tlsf_fls(size_t x)
+{
+	return (int)(sizeof(unsigned long) * 8) - 1 - __builtin_clzl((unsigned long)x);
+}
+
+static inline int tlsf_ffs(uint32_t x)
+{
+	return __builtin_ctz(x);
+}
+
+static inline size_t tlsf_size(const tlsf_block_t *block)
+{
+	return block->size & TLSF_SIZE_MASK;
+}
+
+static inline int tlsf_is_free(const tlsf_block_t *block)
+{
+	return (block->size & TLSF_BLOCK_FREE) != 0;
+}
+
+static inline tlsf_block_t *tlsf_next_phys(const tlsf_block_t *block)
+{
+	return (tlsf_block_t *)((uint8_t *)block + tlsf_size(block));
+}
+
+static inline tlsf_links_t *tlsf_links(tlsf_block_t *block)
+{
+	return (tlsf_links_t *)((uint8_t *)block + TLSF_HDR_SIZE);
+}
+
+static inline void *tlsf_payload(tlsf_block_t *block)
+{
+	return (uint8_t *)block + TLSF_HDR_SIZE;
+}
+
+static inline tlsf_block_t *tlsf_from_payload(const void *ptr)
+{
+	return (tlsf_block_t *)((uint8_t *)ptr - TLSF_HDR_SIZE);
+}
+
+static void tlsf_mapping(size_t size, int *fl, int *sl)
+{
+	int bit;
+
+	if (size < TLSF_SMALL_BLOCK_SIZE) {
+		*fl = 0;
+		*sl = (int)(size >> TLSF_ALIGN_SHIFT);
+	} else {
+		bit = tlsf_fls(size);
+		*sl = (int)(size >> (bit - TLSF_SL_INDEX_COUNT_LOG2)) - TLSF_SL_INDEX_COUNT;
+		*fl = bit - TLSF_FL_INDEX_SHIFT + 1;
+	}
+}
+
+static void tlsf_insert(tlsf_t *tlsf, tlsf_block_t *block)
+{
+	tlsf_block_t *head;
+	int fl, sl;
+
+	tlsf_mapping(tlsf_size(block), &fl, &sl);
+	head = tlsf->blocks[fl][sl];
+
+	tlsf_links(block)->prev = NULL;
+	tlsf_links(block)->next = head;
+	if (head) {
+		tlsf_links(head)->prev = block;
+	}
+	tlsf->blocks[fl][sl] = block;
+	tlsf->fl_bitmap |= 1U << fl;
+	tlsf->sl_bitmap[fl] |= 1U << sl;
+
+	block->size |= TLSF_BLOCK_FREE;
+	tlsf->free_blocks++;
+}
+
+static void tlsf_remove(tlsf_t *tlsf, tlsf_block_t *block)
+{
+	tlsf_links_t *links = tlsf_links(block);
+	int fl, sl;
+
+	tlsf_mapping(tlsf_size(block), &fl, &sl);
+
+	if (links->next) {
+		tlsf_links(links->next)->prev = links->prev;
+	}
+	if (links->prev) {
+		tlsf_links(links->prev)->next = links->next;
+	} else {
+		tlsf->blocks[fl][sl] = links->next;
+		if (links->next == NULL) {
+			tlsf->sl_bitmap[fl] &= ~(1U << sl);
+			if (tlsf->sl_bitmap[fl] == 0) {
+				tlsf->fl_bitmap &= ~(1U << fl);
+			}
+		}
+	}
+
+	block->size &= ~TLSF_BLOCK_FREE;
+	tlsf->free_blocks--;
+}
+
+/* first block of a list whose class is entirely >= size, so any of its blocks fits */
+static tlsf_block_t *tlsf_find(tlsf_t *tlsf, size_t size)
+{
+	uint32_t sl_map, fl_map;
+	int fl, sl;
+
+	if (size >= TLSF_SMALL_BLOCK_SIZE) {
+		size += ((size_t)1 << (tlsf_fls(size) - TLSF_SL_INDEX_COUNT_LOG2)) - 1;
+		if (tlsf_fls(size) >= TLSF_FL_INDEX_MAX) {
+			return NULL;
+		}
+	}
+	tlsf_mapping(size, &fl, &sl);
+
+	sl_map = tlsf->sl_bitmap[fl] & (~0U << sl);
+	if (sl_map == 0) {
+		fl_map = (fl + 1 < 32) ? tlsf->fl_bitmap & (~0U << (fl + 1)) : 0;
+		if (fl_map == 0) {
+			return NULL;
+		}
+		fl = tlsf_ffs(fl_map);
+		sl_map = tlsf->sl_bitmap[fl];
+	}
+	sl = tlsf_ffs(sl_map);
+
+	return tlsf->blocks[fl][sl];
+}
+
+/* cut block down to size, the tail becomes a free block merged with a free successor */
+static void tlsf_trim(tlsf_t *tlsf, tlsf_block_t *block, size_t size)
+{
+	tlsf_block_t *rest, *next;
+	size_t rest_size = tlsf_size(block) - size;
+
+	if (rest_size < TLSF_MIN_BLOCK_SIZE) {
+		return;
+	}
+
+	rest = (tlsf_block_t *)((uint8_t *)block + size);
+	rest->prev_phys = block;
+	rest->size = rest_size;
+	block->size = size | (block->size & TLSF_BLOCK_FREE);
+
+	next = tlsf_next_phys(rest);
+	if (tlsf_is_free(next)) {
+		tlsf_remove(tlsf, next);
+		rest->size += tlsf_size(next);
+		next = tlsf_next_phys(rest);
+	}
+	next->prev_phys = rest;
+	tlsf_insert(tlsf, rest);
+}
+
+/* bytes of block needed for a payload of size, 0 on overflow */
+static size_t tlsf_adjust(size_t size)
+{
+	size_t adjusted;
+
+	if (size == 0 || size > ((size_t)1 << TLSF_FL_INDEX_MAX)) {
+		return 0;
+	}
+
+	adjusted = TLSF_ALIGN_UP(size) + TLSF_HDR_SIZE;
+	return adjusted < TLSF_MIN_BLOCK_SIZE ? TLSF_MIN_BLOCK_SIZE : adjusted;
+}
+
+static void tlsf_used_update(tlsf_t *tlsf)
+{
+	if (tlsf->free_size < tlsf->min_free_size) {
+		tlsf->min_free_size = tlsf->free_size;
+	}
+}
+
+tlsf_t *tlsf_create(void *mem, size_t bytes)
+{
+	size_t start = TLSF_ALIGN_UP(mem);
+	tlsf_t *tlsf;
+
+	if (bytes < (start - (size_t)mem) + TLSF_CONTROL_SIZE + TLSF_MIN_BLOCK_SIZE + TLSF_HDR_SIZE) {
+		return NULL;
+	}
+
+	tlsf = (tlsf_t *)start;
+	memset(tlsf, 0, sizeof(struct tlsf_control));
+	bytes -= (start - (size_t)mem) + TLSF_CONTROL_SIZE;
+
+	if (tlsf_add_pool(tlsf, (uint8_t *)tlsf + TLSF_CONTROL_SIZE, bytes) != 0) {
+		return NULL;
+	}
+	return tlsf;
+}
+
+int tlsf_add_pool(tlsf_t *tlsf, void *mem, size_t bytes)
+{
+	size_t start = TLSF_ALIGN_UP(mem);
+	size_t end = TLSF_ALIGN_DOWN((size_t)mem + bytes);
+	tlsf_block_t *block, *sentinel;
+	size_t size;
+
+	if (tlsf->pool_count >= TLSF_MAX_POOLS || end <= start || end - start < TLSF_MIN_BLOCK_SIZE + TLSF_HDR_SIZE) {
+		return -1;
+	}
+
+	/* a block must fit in the first level range, the rest of a huge region is left unused */
+	size = end - start - TLSF_HDR_SIZE;
+	if (size >= ((size_t)1 << TLSF_FL_INDEX_MAX)) {
+		size = ((size_t)1 << TLSF_FL_INDEX_MAX) - TLSF_ALIGN_SIZE;
+	}
+
+	block = (tlsf_block_t *)start;
+	block->prev_phys = NULL;
+	block->size = size;
+
+	sentinel = tlsf_next_phys(block);
+	sentinel->prev_phys = block;
+	sentinel->size = 0;
+
+	tlsf_insert(tlsf, block);
+
+	tlsf->pool[tlsf->pool_count].start = (uint8_t *)start;
+	tlsf->pool[tlsf->pool_count].end = (uint8_t *)sentinel;
+	tlsf->pool_count++;
+	tlsf->total_size += size;
+	tlsf->free_size += size;
+	tlsf->min_free_size += size;
+
+	return 0;
+}
+
+int tlsf_owns(tlsf_t *tlsf, const void *ptr)
+{
+	uint32_t i;
+
+	for (i = 0; i < tlsf->pool_count; i++) {
+		if ((const uint8_t *)ptr >= tlsf->pool[i].start && (const uint8_t *)ptr < tlsf->pool[i].end) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void *tlsf_malloc(tlsf_t *tlsf, size_t size)
+{
+	size_t adjusted = tlsf_adjust(size);
+	tlsf_block_t *block;
+
+	block = adjusted ? tlsf_find(tlsf, adjusted) : NULL;
+	if (block == NULL) {
+		tlsf->fail_count++;
+		return NULL;
+	}
+
+	tlsf_remove(tlsf, block);
+	tlsf_trim(tlsf, block, adjusted);
+
+	tlsf->free_size -= tlsf_size(block);
+	tlsf->alloc_count++;
+	tlsf_used_update(tlsf);
+
+	return tlsf_payload(block);
+}
+
+void tlsf_free(tlsf_t *tlsf, void *ptr)
+{
+	tlsf_block_t *block, *next, *prev;
+
+	if (ptr == NULL) {
+		return;
+	}
+
+	block = tlsf_from_payload(ptr);
+	if (tlsf_is_free(block)) {
+		/* double free */
+		return;
+	}
+
+	tlsf->free_size += tlsf_size(block);
+	tlsf->free_count++;
+
+	next = tlsf_next_phys(block);
+	if (tlsf_is_free(next)) {
+		tlsf_remove(tlsf, next);
+		block->size += tlsf_size(next);
+	}
+
+	prev = block->prev_phys;
+	if (prev && tlsf_is_free(prev)) {
+		tlsf_remove(tlsf, prev);
+		prev->size += tlsf_size(block);
+		block = prev;
+	}
+
+	tlsf_next_phys(block)->prev_phys = block;
+	tlsf_insert(tlsf, block);
+}
+
+void *tlsf_realloc(tlsf_t *tlsf, void *ptr, size_t size)
+{
+	size_t adjusted, cur;
+	tlsf_block_t *block, *next;
+	void *p;
+
+	if (ptr == NULL) {
+		return tlsf_malloc(tlsf, size);
+	}
+	if (size == 0) {
+		tlsf_free(tlsf, ptr);
+		return NULL;
+	}
+
+	adjusted = tlsf_adjust(size);
+	if (adjusted == 0) {
+		return NULL;
+	}
+
+	block = tlsf_from_payload(ptr);
+	cur = tlsf_size(block);
+	next = tlsf_next_phys(block);
+
+	if (adjusted > cur && tlsf_is_free(next) && cur + tlsf_size(next) >= adjusted) {
+		/* grow into the free successor */
+		tlsf_remove(tlsf, next);
+		tlsf->free_size -= tlsf_size(next);
+		block->size += tlsf_size(next);
+		tlsf_next_phys(block)->prev_phys = block;
+		tlsf_used_update(tlsf);
+	} else if (adjusted > cur) {
+		p = tlsf_malloc(tlsf, size);
+		if (p) {
+			memcpy(p, ptr, cur - TLSF_HDR_SIZE);
+			tlsf_free(tlsf, ptr);
+		}
+		return p;
+	}
+
+	cur = tlsf_size(block);
+	tlsf_trim(tlsf, block, adjusted);
+	tlsf->free_size += cur - tlsf_size(block);
+
+	return ptr;
+}
+
+size_t tlsf_block_size(const void *ptr)
+{
+	return ptr ? tlsf_size(tlsf_from_payload(ptr)) - TLSF_HDR_SIZE : 0;
+}
+
+size_t tlsf_free_size(tlsf_t *tlsf)
+{
+	return tlsf->free_size;
+}
+
+static size_t tlsf_list_extreme(tlsf_t *tlsf, uint32_t fl, uint32_t sl, int largest)
+{
+	tlsf_block_t *block;
+	size_t size = largest ? 0 : (size_t) -1;
+
+	for (block = tlsf->blocks[fl][sl]; block; block = tlsf_links(block)->next) {
+		if (largest ? tlsf_size(block) > size : tlsf_size(block) < size) {
+			size = tlsf_size(block);
+		}
+	}
+	return size - TLSF_HDR_SIZE;
+}
+
+void tlsf_get_stats(tlsf_t *tlsf, tlsf_stats_t *stats)
+{
+	int fl;
+
+	memset(stats, 0, sizeof(tlsf_stats_t));
+	stats->total_size = tlsf->total_size;
+	stats->free_size = tlsf->free_size;
+	stats->min_free_size = tlsf->min_free_size;
+	stats->free_blocks = tlsf->free_blocks;
+	stats->alloc_count = tlsf->alloc_count;
+	stats->free_count = tlsf->free_count;
+	stats->fail_count = tlsf->fail_count;
+
+	/* the bitmaps point at the extreme size classes, only those two lists are walked */
+	if (tlsf->fl_bitmap) {
+		fl = tlsf_fls(tlsf->fl_bitmap);
+		stats->largest_free_block = tlsf_list_extreme(tlsf, fl, tlsf_fls(tlsf->sl_bitmap[fl]), 1);
+		fl = tlsf_ffs(tlsf->fl_bitmap);
+		stats->smallest_free_block = tlsf_list_extreme(tlsf, fl, tlsf_ffs(tlsf->sl_bitmap[fl]), 0);
+	}
+}
+
+void tlsf_reset_min_free(tlsf_t *tlsf)
+{
+	tlsf->min_free_size = tlsf->free_size;
+}
+
+int tlsf_check(tlsf_t *tlsf)
+{
+	tlsf_block_t *block, *prev;
+	size_t free_size = 0, free_blocks = 0, listed = 0;
+	uint32_t i, fl, sl;
+	int fl_m, sl_m;
+	int err = 0;
+
+	for (i = 0; i < tlsf->pool_count; i++) {
+		prev = NULL;
+		for (block = (tlsf_block_t *)tlsf->pool[i].start; tlsf_size(block); block = tlsf_next_phys(block)) {
+			err += block->prev_phys != prev;
+			err += (uint8_t *)block >= tlsf->pool[i].end;
+			if (tlsf_is_free(block)) {
+				err += prev && tlsf_is_free(prev);		/* two free neighbours were not merged */
+				free_size += tlsf_size(block);
+				free_blocks++;
+			}
+			prev = block;
+		}
+		err += block != (tlsf_block_t *)tlsf->pool[i].end;
+	}
+
+	for (fl = 0; fl < TLSF_FL_INDEX_COUNT; fl++) {
+		err += !(tlsf->fl_bitmap & (1U << fl)) != !tlsf->sl_bitmap[fl];
+		for (sl = 0; sl < TLSF_SL_INDEX_COUNT; sl++) {
+			err += !(tlsf->sl_bitmap[fl] & (1U << sl)) != !tlsf->blocks[fl][sl];
+			for (block = tlsf->blocks[fl][sl]; block; block = tlsf_links(block)->next) {
+				tlsf_mapping(tlsf_size(block), &fl_m, &sl_m);
+				err += !tlsf_is_free(block) || (uint32_t)fl_m != fl || (uint32_t)sl_m != sl;
+				listed++;
+			}
+		}
+	}
+
+	err += free_size != tlsf->free_size;
+	err += free_blocks != tlsf->free_blocks || listed != free_blocks;
+
+	return err;
+}
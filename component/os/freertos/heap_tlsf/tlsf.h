@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __TLSF_H__
+#define __TLSF_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform_autoconf.h"
+
+/*
+ * Two-level segregated fit allocator.
+ * Free blocks are kept in size classes: a first level of power of two ranges, each split linearly into
+ * 2^TLSF_SL_INDEX_COUNT_LOG2 second level lists. Two bitmaps record which lists are non-empty, so
+ * malloc and free are a fixed number of bit scans and list operations whatever the fragmentation.
+ * Freed blocks are merged with their physical neighbours immediately.
+ *
+ * A tlsf_t is one heap instance. Its control structure lives at the start of the first pool, further
+ * pools (non-contiguous regions) can be added to the same instance. The allocator does no locking.
+ */
+
+/* payload alignment and allocation granularity, portBYTE_ALIGNMENT of the FreeRTOS port */
+#ifndef TLSF_ALIGN_SHIFT
+#if defined(CONFIG_AMEBASMART) && (defined(CONFIG_ARM_CORE_CM4) || defined(CONFIG_ARM_CORE_CA32))
+#define TLSF_ALIGN_SHIFT			6
+#else
+#define TLSF_ALIGN_SHIFT			5
+#endif
+#endif
+#define TLSF_ALIGN_SIZE				(1U << TLSF_ALIGN_SHIFT)
+
+/* second level lists per power of two, 16 keeps the control structure around 1.3KB */
+#ifndef TLSF_SL_INDEX_COUNT_LOG2
+#define TLSF_SL_INDEX_COUNT_LOG2	4
+#endif
+
+/* largest pool is 2^TLSF_FL_INDEX_MAX bytes, 256MB covers the PSRAM window */
+#ifndef TLSF_FL_INDEX_MAX
+#define TLSF_FL_INDEX_MAX			28
+#endif
+
+typedef struct tlsf_control tlsf_t;
+
+typedef struct {
+	size_t total_size;			/* bytes given to the instance by all pools, headers included */
+	size_t free_size;			/* sum of all free blocks */
+	size_t min_free_size;		/* lowest free_size ever seen, total_size - min_free_size is the high-water mark */
+	size_t largest_free_block;	/* payload of the largest free block */
+	size_t smallest_free_block;	/* payload of the smallest free block */
+	size_t free_blocks;
+	size_t alloc_count;			/* successful allocations */
+	size_t free_count;			/* successful frees */
+	size_t fail_count;			/* allocations that found no block */
+} tlsf_stats_t;
+
+/**
+ * @brief  Create an instance in a memory region, the rest of the region becomes its first pool.
+ * @param  mem: region start, any alignment
+ * @param  bytes: region size
+ * @retval instance or NULL if the region is too small for control structure and one block
+ */
+tlsf_t *tlsf_create(void *mem, size_t bytes);
+
+/**
+ * @brief  Add a region to an instance.
+ * @retval 0 on success, -1 if the region is too small or too large
+ */
+int tlsf_add_pool(tlsf_t *tlsf, void *mem, size_t bytes);
+
+/**
+ * @brief  Check if a pointer lies inside one of the pools of an instance.
+ */
+int tlsf_owns(tlsf_t *tlsf, const void *ptr);
+
+void *tlsf_malloc(tlsf_t *tlsf, size_t size);
+void tlsf_free(tlsf_t *tlsf, void *ptr);
+
+/**
+ * @brief  Resize a block, in place when the block or its free successor is big enough.
+ * @retval new block, NULL on failure with the old block left untouched
+ */
+void *tlsf_realloc(tlsf_t *tlsf, void *ptr, size_t size);
+
+/**
+ * @brief  Usable size of an allocated block, at least the size requested.
+ */
+size_t tlsf_block_size(const void *ptr);
+
+/**
+ * @brief  Sum of all free blocks, the cheap part of tlsf_get_stats.
+ */
+size_t tlsf_free_size(tlsf_t *tlsf);
+
+/**
+ * @brief  Collect statistics. Walks the largest and smallest non-empty size classes only, not the whole heap.
+ */
+void tlsf_get_stats(tlsf_t *tlsf, tlsf_stats_t *stats);
+
+/**
+ * @brief  Reset min_free_size to the current free_size.
+ */
+void tlsf_reset_min_free(tlsf_t *tlsf);
+
+/**
+ * @brief  Walk every block of every pool and cross-check headers, free lists and bitmaps.
+ * @retval number of inconsistencies found, 0 for a sound heap
+ */
+int tlsf_check(tlsf_t *tlsf);
+
+#endif
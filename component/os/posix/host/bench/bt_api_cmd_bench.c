@@ -0,0 +1,652 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * BT API commands against a stub BT API task and lower stack. An act either completes in the BT
+ * API task, or is put on the pending commands and handed to the lower stack, which answers with
+ * the message type the command waits for, the way the LE GAP acts do. The lower stack can hold its
+ * answers and give them back in reverse order, so several commands wait on different message types
+ * at the same time. The bench checks that every command sent by rtk_bt_send_cmd_async completes
+ * once with its own result, by callback and by poll, that the param is copied, that the number of
+ * commands not completed is bounded and that the pending commands complete on deinit. Then it
+ * measures commands per second and the latency from send to completion of the blocking path, which
+ * waits for each command like rtk_bt_send_cmd, and of the asynchronous one with several commands
+ * outstanding, and the cost of a pending command lookup against the single list used before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "osif.h"
+#include "app_msg.h"
+#include "rtk_bt_common.h"
+#include "rtk_stack_internal.h"
+
+#define BENCH_STACK_SIZE		8192
+#define BENCH_GROUP				RTK_BT_LE_GP_GAP
+#define BENCH_ACT_NOW			1		/* completed by the BT API task */
+#define BENCH_ACT_LATER			2		/* completed by an answer of the lower stack */
+#define BENCH_ACT_UNKNOWN		3
+#define BENCH_MSG_TYPE(seq)		((uint32_t)(0x100 | ((seq) & 0xFF)))
+#define BENCH_MAGIC(seq)		((uint32_t)(seq) * 2654435761u)
+#define BENCH_CMDS				50000
+#define BENCH_HOLD_MAX			64
+#define BENCH_LAT_MAX			BENCH_CMDS
+
+/* subtypes of IO_MSG_TYPE_API_SYS_CALL besides the command one */
+#define BENCH_MSG_CMD			0
+#define BENCH_MSG_RSP			1
+#define BENCH_MSG_DEINIT		2
+
+/* messages to the lower stack besides message types */
+#define BENCH_LOWER_RELEASE		0xFFFFFFFEu
+#define BENCH_LOWER_EXIT		0xFFFFFFFFu
+
+struct bench_msg {
+	uint16_t type;
+	uint16_t subtype;
+	void *buf;
+};
+
+struct bench_param {
+	uint32_t seq;
+	uint32_t magic;
+};
+
+static struct {
+	uint32_t cmd_num;
+	uint32_t orphan_num;		/* answers of the lower stack no command waits for */
+	uint32_t hold;				/* answers the lower stack holds before giving them back in reverse order */
+	uint8_t paused;				/* the lower stack holds its answers until released */
+} sim;
+
+static struct {
+	uint32_t done_num;
+	uint32_t bad_num;
+	uint64_t t_send[256];		/* by seq, more than the commands outstanding */
+	uint32_t lat_num;
+	uint32_t lat[BENCH_LAT_MAX];
+	uint8_t seen[BENCH_CMDS];
+} run;
+
+static rtos_queue_t api_q;
+static rtos_queue_t lower_q;
+static rtos_sema_t slot_sema;
+static rtos_sema_t deinit_done;
+static rtos_sema_t bench_done;
+static bool bt_enabled;
+static int bench_fail;
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+bool rtk_bt_is_enable(void)
+{
+	return bt_enabled;
+}
+
+uint16_t bt_stack_msg_send(uint16_t type, uint16_t subtype, void *msg)
+{
+	struct bench_msg m = { type, subtype, msg };
+
+	return rtos_queue_send(api_q, &m, 0) == RTK_SUCCESS ? RTK_BT_OK : RTK_BT_ERR_OS_OPERATION;
+}
+
+uint16_t bt_stack_api_send(void *pcmd)
+{
+	return bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_CMD, pcmd);
+}
+
+/* BT API task: what a group act handler does, with the async_handle path of the LE GAP acts */
+static void bench_act_handle(rtk_bt_cmd_t *p_cmd)
+{
+	struct bench_param *param = (struct bench_param *)p_cmd->param;
+	uint16_t ret = 0;
+
+	sim.cmd_num++;
+	if (p_cmd->group != BENCH_GROUP || p_cmd->param_len != sizeof(*param) ||
+		param->magic != BENCH_MAGIC(param->seq)) {
+		ret = RTK_BT_ERR_PARAM_INVALID;
+		goto end;
+	}
+
+	switch (p_cmd->act) {
+	case BENCH_ACT_NOW:
+		break;
+	case BENCH_ACT_LATER:
+		p_cmd->user_data = BENCH_MSG_TYPE(param->seq);
+		bt_stack_pending_cmd_insert(p_cmd);
+		ret = rtos_queue_send(lower_q, &p_cmd->user_data, 0) == RTK_SUCCESS ? 0 : RTK_BT_ERR_LOWER_STACK_API;
+		goto async_handle;
+	default:
+		ret = RTK_BT_ERR_NO_CASE_ELEMENT;
+		break;
+	}
+
+end:
+	p_cmd->ret = ret;
+	rtk_bt_cmd_complete(p_cmd);
+	return;
+
+async_handle:
+	if (ret) {
+		bt_stack_pending_cmd_delete(p_cmd);
+		p_cmd->ret = ret;
+		rtk_bt_cmd_complete(p_cmd);
+	}
+}
+
+/* BT API task: a lower stack message completes the command waiting for it */
+static void bench_lower_rsp(uint32_t msg_type)
+{
+	rtk_bt_cmd_t *p_cmd = bt_stack_pending_cmd_search(msg_type);
+	struct bench_param *param;
+
+	if (!p_cmd) {
+		sim.orphan_num++;
+		return;
+	}
+	param = (struct bench_param *)p_cmd->param;
+	bt_stack_pending_cmd_delete(p_cmd);
+	p_cmd->ret = BENCH_MSG_TYPE(param->seq) == msg_type ? 0 : RTK_BT_ERR_MISMATCH;
+	rtk_bt_cmd_complete(p_cmd);
+}
+
+static void bench_api_task(void *param)
+{
+	struct bench_msg m;
+
+	(void) param;
+	for (;;) {
+		rtos_queue_receive(api_q, &m, RTOS_MAX_DELAY);
+		if (m.subtype == RTK_BT_API_TASK_EXIT) {
+			break;
+		}
+		switch (m.subtype) {
+		case BENCH_MSG_RSP:
+			bench_lower_rsp((uint32_t)(uintptr_t)m.buf);
+			break;
+		case BENCH_MSG_DEINIT:
+			bt_stack_pending_cmd_deinit();
+			bt_stack_pending_cmd_init();
+			rtos_sema_give(deinit_done);
+			break;
+		default:
+			bench_act_handle((rtk_bt_cmd_t *)m.buf);
+			break;
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_lower_task(void *param)
+{
+	uint32_t held[BENCH_HOLD_MAX];
+	uint32_t n = 0, msg;
+
+	(void) param;
+	for (;;) {
+		rtos_queue_receive(lower_q, &msg, RTOS_MAX_DELAY);
+		if (msg == BENCH_LOWER_EXIT) {
+			break;
+		}
+		if (msg != BENCH_LOWER_RELEASE) {
+			held[n++] = msg;
+			while (n < BENCH_HOLD_MAX && (sim.paused || n < sim.hold) &&
+				   rtos_queue_receive(lower_q, &msg, 0) == RTK_SUCCESS) {
+				if (msg == BENCH_LOWER_RELEASE) {
+					break;
+				}
+				held[n++] = msg;
+			}
+			if (sim.paused && msg != BENCH_LOWER_RELEASE) {
+				continue;
+			}
+		}
+		while (n > 0) {
+			n--;
+			bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_RSP, (void *)(uintptr_t)held[n]);
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+/*------------------------------------------------------------------*/
+
+/* what rtk_bt_send_cmd does */
+static uint16_t bench_send_cmd(uint8_t act, void *param, uint32_t param_len)
+{
+	rtk_bt_cmd_t cmd = {0};
+	uint16_t ret;
+
+	cmd.group = BENCH_GROUP;
+	cmd.act = act;
+	cmd.param = param;
+	cmd.param_len = param_len;
+	if (!osif_sem_create(&cmd.psem, 0, 1)) {
+		return RTK_BT_ERR_OS_OPERATION;
+	}
+	ret = bt_stack_api_send(&cmd);
+	if (!ret) {
+		osif_sem_take(cmd.psem, BT_TIMEOUT_FOREVER);
+		ret = cmd.ret;
+	}
+	osif_sem_delete(cmd.psem);
+	return ret;
+}
+
+static void bench_param_set(struct bench_param *param, uint32_t seq)
+{
+	param->seq = seq;
+	param->magic = BENCH_MAGIC(seq);
+}
+
+static void bench_run_reset(void)
+{
+	memset(&run, 0, sizeof(run));
+}
+
+static void bench_done_record(uint32_t seq, uint16_t ret)
+{
+	uint64_t now = bench_wall_ns();
+
+	if (seq >= BENCH_CMDS || run.seen[seq] || ret != RTK_BT_OK) {
+		run.bad_num++;
+	} else {
+		run.seen[seq] = 1;
+	}
+	if (run.lat_num < BENCH_LAT_MAX) {
+		run.lat[run.lat_num++] = (uint32_t)(now - run.t_send[seq & 0xFF]);
+	}
+	__atomic_fetch_add(&run.done_num, 1, __ATOMIC_RELEASE);
+}
+
+static void bench_cb(uint32_t ticket, uint16_t ret, void *user_data)
+{
+	(void) ticket;
+	bench_done_record((uint32_t)(uintptr_t)user_data, ret);
+	rtos_sema_give(slot_sema);
+}
+
+static void bench_wait_done(uint32_t num)
+{
+	while (__atomic_load_n(&run.done_num, __ATOMIC_ACQUIRE) < num) {
+		rtos_task_yield();
+	}
+}
+
+/*------------------------------------------------------------------*/
+
+static void bench_verify_async(void)
+{
+	struct bench_param param;
+	rtk_bt_cmd_async_result_t result;
+	uint32_t ticket[BT_API_ASYNC_CMD_NUM + 1];
+	uint32_t i, n;
+	uint16_t ret;
+
+	/* by poll, in completion order, param copied */
+	bench_run_reset();
+	sim.hold = 4;
+	for (i = 0; i < 8; i++) {
+		bench_param_set(&param, i);
+		ret = rtk_bt_send_cmd_async(BENCH_GROUP, i & 1 ? BENCH_ACT_LATER : BENCH_ACT_NOW, &param, sizeof(param),
+									NULL, (void *)(uintptr_t)(100 + i), &ticket[i]);
+		bench_check(ret == RTK_BT_OK && ticket[i] != 0, "async send");
+		memset(&param, 0xA5, sizeof(param));
+	}
+	for (i = 0; i < 8; i++) {
+		ret = rtk_bt_cmd_async_poll(&result, 1000);
+		bench_check(ret == RTK_BT_OK, "async poll");
+		n = (uint32_t)(uintptr_t)result.user_data - 100;
+		bench_check(n < 8 && !run.seen[n] && result.ticket == ticket[n] && result.ret == RTK_BT_OK &&
+					result.group == BENCH_GROUP && result.act == (n & 1 ? BENCH_ACT_LATER : BENCH_ACT_NOW),
+					"async poll result");
+		if (n < 8) {
+			run.seen[n] = 1;
+		}
+	}
+	bench_check(rtk_bt_cmd_async_poll(&result, BT_TIMEOUT_NONE) == RTK_BT_ERR_SYNC_TIMEOUT, "async poll empty");
+
+	/* errors of the stack are the result */
+	bench_param_set(&param, 1);
+	bench_check(rtk_bt_send_cmd_async(BENCH_GROUP, BENCH_ACT_UNKNOWN, &param, sizeof(param), NULL, NULL, NULL) == RTK_BT_OK &&
+				rtk_bt_cmd_async_poll(&result, 1000) == RTK_BT_OK && result.ret == RTK_BT_ERR_NO_CASE_ELEMENT,
+				"async unknown act result");
+	bench_check(rtk_bt_send_cmd_async(BENCH_GROUP, BENCH_ACT_NOW, NULL, 4, NULL, NULL, NULL) == RTK_BT_ERR_POINTER_INVALID,
+				"async NULL param refused");
+
+	/* bounded while the lower stack does not answer, results not polled keep their place */
+	sim.paused = 1;
+	for (i = 0; i < BT_API_ASYNC_CMD_NUM; i++) {
+		bench_param_set(&param, i);
+		ret = rtk_bt_send_cmd_async(BENCH_GROUP, BENCH_ACT_LATER, &param, sizeof(param), NULL, NULL, &ticket[i]);
+		bench_check(ret == RTK_BT_OK, "async send up to the limit");
+	}
+	bench_param_set(&param, i);
+	bench_check(rtk_bt_send_cmd_async(BENCH_GROUP, BENCH_ACT_NOW, &param, sizeof(param), NULL, NULL, NULL) ==
+				RTK_BT_ERR_QUEUE_FULL, "async send over the limit");
+	while (bt_stack_pending_cmd_num() < BT_API_ASYNC_CMD_NUM) {
+		rtos_task_yield();
+	}
+	sim.paused = 0;
+	n = BENCH_LOWER_RELEASE;
+	rtos_queue_send(lower_q, &n, RTOS_MAX_DELAY);
+	for (i = 0; i < BT_API_ASYNC_CMD_NUM; i++) {
+		bench_check(rtk_bt_cmd_async_poll(&result, 1000) == RTK_BT_OK && result.ret == RTK_BT_OK, "async limit results");
+	}
+	bench_check(bt_stack_pending_cmd_num() == 0, "no pending command left");
+
+	/* deinit completes the pending commands, the late answers find nothing */
+	sim.paused = 1;
+	sim.orphan_num = 0;
+	for (i = 0; i < 4; i++) {
+		bench_param_set(&param, i);
+		rtk_bt_send_cmd_async(BENCH_GROUP, BENCH_ACT_LATER, &param, sizeof(param), NULL, NULL, NULL);
+	}
+	while (bt_stack_pending_cmd_num() < 4) {
+		rtos_task_yield();
+	}
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_DEINIT, NULL);
+	rtos_sema_take(deinit_done, RTOS_MAX_DELAY);
+	for (i = 0; i < 4; i++) {
+		bench_check(rtk_bt_cmd_async_poll(&result, 1000) == RTK_BT_OK && result.ret == RTK_BT_ERR_UNHANDLED,
+					"deinit completes pending commands");
+	}
+	sim.paused = 0;
+	n = BENCH_LOWER_RELEASE;
+	rtos_queue_send(lower_q, &n, RTOS_MAX_DELAY);
+	while (__atomic_load_n(&sim.orphan_num, __ATOMIC_ACQUIRE) < 4) {
+		rtos_task_yield();
+	}
+
+	/* blocking and asynchronous commands mixed */
+	bench_run_reset();
+	rtos_sema_create(&slot_sema, 0, BT_API_ASYNC_CMD_NUM);
+	for (i = 0; i < 64; i++) {
+		bench_param_set(&param, i);
+		if (i % 3 == 0) {
+			bench_check(bench_send_cmd(i & 1 ? BENCH_ACT_LATER : BENCH_ACT_NOW, &param, sizeof(param)) == RTK_BT_OK,
+						"blocking command among asynchronous ones");
+			run.seen[i] = 1;
+			__atomic_fetch_add(&run.done_num, 1, __ATOMIC_RELEASE);
+		} else {
+			bench_check(rtk_bt_send_cmd_async(BENCH_GROUP, i & 1 ? BENCH_ACT_LATER : BENCH_ACT_NOW, &param, sizeof(param),
+											  bench_cb, (void *)(uintptr_t)i, NULL) == RTK_BT_OK, "async send with callback");
+			rtos_sema_take(slot_sema, 0);
+		}
+	}
+	bench_wait_done(64);
+	bench_check(run.bad_num == 0, "callbacks once each with their result");
+	rtos_sema_delete(slot_sema);
+
+	/* after disable */
+	bt_enabled = false;
+	bench_check(rtk_bt_send_cmd_async(BENCH_GROUP, BENCH_ACT_NOW, &param, sizeof(param), NULL, NULL, NULL) ==
+				RTK_BT_ERR_NOT_READY, "async send when disabled");
+	bt_enabled = true;
+	sim.hold = 0;
+}
+
+/*------------------------------------------------------------------*/
+
+static int bench_u32_cmp(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void bench_report(const char *mode, uint8_t act, uint32_t window, uint64_t ns)
+{
+	uint64_t sum = 0;
+	uint32_t i;
+
+	qsort(run.lat, run.lat_num, sizeof(run.lat[0]), bench_u32_cmp);
+	for (i = 0; i < run.lat_num; i++) {
+		sum += run.lat[i];
+	}
+	printf("%-10s %-7s %7u %10.0f %9.1f %9.1f %9.1f\n", mode, act == BENCH_ACT_NOW ? "task" : "lower",
+		   (unsigned)window, BENCH_CMDS * 1e9 / ns, run.lat_num ? sum / 1000.0 / run.lat_num : 0.0,
+		   run.lat_num ? run.lat[run.lat_num / 2] / 1000.0 : 0.0,
+		   run.lat_num ? run.lat[run.lat_num * 99 / 100] / 1000.0 : 0.0);
+	bench_check(run.bad_num == 0 && run.done_num == BENCH_CMDS, "every command completed once");
+}
+
+static void bench_blocking(uint8_t act)
+{
+	struct bench_param param;
+	uint64_t t0;
+	uint32_t i;
+	uint16_t ret;
+
+	bench_run_reset();
+	t0 = bench_wall_ns();
+	for (i = 0; i < BENCH_CMDS; i++) {
+		bench_param_set(&param, i);
+		run.t_send[i & 0xFF] = bench_wall_ns();
+		ret = bench_send_cmd(act, &param, sizeof(param));
+		bench_done_record(i, ret);
+	}
+	bench_report("blocking", act, 1, bench_wall_ns() - t0);
+}
+
+static void bench_async_cb(uint8_t act, uint32_t window)
+{
+	struct bench_param param;
+	uint64_t t0;
+	uint32_t i;
+
+	bench_run_reset();
+	rtos_sema_create(&slot_sema, window, window);
+	sim.hold = act == BENCH_ACT_LATER ? window : 0;
+	t0 = bench_wall_ns();
+	for (i = 0; i < BENCH_CMDS; i++) {
+		rtos_sema_take(slot_sema, RTOS_MAX_DELAY);
+		bench_param_set(&param, i);
+		run.t_send[i & 0xFF] = bench_wall_ns();
+		if (rtk_bt_send_cmd_async(BENCH_GROUP, act, &param, sizeof(param), bench_cb, (void *)(uintptr_t)i, NULL)) {
+			run.bad_num++;
+			rtos_sema_give(slot_sema);
+		}
+	}
+	bench_wait_done(BENCH_CMDS);
+	bench_report("callback", act, window, bench_wall_ns() - t0);
+	rtos_sema_delete(slot_sema);
+	sim.hold = 0;
+}
+
+static void bench_async_poll(uint8_t act, uint32_t window)
+{
+	struct bench_param param;
+	rtk_bt_cmd_async_result_t result;
+	uint32_t sent = 0, i;
+	uint64_t t0;
+
+	bench_run_reset();
+	sim.hold = act == BENCH_ACT_LATER ? window : 0;
+	t0 = bench_wall_ns();
+	for (i = 0; i < BENCH_CMDS; i++) {
+		while (sent < BENCH_CMDS && sent - i < window) {
+			bench_param_set(&param, sent);
+			run.t_send[sent & 0xFF] = bench_wall_ns();
+			if (rtk_bt_send_cmd_async(BENCH_GROUP, act, &param, sizeof(param), NULL, (void *)(uintptr_t)sent, NULL)) {
+				run.bad_num++;
+			}
+			sent++;
+		}
+		if (rtk_bt_cmd_async_poll(&result, 1000)) {
+			run.bad_num++;
+			break;
+		}
+		bench_done_record((uint32_t)(uintptr_t)result.user_data, result.ret);
+	}
+	bench_report("poll", act, window, bench_wall_ns() - t0);
+	sim.hold = 0;
+}
+
+static void bench_throughput(void)
+{
+	static const uint32_t windows[] = { 1, 4, BT_API_ASYNC_CMD_NUM };
+	static const uint8_t acts[] = { BENCH_ACT_NOW, BENCH_ACT_LATER };
+	unsigned a, w;
+
+	printf("%-10s %-7s %7s %10s %9s %9s %9s\n", "mode", "done by", "window", "cmd/s", "avg us", "p50 us", "p99 us");
+	for (a = 0; a < sizeof(acts) / sizeof(acts[0]); a++) {
+		bench_blocking(acts[a]);
+		for (w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+			bench_async_cb(acts[a], windows[w]);
+		}
+		for (w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+			bench_async_poll(acts[a], windows[w]);
+		}
+	}
+}
+
+/*------------------------------------------------------------------*/
+
+/* the pending command list before, one list searched and deleted from by walking it */
+static struct list_head legacy_pending_list;
+
+static rtk_bt_cmd_t *legacy_pending_search(uint32_t msg_type)
+{
+	rtk_bt_cmd_t *cmd;
+
+	list_for_each_entry(cmd, &legacy_pending_list, list, rtk_bt_cmd_t) {
+		if (cmd->user_data == msg_type) {
+			return cmd;
+		}
+	}
+	return NULL;
+}
+
+static void legacy_pending_delete(rtk_bt_cmd_t *p_cmd)
+{
+	rtk_bt_cmd_t *cmd, *next;
+
+	list_for_each_entry_safe(cmd, next, &legacy_pending_list, list, rtk_bt_cmd_t) {
+		if (p_cmd == cmd) {
+			list_del(&p_cmd->list);
+		}
+	}
+}
+
+static void bench_pending_lookup(void)
+{
+	static const uint32_t nums[] = { 4, 16, 64, 256 };
+	static rtk_bt_cmd_t cmds[256];
+	const uint32_t rounds = 2000000;
+	uint32_t rnd = 1, i, r, n;
+	double legacy_ns, table_ns;
+	uint64_t t0;
+
+	printf("%-8s %14s %14s\n", "pending", "list ns/match", "table ns/match");
+	for (n = 0; n < sizeof(nums) / sizeof(nums[0]); n++) {
+		/* a command answered, then another one of the same message type sent */
+		memset(cmds, 0, sizeof(cmds));
+		INIT_LIST_HEAD(&legacy_pending_list);
+		for (i = 0; i < nums[n]; i++) {
+			cmds[i].user_data = BENCH_MSG_TYPE(i);
+			list_add_tail(&cmds[i].list, &legacy_pending_list);
+		}
+		t0 = bench_wall_ns();
+		for (r = 0; r < rounds; r++) {
+			rtk_bt_cmd_t *p_cmd;
+
+			rnd = rnd * 1103515245u + 12345u;
+			i = (rnd >> 16) % nums[n];
+			p_cmd = legacy_pending_search(BENCH_MSG_TYPE(i));
+			bench_check(p_cmd == &cmds[i], "list lookup");
+			legacy_pending_delete(p_cmd);
+			list_add_tail(&p_cmd->list, &legacy_pending_list);
+		}
+		legacy_ns = (double)(bench_wall_ns() - t0) / rounds;
+
+		memset(cmds, 0, sizeof(cmds));
+		for (i = 0; i < nums[n]; i++) {
+			cmds[i].user_data = BENCH_MSG_TYPE(i);
+			bt_stack_pending_cmd_insert(&cmds[i]);
+		}
+		t0 = bench_wall_ns();
+		for (r = 0; r < rounds; r++) {
+			rtk_bt_cmd_t *p_cmd;
+
+			rnd = rnd * 1103515245u + 12345u;
+			i = (rnd >> 16) % nums[n];
+			p_cmd = bt_stack_pending_cmd_search(BENCH_MSG_TYPE(i));
+			bench_check(p_cmd == &cmds[i], "table lookup");
+			bt_stack_pending_cmd_delete(p_cmd);
+			bt_stack_pending_cmd_insert(p_cmd);
+		}
+		table_ns = (double)(bench_wall_ns() - t0) / rounds;
+		for (i = 0; i < nums[n]; i++) {
+			bt_stack_pending_cmd_delete(&cmds[i]);
+		}
+		bench_check(bt_stack_pending_cmd_num() == 0, "table empty");
+		printf("%-8u %14.1f %14.1f\n", (unsigned)nums[n], legacy_ns, table_ns);
+	}
+}
+
+static void bench_main(void *param)
+{
+	uint32_t stop = BENCH_LOWER_EXIT;
+
+	(void) param;
+	rtos_queue_create(&api_q, 64, sizeof(struct bench_msg));
+	rtos_queue_create(&lower_q, 64, sizeof(uint32_t));
+	rtos_sema_create_binary(&deinit_done);
+	rtos_task_create(NULL, "bt_api", bench_api_task, NULL, BENCH_STACK_SIZE, 5);
+	rtos_task_create(NULL, "lower", bench_lower_task, NULL, BENCH_STACK_SIZE, 5);
+	bt_stack_pending_cmd_init();
+	bench_check(bt_api_async_init() == RTK_BT_OK, "async init");
+	bt_enabled = true;
+
+	bench_verify_async();
+	bench_throughput();
+
+	/* the BT API task is stopped, the pending table is only used by the bench now */
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, RTK_BT_API_TASK_EXIT, NULL);
+	rtos_queue_send(lower_q, &stop, RTOS_MAX_DELAY);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	bench_pending_lookup();
+
+	bt_enabled = false;
+	bt_api_async_deinit();
+	bench_check(bt_api_async_send_num() == 0, "no send in progress");
+	rtos_sema_delete(deinit_done);
+	rtos_sched_stop();
+	rtos_task_delete(NULL);
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	rtos_sema_create(&bench_done, 0, 2);
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * bt_audio codec wrapper with a pass through codec entity which manages its buffers like the lc3
+ * entity: a buffer descriptor per get, the pcm or encoded data allocated by the codec call and both
+ * freed by the free call. Checks the batch calls against the one frame calls, the handed out buffer
+ * ring and an unregister while another task still holds buffers, then times the decode flow of
+ * bt_audio_intf.c and the encode flow of rtk_bt_audio_data_encode against the batch calls.
+ * Lock operations are counted by wrapping osif_mutex_take at link time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "osif.h"
+#include "rtk_bt_common.h"
+#include "bt_audio_codec_wrapper.h"
+
+#define BENCH_STACK_SIZE		8192
+#define BENCH_CODEC_TYPE		0x80
+#define BENCH_FRAME_LEN			120		/* LC3 10 ms frame at 96 kbit/s */
+#define BENCH_PCM_LEN			(BENCH_FRAME_LEN * 2)
+#define BENCH_FRAME_MAX			16
+#define BENCH_FRAMES			400000
+#define BENCH_HOLD_NUM			64
+
+static uint32_t lock_num;
+static uint32_t live_num;
+static int bench_fail;
+static rtos_sema_t bench_done;
+static rtos_queue_t hold_q;
+static uint32_t hold_freed;
+
+bool __real_osif_mutex_take(void *p_handle, uint32_t wait_ms);
+
+bool __wrap_osif_mutex_take(void *p_handle, uint32_t wait_ms)
+{
+	__atomic_add_fetch(&lock_num, 1, __ATOMIC_RELAXED);
+	return __real_osif_mutex_take(p_handle, wait_ms);
+}
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static void *bench_alloc(size_t size)
+{
+	__atomic_add_fetch(&live_num, 1, __ATOMIC_RELAXED);
+	return osif_mem_alloc(RAM_TYPE_DATA_ON, size);
+}
+
+static void bench_free(void *p)
+{
+	if (p) {
+		__atomic_sub_fetch(&live_num, 1, __ATOMIC_RELAXED);
+		osif_mem_free(p);
+	}
+}
+
+/* pass through entity: a frame of bytes decodes to one sample per byte */
+static uint16_t pt_init(void *pentity, void *param)
+{
+	return RTK_BT_AUDIO_OK;
+}
+
+static uint16_t pt_deinit(void *pentity)
+{
+	return RTK_BT_AUDIO_OK;
+}
+
+static uint16_t pt_handle_media_data_packet(void *pentity, uint8_t *packet, uint16_t size, uint32_t *pframe_size, uint8_t *pframe_num,
+											uint8_t *pcodec_header_flag, struct audio_param *paudio_param)
+{
+	*pframe_size = BENCH_FRAME_LEN;
+	*pframe_num = (uint8_t)(size / BENCH_FRAME_LEN);
+	*pcodec_header_flag = 0;
+	paudio_param->channels = 1;
+	paudio_param->channel_allocation = 1;
+	paudio_param->rate = 48000;
+	paudio_param->bits = 16;
+
+	return RTK_BT_AUDIO_OK;
+}
+
+static uint16_t pt_decode(void *pentity, uint8_t *data, uint32_t size, struct dec_codec_buffer *pdecoder_buffer, uint32_t *ppcm_size,
+						  struct audio_param *paudio_param)
+{
+	int16_t *pcm;
+
+	if (size != BENCH_FRAME_LEN) {
+		return RTK_BT_AUDIO_FAIL;
+	}
+	pcm = (int16_t *)bench_alloc(BENCH_PCM_LEN);
+	if (!pcm) {
+		return RTK_BT_AUDIO_FAIL;
+	}
+	for (uint32_t i = 0; i < size; i++) {
+		pcm[i] = data ? (int16_t)((data[i] - 128) << 8) : 0;
+	}
+	pdecoder_buffer->pbuffer = pcm;
+	pdecoder_buffer->total_size = BENCH_PCM_LEN;
+	pdecoder_buffer->actual_write_size = BENCH_PCM_LEN;
+	*ppcm_size = BENCH_PCM_LEN;
+
+	return RTK_BT_AUDIO_OK;
+}
+
+static uint16_t pt_encode(void *pentity, int16_t *data, uint32_t size, struct enc_codec_buffer *pencoder_buffer, uint8_t *p_frame_num,
+						  uint32_t *p_actual_len)
+{
+	uint8_t *out;
+
+	if (size != BENCH_PCM_LEN) {
+		return RTK_BT_AUDIO_FAIL;
+	}
+	out = (uint8_t *)bench_alloc(BENCH_FRAME_LEN);
+	if (!out) {
+		return RTK_BT_AUDIO_FAIL;
+	}
+	for (uint32_t i = 0; i < BENCH_FRAME_LEN; i++) {
+		out[i] = (uint8_t)((data[i] >> 8) + 128);
+	}
+	pencoder_buffer->pbuffer = out;
+	pencoder_buffer->frame_num = 1;
+	pencoder_buffer->frame_size = BENCH_FRAME_LEN;
+	*p_frame_num = 1;
+	*p_actual_len = BENCH_FRAME_LEN;
+
+	return RTK_BT_AUDIO_OK;
+}
+
+static struct dec_codec_buffer *pt_get_decode_buffer(void *pentity)
+{
+	struct dec_codec_buffer *pbuffer = (struct dec_codec_buffer *)bench_alloc(sizeof(*pbuffer));
+
+	if (pbuffer) {
+		memset(pbuffer, 0, sizeof(*pbuffer));
+	}
+	return pbuffer;
+}
+
+static void pt_free_decode_buffer(void *pentity, struct dec_codec_buffer *buffer)
+{
+	bench_free(buffer->pbuffer);
+	bench_free(buffer);
+}
+
+static struct enc_codec_buffer *pt_get_encode_buffer(void *pentity)
+{
+	struct enc_codec_buffer *pbuffer = (struct enc_codec_buffer *)bench_alloc(sizeof(*pbuffer));
+
+	if (pbuffer) {
+		memset(pbuffer, 0, sizeof(*pbuffer));
+	}
+	return pbuffer;
+}
+
+static void pt_free_encode_buffer(void *pentity, struct enc_codec_buffer *buffer)
+{
+	bench_free(buffer->pbuffer);
+	bench_free(buffer);
+}
+
+static void pt_register(PAUDIO_CODEC_ENTITY pentity)
+{
+	memset(pentity, 0, sizeof(*pentity));
+	pentity->type = BENCH_CODEC_TYPE;
+	pentity->init = pt_init;
+	pentity->deinit = pt_deinit;
+	pentity->bt_audio_handle_media_data_packet = pt_handle_media_data_packet;
+	pentity->decoding_func = pt_decode;
+	pentity->encoding_func = pt_encode;
+	pentity->get_decode_buffer = pt_get_decode_buffer;
+	pentity->free_decode_buffer = pt_free_decode_buffer;
+	pentity->get_encode_buffer = pt_get_encode_buffer;
+	pentity->free_encode_buffer = pt_free_encode_buffer;
+	/* what bt_audio_register_codec does for a known codec type */
+	pentity->init(pentity, NULL);
+	osif_mutex_create(&pentity->mutex);
+	pentity->active_flag = 1;
+}
+
+static void bench_fill(uint8_t *data, uint32_t len, uint32_t seed)
+{
+	for (uint32_t i = 0; i < len; i++) {
+		seed = seed * 1103515245u + 12345u;
+		data[i] = (uint8_t)(seed >> 16);
+	}
+}
+
+/* the decode loop of bt_audio_parsing_recv_stream, the pcm written to the track is copied to pcm */
+static uint32_t bench_decode_frame_by_frame(PAUDIO_CODEC_ENTITY pentity, uint8_t *packet, uint16_t size, int16_t *pcm)
+{
+	struct dec_codec_buffer *pbuffer;
+	struct audio_param param;
+	uint32_t frame_size, pcm_size, offset = 0;
+	uint8_t frame_num, header;
+
+	if (bt_audio_handle_media_data_packet(pentity, packet, size, &frame_size, &frame_num, &header, &param)) {
+		return 0;
+	}
+	for (uint8_t i = 0; i < frame_num; i++) {
+		pbuffer = bt_audio_get_decode_buffer(pentity);
+		if (!pbuffer) {
+			continue;
+		}
+		if (bt_audio_decode_process_data(pentity, pbuffer, &packet[i * frame_size + header], frame_size, &pcm_size, &param) == RTK_BT_AUDIO_OK) {
+			memcpy((uint8_t *)pcm + offset, pbuffer->pbuffer, pcm_size);
+			offset += pcm_size;
+		}
+		bt_audio_free_decode_buffer(pentity, pbuffer);
+	}
+
+	return offset;
+}
+
+static uint32_t bench_decode_batch(PAUDIO_CODEC_ENTITY pentity, uint8_t *packet, uint16_t size, int16_t *pcm, uint32_t pcm_size)
+{
+	uint32_t pcm_frame_size[BENCH_FRAME_MAX];
+	struct audio_param param;
+	uint32_t frame_size, offset = 0;
+	uint8_t frame_num, header;
+
+	if (bt_audio_handle_media_data_packet(pentity, packet, size, &frame_size, &frame_num, &header, &param)) {
+		return 0;
+	}
+	bt_audio_decode_process_frames(pentity, &packet[header], frame_size, frame_num, pcm, pcm_size, pcm_frame_size, &param);
+	for (uint8_t i = 0; i < frame_num; i++) {
+		offset += pcm_frame_size[i];
+	}
+
+	return offset;
+}
+
+/* rtk_bt_audio_data_encode and rtk_bt_audio_free_encode_buffer for each frame */
+static uint32_t bench_encode_frame_by_frame(PAUDIO_CODEC_ENTITY pentity, int16_t *pcm, uint8_t frame_num, uint8_t *out)
+{
+	struct enc_codec_buffer *pbuffer;
+	uint32_t actual_len, offset = 0;
+	uint8_t encoded_num;
+
+	for (uint8_t i = 0; i < frame_num; i++) {
+		pbuffer = bt_audio_get_encode_buffer(pentity);
+		if (!pbuffer) {
+			continue;
+		}
+		if (bt_audio_encode_process_data(pentity, pbuffer, pcm + i * BENCH_PCM_LEN / 2, BENCH_PCM_LEN, &encoded_num, &actual_len) == RTK_BT_AUDIO_OK) {
+			memcpy(out + offset, pbuffer->pbuffer, actual_len);
+			offset += actual_len;
+		}
+		bt_audio_free_encode_buffer(pentity, pbuffer);
+	}
+
+	return offset;
+}
+
+static uint32_t bench_encode_batch(PAUDIO_CODEC_ENTITY pentity, int16_t *pcm, uint8_t frame_num, uint8_t *out, uint32_t out_size)
+{
+	uint32_t out_frame_size[BENCH_FRAME_MAX];
+	uint32_t offset = 0;
+
+	bt_audio_encode_process_frames(pentity, pcm, BENCH_PCM_LEN, frame_num, out, out_size, out_frame_size);
+	for (uint8_t i = 0; i < frame_num; i++) {
+		offset += out_frame_size[i];
+	}
+
+	return offset;
+}
+
+static void bench_verify(PAUDIO_CODEC_ENTITY pentity)
+{
+	static uint8_t packet[BENCH_FRAME_LEN * BENCH_FRAME_MAX];
+	static int16_t pcm_a[BENCH_PCM_LEN * BENCH_FRAME_MAX / 2], pcm_b[BENCH_PCM_LEN * BENCH_FRAME_MAX / 2];
+	static uint8_t out_a[BENCH_FRAME_LEN * BENCH_FRAME_MAX], out_b[BENCH_FRAME_LEN * BENCH_FRAME_MAX];
+	struct dec_codec_buffer *dec[BT_AUDIO_CODEC_RING_SLOT_NUM + 1];
+	struct enc_codec_buffer *enc;
+	uint32_t pcm_frame_size[BENCH_FRAME_MAX];
+	struct audio_param param;
+	uint32_t len_a, len_b;
+
+	bench_fill(packet, sizeof(packet), 1);
+	len_a = bench_decode_frame_by_frame(pentity, packet, sizeof(packet), pcm_a);
+	len_b = bench_decode_batch(pentity, packet, sizeof(packet), pcm_b, sizeof(pcm_b));
+	bench_check(len_a == sizeof(pcm_a) && len_b == len_a && !memcmp(pcm_a, pcm_b, len_a), "batch decode equals frame by frame decode");
+
+	len_a = bench_encode_frame_by_frame(pentity, pcm_a, BENCH_FRAME_MAX, out_a);
+	len_b = bench_encode_batch(pentity, pcm_a, BENCH_FRAME_MAX, out_b, sizeof(out_b));
+	bench_check(len_a == sizeof(out_a) && len_b == len_a && !memcmp(out_a, out_b, len_a), "batch encode equals frame by frame encode");
+	bench_check(!memcmp(out_a, packet, sizeof(packet)), "pass through round trip");
+
+	/* a pcm span for two and a half frames: the frames which do not fit are reported with size 0 */
+	memset(pcm_b, 0, sizeof(pcm_b));
+	bench_check(bt_audio_decode_process_frames(pentity, packet, BENCH_FRAME_LEN, 4, pcm_b, BENCH_PCM_LEN * 5 / 2, pcm_frame_size, &param) != RTK_BT_AUDIO_OK,
+				"short pcm span fails");
+	bench_check(pcm_frame_size[0] == BENCH_PCM_LEN && pcm_frame_size[1] == BENCH_PCM_LEN && pcm_frame_size[2] == 0 && pcm_frame_size[3] == 0 &&
+				!memcmp(pcm_a, pcm_b, BENCH_PCM_LEN * 2), "short pcm span keeps the frames which fit");
+
+	/* the ring holds BT_AUDIO_CODEC_RING_SLOT_NUM buffers, freed in any order */
+	for (int i = 0; i <= BT_AUDIO_CODEC_RING_SLOT_NUM; i++) {
+		dec[i] = bt_audio_get_decode_buffer(pentity);
+	}
+	bench_check(dec[BT_AUDIO_CODEC_RING_SLOT_NUM] == NULL, "ring full refuses a buffer");
+	bench_check(bt_audio_free_decode_buffer(pentity, dec[3]) == RTK_BT_AUDIO_OK, "free out of order");
+	bench_check(bt_audio_free_decode_buffer(pentity, dec[3]) != RTK_BT_AUDIO_OK, "double free refused");
+	dec[3] = bt_audio_get_decode_buffer(pentity);
+	bench_check(dec[3] != NULL, "slot reused");
+	for (int i = BT_AUDIO_CODEC_RING_SLOT_NUM - 1; i >= 0; i--) {
+		bench_check(bt_audio_free_decode_buffer(pentity, dec[i]) == RTK_BT_AUDIO_OK, "free in reverse order");
+	}
+	enc = bt_audio_get_encode_buffer(pentity);
+	bench_check(enc != NULL && bt_audio_free_encode_buffer(pentity, enc) == RTK_BT_AUDIO_OK, "encode buffer handed out");
+	bench_check(live_num == 0, "entity buffers returned");
+	printf("verify %s\n", bench_fail ? "failed" : "ok");
+}
+
+/* frees the decode buffers handed over by the bench task, slowly */
+static void bench_hold_task(void *param)
+{
+	struct dec_codec_buffer *pbuffer;
+	PAUDIO_CODEC_ENTITY pentity = (PAUDIO_CODEC_ENTITY)param;
+
+	while (rtos_queue_receive(hold_q, &pbuffer, RTOS_MAX_DELAY) == RTK_SUCCESS && pbuffer) {
+		rtos_time_delay_ms(1);
+		if (bt_audio_free_decode_buffer(pentity, pbuffer) == RTK_BT_AUDIO_OK) {
+			__atomic_add_fetch(&hold_freed, 1, __ATOMIC_RELEASE);
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+/* unregister waits for the buffers another task still holds */
+static void bench_unregister(void)
+{
+	AUDIO_CODEC_ENTITY entity;
+	struct dec_codec_buffer *pbuffer = NULL;
+	uint32_t got = 0;
+
+	pt_register(&entity);
+	rtos_queue_create(&hold_q, BENCH_HOLD_NUM, sizeof(pbuffer));
+	rtos_task_create(NULL, "hold", bench_hold_task, &entity, BENCH_STACK_SIZE, 4);
+	while (got < BENCH_HOLD_NUM) {
+		/* keep the ring full without being refused */
+		if (got - __atomic_load_n(&hold_freed, __ATOMIC_ACQUIRE) >= BT_AUDIO_CODEC_RING_SLOT_NUM) {
+			rtos_time_delay_ms(1);
+			continue;
+		}
+		pbuffer = bt_audio_get_decode_buffer(&entity);
+		bench_check(pbuffer != NULL, "buffer for the holding task");
+		if (!pbuffer) {
+			break;
+		}
+		got++;
+		rtos_queue_send(hold_q, &pbuffer, RTOS_MAX_DELAY);
+	}
+	bt_audio_unregister_codec(BENCH_CODEC_TYPE, &entity);
+	bench_check(__atomic_load_n(&hold_freed, __ATOMIC_ACQUIRE) == got, "unregister waits for held buffers");
+	pbuffer = NULL;
+	rtos_queue_send(hold_q, &pbuffer, RTOS_MAX_DELAY);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	rtos_queue_delete(hold_q);
+	bench_check(live_num == 0, "held buffers returned");
+	printf("unregister with %u buffers handed to another task %s\n", (unsigned)got, bench_fail ? "failed" : "ok");
+}
+
+static void bench_run(PAUDIO_CODEC_ENTITY pentity, uint8_t frame_num)
+{
+	static uint8_t packet[BENCH_FRAME_LEN * BENCH_FRAME_MAX], out[BENCH_FRAME_LEN * BENCH_FRAME_MAX];
+	static int16_t pcm[BENCH_PCM_LEN * BENCH_FRAME_MAX / 2];
+	uint16_t size = (uint16_t)(BENCH_FRAME_LEN * frame_num);
+	uint32_t rounds = BENCH_FRAMES / frame_num;
+	uint32_t locks, sum = 0;
+	uint64_t wall;
+
+	bench_fill(packet, size, frame_num);
+
+	locks = lock_num;
+	wall = bench_wall_ns();
+	for (uint32_t r = 0; r < rounds; r++) {
+		sum += bench_decode_frame_by_frame(pentity, packet, size, pcm);
+	}
+	wall = bench_wall_ns() - wall;
+	printf("%2u frames/packet %-16s %8.1f ns/frame %5.2f locks/frame\n", (unsigned)frame_num, "decode frame", (double)wall / (rounds * frame_num),
+		   (double)(lock_num - locks) / (rounds * frame_num));
+
+	locks = lock_num;
+	wall = bench_wall_ns();
+	for (uint32_t r = 0; r < rounds; r++) {
+		sum -= bench_decode_batch(pentity, packet, size, pcm, sizeof(pcm));
+	}
+	wall = bench_wall_ns() - wall;
+	printf("%2u frames/packet %-16s %8.1f ns/frame %5.2f locks/frame\n", (unsigned)frame_num, "decode batch", (double)wall / (rounds * frame_num),
+		   (double)(lock_num - locks) / (rounds * frame_num));
+
+	locks = lock_num;
+	wall = bench_wall_ns();
+	for (uint32_t r = 0; r < rounds; r++) {
+		sum += bench_encode_frame_by_frame(pentity, pcm, frame_num, out);
+	}
+	wall = bench_wall_ns() - wall;
+	printf("%2u frames/packet %-16s %8.1f ns/frame %5.2f locks/frame\n", (unsigned)frame_num, "encode frame", (double)wall / (rounds * frame_num),
+		   (double)(lock_num - locks) / (rounds * frame_num));
+
+	locks = lock_num;
+	wall = bench_wall_ns();
+	for (uint32_t r = 0; r < rounds; r++) {
+		sum -= bench_encode_batch(pentity, pcm, frame_num, out, sizeof(out));
+	}
+	wall = bench_wall_ns() - wall;
+	printf("%2u frames/packet %-16s %8.1f ns/frame %5.2f locks/frame\n", (unsigned)frame_num, "encode batch", (double)wall / (rounds * frame_num),
+		   (double)(lock_num - locks) / (rounds * frame_num));
+
+	bench_check(sum == 0, "same pcm and encoded lengths");
+}
+
+static void bench_main(void *param)
+{
+	AUDIO_CODEC_ENTITY entity;
+
+	(void) param;
+	pt_register(&entity);
+	bench_verify(&entity);
+	bench_run(&entity, 1);
+	bench_run(&entity, 4);
+	bench_run(&entity, 12);
+	bench_check(bt_audio_unregister_codec(BENCH_CODEC_TYPE, &entity) == RTK_BT_AUDIO_OK, "unregister");
+	bench_unregister();
+
+	rtos_sched_stop();
+	rtos_task_delete(NULL);
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	rtos_sema_create(&bench_done, 0, 1);
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
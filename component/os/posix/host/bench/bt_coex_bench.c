@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * HCI traffic through the rtk_coex snoop. Without argument a trace is recorded in memory for 1, 4
+ * and 8 BR/EDR links, each with an A2DP signalling and media channel and two PAN channels opened
+ * from both sides, then its ACL data part is replayed and timed per frame. With a btsnoop file (H4
+ * datalink) the whole file is replayed instead. The monitor timer is held so the per-link counters
+ * can be checked against the trace.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "osif.h"
+#include "rtk_bt_gap.h"
+#include "rtk_coex.h"
+
+#define BENCH_STACK_SIZE		8192
+#define BENCH_FRAMES			2000000
+#define BENCH_FRAME_MAX			700
+#define BENCH_MEDIA_LEN			600
+#define BENCH_PAN_LEN			300
+#define BENCH_SNOOP_PASSES		100
+
+struct bench_frame {
+	uint8_t type;
+	uint8_t dir;
+	uint16_t len;
+	uint8_t *data;
+};
+
+struct bench_trace {
+	struct bench_frame *frame;
+	uint32_t num;
+	uint32_t max;
+};
+
+extern struct rtk_bt_coex_priv_t *p_rtk_bt_coex_priv;
+
+static uint32_t vendor_cmds;
+static int bench_fail;
+static const char *bench_snoop_file;
+
+uint16_t rtk_bt_gap_vendor_cmd_req(rtk_bt_gap_vendor_cmd_param_t *vendor_param)
+{
+	(void) vendor_param;
+	vendor_cmds++;
+	return 0;
+}
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static void bench_put16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static uint8_t *bench_record(struct bench_trace *trace, uint8_t type, uint8_t dir, uint16_t len)
+{
+	struct bench_frame *frame;
+
+	if (trace->num == trace->max) {
+		trace->max = trace->max ? trace->max * 2 : 64;
+		trace->frame = realloc(trace->frame, trace->max * sizeof(struct bench_frame));
+	}
+	frame = &trace->frame[trace->num++];
+	frame->type = type;
+	frame->dir = dir;
+	frame->len = len;
+	frame->data = calloc(1, len);
+	return frame->data;
+}
+
+static void bench_trace_free(struct bench_trace *trace)
+{
+	uint32_t i;
+
+	for (i = 0; i < trace->num; i++) {
+		free(trace->frame[i].data);
+	}
+	free(trace->frame);
+	memset(trace, 0, sizeof(*trace));
+}
+
+static void bench_evt_conn_complete(struct bench_trace *trace, uint16_t handle)
+{
+	uint8_t *p = bench_record(trace, HCI_EVT, DIR_IN, 2 + 11);
+
+	p[0] = HCI_EV_CONN_COMPLETE;
+	p[1] = 11;
+	bench_put16(p + 3, handle);     /* status 0, handle, bdaddr */
+	p[11] = 0x01;                   /* ACL link */
+}
+
+static void bench_evt_disconn_complete(struct bench_trace *trace, uint16_t handle)
+{
+	uint8_t *p = bench_record(trace, HCI_EVT, DIR_IN, 2 + 4);
+
+	p[0] = HCI_EV_DISCONN_COMPLETE;
+	p[1] = 4;
+	bench_put16(p + 3, handle);
+	p[5] = 0x13;
+}
+
+/* ACL start fragment with a basic L2CAP header, payload left zero */
+static uint8_t *bench_acl(struct bench_trace *trace, uint8_t dir, uint16_t handle, uint16_t cid, uint16_t payload)
+{
+	uint8_t *p = bench_record(trace, HCI_ACL, dir, 8 + payload);
+
+	bench_put16(p, (uint16_t)(handle | 0x2000));
+	bench_put16(p + 2, (uint16_t)(4 + payload));
+	bench_put16(p + 4, payload);
+	bench_put16(p + 6, cid);
+	return p + 8;
+}
+
+/* a channel set up by the side sending the request, scid of the request and dcid of the response */
+static void bench_l2cap_open(struct bench_trace *trace, uint8_t dir, uint16_t handle, uint16_t psm, uint16_t scid,
+							 uint16_t dcid)
+{
+	uint8_t *p;
+
+	p = bench_acl(trace, dir, handle, 0x0001, 8);
+	p[0] = L2CAP_CONN_REQ;
+	p[1] = (uint8_t)scid;
+	bench_put16(p + 2, 4);
+	bench_put16(p + 4, psm);
+	bench_put16(p + 6, scid);
+
+	p = bench_acl(trace, dir == DIR_OUT ? DIR_IN : DIR_OUT, handle, 0x0001, 12);
+	p[0] = L2CAP_CONN_RSP;
+	p[1] = (uint8_t)scid;
+	bench_put16(p + 2, 8);
+	bench_put16(p + 4, dcid);
+	bench_put16(p + 6, scid);
+}
+
+static uint16_t bench_handle(int link)
+{
+	return (uint16_t)(0x000b + link * 7);
+}
+
+/* local cids 0x40.., remote cids 0x80.., four channels per link */
+static void bench_setup_trace(struct bench_trace *trace, int links)
+{
+	uint16_t handle, local, remote;
+	int i;
+
+	for (i = 0; i < links; i++) {
+		handle = bench_handle(i);
+		local = (uint16_t)(0x40 + i * 4);
+		remote = (uint16_t)(0x80 + i * 4);
+		bench_evt_conn_complete(trace, handle);
+		bench_l2cap_open(trace, DIR_OUT, handle, PSM_AVDTP, local, remote);
+		bench_l2cap_open(trace, DIR_OUT, handle, PSM_AVDTP, local + 1, remote + 1);
+		bench_l2cap_open(trace, DIR_OUT, handle, PSM_RFCOMM, local + 2, remote + 2);
+		bench_l2cap_open(trace, DIR_IN, handle, PSM_PAN, remote + 3, local + 3);
+	}
+}
+
+/* per link and round: A2DP media in, PAN out on the local channel, PAN in on the remote one */
+static void bench_data_trace(struct bench_trace *trace, int links)
+{
+	uint16_t handle, local, remote;
+	uint8_t *p;
+	int i;
+
+	for (i = 0; i < links; i++) {
+		handle = bench_handle(i);
+		local = (uint16_t)(0x40 + i * 4);
+		remote = (uint16_t)(0x80 + i * 4);
+		p = bench_acl(trace, DIR_IN, handle, local + 1, BENCH_MEDIA_LEN);
+		p[0] = 0x80;                /* RTP v2 */
+		p[13] = 0x9c;               /* SBC syncword */
+		p[15] = 53;                 /* bitpool */
+		bench_acl(trace, DIR_OUT, handle, remote + 2, BENCH_PAN_LEN);
+		bench_acl(trace, DIR_IN, handle, local + 3, BENCH_PAN_LEN);
+	}
+}
+
+static void bench_replay(const struct bench_trace *trace)
+{
+	const struct bench_frame *frame;
+	uint32_t i;
+
+	for (i = 0; i < trace->num; i++) {
+		frame = &trace->frame[i];
+		if (frame->dir == DIR_IN) {
+			bt_coex_process_rx_frame(frame->type, frame->data, frame->len);
+		} else {
+			bt_coex_process_tx_frame(frame->type, frame->data, frame->len);
+		}
+	}
+}
+
+static int bench_link_count(void)
+{
+	struct list_head *plist;
+	int n = 0;
+
+	list_for_each(plist, &p_rtk_bt_coex_priv->conn_list) {
+		n++;
+	}
+	return n;
+}
+
+static void bench_links(int links)
+{
+	struct bench_trace setup = { 0 }, data = { 0 }, teardown = { 0 };
+	struct rtk_bt_coex_conn_t *p_conn;
+	struct list_head *plist;
+	uint32_t rounds, cmds;
+	uint64_t wall;
+	char label[32];
+	int i;
+
+	bt_coex_init();
+	osif_timer_stop(&p_rtk_bt_coex_priv->monitor_timer);
+
+	bench_setup_trace(&setup, links);
+	bench_data_trace(&data, links);
+	for (i = 0; i < links; i++) {
+		bench_evt_disconn_complete(&teardown, bench_handle(i));
+	}
+	rounds = BENCH_FRAMES / data.num;
+
+	bench_replay(&setup);
+	cmds = vendor_cmds;
+	wall = bench_wall_ns();
+	for (i = 0; i < (int)rounds; i++) {
+		bench_replay(&data);
+	}
+	wall = bench_wall_ns() - wall;
+	cmds = vendor_cmds - cmds;
+
+	list_for_each(plist, &p_rtk_bt_coex_priv->conn_list) {
+		p_conn = (struct rtk_bt_coex_conn_t *)plist;
+		bench_check(p_conn->a2dp_cnt == rounds, "a2dp media counted once per frame");
+		bench_check(p_conn->pan_cnt == 2 * rounds, "pan counted in both directions");
+		bench_check((p_conn->profile_bitmap & (BIT(PROFILE_A2DP) | BIT(PROFILE_PAN) | BIT(PROFILE_SINK))) ==
+					(BIT(PROFILE_A2DP) | BIT(PROFILE_PAN) | BIT(PROFILE_SINK)), "profiles of the link");
+	}
+	/* the first media frame of a link reports the busy A2DP sink and its bitpool */
+	bench_check(cmds == 2 * (uint32_t)links, "vendor commands of the data phase");
+
+	bench_replay(&teardown);
+	bench_check(bench_link_count() == 0 && list_empty(&p_rtk_bt_coex_priv->monitor_list), "links torn down");
+
+	snprintf(label, sizeof(label), "%d link%s", links, links > 1 ? "s" : "");
+	printf("%-10s %8.1f ns/frame  %u frames\n", label, (double)wall / (rounds * data.num), (unsigned)(rounds * data.num));
+
+	bt_coex_deinit();
+	bench_trace_free(&setup);
+	bench_trace_free(&data);
+	bench_trace_free(&teardown);
+}
+
+static uint32_t bench_be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* btsnoop: 16 byte file header, then per packet a 24 byte record header; flags bit 0 set for controller to host */
+static int bench_load_snoop(const char *path, struct bench_trace *trace, uint32_t *acl)
+{
+	uint8_t hdr[24];
+	uint32_t incl, flags;
+	uint8_t *p;
+	FILE *f;
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		return -1;
+	}
+	if (fread(hdr, 1, 16, f) != 16 || memcmp(hdr, "btsnoop", 8) != 0 || bench_be32(hdr + 12) != 1002) {
+		fclose(f);
+		return -1;
+	}
+	while (fread(hdr, 1, 24, f) == 24) {
+		incl = bench_be32(hdr + 4);
+		flags = bench_be32(hdr + 8);
+		if (incl < 2 || incl > 0xFFFF) {
+			break;
+		}
+		p = bench_record(trace, 0, (flags & 1) ? DIR_IN : DIR_OUT, (uint16_t)(incl - 1));
+		if (fread(&trace->frame[trace->num - 1].type, 1, 1, f) != 1 || fread(p, 1, incl - 1, f) != incl - 1) {
+			break;
+		}
+		if (trace->frame[trace->num - 1].type == HCI_ACL) {
+			(*acl)++;
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+static void bench_snoop(const char *path)
+{
+	struct bench_trace trace = { 0 };
+	uint32_t acl = 0;
+	uint64_t wall;
+	int i;
+
+	if (bench_load_snoop(path, &trace, &acl) != 0) {
+		bench_check(0, "btsnoop file with H4 datalink");
+		return;
+	}
+
+	bt_coex_init();
+	wall = bench_wall_ns();
+	for (i = 0; i < BENCH_SNOOP_PASSES; i++) {
+		bench_replay(&trace);
+	}
+	wall = bench_wall_ns() - wall;
+	printf("%-10s %8.1f ns/frame  %u frames, %u ACL, %d links left\n", "btsnoop", (double)wall / (trace.num * BENCH_SNOOP_PASSES),
+		   (unsigned)trace.num, (unsigned)acl, bench_link_count());
+	bt_coex_deinit();
+	bench_trace_free(&trace);
+}
+
+static void bench_main(void *param)
+{
+	(void) param;
+
+	if (bench_snoop_file) {
+		bench_snoop(bench_snoop_file);
+	} else {
+		bench_links(1);
+		bench_links(4);
+		bench_links(8);
+	}
+
+	rtos_sched_stop();
+	rtos_task_delete(NULL);
+}
+
+int main(int argc, char **argv)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	bench_snoop_file = (argc > 1) ? argv[1] : NULL;
+
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Voice output of the Bluetooth noise cancellation, from the AFE frames at 16k to the frames the
+ * SCO encoder reads. The path before resampled each AFE frame of a CVSD link with the speex
+ * resampler into a frame buffer, wrote it into a RingBuffer and read it out again for the encoder.
+ * Speex is a fixed point build on the SoC and its source is not in the tree, so the bench models
+ * its quality 1 path for 2:1: 32 Q15 taps of a sinc with cutoff 0.425 windowed by Kaiser 6, applied
+ * to a copy of the input appended to its history. The new path decimates with the half-band filter
+ * of bt_audio_voice_out.c straight into the ring and the encoder reads the frame in place.
+ *
+ * The input is raw 16 bit mono PCM at 16k given on the command line, or a synthetic voice with
+ * fricatives reaching 8 kHz. The bench checks that the ring path gives the same samples as one
+ * decimation of the whole input and that the 16k path gives the input back, then reports the time
+ * and bytes copied per AFE frame of both paths, the SNR of each output against an ideal low pass and
+ * against each other, and the response of both filters to tones in and above the voice band.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "ringbuffer.h"
+#include "bt_audio_voice_out.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC			1
+#else
+#define BENCH_HAS_TSC			0
+#endif
+
+#define BENCH_RATE				16000
+#define BENCH_AFE_SAMPLES		256		/* AFE frame of 16 ms */
+#define BENCH_AFE_BYTES			(BENCH_AFE_SAMPLES * 2)
+#define BENCH_RING_FRAMES		4
+#define BENCH_CVSD_READ			120		/* bytes the encoder reads, 7.5 ms at 8k */
+#define BENCH_MSBC_READ			240		/* 7.5 ms at 16k */
+#define BENCH_SIG_SECONDS		10
+#define BENCH_ROUNDS			20
+
+#define SPEEX_TAPS				32
+#define SPEEX_CUTOFF			0.425
+#define REF_HALF				255		/* ideal low pass, 511 taps */
+#define REF_CUTOFF				3900.0	/* anti-aliasing of the reference */
+#define BENCH_VOICE_BAND		3400.0
+
+struct speex_model {
+	int16_t sinc[SPEEX_TAPS];
+	int16_t mem[SPEEX_TAPS - 1 + BENCH_AFE_SAMPLES];
+};
+
+struct bench_stat {
+	uint64_t ns;
+	uint64_t tsc;
+	uint64_t copy_bytes;
+	uint32_t frames;
+};
+
+static int bench_fail;
+static volatile int32_t bench_sink;
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t bench_tsc(void)
+{
+#if BENCH_HAS_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static double bench_i0(double x)
+{
+	double s = 1, t = 1;
+	int k;
+
+	for (k = 1; k < 50; k++) {
+		t *= (x / 2 / k) * (x / 2 / k);
+		s += t;
+	}
+	return s;
+}
+
+static double bench_kaiser(double r, double beta)
+{
+	return r >= 1 ? 0 : bench_i0(beta * sqrt(1 - r * r)) / bench_i0(beta);
+}
+
+/*------------------------------------------------------------------*/
+
+/* what speex_resampler_init(1, 16000, 8000, 1) sets up in a fixed point build */
+static void speex_model_init(struct speex_model *m)
+{
+	int j;
+
+	for (j = 0; j < SPEEX_TAPS; j++) {
+		double x = j - SPEEX_TAPS / 2 + 1, v;
+
+		if (x == 0) {
+			v = SPEEX_CUTOFF;
+		} else {
+			double xx = x * SPEEX_CUTOFF;
+			v = SPEEX_CUTOFF * sin(M_PI * xx) / (M_PI * xx) * bench_kaiser(fabs(2 * x / SPEEX_TAPS), 6);
+		}
+		m->sinc[j] = (int16_t)floor(32768 * v + 0.5);
+	}
+	memset(m->mem, 0, sizeof(m->mem));
+}
+
+/* speex_resampler_process_int, the input is copied after the history of the filter */
+static void speex_model_process(struct speex_model *m, const int16_t *in, uint32_t in_samples, int16_t *out,
+								uint64_t *copy_bytes)
+{
+	uint32_t k;
+	int j;
+
+	memcpy(m->mem + SPEEX_TAPS - 1, in, in_samples * 2);
+	for (k = 0; k < in_samples / 2; k++) {
+		const int16_t *p = m->mem + 2 * k;
+		int32_t sum = 0;
+
+		for (j = 0; j < SPEEX_TAPS; j++) {
+			sum += (int32_t)m->sinc[j] * p[j];
+		}
+		sum = (sum + (1 << 14)) >> 15;
+		out[k] = (int16_t)(sum > 32767 ? 32767 : sum < -32768 ? -32768 : sum);
+	}
+	memmove(m->mem, m->mem + in_samples, (SPEEX_TAPS - 1) * 2);
+	*copy_bytes += in_samples * 2 + (SPEEX_TAPS - 1) * 2;
+}
+
+/*------------------------------------------------------------------*/
+
+/* the encoder reads the frame */
+static void bench_encode(const void *frame, uint32_t len, int16_t *collect, uint32_t *collected)
+{
+	const int16_t *s = (const int16_t *)frame;
+	int32_t acc = 0;
+	uint32_t i;
+
+	for (i = 0; i < len / 2; i++) {
+		acc += s[i];
+	}
+	bench_sink += acc;
+	if (collect) {
+		memcpy(collect + *collected, frame, len);
+		*collected += len / 2;
+	}
+}
+
+/* aivoice_callback_process and hfp_task_entry before: speex, RingBuffer_Write, RingBuffer_Read */
+static void bench_legacy(const int16_t *sig, uint32_t frames, int cvsd, int16_t *collect, uint32_t *collected,
+						 struct bench_stat *st)
+{
+	static struct speex_model m;
+	int16_t out_8k[BENCH_AFE_SAMPLES / 2];
+	int16_t nc_buffer[BENCH_AFE_SAMPLES];
+	uint32_t read = cvsd ? BENCH_CVSD_READ : BENCH_MSBC_READ;
+	uint32_t f;
+	RingBuffer *rb = RingBuffer_Create(NULL, BENCH_AFE_BYTES * BENCH_RING_FRAMES, LOCAL_RINGBUFF, 1);
+	uint64_t t0, c0;
+
+	speex_model_init(&m);
+	t0 = bench_wall_ns();
+	c0 = bench_tsc();
+	for (f = 0; f < frames; f++) {
+		const int16_t *in = sig + f * BENCH_AFE_SAMPLES;
+
+		if (cvsd) {
+			speex_model_process(&m, in, BENCH_AFE_SAMPLES, out_8k, &st->copy_bytes);
+			if (RingBuffer_Space(rb) >= BENCH_AFE_BYTES / 2) {
+				RingBuffer_Write(rb, (uint8_t *)out_8k, BENCH_AFE_BYTES / 2);
+				st->copy_bytes += BENCH_AFE_BYTES / 2;
+			}
+		} else if (RingBuffer_Space(rb) >= BENCH_AFE_BYTES) {
+			RingBuffer_Write(rb, (uint8_t *)in, BENCH_AFE_BYTES);
+			st->copy_bytes += BENCH_AFE_BYTES;
+		}
+		while (RingBuffer_Available(rb) >= read) {
+			RingBuffer_Read(rb, (uint8_t *)nc_buffer, read);
+			st->copy_bytes += read;
+			bench_encode(nc_buffer, read, collect, collected);
+		}
+	}
+	st->tsc += bench_tsc() - c0;
+	st->ns += bench_wall_ns() - t0;
+	st->frames += frames;
+	RingBuffer_Destroy(rb);
+}
+
+/* aivoice_callback_process and hfp_task_entry now: decimated into the ring, encoded in place */
+static void bench_fused(const int16_t *sig, uint32_t frames, int cvsd, int16_t *collect, uint32_t *collected,
+						struct bench_stat *st)
+{
+	static uint8_t ring_buf[BENCH_AFE_BYTES * BENCH_RING_FRAMES];
+	static uint8_t bounce[BENCH_AFE_BYTES];
+	struct bt_audio_voice_decim decim;
+	struct bt_audio_voice_ring ring;
+	uint32_t read = cvsd ? BENCH_CVSD_READ : BENCH_MSBC_READ;
+	uint32_t f;
+	uint64_t t0, c0;
+
+	bt_audio_voice_decim_init(&decim);
+	bt_audio_voice_ring_init(&ring, ring_buf, sizeof(ring_buf));
+	t0 = bench_wall_ns();
+	c0 = bench_tsc();
+	for (f = 0; f < frames; f++) {
+		const int16_t *in = sig + f * BENCH_AFE_SAMPLES;
+		const void *frame;
+		void *space;
+
+		if (cvsd) {
+			space = bt_audio_voice_ring_reserve(&ring, BENCH_AFE_BYTES / 2);
+			if (space) {
+				bt_audio_voice_decim_process(&decim, in, BENCH_AFE_SAMPLES, (int16_t *)space);
+				bt_audio_voice_ring_commit(&ring, BENCH_AFE_BYTES / 2);
+				/* history and stitch of the first outputs */
+				st->copy_bytes += 3 * BT_AUDIO_VOICE_DECIM_HIST_NUM * 2;
+			}
+		} else {
+			space = bt_audio_voice_ring_reserve(&ring, BENCH_AFE_BYTES);
+			if (space) {
+				memcpy(space, in, BENCH_AFE_BYTES);
+				bt_audio_voice_ring_commit(&ring, BENCH_AFE_BYTES);
+				st->copy_bytes += BENCH_AFE_BYTES;
+			}
+		}
+		while ((frame = bt_audio_voice_ring_peek(&ring, read, bounce)) != NULL) {
+			if (frame == bounce) {
+				st->copy_bytes += read;
+			}
+			bench_encode(frame, read, collect, collected);
+			bt_audio_voice_ring_release(&ring, read);
+		}
+	}
+	st->tsc += bench_tsc() - c0;
+	st->ns += bench_wall_ns() - t0;
+	st->frames += frames;
+}
+
+/*------------------------------------------------------------------*/
+
+static void bench_verify_ring(void)
+{
+	/* 5 frames, not a power of two like the AFE ring, head and tail wrap many times */
+	static uint8_t buf[5 * 64];
+	uint8_t bounce[100], *p;
+	struct bt_audio_voice_ring ring;
+	const uint8_t *q;
+	uint32_t i, j, written = 0, read = 0;
+	int ok = 1;
+
+	bt_audio_voice_ring_init(&ring, buf, sizeof(buf));
+	/* reads of 100 bytes over frames of 64 bytes wrap around the end */
+	for (i = 0; i < 200 && ok; i++) {
+		while ((p = bt_audio_voice_ring_reserve(&ring, 64)) != NULL) {
+			for (j = 0; j < 64; j++) {
+				p[j] = (uint8_t)(written + j);
+			}
+			written += 64;
+			bt_audio_voice_ring_commit(&ring, 64);
+		}
+		ok &= bt_audio_voice_ring_available(&ring) > sizeof(buf) - 64;
+		q = bt_audio_voice_ring_peek(&ring, 100, bounce);
+		if (!q) {
+			ok = 0;
+			break;
+		}
+		for (j = 0; j < 100; j++) {
+			ok &= q[j] == (uint8_t)(read + j);
+		}
+		read += 100;
+		bt_audio_voice_ring_release(&ring, 100);
+	}
+	bench_check(ok, "ring in order across wraps");
+	bench_check(bt_audio_voice_ring_peek(&ring, sizeof(buf) + 1, bounce) == NULL, "ring peek more than available");
+	while (bt_audio_voice_ring_reserve(&ring, 64)) {
+		bt_audio_voice_ring_commit(&ring, 64);
+	}
+	bench_check(bt_audio_voice_ring_available(&ring) <= sizeof(buf), "ring not overfilled");
+}
+
+/*------------------------------------------------------------------*/
+
+static uint32_t bench_rand(uint32_t *seed)
+{
+	*seed = *seed * 1103515245u + 12345u;
+	return *seed >> 8;
+}
+
+/* voiced sounds through formant resonators, and fricatives of high passed noise */
+static void bench_voice_gen(int16_t *sig, uint32_t n)
+{
+	static const double formant[4] = { 700, 1200, 2600, 3400 };
+	double y1[4] = {0}, y2[4] = {0}, phase = 0, lp = 0, peak = 1;
+	double *tmp = malloc(n * sizeof(double));
+	uint32_t seed = 1, i;
+	int f;
+
+	for (i = 0; i < n; i++) {
+		double t = (double)i / BENCH_RATE;
+		double f0 = 120 + 40 * sin(2 * M_PI * 0.7 * t);
+		double env = 0.5 + 0.5 * sin(2 * M_PI * 3 * t);
+		double noise = (double)(bench_rand(&seed) & 0xFFFF) / 32768.0 - 1;
+		int fricative = ((uint32_t)(t * 4) % 5) == 2;
+		double src, v = 0;
+
+		phase += f0 / BENCH_RATE;
+		if (phase >= 1) {
+			phase -= 1;
+		}
+		src = fricative ? 0 : 2 * phase - 1;
+		for (f = 0; f < 4; f++) {
+			double r = 0.97, w = 2 * M_PI * formant[f] / BENCH_RATE;
+			double y = src * (1 - r) + 2 * r * cos(w) * y1[f] - r * r * y2[f];
+
+			y2[f] = y1[f];
+			y1[f] = y;
+			v += y / (f + 1);
+		}
+		lp += 0.3 * (noise - lp);
+		if (fricative) {
+			v += 0.6 * (noise - lp);
+		}
+		tmp[i] = v * env + 0.002 * noise;
+		if (fabs(tmp[i]) > peak || i == 0) {
+			peak = fabs(tmp[i]);
+		}
+	}
+	for (i = 0; i < n; i++) {
+		sig[i] = (int16_t)lrint(tmp[i] / peak * 16000);
+	}
+	free(tmp);
+}
+
+static void bench_lowpass(double *h, int half, double rate, double cutoff)
+{
+	double wc = 2 * cutoff / rate;
+	int t;
+
+	for (t = -half; t <= half; t++) {
+		double sinc = t ? sin(M_PI * wc * t) / (M_PI * wc * t) : 1;
+
+		h[t + half] = wc * sinc * bench_kaiser(fabs((double)t / (half + 1)), 10);
+	}
+}
+
+/* y[m] = sum of h around x[step * m] */
+static void bench_filter(const double *h, int half, const double *x, uint32_t n, uint32_t step, double *y)
+{
+	uint32_t m;
+	int t;
+
+	for (m = 0; m < n / step; m++) {
+		double acc = 0;
+
+		for (t = -half; t <= half; t++) {
+			int64_t idx = (int64_t)step * m + t;
+
+			if (idx >= 0 && idx < n) {
+				acc += h[t + half] * x[idx];
+			}
+		}
+		y[m] = acc;
+	}
+}
+
+/* SNR of a against b at the lag of a which fits best, over the whole band or below BENCH_VOICE_BAND */
+static double bench_snr(const int16_t *a, const double *b, uint32_t n, int voice_band, int *best_lag)
+{
+	static double h[2 * REF_HALF + 1];
+	double best = -1e9, *e, *lb, *le;
+	uint32_t i;
+	int lag;
+
+	for (lag = -16; lag <= 16; lag++) {
+		double sig = 0, err = 0, snr;
+
+		for (i = 256; i + 256 < n; i++) {
+			double d = a[(int64_t)i + lag] - b[i];
+
+			sig += b[i] * b[i];
+			err += d * d;
+		}
+		snr = 10 * log10(sig / (err ? err : 1e-9));
+		if (snr > best) {
+			best = snr;
+			*best_lag = lag;
+		}
+	}
+	if (!voice_band) {
+		return best;
+	}
+
+	/* the error the far end hears, aliases and droop which fall in the voice band */
+	e = calloc(n, sizeof(double));
+	lb = calloc(n, sizeof(double));
+	le = calloc(n, sizeof(double));
+	for (i = 256; i + 256 < n; i++) {
+		e[i] = a[(int64_t)i + *best_lag] - b[i];
+	}
+	bench_lowpass(h, REF_HALF, BENCH_RATE / 2, BENCH_VOICE_BAND);
+	bench_filter(h, REF_HALF, b, n, 1, lb);
+	bench_filter(h, REF_HALF, e, n, 1, le);
+	{
+		double sig = 0, err = 0;
+
+		for (i = 512; i + 512 < n; i++) {
+			sig += lb[i] * lb[i];
+			err += le[i] * le[i];
+		}
+		best = 10 * log10(sig / (err ? err : 1e-9));
+	}
+	free(e);
+	free(lb);
+	free(le);
+	return best;
+}
+
+static double bench_tone_db(int speex, double freq)
+{
+	static int16_t in[BENCH_RATE / 2], out[BENCH_RATE / 4];
+	struct speex_model m;
+	struct bt_audio_voice_decim decim;
+	uint64_t copy_bytes = 0;
+	double pin = 0, pout = 0;
+	uint32_t i;
+
+	for (i = 0; i < BENCH_RATE / 2; i++) {
+		in[i] = (int16_t)lrint(10000 * sin(2 * M_PI * freq * i / BENCH_RATE));
+	}
+	speex_model_init(&m);
+	bt_audio_voice_decim_init(&decim);
+	for (i = 0; i + BENCH_AFE_SAMPLES <= BENCH_RATE / 2; i += BENCH_AFE_SAMPLES) {
+		if (speex) {
+			speex_model_process(&m, in + i, BENCH_AFE_SAMPLES, out + i / 2, &copy_bytes);
+		} else {
+			bt_audio_voice_decim_process(&decim, in + i, BENCH_AFE_SAMPLES, out + i / 2);
+		}
+	}
+	for (i = 512; i < BENCH_RATE / 2; i++) {
+		pin += (double)in[i] * in[i];
+	}
+	for (i = 256; i < BENCH_RATE / 4; i++) {
+		pout += (double)out[i] * out[i];
+	}
+	pin /= BENCH_RATE / 2 - 512;
+	pout /= BENCH_RATE / 4 - 256;
+	return 10 * log10((pout ? pout : 1e-3) / pin);
+}
+
+/*------------------------------------------------------------------*/
+
+static int16_t *bench_load(const char *path, uint32_t *n)
+{
+	FILE *fp = fopen(path, "rb");
+	int16_t *sig;
+	long size;
+
+	if (!fp) {
+		return NULL;
+	}
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	*n = (uint32_t)(size / 2) / BENCH_AFE_SAMPLES * BENCH_AFE_SAMPLES;
+	sig = malloc((*n ? *n : 1) * 2);
+	if (sig && fread(sig, 2, *n, fp) != *n) {
+		free(sig);
+		sig = NULL;
+	}
+	fclose(fp);
+	return sig;
+}
+
+static void bench_row(const char *path, const char *codec, const struct bench_stat *st)
+{
+	printf("%-8s %-5s %10.0f %10.0f %12.0f\n", path, codec, (double)st->ns / st->frames,
+		   BENCH_HAS_TSC ? (double)st->tsc / st->frames : 0.0, (double)st->copy_bytes / st->frames);
+}
+
+int main(int argc, char **argv)
+{
+	static const double tones[] = { 300, 1000, 2000, 3000, 3400, 3800, 4200, 4600, 5500, 7000 };
+	struct bench_stat st;
+	int16_t *sig, *out_legacy, *out_fused, *out_once;
+	double *ref;
+	uint32_t n, frames, n_legacy = 0, n_fused = 0, i;
+	int lag_legacy = 0, lag_fused = 0, lag_cross = 0, cvsd, r;
+	struct bt_audio_voice_decim decim;
+	double *legacy_d;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	if (argc > 1) {
+		sig = bench_load(argv[1], &n);
+		if (!sig || n < 2 * BENCH_AFE_SAMPLES) {
+			printf("cannot read 16 bit mono 16k PCM from %s\n", argv[1]);
+			return 1;
+		}
+	} else {
+		n = BENCH_SIG_SECONDS * BENCH_RATE / BENCH_AFE_SAMPLES * BENCH_AFE_SAMPLES;
+		sig = malloc(n * 2);
+		bench_voice_gen(sig, n);
+	}
+	frames = n / BENCH_AFE_SAMPLES;
+	out_legacy = calloc(n, 2);
+	out_fused = calloc(n, 2);
+	out_once = calloc(n, 2);
+	ref = calloc(n / 2, sizeof(double));
+	legacy_d = calloc(n / 2, sizeof(double));
+
+	bench_verify_ring();
+
+	/* the 8k frames the encoder reads are one decimation of the whole input */
+	memset(&st, 0, sizeof(st));
+	bench_fused(sig, frames, 1, out_fused, &n_fused, &st);
+	bt_audio_voice_decim_init(&decim);
+	bt_audio_voice_decim_process(&decim, sig, n, out_once);
+	bench_check(n_fused == n / 2 / (BENCH_CVSD_READ / 2) * (BENCH_CVSD_READ / 2), "8k samples read");
+	bench_check(memcmp(out_fused, out_once, n_fused * 2) == 0, "8k frames through the ring");
+	bench_legacy(sig, frames, 1, out_legacy, &n_legacy, &st);
+	bench_check(n_legacy == n_fused, "8k samples read before");
+
+	/* 16k frames go through unchanged */
+	n_fused = 0;
+	memset(&st, 0, sizeof(st));
+	bench_fused(sig, frames, 0, out_once, &n_fused, &st);
+	bench_check(n_fused == n / (BENCH_MSBC_READ / 2) * (BENCH_MSBC_READ / 2) &&
+				memcmp(out_once, sig, n_fused * 2) == 0, "16k frames through the ring");
+
+	printf("%u AFE frames of %u samples, %s\n", (unsigned)frames, (unsigned)BENCH_AFE_SAMPLES,
+		   argc > 1 ? argv[1] : "synthetic voice");
+	printf("%-8s %-5s %10s %10s %12s\n", "path", "link", "ns/frame", "tsc/frame", "copied B/frm");
+	for (cvsd = 1; cvsd >= 0; cvsd--) {
+		uint32_t dummy = 0;
+
+		memset(&st, 0, sizeof(st));
+		for (r = 0; r < BENCH_ROUNDS; r++) {
+			bench_legacy(sig, frames, cvsd, NULL, &dummy, &st);
+		}
+		bench_row("before", cvsd ? "cvsd" : "msbc", &st);
+		memset(&st, 0, sizeof(st));
+		for (r = 0; r < BENCH_ROUNDS; r++) {
+			bench_fused(sig, frames, cvsd, NULL, &dummy, &st);
+		}
+		bench_row("fused", cvsd ? "cvsd" : "msbc", &st);
+	}
+
+	{
+		static double h[2 * REF_HALF + 1];
+		double *sig_d = calloc(n, sizeof(double));
+		double snr_legacy, snr_fused, snr_legacy_band, snr_fused_band, snr_cross;
+		int lag;
+
+		for (i = 0; i < n; i++) {
+			sig_d[i] = sig[i];
+		}
+		bench_lowpass(h, REF_HALF, BENCH_RATE, REF_CUTOFF);
+		bench_filter(h, REF_HALF, sig_d, n, 2, ref);
+		free(sig_d);
+		for (i = 0; i < n_legacy; i++) {
+			legacy_d[i] = out_legacy[i];
+		}
+		snr_legacy = bench_snr(out_legacy, ref, n_legacy, 0, &lag_legacy);
+		snr_fused = bench_snr(out_fused, ref, n_legacy, 0, &lag_fused);
+		snr_legacy_band = bench_snr(out_legacy, ref, n_legacy, 1, &lag);
+		snr_fused_band = bench_snr(out_fused, ref, n_legacy, 1, &lag);
+		snr_cross = bench_snr(out_fused, legacy_d, n_legacy, 0, &lag_cross);
+		printf("SNR dB against a %u tap low pass at %.0f Hz   whole band  below %.0f Hz\n", 2 * REF_HALF + 1,
+			   REF_CUTOFF, BENCH_VOICE_BAND);
+		printf("  speex (lag %d) %30.1f %12.1f\n", lag_legacy, snr_legacy, snr_legacy_band);
+		printf("  fused (lag %d) %30.1f %12.1f\n", lag_fused, snr_fused, snr_fused_band);
+		printf("SNR dB fused against speex (lag %d) %.1f\n", lag_cross, snr_cross);
+		/* 19 input samples of delay against 16 */
+		bench_check(lag_fused == lag_legacy + 1 && lag_cross == 1, "fused path one 8k sample later");
+		bench_check(snr_fused_band > snr_legacy_band, "voice band at least as clean as speex");
+	}
+
+	printf("%-8s %8s %8s\n", "tone Hz", "speex dB", "fused dB");
+	for (i = 0; i < sizeof(tones) / sizeof(tones[0]); i++) {
+		printf("%-8.0f %8.1f %8.1f\n", tones[i], bench_tone_db(1, tones[i]), bench_tone_db(0, tones[i]));
+	}
+
+	free(sig);
+	free(out_legacy);
+	free(out_fused);
+	free(out_once);
+	free(ref);
+	free(legacy_d);
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * cJSON parse of MQTT and HTTP sized payloads: the usual cJSON_Parse/cJSON_Delete against
+ * cJSON_ParseInPlace on a reused arena. Reports throughput, allocator calls per parse and the peak
+ * of live bytes (payload sizes only, not the per block overhead of the allocator), then checks both
+ * trees are equal and the arena corner cases.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "cJSON.h"
+
+#define BENCH_ROUNDS			2000
+#define BENCH_PAYLOAD_MAX		(64 * 1024)
+
+/* every block carries its size so frees can be accounted, bench_hdr is the offset of the
+ * returned pointer and may be set off double alignment */
+#define BENCH_HDR				16
+
+static size_t bench_hdr = BENCH_HDR;
+
+static size_t heap_calls;
+static size_t heap_live;
+static size_t heap_peak;
+static int bench_fail;
+
+static void *bench_malloc(size_t size)
+{
+	unsigned char *p = malloc(size + bench_hdr);
+
+	if (p == NULL) {
+		return NULL;
+	}
+	*(size_t *)p = size;
+	heap_calls++;
+	heap_live += size;
+	if (heap_live > heap_peak) {
+		heap_peak = heap_live;
+	}
+	return p + bench_hdr;
+}
+
+static void bench_free(void *ptr)
+{
+	unsigned char *p = (unsigned char *)ptr - bench_hdr;
+
+	heap_calls++;
+	heap_live -= *(size_t *)p;
+	free(p);
+}
+
+static void bench_heap_reset(void)
+{
+	heap_calls = 0;
+	heap_peak = heap_live;
+}
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+/* telemetry publish: a flat object of readings and a short array of samples */
+static size_t bench_mqtt_payload(char *buf, size_t size)
+{
+	size_t len;
+	int i;
+
+	len = (size_t)snprintf(buf, size, "{\"device\":\"ameba-%04x\",\"fw\":\"1.4.2\",\"ts\":%u,\"online\":true,\"readings\":{",
+						   0x1a2b, 1700000000u);
+	for (i = 0; i < 24; i++) {
+		len += (size_t)snprintf(buf + len, size - len, "%s\"sensor_%02d\":{\"value\":%d.%02d,\"unit\":\"%s\",\"ok\":%s}",
+								i ? "," : "", i, 20 + i, i * 3 % 100, (i & 1) ? "C" : "%RH", (i % 5) ? "true" : "false");
+	}
+	len += (size_t)snprintf(buf + len, size - len, "},\"samples\":[");
+	for (i = 0; i < 32; i++) {
+		len += (size_t)snprintf(buf + len, size - len, "%s%d", i ? "," : "", (i * 37) % 1024 - 512);
+	}
+	len += (size_t)snprintf(buf + len, size - len, "],\"note\":\"rssi \\\"-61\\\" dBm\\n\\u00b0C\"}");
+	return len;
+}
+
+/* REST listing: an array of records with nested objects and escaped text */
+static size_t bench_http_payload(char *buf, size_t size)
+{
+	size_t len;
+	int i;
+
+	len = (size_t)snprintf(buf, size, "{\n  \"status\": 200,\n  \"next\": null,\n  \"items\": [\n");
+	for (i = 0; i < 64; i++) {
+		len += (size_t)snprintf(buf + len, size - len,
+								"%s    {\"id\": %d, \"name\": \"item %d\", \"path\": \"\\/files\\/%d.bin\", \"size\": %d,"
+								" \"tags\": [\"a\", \"b\", \"c%d\"], \"meta\": {\"owner\": \"user\\t%d\", \"score\": %d.5e-1,"
+								" \"empty\": {}, \"none\": []}}",
+								i ? ",\n" : "", i, i, i, 1024 * i + 17, i % 7, i % 3, i);
+	}
+	len += (size_t)snprintf(buf + len, size - len, "\n  ]\n}\n");
+	return len;
+}
+
+static void bench_heap(const char *name, const char *payload, size_t len)
+{
+	uint64_t wall;
+	size_t calls;
+	cJSON *root;
+	int r;
+
+	bench_heap_reset();
+	wall = bench_wall_ns();
+	for (r = 0; r < BENCH_ROUNDS; r++) {
+		root = cJSON_ParseWithLength(payload, len);
+		cJSON_Delete(root);
+	}
+	wall = bench_wall_ns() - wall;
+	calls = heap_calls;
+
+	printf("%-6s %-8s %8.1f MB/s %8.1f us/parse %8.1f alloc+free/parse %8u peak bytes\n", name, "heap",
+		   (double)len * BENCH_ROUNDS * 1e3 / wall, wall / 1e3 / BENCH_ROUNDS, (double)calls / BENCH_ROUNDS,
+		   (unsigned)heap_peak);
+}
+
+static void bench_arena(const char *name, const char *payload, size_t len)
+{
+	static char work[BENCH_PAYLOAD_MAX];
+	cJSON_Arena arena;
+	void *buffer;
+	size_t size;
+	uint64_t wall;
+	size_t calls;
+	cJSON *root;
+	int r;
+
+	size = cJSON_ArenaSize(payload, len);
+	buffer = malloc(size);
+	cJSON_InitArena(&arena, buffer, size);
+
+	bench_heap_reset();
+	wall = bench_wall_ns();
+	for (r = 0; r < BENCH_ROUNDS; r++) {
+		/* the input is consumed, a receive buffer would be refilled by the transport */
+		memcpy(work, payload, len);
+		root = cJSON_ParseInPlace(work, len, &arena);
+		bench_check(root != NULL, "arena parse");
+		cJSON_ResetArena(&arena);
+	}
+	wall = bench_wall_ns() - wall;
+	calls = heap_calls;
+
+	printf("%-6s %-8s %8.1f MB/s %8.1f us/parse %8.1f alloc+free/parse %8u peak bytes (arena %u of %u)\n", name,
+		   "in-place", (double)len * BENCH_ROUNDS * 1e3 / wall, wall / 1e3 / BENCH_ROUNDS, (double)calls / BENCH_ROUNDS,
+		   (unsigned)(arena.peak + len), (unsigned)arena.peak, (unsigned)size);
+	free(buffer);
+}
+
+static void bench_verify(const char *name, const char *payload, size_t len)
+{
+	static char work[BENCH_PAYLOAD_MAX];
+	cJSON_Arena arena;
+	cJSON *heap_root, *arena_root, *copy, *extra;
+	size_t used;
+
+	heap_root = cJSON_ParseWithLength(payload, len);
+	bench_check(heap_root != NULL, "heap parse");
+
+	/* arena allocated on first use */
+	memcpy(work, payload, len);
+	cJSON_InitArena(&arena, NULL, 0);
+	arena_root = cJSON_ParseInPlace(work, len, &arena);
+	bench_check(arena_root != NULL && arena.allocation != NULL, "owned arena parse");
+	bench_check(cJSON_Compare(heap_root, arena_root, 1), "in-place tree equals heap tree");
+	bench_check(arena.used <= arena.size, "arena size estimate");
+
+	/* a duplicate leaves the arena behind */
+	copy = cJSON_Duplicate(arena_root, 1);
+	bench_check(cJSON_Compare(copy, heap_root, 1), "duplicate of in-place tree");
+	cJSON_Delete(copy);
+
+	/* heap items added into an arena tree are freed by cJSON_Delete, arena nodes are not */
+	extra = cJSON_CreateString("added on the heap");
+	cJSON_AddItemToObject(arena_root, "extra", extra);
+	bench_check(!cJSON_AddItemToObject(arena_root, "moved", cJSON_DetachItemFromObject(arena_root, "next")),
+				"heap key on an arena node");
+	cJSON_Delete(arena_root);
+
+	/* the arena is full for a second tree: the parse fails and leaves used alone */
+	used = arena.used;
+	memcpy(work, payload, len);
+	bench_check(cJSON_ParseInPlace(work, len, &arena) == NULL && arena.used == used, "parse into a full arena");
+
+	/* a truncated document rolls the arena back */
+	cJSON_ResetArena(&arena);
+	memcpy(work, payload, len);
+	bench_check(cJSON_ParseInPlace(work, len / 2, &arena) == NULL && arena.used == 0, "truncated parse");
+
+	cJSON_FreeArena(&arena);
+	cJSON_Delete(heap_root);
+	printf("%-6s %u bytes, in-place tree %s\n", name, (unsigned)len, bench_fail ? "differs" : "equal");
+}
+
+/* hooks memory off double alignment: the owned arena starts further in and frees what was allocated,
+ * the in-place parse calls the hooks for nothing else */
+static void bench_verify_misaligned(const char *payload, size_t len)
+{
+	static char work[BENCH_PAYLOAD_MAX];
+	cJSON_Arena arena;
+	size_t live = heap_live;
+
+	memcpy(work, payload, len);
+	cJSON_InitArena(&arena, NULL, 0);
+	bench_hdr = BENCH_HDR + 4;
+	bench_check(cJSON_ParseInPlace(work, len, &arena) != NULL && (unsigned char *)arena.allocation != arena.buffer,
+				"arena parse with misaligned hooks memory");
+	cJSON_FreeArena(&arena);
+	bench_hdr = BENCH_HDR;
+	bench_check(heap_live == live, "misaligned arena freed");
+}
+
+int main(void)
+{
+	static char mqtt[BENCH_PAYLOAD_MAX], http[BENCH_PAYLOAD_MAX];
+	cJSON_Hooks hooks = { bench_malloc, bench_free };
+	size_t mqtt_len, http_len;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	cJSON_InitHooks(&hooks);
+
+	mqtt_len = bench_mqtt_payload(mqtt, sizeof(mqtt));
+	http_len = bench_http_payload(http, sizeof(http));
+
+	bench_verify("mqtt", mqtt, mqtt_len);
+	bench_verify("http", http, http_len);
+	bench_verify_misaligned(mqtt, mqtt_len);
+
+	bench_heap("mqtt", mqtt, mqtt_len);
+	bench_arena("mqtt", mqtt, mqtt_len);
+	bench_heap("http", http, http_len);
+	bench_arena("http", http, http_len);
+
+	bench_check(heap_live == 0, "all cJSON memory returned");
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
@@ -0,0 +1,610 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * network/coap between a client and a server handle over an in-memory datagram queue, both created
+ * with coap_protocol_init() of the Ameba port.
+ * Confirmable GETs with 1 to 255 exchanges in flight (255 is the uint8_t limit of the resending queue
+ * and of the duplicate table) report exchanges/s and the peak of live heap bytes of each handle,
+ * counted around rtos_mem_malloc/rtos_mem_free. The lossy run drops datagrams in both directions and
+ * recovers through the resending of sn_coap_protocol_exec() and duplicate detection on the server.
+ * Block-wise GET (Block2) and PUT (Block1) of a payload near the 64 KiB limit of the sender then
+ * compare the store-and-concatenate receive with streaming each block to a callback and to a file
+ * through coap_block_file_sink(). Checks every exchange completes once, the received bytes, that the
+ * streaming receiver does not hold the payload and that both handles free everything on destroy.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "sn_coap_ameba_port.h"
+#include "sn_coap_protocol_internal.h"
+
+#define BENCH_EXCHANGES			60000
+#define BENCH_QUEUE				1024	/* datagrams in flight */
+#define BENCH_DGRAM_MAX			1280
+#define BENCH_BLOCK_PAYLOAD		60000
+#define BENCH_BLOCK_ROUNDS		10
+#define BENCH_STALL_S			300		/* virtual seconds without progress before giving up */
+
+/* every block carries its size and owner so frees can be accounted */
+#define BENCH_HDR				16
+
+enum {
+	BENCH_RX_STORE,
+	BENCH_RX_STREAM,
+	BENCH_RX_FILE,
+};
+
+struct bench_side {
+	struct coap_s *coap;
+	uint8_t ip[4];
+	sn_nsdl_addr_s addr;
+	struct bench_side *peer;
+	void (*app)(struct bench_side *side, sn_coap_hdr_s *msg);
+	size_t live;
+	size_t peak;
+	uint32_t lib_tx;	/* datagrams sent by the stack itself: resendings and block-wise follow-ups */
+};
+
+struct bench_dgram {
+	struct bench_side *to;
+	uint16_t len;
+	uint8_t data[BENCH_DGRAM_MAX];
+};
+
+struct bench_stream {
+	const uint8_t *expect;
+	uint32_t len;
+	uint32_t bytes;
+	int bad;
+	int last;
+};
+
+static struct bench_side bench_client = { NULL, {10, 0, 0, 1}, {0}, NULL, NULL, 0, 0, 0 };
+static struct bench_side bench_server = { NULL, {10, 0, 0, 2}, {0}, NULL, NULL, 0, 0, 0 };
+static struct bench_side *heap_side;
+
+static struct bench_dgram *bench_queue;
+static unsigned int queue_head;
+static unsigned int queue_count;
+static uint32_t queue_full;
+static uint32_t bench_delivered;
+
+static uint32_t loss_permille;
+static uint32_t loss_seed = 1;
+static uint32_t loss_drops;
+
+static uint8_t outstanding[65536];
+static uint32_t exch_open;
+static uint32_t exch_done;
+static uint32_t exch_stray;
+static uint32_t exch_failed;
+static uint32_t server_dups;
+
+static uint8_t block_src[BENCH_BLOCK_PAYLOAD];
+static int block_mode;
+static int block_done;
+static int block_ok;
+static struct bench_stream block_stream;
+
+static int bench_fail;
+
+void *__real_rtos_mem_malloc(uint32_t size);
+void __real_rtos_mem_free(void *pbuf);
+
+/* allocations are charged to the handle the bench called into */
+void *__wrap_rtos_mem_malloc(uint32_t size)
+{
+	unsigned char *p = __real_rtos_mem_malloc(size + BENCH_HDR);
+	struct bench_side *side = heap_side;
+
+	if (p == NULL) {
+		return NULL;
+	}
+	*(uint32_t *)p = size;
+	memcpy(p + sizeof(uint64_t), &side, sizeof(side));
+	if (side) {
+		side->live += size;
+		if (side->live > side->peak) {
+			side->peak = side->live;
+		}
+	}
+	return p + BENCH_HDR;
+}
+
+void __wrap_rtos_mem_free(void *pbuf)
+{
+	unsigned char *p = (unsigned char *)pbuf - BENCH_HDR;
+	struct bench_side *side;
+
+	if (pbuf == NULL) {
+		return;
+	}
+	memcpy(&side, p + sizeof(uint64_t), sizeof(side));
+	if (side) {
+		side->live -= *(uint32_t *)p;
+	}
+	__real_rtos_mem_free(p);
+}
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static void bench_send(struct bench_side *from, const uint8_t *data, uint16_t len)
+{
+	struct bench_dgram *d;
+
+	if (loss_permille) {
+		loss_seed = loss_seed * 1103515245u + 12345u;
+		if ((loss_seed >> 16) % 1000 < loss_permille) {
+			loss_drops++;
+			return;
+		}
+	}
+	if (queue_count == BENCH_QUEUE || len > BENCH_DGRAM_MAX) {
+		queue_full++;
+		return;
+	}
+	d = &bench_queue[(queue_head + queue_count) % BENCH_QUEUE];
+	d->to = from->peer;
+	d->len = len;
+	memcpy(d->data, data, len);
+	queue_count++;
+}
+
+/* param of build, parse and exec is always the calling side */
+static uint8_t bench_tx_cb(uint8_t *data, uint16_t len, sn_nsdl_addr_s *addr, void *param)
+{
+	struct bench_side *side = param;
+
+	side->lib_tx++;
+	bench_send(side, data, len);
+	return 1;
+}
+
+static int8_t bench_rx_cb(sn_coap_hdr_s *msg, sn_nsdl_addr_s *addr, void *param)
+{
+	if (msg->coap_status == COAP_STATUS_BUILDER_MESSAGE_SENDING_FAILED) {
+		exch_failed++;
+		if (outstanding[msg->msg_id]) {
+			outstanding[msg->msg_id] = 0;
+			exch_open--;
+		}
+	}
+	return 0;
+}
+
+/* hands every queued datagram, and those sent while handling it, to the parser of its side */
+static int bench_net_run(void)
+{
+	int moved = 0;
+
+	while (queue_count) {
+		struct bench_dgram *d = &bench_queue[queue_head];
+		struct bench_side *side = d->to;
+		sn_coap_hdr_s *msg;
+
+		queue_head = (queue_head + 1) % BENCH_QUEUE;
+		queue_count--;
+		bench_delivered++;
+		moved = 1;
+
+		heap_side = side;
+		msg = sn_coap_protocol_parse(side->coap, &side->peer->addr, d->len, d->data, side);
+		if (msg) {
+			side->app(side, msg);
+		}
+		heap_side = NULL;
+	}
+	return moved;
+}
+
+static void bench_exec(uint32_t now)
+{
+	heap_side = &bench_client;
+	sn_coap_protocol_exec(bench_client.coap, now);
+	heap_side = &bench_server;
+	sn_coap_protocol_exec(bench_server.coap, now);
+	heap_side = NULL;
+}
+
+static void bench_open(void (*client_app)(struct bench_side *, sn_coap_hdr_s *),
+					   void (*server_app)(struct bench_side *, sn_coap_hdr_s *))
+{
+	struct bench_side *sides[2] = { &bench_client, &bench_server };
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		struct bench_side *side = sides[i];
+
+		side->addr.type = SN_NSDL_ADDRESS_TYPE_IPV4;
+		side->addr.addr_len = sizeof(side->ip);
+		side->addr.addr_ptr = side->ip;
+		side->addr.port = 5683;
+		side->peer = sides[1 - i];
+		side->lib_tx = 0;
+		side->peak = side->live;
+		heap_side = side;
+		side->coap = coap_protocol_init(bench_tx_cb, bench_rx_cb);
+		heap_side = NULL;
+		bench_check(side->coap != NULL, "coap_protocol_init");
+	}
+	bench_client.app = client_app;
+	bench_server.app = server_app;
+	queue_head = 0;
+	queue_count = 0;
+	queue_full = 0;
+	bench_delivered = 0;
+	loss_drops = 0;
+}
+
+static void bench_close(void)
+{
+	heap_side = &bench_client;
+	sn_coap_protocol_destroy(bench_client.coap);
+	heap_side = &bench_server;
+	sn_coap_protocol_destroy(bench_server.coap);
+	heap_side = NULL;
+	bench_check(bench_client.live == 0 && bench_server.live == 0, "handles free everything on destroy");
+	bench_check(queue_full == 0, "datagram queue never overflows");
+}
+
+/* piggybacked response, or a message with no payload */
+static void bench_reply(struct bench_side *side, uint16_t msg_id, sn_coap_msg_code_e code, uint8_t *payload, uint16_t len)
+{
+	uint8_t buf[BENCH_DGRAM_MAX];
+	sn_coap_hdr_s *rsp = sn_coap_parser_alloc_message(side->coap);
+	int16_t n;
+
+	if (rsp == NULL) {
+		bench_check(0, "response allocation");
+		return;
+	}
+	rsp->msg_type = COAP_MSG_TYPE_ACKNOWLEDGEMENT;
+	rsp->msg_code = code;
+	rsp->msg_id = msg_id;
+	rsp->payload_ptr = payload;
+	rsp->payload_len = len;
+	prepare_blockwise_message(side->coap, rsp);
+	n = sn_coap_protocol_build(side->coap, &side->peer->addr, buf, rsp, side);
+	rsp->payload_ptr = NULL;
+	sn_coap_parser_release_allocated_coap_msg_mem(side->coap, rsp);
+	if (n <= 0) {
+		bench_check(0, "response build");
+		return;
+	}
+	bench_send(side, buf, n);
+}
+
+/*------------------------------------------------------------------*/
+/* confirmable exchanges */
+
+static void bench_exch_server(struct bench_side *side, sn_coap_hdr_s *msg)
+{
+	static uint8_t value[] = "21.5";
+
+	if (msg->coap_status == COAP_STATUS_PARSER_DUPLICATED_MSG) {
+		/* the response was lost, the stack only reports the repeat */
+		server_dups++;
+	}
+	if ((msg->coap_status == COAP_STATUS_OK || msg->coap_status == COAP_STATUS_PARSER_DUPLICATED_MSG) &&
+		msg->msg_type == COAP_MSG_TYPE_CONFIRMABLE && msg->msg_code == COAP_MSG_CODE_REQUEST_GET) {
+		bench_reply(side, msg->msg_id, COAP_MSG_CODE_RESPONSE_CONTENT, value, sizeof(value) - 1);
+	}
+	sn_coap_parser_release_allocated_coap_msg_mem(side->coap, msg);
+}
+
+static void bench_exch_client(struct bench_side *side, sn_coap_hdr_s *msg)
+{
+	if (msg->msg_type == COAP_MSG_TYPE_ACKNOWLEDGEMENT && msg->msg_code == COAP_MSG_CODE_RESPONSE_CONTENT) {
+		if (outstanding[msg->msg_id]) {
+			outstanding[msg->msg_id] = 0;
+			exch_open--;
+			exch_done++;
+		} else {
+			exch_stray++;
+		}
+	}
+	sn_coap_parser_release_allocated_coap_msg_mem(side->coap, msg);
+}
+
+static int bench_exch_request(void)
+{
+	static uint8_t path[] = "sensor/temp";
+	uint8_t buf[BENCH_DGRAM_MAX];
+	sn_coap_hdr_s req;
+	int16_t n;
+
+	sn_coap_parser_init_message(&req);
+	req.msg_type = COAP_MSG_TYPE_CONFIRMABLE;
+	req.msg_code = COAP_MSG_CODE_REQUEST_GET;
+	req.uri_path_ptr = path;
+	req.uri_path_len = sizeof(path) - 1;
+
+	heap_side = &bench_client;
+	n = sn_coap_protocol_build(bench_client.coap, &bench_server.addr, buf, &req, &bench_client);
+	heap_side = NULL;
+	if (n <= 0 || outstanding[req.msg_id]) {
+		return -1;
+	}
+	outstanding[req.msg_id] = 1;
+	exch_open++;
+	bench_send(&bench_client, buf, n);
+	return 0;
+}
+
+static void bench_exchanges(uint32_t window, uint32_t loss)
+{
+	uint32_t issued = 0;
+	uint32_t now = 0;
+	uint32_t progress_at = 0;
+	uint32_t progress_done = 0;
+	uint64_t t0, t1;
+	double s;
+
+	memset(outstanding, 0, sizeof(outstanding));
+	exch_open = exch_done = exch_stray = exch_failed = server_dups = 0;
+	bench_open(bench_exch_client, bench_exch_server);
+	loss_permille = loss;
+
+	t0 = bench_wall_ns();
+	while (exch_done + exch_failed < BENCH_EXCHANGES) {
+		while (exch_open < window && issued < BENCH_EXCHANGES) {
+			if (bench_exch_request() < 0) {
+				bench_check(0, "request build");
+				break;
+			}
+			issued++;
+		}
+		if (bench_net_run()) {
+			continue;
+		}
+		/* everything in flight was lost, let the clock run to the next resending */
+		if (exch_done != progress_done) {
+			progress_done = exch_done;
+			progress_at = now;
+		} else if (now - progress_at > BENCH_STALL_S) {
+			bench_check(0, "exchanges stalled");
+			break;
+		}
+		bench_exec(++now);
+	}
+	t1 = bench_wall_ns();
+	loss_permille = 0;
+
+	s = (double)(t1 - t0) / 1e9;
+	printf("window %3u loss %3.1f%%  %8.0f exch/s %8.0f dgram/s  peak client %7zu B server %7zu B  resent %4u dup %4u  %u s virtual\n",
+		   (unsigned int)window, loss / 10.0, exch_done / s, bench_delivered / s,
+		   bench_client.peak, bench_server.peak, (unsigned int)bench_client.lib_tx, (unsigned int)server_dups, (unsigned int)now);
+
+	bench_check(exch_done == BENCH_EXCHANGES, "every exchange completes");
+	bench_check(exch_open == 0 && exch_failed == 0, "no exchange left or failed");
+	bench_check(exch_stray == 0, "no response twice");
+	bench_check(loss || (bench_client.lib_tx == 0 && server_dups == 0), "no resending without loss");
+	bench_check(!loss || (loss_drops && bench_client.lib_tx >= loss_drops / 2 && server_dups), "losses are recovered by resending");
+	bench_close();
+}
+
+/*------------------------------------------------------------------*/
+/* block-wise transfers */
+
+static int8_t bench_block_cb(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint32_t offset, uint8_t *payload_ptr,
+							 uint16_t payload_len, uint8_t last, void *ctx)
+{
+	struct bench_stream *st = ctx;
+
+	if (offset + payload_len > st->len || memcmp(st->expect + offset, payload_ptr, payload_len) != 0) {
+		st->bad = 1;
+		return -1;
+	}
+	if (offset + payload_len > st->bytes) {
+		st->bytes = offset + payload_len;
+	}
+	st->last = last;
+	return 0;
+}
+
+static void bench_block_receiver(struct bench_side *side, FILE *file)
+{
+	memset(&block_stream, 0, sizeof(block_stream));
+	block_stream.expect = block_src;
+	block_stream.len = sizeof(block_src);
+	if (block_mode == BENCH_RX_STREAM) {
+		sn_coap_protocol_set_block_payload_callback(side->coap, bench_block_cb, &block_stream);
+	} else if (block_mode == BENCH_RX_FILE) {
+		sn_coap_protocol_set_block_payload_callback(side->coap, coap_block_file_sink, file);
+	}
+}
+
+/* the whole payload is in the message when stored, otherwise it was checked block by block */
+static void bench_block_received(struct bench_side *side, sn_coap_hdr_s *msg)
+{
+	block_done = 1;
+	if (block_mode == BENCH_RX_STORE) {
+		block_ok = msg->payload_len == sizeof(block_src) && memcmp(msg->payload_ptr, block_src, sizeof(block_src)) == 0;
+		side->coap->sn_coap_protocol_free(msg->payload_ptr);
+		msg->payload_ptr = NULL;
+	} else if (block_mode == BENCH_RX_STREAM) {
+		block_ok = !block_stream.bad && block_stream.last && block_stream.bytes == sizeof(block_src) && msg->payload_len == 0;
+	} else {
+		block_ok = msg->payload_len == 0;
+	}
+}
+
+static void bench_get_client(struct bench_side *side, sn_coap_hdr_s *msg)
+{
+	if (msg->coap_status == COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED) {
+		bench_block_received(side, msg);
+	}
+	sn_coap_parser_release_allocated_coap_msg_mem(side->coap, msg);
+}
+
+static void bench_get_server(struct bench_side *side, sn_coap_hdr_s *msg)
+{
+	if (msg->coap_status == COAP_STATUS_OK && msg->msg_code == COAP_MSG_CODE_REQUEST_GET) {
+		bench_reply(side, msg->msg_id, COAP_MSG_CODE_RESPONSE_CONTENT, block_src, sizeof(block_src));
+	}
+	sn_coap_parser_release_allocated_coap_msg_mem(side->coap, msg);
+}
+
+static void bench_put_client(struct bench_side *side, sn_coap_hdr_s *msg)
+{
+	if (msg->coap_status == COAP_STATUS_OK && msg->msg_code == COAP_MSG_CODE_RESPONSE_CHANGED) {
+		block_done = 1;
+	}
+	sn_coap_parser_release_allocated_coap_msg_mem(side->coap, msg);
+}
+
+static void bench_put_server(struct bench_side *side, sn_coap_hdr_s *msg)
+{
+	if (msg->coap_status == COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED) {
+		bench_block_received(side, msg);
+		/* the PUT is done when the client has the final response */
+		block_done = 0;
+		bench_reply(side, msg->msg_id, COAP_MSG_CODE_RESPONSE_CHANGED, NULL, 0);
+	}
+	sn_coap_parser_release_allocated_coap_msg_mem(side->coap, msg);
+}
+
+static int bench_block_start(int put, uint16_t block_size)
+{
+	static uint8_t path[] = "fw/image";
+	uint8_t buf[BENCH_DGRAM_MAX];
+	sn_coap_hdr_s *req;
+	int16_t n;
+
+	heap_side = &bench_client;
+	sn_coap_protocol_set_block_size(bench_client.coap, block_size);
+	heap_side = &bench_server;
+	sn_coap_protocol_set_block_size(bench_server.coap, block_size);
+
+	heap_side = &bench_client;
+	req = sn_coap_parser_alloc_message(bench_client.coap);
+	req->msg_type = COAP_MSG_TYPE_CONFIRMABLE;
+	req->msg_code = put ? COAP_MSG_CODE_REQUEST_PUT : COAP_MSG_CODE_REQUEST_GET;
+	if (put) {
+		req->payload_ptr = block_src;
+		req->payload_len = sizeof(block_src);
+		prepare_blockwise_message(bench_client.coap, req);
+	}
+	req->uri_path_ptr = path;
+	req->uri_path_len = sizeof(path) - 1;
+	n = sn_coap_protocol_build(bench_client.coap, &bench_server.addr, buf, req, &bench_client);
+	req->uri_path_ptr = NULL;
+	req->payload_ptr = NULL;
+	sn_coap_parser_release_allocated_coap_msg_mem(bench_client.coap, req);
+	heap_side = NULL;
+	if (n <= 0) {
+		return -1;
+	}
+	bench_send(&bench_client, buf, n);
+	return 0;
+}
+
+static size_t bench_blockwise(int put, uint16_t block_size, int mode, size_t store_peak)
+{
+	static const char *const mode_name[] = { "store", "stream", "file" };
+	struct bench_side *rx = put ? &bench_server : &bench_client;
+	uint64_t t0, t1;
+	size_t peak = 0;
+	uint32_t blocks = 0;
+	int ok = 1;
+	int round;
+
+	block_mode = mode;
+	t0 = bench_wall_ns();
+	for (round = 0; round < BENCH_BLOCK_ROUNDS; round++) {
+		FILE *file = mode == BENCH_RX_FILE ? tmpfile() : NULL;
+
+		bench_open(put ? bench_put_client : bench_get_client, put ? bench_put_server : bench_get_server);
+		bench_block_receiver(rx, file);
+		block_done = 0;
+		block_ok = 0;
+		if (bench_block_start(put, block_size) < 0) {
+			bench_check(0, "block-wise request build");
+		}
+		while (bench_net_run()) {
+		}
+		if (file) {
+			static uint8_t back[BENCH_BLOCK_PAYLOAD];
+
+			rewind(file);
+			block_ok = block_ok && fread(back, 1, sizeof(back), file) == sizeof(back) && fgetc(file) == EOF &&
+					   memcmp(back, block_src, sizeof(back)) == 0;
+			fclose(file);
+		}
+		ok = ok && block_done && block_ok;
+		blocks = bench_delivered;
+		if (rx->peak > peak) {
+			peak = rx->peak;
+		}
+		bench_close();
+	}
+	t1 = bench_wall_ns();
+
+	printf("%-5s %4u B blocks %-6s %7.2f MB/s  %4u datagrams  receiver peak %6zu B\n", put ? "PUT" : "GET",
+		   (unsigned int)block_size, mode_name[mode], (double)sizeof(block_src) * BENCH_BLOCK_ROUNDS / ((double)(t1 - t0) / 1e9) / 1e6,
+		   (unsigned int)blocks, peak);
+
+	bench_check(ok, "block-wise payload received intact");
+	if (mode != BENCH_RX_STORE) {
+		/* only the blocks in flight and the stack state, never the payload */
+		bench_check(peak + sizeof(block_src) <= store_peak, "streaming receiver does not hold the payload");
+	}
+	return peak;
+}
+
+int main(void)
+{
+	static const uint16_t block_sizes[] = { 64, 1024 };
+	static const uint32_t windows[] = { 1, 16, 255 };
+	size_t i, j;
+
+	bench_queue = malloc(sizeof(*bench_queue) * BENCH_QUEUE);
+	if (bench_queue == NULL) {
+		return 1;
+	}
+	for (i = 0; i < sizeof(block_src); i++) {
+		block_src[i] = (uint8_t)(i * 131 + (i >> 8));
+	}
+
+	printf("%u confirmable GET exchanges\n", BENCH_EXCHANGES);
+	for (i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+		bench_exchanges(windows[i], 0);
+	}
+	bench_exchanges(255, 10);
+
+	printf("%u B block-wise payload, %u transfers\n", BENCH_BLOCK_PAYLOAD, BENCH_BLOCK_ROUNDS);
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < sizeof(block_sizes) / sizeof(block_sizes[0]); j++) {
+			size_t store_peak = bench_blockwise(i, block_sizes[j], BENCH_RX_STORE, 0);
+
+			bench_blockwise(i, block_sizes[j], BENCH_RX_STREAM, store_peak);
+			bench_blockwise(i, block_sizes[j], BENCH_RX_FILE, store_peak);
+		}
+	}
+
+	free(bench_queue);
+	printf(bench_fail ? "FAIL\n" : "done\n");
+	return bench_fail;
+}
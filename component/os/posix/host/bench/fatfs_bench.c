@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * FatFs through the vfs_fatfs file operations on a RAM disk standing in for the flash drive,
+ * with the sector cache in front as on the target. Logs of 100 byte records are appended and
+ * an earlier record is read back after every append, which is how the cluster link map of a
+ * growing file gets used. Reports driver commands, FAT sectors read and host time per append
+ * and read back, for one log and for two logs appended in turn (one fragment per cluster, the
+ * second run outgrows the largest map), then checks every record and that the map of each file matches the chain on the disk.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "vfs.h"
+#include "vfs_fatfs.h"
+#include "ff.h"
+
+#define BENCH_SECTORS			(128 * 1024)	/* 64 MB, FAT32 with one sector per cluster */
+#define BENCH_REC_LEN			100
+#define BENCH_ROUNDS			2000
+#define BENCH_LOGS_MAX			2
+
+static uint8_t *ram;
+static FATFS bench_fs;
+static int bench_fail;
+
+static struct {
+	uint32_t read_cmds;
+	uint32_t write_cmds;
+	uint32_t fat_sectors;		/* sectors of the FAT read by the driver */
+} drv_stats;
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static DSTATUS ram_disk_initialize(void)
+{
+	return 0;
+}
+
+static DSTATUS ram_disk_deinitialize(void)
+{
+	return 0;
+}
+
+static DSTATUS ram_disk_status(void)
+{
+	return 0;
+}
+
+static DRESULT ram_disk_read(BYTE *buff, DWORD sector, UINT count)
+{
+	LBA_t fat_end = bench_fs.fatbase + (LBA_t)bench_fs.fsize * bench_fs.n_fats;
+	UINT i;
+
+	if (sector + count > BENCH_SECTORS) {
+		return RES_PARERR;
+	}
+	drv_stats.read_cmds++;
+	for (i = 0; i < count; i++) {
+		if (bench_fs.fs_type && sector + i >= bench_fs.fatbase && sector + i < fat_end) {
+			drv_stats.fat_sectors++;
+		}
+	}
+	memcpy(buff, ram + (size_t)sector * FF_MAX_SS, (size_t)count * FF_MAX_SS);
+	return RES_OK;
+}
+
+static DRESULT ram_disk_write(const BYTE *buff, DWORD sector, UINT count)
+{
+	if (sector + count > BENCH_SECTORS) {
+		return RES_PARERR;
+	}
+	drv_stats.write_cmds++;
+	memcpy(ram + (size_t)sector * FF_MAX_SS, buff, (size_t)count * FF_MAX_SS);
+	return RES_OK;
+}
+
+static DRESULT ram_disk_ioctl(BYTE cmd, void *buff)
+{
+	switch (cmd) {
+	case CTRL_SYNC:
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t *)buff = BENCH_SECTORS;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = FF_MAX_SS;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = 1;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+static ll_diskio_drv ram_disk_driver = {
+	.disk_initialize = ram_disk_initialize,
+	.disk_deinitialize = ram_disk_deinitialize,
+	.disk_status = ram_disk_status,
+	.disk_read = ram_disk_read,
+	.disk_write = ram_disk_write,
+	.disk_ioctl = ram_disk_ioctl,
+	.TAG = (unsigned char *)"FLASH",
+	.cache_en = 1,
+};
+
+/* what fatfs_flash.c does on the target, on the RAM disk */
+int fatfs_flash_init(int interface)
+{
+	static const MKFS_PARM opt = { FM_FAT32 | FM_SFD, 1, 0, 0, FF_MAX_SS };
+	static BYTE work[FF_MAX_SS];
+	char path[12];
+	int drv_num;
+
+	(void) interface;
+	drv_num = FATFS_RegisterDiskDriver(&ram_disk_driver);
+	if (drv_num < 0) {
+		return -1;
+	}
+	snprintf(path, sizeof(path), "%d:", drv_num);
+	if (f_mkfs(path, &opt, work, sizeof(work)) != FR_OK || f_mount(&bench_fs, path, 1) != FR_OK) {
+		return -1;
+	}
+	return 0;
+}
+
+int fatfs_flash_close(int interface)
+{
+	(void) interface;
+	f_mount(NULL, "0:", 1);
+	return FATFS_UnRegisterDiskDriver(ram_disk_driver.drv_num);
+}
+
+static void bench_record(uint8_t *rec, uint32_t seq)
+{
+	uint32_t i;
+
+	memcpy(rec, &seq, sizeof(seq));
+	for (i = sizeof(seq); i < BENCH_REC_LEN; i++) {
+		rec[i] = (uint8_t)(seq * 7 + i);
+	}
+}
+
+/* the map of the file against a fresh walk of its chain */
+static void bench_check_map(vfs_file *finfo)
+{
+	FIL *fil = (FIL *)finfo->file;
+	DWORD *cltbl = fil->cltbl;
+	static DWORD fresh[4096];
+	DWORD i;
+
+	if (cltbl == NULL) {
+		return;
+	}
+	fresh[0] = sizeof(fresh) / sizeof(fresh[0]);
+	fil->cltbl = fresh;
+	bench_check(f_lseek(fil, CREATE_LINKMAP) == FR_OK, "walk the chain");
+	fil->cltbl = cltbl;
+	bench_check(cltbl[0] == fresh[0], "map size");
+	for (i = 1; i < fresh[0] && i < cltbl[0]; i++) {
+		if (cltbl[i] != fresh[i]) {
+			bench_check(0, "map matches the chain");
+			break;
+		}
+	}
+}
+
+/* every record of a log in order */
+static void bench_check_log(vfs_file *finfo, uint32_t recs)
+{
+	uint8_t rec[BENCH_REC_LEN], expect[BENCH_REC_LEN];
+	uint32_t seq;
+
+	fatfs_drv.seek(NULL, 0, SEEK_SET, finfo);
+	for (seq = 0; seq < recs; seq++) {
+		bench_record(expect, seq);
+		if (fatfs_drv.read(NULL, rec, 1, BENCH_REC_LEN, finfo) != BENCH_REC_LEN || memcmp(rec, expect, BENCH_REC_LEN)) {
+			bench_check(0, "log read back in order");
+			return;
+		}
+	}
+}
+
+static void bench_logs(int logs, uint32_t prefill_bytes)
+{
+	static vfs_file files[BENCH_LOGS_MAX];
+	uint8_t rec[BENCH_REC_LEN], expect[BENCH_REC_LEN];
+	uint32_t recs[BENCH_LOGS_MAX];
+	uint32_t prefill = prefill_bytes / BENCH_REC_LEN;
+	uint32_t n, seq;
+	uint64_t wall;
+	char name[24];
+	int i;
+
+	for (i = 0; i < logs; i++) {
+		snprintf(name, sizeof(name), "0:/log%d.txt", i);
+		bench_check(fatfs_drv.open(NULL, name, "w+", &files[i]) == 0, "open log");
+		recs[i] = 0;
+	}
+	/* prefill in turn, so with two logs every cluster is a fragment of its own */
+	for (n = 0; n < prefill; n++) {
+		for (i = 0; i < logs; i++) {
+			bench_record(rec, recs[i]++);
+			bench_check(fatfs_drv.write(NULL, rec, 1, BENCH_REC_LEN, &files[i]) == BENCH_REC_LEN, "prefill");
+		}
+	}
+	for (i = 0; i < logs; i++) {
+		fatfs_drv.fflush(NULL, &files[i]);
+	}
+
+	srand(1);
+	memset(&drv_stats, 0, sizeof(drv_stats));
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_ROUNDS; n++) {
+		i = n % logs;
+		fatfs_drv.seek(NULL, 0, SEEK_END, &files[i]);
+		bench_record(rec, recs[i]);
+		bench_check(fatfs_drv.write(NULL, rec, 1, BENCH_REC_LEN, &files[i]) == BENCH_REC_LEN, "append");
+		recs[i]++;
+
+		seq = (uint32_t)rand() % recs[i];
+		fatfs_drv.seek(NULL, seq * BENCH_REC_LEN, SEEK_SET, &files[i]);
+		bench_record(expect, seq);
+		if (fatfs_drv.read(NULL, rec, 1, BENCH_REC_LEN, &files[i]) != BENCH_REC_LEN || memcmp(rec, expect, BENCH_REC_LEN)) {
+			bench_check(0, "record read back");
+		}
+	}
+	for (i = 0; i < logs; i++) {
+		fatfs_drv.fflush(NULL, &files[i]);
+	}
+	wall = bench_wall_ns() - wall;
+
+	printf("%-5d %7u KB %9.2f %9.2f %11.2f %9.0f %6s\n", logs,
+		   (unsigned)(prefill_bytes / 1024), (double)drv_stats.read_cmds / BENCH_ROUNDS, (double)drv_stats.write_cmds / BENCH_ROUNDS,
+		   (double)drv_stats.fat_sectors / BENCH_ROUNDS, (double)wall / BENCH_ROUNDS,
+		   ((FIL *)files[0].file)->cltbl ? "yes" : "no");
+
+	for (i = 0; i < logs; i++) {
+		bench_check_map(&files[i]);
+		bench_check_log(&files[i], recs[i]);
+		fatfs_drv.close(NULL, &files[i]);
+		snprintf(name, sizeof(name), "0:/log%d.txt", i);
+		fatfs_drv.remove(NULL, name);
+	}
+}
+
+int main(void)
+{
+	ram = calloc(BENCH_SECTORS, FF_MAX_SS);
+	if (ram == NULL || fatfs_drv.mount(VFS_INF_FLASH) != 0) {
+		printf("FAIL: mount\n");
+		return 1;
+	}
+
+	printf("%-5s %10s %9s %9s %11s %9s %6s\n", "logs", "prefill", "rd cmd", "wr cmd", "FAT sectors", "ns", "map");
+	bench_logs(1, 1024 * 1024);
+	/* small enough for the map to hold one fragment per cluster, then outgrowing it */
+	bench_logs(2, 64 * 1024);
+	bench_logs(2, 192 * 1024);
+
+	fatfs_drv.unmount(VFS_INF_FLASH);
+	free(ram);
+	printf(bench_fail ? "FAIL\n" : "done\n");
+	return bench_fail;
+}
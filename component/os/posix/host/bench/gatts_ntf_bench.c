@@ -0,0 +1,755 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * GATT server notification channels against a simulated lower stack. The lower stack owns a pool
+ * of LE credits: a notification handed to it takes one, is checked for order and content per link,
+ * and comes back as a send data complete message to the BT API task, which returns the credit and
+ * runs the completion the way _send_data_complete_cb does. The bench checks ordering across ring
+ * wraps, queue full and credit stalls, sharing between links, refusals and disconnection, then
+ * measures notifications per second for several MTUs and connection counts against a model of the
+ * command path: a BT API command round trip per notification, a copy into a request in the API
+ * task, a retry when out of credits and a complete event handed to an event task.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "osif.h"
+#include "app_msg.h"
+#include "gap_le.h"
+#include "bt_types.h"
+#include "rtk_bt_common.h"
+#include "rtk_bt_gatts_ntf_chan.h"
+#include "rtk_stack_internal.h"
+
+#define BENCH_STACK_SIZE		8192
+#define BENCH_CONN_NUM			(RTK_BT_GATTS_NTF_CHAN_NUM + 1)
+#define BENCH_CONN_HANDLE(id)	((uint16_t)(0x0010 + (id)))
+#define BENCH_APP_ID			3
+#define BENCH_INDEX				5
+#define BENCH_CREDITS			10
+#define BENCH_RING_SIZE			8192
+#define BENCH_BATCH				4
+#define BENCH_ROUNDS			100000
+
+/* subtypes of IO_MSG_TYPE_API_SYS_CALL besides the stack ones */
+#define BENCH_MSG_CMD			0
+#define BENCH_MSG_COMPLETE		1
+#define BENCH_MSG_PAUSE			2
+#define BENCH_MSG_DISCONNECT	3
+
+/* a send data complete: conn_id, cause, index and the tag of the notification packed in the message,
+ * the tag is only known to the simulation, to check which notification a completion was matched to */
+#define BENCH_COMPLETE(conn_id, cause, index, tag)	\
+	((void *)(uintptr_t)(((conn_id) << 24) | ((cause) << 16) | ((tag) << 8) | (index)))
+
+struct bench_msg {
+	uint16_t type;
+	uint16_t subtype;
+	void *buf;
+};
+
+/* a RTK_BT_GATTS_ACT_NOTIFY command, sent and waited for like rtk_bt_send_cmd */
+struct bench_cmd {
+	uint16_t conn_handle;
+	uint16_t len;
+	uint8_t *data;
+	uint16_t ret;
+	rtos_sema_t done;
+};
+
+/* a rtk_bt_gatts_req_t on the sent list of a link */
+struct bench_req {
+	struct bench_req *next;
+	uint16_t app_id;
+	uint16_t index;
+	uint16_t len;
+	uint8_t tag;
+	uint8_t data[];
+};
+
+/* a RTK_BT_GATTS_EVT_NOTIFY_COMPLETE_IND */
+struct bench_evt {
+	uint16_t conn_handle;
+	uint16_t app_id;
+	uint16_t index;
+	uint16_t err_code;
+};
+
+static struct {
+	uint16_t credits;
+	uint16_t next_seq[BENCH_CONN_NUM];
+	uint8_t ntf_tag[BENCH_CONN_NUM];
+	uint8_t connected[BENCH_CONN_NUM];
+	uint32_t refuse_mod;			/* refuse the notifications whose sequence number is a multiple of it */
+	uint32_t tx_num;
+	uint32_t tx_bytes;
+	uint32_t tx_bad;
+	uint32_t complete_num;
+	uint8_t last_conn_id;			/* conn_id of the notification before */
+	uint32_t switch_num;			/* notifications on the air from another link than the one before */
+	struct bench_req *sent[BENCH_CONN_NUM];
+	struct bench_req **sent_tail[BENCH_CONN_NUM];
+} sim;
+
+static rtos_queue_t api_q;
+static rtos_queue_t evt_q;
+static rtos_sema_t api_resume;
+static rtos_sema_t bench_done;
+static uint32_t evt_num;
+static int bench_fail;
+static volatile int close_race_run;
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static inline uint8_t bench_pattern(uint16_t seq, uint16_t i)
+{
+	return (uint8_t)(seq * 7 + i);
+}
+
+/* a value carries its sequence number and length, then the pattern */
+static void bench_fill(uint8_t *p_value, uint16_t seq, uint16_t len)
+{
+	uint16_t i;
+
+	p_value[0] = (uint8_t)seq;
+	if (len > 1) {
+		p_value[1] = (uint8_t)(seq >> 8);
+	}
+	if (len > 2) {
+		p_value[2] = (uint8_t)len;
+	}
+	for (i = 3; i < len; i++) {
+		p_value[i] = bench_pattern(seq, i);
+	}
+}
+
+uint16_t bt_stack_le_gap_get_conn_id(uint16_t conn_handle, uint8_t *p_conn_id)
+{
+	uint8_t conn_id = (uint8_t)(conn_handle - BENCH_CONN_HANDLE(0));
+
+	if (conn_id >= BENCH_CONN_NUM || !sim.connected[conn_id]) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	*p_conn_id = conn_id;
+	return RTK_BT_OK;
+}
+
+T_GAP_CAUSE le_get_gap_param(T_GAP_LE_PARAM_TYPE param, void *p_value)
+{
+	if (param != GAP_PARAM_LE_REMAIN_CREDITS) {
+		return GAP_CAUSE_INVALID_PARAM;
+	}
+	*(uint16_t *)p_value = sim.credits;
+	return GAP_CAUSE_SUCCESS;
+}
+
+/* BT API task: drain messages, commands and the lower stack messages */
+uint16_t bt_stack_msg_send(uint16_t type, uint16_t subtype, void *msg)
+{
+	struct bench_msg m = { type, subtype, msg };
+
+	return rtos_queue_send(api_q, &m, 0) == RTK_SUCCESS ? RTK_BT_OK : RTK_BT_ERR_OS_OPERATION;
+}
+
+/* lower stack: a notification takes a credit, its content and order are checked on the air */
+uint16_t bt_stack_gatts_send_value(uint16_t conn_handle, uint16_t cid, uint16_t app_id, uint16_t index,
+								   uint8_t *data, uint16_t len, bool notify, uint8_t *p_tag)
+{
+	uint8_t conn_id;
+	uint16_t seq, i;
+
+	if (bt_stack_le_gap_get_conn_id(conn_handle, &conn_id) != RTK_BT_OK) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	if (!sim.credits) {
+		sim.tx_bad++;
+		return RTK_BT_ERR_NO_CREDITS;
+	}
+	seq = (uint16_t)(data[0] | (len > 1 ? data[1] << 8 : 0));
+	if (cid != L2C_FIXED_CID_ATT || app_id != BENCH_APP_ID || index != BENCH_INDEX || !notify ||
+		seq != sim.next_seq[conn_id] || (len > 2 && data[2] != (uint8_t)len)) {
+		sim.tx_bad++;
+	}
+	for (i = 3; i < len; i++) {
+		if (data[i] != bench_pattern(seq, i)) {
+			sim.tx_bad++;
+			break;
+		}
+	}
+	sim.next_seq[conn_id] = seq + 1;
+	if (sim.refuse_mod && seq % sim.refuse_mod == 0) {
+		return RTK_BT_ERR_LOWER_STACK_API;
+	}
+
+	sim.credits--;
+	sim.tx_num++;
+	sim.tx_bytes += len;
+	sim.switch_num += conn_id != sim.last_conn_id;
+	sim.last_conn_id = conn_id;
+	*p_tag = sim.ntf_tag[conn_id]++;
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_COMPLETE, BENCH_COMPLETE(conn_id, 0, index, *p_tag));
+	return RTK_BT_OK;
+}
+
+/* what bt_stack_gatts_send_data does for a notification */
+static uint16_t bench_legacy_send(struct bench_cmd *p_cmd)
+{
+	uint8_t conn_id;
+	struct bench_req *req;
+	uint16_t ret;
+
+	if (bt_stack_le_gap_get_conn_id(p_cmd->conn_handle, &conn_id) != RTK_BT_OK) {
+		return RTK_BT_ERR_PARAM_INVALID;
+	}
+	req = malloc(sizeof(*req) + p_cmd->len);
+	req->next = NULL;
+	req->app_id = BENCH_APP_ID;
+	req->index = BENCH_INDEX;
+	req->len = p_cmd->len;
+	memcpy(req->data, p_cmd->data, p_cmd->len);
+	if (!sim.credits) {
+		free(req);
+		return RTK_BT_ERR_NO_CREDITS;
+	}
+	ret = bt_stack_gatts_send_value(p_cmd->conn_handle, L2C_FIXED_CID_ATT, req->app_id, req->index, req->data, req->len, true,
+									&req->tag);
+	if (ret != RTK_BT_OK) {
+		free(req);
+		return ret;
+	}
+	*sim.sent_tail[conn_id] = req;
+	sim.sent_tail[conn_id] = &req->next;
+	return RTK_BT_OK;
+}
+
+/* what _send_data_complete_cb does for a notification */
+static void bench_complete(uint8_t conn_id, uint16_t cause, uint16_t index, uint8_t tag)
+{
+	struct bench_req *req = sim.sent[conn_id];
+	struct bench_evt *p_evt;
+	uint8_t chan_tag;
+
+	sim.credits++;
+	/* bt_stack_gatts_ntf_is_chan: the channel one when it was sent before the command one */
+	if (bt_stack_gatts_ntf_chan_oldest(conn_id, BENCH_APP_ID, index, &chan_tag) &&
+		(!req || req->index != index || (int8_t)(chan_tag - req->tag) < 0)) {
+		bench_check(chan_tag == tag, "channel completion for its notification");
+		bench_check(bt_stack_gatts_ntf_chan_sent(conn_id, BENCH_APP_ID, index, cause), "channel completion matched");
+		sim.complete_num++;
+		return;
+	}
+	if (!req || req->index != index) {
+		/* a close drops the records of the notifications still on the air */
+		bench_check(close_race_run, "completion matched");
+		sim.complete_num++;
+		return;
+	}
+	bench_check(req->tag == tag, "command completion for its notification");
+
+	sim.sent[conn_id] = req->next;
+	if (!req->next) {
+		sim.sent_tail[conn_id] = &sim.sent[conn_id];
+	}
+	p_evt = malloc(sizeof(*p_evt));
+	p_evt->conn_handle = BENCH_CONN_HANDLE(conn_id);
+	p_evt->app_id = req->app_id;
+	p_evt->index = req->index;
+	p_evt->err_code = cause;
+	free(req);
+	rtos_queue_send(evt_q, &p_evt, RTOS_MAX_DELAY);
+	bt_stack_gatts_ntf_chan_drain();
+	sim.complete_num++;
+}
+
+static void bench_api_task(void *param)
+{
+	struct bench_cmd *p_cmd;
+	struct bench_msg m;
+	uintptr_t c;
+
+	(void) param;
+	for (;;) {
+		rtos_queue_receive(api_q, &m, RTOS_MAX_DELAY);
+		if (m.subtype == RTK_BT_API_TASK_EXIT) {
+			break;
+		}
+		switch (m.subtype) {
+		case RTK_BT_API_TASK_GATTS_NTF:
+			bt_stack_gatts_ntf_chan_drain();
+			break;
+		case BENCH_MSG_COMPLETE:
+			c = (uintptr_t)m.buf;
+			bench_complete((uint8_t)(c >> 24), (uint16_t)((c >> 16) & 0xFF), (uint16_t)(c & 0xFF), (uint8_t)(c >> 8));
+			break;
+		case BENCH_MSG_PAUSE:
+			rtos_sema_take(api_resume, RTOS_MAX_DELAY);
+			break;
+		case BENCH_MSG_DISCONNECT:
+			/* what the disconnect of a link does in bt_stack_gatts_disconnect_queue_clear */
+			bt_stack_gatts_ntf_chan_disconnect((uint8_t)(uintptr_t)m.buf);
+			break;
+		default:
+			p_cmd = (struct bench_cmd *)m.buf;
+			p_cmd->ret = bench_legacy_send(p_cmd);
+			rtos_sema_give(p_cmd->done);
+			break;
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_evt_task(void *param)
+{
+	struct bench_evt *p_evt;
+
+	(void) param;
+	for (;;) {
+		rtos_queue_receive(evt_q, &p_evt, RTOS_MAX_DELAY);
+		if (p_evt == NULL) {
+			break;
+		}
+		free(p_evt);
+		__atomic_fetch_add(&evt_num, 1, __ATOMIC_RELEASE);
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+/* run the API task until it has nothing left, with the lower stack completing everything */
+static void bench_wait_sent(uint32_t tx_num)
+{
+	while (__atomic_load_n(&sim.tx_num, __ATOMIC_ACQUIRE) < tx_num ||
+		   __atomic_load_n(&sim.complete_num, __ATOMIC_ACQUIRE) < tx_num) {
+		rtos_task_yield();
+	}
+}
+
+static void bench_reset(void)
+{
+	uint8_t i;
+
+	memset(&sim, 0, sizeof(sim));
+	for (i = 0; i < BENCH_CONN_NUM; i++) {
+		sim.connected[i] = 1;
+		sim.sent_tail[i] = &sim.sent[i];
+	}
+	sim.credits = BENCH_CREDITS;
+}
+
+/* reserve, retrying while the ring is full */
+static uint8_t *bench_reserve(uint16_t conn_handle, uint16_t len)
+{
+	uint8_t *p_value;
+	uint16_t ret;
+
+	while ((ret = rtk_bt_gatts_ntf_chan_reserve(conn_handle, BENCH_APP_ID, BENCH_INDEX, len, &p_value)) == RTK_BT_ERR_QUEUE_FULL) {
+		rtk_bt_gatts_ntf_chan_commit(conn_handle);
+		rtos_task_yield();
+	}
+	bench_check(ret == RTK_BT_OK, "reserve");
+	return ret == RTK_BT_OK ? p_value : NULL;
+}
+
+static void bench_verify_params(void)
+{
+	uint8_t *p_value;
+	uint8_t i;
+
+	bench_check(rtk_bt_gatts_ntf_chan_open(0x0FFF, 0, 256) == RTK_BT_ERR_NO_CONNECTION, "open without link");
+	bench_check(rtk_bt_gatts_ntf_chan_open(BENCH_CONN_HANDLE(0), 0, 0xFFFF) == RTK_BT_ERR_PARAM_INVALID, "ring too large");
+	for (i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		bench_check(rtk_bt_gatts_ntf_chan_open(BENCH_CONN_HANDLE(i), 0, 100) == RTK_BT_OK, "open");
+	}
+	bench_check(rtk_bt_gatts_ntf_chan_open(BENCH_CONN_HANDLE(0), 0, 100) == RTK_BT_ERR_ALREADY_DONE, "open twice");
+	bench_check(rtk_bt_gatts_ntf_chan_open(BENCH_CONN_HANDLE(i), 0, 100) == RTK_BT_ERR_NO_RESOURCE, "no channel left");
+
+	/* 100 rounds up to 128, half of it is the largest record */
+	bench_check(rtk_bt_gatts_ntf_chan_reserve(BENCH_CONN_HANDLE(0), BENCH_APP_ID, BENCH_INDEX, 0, &p_value) ==
+				RTK_BT_ERR_PARAM_INVALID, "empty value");
+	bench_check(rtk_bt_gatts_ntf_chan_reserve(BENCH_CONN_HANDLE(0), BENCH_APP_ID, BENCH_INDEX, 57, &p_value) ==
+				RTK_BT_ERR_PARAM_INVALID, "value over half the ring");
+	bench_check(rtk_bt_gatts_ntf_chan_reserve(BENCH_CONN_HANDLE(0), BENCH_APP_ID, BENCH_INDEX, 56, &p_value) ==
+				RTK_BT_OK, "value of half the ring");
+	bench_check(rtk_bt_gatts_ntf_chan_reserve(BENCH_CONN_HANDLE(i), BENCH_APP_ID, BENCH_INDEX, 8, &p_value) ==
+				RTK_BT_ERR_NO_ENTRY, "reserve without channel");
+
+	/* reserved and not committed is dropped with the channel */
+	for (i = 0; i < RTK_BT_GATTS_NTF_CHAN_NUM; i++) {
+		bench_check(rtk_bt_gatts_ntf_chan_close(BENCH_CONN_HANDLE(i)) == RTK_BT_OK, "close");
+	}
+	bench_check(rtk_bt_gatts_ntf_chan_close(BENCH_CONN_HANDLE(0)) == RTK_BT_ERR_NO_ENTRY, "close twice");
+	bench_check(sim.tx_num == 0, "nothing sent without commit");
+}
+
+/* one link, a small ring and few credits: wraps, pads, queue full and credit stalls */
+static void bench_verify_order(void)
+{
+	rtk_bt_gatts_ntf_chan_stats_t stats;
+	uint16_t conn_handle = BENCH_CONN_HANDLE(0);
+	uint16_t seq, len;
+	uint32_t bytes = 0;
+	uint8_t *p_value;
+
+	bench_reset();
+	sim.credits = 2;
+	bench_check(rtk_bt_gatts_ntf_chan_open(conn_handle, 0, 256) == RTK_BT_OK, "open");
+	for (seq = 0; seq < 2000; seq++) {
+		len = (uint16_t)(3 + (seq * 13) % 100);
+		p_value = bench_reserve(conn_handle, len);
+		if (!p_value) {
+			break;
+		}
+		bench_fill(p_value, seq, len);
+		bytes += len;
+		if (seq % 5 == 4) {
+			rtk_bt_gatts_ntf_chan_commit(conn_handle);
+		}
+	}
+	rtk_bt_gatts_ntf_chan_commit(conn_handle);
+	bench_wait_sent(2000);
+
+	bench_check(rtk_bt_gatts_ntf_chan_stats_get(conn_handle, &stats, true) == RTK_BT_OK, "stats");
+	bench_check(sim.tx_bad == 0 && sim.tx_num == 2000 && sim.tx_bytes == bytes, "on the air in order and intact");
+	bench_check(stats.queued_num == 2000 && stats.sent_num == 2000 && stats.complete_num == 2000 &&
+				stats.fail_num == 0 && stats.sent_bytes == bytes, "sent counters");
+	bench_check(stats.queue_full_num > 0 && stats.credit_stall_num > 0, "queue full and credit stalls counted");
+	bench_check(stats.queue_bytes == 0 && stats.queue_bytes_max <= 256, "ring usage");
+	printf("%-22s %u sent in %u commits, %u refused full, %u credit stalls, ring %u of 256 bytes\n", "ordering",
+		   (unsigned)stats.sent_num, (unsigned)stats.commit_num, (unsigned)stats.queue_full_num,
+		   (unsigned)stats.credit_stall_num, (unsigned)stats.queue_bytes_max);
+
+	/* the lower stack refusing a notification does not stop the ring */
+	sim.refuse_mod = 10;
+	for (seq = 2000; seq < 2100; seq++) {
+		p_value = bench_reserve(conn_handle, 20);
+		if (p_value) {
+			bench_fill(p_value, seq, 20);
+		}
+		rtk_bt_gatts_ntf_chan_commit(conn_handle);
+	}
+	bench_wait_sent(2090);
+	rtk_bt_gatts_ntf_chan_stats_get(conn_handle, &stats, false);
+	bench_check(stats.sent_num == 90 && stats.fail_num == 10 && stats.complete_num == 90 && stats.queue_bytes == 0,
+				"refused notifications dropped");
+	sim.refuse_mod = 0;
+
+	bench_check(rtk_bt_gatts_ntf_chan_close(conn_handle) == RTK_BT_OK, "close");
+}
+
+/* two links backlogged while the API task waits, one credit given back at a time */
+static void bench_verify_share(void)
+{
+	rtk_bt_gatts_ntf_chan_stats_t stats[2];
+	uint8_t *p_value;
+	uint16_t seq;
+	uint8_t i;
+
+	bench_reset();
+	sim.credits = 1;
+	for (i = 0; i < 2; i++) {
+		rtk_bt_gatts_ntf_chan_open(BENCH_CONN_HANDLE(i), 0, 1024);
+	}
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_PAUSE, NULL);
+	for (seq = 0; seq < 20; seq++) {
+		for (i = 0; i < 2; i++) {
+			p_value = bench_reserve(BENCH_CONN_HANDLE(i), 30);
+			bench_fill(p_value, seq, 30);
+		}
+	}
+	for (i = 0; i < 2; i++) {
+		rtk_bt_gatts_ntf_chan_commit(BENCH_CONN_HANDLE(i));
+	}
+	rtos_sema_give(api_resume);
+	bench_wait_sent(40);
+
+	for (i = 0; i < 2; i++) {
+		rtk_bt_gatts_ntf_chan_stats_get(BENCH_CONN_HANDLE(i), &stats[i], false);
+		rtk_bt_gatts_ntf_chan_close(BENCH_CONN_HANDLE(i));
+	}
+	bench_check(sim.tx_bad == 0 && stats[0].complete_num == 20 && stats[1].complete_num == 20, "both links sent");
+	/* either link may go first */
+	bench_check(sim.switch_num >= 39, "links take turns for the credit");
+	printf("%-22s %u of %u notifications from the other link\n", "sharing", (unsigned)sim.switch_num,
+		   (unsigned)sim.tx_num);
+}
+
+/* a channel and the BT API command notifying the same attribute on one link, the command sent while
+ * the channel notification before it is on the air: each completion goes to the one sent first */
+static void bench_verify_mixed(void)
+{
+	rtk_bt_gatts_ntf_chan_stats_t stats;
+	uint16_t conn_handle = BENCH_CONN_HANDLE(0);
+	static uint8_t value[20];
+	struct bench_cmd cmd;
+	uint8_t *p_value;
+	uint16_t seq;
+
+	bench_reset();
+	rtos_sema_create_binary(&cmd.done);
+	evt_num = 0;
+	rtk_bt_gatts_ntf_chan_open(conn_handle, 0, 1024);
+	for (seq = 0; seq < 200; seq += 2) {
+		/* the drain of the commit runs before the command, both are completed after them */
+		bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_PAUSE, NULL);
+		p_value = bench_reserve(conn_handle, sizeof(value));
+		bench_fill(p_value, seq, sizeof(value));
+		rtk_bt_gatts_ntf_chan_commit(conn_handle);
+		bench_fill(value, seq + 1, sizeof(value));
+		cmd.conn_handle = conn_handle;
+		cmd.len = sizeof(value);
+		cmd.data = value;
+		bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_CMD, &cmd);
+		rtos_sema_give(api_resume);
+		rtos_sema_take(cmd.done, RTOS_MAX_DELAY);
+		bench_check(cmd.ret == RTK_BT_OK, "notify command");
+	}
+	bench_wait_sent(200);
+	while (__atomic_load_n(&evt_num, __ATOMIC_ACQUIRE) < 100) {
+		rtos_task_yield();
+	}
+	rtos_sema_delete(cmd.done);
+
+	rtk_bt_gatts_ntf_chan_stats_get(conn_handle, &stats, false);
+	rtk_bt_gatts_ntf_chan_close(conn_handle);
+	bench_check(sim.tx_bad == 0 && stats.complete_num == 100 && !sim.sent[0], "channel and command completions apart");
+	printf("%-22s %u channel and %u command completions\n", "same attribute", (unsigned)stats.complete_num,
+		   (unsigned)evt_num);
+}
+
+/* a disconnection drops what is queued, the channel stays until it is closed */
+static void bench_verify_disconnect(void)
+{
+	rtk_bt_gatts_ntf_chan_stats_t stats;
+	uint16_t conn_handle = BENCH_CONN_HANDLE(1);
+	uint8_t *p_value;
+	uint16_t seq;
+
+	bench_reset();
+	sim.credits = 2;
+	rtk_bt_gatts_ntf_chan_open(conn_handle, 0, 1024);
+	/* the disconnection is handled before the drain message of the commit */
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_PAUSE, NULL);
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_DISCONNECT, (void *)(uintptr_t)1);
+	for (seq = 0; seq < 10; seq++) {
+		p_value = bench_reserve(conn_handle, 40);
+		bench_fill(p_value, seq, 40);
+	}
+	rtk_bt_gatts_ntf_chan_commit(conn_handle);
+	rtos_sema_give(api_resume);
+	while (rtk_bt_gatts_ntf_chan_stats_get(conn_handle, &stats, false) == RTK_BT_OK && stats.fail_num < 10) {
+		rtos_task_yield();
+	}
+
+	bench_check(stats.fail_num == 10 && stats.sent_num == 0 && stats.queue_bytes == 0 && sim.tx_num == 0,
+				"queued notifications dropped");
+	bench_check(rtk_bt_gatts_ntf_chan_reserve(conn_handle, BENCH_APP_ID, BENCH_INDEX, 40, &p_value) ==
+				RTK_BT_ERR_NO_CONNECTION, "reserve after disconnection");
+	bench_check(rtk_bt_gatts_ntf_chan_close(conn_handle) == RTK_BT_OK, "close after disconnection");
+	printf("%-22s %u dropped\n", "disconnect", (unsigned)stats.fail_num);
+}
+
+static uint32_t close_race_ok;
+
+/* reserve and commit only: the value returned by a reserve is not written after a close, see
+ * rtk_bt_gatts_ntf_chan_close, so what is checked here is the ring itself */
+static void bench_close_race_task(void *param)
+{
+	uint16_t conn_handle = BENCH_CONN_HANDLE(0);
+	uint8_t *p_value;
+
+	(void) param;
+	while (close_race_run) {
+		if (rtk_bt_gatts_ntf_chan_reserve(conn_handle, BENCH_APP_ID, BENCH_INDEX, 40, &p_value) == RTK_BT_OK &&
+			rtk_bt_gatts_ntf_chan_commit(conn_handle) == RTK_BT_OK) {
+			close_race_ok++;
+		} else {
+			rtos_task_yield();
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+/* close from another task while the producer reserves and commits */
+static void bench_verify_close_race(void)
+{
+	uint16_t conn_handle = BENCH_CONN_HANDLE(0);
+	int n;
+
+	bench_reset();
+	close_race_run = 1;
+	close_race_ok = 0;
+	rtos_task_create(NULL, "producer", bench_close_race_task, NULL, BENCH_STACK_SIZE, 4);
+	for (n = 0; n < 2000; n++) {
+		bench_check(rtk_bt_gatts_ntf_chan_open(conn_handle, 0, 256) == RTK_BT_OK, "open under a producer");
+		rtos_task_yield();
+		bench_check(rtk_bt_gatts_ntf_chan_close(conn_handle) == RTK_BT_OK, "close under a producer");
+	}
+	close_race_run = 0;
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	/* the completions of the closed channels come back unmatched */
+	close_race_run = 1;
+	while (__atomic_load_n(&sim.complete_num, __ATOMIC_ACQUIRE) < __atomic_load_n(&sim.tx_num, __ATOMIC_ACQUIRE)) {
+		rtos_task_yield();
+	}
+	close_race_run = 0;
+	bench_check(close_race_ok > 0, "producer ran between the closes");
+	printf("%-22s %u commits across 2000 closes\n", "close under producer", (unsigned)close_race_ok);
+}
+
+static double bench_legacy(uint16_t len, uint8_t conns)
+{
+	static uint8_t value[512];
+	struct bench_cmd cmd;
+	uint64_t wall;
+	uint32_t n;
+
+	bench_reset();
+	rtos_sema_create_binary(&cmd.done);
+	evt_num = 0;
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_ROUNDS; n++) {
+		bench_fill(value, (uint16_t)(n / conns), len);
+		cmd.conn_handle = BENCH_CONN_HANDLE(n % conns);
+		cmd.len = len;
+		cmd.data = value;
+		do {
+			bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, BENCH_MSG_CMD, &cmd);
+			rtos_sema_take(cmd.done, RTOS_MAX_DELAY);
+			if (cmd.ret == RTK_BT_ERR_NO_CREDITS) {
+				rtos_task_yield();
+			}
+		} while (cmd.ret == RTK_BT_ERR_NO_CREDITS);
+		bench_check(cmd.ret == RTK_BT_OK, "notify command");
+	}
+	bench_wait_sent(BENCH_ROUNDS);
+	while (__atomic_load_n(&evt_num, __ATOMIC_ACQUIRE) < BENCH_ROUNDS) {
+		rtos_task_yield();
+	}
+	wall = bench_wall_ns() - wall;
+	rtos_sema_delete(cmd.done);
+	bench_check(sim.tx_bad == 0, "commands on the air in order and intact");
+
+	return BENCH_ROUNDS * 1e9 / wall;
+}
+
+static double bench_chan(uint16_t len, uint8_t conns, uint32_t *p_stalls)
+{
+	rtk_bt_gatts_ntf_chan_stats_t stats;
+	uint8_t *p_value;
+	uint64_t wall;
+	uint32_t n;
+	uint8_t i;
+
+	bench_reset();
+	for (i = 0; i < conns; i++) {
+		rtk_bt_gatts_ntf_chan_open(BENCH_CONN_HANDLE(i), 0, BENCH_RING_SIZE);
+	}
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_ROUNDS; n++) {
+		i = n % conns;
+		p_value = bench_reserve(BENCH_CONN_HANDLE(i), len);
+		bench_fill(p_value, (uint16_t)(n / conns), len);
+		if ((n / conns) % BENCH_BATCH == BENCH_BATCH - 1) {
+			rtk_bt_gatts_ntf_chan_commit(BENCH_CONN_HANDLE(i));
+		}
+	}
+	for (i = 0; i < conns; i++) {
+		rtk_bt_gatts_ntf_chan_commit(BENCH_CONN_HANDLE(i));
+	}
+	bench_wait_sent(BENCH_ROUNDS);
+	wall = bench_wall_ns() - wall;
+	bench_check(sim.tx_bad == 0, "channels on the air in order and intact");
+
+	*p_stalls = 0;
+	for (i = 0; i < conns; i++) {
+		rtk_bt_gatts_ntf_chan_stats_get(BENCH_CONN_HANDLE(i), &stats, false);
+		*p_stalls += stats.credit_stall_num;
+		rtk_bt_gatts_ntf_chan_close(BENCH_CONN_HANDLE(i));
+	}
+
+	return BENCH_ROUNDS * 1e9 / wall;
+}
+
+static void bench_throughput(void)
+{
+	static const uint16_t mtus[] = { 23, 185, 247, 512 };
+	static const uint8_t conns[] = { 1, 2, 4 };
+	double legacy, chan;
+	uint32_t stalls;
+	unsigned m, c;
+
+	printf("%-5s %-6s %14s %14s %9s %8s\n", "mtu", "links", "command ntf/s", "channel ntf/s", "MB/s", "stalls");
+	for (m = 0; m < sizeof(mtus) / sizeof(mtus[0]); m++) {
+		for (c = 0; c < sizeof(conns) / sizeof(conns[0]); c++) {
+			legacy = bench_legacy(mtus[m] - 3, conns[c]);
+			chan = bench_chan(mtus[m] - 3, conns[c], &stalls);
+			printf("%-5u %-6u %14.0f %14.0f %9.1f %8u\n", mtus[m], conns[c], legacy, chan,
+				   chan * (mtus[m] - 3) / 1e6, (unsigned)stalls);
+		}
+	}
+}
+
+static void bench_main(void *param)
+{
+	struct bench_evt *stop = NULL;
+
+	(void) param;
+	bench_reset();
+	rtos_queue_create(&api_q, 64, sizeof(struct bench_msg));
+	rtos_queue_create(&evt_q, 64, sizeof(struct bench_evt *));
+	rtos_sema_create_binary(&api_resume);
+	rtos_task_create(NULL, "bt_api", bench_api_task, NULL, BENCH_STACK_SIZE, 5);
+	rtos_task_create(NULL, "bt_evt", bench_evt_task, NULL, BENCH_STACK_SIZE, 4);
+
+	bench_verify_params();
+	bench_verify_order();
+	bench_verify_share();
+	bench_verify_mixed();
+	bench_verify_disconnect();
+	bench_verify_close_race();
+	bench_throughput();
+
+	bt_stack_gatts_ntf_chan_deinit();
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, RTK_BT_API_TASK_EXIT, NULL);
+	rtos_queue_send(evt_q, &stop, RTOS_MAX_DELAY);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	rtos_sema_delete(api_resume);
+	rtos_sched_stop();
+	rtos_task_delete(NULL);
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	rtos_sema_create(&bench_done, 0, 2);
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Trace replay of the FreeRTOS heaps: heap_5 and heap_tlsf run the same allocation sequence on
+ * the same SRAM + PSRAM region layout.
+ *     heap_bench [-s sram_kb] [-p psram_kb] [-n ops] [trace]
+ * A trace is either a console log taken with CONFIG_HEAP_TRACE_MALLOC_FREE_LOG ([trace_malloc] and
+ * [trace_free] lines, whose size includes the block header) or lines of "m <addr> <size>" and
+ * "f <addr>". A malloc of an address still live frees it first, which covers realloc. Without a
+ * trace a deterministic lwIP like load is generated.
+ * Latencies include the clock read, about the same for both heaps.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "heap_tlsf.h"
+
+#define BENCH_TRACE_HDR			32			/* block header counted in heap trace sizes */
+#define BENCH_FILL				32			/* bytes of every block written and verified */
+#define BENCH_REGION_GAP		4096
+#define BENCH_MAP_BITS			18
+
+size_t heap_bench_psram_base;
+
+/* heap_5 is built with its symbols prefixed, see heap5_rename.h */
+void *heap5_pvPortMalloc(size_t xWantedSize);
+void heap5_vPortFree(void *pv);
+size_t heap5_xPortGetFreeHeapSize(void);
+size_t heap5_xPortGetMinimumEverFreeHeapSize(void);
+void heap5_vPortDefineHeapRegions(const HeapRegion_t *const pxHeapRegions);
+void heap5_vPortGetHeapStats(HeapStats_t *pxHeapStats);
+
+static int heap5_check(void)
+{
+	return 0;
+}
+
+struct bench_heap {
+	const char *name;
+	void (*define)(const HeapRegion_t *const regions);
+	void *(*malloc)(size_t size);
+	void (*free)(void *p);
+	size_t (*free_size)(void);
+	size_t (*min_free)(void);
+	void (*stats)(HeapStats_t *stats);
+	int (*check)(void);
+};
+
+static const struct bench_heap bench_heaps[] = {
+	{
+		"heap_5", heap5_vPortDefineHeapRegions, heap5_pvPortMalloc, heap5_vPortFree, heap5_xPortGetFreeHeapSize,
+		heap5_xPortGetMinimumEverFreeHeapSize, heap5_vPortGetHeapStats, heap5_check
+	},
+	{
+		"heap_tlsf", vPortDefineHeapRegions, pvPortMalloc, vPortFree, xPortGetFreeHeapSize,
+		xPortGetMinimumEverFreeHeapSize, vPortGetHeapStats, heap_tlsf_check
+	},
+};
+
+/* one operation on a slot, size 0 frees it */
+struct bench_op {
+	uint32_t slot;
+	uint32_t size;
+};
+
+struct bench_trace {
+	struct bench_op *ops;
+	uint32_t num;
+	uint32_t cap;
+	uint32_t slots;
+	uint32_t peak_op;		/* op after which the most requested bytes are live */
+	uint64_t live;
+	uint64_t peak;
+	uint32_t *slot_size;
+	uint32_t slot_cap;
+};
+
+static void trace_push(struct bench_trace *t, uint32_t slot, uint32_t size)
+{
+	if (t->num == t->cap) {
+		t->cap = t->cap ? t->cap * 2 : 4096;
+		t->ops = realloc(t->ops, t->cap * sizeof(struct bench_op));
+	}
+	if (slot >= t->slot_cap) {
+		t->slot_cap = t->slot_cap ? t->slot_cap * 2 : 4096;
+		t->slot_size = realloc(t->slot_size, t->slot_cap * sizeof(uint32_t));
+	}
+	if (t->ops == NULL || t->slot_size == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	if (size) {
+		t->slot_size[slot] = size;
+		t->live += size;
+	} else {
+		t->live -= t->slot_size[slot];
+	}
+	if (t->live > t->peak) {
+		t->peak = t->live;
+		t->peak_op = t->num;
+	}
+
+	t->ops[t->num].slot = slot;
+	t->ops[t->num].size = size;
+	t->num++;
+}
+
+/* recorded address to live slot, open addressing with tombstones */
+struct bench_map {
+	uint64_t key[1U << BENCH_MAP_BITS];
+	uint32_t slot[1U << BENCH_MAP_BITS];
+	uint32_t used;
+};
+
+#define MAP_EMPTY		0
+#define MAP_TOMB		1
+
+static uint32_t map_hash(uint64_t key)
+{
+	return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - BENCH_MAP_BITS));
+}
+
+static uint32_t *map_find(struct bench_map *m, uint64_t key)
+{
+	uint32_t i = map_hash(key);
+
+	while (m->key[i] != MAP_EMPTY) {
+		if (m->key[i] == key) {
+			return &m->slot[i];
+		}
+		i = (i + 1) & ((1U << BENCH_MAP_BITS) - 1);
+	}
+	return NULL;
+}
+
+static void map_remove(struct bench_map *m, uint32_t *slot)
+{
+	m->key[slot - m->slot] = MAP_TOMB;
+}
+
+static void map_insert(struct bench_map *m, uint64_t key, uint32_t slot)
+{
+	uint32_t i = map_hash(key);
+
+	/* tombstones are not reused, rebuild once they fill the table */
+	if (++m->used > (3U << BENCH_MAP_BITS) / 4) {
+		fprintf(stderr, "trace has too many distinct addresses\n");
+		exit(1);
+	}
+	while (m->key[i] > MAP_TOMB) {
+		i = (i + 1) & ((1U << BENCH_MAP_BITS) - 1);
+	}
+	m->key[i] = key;
+	m->slot[i] = slot;
+}
+
+static void map_rebuild(struct bench_map *m)
+{
+	static uint64_t key[1U << BENCH_MAP_BITS];
+	static uint32_t slot[1U << BENCH_MAP_BITS];
+	uint32_t i;
+
+	memcpy(key, m->key, sizeof(key));
+	memcpy(slot, m->slot, sizeof(slot));
+	memset(m->key, 0, sizeof(m->key));
+	m->used = 0;
+	for (i = 0; i < (1U << BENCH_MAP_BITS); i++) {
+		if (key[i] > MAP_TOMB) {
+			map_insert(m, key[i], slot[i]);
+		}
+	}
+}
+
+static int trace_load(struct bench_trace *t, const char *path)
+{
+	static struct bench_map map;
+	unsigned long long addr;
+	unsigned int size;
+	uint32_t *slot;
+	char line[256];
+	const char *s;
+	int is_malloc;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), f)) {
+		size = 0;
+		if ((s = strstr(line, "[trace_malloc]")) != NULL) {
+			is_malloc = sscanf(s, "[trace_malloc] pvAddress:%llx, uiSize:%x", &addr, &size) == 2;
+			if (!is_malloc) {
+				continue;
+			}
+			size = size > BENCH_TRACE_HDR ? size - BENCH_TRACE_HDR : 1;
+		} else if ((s = strstr(line, "[trace_free]")) != NULL) {
+			if (sscanf(s, "[trace_free] pvAddress:%llx", &addr) != 1) {
+				continue;
+			}
+			is_malloc = 0;
+		} else if (sscanf(line, "m %llx %u", &addr, &size) == 2 && size) {
+			is_malloc = 1;
+		} else if (sscanf(line, "f %llx", &addr) == 1) {
+			is_malloc = 0;
+		} else {
+			continue;
+		}
+		addr += MAP_TOMB + 1;
+
+		slot = map_find(&map, addr);
+		if (slot) {
+			trace_push(t, *slot, 0);
+			map_remove(&map, slot);
+		}
+		if (is_malloc) {
+			if (map.used > (5U << BENCH_MAP_BITS) / 8) {
+				map_rebuild(&map);
+			}
+			map_insert(&map, addr, t->slots);
+			trace_push(t, t->slots++, size);
+		}
+		/* frees of blocks allocated before the trace started are dropped */
+	}
+
+	fclose(f);
+	return 0;
+}
+
+/* synthetic load: short lived packet buffers, segments on the retransmission queue, application
+ * buffers and long lived connection state, bounded to a share of the heap like a busy network stack */
+struct gen_live {
+	uint64_t death;
+	uint32_t slot;
+	uint32_t size;
+};
+
+static uint64_t gen_state = 0x853c49e6748fea9bULL;
+
+static uint32_t gen_rand(uint32_t n)
+{
+	gen_state = gen_state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (uint32_t)((gen_state >> 33) % n);
+}
+
+static void gen_sift_down(struct gen_live *h, uint32_t n, uint32_t i)
+{
+	struct gen_live tmp;
+	uint32_t c;
+
+	while ((c = 2 * i + 1) < n) {
+		if (c + 1 < n && h[c + 1].death < h[c].death) {
+			c++;
+		}
+		if (h[i].death <= h[c].death) {
+			break;
+		}
+		tmp = h[i];
+		h[i] = h[c];
+		h[c] = tmp;
+		i = c;
+	}
+}
+
+static void gen_push(struct gen_live *h, uint32_t *n, struct gen_live e)
+{
+	struct gen_live tmp;
+	uint32_t i = (*n)++;
+
+	h[i] = e;
+	while (i && h[(i - 1) / 2].death > h[i].death) {
+		tmp = h[i];
+		h[i] = h[(i - 1) / 2];
+		h[(i - 1) / 2] = tmp;
+		i = (i - 1) / 2;
+	}
+}
+
+static void trace_generate(struct bench_trace *t, uint32_t ops, uint64_t budget)
+{
+	struct gen_live *heap = malloc(ops * sizeof(struct gen_live));
+	struct gen_live e;
+	uint64_t now = 0, live = 0;
+	uint32_t n = 0, r;
+
+	while (t->num < ops) {
+		if (n && (heap[0].death <= now || live > budget)) {
+			trace_push(t, heap[0].slot, 0);
+			live -= heap[0].size;
+			heap[0] = heap[--n];
+			gen_sift_down(heap, n, 0);
+			continue;
+		}
+
+		r = gen_rand(100);
+		if (r < 45) {				/* rx pbuf, PBUF_POOL sized */
+			e.size = 1600;
+			e.death = now + 1 + gen_rand(8);
+		} else if (r < 70) {		/* control blocks, timeouts, small pbufs */
+			e.size = 16 + gen_rand(240);
+			e.death = now + 1 + gen_rand(200);
+		} else if (r < 85) {		/* tcp segments waiting for ack */
+			e.size = gen_rand(2) ? 536 + 80 : 1460 + 80;
+			e.death = now + 20 + gen_rand(400);
+		} else if (r < 95) {		/* application buffers */
+			e.size = 2048 + gen_rand(14 * 1024);
+			e.death = now + 10 + gen_rand(2000);
+		} else {					/* pcbs and sockets */
+			e.size = 300 + gen_rand(500);
+			e.death = now + 1000 + gen_rand(50000);
+		}
+		e.slot = t->slots++;
+		trace_push(t, e.slot, e.size);
+		gen_push(heap, &n, e);
+		live += e.size;
+		now++;
+	}
+
+	free(heap);
+}
+
+static uint64_t bench_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void lat_print(const char *what, uint32_t *lat, uint32_t n)
+{
+	uint64_t sum = 0;
+	uint32_t i;
+
+	if (n == 0) {
+		printf("  %-6s -\n", what);
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		sum += lat[i];
+	}
+	qsort(lat, n, sizeof(uint32_t), cmp_u32);
+	printf("  %-6s %8u ops  mean %6.1f ns  p99 %6u ns  max %8u ns\n", what, n, (double)sum / n,
+		   lat[(uint64_t)n * 99 / 100], lat[n - 1]);
+}
+
+static int bench_replay(const struct bench_heap *h, const struct bench_trace *t, size_t sram, size_t psram)
+{
+	HeapRegion_t regions[3];
+	HeapStats_t stats;
+	void **ptr = calloc(t->slots ? t->slots : 1, sizeof(void *));
+	uint32_t *lat_m = malloc(t->num * sizeof(uint32_t));
+	uint32_t *lat_f = malloc(t->num * sizeof(uint32_t));
+	uint32_t nm = 0, nf = 0, fails = 0, bad = 0, i, k;
+	size_t initial, peak_free = 0, peak_largest = 0;
+	uint8_t *mem;
+	uint64_t t0;
+	int err;
+
+	if (posix_memalign((void **)&mem, 4096, sram + BENCH_REGION_GAP + psram) != 0 || ptr == NULL || lat_m == NULL || lat_f == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	regions[0].pucStartAddress = mem;
+	regions[0].xSizeInBytes = sram;
+	regions[1].pucStartAddress = mem + sram + BENCH_REGION_GAP;
+	regions[1].xSizeInBytes = psram;
+	regions[2].pucStartAddress = NULL;
+	regions[2].xSizeInBytes = 0;
+	heap_bench_psram_base = (size_t)regions[1].pucStartAddress;
+
+	h->define(regions);
+	initial = h->free_size();
+
+	for (i = 0; i < t->num; i++) {
+		const struct bench_op *op = &t->ops[i];
+
+		if (op->size) {
+			t0 = bench_ns();
+			ptr[op->slot] = h->malloc(op->size);
+			lat_m[nm++] = (uint32_t)(bench_ns() - t0);
+			if (ptr[op->slot] == NULL) {
+				fails++;
+			} else {
+				memset(ptr[op->slot], (uint8_t)op->slot, op->size < BENCH_FILL ? op->size : BENCH_FILL);
+			}
+		} else if (ptr[op->slot] != NULL) {
+			for (k = 0; k < t->slot_size[op->slot] && k < BENCH_FILL; k++) {
+				bad += ((uint8_t *)ptr[op->slot])[k] != (uint8_t)op->slot;
+			}
+			t0 = bench_ns();
+			h->free(ptr[op->slot]);
+			lat_f[nf++] = (uint32_t)(bench_ns() - t0);
+			ptr[op->slot] = NULL;
+		}
+
+		if (i == t->peak_op) {
+			h->stats(&stats);
+			peak_free = stats.xAvailableHeapSpaceInBytes;
+			peak_largest = stats.xSizeOfLargestFreeBlockInBytes;
+			if (h->define == vPortDefineHeapRegions) {
+				heap_tlsf_dump();
+			}
+		}
+	}
+
+	printf("%s\n", h->name);
+	lat_print("malloc", lat_m, nm);
+	lat_print("free", lat_f, nf);
+	printf("  failed %u, high-water %zu of %zu, at peak: free %zu largest %zu fragmentation %.1f%%\n",
+		   fails, initial - h->min_free(), initial, peak_free, peak_largest,
+		   peak_free ? 100.0 * (1.0 - (double)peak_largest / peak_free) : 0.0);
+
+	for (i = 0; i < t->slots; i++) {
+		if (ptr[i]) {
+			h->free(ptr[i]);
+		}
+	}
+	err = h->check();
+	if (bad || err || h->free_size() != initial) {
+		printf("  FAIL: %u corrupted bytes, %d inconsistencies, %zu bytes lost\n", bad, err, initial - h->free_size());
+		err = 1;
+	}
+
+	free(ptr);
+	free(lat_m);
+	free(lat_f);
+	free(mem);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	struct bench_trace trace;
+	size_t sram = 512 * 1024, psram = 4 * 1024 * 1024;
+	uint32_t ops = 400000, i;
+	const char *path = NULL;
+	int opt, fail = 0;
+
+	while (argc > 1 && argv[1][0] == '-' && argc > 2) {
+		opt = argv[1][1];
+		if (opt == 's') {
+			sram = strtoul(argv[2], NULL, 0) * 1024;
+		} else if (opt == 'p') {
+			psram = strtoul(argv[2], NULL, 0) * 1024;
+		} else if (opt == 'n') {
+			ops = strtoul(argv[2], NULL, 0);
+		} else {
+			break;
+		}
+		argc -= 2;
+		argv += 2;
+	}
+	if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+		fprintf(stderr, "usage: heap_bench [-s sram_kb] [-p psram_kb] [-n ops] [trace]\n");
+		return 2;
+	}
+	if (argc == 2) {
+		path = argv[1];
+	}
+
+	memset(&trace, 0, sizeof(trace));
+	if (path) {
+		if (trace_load(&trace, path) != 0) {
+			return 1;
+		}
+	} else {
+		trace_generate(&trace, ops, (sram + psram) * 3 / 4);
+	}
+	printf("%s: %u ops, %u allocations, peak %llu bytes live at op %u\n", path ? path : "synthetic lwip load",
+		   trace.num, trace.slots, (unsigned long long)trace.peak, trace.peak_op);
+
+	for (i = 0; i < sizeof(bench_heaps) / sizeof(bench_heaps[0]); i++) {
+		fail |= bench_replay(&bench_heaps[i], &trace, sram, psram);
+	}
+
+	free(trace.ops);
+	free(trace.slot_size);
+	printf("%s\n", fail ? "FAIL" : "done");
+	return fail;
+}
@@ -0,0 +1,618 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Direct ISO data path against a simulated controller. The controller owns a small pool of receive
+ * buffers handed to the stack as T_BT_DIRECT_ISO_DATA_IND and a pool of ISO buffer credits consumed
+ * by gap_iso_send_data and given back by a tick task. The bench plays the lower stack for receive,
+ * runs a BT API task for the drain message, checks both paths and the statistics, then times them
+ * against a model of the event and command paths: a copy of each SDU into an event handed to an
+ * event task, and a command round trip to the API task per SDU sent.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "osif.h"
+#include "app_msg.h"
+#include "gap_iso_data.h"
+#include "bt_direct_msg.h"
+#include "rtk_bt_common.h"
+#include "rtk_bt_le_iso_data.h"
+#include "rtk_stack_internal.h"
+
+#define BENCH_STACK_SIZE		8192
+#define BENCH_HANDLE			0x0100
+#define BENCH_SDU_LEN			120		/* LC3 10 ms frame at 96 kbit/s */
+#define BENCH_RX_OFFSET			8
+#define BENCH_RX_BUFS			8
+#define BENCH_TX_CREDITS		4
+#define BENCH_INTERVAL_US		2000
+#define BENCH_ROUNDS			200000
+
+struct bench_msg {
+	uint16_t type;
+	uint16_t subtype;
+	void *buf;
+};
+
+/* a BT API command, sent and waited for like rtk_bt_send_cmd */
+struct bench_cmd {
+	uint16_t handle;
+	uint16_t seq;
+	uint16_t len;
+	uint8_t *data;
+	uint16_t ret;
+	rtos_sema_t done;
+};
+
+/* an RTK_BT_LE_ISO_EVT_DATA_RECEIVE_IND with the SDU copied behind it */
+struct bench_evt {
+	uint16_t handle;
+	uint16_t seq;
+	uint16_t len;
+	uint8_t data[];
+};
+
+static struct {
+	uint8_t buf[BENCH_RX_BUFS][BENCH_RX_OFFSET + BENCH_SDU_LEN];
+	uint8_t used[BENCH_RX_BUFS];
+	uint32_t rx_held;
+	uint32_t rx_cfm_bad;
+	uint32_t credits;
+	uint32_t credits_max;			/* 0: the controller never runs out */
+	uint32_t tx_num;
+	uint32_t tx_bad;
+	uint16_t tx_next_seq;
+	volatile int tick_run;
+} sim;
+
+static rtos_queue_t api_q;
+static rtos_queue_t evt_q;
+static rtos_sema_t bench_done;
+static uint32_t rx_sum;
+static uint32_t rx_num;
+static int bench_fail;
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static inline uint8_t bench_pattern(uint16_t seq, uint16_t i)
+{
+	return (uint8_t)(seq * 7 + i);
+}
+
+/* controller: an SDU to send takes a credit, its content and order are checked on the air */
+T_GAP_CAUSE gap_iso_send_data(uint8_t *p_data, uint16_t handle, uint16_t iso_sdu_len, bool ts_flag,
+							  uint32_t time_stamp, uint16_t pkt_seq_num)
+{
+	uint32_t credits;
+	uint16_t i;
+
+	(void) ts_flag;
+	(void) time_stamp;
+	if (sim.credits_max) {
+		credits = __atomic_load_n(&sim.credits, __ATOMIC_ACQUIRE);
+		do {
+			if (credits == 0) {
+				return GAP_CAUSE_ERROR_CREDITS;
+			}
+		} while (!__atomic_compare_exchange_n(&sim.credits, &credits, credits - 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+	}
+	if (handle != BENCH_HANDLE || pkt_seq_num != sim.tx_next_seq || iso_sdu_len != BENCH_SDU_LEN) {
+		sim.tx_bad++;
+	}
+	for (i = 0; i < iso_sdu_len; i++) {
+		if (p_data[i] != bench_pattern(pkt_seq_num, i)) {
+			sim.tx_bad++;
+			break;
+		}
+	}
+	sim.tx_next_seq = pkt_seq_num + 1;
+	sim.tx_num++;
+	return GAP_CAUSE_SUCCESS;
+}
+
+bool gap_iso_data_cfm(void *p_buf)
+{
+	int i;
+
+	for (i = 0; i < BENCH_RX_BUFS; i++) {
+		if (p_buf == sim.buf[i] && sim.used[i]) {
+			sim.used[i] = 0;
+			__atomic_fetch_sub(&sim.rx_held, 1, __ATOMIC_RELEASE);
+			return true;
+		}
+	}
+	sim.rx_cfm_bad++;
+	return false;
+}
+
+/* controller tick: Number Of Completed Packets gives credits back */
+static void sim_tick_task(void *param)
+{
+	(void) param;
+	while (sim.tick_run) {
+		rtos_time_delay_ms(1);
+		if (__atomic_load_n(&sim.credits, __ATOMIC_ACQUIRE) < sim.credits_max) {
+			__atomic_fetch_add(&sim.credits, 1, __ATOMIC_RELEASE);
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+/* the lower stack without the direct path: copy into an event for the event task */
+static void bench_legacy_rx(T_BT_DIRECT_ISO_DATA_IND *p_ind)
+{
+	struct bench_evt *p_evt = malloc(sizeof(*p_evt) + p_ind->iso_sdu_len);
+
+	p_evt->handle = p_ind->conn_handle;
+	p_evt->seq = p_ind->pkt_seq_num;
+	p_evt->len = p_ind->iso_sdu_len;
+	memcpy(p_evt->data, p_ind->p_buf + p_ind->offset, p_ind->iso_sdu_len);
+	gap_iso_data_cfm(p_ind->p_buf);
+	rtos_queue_send(evt_q, &p_evt, RTOS_MAX_DELAY);
+}
+
+/* controller: one SDU into a free receive buffer, false when all of them are held */
+static bool sim_rx(uint16_t seq, uint8_t status, uint16_t len)
+{
+	T_BT_DIRECT_ISO_DATA_IND ind;
+	uint16_t i;
+	int b;
+
+	for (b = 0; b < BENCH_RX_BUFS; b++) {
+		if (!sim.used[b]) {
+			break;
+		}
+	}
+	if (b == BENCH_RX_BUFS) {
+		return false;
+	}
+	sim.used[b] = 1;
+	__atomic_fetch_add(&sim.rx_held, 1, __ATOMIC_RELEASE);
+	for (i = 0; i < len; i++) {
+		sim.buf[b][BENCH_RX_OFFSET + i] = bench_pattern(seq, i);
+	}
+
+	memset(&ind, 0, sizeof(ind));
+	ind.conn_handle = BENCH_HANDLE;
+	ind.pkt_status_flag = (T_ISOCH_DATA_PKT_STATUS)status;
+	ind.p_buf = sim.buf[b];
+	ind.offset = BENCH_RX_OFFSET;
+	ind.iso_sdu_len = len;
+	ind.pkt_seq_num = seq;
+	/* what bt_stack_le_iso_data_direct_callback does */
+	if (!bt_stack_le_iso_data_rx_ind(&ind)) {
+		bench_legacy_rx(&ind);
+	}
+	return true;
+}
+
+/* BT API task: drain messages and commands */
+uint16_t bt_stack_msg_send(uint16_t type, uint16_t subtype, void *msg)
+{
+	struct bench_msg m = { type, subtype, msg };
+
+	return rtos_queue_send(api_q, &m, 0) == RTK_SUCCESS ? RTK_BT_OK : RTK_BT_ERR_OS_OPERATION;
+}
+
+static void bench_api_task(void *param)
+{
+	struct bench_cmd *p_cmd;
+	struct bench_msg m;
+	T_GAP_CAUSE cause;
+
+	(void) param;
+	for (;;) {
+		rtos_queue_receive(api_q, &m, RTOS_MAX_DELAY);
+		if (m.subtype == RTK_BT_API_TASK_EXIT) {
+			break;
+		}
+		if (m.subtype == RTK_BT_API_TASK_ISO_DATA) {
+			bt_stack_le_iso_data_drain();
+			continue;
+		}
+		/* what bt_stack_le_iso_data_send does */
+		p_cmd = (struct bench_cmd *)m.buf;
+		cause = gap_iso_send_data(p_cmd->data, p_cmd->handle, p_cmd->len, false, 0, p_cmd->seq);
+		bt_stack_le_iso_data_tx_record(p_cmd->handle, (uint16_t)cause);
+		p_cmd->ret = cause == GAP_CAUSE_SUCCESS ? RTK_BT_OK : RTK_BT_ERR_NO_CREDITS;
+		rtos_sema_give(p_cmd->done);
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_evt_task(void *param)
+{
+	struct bench_evt *p_evt;
+	uint16_t i;
+
+	(void) param;
+	for (;;) {
+		rtos_queue_receive(evt_q, &p_evt, RTOS_MAX_DELAY);
+		if (p_evt == NULL) {
+			break;
+		}
+		for (i = 0; i < p_evt->len; i++) {
+			rx_sum += p_evt->data[i];
+		}
+		free(p_evt);
+		__atomic_fetch_add(&rx_num, 1, __ATOMIC_RELEASE);
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+/* receive callbacks: keep the buffer for a deferred release, or consume it in place */
+static uint8_t *rx_kept[BENCH_RX_BUFS];
+static uint32_t rx_kept_num;
+static uint32_t rx_bad;
+
+static bool bench_rx_keep(rtk_bt_le_iso_data_rx_t *p_rx)
+{
+	uint16_t i;
+
+	if (p_rx->p_sdu != p_rx->p_buf + BENCH_RX_OFFSET || p_rx->iso_conn_handle != BENCH_HANDLE) {
+		rx_bad++;
+	}
+	for (i = 0; i < p_rx->iso_sdu_len; i++) {
+		if (p_rx->p_sdu[i] != bench_pattern(p_rx->pkt_seq_num, i)) {
+			rx_bad++;
+			break;
+		}
+	}
+	rx_kept[rx_kept_num++] = p_rx->p_buf;
+	return true;
+}
+
+static bool bench_rx_consume(rtk_bt_le_iso_data_rx_t *p_rx)
+{
+	uint16_t i;
+
+	for (i = 0; i < p_rx->iso_sdu_len; i++) {
+		rx_sum += p_rx->p_sdu[i];
+	}
+	rx_num++;
+	return false;
+}
+
+static void bench_rx_release_kept(void)
+{
+	while (rx_kept_num) {
+		bench_check(rtk_bt_le_iso_data_release(rx_kept[--rx_kept_num]) == RTK_BT_OK, "release kept buffer");
+	}
+}
+
+static void bench_verify_rx(void)
+{
+	rtk_bt_le_iso_data_stats_t stats;
+	uint32_t delivered = 0, errors = 0, lost = 0, gaps = 0;
+	uint16_t seq = 0;
+	uint8_t status;
+	int n;
+
+	bench_check(rtk_bt_le_iso_data_stream_open(BENCH_HANDLE, BENCH_INTERVAL_US, 0, 0) == RTK_BT_OK, "open rx stream");
+	bench_check(rtk_bt_le_iso_data_stream_open(BENCH_HANDLE, BENCH_INTERVAL_US, 0, 0) == RTK_BT_ERR_ALREADY_DONE,
+				"open twice");
+	rtk_bt_le_iso_data_rx_register(bench_rx_keep);
+
+	/* held buffers stop the controller until the consumer gives them back */
+	for (n = 0; n < 1000; n++) {
+		if (n % 100 == 99) {
+			seq += 2;
+			gaps += 2;
+		}
+		status = n % 50 == 49 ? ISOCH_DATA_PKT_STATUS_POSSIBLE_ERROR_DATA :
+				 n % 70 == 69 ? ISOCH_DATA_PKT_STATUS_LOST_DATA : ISOCH_DATA_PKT_STATUS_VALID_DATA;
+		if (!sim_rx(seq, status, status == ISOCH_DATA_PKT_STATUS_LOST_DATA ? 0 : BENCH_SDU_LEN)) {
+			bench_check(rx_kept_num == BENCH_RX_BUFS, "controller blocked only by held buffers");
+			bench_rx_release_kept();
+			n--;
+			continue;
+		}
+		errors += status == ISOCH_DATA_PKT_STATUS_POSSIBLE_ERROR_DATA;
+		lost += status == ISOCH_DATA_PKT_STATUS_LOST_DATA;
+		delivered++;
+		seq++;
+	}
+	bench_rx_release_kept();
+
+	bench_check(rx_bad == 0, "lent SDU in place and intact");
+	bench_check(sim.rx_held == 0 && sim.rx_cfm_bad == 0, "every lent buffer confirmed once");
+	bench_check(rtk_bt_le_iso_data_stats_get(BENCH_HANDLE, &stats, true) == RTK_BT_OK, "stats");
+	bench_check(stats.rx.sdu_num == delivered && stats.rx_error_num == errors && stats.rx_lost_num == lost &&
+				stats.rx_seq_gap_num == gaps, "rx counters");
+	printf("%-22s %u SDUs lent, %u errors, %u lost, %u missing sequence numbers\n", "rx lent",
+		   (unsigned)stats.rx.sdu_num, (unsigned)stats.rx_error_num, (unsigned)stats.rx_lost_num,
+		   (unsigned)stats.rx_seq_gap_num);
+
+	/* consumed in the callback, the stack confirms */
+	rtk_bt_le_iso_data_rx_register(bench_rx_consume);
+	rx_num = 0;
+	for (n = 0; n < 100; n++) {
+		sim_rx((uint16_t)n, ISOCH_DATA_PKT_STATUS_VALID_DATA, BENCH_SDU_LEN);
+	}
+	bench_check(rx_num == 100 && sim.rx_held == 0, "callback consuming in place");
+
+	/* arrival timing: every 25th SDU comes three intervals late */
+	rtk_bt_le_iso_data_stats_get(BENCH_HANDLE, &stats, true);
+	for (n = 0; n < 100; n++) {
+		rtos_time_delay_ms(n % 25 == 24 ? 3 * BENCH_INTERVAL_US / 1000 : BENCH_INTERVAL_US / 1000);
+		sim_rx((uint16_t)n, ISOCH_DATA_PKT_STATUS_VALID_DATA, BENCH_SDU_LEN);
+	}
+	rtk_bt_le_iso_data_stats_get(BENCH_HANDLE, &stats, false);
+	bench_check(stats.rx.late_num >= 4 && stats.rx.interval_max_us >= 3 * BENCH_INTERVAL_US, "late SDUs counted");
+	printf("%-22s %u late of %u, interval %u..%u us, jitter max %u us\n", "rx timing",
+		   (unsigned)stats.rx.late_num, (unsigned)stats.rx.sdu_num, (unsigned)stats.rx.interval_min_us,
+		   (unsigned)stats.rx.interval_max_us, (unsigned)stats.rx.jitter_max_us);
+
+	/* without callback the events carry the SDU again */
+	rtk_bt_le_iso_data_rx_register(NULL);
+	rx_num = 0;
+	sim_rx(0, ISOCH_DATA_PKT_STATUS_VALID_DATA, BENCH_SDU_LEN);
+	while (__atomic_load_n(&rx_num, __ATOMIC_ACQUIRE) == 0) {
+		rtos_time_delay_ms(1);
+	}
+	bench_check(sim.rx_held == 0, "event path confirms");
+
+	bench_check(rtk_bt_le_iso_data_stream_close(BENCH_HANDLE) == RTK_BT_OK, "close rx stream");
+	bench_check(rtk_bt_le_iso_data_stats_get(BENCH_HANDLE, &stats, false) == RTK_BT_ERR_NO_ENTRY, "closed stream");
+}
+
+static void bench_verify_tx(void)
+{
+	static uint8_t sdu[BENCH_SDU_LEN];
+	rtk_bt_le_iso_data_stats_t stats;
+	uint16_t seq, i;
+	uint32_t accepted = 0, full = 0;
+	int n;
+
+	bench_check(rtk_bt_le_iso_data_stream_open(BENCH_HANDLE, BENCH_INTERVAL_US, BENCH_SDU_LEN, 12) == RTK_BT_OK,
+				"open tx stream");
+	bench_check(rtk_bt_le_iso_data_enqueue(BENCH_HANDLE, sdu, BENCH_SDU_LEN + 1, false, 0, 0) == RTK_BT_ERR_PARAM_INVALID,
+				"SDU over max_sdu");
+
+	/* one SDU per interval, four credits given back one per millisecond */
+	sim.credits_max = BENCH_TX_CREDITS;
+	sim.credits = BENCH_TX_CREDITS;
+	sim.tx_num = 0;
+	sim.tx_next_seq = 0;
+	sim.tick_run = 1;
+	rtos_task_create(NULL, "sim_tick", sim_tick_task, NULL, BENCH_STACK_SIZE, 5);
+	for (seq = 0; seq < 300; seq++) {
+		for (i = 0; i < BENCH_SDU_LEN; i++) {
+			sdu[i] = bench_pattern(seq, i);
+		}
+		bench_check(rtk_bt_le_iso_data_enqueue(BENCH_HANDLE, sdu, BENCH_SDU_LEN, false, 0, seq) == RTK_BT_OK, "enqueue");
+		rtos_time_delay_ms(BENCH_INTERVAL_US / 1000);
+	}
+
+	/* a burst larger than the queue: the overflow is refused, the rest waits for credits */
+	for (n = 0; n < 64; n++) {
+		for (i = 0; i < BENCH_SDU_LEN; i++) {
+			sdu[i] = bench_pattern(seq, i);
+		}
+		if (rtk_bt_le_iso_data_enqueue(BENCH_HANDLE, sdu, BENCH_SDU_LEN, false, 0, seq) == RTK_BT_OK) {
+			accepted++;
+			seq++;
+		} else {
+			full++;
+		}
+	}
+	while (sim.tx_num < 300 + accepted) {
+		rtos_time_delay_ms(1);
+	}
+	rtk_bt_le_iso_data_stats_get(BENCH_HANDLE, &stats, false);
+	bench_check(sim.tx_bad == 0, "queued SDUs on the air in order and intact");
+	bench_check(stats.tx_sent_num == 300 + accepted && stats.tx_queue_full_num == full && full >= 64 - 16,
+				"tx counters");
+	bench_check(stats.tx_credit_stall_num > 0 && stats.tx_queue_depth == 0 && stats.tx_queue_depth_max == 16,
+				"credit stalls and depth");
+	printf("%-22s %u sent, %u refused full, %u credit stalls, depth max %u, %u late of %u queued\n", "tx queue",
+		   (unsigned)stats.tx_sent_num, (unsigned)stats.tx_queue_full_num, (unsigned)stats.tx_credit_stall_num,
+		   (unsigned)stats.tx_queue_depth_max, (unsigned)stats.tx.late_num, (unsigned)stats.tx.sdu_num);
+
+	/* closed with SDUs waiting for credits */
+	sim.credits_max = 1;
+	for (n = 0; n < 16; n++, seq++) {
+		for (i = 0; i < BENCH_SDU_LEN; i++) {
+			sdu[i] = bench_pattern(seq, i);
+		}
+		rtk_bt_le_iso_data_enqueue(BENCH_HANDLE, sdu, BENCH_SDU_LEN, false, 0, seq);
+	}
+	bench_check(rtk_bt_le_iso_data_stream_close(BENCH_HANDLE) == RTK_BT_OK, "close with a backlog");
+	bench_check(rtk_bt_le_iso_data_enqueue(BENCH_HANDLE, sdu, BENCH_SDU_LEN, false, 0, seq) == RTK_BT_ERR_NO_ENTRY,
+				"enqueue on a closed stream");
+
+	sim.tick_run = 0;
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	sim.credits_max = 0;
+}
+
+/* producer on its own task, enqueueing while the stream is closed and opened again under it */
+static volatile int close_race_run;
+static uint32_t close_race_ok;
+
+static void bench_close_race_task(void *param)
+{
+	static uint8_t sdu[BENCH_SDU_LEN];
+	uint16_t seq = 0, i;
+
+	(void) param;
+	while (close_race_run) {
+		for (i = 0; i < BENCH_SDU_LEN; i++) {
+			sdu[i] = bench_pattern(seq, i);
+		}
+		if (rtk_bt_le_iso_data_enqueue(BENCH_HANDLE, sdu, BENCH_SDU_LEN, false, 0, seq) == RTK_BT_OK) {
+			close_race_ok++;
+			seq++;
+		} else {
+			rtos_task_yield();
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_verify_close_race(void)
+{
+	uint32_t tx_bad = sim.tx_bad;
+	int n;
+
+	close_race_run = 1;
+	close_race_ok = 0;
+	rtos_task_create(NULL, "producer", bench_close_race_task, NULL, BENCH_STACK_SIZE, 4);
+	for (n = 0; n < 2000; n++) {
+		bench_check(rtk_bt_le_iso_data_stream_open(BENCH_HANDLE, BENCH_INTERVAL_US, BENCH_SDU_LEN, 4) == RTK_BT_OK,
+					"open under a producer");
+		rtos_task_yield();
+		bench_check(rtk_bt_le_iso_data_stream_close(BENCH_HANDLE) == RTK_BT_OK, "close under a producer");
+	}
+	close_race_run = 0;
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	/* SDUs dropped by a close break the sequence on the air, their content is still checked */
+	sim.tx_bad = tx_bad;
+	bench_check(close_race_ok > 0, "producer ran between the closes");
+	printf("%-22s %u SDUs queued across 2000 closes\n", "close under producer", (unsigned)close_race_ok);
+}
+
+static void bench_rx(void)
+{
+	uint64_t wall;
+	uint32_t n;
+
+	rtk_bt_le_iso_data_stream_open(BENCH_HANDLE, BENCH_INTERVAL_US, 0, 0);
+
+	rx_num = 0;
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_ROUNDS; n++) {
+		sim_rx((uint16_t)n, ISOCH_DATA_PKT_STATUS_VALID_DATA, BENCH_SDU_LEN);
+	}
+	while (__atomic_load_n(&rx_num, __ATOMIC_ACQUIRE) < BENCH_ROUNDS) {
+		rtos_task_yield();
+	}
+	wall = bench_wall_ns() - wall;
+	printf("%-22s %8.1f ns/SDU\n", "rx event copy", (double)wall / BENCH_ROUNDS);
+
+	rtk_bt_le_iso_data_rx_register(bench_rx_consume);
+	rx_num = 0;
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_ROUNDS; n++) {
+		sim_rx((uint16_t)n, ISOCH_DATA_PKT_STATUS_VALID_DATA, BENCH_SDU_LEN);
+	}
+	wall = bench_wall_ns() - wall;
+	bench_check(rx_num == BENCH_ROUNDS, "lent SDUs consumed");
+	printf("%-22s %8.1f ns/SDU\n", "rx lent", (double)wall / BENCH_ROUNDS);
+
+	rtk_bt_le_iso_data_rx_register(NULL);
+	rtk_bt_le_iso_data_stream_close(BENCH_HANDLE);
+}
+
+static void bench_tx(void)
+{
+	static uint8_t sdu[BENCH_SDU_LEN];
+	struct bench_cmd cmd;
+	uint64_t wall;
+	uint16_t i;
+	uint32_t n;
+
+	rtk_bt_le_iso_data_stream_open(BENCH_HANDLE, BENCH_INTERVAL_US, BENCH_SDU_LEN, 32);
+	rtos_sema_create_binary(&cmd.done);
+
+	sim.tx_num = 0;
+	sim.tx_next_seq = 0;
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_ROUNDS; n++) {
+		for (i = 0; i < BENCH_SDU_LEN; i++) {
+			sdu[i] = bench_pattern((uint16_t)n, i);
+		}
+		cmd.handle = BENCH_HANDLE;
+		cmd.seq = (uint16_t)n;
+		cmd.len = BENCH_SDU_LEN;
+		cmd.data = sdu;
+		bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, 0, &cmd);
+		rtos_sema_take(cmd.done, RTOS_MAX_DELAY);
+	}
+	wall = bench_wall_ns() - wall;
+	printf("%-22s %8.1f ns/SDU\n", "tx command", (double)wall / BENCH_ROUNDS);
+
+	sim.tx_num = 0;
+	sim.tx_next_seq = 0;
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_ROUNDS; n++) {
+		for (i = 0; i < BENCH_SDU_LEN; i++) {
+			sdu[i] = bench_pattern((uint16_t)n, i);
+		}
+		while (rtk_bt_le_iso_data_enqueue(BENCH_HANDLE, sdu, BENCH_SDU_LEN, false, 0, (uint16_t)n) == RTK_BT_ERR_QUEUE_FULL) {
+			rtos_task_yield();
+		}
+	}
+	while (__atomic_load_n(&sim.tx_num, __ATOMIC_ACQUIRE) < BENCH_ROUNDS) {
+		rtos_task_yield();
+	}
+	wall = bench_wall_ns() - wall;
+	bench_check(sim.tx_bad == 0, "queued SDUs intact");
+	printf("%-22s %8.1f ns/SDU\n", "tx queue", (double)wall / BENCH_ROUNDS);
+
+	rtos_sema_delete(cmd.done);
+	rtk_bt_le_iso_data_stream_close(BENCH_HANDLE);
+}
+
+static void bench_main(void *param)
+{
+	struct bench_evt *stop = NULL;
+
+	(void) param;
+	rtos_queue_create(&api_q, 64, sizeof(struct bench_msg));
+	rtos_queue_create(&evt_q, 64, sizeof(struct bench_evt *));
+	rtos_task_create(NULL, "bt_api", bench_api_task, NULL, BENCH_STACK_SIZE, 5);
+	rtos_task_create(NULL, "bt_evt", bench_evt_task, NULL, BENCH_STACK_SIZE, 4);
+	bt_stack_le_iso_data_init();
+
+	bench_verify_rx();
+	bench_verify_tx();
+	bench_verify_close_race();
+	bench_rx();
+	bench_tx();
+
+	bt_stack_le_iso_data_deinit();
+	bt_stack_msg_send(IO_MSG_TYPE_API_SYS_CALL, RTK_BT_API_TASK_EXIT, NULL);
+	rtos_queue_send(evt_q, &stop, RTOS_MAX_DELAY);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	rtos_sched_stop();
+	rtos_task_delete(NULL);
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	rtos_sema_create(&bench_done, 0, 2);
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * lwIP in one process: two ethernet netifs joined by a simulated wire, a netconn TCP transfer from
+ * one to the other, then memp_malloc/memp_free latency. Each frame crossing the wire is copied into
+ * a PBUF_POOL chain like a NIC driver does on receive. The same source is built against every memory
+ * configuration of the stack (lwip_bench_heap, lwip_bench_pools, lwip_bench_pools_small).
+ */
+
+#include <time.h>
+#include "os_wrapper.h"
+#include "os_wrapper_specific.h"
+#include "lwip/tcpip.h"
+#include "lwip/api.h"
+#include "lwip/netif.h"
+#include "lwip/etharp.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "netif/ethernet.h"
+
+#define BENCH_STACK_SIZE		4096
+#define BENCH_WIRE_DEPTH		128
+#define BENCH_TCP_PORT			5001
+#define BENCH_TCP_BYTES			(32 * 1024 * 1024)
+#define BENCH_TCP_CHUNK			(4 * TCP_MSS)
+#define BENCH_MEMP_ROUNDS		20000
+
+struct bench_port {
+	struct netif netif;
+	struct bench_port *peer;
+	rtos_queue_t wire;
+	uint32_t frames;
+	uint32_t drops;
+};
+
+static struct bench_port bench_ports[2];
+static rtos_sema_t bench_done;
+static int bench_fail;
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+/* each end of the connection leaves through the netif owning its address */
+struct netif *lwip_bench_route_src(const ip4_addr_t *src, const ip4_addr_t *dest)
+{
+	int i;
+
+	(void) dest;
+	if (src == NULL) {
+		return NULL;
+	}
+	for (i = 0; i < 2; i++) {
+		if (ip4_addr_cmp(src, netif_ip4_addr(&bench_ports[i].netif))) {
+			return &bench_ports[i].netif;
+		}
+	}
+	return NULL;
+}
+
+/* called with the core locked: copy into a receive chain and queue it for the peer */
+static err_t bench_linkoutput(struct netif *netif, struct pbuf *p)
+{
+	struct bench_port *port = (struct bench_port *)netif->state;
+	struct pbuf *q;
+
+	q = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_POOL);
+	if (q == NULL) {
+		port->drops++;
+		return ERR_MEM;
+	}
+	pbuf_copy(q, p);
+	if (rtos_queue_send(port->peer->wire, &q, 0) != RTK_SUCCESS) {
+		pbuf_free(q);
+		port->drops++;
+		return ERR_OK;
+	}
+	port->frames++;
+	return ERR_OK;
+}
+
+/* receive side of the wire, the NIC rx task of a driver */
+static void bench_wire_task(void *param)
+{
+	struct bench_port *port = (struct bench_port *)param;
+	struct pbuf *p;
+
+	for (;;) {
+		rtos_queue_receive(port->wire, &p, RTOS_MAX_DELAY);
+		if (p == NULL) {
+			break;
+		}
+		/* the tcpip mailbox is short, wait for room instead of dropping */
+		while (port->netif.input(p, &port->netif) != ERR_OK) {
+			rtos_task_yield();
+		}
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static err_t bench_netif_init(struct netif *netif)
+{
+	struct bench_port *port = (struct bench_port *)netif->state;
+	int idx = (int)(port - bench_ports);
+
+	netif->name[0] = 'b';
+	netif->name[1] = (char)('0' + idx);
+	netif->output = etharp_output;
+	netif->linkoutput = bench_linkoutput;
+	netif->mtu = 1500;
+	netif->hwaddr_len = ETH_HWADDR_LEN;
+	memset(netif->hwaddr, 0, ETH_HWADDR_LEN);
+	netif->hwaddr[0] = 0x02;
+	netif->hwaddr[5] = (u8_t)(idx + 1);
+	netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP;
+	return ERR_OK;
+}
+
+static void bench_tcpip_ready(void *arg)
+{
+	rtos_sema_give((rtos_sema_t)arg);
+}
+
+static void bench_stack_init(void)
+{
+	ip4_addr_t addr, mask, gw;
+	rtos_sema_t ready;
+	int i;
+
+	rtos_sema_create_binary(&ready);
+	tcpip_init(bench_tcpip_ready, ready);
+	rtos_sema_take(ready, RTOS_MAX_DELAY);
+	rtos_sema_delete(ready);
+
+	bench_ports[0].peer = &bench_ports[1];
+	bench_ports[1].peer = &bench_ports[0];
+	IP4_ADDR(&mask, 255, 255, 255, 0);
+	ip4_addr_set_zero(&gw);
+	/* both wires exist before the first gratuitous ARP goes out */
+	for (i = 0; i < 2; i++) {
+		rtos_queue_create(&bench_ports[i].wire, BENCH_WIRE_DEPTH, sizeof(struct pbuf *));
+	}
+	for (i = 0; i < 2; i++) {
+		IP4_ADDR(&addr, 10, 0, 0, i + 1);
+		LOCK_TCPIP_CORE();
+		netif_add(&bench_ports[i].netif, &addr, &mask, &gw, &bench_ports[i], bench_netif_init, tcpip_input);
+		netif_set_up(&bench_ports[i].netif);
+		UNLOCK_TCPIP_CORE();
+		rtos_task_create(NULL, "wire", bench_wire_task, &bench_ports[i], BENCH_STACK_SIZE, TCPIP_THREAD_PRIO);
+	}
+}
+
+static void bench_stack_stop(void)
+{
+	struct pbuf *stop = NULL;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		rtos_queue_send(bench_ports[i].wire, &stop, RTOS_MAX_DELAY);
+	}
+	for (i = 0; i < 2; i++) {
+		rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	}
+}
+
+/* TCP sink on port 1 */
+static uint32_t tcp_received;
+
+static void bench_tcp_server(void *param)
+{
+	struct netconn *listener = (struct netconn *)param;
+	struct netconn *conn;
+	struct netbuf *buf;
+
+	if (netconn_accept(listener, &conn) == ERR_OK) {
+		while (netconn_recv(conn, &buf) == ERR_OK) {
+			tcp_received += netbuf_len(buf);
+			netbuf_delete(buf);
+		}
+		netconn_close(conn);
+		netconn_delete(conn);
+	}
+	/* the target frees it from the task delete hook */
+	sys_thread_sem_deinit();
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_tcp(void)
+{
+	static u8_t chunk[BENCH_TCP_CHUNK];
+	struct netconn *listener, *conn;
+	ip_addr_t local, remote;
+	uint64_t wall;
+	uint32_t sent = 0;
+	err_t err;
+
+	memset(chunk, 0x5a, sizeof(chunk));
+	IP_ADDR4(&local, 10, 0, 0, 1);
+	IP_ADDR4(&remote, 10, 0, 0, 2);
+
+	listener = netconn_new(NETCONN_TCP);
+	netconn_bind(listener, IP_ADDR_ANY, BENCH_TCP_PORT);
+	netconn_listen(listener);
+	rtos_task_create(NULL, "tcp_srv", bench_tcp_server, listener, BENCH_STACK_SIZE, 4);
+
+	conn = netconn_new(NETCONN_TCP);
+	netconn_bind(conn, &local, 0);
+	wall = bench_wall_ns();
+	err = netconn_connect(conn, &remote, BENCH_TCP_PORT);
+	bench_check(err == ERR_OK, "tcp connect");
+	while (err == ERR_OK && sent < BENCH_TCP_BYTES) {
+		err = netconn_write(conn, chunk, sizeof(chunk), NETCONN_COPY);
+		sent += sizeof(chunk);
+	}
+	netconn_close(conn);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	wall = bench_wall_ns() - wall;
+	netconn_delete(conn);
+	netconn_delete(listener);
+
+	bench_check(tcp_received == sent, "tcp bytes received");
+	printf("%-22s %10.1f Mbit/s  %u bytes in %.1f ms, frames %u/%u, drops %u/%u\n", "tcp transfer",
+		   tcp_received * 8e3 / wall, (unsigned)tcp_received, wall / 1e6,
+		   (unsigned)bench_ports[0].frames, (unsigned)bench_ports[1].frames,
+		   (unsigned)bench_ports[0].drops, (unsigned)bench_ports[1].drops);
+}
+
+/* depth elements outstanding: allocate depth, free them, repeat */
+static void bench_memp(memp_t type, const char *name, int depth)
+{
+	void *elem[64];
+	uint64_t wall;
+	char label[32];
+	int r, i;
+
+	wall = bench_wall_ns();
+	for (r = 0; r < BENCH_MEMP_ROUNDS; r++) {
+		for (i = 0; i < depth; i++) {
+			elem[i] = memp_malloc(type);
+		}
+		for (i = depth - 1; i >= 0; i--) {
+			memp_free(type, elem[i]);
+		}
+	}
+	wall = bench_wall_ns() - wall;
+	snprintf(label, sizeof(label), "%s x%d", name, depth);
+	printf("%-22s %10.1f ns/op\n", label, (double)wall / (2.0 * BENCH_MEMP_ROUNDS * depth));
+}
+
+static void bench_memp_dump(void)
+{
+#if MEMP_POOL_COUNTERS
+	struct memp_info info;
+	int i;
+
+	printf("%-16s %5s %4s %5s %5s %5s %10s %8s %8s\n",
+		   "pool", "size", "num", "mem", "used", "max", "alloc", "fail", "fallback");
+	for (i = 0; i < MEMP_MAX; i++) {
+		if (memp_get_info((memp_t)i, &info) != ERR_OK || info.counters.alloc == 0) {
+			continue;
+		}
+		printf("%-16s %5u %4u %5s %5u %5u %10u %8u %8u\n",
+			   info.name, info.size, info.num, info.num ? (info.psram ? "psram" : "sram") : "heap",
+			   info.counters.used, info.counters.max, (unsigned)info.counters.alloc,
+			   (unsigned)info.counters.fail, (unsigned)info.counters.fallback);
+	}
+#endif
+}
+
+static void bench_main(void *param)
+{
+	(void) param;
+#if MEMP_MEM_MALLOC
+	printf("lwip bench, memp on the heap\n");
+#else
+	printf("lwip bench, memp pools: PBUF_POOL %d, PBUF %d, TCP_SEG %d%s\n", PBUF_POOL_SIZE, MEMP_NUM_PBUF,
+		   MEMP_NUM_TCP_SEG, MEMP_POOL_FALLBACK ? ", heap fallback" : "");
+#endif
+
+	bench_stack_init();
+	bench_tcp();
+	bench_memp_dump();
+
+	bench_memp(MEMP_PBUF_POOL, "memp PBUF_POOL", 1);
+	bench_memp(MEMP_PBUF_POOL, "memp PBUF_POOL", 8);
+	bench_memp(MEMP_PBUF_POOL, "memp PBUF_POOL", 48);
+	bench_memp(MEMP_TCP_SEG, "memp TCP_SEG", 1);
+	bench_memp(MEMP_TCP_SEG, "memp TCP_SEG", 48);
+
+	bench_stack_stop();
+	sys_thread_sem_deinit();
+	printf("heap min ever free %u, free %u\n", (unsigned)rtos_mem_get_minimum_ever_free_heap_size(),
+		   (unsigned)rtos_mem_get_free_heap_size());
+	rtos_sched_stop();
+	rtos_task_delete(NULL);
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	rtos_sema_create(&bench_done, 0, 2);
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
@@ -0,0 +1,1226 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Discrete event simulation of a mesh BLOB transfer in push mode, from the first block start to
+ * the last block status. The client PDUs go out one after the other on the air. A segment to a
+ * group address is sent group_tx_times times, a unicast segmented message waits for the
+ * acknowledgment of the receiver and sends the missing segments again up to four times. Each
+ * receiver loses a PDU with its own probability; receivers behind a relay also lose the PDUs the
+ * relay can not forward when the client sends faster than the relay. Servers answer a unicast
+ * message after 20 to 50 ms and a group message after 20 to 500 ms, answers to a group message
+ * which reach the client at the same time are lost.
+ *
+ * The current client is a model of blob_client_app.c before the chunk scheduler: it asks every
+ * receiver one by one for block start and block get, sends the union of the missing chunks to the
+ * group address and waits for each chunk to be sent. The scheduled client is blob_client_app.c
+ * itself with blob_client_sched.c. The BLOB Transfer Client senders, the send callback, the
+ * message queue of the BT API task and the timers are stubbed here, so its messages go out on the
+ * simulated air and its procedure, retry and pace timers run in simulated time. The columns after
+ * the scheduled client count its block start and block get to the group address, the group
+ * queries some receivers did not answer, and the chunks sent by the pace timer.
+ *
+ *     mesh_blob_sim [nodes loss_permille [bad_percent bad_loss_permille [far_percent relay_pdu_ms]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh_api.h"
+#include "blob_client_app.h"
+#include <rtk_bt_mesh_def.h>
+
+#define SIM_NODE_MAX			128
+#define SIM_CHUNK_MAX			256
+#define SIM_MSG_MAX				8
+#define SIM_EVENT_MAX			4096
+#define SIM_TIMER_MAX			8
+
+#define SIM_RETRY_TIMES			3
+#define SIM_RETRY_PERIOD		2000
+#define SIM_GROUP_STATUS_PERIOD	1000
+#define SIM_UNICAST_RSP_MIN		20
+#define SIM_UNICAST_RSP_MAX		50
+#define SIM_GROUP_RSP_MIN		20
+#define SIM_GROUP_RSP_MAX		500
+#define SIM_RSP_COLLIDE_MS		2
+#define SIM_TRANS_RETRANS		4
+#define SIM_ACK_DELAY			150
+#define SIM_TIME_LIMIT			(24ULL * 3600 * 1000)
+
+#define SIM_GROUP				(-1)
+#define SIM_GROUP_ADDR			0xC000
+#define SIM_ADDR_BASE			0x0100
+#define SIM_TTL					5
+#define SIM_TIMEOUT_BASE		30		/* procedure timer of 320 s */
+
+struct sim_cfg {
+	const char *name;
+	uint16_t node_num;
+	uint16_t loss;					/* per mille of a PDU */
+	uint16_t bad_percent;			/* receivers with bad_loss instead of loss */
+	uint16_t bad_loss;
+	uint16_t far_percent;			/* receivers behind a relay */
+	uint16_t relay_pdu_ms;			/* air time the relay needs per PDU, 0 for no relay */
+	uint32_t blob_size;
+	uint16_t block_size;
+	uint16_t chunk_size;
+	uint16_t pdu_ms;				/* air time of a client PDU, network transmissions included */
+	uint8_t group_tx_times;
+};
+
+enum {
+	EV_STATUS,						/* a: node, b: answer */
+	EV_RETRY,						/* b: generation */
+	EV_TX_DONE,						/* a: lost, b: unicast */
+	EV_UNI_ACK,						/* a: msg */
+	EV_UNI_RETRANS,					/* a: msg, b: attempt */
+	EV_TIMER,						/* a: timer, b: generation */
+	EV_MSG,							/* a: subtype */
+};
+
+enum {
+	ANS_TRANSFER_START,
+	ANS_BLOCK_START,
+	ANS_BLOCK_GET,
+};
+
+struct sim_event {
+	uint64_t t;
+	uint32_t seq;
+	uint8_t type;
+	uint16_t a;
+	uint32_t b;
+};
+
+enum {
+	NODE_PENDING,
+	NODE_WAIT,
+	NODE_DONE,
+};
+
+struct sim_node {
+	uint16_t loss;
+	uint8_t far;
+	/* receiver */
+	uint16_t block;
+	uint8_t got[SIM_CHUNK_MAX / 8];
+	/* client view */
+	uint8_t active;
+	uint8_t phase;
+	uint16_t missing[SIM_CHUNK_MAX];
+	uint16_t missing_len;
+};
+
+/* a unicast segmented chunk message in the stack */
+struct sim_msg {
+	uint8_t used;
+	uint8_t node;
+	uint16_t chunk;
+	uint8_t attempt;
+	uint32_t node_missing;			/* segments the receiver does not have */
+	uint32_t unacked;				/* segments the client has no acknowledgment for */
+};
+
+enum {
+	PH_TRANSFER_START,
+	PH_BLOCK_START,
+	PH_CHUNK,
+	PH_BLOCK_GET,
+	PH_DONE,
+};
+
+struct sim_result {
+	uint64_t time_ms;
+	uint64_t air_client;
+	uint64_t air_node;
+	uint32_t group_msgs;
+	uint32_t unicast_msgs;
+	uint32_t status_msgs;
+	uint32_t group_status;
+	uint32_t group_retries;
+	uint32_t paced;
+	uint32_t failed;
+	uint32_t incomplete;
+	uint32_t bad_chunks;
+	uint8_t aborted;
+};
+
+/* a timer of the client, it outlives a run like the timers of the target */
+struct sim_timer {
+	uint8_t used;
+	uint8_t active;
+	uint8_t reload;
+	uint32_t period;
+	uint32_t gen;
+	const char *name;
+	void (*cb)(void *);
+};
+
+static struct {
+	const struct sim_cfg *cfg;
+	int app;
+	uint64_t rnd;
+	uint64_t now;
+	struct sim_event ev[SIM_EVENT_MAX];
+	uint32_t ev_num;
+	uint32_t ev_seq;
+
+	uint64_t air_free;
+	double util;
+
+	struct sim_node node[SIM_NODE_MAX];
+	int phase;
+	uint16_t block;
+	uint16_t total_blocks;
+	uint16_t total_chunks;
+	uint8_t seg_num;
+
+	/* status collection */
+	int cur;
+	int retry_count;
+	uint32_t retry_gen;
+
+	/* current client */
+	uint8_t sending[SIM_CHUNK_MAX / 8];
+
+	/* scheduled client, the counters start at its first block start */
+	uint64_t start_ms;
+	struct sim_msg msg[SIM_MSG_MAX];
+
+	struct sim_result res;
+} sim;
+
+static struct sim_timer sim_timer[SIM_TIMER_MAX];
+static mesh_model_info_t sim_client_model = { .model_id = MESH_MODEL_BLOB_TRANSFER_CLIENT };
+static model_data_cb_pf sim_client_data_cb;
+static model_send_cb_pf sim_client_send_cb;
+
+static uint32_t sim_rand(void)
+{
+	sim.rnd ^= sim.rnd >> 12;
+	sim.rnd ^= sim.rnd << 25;
+	sim.rnd ^= sim.rnd >> 27;
+	return (uint32_t)((sim.rnd * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static uint32_t sim_rand_range(uint32_t min, uint32_t max)
+{
+	return min + sim_rand() % (max - min + 1);
+}
+
+/*------------------------------------------------------------------*/
+/* events */
+
+static int sim_ev_before(const struct sim_event *a, const struct sim_event *b)
+{
+	return a->t < b->t || (a->t == b->t && a->seq < b->seq);
+}
+
+static void sim_ev_add(uint64_t t, uint8_t type, uint16_t a, uint32_t b)
+{
+	uint32_t i;
+
+	if (sim.ev_num == SIM_EVENT_MAX) {
+		printf("FAIL: event queue full\n");
+		exit(1);
+	}
+	i = sim.ev_num++;
+	sim.ev[i].t = t;
+	sim.ev[i].seq = sim.ev_seq++;
+	sim.ev[i].type = type;
+	sim.ev[i].a = a;
+	sim.ev[i].b = b;
+	while (i > 0 && sim_ev_before(&sim.ev[i], &sim.ev[(i - 1) / 2])) {
+		struct sim_event tmp = sim.ev[i];
+
+		sim.ev[i] = sim.ev[(i - 1) / 2];
+		sim.ev[(i - 1) / 2] = tmp;
+		i = (i - 1) / 2;
+	}
+}
+
+static struct sim_event sim_ev_pop(void)
+{
+	struct sim_event top = sim.ev[0];
+	uint32_t i = 0;
+
+	sim.ev[0] = sim.ev[--sim.ev_num];
+	for (;;) {
+		uint32_t l = 2 * i + 1, r = l + 1, m = i;
+		struct sim_event tmp;
+
+		if (l < sim.ev_num && sim_ev_before(&sim.ev[l], &sim.ev[m])) {
+			m = l;
+		}
+		if (r < sim.ev_num && sim_ev_before(&sim.ev[r], &sim.ev[m])) {
+			m = r;
+		}
+		if (m == i) {
+			break;
+		}
+		tmp = sim.ev[i];
+		sim.ev[i] = sim.ev[m];
+		sim.ev[m] = tmp;
+		i = m;
+	}
+	return top;
+}
+
+/*------------------------------------------------------------------*/
+/* air */
+
+/* client PDUs, returns when the last one is on the air */
+static uint64_t sim_air_send(uint32_t pdu_num)
+{
+	uint64_t start = sim.now > sim.air_free ? sim.now : sim.air_free;
+	double busy = (double)pdu_num * sim.cfg->pdu_ms;
+	double gap = (double)(start - sim.air_free);
+
+	if (sim.air_free == 0) {
+		gap = 0;
+	}
+	sim.util = 0.7 * sim.util + 0.3 * (busy / (busy + gap));
+	sim.air_free = start + (uint64_t)busy;
+	sim.res.air_client += pdu_num;
+	return sim.air_free;
+}
+
+/* per mille a receiver loses a client PDU */
+static uint32_t sim_loss(int n)
+{
+	double keep = 1.0 - sim.node[n].loss / 1000.0;
+
+	if (sim.node[n].far && sim.cfg->relay_pdu_ms) {
+		double rate = sim.util * 1000.0 / sim.cfg->pdu_ms;
+		double cap = 1000.0 / sim.cfg->relay_pdu_ms;
+
+		if (rate > cap) {
+			keep *= cap / rate;
+		}
+	}
+	return (uint32_t)((1.0 - keep) * 1000.0 + 0.5);
+}
+
+static int sim_lost(uint32_t loss)
+{
+	return sim_rand() % 1000 < loss;
+}
+
+/*------------------------------------------------------------------*/
+/* receivers */
+
+static void sim_block_set(uint16_t block)
+{
+	uint32_t left = sim.cfg->blob_size - (uint32_t)block * sim.cfg->block_size;
+	uint32_t size = left < sim.cfg->block_size ? left : sim.cfg->block_size;
+
+	sim.block = block;
+	sim.total_chunks = (size + sim.cfg->chunk_size - 1) / sim.cfg->chunk_size;
+}
+
+static void sim_node_block_start(int n)
+{
+	if (sim.node[n].block != sim.block) {
+		sim.node[n].block = sim.block;
+		memset(sim.node[n].got, 0, sizeof(sim.node[n].got));
+	}
+}
+
+static void sim_node_chunk_rx(int n, uint16_t chunk)
+{
+	if (sim.node[n].block == sim.block) {
+		sim.node[n].got[chunk / 8] |= 1 << (chunk % 8);
+	}
+}
+
+static uint16_t sim_node_missing(int n, uint16_t *missing)
+{
+	uint16_t len = 0;
+
+	for (uint16_t c = 0; c < sim.total_chunks; c++) {
+		if (!(sim.node[n].got[c / 8] & (1 << (c % 8)))) {
+			missing[len++] = c;
+		}
+	}
+	return len;
+}
+
+static void sim_node_fail(int n)
+{
+	sim.node[n].active = 0;
+	sim.res.failed++;
+}
+
+/* blocks the client completes while an active receiver still misses chunks */
+static void sim_block_check(void)
+{
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		uint16_t missing[SIM_CHUNK_MAX];
+
+		if (sim.node[n].active && sim_node_missing(n, missing) != 0) {
+			sim.res.incomplete++;
+		}
+	}
+}
+
+/* a status request to one receiver or to the group, the answers which reach the client are queued */
+static void sim_query(int dst, uint8_t ans)
+{
+	uint64_t t = sim_air_send(1);
+	uint64_t rsp[SIM_NODE_MAX];
+	int rsp_node[SIM_NODE_MAX];
+	int rsp_num = 0;
+
+	sim.res.status_msgs++;
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		if ((dst != SIM_GROUP && dst != n) || !sim.node[n].active || sim_lost(sim_loss(n))) {
+			continue;
+		}
+		if (ans == ANS_BLOCK_START) {
+			sim_node_block_start(n);
+		}
+		rsp[rsp_num] = t + (dst == SIM_GROUP ? sim_rand_range(SIM_GROUP_RSP_MIN, SIM_GROUP_RSP_MAX) :
+							sim_rand_range(SIM_UNICAST_RSP_MIN, SIM_UNICAST_RSP_MAX));
+		rsp_node[rsp_num++] = n;
+	}
+	sim.res.air_node += rsp_num;
+	for (int i = 0; i < rsp_num; i++) {
+		int collide = 0;
+
+		for (int j = 0; j < rsp_num; j++) {
+			if (j != i && rsp[i] < rsp[j] + SIM_RSP_COLLIDE_MS && rsp[j] < rsp[i] + SIM_RSP_COLLIDE_MS) {
+				collide = 1;
+				break;
+			}
+		}
+		if (!collide && !sim_lost(sim.node[rsp_node[i]].loss)) {
+			sim_ev_add(rsp[i], EV_STATUS, rsp_node[i], ans);
+		}
+	}
+}
+
+/*------------------------------------------------------------------*/
+/* chunks */
+
+static void sim_group_chunk(uint16_t chunk)
+{
+	uint64_t t = sim_air_send(sim.seg_num * sim.cfg->group_tx_times);
+
+	sim.res.group_msgs++;
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		uint32_t loss = sim_loss(n);
+		int ok = 1;
+
+		for (int s = 0; s < sim.seg_num && ok; s++) {
+			int seg_ok = 0;
+
+			for (int k = 0; k < sim.cfg->group_tx_times && !seg_ok; k++) {
+				seg_ok = !sim_lost(loss);
+			}
+			ok = seg_ok;
+		}
+		if (ok) {
+			sim_node_chunk_rx(n, chunk);
+		}
+	}
+	sim_ev_add(t, EV_TX_DONE, 0, 0);
+}
+
+static void sim_unicast_send(int m)
+{
+	struct sim_msg *msg = &sim.msg[m];
+	uint32_t loss = sim_loss(msg->node);
+	uint32_t segs = 0;
+	int rx = 0;
+	uint64_t t;
+
+	for (int s = 0; s < sim.seg_num; s++) {
+		if (msg->unacked & (1u << s)) {
+			segs++;
+			if (!sim_lost(loss)) {
+				msg->node_missing &= ~(1u << s);
+				rx = 1;
+			}
+		}
+	}
+	t = sim_air_send(segs);
+	if (msg->node_missing == 0) {
+		sim_node_chunk_rx(msg->node, msg->chunk);
+	}
+	if (rx) {
+		sim.res.air_node++;
+		if (!sim_lost(sim.node[msg->node].loss)) {
+			sim_ev_add(t + SIM_ACK_DELAY, EV_UNI_ACK, m, 0);
+			return;
+		}
+	}
+	sim_ev_add(t + 200 + 30 * sim.seg_num, EV_UNI_RETRANS, m, msg->attempt);
+}
+
+static void sim_unicast_end(int m, int lost)
+{
+	sim.msg[m].used = 0;
+	sim_ev_add(sim.now, EV_TX_DONE, lost, 1);
+}
+
+static void sim_unicast_retrans(int m)
+{
+	struct sim_msg *msg = &sim.msg[m];
+
+	if (msg->attempt >= SIM_TRANS_RETRANS) {
+		sim_unicast_end(m, 1);
+		return;
+	}
+	msg->attempt++;
+	sim_unicast_send(m);
+}
+
+static void sim_on_uni_ack(int m)
+{
+	struct sim_msg *msg = &sim.msg[m];
+
+	msg->unacked = msg->node_missing;
+	if (msg->unacked == 0) {
+		sim_unicast_end(m, 0);
+	} else {
+		sim_unicast_retrans(m);
+	}
+}
+
+static void sim_unicast_chunk(int n, uint16_t chunk)
+{
+	int m;
+
+	for (m = 0; m < SIM_MSG_MAX && sim.msg[m].used; m++) {
+	}
+	if (m == SIM_MSG_MAX) {
+		printf("FAIL: unicast message pool full\n");
+		exit(1);
+	}
+	sim.res.unicast_msgs++;
+	sim.msg[m].used = 1;
+	sim.msg[m].node = n;
+	sim.msg[m].chunk = chunk;
+	sim.msg[m].attempt = 0;
+	sim.msg[m].node_missing = (sim.seg_num >= 32) ? 0xFFFFFFFFu : ((1u << sim.seg_num) - 1);
+	sim.msg[m].unacked = sim.msg[m].node_missing;
+	sim_unicast_send(m);
+}
+
+/*------------------------------------------------------------------*/
+/* current client */
+
+static void sim_status_complete(void);
+
+static int sim_active_num(void)
+{
+	int num = 0;
+
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		num += sim.node[n].active;
+	}
+	return num;
+}
+
+static void sim_retry_start(uint32_t period)
+{
+	sim_ev_add(sim.now + period, EV_RETRY, 0, ++sim.retry_gen);
+}
+
+static void sim_status_ask(int n)
+{
+	sim.node[n].phase = NODE_WAIT;
+	sim_query(n, sim.phase == PH_BLOCK_START ? ANS_BLOCK_START : ANS_BLOCK_GET);
+}
+
+static void sim_status_next(void)
+{
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		if (sim.node[n].active && sim.node[n].phase != NODE_DONE) {
+			sim.cur = n;
+			sim.retry_count = 0;
+			sim_status_ask(n);
+			sim_retry_start(SIM_RETRY_PERIOD);
+			return;
+		}
+	}
+	sim_status_complete();
+}
+
+static void sim_status_begin(void)
+{
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		sim.node[n].phase = NODE_PENDING;
+	}
+	sim_status_next();
+}
+
+static void sim_on_status(int n, uint8_t ans)
+{
+	struct sim_node *node = &sim.node[n];
+
+	if (!node->active || node->phase != NODE_WAIT ||
+		(sim.phase == PH_BLOCK_START) != (ans == ANS_BLOCK_START)) {
+		return;
+	}
+	node->phase = NODE_DONE;
+	node->missing_len = sim_node_missing(n, node->missing);
+	if (n == sim.cur) {
+		sim.retry_gen++;
+		sim_status_next();
+	}
+}
+
+static void sim_on_retry(uint32_t gen)
+{
+	if (gen != sim.retry_gen || (sim.phase != PH_BLOCK_START && sim.phase != PH_BLOCK_GET)) {
+		return;
+	}
+	if (sim.retry_count >= SIM_RETRY_TIMES) {
+		sim_node_fail(sim.cur);
+		sim_status_next();
+		return;
+	}
+	sim.retry_count++;
+	sim_status_ask(sim.cur);
+	sim_retry_start(SIM_RETRY_PERIOD);
+}
+
+/* the union of the missing chunks to the group address, one at a time */
+static void sim_current_next(void)
+{
+	for (uint16_t c = 0; c < sim.total_chunks; c++) {
+		if (sim.sending[c / 8] & (1 << (c % 8))) {
+			sim.sending[c / 8] &= ~(1 << (c % 8));
+			sim_group_chunk(c);
+			return;
+		}
+	}
+	sim.phase = PH_BLOCK_GET;
+	sim_status_begin();
+}
+
+static void sim_block_start(void)
+{
+	sim_block_set(sim.block);
+	sim.phase = PH_BLOCK_START;
+	sim_status_begin();
+}
+
+static void sim_block_complete(void)
+{
+	sim_block_check();
+	if (sim.block + 1 == sim.total_blocks) {
+		sim.phase = PH_DONE;
+		return;
+	}
+	sim.block++;
+	sim_block_start();
+}
+
+static void sim_status_complete(void)
+{
+	uint32_t missing_num = 0;
+
+	if (sim_active_num() == 0) {
+		sim.phase = PH_DONE;
+		return;
+	}
+	memset(sim.sending, 0, sizeof(sim.sending));
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		if (!sim.node[n].active || sim.node[n].phase != NODE_DONE) {
+			continue;
+		}
+		for (uint16_t i = 0; i < sim.node[n].missing_len; i++) {
+			uint16_t c = sim.node[n].missing[i];
+
+			sim.sending[c / 8] |= 1 << (c % 8);
+		}
+	}
+	for (uint16_t c = 0; c < sim.total_chunks; c++) {
+		missing_num += (sim.sending[c / 8] >> (c % 8)) & 1;
+	}
+	if (missing_num == 0) {
+		sim_block_complete();
+		return;
+	}
+	sim.phase = PH_CHUNK;
+	sim_current_next();
+}
+
+/*------------------------------------------------------------------*/
+/* what blob_client_app.c links against on the target */
+
+mesh_node_t mesh_node;
+uint32_t mesh_log_switch[MESH_LOG_LEVEL_COUNT][MESH_LOG_LEVEL_SIZE];
+
+void trace_log_buffer(uint32_t info, uint32_t log_str_index, uint8_t param_num, ...)
+{
+	(void)info;
+	(void)log_str_index;
+	(void)param_num;
+}
+
+const char *trace_binary(uint32_t info, uint16_t length, uint8_t *p_data)
+{
+	(void)info;
+	(void)length;
+	(void)p_data;
+	return "";
+}
+
+void plt_list_push(plt_list_t *plist, void *plist_e)
+{
+	plt_list_e_t *pe = (plt_list_e_t *)plist_e;
+
+	pe->pnext = NULL;
+	if (plist->plast) {
+		plist->plast->pnext = pe;
+	} else {
+		plist->pfirst = pe;
+	}
+	plist->plast = pe;
+	plist->count++;
+}
+
+void plt_list_remove(plt_list_t *plist, void *plist_e)
+{
+	plt_list_e_t *prev = NULL, *pe = plist->pfirst;
+
+	while (pe && pe != plist_e) {
+		prev = pe;
+		pe = pe->pnext;
+	}
+	if (pe == NULL) {
+		return;
+	}
+	if (prev) {
+		prev->pnext = pe->pnext;
+	} else {
+		plist->pfirst = pe->pnext;
+	}
+	if (plist->plast == pe) {
+		plist->plast = prev;
+	}
+	plist->count--;
+}
+
+void *plt_os_mem_zalloc(RAM_TYPE ram_type, uint32_t size)
+{
+	(void)ram_type;
+	return calloc(1, size);
+}
+
+void plt_os_mem_free(void *p)
+{
+	free(p);
+}
+
+uint32_t plt_exp2(uint8_t log)
+{
+	return 1UL << log;
+}
+
+plt_timer_t plt_timer_create(const char *name, uint32_t period_ms, bool reload, uint32_t timer_id,
+							 void (*pf_cb)(void *))
+{
+	(void)timer_id;
+	for (int i = 0; i < SIM_TIMER_MAX; i++) {
+		if (!sim_timer[i].used) {
+			sim_timer[i].used = 1;
+			sim_timer[i].active = 0;
+			sim_timer[i].reload = reload;
+			sim_timer[i].period = period_ms;
+			sim_timer[i].name = name;
+			sim_timer[i].cb = pf_cb;
+			return &sim_timer[i];
+		}
+	}
+	return NULL;
+}
+
+void plt_timer_remove(plt_timer_t timer)
+{
+	struct sim_timer *ptimer = (struct sim_timer *)timer;
+
+	ptimer->used = 0;
+	ptimer->active = 0;
+	ptimer->gen++;
+}
+
+bool plt_timer_is_active(plt_timer_t timer)
+{
+	return ((struct sim_timer *)timer)->active;
+}
+
+bool os_timer_start(void **pp_handle)
+{
+	struct sim_timer *ptimer = (struct sim_timer *)*pp_handle;
+
+	ptimer->active = 1;
+	sim_ev_add(sim.now + ptimer->period, EV_TIMER, (uint16_t)(ptimer - sim_timer), ++ptimer->gen);
+	return true;
+}
+
+bool os_timer_restart(void **pp_handle, uint32_t interval_ms)
+{
+	((struct sim_timer *)*pp_handle)->period = interval_ms;
+	return os_timer_start(pp_handle);
+}
+
+/* the BT API task queue */
+uint16_t bt_stack_msg_send(uint16_t type, uint16_t subtype, void *msg)
+{
+	(void)type;
+	(void)msg;
+	sim_ev_add(sim.now, EV_MSG, subtype, 0);
+	return 0;
+}
+
+void blob_transfer_client_reg(uint8_t element_index, model_data_cb_pf model_data_cb)
+{
+	(void)element_index;
+	sim_client_data_cb = model_data_cb;
+}
+
+void blob_transfer_client_set_send_cb(model_send_cb_pf model_send_cb)
+{
+	sim_client_send_cb = model_send_cb;
+}
+
+static int sim_dst(uint16_t dst)
+{
+	return dst == SIM_GROUP_ADDR ? SIM_GROUP : dst - SIM_ADDR_BASE;
+}
+
+/* the first block start of the scheduled client starts the clock */
+static void sim_app_block(uint16_t block_num)
+{
+	if (sim.phase == PH_TRANSFER_START) {
+		uint32_t failed = sim.res.failed;
+
+		memset(&sim.res, 0, sizeof(sim.res));
+		sim.res.failed = failed;
+		sim.start_ms = sim.now;
+	}
+	sim_block_set(block_num);
+}
+
+mesh_msg_send_cause_t blob_transfer_start(uint16_t dst, uint16_t app_key_index,
+										  blob_transfer_mode_t mode, uint8_t blob_id[8], uint32_t blob_size,
+										  uint8_t block_size_log, uint16_t client_mtu_size)
+{
+	(void)app_key_index;
+	(void)mode;
+	(void)blob_id;
+	(void)blob_size;
+	(void)block_size_log;
+	(void)client_mtu_size;
+	sim_query(sim_dst(dst), ANS_TRANSFER_START);
+	return MESH_MSG_SEND_CAUSE_SUCCESS;
+}
+
+mesh_msg_send_cause_t blob_block_start(uint16_t dst, uint16_t app_key_index, uint16_t block_num,
+									   uint16_t chunk_size)
+{
+	(void)app_key_index;
+	(void)chunk_size;
+	sim_app_block(block_num);
+	sim.phase = PH_BLOCK_START;
+	sim.res.group_status += (dst == SIM_GROUP_ADDR);
+	sim_query(sim_dst(dst), ANS_BLOCK_START);
+	return MESH_MSG_SEND_CAUSE_SUCCESS;
+}
+
+mesh_msg_send_cause_t blob_block_get(uint16_t dst, uint16_t app_key_index)
+{
+	(void)app_key_index;
+	sim.phase = PH_BLOCK_GET;
+	sim.res.group_status += (dst == SIM_GROUP_ADDR);
+	sim_query(sim_dst(dst), ANS_BLOCK_GET);
+	return MESH_MSG_SEND_CAUSE_SUCCESS;
+}
+
+static uint8_t sim_blob_byte(uint32_t offset)
+{
+	return (uint8_t)(offset ^ (offset >> 8) ^ 0x5A);
+}
+
+mesh_msg_send_cause_t blob_chunk_transfer(uint16_t dst, uint16_t app_key_index, uint16_t chunk_num,
+										  uint8_t *pdata, uint16_t len)
+{
+	uint32_t offset = (uint32_t)sim.block * sim.cfg->block_size + (uint32_t)chunk_num * sim.cfg->chunk_size;
+	uint32_t expect = sim.cfg->blob_size - offset < sim.cfg->chunk_size ? sim.cfg->blob_size - offset :
+					  sim.cfg->chunk_size;
+
+	(void)app_key_index;
+	if (len != expect) {
+		sim.res.bad_chunks++;
+	} else {
+		for (uint16_t i = 0; i < len; i++) {
+			if (pdata[i] != sim_blob_byte(offset + i)) {
+				sim.res.bad_chunks++;
+				break;
+			}
+		}
+	}
+	sim.phase = PH_CHUNK;
+	if (dst == SIM_GROUP_ADDR) {
+		sim_group_chunk(chunk_num);
+	} else {
+		sim_unicast_chunk(sim_dst(dst), chunk_num);
+	}
+	return MESH_MSG_SEND_CAUSE_SUCCESS;
+}
+
+mesh_msg_send_cause_t blob_info_get(uint16_t dst, uint16_t app_key_index)
+{
+	(void)dst;
+	(void)app_key_index;
+	return MESH_MSG_SEND_CAUSE_SUCCESS;
+}
+
+mesh_msg_send_cause_t blob_transfer_cancel(uint16_t dst, uint16_t app_key_index, uint8_t blob_id[8])
+{
+	(void)dst;
+	(void)app_key_index;
+	(void)blob_id;
+	return MESH_MSG_SEND_CAUSE_SUCCESS;
+}
+
+/*------------------------------------------------------------------*/
+/* scheduled client */
+
+static uint16_t sim_app_cb(uint8_t type, void *pdata)
+{
+	if (type == MESH_MSG_BLOB_CLIENT_APP_BLOCK_LOAD) {
+		blob_client_app_block_load_t *pload = (blob_client_app_block_load_t *)pdata;
+
+		for (uint32_t i = 0; i < pload->block_size; i++) {
+			pload->pblock_data[i] = sim_blob_byte(pload->offset + i);
+		}
+	} else if (type == MESH_MSG_BLOB_CLIENT_APP_TRANSFER) {
+		blob_client_app_transfer_t *ptransfer = (blob_client_app_transfer_t *)pdata;
+
+		if (ptransfer->procedure != BLOB_CB_PROCEDURE_TRANSFER) {
+			return 0;
+		}
+		switch (ptransfer->type) {
+		case BLOB_CB_TYPE_NODE_FAIL:
+			sim_node_fail(ptransfer->addr - SIM_ADDR_BASE);
+			break;
+		case BLOB_CB_TYPE_PROGRESS:
+			sim_block_check();
+			break;
+		case BLOB_CB_TYPE_FAIL:
+			/* the client gives up on its own only when every receiver failed */
+			sim.res.aborted = sim_active_num() > 0;
+			sim.phase = PH_DONE;
+			break;
+		default:
+			sim.phase = PH_DONE;
+			break;
+		}
+	}
+	return 0;
+}
+
+static void sim_app_status(int n, uint8_t ans)
+{
+	uint16_t missing[SIM_CHUNK_MAX];
+
+	if (ans == ANS_TRANSFER_START) {
+		blob_transfer_client_transfer_status_t status = {0};
+
+		status.src = SIM_ADDR_BASE + n;
+		status.status = BLOB_TRANSFER_STATUS_SUCCESS;
+		status.transfer_mode = BLOB_TRANSFER_MODE_PUSH;
+		status.transfer_phase = BLOB_TRANSFER_PHASE_WAITING_BLOCK;
+		sim_client_data_cb(&sim_client_model, BLOB_TRANSFER_CLIENT_TRANSFER_STATUS, &status);
+	} else {
+		blob_transfer_client_block_status_t status = {0};
+
+		status.src = SIM_ADDR_BASE + n;
+		status.status = BLOB_TRANSFER_STATUS_SUCCESS;
+		status.block_num = sim.block;
+		status.chunk_size = sim.cfg->chunk_size;
+		status.missing_chunks_len = sim_node_missing(n, missing);
+		status.pmissing_chunks = missing;
+		if (status.missing_chunks_len == 0) {
+			status.missing_format = BLOB_CHUNK_MISSING_FORMAT_NONE;
+		} else if (status.missing_chunks_len == sim.total_chunks) {
+			status.missing_format = BLOB_CHUNK_MISSING_FORMAT_ALL;
+		} else {
+			status.missing_format = BLOB_CHUNK_MISSING_FORMAT_SOME;
+		}
+		sim_client_data_cb(&sim_client_model, BLOB_TRANSFER_CLIENT_BLOCK_STATUS, &status);
+	}
+}
+
+static void sim_app_tx_done(int lost, int unicast)
+{
+	mesh_msg_send_stat_t stat;
+
+	if (sim_client_send_cb == NULL) {
+		return;
+	}
+	if (unicast) {
+		stat = lost ? MESH_MSG_SEND_STAT_TIMEOUT : MESH_MSG_SEND_STAT_ACKED;
+	} else {
+		/* nothing acknowledges a segmented message to a group address */
+		stat = sim.seg_num > 1 ? MESH_MSG_SEND_STAT_TIMEOUT : MESH_MSG_SEND_STAT_SENT;
+	}
+	sim_client_send_cb(&sim_client_model, stat, MESH_MSG_BLOB_CHUNK_TRANSFER);
+}
+
+static void sim_app_timer(int i, uint32_t gen)
+{
+	struct sim_timer *ptimer = &sim_timer[i];
+
+	if (!ptimer->used || !ptimer->active || ptimer->gen != gen) {
+		return;
+	}
+	if (ptimer->reload) {
+		sim_ev_add(sim.now + ptimer->period, EV_TIMER, i, gen);
+	} else {
+		ptimer->active = 0;
+	}
+	if (strcmp(ptimer->name, "blob_pc") == 0) {
+		sim.res.paced++;
+	} else if (strcmp(ptimer->name, "blob_cr") == 0 && ptimer->period == SIM_GROUP_STATUS_PERIOD &&
+			   (sim.phase == PH_BLOCK_START || sim.phase == PH_BLOCK_GET)) {
+		sim.res.group_retries++;
+	}
+	ptimer->cb(NULL);
+}
+
+/* the BT API task, as rtk_stack_mesh_common.c dispatches the messages of the client */
+static void sim_app_msg(uint16_t subtype)
+{
+	switch (subtype) {
+	case RTK_BT_MESH_IO_MSG_SUBTYPE_BLOB_CLIENT_PROCEDURE:
+		blob_client_handle_procedure_timeout();
+		break;
+	case RTK_BT_MESH_IO_MSG_SUBTYPE_BLOB_CLIENT_RETRY:
+		blob_client_handle_retry_timeout();
+		break;
+	case RTK_BT_MESH_IO_MSG_SUBTYPE_BLOB_CLIENT_CHUNK_TRANSFER:
+		blob_client_active_chunk_transfer();
+		break;
+	default:
+		break;
+	}
+}
+
+static void sim_app_start(void)
+{
+	uint16_t addr[SIM_NODE_MAX];
+	uint8_t blob_id[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+	uint8_t block_size_log = 0;
+
+	while ((1u << block_size_log) < sim.cfg->block_size) {
+		block_size_log++;
+	}
+	for (int n = 0; n < sim.cfg->node_num; n++) {
+		addr[n] = SIM_ADDR_BASE + n;
+	}
+	mesh_node.trans_retrans_count = sim.cfg->group_tx_times - 1;
+	blob_client_block_size_log_set(block_size_log);
+	blob_client_chunk_size_set(sim.cfg->chunk_size);
+	sim.phase = PH_TRANSFER_START;
+	if (!blob_client_blob_transfer(SIM_GROUP_ADDR, 0, SIM_TTL, addr, sim.cfg->node_num, blob_id,
+								   sim.cfg->blob_size, BLOB_TRANSFER_MODE_PUSH, SIM_TIMEOUT_BASE, true)) {
+		printf("FAIL: blob client transfer start\n");
+		exit(1);
+	}
+}
+
+/*------------------------------------------------------------------*/
+
+static void sim_run(const struct sim_cfg *cfg, int app, struct sim_result *res)
+{
+	uint16_t len = cfg->chunk_size + 3;
+	int bad = cfg->node_num * cfg->bad_percent / 100;
+	int far = cfg->node_num * cfg->far_percent / 100;
+
+	memset(&sim, 0, sizeof(sim));
+	sim.cfg = cfg;
+	sim.app = app;
+	sim.rnd = 0x9E3779B97F4A7C15ULL;
+	sim.total_blocks = (cfg->blob_size + cfg->block_size - 1) / cfg->block_size;
+	sim.seg_num = (len <= 11) ? 1 : (len + 4 + 11) / 12;
+	for (int n = 0; n < cfg->node_num; n++) {
+		/* bad receivers first, far receivers last, so both sets overlap as little as possible */
+		sim.node[n].loss = n < bad ? cfg->bad_loss : cfg->loss;
+		sim.node[n].far = n >= cfg->node_num - far;
+		sim.node[n].active = 1;
+		sim.node[n].block = 0xFFFF;
+	}
+
+	if (app) {
+		sim_app_start();
+	} else {
+		sim_block_start();
+	}
+	while (sim.phase != PH_DONE && sim.ev_num > 0 && sim.now < SIM_TIME_LIMIT) {
+		struct sim_event ev = sim_ev_pop();
+
+		sim.now = ev.t;
+		switch (ev.type) {
+		case EV_STATUS:
+			if (app) {
+				sim_app_status(ev.a, ev.b);
+			} else {
+				sim_on_status(ev.a, ev.b);
+			}
+			break;
+		case EV_RETRY:
+			sim_on_retry(ev.b);
+			break;
+		case EV_TX_DONE:
+			if (app) {
+				sim_app_tx_done(ev.a, ev.b);
+			} else {
+				sim_current_next();
+			}
+			break;
+		case EV_UNI_ACK:
+			sim_on_uni_ack(ev.a);
+			break;
+		case EV_UNI_RETRANS:
+			if (sim.msg[ev.a].used && sim.msg[ev.a].attempt == ev.b) {
+				sim_unicast_retrans(ev.a);
+			}
+			break;
+		case EV_TIMER:
+			sim_app_timer(ev.a, ev.b);
+			break;
+		case EV_MSG:
+			sim_app_msg(ev.a);
+			break;
+		}
+	}
+	if (sim.phase != PH_DONE) {
+		printf("FAIL: transfer stuck in phase %d at %llu ms\n", sim.phase, (unsigned long long)sim.now);
+		exit(1);
+	}
+	sim.res.time_ms = sim.now - sim.start_ms;
+	*res = sim.res;
+}
+
+static int sim_compare(const struct sim_cfg *cfg, struct sim_result *sched)
+{
+	struct sim_result cur;
+
+	sim_run(cfg, 0, &cur);
+	sim_run(cfg, 1, sched);
+	printf("%-22s %5u %5u %4u%%/%-4u %3u%%/%-3u | %8.1f %8llu %5u %5u %4u | %8.1f %8llu %5u %5u %5u %4u %4u %5u %4u | %5.2fx %5.2fx\n",
+		   cfg->name, cfg->node_num, cfg->loss, cfg->bad_percent, cfg->bad_loss, cfg->far_percent,
+		   cfg->relay_pdu_ms,
+		   cur.time_ms / 1000.0, (unsigned long long)(cur.air_client + cur.air_node), cur.group_msgs,
+		   cur.status_msgs, cur.failed,
+		   sched->time_ms / 1000.0, (unsigned long long)(sched->air_client + sched->air_node),
+		   sched->group_msgs, sched->unicast_msgs, sched->status_msgs, sched->group_status,
+		   sched->group_retries, sched->paced, sched->failed,
+		   (double)cur.time_ms / sched->time_ms,
+		   (double)(cur.air_client + cur.air_node) / (sched->air_client + sched->air_node));
+	if (cur.incomplete || sched->incomplete) {
+		printf("FAIL: %s: blocks completed with receivers missing chunks (%u, %u)\n", cfg->name,
+			   cur.incomplete, sched->incomplete);
+		return 1;
+	}
+	if (sched->aborted || sched->bad_chunks) {
+		printf("FAIL: %s: scheduled client aborted %u, chunks with wrong data %u\n", cfg->name,
+			   sched->aborted, sched->bad_chunks);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	static const struct sim_cfg base = {
+		.blob_size = 32768,
+		.block_size = 4096,
+		.chunk_size = 256,
+		.pdu_ms = 20,
+		.group_tx_times = 5,
+	};
+	struct sim_cfg cfgs[8];
+	struct sim_result sched, total = {0};
+	int cfg_num = 0;
+	int fail = 0;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	if (argc > 2) {
+		cfgs[0] = base;
+		cfgs[0].name = "command line";
+		cfgs[0].node_num = atoi(argv[1]);
+		cfgs[0].loss = atoi(argv[2]);
+		if (argc > 4) {
+			cfgs[0].bad_percent = atoi(argv[3]);
+			cfgs[0].bad_loss = atoi(argv[4]);
+		}
+		if (argc > 6) {
+			cfgs[0].far_percent = atoi(argv[5]);
+			cfgs[0].relay_pdu_ms = atoi(argv[6]);
+		}
+		if (cfgs[0].node_num == 0 || cfgs[0].node_num > SIM_NODE_MAX) {
+			printf("nodes 1..%d\n", SIM_NODE_MAX);
+			return 1;
+		}
+		cfg_num = 1;
+	} else {
+		static const struct {
+			const char *name;
+			uint16_t node_num, loss, bad_percent, bad_loss, far_percent, relay_pdu_ms;
+		} table[] = {
+			{ "few nodes",          4,  50,  0,   0,  0,  0 },
+			{ "dozens, clean",     32,  20,  0,   0,  0,  0 },
+			{ "dozens, lossy",     32, 100,  0,   0,  0,  0 },
+			{ "dozens, bad nodes", 32,  50, 20, 300,  0,  0 },
+			{ "many, bad nodes",   96,  50, 10, 300,  0,  0 },
+			{ "behind busy relay", 32,  50,  0,   0, 50, 40 },
+		};
+
+		for (cfg_num = 0; cfg_num < (int)(sizeof(table) / sizeof(table[0])); cfg_num++) {
+			cfgs[cfg_num] = base;
+			cfgs[cfg_num].name = table[cfg_num].name;
+			cfgs[cfg_num].node_num = table[cfg_num].node_num;
+			cfgs[cfg_num].loss = table[cfg_num].loss;
+			cfgs[cfg_num].bad_percent = table[cfg_num].bad_percent;
+			cfgs[cfg_num].bad_loss = table[cfg_num].bad_loss;
+			cfgs[cfg_num].far_percent = table[cfg_num].far_percent;
+			cfgs[cfg_num].relay_pdu_ms = table[cfg_num].relay_pdu_ms;
+		}
+	}
+
+	blob_client_app_init(0, sim_app_cb);
+
+	printf("blob %u bytes, block %u, chunk %u, PDU %u ms, group segments sent %u times\n",
+		   base.blob_size, base.block_size, base.chunk_size, base.pdu_ms, base.group_tx_times);
+	printf("%-22s %5s %5s %9s %8s | %-31s | %-53s | speedup\n", "", "nodes", "loss", "bad", "relay",
+		   "current client", "scheduled client (blob_client_app.c)");
+	printf("%-22s %5s %5s %9s %8s | %8s %8s %5s %5s %4s | %8s %8s %5s %5s %5s %4s %4s %5s %4s | %5s %6s\n", "",
+		   "", "", "", "", "time s", "air pkt", "group", "stat", "fail", "time s", "air pkt", "group", "uni",
+		   "stat", "gst", "gre", "pace", "fail", "time", "air");
+	for (int i = 0; i < cfg_num; i++) {
+		fail |= sim_compare(&cfgs[i], &sched);
+		total.group_status += sched.group_status;
+		total.group_retries += sched.group_retries;
+		total.paced += sched.paced;
+	}
+	/* the scenarios together go through the group status, its retry and the pacing */
+	if (argc <= 2 && (total.group_status == 0 || total.group_retries == 0 || total.paced == 0)) {
+		printf("FAIL: group status %u, group status retries %u, paced chunks %u\n", total.group_status,
+			   total.group_retries, total.paced);
+		fail = 1;
+	}
+	printf("%s\n", fail ? "FAIL" : "done");
+	return fail;
+}
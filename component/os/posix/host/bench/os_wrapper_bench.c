@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host benchmarks of the os_wrapper primitives and of components using them.
+ * Wall clock figures are host measurements. In deterministic mode the switch count and the
+ * virtual time printed for every case are identical from run to run.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "os_wrapper_specific.h"
+#ifdef RTOS_POSIX_HAS_RINGBUFFER
+#include "ringbuffer.h"
+#endif
+
+#define BENCH_STACK_SIZE		4096
+#define BENCH_PINGPONG_ROUNDS	20000
+#define BENCH_QUEUE_MSGS		100000
+#define BENCH_QUEUE_DEPTH		16
+#define BENCH_MUTEX_TASKS		4
+#define BENCH_MUTEX_LOOPS		20000
+#define BENCH_TIMER_TICKS		200
+#define BENCH_TIMER_PERIOD_MS	2
+#define BENCH_RB_BYTES			(8 * 1024 * 1024)
+#define BENCH_RB_SIZE			4096
+#define BENCH_RB_CHUNK			512
+
+static rtos_sema_t bench_done;
+static int bench_fail;
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct bench_run {
+	uint64_t wall;
+	uint64_t switches;
+	uint64_t virt_us;
+};
+
+static void bench_begin(struct bench_run *run)
+{
+	run->wall = bench_wall_ns();
+	run->switches = rtos_posix_get_switch_count();
+	run->virt_us = rtos_time_get_current_system_time_us();
+}
+
+static void bench_end(struct bench_run *run, const char *name, uint32_t ops, const char *unit)
+{
+	uint64_t wall = bench_wall_ns() - run->wall;
+
+	printf("%-22s %10.1f ns/%-6s %10.0f %s/s  switches %-8llu time %llu us\n", name,
+		   (double)wall / ops, unit, ops * 1e9 / wall, unit,
+		   (unsigned long long)(rtos_posix_get_switch_count() - run->switches),
+		   (unsigned long long)(rtos_time_get_current_system_time_us() - run->virt_us));
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+/* semaphore ping-pong, one round trip is two gives and two wake-ups */
+static rtos_sema_t pp_ping, pp_pong;
+
+static void pingpong_peer(void *param)
+{
+	int i;
+
+	(void) param;
+	for (i = 0; i < BENCH_PINGPONG_ROUNDS; i++) {
+		rtos_sema_take(pp_ping, RTOS_MAX_DELAY);
+		rtos_sema_give(pp_pong);
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_pingpong(void)
+{
+	struct bench_run run;
+	int i;
+
+	rtos_sema_create_binary(&pp_ping);
+	rtos_sema_create_binary(&pp_pong);
+	rtos_task_create(NULL, "pp_peer", pingpong_peer, NULL, BENCH_STACK_SIZE, 5);
+
+	bench_begin(&run);
+	for (i = 0; i < BENCH_PINGPONG_ROUNDS; i++) {
+		rtos_sema_give(pp_ping);
+		bench_check(rtos_sema_take(pp_pong, 1000) == RTK_SUCCESS, "pingpong timeout");
+	}
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	bench_end(&run, "sema ping-pong", BENCH_PINGPONG_ROUNDS, "round");
+
+	rtos_sema_delete(pp_ping);
+	rtos_sema_delete(pp_pong);
+}
+
+/* queue throughput, 32 byte messages through a shallow queue */
+struct bench_msg {
+	uint32_t seq;
+	uint32_t payload[7];
+};
+
+static rtos_queue_t q_queue;
+
+static void queue_consumer(void *param)
+{
+	struct bench_msg msg;
+	uint32_t i;
+
+	(void) param;
+	for (i = 0; i < BENCH_QUEUE_MSGS; i++) {
+		rtos_queue_receive(q_queue, &msg, RTOS_MAX_DELAY);
+		bench_check(msg.seq == i && msg.payload[6] == i * 7, "queue order");
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_queue(void)
+{
+	struct bench_run run;
+	struct bench_msg msg;
+	uint32_t i;
+
+	rtos_queue_create(&q_queue, BENCH_QUEUE_DEPTH, sizeof(struct bench_msg));
+	rtos_task_create(NULL, "q_consumer", queue_consumer, NULL, BENCH_STACK_SIZE, 5);
+
+	bench_begin(&run);
+	for (i = 0; i < BENCH_QUEUE_MSGS; i++) {
+		msg.seq = i;
+		msg.payload[6] = i * 7;
+		rtos_queue_send(q_queue, &msg, RTOS_MAX_DELAY);
+	}
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	bench_end(&run, "queue send/receive", BENCH_QUEUE_MSGS, "msg");
+
+	rtos_queue_delete(q_queue);
+}
+
+/* mutex contention, tasks of different priorities hammer one counter */
+static rtos_mutex_t mtx;
+static volatile uint32_t mtx_counter;
+
+static void mutex_worker(void *param)
+{
+	uint32_t i, v;
+
+	(void) param;
+	for (i = 0; i < BENCH_MUTEX_LOOPS; i++) {
+		rtos_mutex_take(mtx, RTOS_MAX_DELAY);
+		v = mtx_counter;
+		if ((i & 63) == 0) {
+			rtos_task_yield();
+		}
+		mtx_counter = v + 1;
+		rtos_mutex_give(mtx);
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_mutex(void)
+{
+	struct bench_run run;
+	int i;
+
+	rtos_mutex_create(&mtx);
+	mtx_counter = 0;
+
+	bench_begin(&run);
+	for (i = 0; i < BENCH_MUTEX_TASKS; i++) {
+		rtos_task_create(NULL, "mtx_worker", mutex_worker, NULL, BENCH_STACK_SIZE, 2 + i);
+	}
+	for (i = 0; i < BENCH_MUTEX_TASKS; i++) {
+		rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	}
+	bench_end(&run, "mutex contention", BENCH_MUTEX_TASKS * BENCH_MUTEX_LOOPS, "lock");
+	bench_check(mtx_counter == BENCH_MUTEX_TASKS * BENCH_MUTEX_LOOPS, "mutex lost update");
+
+	rtos_mutex_delete(mtx);
+}
+
+/* periodic timer jitter against the os clock */
+static uint64_t tmr_last, tmr_max_late, tmr_sum_late;
+static uint32_t tmr_ticks;
+
+static void bench_timer_cb(void *timer)
+{
+	uint64_t now = rtos_time_get_current_system_time_us();
+	uint64_t late;
+
+	(void) timer;
+	if (tmr_ticks) {
+		late = now - tmr_last > BENCH_TIMER_PERIOD_MS * 1000ULL ? now - tmr_last - BENCH_TIMER_PERIOD_MS * 1000ULL :
+			   BENCH_TIMER_PERIOD_MS * 1000ULL - (now - tmr_last);
+		tmr_sum_late += late;
+		if (late > tmr_max_late) {
+			tmr_max_late = late;
+		}
+	}
+	tmr_last = now;
+	if (++tmr_ticks == BENCH_TIMER_TICKS) {
+		rtos_sema_give(bench_done);
+	}
+}
+
+static void bench_timer(void)
+{
+	struct bench_run run;
+	rtos_timer_t timer;
+
+	rtos_timer_create(&timer, "bench", 1, BENCH_TIMER_PERIOD_MS, 1, bench_timer_cb);
+
+	bench_begin(&run);
+	rtos_timer_start(timer, 0);
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	rtos_timer_stop(timer, 0);
+	bench_end(&run, "timer 2ms period", BENCH_TIMER_TICKS, "tick");
+	printf("%-22s jitter avg %llu us max %llu us\n", "",
+		   (unsigned long long)(tmr_sum_late / (BENCH_TIMER_TICKS - 1)), (unsigned long long)tmr_max_late);
+
+	rtos_timer_delete(timer, 0);
+}
+
+#ifdef RTOS_POSIX_HAS_RINGBUFFER
+/* ringbuffer producer/consumer, the semaphores only signal space and data */
+static RingBuffer *rb;
+static rtos_sema_t rb_data, rb_space;
+static uint32_t rb_sum;
+
+static void rb_consumer(void *param)
+{
+	uint8_t chunk[BENCH_RB_CHUNK];
+	uint32_t got = 0, i;
+
+	(void) param;
+	while (got < BENCH_RB_BYTES) {
+		if (RingBuffer_Available(rb) < BENCH_RB_CHUNK) {
+			rtos_sema_take(rb_data, RTOS_MAX_DELAY);
+			continue;
+		}
+		RingBuffer_Read(rb, chunk, BENCH_RB_CHUNK);
+		rtos_sema_give(rb_space);
+		for (i = 0; i < BENCH_RB_CHUNK; i++) {
+			rb_sum += chunk[i];
+		}
+		got += BENCH_RB_CHUNK;
+	}
+	rtos_sema_give(bench_done);
+	rtos_task_delete(NULL);
+}
+
+static void bench_ringbuffer(void)
+{
+	struct bench_run run;
+	uint8_t chunk[BENCH_RB_CHUNK];
+	uint32_t put = 0, sum = 0, i;
+
+	rb = RingBuffer_Create(NULL, BENCH_RB_SIZE, LOCAL_RINGBUFF, 1);
+	rtos_sema_create_binary(&rb_data);
+	rtos_sema_create_binary(&rb_space);
+	rb_sum = 0;
+	rtos_task_create(NULL, "rb_consumer", rb_consumer, NULL, BENCH_STACK_SIZE, 5);
+
+	bench_begin(&run);
+	while (put < BENCH_RB_BYTES) {
+		if (RingBuffer_Space(rb) < BENCH_RB_CHUNK) {
+			rtos_sema_take(rb_space, RTOS_MAX_DELAY);
+			continue;
+		}
+		for (i = 0; i < BENCH_RB_CHUNK; i++) {
+			chunk[i] = (uint8_t)(put + i * 13);
+			sum += chunk[i];
+		}
+		RingBuffer_Write(rb, chunk, BENCH_RB_CHUNK);
+		rtos_sema_give(rb_data);
+		put += BENCH_RB_CHUNK;
+	}
+	rtos_sema_take(bench_done, RTOS_MAX_DELAY);
+	bench_end(&run, "ringbuffer 512B", BENCH_RB_BYTES / BENCH_RB_CHUNK, "chunk");
+	bench_check(sum == rb_sum, "ringbuffer data");
+
+	rtos_sema_delete(rb_data);
+	rtos_sema_delete(rb_space);
+	RingBuffer_Destroy(rb);
+}
+#endif
+
+static void bench_main(void *param)
+{
+	static const char *const mode_name[] = {"thread", "rt", "det"};
+
+	(void) param;
+	printf("os_wrapper posix bench, sched mode %s\n", mode_name[rtos_posix_get_sched_mode()]);
+
+	bench_pingpong();
+	bench_queue();
+	bench_mutex();
+	bench_timer();
+#ifdef RTOS_POSIX_HAS_RINGBUFFER
+	bench_ringbuffer();
+#endif
+
+	printf("heap min ever free %u, free %u\n", (unsigned)rtos_mem_get_minimum_ever_free_heap_size(),
+		   (unsigned)rtos_mem_get_free_heap_size());
+	rtos_sched_stop();
+	rtos_task_delete(NULL);
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	rtos_sema_create(&bench_done, 0, BENCH_MUTEX_TASKS);
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
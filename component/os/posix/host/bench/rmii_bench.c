@@ -0,0 +1,691 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * The RMII driver on its descriptor rings, with the bench playing the MAC. On transmit the MAC takes
+ * the frames of the descriptors handed over to it, checks their bytes and closes the descriptors, on
+ * receive it fills the descriptors it owns and drops the frame when there is none. Both raise the
+ * interrupt through RMII_IRQHandler. The lwIP side of the port is the bench too, it frees, holds or
+ * stalls the frames received. Reports descriptors and copies per frame, ring full returns, rx loans
+ * and drops for each case, then checks that a frame is handed over whole, that a pbuf is held until
+ * its descriptors are closed and that loaned rx buffers are not reused while lwIP holds them.
+ */
+
+#include <malloc.h>
+#include <time.h>
+#include "cmsis.h"
+#include "ethernet_mii.h"
+#include "wifi_api.h"
+#include "wifi_intf_drv_to_lwip.h"
+#include "ameba_usrcfg.h"
+#include "kv.h"
+#include "lwip/tcpip.h"
+
+#define BENCH_STACK_SIZE		4096
+#define BENCH_FRAME_MIN			60
+#define BENCH_FRAME_MAX			1514
+#define BENCH_SEG_MAX			10
+#define BENCH_TX_FRAMES			20000
+#define BENCH_RX_FRAMES			20000
+#define BENCH_RX_HOLD_MAX		32
+#define BENCH_WAIT_MS			2000
+
+/* the driver state and counters, not in its header */
+extern ETH_InitTypeDef eth_initstruct;
+extern rtos_sema_t ethernet_init_done;
+extern volatile u32 g_rmii_tx_submit;
+extern volatile u32 g_rmii_tx_getbuf_null;
+extern volatile u32 g_rmii_tx_copy;
+extern volatile u32 g_rmii_rx_loan;
+extern volatile u32 g_rmii_rx_copy;
+
+ETHERNET_TypeDef rmii_host_regs;
+const SocClk_Info_TypeDef SocClk_Info[1];
+struct wifi_user_conf wifi_user_config;
+int lwip_init_done = 1;
+
+static struct netif bench_netif;
+struct netif *pnetif_eth = &bench_netif;
+
+static IRQ_FUN bench_irq_fun;
+static u32 bench_irq_data;
+static int bench_fail;
+
+/* MAC side */
+static u8 hw_tx_idx;
+static u8 hw_rx_idx;
+static u32 hw_tx_descs;
+static u32 hw_tx_seq;
+static u32 hw_rx_drops;
+
+/* lwIP side */
+enum bench_rx_mode {
+	BENCH_RX_FREE,
+	BENCH_RX_HOLD,
+	BENCH_RX_GATE,
+};
+
+static volatile int bench_rx_mode;
+static volatile u32 bench_rx_entered;
+static volatile u32 bench_rx_frames;
+static u32 bench_rx_last_seq;
+static struct pbuf *bench_rx_held[BENCH_RX_HOLD_MAX];
+static u32 bench_rx_held_seq[BENCH_RX_HOLD_MAX];
+static u32 bench_rx_held_num;
+static rtos_sema_t bench_rx_gate;
+
+static u32 bench_tx_seq;
+static volatile u32 bench_tx_live;
+
+struct bench_tx_frame;
+
+struct bench_tx_seg {
+	struct pbuf_custom pc;
+	struct bench_tx_frame *frame;
+};
+
+struct bench_tx_frame {
+	struct bench_tx_seg seg[BENCH_SEG_MAX];
+	u32 live_segs;
+	u8 data[BENCH_FRAME_MAX];
+};
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+/* the driver threads are left to run until the value is reached */
+static int bench_wait(volatile u32 *value, u32 expect)
+{
+	uint64_t end = bench_wall_ns() + BENCH_WAIT_MS * 1000000ULL;
+
+	while (*value != expect && bench_wall_ns() < end) {
+		rtos_task_yield();
+	}
+	return *value == expect;
+}
+
+static u32 bench_frame_len(u32 seq)
+{
+	return BENCH_FRAME_MIN + (seq * 97) % (BENCH_FRAME_MAX - BENCH_FRAME_MIN + 1);
+}
+
+static void bench_frame_fill(u8 *frame, u32 seq)
+{
+	u32 len = bench_frame_len(seq);
+	u32 i;
+
+	memset(frame, 0xFF, 6);
+	memcpy(frame + 6, "\x00\xe0\x4c\x00\x00\x01", 6);
+	frame[12] = 0x08;
+	frame[13] = 0x00;
+	memcpy(frame + 14, &seq, sizeof(seq));
+	for (i = 14 + sizeof(seq); i < len; i++) {
+		frame[i] = (u8)(seq * 31 + i);
+	}
+}
+
+/* the frame and its length match its sequence number, which is returned */
+static int bench_frame_check(const u8 *frame, u32 len, u32 *seq)
+{
+	static u8 expect[BENCH_FRAME_MAX];
+
+	if (len < 14 + sizeof(*seq)) {
+		return 0;
+	}
+	memcpy(seq, frame + 14, sizeof(*seq));
+	if (len != bench_frame_len(*seq)) {
+		return 0;
+	}
+	bench_frame_fill(expect, *seq);
+	return memcmp(frame, expect, len) == 0;
+}
+
+/* stubs of the SoC and of the network stack parts the driver calls at init */
+void InterruptRegister(IRQ_FUN IrqFun, IRQn_Type IrqNum, u32 Data, u32 Priority)
+{
+	(void) IrqNum;
+	(void) Priority;
+	bench_irq_fun = IrqFun;
+	bench_irq_data = Data;
+}
+
+void InterruptEn(IRQn_Type IrqNum, u32 Priority)
+{
+	(void) IrqNum;
+	(void) Priority;
+}
+
+int PHY_SoftWareReset(uint8_t phy_id)
+{
+	(void) phy_id;
+	return RTK_SUCCESS;
+}
+
+int PHY_RestartAutoNego(uint8_t phy_id)
+{
+	(void) phy_id;
+	return RTK_SUCCESS;
+}
+
+int PHY_SetRefclkDir(uint8_t phy_id, u32 mac_dir)
+{
+	(void) phy_id;
+	(void) mac_dir;
+	return RTK_SUCCESS;
+}
+
+s32 wifi_get_mac_address(s32 idx, struct rtw_mac *mac, u8 efuse)
+{
+	(void) idx;
+	(void) efuse;
+	memcpy(mac->octet, "\x00\xe0\x4c\x87\x00\x10", 6);
+	return RTK_SUCCESS;
+}
+
+int32_t rt_kv_get(const char *key, void *buffer, int32_t len)
+{
+	(void) key;
+	(void) buffer;
+	(void) len;
+	return -1;
+}
+
+int32_t rt_kv_size(const char *key)
+{
+	(void) key;
+	return 0;
+}
+
+void LwIP_ReleaseIP(uint8_t idx)
+{
+	(void) idx;
+}
+
+void LwIP_SetIP(uint8_t idx, u32_t addr, u32_t netmask, u32_t gw)
+{
+	(void) idx;
+	(void) addr;
+	(void) netmask;
+	(void) gw;
+}
+
+uint8_t LwIP_IP_Address_Request(uint8_t idx)
+{
+	(void) idx;
+	return DHCP_ADDRESS_ASSIGNED;
+}
+
+struct netif *lwip_bench_route_src(const struct ip4_addr *src, const struct ip4_addr *dest)
+{
+	(void) src;
+	(void) dest;
+	return NULL;
+}
+
+/*
+ * The MAC reset and the MDIO transfers of Ethernet_init() spin on bits only the hardware changes.
+ * The model programs the rings and the interrupt mask the way it does and comes up with the link.
+ */
+u32 __wrap_Ethernet_init(ETH_InitTypeDef *ETH_InitStruct)
+{
+	u8 i;
+
+	Ethernet_SetMacAddr(ETH_InitStruct->ETH_MacAddr);
+	for (i = 0; i < ETH_InitStruct->ETH_TxDescNum; i++) {
+		ETH_InitStruct->ETH_TxDesc[i].dw1 = 0;
+		ETH_InitStruct->ETH_TxDesc[i].addr = (u32)(uintptr_t)(ETH_InitStruct->ETH_TxPktBuf + i * ETH_InitStruct->ETH_TxBufSize);
+	}
+	for (i = 0; i < ETH_InitStruct->ETH_RxDescNum; i++) {
+		ETH_InitStruct->ETH_RxDesc[i].dw1 = FEMAC_RX_DSC_BIT_OWN | ETH_InitStruct->ETH_RxBufSize;
+		if (i == ETH_InitStruct->ETH_RxDescNum - 1) {
+			ETH_InitStruct->ETH_RxDesc[i].dw1 |= FEMAC_RX_DSC_BIT_EOR;
+		}
+		ETH_InitStruct->ETH_RxDesc[i].addr = (u32)(uintptr_t)(ETH_InitStruct->ETH_RxPktBuf + i * ETH_InitStruct->ETH_RxBufSize);
+	}
+	rmii_host_regs.ETH_TXFDP1 = (u32)(uintptr_t)ETH_InitStruct->ETH_TxDesc;
+	rmii_host_regs.ETH_RX_FDP1 = (u32)(uintptr_t)ETH_InitStruct->ETH_RxDesc;
+	rmii_host_regs.ETH_ISR_AND_IMR = ETH_InitStruct->ETH_IntMaskAndStatus & ~0xFFFFU;
+	link_is_up = 1;
+
+	return HAL_OK;
+}
+
+/* the lwIP port: copy to a pool pbuf, and the netif input of the stack */
+struct pbuf *ethernetif_rmii_buf_copy(u32 frame_len, u8 *src_buf)
+{
+	struct pbuf *p;
+
+	p = pbuf_alloc(PBUF_RAW, frame_len, PBUF_POOL);
+	if (p != NULL) {
+		pbuf_take(p, src_buf, frame_len);
+	}
+	return p;
+}
+
+void ethernetif_rmii_netif_recv(struct pbuf *p)
+{
+	static u8 frame[BENCH_FRAME_MAX];
+	u32 len = p->tot_len;
+	u32 seq;
+
+	bench_rx_entered++;
+	if (bench_rx_mode == BENCH_RX_GATE) {
+		rtos_sema_take(bench_rx_gate, RTOS_MAX_TIMEOUT);
+	}
+
+	if (len > sizeof(frame) || pbuf_copy_partial(p, frame, len, 0) != len || !bench_frame_check(frame, len, &seq)) {
+		bench_check(0, "rx frame intact");
+	} else {
+		bench_check(bench_rx_frames == 0 || seq > bench_rx_last_seq, "rx frames in order");
+		bench_rx_last_seq = seq;
+	}
+
+	if (bench_rx_mode == BENCH_RX_HOLD && bench_rx_held_num < BENCH_RX_HOLD_MAX) {
+		bench_rx_held_seq[bench_rx_held_num] = seq;
+		bench_rx_held[bench_rx_held_num++] = p;
+	} else {
+		pbuf_free(p);
+	}
+	bench_rx_frames++;
+}
+
+/* raise the interrupt, the status bits are write one to clear */
+static void hw_irq(u32 isr)
+{
+	rmii_host_regs.ETH_ISR_AND_IMR = (rmii_host_regs.ETH_ISR_AND_IMR & ~0xFFFFU) | isr;
+	bench_irq_fun((void *)(uintptr_t)bench_irq_data);
+	rmii_host_regs.ETH_ISR_AND_IMR &= ~0xFFFFU;
+}
+
+static u8 hw_tx_next(u8 idx)
+{
+	return (idx == eth_initstruct.ETH_TxDescNum - 1) ? 0 : idx + 1;
+}
+
+/* send every frame handed over and close its descriptors, return the number of frames */
+static u32 hw_tx(void)
+{
+	static u8 frame[BENCH_FRAME_MAX];
+	ETH_TxDescTypeDef *desc;
+	u32 frames = 0, len, seg, seq, num, dw1, i;
+	u8 idx;
+
+	while (__atomic_load_n(&eth_initstruct.ETH_TxDesc[hw_tx_idx].dw1, __ATOMIC_ACQUIRE) & FEMAC_TX_DSC_BIT_OWN) {
+		idx = hw_tx_idx;
+		len = 0;
+		for (num = 0; num < eth_initstruct.ETH_TxDescNum; num++) {
+			desc = &eth_initstruct.ETH_TxDesc[idx];
+			dw1 = __atomic_load_n(&desc->dw1, __ATOMIC_ACQUIRE);
+			if (!(dw1 & FEMAC_TX_DSC_BIT_OWN)) {
+				bench_check(0, "every descriptor of a frame handed over");
+				return frames;
+			}
+			bench_check(!(dw1 & FEMAC_TX_DSC_BIT_FS) == (num != 0), "first segment on the first descriptor");
+			bench_check(!(dw1 & FEMAC_TX_DSC_BIT_EOR) == (idx != eth_initstruct.ETH_TxDescNum - 1), "end of ring on the last descriptor");
+			seg = FEMAC_TX_DSC_BIT_SIZE(dw1);
+			if (len + seg <= sizeof(frame)) {
+				memcpy(frame + len, (u8 *)(uintptr_t)desc->addr, seg);
+			}
+			len += seg;
+			idx = hw_tx_next(idx);
+			if (dw1 & FEMAC_TX_DSC_BIT_LS) {
+				break;
+			}
+		}
+		bench_check(num < eth_initstruct.ETH_TxDescNum, "last segment flagged");
+		bench_check(bench_frame_check(frame, len, &seq) && seq == hw_tx_seq, "tx frame intact and in order");
+		hw_tx_seq++;
+
+		for (i = 0; i <= num; i++) {
+			__atomic_and_fetch(&eth_initstruct.ETH_TxDesc[hw_tx_idx].dw1, ~FEMAC_TX_DSC_BIT_OWN, __ATOMIC_RELEASE);
+			hw_tx_idx = hw_tx_next(hw_tx_idx);
+		}
+		hw_tx_descs += num + 1;
+		frames++;
+	}
+
+	if (frames) {
+		hw_irq(BIT_ISR_TOK_TI);
+	}
+	return frames;
+}
+
+/* receive one frame into the current descriptor, dropped if the driver has not given it back */
+static int hw_rx(u32 seq)
+{
+	ETH_RxDescTypeDef *desc = &eth_initstruct.ETH_RxDesc[hw_rx_idx];
+	u32 dw1 = __atomic_load_n(&desc->dw1, __ATOMIC_ACQUIRE);
+	u32 len = bench_frame_len(seq);
+
+	if (!(dw1 & FEMAC_RX_DSC_BIT_OWN)) {
+		hw_rx_drops++;
+		return 0;
+	}
+	bench_check(len + 2 <= (dw1 & 0xFFF), "rx buffer size");
+
+	/* the MAC puts two bytes in front of the frame and counts them */
+	bench_frame_fill((u8 *)(uintptr_t)desc->addr + 2, seq);
+	__atomic_store_n(&desc->dw1, (dw1 & FEMAC_RX_DSC_BIT_EOR) | (len + 2), __ATOMIC_RELEASE);
+	hw_rx_idx = (dw1 & FEMAC_RX_DSC_BIT_EOR) ? 0 : hw_rx_idx + 1;
+
+	hw_irq(BIT_ISR_ROK);
+	return 1;
+}
+
+/* the driver has given every rx descriptor back */
+static int hw_rx_ring_free(void)
+{
+	int i;
+
+	for (i = 0; i < eth_initstruct.ETH_RxDescNum; i++) {
+		if (!(__atomic_load_n(&eth_initstruct.ETH_RxDesc[i].dw1, __ATOMIC_ACQUIRE) & FEMAC_RX_DSC_BIT_OWN)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int hw_rx_wait_ring(void)
+{
+	uint64_t end = bench_wall_ns() + BENCH_WAIT_MS * 1000000ULL;
+
+	while (!hw_rx_ring_free() && bench_wall_ns() < end) {
+		rtos_task_yield();
+	}
+	return hw_rx_ring_free();
+}
+
+static void bench_tx_seg_free(struct pbuf *p)
+{
+	struct bench_tx_frame *frame = ((struct bench_tx_seg *)p)->frame;
+
+	if (--frame->live_segs == 0) {
+		free(frame);
+		__atomic_sub_fetch(&bench_tx_live, 1, __ATOMIC_RELAXED);
+	}
+}
+
+/* a frame in segs custom pbufs, the segments of ref_mask are PBUF_REF and the others PBUF_RAM */
+static struct pbuf *bench_tx_frame(u32 seq, u32 segs, u32 ref_mask)
+{
+	struct bench_tx_frame *frame = malloc(sizeof(*frame));
+	u32 len = bench_frame_len(seq);
+	struct pbuf *head = NULL, *p;
+	u32 i, off, end;
+
+	if (frame == NULL) {
+		return NULL;
+	}
+	bench_check((uintptr_t)frame->data < 0x100000000ULL, "tx frame below 4 GB");
+	bench_frame_fill(frame->data, seq);
+	frame->live_segs = segs;
+
+	for (i = 0; i < segs; i++) {
+		off = i * len / segs;
+		end = (i + 1) * len / segs;
+		frame->seg[i].frame = frame;
+		frame->seg[i].pc.custom_free_function = bench_tx_seg_free;
+		p = pbuf_alloced_custom(PBUF_RAW, end - off, (ref_mask & BIT(i)) ? PBUF_REF : PBUF_RAM, &frame->seg[i].pc,
+								frame->data + off, end - off);
+		if (head == NULL) {
+			head = p;
+		} else {
+			pbuf_cat(head, p);
+		}
+	}
+	__atomic_add_fetch(&bench_tx_live, 1, __ATOMIC_RELAXED);
+	return head;
+}
+
+/* no time for the cases that wait on purpose */
+static void bench_ns_column(uint64_t wall, u32 frames)
+{
+	if (wall) {
+		printf("%8.0f\n", (double)wall / frames);
+	} else {
+		printf("%8s\n", "-");
+	}
+}
+
+static void bench_tx_row(const char *name, u32 frames, u32 descs, u32 copies, u32 busy, uint64_t wall)
+{
+	printf("%-22s %7u %8.2f %8.2f %9u ", name, frames, (double)descs / frames, (double)copies / frames, busy);
+	bench_ns_column(wall, frames);
+}
+
+static void bench_tx(const char *name, u32 segs, u32 ref_mask)
+{
+	u32 submit = g_rmii_tx_submit, busy = g_rmii_tx_getbuf_null, copy = g_rmii_tx_copy, descs = hw_tx_descs;
+	uint64_t wall;
+	struct pbuf *p;
+	int ret;
+	u32 n;
+
+	wall = bench_wall_ns();
+	for (n = 0; n < BENCH_TX_FRAMES; n++) {
+		p = bench_tx_frame(bench_tx_seq, segs, ref_mask);
+		if (p == NULL) {
+			bench_check(0, "tx frame alloc");
+			break;
+		}
+		/* the MAC drains a full ring, as the link would */
+		while ((ret = rltk_mii_send(p)) != 0 && hw_tx() != 0) {
+		}
+		/* lwIP drops its reference when linkoutput returns */
+		pbuf_free(p);
+		if (ret != 0) {
+			bench_check(0, "ring full only while the MAC has frames");
+			break;
+		}
+		bench_tx_seq++;
+	}
+	hw_tx();
+	bench_check(bench_wait(&bench_tx_live, 0), "tx pbufs released once their descriptors are closed");
+	wall = bench_wall_ns() - wall;
+
+	bench_check(g_rmii_tx_submit - submit == n, "every tx frame submitted");
+	bench_tx_row(name, n, hw_tx_descs - descs, g_rmii_tx_copy - copy, g_rmii_tx_getbuf_null - busy, wall);
+}
+
+/* the MAC stops, frames are taken until the ring is full and held until it sends them */
+static void bench_tx_stall(const char *name, u32 segs)
+{
+	u32 submit = g_rmii_tx_submit, busy = g_rmii_tx_getbuf_null, copy = g_rmii_tx_copy, descs = hw_tx_descs;
+	u32 accepted = 0;
+	struct pbuf *p;
+	int ret;
+
+	do {
+		p = bench_tx_frame(bench_tx_seq, segs, 0);
+		if (p == NULL) {
+			bench_check(0, "tx frame alloc");
+			return;
+		}
+		ret = rltk_mii_send(p);
+		pbuf_free(p);
+		if (ret == 0) {
+			bench_tx_seq++;
+			accepted++;
+		}
+	} while (ret == 0 && accepted <= eth_initstruct.ETH_TxDescNum);
+
+	bench_check(accepted == eth_initstruct.ETH_TxDescNum / segs, "ring full at the first frame that does not fit");
+	bench_check(g_rmii_tx_getbuf_null - busy == 1, "ring full returned to lwIP");
+	rtos_time_delay_ms(10);
+	bench_check(bench_tx_live == accepted, "tx pbufs held while the MAC owns their descriptors");
+
+	bench_check(hw_tx() == accepted, "held frames sent when the MAC resumes");
+	bench_check(bench_wait(&bench_tx_live, 0), "tx pbufs released after resume");
+	p = bench_tx_frame(bench_tx_seq, segs, 0);
+	bench_check(p != NULL && rltk_mii_send(p) == 0, "ring free again after resume");
+	if (p != NULL) {
+		pbuf_free(p);
+		bench_tx_seq++;
+	}
+	hw_tx();
+	bench_check(bench_wait(&bench_tx_live, 0), "tx pbufs released");
+
+	bench_tx_row(name, g_rmii_tx_submit - submit, hw_tx_descs - descs, g_rmii_tx_copy - copy,
+				 g_rmii_tx_getbuf_null - busy, 0);
+}
+
+static u32 bench_rx_seq;
+
+/* bursts of one ring, each drained by the driver before the next */
+static u32 bench_rx_push(u32 frames)
+{
+	u32 n, i, received = 0;
+
+	for (n = 0; n < frames;) {
+		for (i = 0; i < eth_initstruct.ETH_RxDescNum && n < frames; i++, n++) {
+			received += hw_rx(bench_rx_seq++);
+		}
+		if (!hw_rx_wait_ring()) {
+			bench_check(0, "rx descriptors given back");
+			break;
+		}
+	}
+	return received;
+}
+
+static void bench_rx_row(const char *name, u32 frames, u32 loan, u32 copy, u32 drops, uint64_t wall)
+{
+	printf("%-22s %7u %8u %8u %9u ", name, frames, g_rmii_rx_loan - loan, g_rmii_rx_copy - copy, hw_rx_drops - drops);
+	bench_ns_column(wall, frames);
+}
+
+static void bench_rx_free(const char *name, u32 frames)
+{
+	u32 loan = g_rmii_rx_loan, copy = g_rmii_rx_copy, drops = hw_rx_drops, delivered = bench_rx_frames;
+	uint64_t wall;
+
+	bench_rx_mode = BENCH_RX_FREE;
+	wall = bench_wall_ns();
+	bench_check(bench_rx_push(frames) == frames, "no rx drop while lwIP keeps up");
+	wall = bench_wall_ns() - wall;
+
+	bench_check(bench_rx_frames - delivered == frames, "every rx frame delivered");
+	bench_check(g_rmii_rx_loan - loan == frames, "rx frames loaned while spare buffers are left");
+	bench_rx_row(name, frames, loan, copy, drops, wall);
+}
+
+/* lwIP holds more frames than there are spare buffers, then more arrive */
+static void bench_rx_hold(const char *name, u32 held, u32 frames)
+{
+	u32 loan = g_rmii_rx_loan, copy = g_rmii_rx_copy, drops = hw_rx_drops;
+	static u8 frame[BENCH_FRAME_MAX];
+	uint64_t wall;
+	u32 i, len, seq;
+
+	bench_rx_held_num = 0;
+	bench_rx_mode = BENCH_RX_HOLD;
+	wall = bench_wall_ns();
+	bench_rx_push(held);
+	bench_check(bench_rx_held_num == held, "rx frames held by lwIP");
+	bench_check(g_rmii_rx_loan - loan < held && g_rmii_rx_copy - copy == held - (g_rmii_rx_loan - loan),
+				"rx frames copied once every spare buffer is held");
+
+	bench_rx_mode = BENCH_RX_FREE;
+	bench_rx_push(frames);
+	wall = bench_wall_ns() - wall;
+
+	/* the ring went round while lwIP held the loaned buffers */
+	for (i = 0; i < bench_rx_held_num; i++) {
+		len = bench_rx_held[i]->tot_len;
+		bench_check(pbuf_copy_partial(bench_rx_held[i], frame, len, 0) == len && bench_frame_check(frame, len, &seq) &&
+					seq == bench_rx_held_seq[i], "held rx frame not overwritten");
+		pbuf_free(bench_rx_held[i]);
+	}
+	bench_rx_held_num = 0;
+	bench_rx_row(name, held + frames, loan, copy, drops, wall);
+}
+
+/* the rx thread is stuck in lwIP with one frame, the MAC fills the rest of the ring and drops */
+static void bench_rx_stall(const char *name, u32 frames)
+{
+	u32 loan = g_rmii_rx_loan, copy = g_rmii_rx_copy, drops = hw_rx_drops, delivered = bench_rx_frames;
+	u32 entered = bench_rx_entered, received = 0, n;
+
+	bench_rx_mode = BENCH_RX_GATE;
+	received += hw_rx(bench_rx_seq++);
+	bench_check(bench_wait(&bench_rx_entered, entered + 1), "rx thread in lwIP");
+	for (n = 1; n < frames; n++) {
+		received += hw_rx(bench_rx_seq++);
+	}
+	bench_check(received == eth_initstruct.ETH_RxDescNum, "rx ring filled while the rx thread is stalled");
+	bench_check(hw_rx_drops - drops == frames - received, "rx frames dropped by the MAC");
+
+	bench_rx_mode = BENCH_RX_FREE;
+	rtos_sema_give(bench_rx_gate);
+	bench_check(hw_rx_wait_ring(), "rx descriptors given back after the stall");
+
+	bench_check(bench_rx_frames - delivered == received, "frames in the ring delivered after the stall");
+	bench_rx_row(name, frames, loan, copy, drops, 0);
+}
+
+static void bench_main(void *param)
+{
+	(void) param;
+
+	tcpip_init(NULL, NULL);
+	rtos_sema_create_binary(&bench_rx_gate);
+
+	ethernet_mii_init();
+	if (rtos_sema_take(ethernet_init_done, BENCH_WAIT_MS) != RTK_SUCCESS) {
+		bench_check(0, "driver up");
+		rtos_sched_stop();
+		return;
+	}
+	bench_check((uintptr_t)eth_initstruct.ETH_RxPktBuf < 0x100000000ULL && (uintptr_t)eth_initstruct.ETH_TxPktBuf < 0x100000000ULL &&
+				(uintptr_t)eth_initstruct.ETH_TxDesc < 0x100000000ULL, "driver buffers below 4 GB");
+	bench_check(rmii_host_regs.ETH_IDR0 == ((u32)pnetif_eth->hwaddr[0] << 24 | (u32)pnetif_eth->hwaddr[1] << 16 |
+											 (u32)pnetif_eth->hwaddr[2] << 8 | pnetif_eth->hwaddr[3]), "MAC address of the netif");
+	if (bench_fail) {
+		rtos_sched_stop();
+		return;
+	}
+
+	printf("%-22s %7s %8s %8s %9s %8s\n", "tx", "frames", "desc/fr", "copy/fr", "ring full", "ns/fr");
+	bench_tx("1 segment", 1, 0);
+	bench_tx("3 segments", 3, 0);
+	bench_tx("3 segments, 2 ref", 3, BIT(1) | BIT(2));
+	bench_tx("10 segments", 10, 0);
+	bench_tx_stall("MAC stalled, 3 seg", 3);
+
+	printf("%-22s %7s %8s %8s %9s %8s\n", "rx", "frames", "loans", "copies", "drops", "ns/fr");
+	bench_rx_free("freed at once", BENCH_RX_FRAMES);
+	bench_rx_hold("lwIP holds 12", 12, 40);
+	bench_rx_free("after release", 40);
+	bench_rx_stall("rx thread stalled", 10);
+
+	rtos_sched_stop();
+}
+
+int main(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	/* every thread allocates from the main arena, which is below 4 GB in the non-PIE executable */
+	mallopt(M_ARENA_MAX, 1);
+
+	rtos_task_create(NULL, "bench", bench_main, NULL, BENCH_STACK_SIZE, 4);
+	rtos_sched_start();
+
+	printf("%s\n", bench_fail ? "FAIL" : "done");
+	return bench_fail;
+}
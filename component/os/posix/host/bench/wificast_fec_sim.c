@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Simulation of the wificast OTA image send after the first plain pass, with the XOR repair
+ * packets planned by wificast_fec.c against the previous bitmap retransmission. Every frame is
+ * a broadcast each receiver loses with the same independent probability, status requests and
+ * responses included.
+ *
+ * Both senders poll the receivers in rounds. A receiver answers with the bitmap of the window of
+ * WIFI_CAST_OTA_WINDOW_SIZE chunks holding its first missing chunk. The bitmap sender waits three
+ * request windows of WIFI_CAST_OTA_FEEDBACK_WAIT_MS every round and sends every chunk missing in
+ * any answer again. The repair sender stops polling as soon as every unfinished receiver has
+ * answered, then sends the planned groups of the lowest window reported, a group of one chunk as
+ * plain data. The air time of a frame is frame_us, an answer to a request takes SIM_RSP_MS.
+ *
+ * The plans are checked first on random loss masks: a chunk is in one group at most, only lost
+ * chunks are planned, every node misses at most one chunk of a group and all lost chunks are
+ * planned unless the groups run out.
+ *
+ *     wificast_fec_sim [nodes loss_permille [chunks [frame_us]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "wificast_fec.h"
+
+/* as in example_wificast_ota.h and wifi_intf_drv_to_app_cast.h */
+#define SIM_WINDOW_SIZE			(200 * 8)
+#define SIM_REPAIR_GROUP_MAX	256
+#define SIM_FEEDBACK_RETRY		3
+#define SIM_FEEDBACK_WAIT_MS	1000
+#define SIM_ROUND_MAX			50
+#define SIM_NODE_MAX			16
+
+#define SIM_CHUNK_MAX			8192
+#define SIM_RSP_MS				5
+#define SIM_SEEDS				8
+
+struct sim_cfg {
+	uint16_t node_num;
+	uint16_t loss;					/* per mille of a frame */
+	uint32_t chunk_num;
+	uint32_t frame_us;
+};
+
+struct sim_node {
+	uint8_t have[SIM_CHUNK_MAX / 8];
+	uint32_t have_num;
+	uint8_t done;					/* known finished by the sender */
+	uint8_t reported;				/* answered in this round */
+	uint32_t window;				/* window of the answer */
+};
+
+struct sim_result {
+	uint64_t frames;				/* data and repair frames after the first pass */
+	uint64_t feedback;				/* status requests and responses */
+	uint64_t time_ms;
+	uint32_t rounds;
+	uint32_t unfinished;
+};
+
+static int bench_fail = 0;
+static uint64_t sim_rng;
+static struct sim_node sim_nodes[SIM_NODE_MAX];
+static uint32_t sim_miss[SIM_WINDOW_SIZE];
+static struct wificast_fec_group sim_groups[SIM_REPAIR_GROUP_MAX];
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+static uint32_t sim_rand(void)
+{
+	sim_rng ^= sim_rng << 13;
+	sim_rng ^= sim_rng >> 7;
+	sim_rng ^= sim_rng << 17;
+	return (uint32_t)(sim_rng >> 16);
+}
+
+static int sim_lost(uint16_t loss)
+{
+	return (sim_rand() % 1000) < loss;
+}
+
+static int sim_has(struct sim_node *node, uint32_t seq)
+{
+	return (node->have[seq >> 3] >> (seq & 7)) & 1;
+}
+
+static void sim_set(struct sim_node *node, uint32_t seq)
+{
+	if (!sim_has(node, seq)) {
+		node->have[seq >> 3] |= 1 << (seq & 7);
+		node->have_num++;
+	}
+}
+
+static void sim_send_chunk(const struct sim_cfg *cfg, uint32_t seq)
+{
+	for (int n = 0; n < cfg->node_num; n++) {
+		if (!sim_lost(cfg->loss)) {
+			sim_set(&sim_nodes[n], seq);
+		}
+	}
+}
+
+/* a receiver rebuilds a chunk when it misses exactly one chunk of the repair */
+static void sim_send_repair(const struct sim_cfg *cfg, uint32_t base, const struct wificast_fec_group *group)
+{
+	for (int n = 0; n < cfg->node_num; n++) {
+		struct sim_node *node = &sim_nodes[n];
+		uint32_t missing_seq = 0;
+		int missing_num = 0;
+
+		if (sim_lost(cfg->loss)) {
+			continue;
+		}
+		for (int i = 0; i < group->num; i++) {
+			if (!sim_has(node, base + group->seq[i])) {
+				missing_seq = base + group->seq[i];
+				missing_num++;
+			}
+		}
+		if (missing_num == 1) {
+			sim_set(node, missing_seq);
+		}
+	}
+}
+
+/* one round of status polling, unfinished is the number of receivers not known to be finished */
+static void sim_feedback(const struct sim_cfg *cfg, int early, struct sim_result *res, uint32_t *unfinished)
+{
+	uint32_t expect = *unfinished;
+	uint32_t answers = 0;
+
+	for (int n = 0; n < cfg->node_num; n++) {
+		sim_nodes[n].reported = 0;
+	}
+
+	for (int i = 0; i < SIM_FEEDBACK_RETRY; i++) {
+		uint32_t rsp = 0;
+
+		if (early && answers == expect) {
+			break;
+		}
+		res->feedback++;
+		/* every receiver hearing the request answers it, finished or not */
+		for (int n = 0; n < cfg->node_num; n++) {
+			struct sim_node *node = &sim_nodes[n];
+
+			if (sim_lost(cfg->loss)) {
+				continue;
+			}
+			res->feedback++;
+			rsp++;
+			if (sim_lost(cfg->loss) || node->reported || node->done) {
+				continue;
+			}
+			if (node->have_num == cfg->chunk_num) {
+				node->done = 1;
+				(*unfinished)--;
+				expect--;
+				continue;
+			}
+			for (uint32_t seq = 0; seq < cfg->chunk_num; seq++) {
+				if (!sim_has(node, seq)) {
+					node->window = seq / SIM_WINDOW_SIZE;
+					break;
+				}
+			}
+			node->reported = 1;
+			answers++;
+		}
+		/* the repair sender stops once every unfinished receiver answered */
+		if (early && answers == expect) {
+			res->time_ms += (uint64_t)rsp * SIM_RSP_MS;
+		} else {
+			res->time_ms += SIM_FEEDBACK_WAIT_MS;
+		}
+	}
+}
+
+static void sim_bitmap_round(const struct sim_cfg *cfg, struct sim_result *res)
+{
+	for (uint32_t seq = 0; seq < cfg->chunk_num; seq++) {
+		for (int n = 0; n < cfg->node_num; n++) {
+			struct sim_node *node = &sim_nodes[n];
+
+			if (node->reported && node->window == seq / SIM_WINDOW_SIZE &&
+				!sim_has(node, seq)) {
+				sim_send_chunk(cfg, seq);
+				res->frames++;
+				break;
+			}
+		}
+	}
+}
+
+static void sim_repair_round(const struct sim_cfg *cfg, struct sim_result *res)
+{
+	uint32_t window = UINT32_MAX;
+	uint32_t base;
+	uint16_t seq_num;
+	int group_num;
+
+	for (int n = 0; n < cfg->node_num; n++) {
+		if (sim_nodes[n].reported && sim_nodes[n].window < window) {
+			window = sim_nodes[n].window;
+		}
+	}
+	if (window == UINT32_MAX) {
+		return;
+	}
+	base = window * SIM_WINDOW_SIZE;
+	seq_num = (cfg->chunk_num - base < SIM_WINDOW_SIZE) ? cfg->chunk_num - base : SIM_WINDOW_SIZE;
+
+	memset(sim_miss, 0, sizeof(sim_miss));
+	for (int n = 0; n < cfg->node_num; n++) {
+		struct sim_node *node = &sim_nodes[n];
+
+		if (!node->reported || node->window != window) {
+			continue;
+		}
+		for (uint16_t i = 0; i < seq_num; i++) {
+			if (!sim_has(node, base + i)) {
+				sim_miss[i] |= 1UL << n;
+			}
+		}
+	}
+
+	group_num = wificast_fec_plan(sim_miss, seq_num, sim_groups, SIM_REPAIR_GROUP_MAX);
+	for (int g = 0; g < group_num; g++) {
+		if (sim_groups[g].num == 1) {
+			sim_send_chunk(cfg, base + sim_groups[g].seq[0]);
+		} else {
+			sim_send_repair(cfg, base, &sim_groups[g]);
+		}
+		res->frames++;
+	}
+}
+
+static void sim_run(const struct sim_cfg *cfg, int repair, uint64_t seed, struct sim_result *res)
+{
+	uint32_t unfinished = cfg->node_num;
+
+	memset(res, 0, sizeof(*res));
+	memset(sim_nodes, 0, sizeof(sim_nodes));
+	sim_rng = seed;
+
+	/* the first pass is the same for both */
+	for (uint32_t seq = 0; seq < cfg->chunk_num; seq++) {
+		sim_send_chunk(cfg, seq);
+	}
+
+	for (res->rounds = 0; res->rounds < SIM_ROUND_MAX && unfinished; res->rounds++) {
+		sim_feedback(cfg, repair, res, &unfinished);
+		if (repair) {
+			sim_repair_round(cfg, res);
+		} else {
+			sim_bitmap_round(cfg, res);
+		}
+	}
+	res->unfinished = unfinished;
+	res->time_ms += res->frames * cfg->frame_us / 1000;
+}
+
+static void sim_compare(const struct sim_cfg *cfg)
+{
+	struct sim_result sum[2];
+	struct sim_result res;
+
+	memset(sum, 0, sizeof(sum));
+	for (int s = 0; s < SIM_SEEDS; s++) {
+		for (int repair = 0; repair < 2; repair++) {
+			sim_run(cfg, repair, 0x9e3779b97f4a7c15ULL * (s + 1), &res);
+			sum[repair].frames += res.frames;
+			sum[repair].feedback += res.feedback;
+			sum[repair].time_ms += res.time_ms;
+			sum[repair].rounds += res.rounds;
+			sum[repair].unfinished += res.unfinished;
+		}
+	}
+
+	printf("%2u nodes %3u%% loss  frames %6.0f -> %6.0f  feedback %5.0f -> %5.0f  rounds %5.1f -> %5.1f"
+		   "  time %6.1f -> %6.1f s\n", cfg->node_num, cfg->loss / 10,
+		   (double)sum[0].frames / SIM_SEEDS, (double)sum[1].frames / SIM_SEEDS,
+		   (double)sum[0].feedback / SIM_SEEDS, (double)sum[1].feedback / SIM_SEEDS,
+		   (double)sum[0].rounds / SIM_SEEDS, (double)sum[1].rounds / SIM_SEEDS,
+		   sum[0].time_ms / 1000.0 / SIM_SEEDS, sum[1].time_ms / 1000.0 / SIM_SEEDS);
+	bench_check(sum[1].unfinished == 0, "repair sender finishes every receiver");
+	bench_check(sum[1].frames <= sum[0].frames, "repair sender sends no more frames");
+}
+
+static void plan_check(int node_num, uint16_t loss, uint16_t seq_num, int max_groups)
+{
+	static uint32_t miss[SIM_WINDOW_SIZE];
+	static int placed[SIM_WINDOW_SIZE];
+	static struct wificast_fec_group groups[SIM_WINDOW_SIZE];
+	int group_num;
+	int ok = 1;
+
+	memset(miss, 0, sizeof(miss));
+	memset(placed, 0, sizeof(placed));
+	for (uint16_t i = 0; i < seq_num; i++) {
+		for (int n = 0; n < node_num; n++) {
+			if (sim_lost(loss)) {
+				miss[i] |= 1UL << n;
+			}
+		}
+	}
+
+	group_num = wificast_fec_plan(miss, seq_num, groups, max_groups);
+	ok &= group_num >= 0 && group_num <= max_groups;
+	for (int g = 0; g < group_num && ok; g++) {
+		uint32_t mask = 0;
+
+		ok &= groups[g].num > 0 && groups[g].num <= WIFICAST_FEC_GROUP_MAX;
+		for (int i = 0; i < groups[g].num && ok; i++) {
+			uint16_t seq = groups[g].seq[i];
+
+			ok &= seq < seq_num && miss[seq] != 0 && !placed[seq];
+			/* no node misses two chunks of a group */
+			ok &= (mask & miss[seq]) == 0;
+			mask |= miss[seq];
+			placed[seq] = 1;
+		}
+		ok &= groups[g].node_mask == mask;
+	}
+	if (group_num < max_groups) {
+		for (uint16_t i = 0; i < seq_num; i++) {
+			ok &= !miss[i] || placed[i];
+		}
+	}
+
+	if (!ok) {
+		printf("FAIL: plan of %d nodes, %u permille loss, %u chunks, %d groups\n", node_num, loss, seq_num, max_groups);
+		bench_fail = 1;
+	}
+}
+
+static void xor_check(void)
+{
+	uint8_t a[300], b[300], c[300];
+
+	for (int i = 0; i < 300; i++) {
+		a[i] = (uint8_t)sim_rand();
+		b[i] = (uint8_t)sim_rand();
+	}
+	/* aligned and unaligned, the word loop and the byte tail */
+	for (int off = 0; off < 4; off++) {
+		memcpy(c, a, sizeof(c));
+		wificast_fec_xor(c + off, b + off, 257);
+		wificast_fec_xor(c + off, b + off, 257);
+		bench_check(memcmp(c, a, sizeof(c)) == 0, "xor twice is the identity");
+		wificast_fec_xor(c + off, b, 5);
+		bench_check((c[off] ^ b[0]) == a[off] && (c[off + 4] ^ b[4]) == a[off + 4], "xor of unaligned buffers");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	static const uint16_t node_nums[] = {4, 8, 16};
+	static const uint16_t losses[] = {10, 50, 100, 200};
+	struct sim_cfg cfg = {
+		.chunk_num = 4000,			/* a 1 MB image in 256 byte chunks */
+		.frame_us = 1000,
+	};
+
+	sim_rng = 1;
+	for (int n = 1; n <= 32; n++) {
+		for (int l = 0; l < 4; l++) {
+			plan_check(n, losses[l], SIM_WINDOW_SIZE, SIM_REPAIR_GROUP_MAX);
+			plan_check(n, losses[l], 37, 4);
+		}
+	}
+	xor_check();
+	printf("plans checked\n");
+
+	if (argc > 2) {
+		cfg.node_num = atoi(argv[1]);
+		cfg.loss = atoi(argv[2]);
+		if (argc > 3) {
+			cfg.chunk_num = atoi(argv[3]);
+		}
+		if (argc > 4) {
+			cfg.frame_us = atoi(argv[4]);
+		}
+		if (cfg.node_num == 0 || cfg.node_num > SIM_NODE_MAX || cfg.loss >= 1000 ||
+			cfg.chunk_num == 0 || cfg.chunk_num > SIM_CHUNK_MAX) {
+			printf("nodes 1..%d, loss_permille below 1000, chunks 1..%d\n", SIM_NODE_MAX, SIM_CHUNK_MAX);
+			return 1;
+		}
+		sim_compare(&cfg);
+	} else {
+		printf("bitmap -> repair, %u chunks, %u us per frame, mean of %d runs\n", cfg.chunk_num, cfg.frame_us, SIM_SEEDS);
+		for (unsigned i = 0; i < sizeof(node_nums) / sizeof(node_nums[0]); i++) {
+			for (unsigned l = 0; l < sizeof(losses) / sizeof(losses[0]); l++) {
+				cfg.node_num = node_nums[i];
+				cfg.loss = losses[l];
+				sim_compare(&cfg);
+			}
+		}
+	}
+
+	printf(bench_fail ? "FAIL\n" : "done\n");
+	return bench_fail;
+}
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * network/xml on UPnP sized documents: a ContentDirectory Browse SOAP response and a device
+ * description, each parsed with xml_parse (the tree owns its strings), xml_parse_insitu (arena
+ * nodes pointing into the buffer) and a bare xml_sax_parse, followed by one xml_find_path.
+ * Reports throughput, allocator calls per parse and the peak of live bytes (payload sizes only),
+ * counted around rtos_mem_malloc/rtos_mem_free, then checks both trees are equal, the path finds
+ * the same nodes, a dump parses back to the same tree and same-name nesting.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "os_wrapper.h"
+#include "xml.h"
+
+#define BENCH_ROUNDS			1000
+#define BENCH_DOC_MAX			(64 * 1024)
+
+/* every block carries its size so frees can be accounted */
+#define BENCH_HDR				16
+
+static size_t heap_calls;
+static size_t heap_live;
+static size_t heap_peak;
+static int bench_fail;
+
+void *__real_rtos_mem_malloc(uint32_t size);
+void __real_rtos_mem_free(void *pbuf);
+
+void *__wrap_rtos_mem_malloc(uint32_t size)
+{
+	unsigned char *p = __real_rtos_mem_malloc(size + BENCH_HDR);
+
+	if (p == NULL) {
+		return NULL;
+	}
+	*(uint32_t *)p = size;
+	heap_calls++;
+	heap_live += size;
+	if (heap_live > heap_peak) {
+		heap_peak = heap_live;
+	}
+	return p + BENCH_HDR;
+}
+
+void __wrap_rtos_mem_free(void *pbuf)
+{
+	unsigned char *p = (unsigned char *)pbuf - BENCH_HDR;
+
+	if (pbuf == NULL) {
+		return;
+	}
+	heap_calls++;
+	heap_live -= *(uint32_t *)p;
+	__real_rtos_mem_free(p);
+}
+
+static void bench_heap_reset(void)
+{
+	heap_calls = 0;
+	heap_peak = heap_live;
+}
+
+static uint64_t bench_wall_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_check(int cond, const char *what)
+{
+	if (!cond) {
+		printf("FAIL: %s\n", what);
+		bench_fail = 1;
+	}
+}
+
+/* Browse response of a media server, the DIDL-Lite result is escaped text as on the wire */
+static size_t bench_soap_browse(char *buf, size_t size, int items)
+{
+	size_t len;
+	int i;
+
+	len = snprintf(buf, size,
+				   "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+				   "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">"
+				   "<s:Body><u:BrowseResponse xmlns:u=\"urn:schemas-upnp-org:service:ContentDirectory:1\"><Result>"
+				   "&lt;DIDL-Lite xmlns=&quot;urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/&quot;&gt;");
+	for (i = 0; i < items && len < size; i++) {
+		len += snprintf(buf + len, size - len,
+						"&lt;item id=&quot;%d&quot; parentID=&quot;64&quot; restricted=&quot;1&quot;&gt;"
+						"&lt;dc:title&gt;Track %02d&lt;/dc:title&gt;&lt;upnp:class&gt;object.item.audioItem.musicTrack&lt;/upnp:class&gt;"
+						"&lt;res protocolInfo=&quot;http-get:*:audio/mpeg:*&quot; size=&quot;%d&quot;&gt;http://192.168.1.2:8200/MediaItems/%d.mp3&lt;/res&gt;"
+						"&lt;/item&gt;", 1000 + i, i, 3000000 + i * 4096, 1000 + i);
+	}
+	len += snprintf(buf + len, size - len,
+					"&lt;/DIDL-Lite&gt;</Result><NumberReturned>%d</NumberReturned><TotalMatches>%d</TotalMatches>"
+					"<UpdateID>7</UpdateID></u:BrowseResponse></s:Body></s:Envelope>", items, items);
+	return len;
+}
+
+/* device description, eight services on the root device and eight on every embedded device */
+static size_t bench_device_desc(char *buf, size_t size, int services)
+{
+	size_t len;
+	int i;
+
+	len = snprintf(buf, size,
+				   "<?xml version=\"1.0\"?>\n<!-- device description -->\n"
+				   "<root xmlns=\"urn:schemas-upnp-org:device-1-0\"><specVersion><major>1</major><minor>0</minor></specVersion>"
+				   "<device><deviceType>urn:schemas-upnp-org:device:MediaRenderer:1</deviceType>"
+				   "<friendlyName>Ameba Renderer</friendlyName><manufacturer>Realtek</manufacturer>"
+				   "<UDN>uuid:4d696e69-444c-164e-9d41-b827eb54e2a1</UDN><serviceList>");
+	for (i = 0; i < services && len < size; i++) {
+		if (i == 8) {
+			len += snprintf(buf + len, size - len, "</serviceList><deviceList>");
+		}
+		if (i >= 8 && i % 8 == 0) {
+			len += snprintf(buf + len, size - len,
+							"<device><deviceType>urn:schemas-upnp-org:device:Embedded:1</deviceType><UDN>uuid:e%d</UDN><serviceList>", i / 8);
+		}
+		len += snprintf(buf + len, size - len,
+						"<service><serviceType>urn:schemas-upnp-org:service:Svc%d:1</serviceType>"
+						"<serviceId>urn:upnp-org:serviceId:Svc%d</serviceId><SCPDURL>/svc%d/scpd.xml</SCPDURL>"
+						"<controlURL>/svc%d/control</controlURL><eventSubURL>/svc%d/event</eventSubURL></service>",
+						i, i, i, i, i);
+		if (i >= 8 && (i % 8 == 7 || i == services - 1)) {
+			len += snprintf(buf + len, size - len, "</serviceList></device>");
+		}
+	}
+	len += snprintf(buf + len, size - len, services > 8 ? "</deviceList></device></root>" : "</serviceList></device></root>");
+	return len;
+}
+
+static int bench_tree_equal(struct xml_node *a, struct xml_node *b)
+{
+	for (; a && b; a = a->next, b = b->next) {
+		if ((a->name == NULL) != (b->name == NULL) || (a->name && strcmp(a->name, b->name))
+			|| (a->text == NULL) != (b->text == NULL) || (a->text && strcmp(a->text, b->text))
+			|| (a->prefix == NULL) != (b->prefix == NULL) || (a->prefix && strcmp(a->prefix, b->prefix))
+			|| (a->attr == NULL) != (b->attr == NULL) || (a->attr && strcmp(a->attr, b->attr))
+			|| !bench_tree_equal(a->child, b->child)) {
+			return 0;
+		}
+	}
+	return a == NULL && b == NULL;
+}
+
+static int sax_start(void *ctx, char *prefix, char *name, char *attr, char *uri, int uri_len)
+{
+	(*(int *)ctx)++;
+	return 0;
+}
+
+static int sax_end(void *ctx, char *prefix, char *name)
+{
+	return 0;
+}
+
+static int sax_text(void *ctx, char *text, int text_len)
+{
+	return 0;
+}
+
+static const struct xml_sax_handler sax_count = { sax_start, sax_end, sax_text };
+
+static int bench_count_elements(struct xml_node *node)
+{
+	int n = 0;
+
+	for (; node; node = node->next) {
+		if (xml_is_element(node)) {
+			n += 1 + bench_count_elements(node->child);
+		}
+	}
+	return n;
+}
+
+static void bench_doc(const char *name, const char *doc, size_t len, char *path)
+{
+	static char work[BENCH_DOC_MAX];
+	struct xml_node_set *set;
+	struct xml_node *root;
+	struct xml_doc *xdoc;
+	uint64_t wall[3] = { 0 }, t;
+	size_t calls[3], peak[3];
+	int found[2] = { 0 }, elements = 0;
+	int round;
+
+	/* xml_parse, the working copy is made by the parser */
+	bench_heap_reset();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		memcpy(work, doc, len);
+		t = bench_wall_ns();
+		if ((root = xml_parse(work, (int)len)) == NULL) {
+			bench_check(0, "xml_parse");
+			return;
+		}
+		set = xml_find_path(root, path);
+		found[0] = set->count;
+		xml_delete_set(set);
+		xml_delete_tree(root);
+		wall[0] += bench_wall_ns() - t;
+	}
+	calls[0] = heap_calls / BENCH_ROUNDS;
+	peak[0] = heap_peak - heap_live;
+
+	bench_heap_reset();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		memcpy(work, doc, len);
+		t = bench_wall_ns();
+		if ((xdoc = xml_parse_insitu(work, (int)len)) == NULL) {
+			bench_check(0, "xml_parse_insitu");
+			return;
+		}
+		set = xml_find_path(xdoc->root, path);
+		found[1] = set->count;
+		xml_delete_set(set);
+		xml_delete_doc(xdoc);
+		wall[1] += bench_wall_ns() - t;
+	}
+	calls[1] = heap_calls / BENCH_ROUNDS;
+	peak[1] = heap_peak - heap_live;
+
+	bench_heap_reset();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		memcpy(work, doc, len);
+		elements = 0;
+		t = bench_wall_ns();
+		bench_check(xml_sax_parse(work, (int)len, &sax_count, &elements) == 0, "sax parse");
+		wall[2] += bench_wall_ns() - t;
+	}
+	calls[2] = heap_calls / BENCH_ROUNDS;
+	peak[2] = heap_peak - heap_live;
+
+	printf("%-8s %7zu B  xml_parse %7.1f MB/s %5zu/%7zu  insitu %7.1f MB/s %4zu/%6zu  sax %7.1f MB/s %2zu/%4zu\n",
+		   name, len,
+		   (double)len * BENCH_ROUNDS * 1000.0 / wall[0], calls[0], peak[0],
+		   (double)len * BENCH_ROUNDS * 1000.0 / wall[1], calls[1], peak[1],
+		   (double)len * BENCH_ROUNDS * 1000.0 / wall[2], calls[2], peak[2]);
+
+	/* both trees and the path results against each other */
+	memcpy(work, doc, len);
+	root = xml_parse(work, (int)len);
+	memcpy(work, doc, len);
+	xdoc = xml_parse_insitu(work, (int)len);
+	bench_check(root && xdoc && bench_tree_equal(root, xdoc->root), "xml_parse and xml_parse_insitu trees equal");
+	bench_check(found[0] > 0 && found[0] == found[1], "path found by both");
+	bench_check(root && bench_count_elements(root) == elements, "sax reports every element");
+	if (root) {
+		char *dump = xml_dump_tree(root);
+		struct xml_node *again = xml_parse(dump, (int)strlen(dump));
+
+		bench_check(again && bench_tree_equal(root, again), "dump parses back to the same tree");
+		xml_delete_tree(again);
+		xml_free(dump);
+		xml_delete_tree(root);
+	}
+	if (xdoc) {
+		xml_delete_doc(xdoc);
+	}
+}
+
+static void bench_nesting(void)
+{
+	char doc[] = "<a:x xmlns:a=\"urn:a\"><x><x>in<![CDATA[<x>]]></x></x><x/><!-- <x> --></a:x>";
+	struct xml_node_set *set;
+	struct xml_node *root = xml_parse(doc, (int)strlen(doc));
+
+	bench_check(root != NULL, "nested parse");
+	if (root == NULL) {
+		return;
+	}
+	set = xml_find_path(root, "/a:x/x/x");
+	bench_check(set->count == 1, "same-name nesting");
+	if (set->count == 1) {
+		struct xml_node *text = xml_text_child(set->node[0]);
+
+		bench_check(text && strcmp(text->text, "in<x>") == 0, "CDATA kept as text");
+	}
+	xml_delete_set(set);
+	set = xml_find_path(root, "/a:x/x");
+	bench_check(set->count == 2, "siblings after a nested close");
+	xml_delete_set(set);
+	xml_delete_tree(root);
+}
+
+int main(void)
+{
+	static char doc[BENCH_DOC_MAX];
+	size_t len;
+
+	printf("allocator calls / peak live bytes per parse\n");
+	len = bench_soap_browse(doc, sizeof(doc), 1);
+	bench_doc("browse", doc, len, "/s:Envelope/s:Body/u:BrowseResponse/NumberReturned");
+	len = bench_soap_browse(doc, sizeof(doc), 16);
+	bench_doc("browse", doc, len, "/s:Envelope/s:Body/u:BrowseResponse/Result");
+	len = bench_device_desc(doc, sizeof(doc), 8);
+	bench_doc("device", doc, len, "/root/device/serviceList/service/controlURL");
+	len = bench_device_desc(doc, sizeof(doc), 96);
+	bench_doc("device", doc, len, "/root/device/deviceList/device/serviceList/service");
+	bench_nesting();
+
+	bench_check(heap_live == 0, "no leaks");
+	printf(bench_fail ? "FAIL\n" : "done\n");
+	return bench_fail;
+}
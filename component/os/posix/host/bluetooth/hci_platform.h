@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _HCI_PLATFORM_H_
+#define _HCI_PLATFORM_H_
+
+#include "ameba_soc.h"
+#include "platform_stdlib.h"
+
+/* host stand-in, the HCI snoop of rtk_coex is on and reports through vendor commands only */
+#define HCI_BT_COEX_ENABLE         1
+#define HCI_BT_COEX_SW_MAILBOX     0
+
+#endif
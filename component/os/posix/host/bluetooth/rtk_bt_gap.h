@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __RTK_BT_GAP_H__
+#define __RTK_BT_GAP_H__
+
+#include <basic_types.h>
+
+/* host stand-in, only the vendor command the coexistence snoop sends, implemented by the bench */
+typedef struct {
+	uint16_t op;
+	uint8_t len;
+	uint8_t *cmd_param;
+} rtk_bt_gap_vendor_cmd_param_t;
+
+uint16_t rtk_bt_gap_vendor_cmd_req(rtk_bt_gap_vendor_cmd_param_t *vendor_param);
+
+#endif
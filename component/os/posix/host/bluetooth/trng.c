@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* host stand-in for the SoC TRNG behind osif_rand */
+int TRNG_get_random_bytes(void *dst, uint32_t size)
+{
+	FILE *f = fopen("/dev/urandom", "rb");
+	size_t got = 0;
+
+	if (f) {
+		got = fread(dst, 1, size, f);
+		fclose(f);
+	}
+	return (got == size) ? 0 : -1;
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __LWIP_NETCONF_H__
+#define __LWIP_NETCONF_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include "os_wrapper.h"
+
+/* host stand-in, the CoAP port uses the BSD socket API of lwIP, the host C library provides the same calls */
+
+#endif
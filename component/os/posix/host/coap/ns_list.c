@@ -0,0 +1,10 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* host stand-in for ns_list.c of nanostack-libservice: the one external definition of the list
+ * functions that C99 inline needs when the compiler does not inline them, as at -O0 */
+#define NS_LIST_FN extern
+#include "ns_list.h"
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __SN_CONFIG_HOST_H__
+#define __SN_CONFIG_HOST_H__
+
+/* host configuration of the CoAP stack, given by MBED_CLIENT_USER_CONFIG_FILE. Duplicate detection
+ * and block-wise transfer are enabled, the resending queue and the duplicate table are at their
+ * uint8_t limit so hundreds of exchanges can be in flight. */
+#define SN_COAP_DUPLICATION_MAX_MSGS_COUNT	255
+#define SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE	1024
+#define SN_COAP_RESENDING_QUEUE_SIZE_MSGS	255
+#define SN_COAP_RESENDING_QUEUE_SIZE_BYTES	0
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __AMEBA_USRCFG_H__
+#define __AMEBA_USRCFG_H__
+
+#include "basic_types.h"
+
+/* host stand-in, only the MAC address offset of the wifi user configuration */
+struct wifi_user_conf {
+	u8 softap_addr_offset_idx;
+};
+
+extern struct wifi_user_conf wifi_user_config;
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __CMSIS_H__
+#define __CMSIS_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "basic_types.h"
+#include "ameba_soc.h"
+#include "section_config.h"
+#include "os_wrapper.h"
+#include "log.h"
+#include "rand.h"
+
+/*
+ * host stand-in for the amebagreen2 RMII driver. The MAC registers are a plain structure owned by
+ * the bench, which also raises the interrupt. Clock, pinmux and power control do nothing.
+ */
+#define __I		volatile const
+#define __O		volatile
+#define __IO	volatile
+#define __weak	__attribute__((weak))
+#define __DSB()	__atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#ifndef ENABLE
+#define ENABLE	1
+#endif
+#ifndef DISABLE
+#define DISABLE	0
+#endif
+#define HAL_OK			0
+#define HAL_ERR_PARA	3
+
+#define CACHE_LINE_SIZE			32U
+#define CACHE_LINE_ALIGNMENT(x)	(((uintptr_t)(x) + CACHE_LINE_SIZE - 1) & ~((uintptr_t)CACHE_LINE_SIZE - 1))
+
+#include "ameba_phy.h"
+#include "ameba_ethernet.h"
+
+extern ETHERNET_TypeDef rmii_host_regs;
+#define RMII_REG_BASE		((uintptr_t)&rmii_host_regs)
+#define RMII_REG_BASE_S		RMII_REG_BASE
+
+#define TrustZone_IsSecure()	0
+#define DelayMs(ms)				rtos_time_delay_ms(ms)
+
+typedef u32(*IRQ_FUN)(void *Data);
+typedef int IRQn_Type;
+#define RMII_IRQ	48
+void InterruptRegister(IRQ_FUN IrqFun, IRQn_Type IrqNum, u32 Data, u32 Priority);
+void InterruptEn(IRQn_Type IrqNum, u32 Priority);
+
+typedef struct {
+	u32	USBPLL_CLK;
+	u32	SYSPLL_CLK;
+	u8	Vol_Type;
+	u8	CPU_CKD;
+} SocClk_Info_TypeDef;
+extern const SocClk_Info_TypeDef SocClk_Info[];
+
+#define IS_SYS_PLL			BIT7
+#define GET_CLK_DIV(x)		(x & 0x7f)
+#define CLK_LIMIT_GMAC		(50 * 1000000U)
+#define PLL_ClkSrcGet(sys_pll, usb_pll, fre_limit)	((void)(sys_pll), (void)(usb_pll), (u8)0)
+#define RCC_PeriphClockCmd(...)
+#define RCC_PeriphClockSourceSet(...)
+#define RCC_PeriphClockDividerFENSet(...)
+#define RCC_PeriphClockDividerSet(...)
+#define Pinmux_Config(...)
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __LWIP_NETCONF_H__
+#define __LWIP_NETCONF_H__
+
+#include "lwip/netif.h"
+#include "lwip/netifapi.h"
+#include "lwip/pbuf.h"
+
+/* host stand-in, the ethernet netif is the only one and its address is set by the bench */
+extern struct netif *pnetif_eth;
+
+enum {
+	NETIF_ETH_INDEX,
+	NET_IF_NUM
+};
+
+typedef enum {
+	DHCP_START = 0,
+	DHCP_WAIT_ADDRESS,
+	DHCP_ADDRESS_ASSIGNED,
+	DHCP_RELEASE_IP,
+	DHCP_STOP,
+	DHCP_TIMEOUT
+} DHCP_State_TypeDef;
+
+void LwIP_Init(void);
+void LwIP_ReleaseIP(uint8_t idx);
+void LwIP_SetIP(uint8_t idx, u32_t addr, u32_t netmask, u32_t gw);
+uint8_t LwIP_IP_Address_Request(uint8_t idx);
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __TIMER_API_H__
+#define __TIMER_API_H__
+
+/* host stand-in, the RMII driver uses nothing from it */
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __WIFI_API_H__
+#define __WIFI_API_H__
+
+#include "basic_types.h"
+
+/* host stand-in, the RMII driver only takes its MAC address from the wifi efuse */
+struct rtw_mac {
+	u8		octet[6];
+};
+
+s32 wifi_get_mac_address(s32 idx, struct rtw_mac *mac, u8 efuse);
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __WIFI_INTF_DRV_TO_LWIP_H__
+#define __WIFI_INTF_DRV_TO_LWIP_H__
+
+#include "lwip/pbuf.h"
+
+/* host stand-in, the rx hand-off of the lwIP port is implemented by the bench */
+struct pbuf *ethernetif_rmii_buf_copy(u32 frame_len, u8 *src_buf);
+void ethernetif_rmii_netif_recv(struct pbuf *p);
+
+#endif
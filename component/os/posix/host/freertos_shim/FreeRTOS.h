@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __FREERTOS_SHIM_H__
+#define __FREERTOS_SHIM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+/* just enough of FreeRTOS.h to build the heap implementations on the host, single threaded */
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+#define configUSE_MALLOC_FAILED_HOOK		0
+#define configASSERT(x)						assert(x)
+
+#define portBYTE_ALIGNMENT					32
+#define portBYTE_ALIGNMENT_MASK				(portBYTE_ALIGNMENT - 1)
+#define portMAX_DELAY						((TickType_t) 0xffffffffUL)
+#define portPOINTER_SIZE_TYPE				size_t
+
+#define PRIVILEGED_DATA
+#define mtCOVERAGE_TEST_MARKER()
+#define traceMALLOC(pvAddress, uiSize)
+#define traceFREE(pvAddress, uiSize)
+
+#define pdFALSE								((BaseType_t) 0)
+#define pdTRUE								((BaseType_t) 1)
+#define pdPASS								(pdTRUE)
+#define pdFAIL								(pdFALSE)
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+typedef struct HeapRegion {
+	uint8_t *pucStartAddress;
+	size_t xSizeInBytes;
+} HeapRegion_t;
+
+typedef struct xHeapStats {
+	size_t xAvailableHeapSpaceInBytes;
+	size_t xSizeOfLargestFreeBlockInBytes;
+	size_t xSizeOfSmallestFreeBlockInBytes;
+	size_t xNumberOfFreeBlocks;
+	size_t xMinimumEverFreeBytesRemaining;
+	size_t xNumberOfSuccessfulAllocations;
+	size_t xNumberOfSuccessfulFrees;
+} HeapStats_t;
+
+void *pvPortMalloc(size_t xWantedSize);
+void *pvPortMallocBase(size_t xWantedSize, uint32_t startAddr);
+void vPortFree(void *pv);
+void *pvPortReAlloc(void *pv, size_t xWantedSize);
+void *pvPortReAllocBase(void *pv, size_t xWantedSize, uint32_t startAddr);
+void *pvPortCalloc(size_t xWantedCnt, size_t xWantedSize);
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+void xPortResetHeapMinimumEverFreeHeapSize(void);
+void vPortDefineHeapRegions(const HeapRegion_t *const pxHeapRegions);
+void vPortGetHeapStats(HeapStats_t *pxHeapStats);
+
+#endif
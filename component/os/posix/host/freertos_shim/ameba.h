@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __FREERTOS_SHIM_AMEBA_H__
+#define __FREERTOS_SHIM_AMEBA_H__
+
+#include <stdio.h>
+#include "platform_autoconf.h"
+
+#define NOTAG						"NOTAG"
+#define RTK_LOG_ERROR				1
+#define RTK_LOG_INFO				4
+#define RTK_LOGS(tag, level, ...)	printf(__VA_ARGS__)
+
+#ifndef UNUSED
+#define UNUSED(x)					((void)(x))
+#endif
+
+/* the bench places its PSRAM region at run time */
+extern size_t heap_bench_psram_base;
+#define PSRAM_BASE					heap_bench_psram_base
+
+#endif
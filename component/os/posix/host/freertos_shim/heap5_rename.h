@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __HEAP5_RENAME_H__
+#define __HEAP5_RENAME_H__
+
+/* forced into heap_5.c so it links next to heap_tlsf.c in the heap bench */
+#define xHeapStructSize							heap5_xHeapStructSize
+#define pvPortMalloc							heap5_pvPortMalloc
+#define pvPortMallocBase						heap5_pvPortMallocBase
+#define vPortFree								heap5_vPortFree
+#define pvPortReAlloc							heap5_pvPortReAlloc
+#define pvPortReAllocBase						heap5_pvPortReAllocBase
+#define pvPortCalloc							heap5_pvPortCalloc
+#define xPortGetFreeHeapSize					heap5_xPortGetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize			heap5_xPortGetMinimumEverFreeHeapSize
+#define xPortResetHeapMinimumEverFreeHeapSize	heap5_xPortResetHeapMinimumEverFreeHeapSize
+#define vPortDefineHeapRegions					heap5_vPortDefineHeapRegions
+#define vPortGetHeapStats						heap5_vPortGetHeapStats
+
+#endif
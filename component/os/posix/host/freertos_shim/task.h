@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __FREERTOS_SHIM_TASK_H__
+#define __FREERTOS_SHIM_TASK_H__
+
+#include "FreeRTOS.h"
+
+/* the heap bench is single threaded, locking compiles to nothing */
+static inline void vTaskSuspendAll(void)
+{
+}
+
+static inline BaseType_t xTaskResumeAll(void)
+{
+	return pdFALSE;
+}
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __AMEBA_SOC_H__
+#define __AMEBA_SOC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* host stand-in for the SoC header: caches are coherent, the maintenance calls do nothing */
+static inline void DCache_Clean(uint32_t Address, uint32_t Bytes)
+{
+	(void) Address;
+	(void) Bytes;
+}
+
+static inline void DCache_Invalidate(uint32_t Address, uint32_t Bytes)
+{
+	(void) Address;
+	(void) Bytes;
+}
+
+static inline void DCache_CleanInvalidate(uint32_t Address, uint32_t Bytes)
+{
+	(void) Address;
+	(void) Bytes;
+}
+
+/* the debug timer is a free running microsecond counter */
+static inline uint32_t DTimestamp_Get(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+/* the TRNG is the generator of the C library */
+static inline int TRNG_get_random_bytes(void *dst, uint32_t size)
+{
+	unsigned char *p = (unsigned char *)dst;
+
+	while (size--) {
+		*p++ = (unsigned char)rand();
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __DIAG_H__
+#define __DIAG_H__
+
+#include <stdio.h>
+
+/* host stand-in, the SoC log UART is stdout */
+#define DiagPrintf	printf
+#define DiagSnPrintf	snprintf
+
+#endif
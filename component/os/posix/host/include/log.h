@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <stdio.h>
+
+/* host stand-in, every level goes to stdout */
+enum rtk_log_level {
+	RTK_LOG_NONE = 0,
+	RTK_LOG_ALWAYS,
+	RTK_LOG_ERROR,
+	RTK_LOG_WARN,
+	RTK_LOG_INFO,
+	RTK_LOG_DEBUG,
+};
+
+#define NOTAG	"#"
+
+#define RTK_LOGA(tag, ...)			printf(__VA_ARGS__)
+#define RTK_LOGE(tag, ...)			printf(__VA_ARGS__)
+#define RTK_LOGW(tag, ...)			printf(__VA_ARGS__)
+#define RTK_LOGI(tag, ...)			printf(__VA_ARGS__)
+#define RTK_LOGD(tag, ...)			printf(__VA_ARGS__)
+#define RTK_LOGS(tag, level, ...)	printf(__VA_ARGS__)
+
+static inline void rtk_log_memory_dump_byte(const void *buf, unsigned int len)
+{
+	const unsigned char *p = (const unsigned char *)buf;
+	unsigned int i;
+
+	for (i = 0; i < len; i++) {
+		printf("%02x%s", p[i], ((i & 15) == 15 || i + 1 == len) ? "\n" : " ");
+	}
+}
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __PLATFORM_AUTOCONF_H__
+#define __PLATFORM_AUTOCONF_H__
+
+/* host build of the os_wrapper, there is no SoC configuration */
+
+#endif
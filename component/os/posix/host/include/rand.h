@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __RAND_H__
+#define __RAND_H__
+
+#include <stdlib.h>
+
+/* host stand-in for the SoC random generator */
+static inline unsigned int _rand(void)
+{
+	return (unsigned int)rand();
+}
+
+#endif
@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __SECTION_CONFIG_H__
+#define __SECTION_CONFIG_H__
+
+/* host stand-in, there is no linker section placement */
+#define SRAM_WLAN_CRITICAL_CODE_SECTION
+#define SRAM_NOCACHE_DATA_SECTION
+
+#endif
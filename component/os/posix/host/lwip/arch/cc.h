@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __CC_H__
+#define __CC_H__
+
+/* host variant of port/realtek/arch/cc.h: stdint types, pointers may be 64 bit */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+#define LWIP_HAVE_INT64 1
+
+typedef int sys_prot_t;
+
+#define PACK_STRUCT_BEGIN
+#define PACK_STRUCT_STRUCT __attribute__ ((__packed__))
+#define PACK_STRUCT_END
+#define PACK_STRUCT_FIELD(x) x
+
+#define LWIP_PLATFORM_DIAG(x) do { printf x; } while(0)
+#define LWIP_PLATFORM_ASSERT(x) do { printf("lwip assert \"%s\" at %s:%d\n", x, __FILE__, __LINE__); abort(); } while(0)
+
+#define LWIP_NO_CTYPE_H 1
+
+#endif /* __CC_H__ */
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __LWIP_BENCH_HOOKS_H__
+#define __LWIP_BENCH_HOOKS_H__
+
+/*
+ * Both ends of the benchmark connection live in the same stack. Routing by source address sends
+ * each end out of its own netif, so frames cross the simulated wire instead of the loopback.
+ * The file is force-included (-include), lwip/ip4.h tests the hook before any hook file is read.
+ */
+struct netif;
+struct ip4_addr;
+struct netif *lwip_bench_route_src(const struct ip4_addr *src, const struct ip4_addr *dest);
+
+#define LWIP_HOOK_IP4_ROUTE_SRC(src, dest)	lwip_bench_route_src(src, dest)
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __OS_WRAPPER_SPECIFIC_H__
+#define __OS_WRAPPER_SPECIFIC_H__
+
+#include "rtk_status.h"
+
+#ifndef TRUE
+#define TRUE	1
+#endif
+
+#ifndef FALSE
+#define FALSE	0
+#endif
+
+/**
+ * @brief  Scheduling modes of the pthread host port.
+ * RTOS_POSIX_SCHED_THREAD:        one pthread per task on the default host policy, tasks run on all host cores.
+ *                                 Priorities only order wake-ups of tasks blocked on the same object.
+ * RTOS_POSIX_SCHED_RT:            like RTOS_POSIX_SCHED_THREAD, but tasks get SCHED_FIFO priorities and are all
+ *                                 pinned to one core, which gives FreeRTOS single core preemption. Needs
+ *                                 CAP_SYS_NICE, otherwise tasks fall back to the default policy.
+ * RTOS_POSIX_SCHED_DETERMINISTIC: exactly one task runs at a time. Switches only happen inside rtos_* calls,
+ *                                 with FreeRTOS rules (highest ready priority first, round robin within a
+ *                                 priority on block/yield). Time is virtual: it advances only when every task
+ *                                 is blocked, to the nearest timeout, and by rtos_time_delay_us(). Repeated runs
+ *                                 give identical schedules and timestamps. rtos_sched_start() returns once
+ *                                 no task can ever run again or rtos_sched_stop() is called.
+ * The mode can also be chosen with the RTOS_POSIX_SCHED environment variable ("thread", "rt" or "det").
+ */
+#define RTOS_POSIX_SCHED_THREAD				0
+#define RTOS_POSIX_SCHED_RT					1
+#define RTOS_POSIX_SCHED_DETERMINISTIC		2
+
+/**
+ * @brief  Size of the simulated heap reported by rtos_mem_get_free_heap_size(), allocations beyond it fail.
+ */
+#ifndef RTOS_POSIX_HEAP_SIZE
+#define RTOS_POSIX_HEAP_SIZE				(64 * 1024 * 1024)
+#endif
+
+/**
+ * @brief  Host stacks are wider than the target ones, task stacks are scaled and rounded up.
+ */
+#ifndef RTOS_POSIX_STACK_SCALE
+#define RTOS_POSIX_STACK_SCALE				4
+#endif
+
+#ifndef RTOS_POSIX_MIN_STACK_SIZE
+#define RTOS_POSIX_MIN_STACK_SIZE			(64 * 1024)
+#endif
+
+/**
+ * @brief  Select the scheduling mode. Must be called before the first task is created.
+ * @param  mode: RTOS_POSIX_SCHED_THREAD / RTOS_POSIX_SCHED_RT / RTOS_POSIX_SCHED_DETERMINISTIC
+ * @retval RTK_SUCCESS or RTK_FAIL if tasks already exist or mode is invalid
+ */
+int rtos_posix_set_sched_mode(int mode);
+
+/**
+ * @brief  Get the active scheduling mode.
+ */
+int rtos_posix_get_sched_mode(void);
+
+/**
+ * @brief  Number of task switches done by the deterministic scheduler, 0 in the other modes.
+ */
+uint64_t rtos_posix_get_switch_count(void);
+
+#endif
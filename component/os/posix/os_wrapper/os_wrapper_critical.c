@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE
+#include "os_wrapper_posix.h"
+
+/* no interrupts on the host, a critical section is one recursive lock shared by all components.
+ * In deterministic mode only one task runs at a time and nothing is locked, the nesting only
+ * holds off preemption. */
+static pthread_mutex_t rtos_posix_critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread uint32_t rtos_posix_critical_nesting;
+
+int rtos_critical_is_in_interrupt(void)
+{
+	return 0;
+}
+
+void rtos_critical_enter(uint32_t component_id)
+{
+	(void) component_id;
+	__rtos_critical_enter_os();
+}
+
+void rtos_critical_exit(uint32_t component_id)
+{
+	(void) component_id;
+	__rtos_critical_exit_os();
+}
+
+void __rtos_critical_enter_os(void)
+{
+	if (rtos_posix_get_sched_mode() != RTOS_POSIX_SCHED_DETERMINISTIC) {
+		pthread_mutex_lock(&rtos_posix_critical);
+	}
+	rtos_posix_critical_nesting++;
+}
+
+void __rtos_critical_exit_os(void)
+{
+	if (rtos_posix_critical_nesting == 0) {
+		return;
+	}
+
+	rtos_posix_critical_nesting--;
+	if (rtos_posix_get_sched_mode() != RTOS_POSIX_SCHED_DETERMINISTIC) {
+		pthread_mutex_unlock(&rtos_posix_critical);
+	} else if (rtos_posix_critical_nesting == 0) {
+		/* a task readied inside the section may preempt now */
+		rtos_posix_lock();
+		rtos_posix_unlock();
+	}
+}
+
+uint32_t rtos_get_critical_state(void)
+{
+	return rtos_posix_critical_nesting;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "os_wrapper_posix.h"
+
+struct rtos_posix_event_group {
+	rtos_event_bits_t bits;
+	struct list_head waiters;
+};
+
+static int rtos_posix_event_match(rtos_event_bits_t bits, rtos_event_bits_t wait_bits, uint8_t flags)
+{
+	if (flags & RTOS_POSIX_EVENT_WAIT_ALL) {
+		return (bits & wait_bits) == wait_bits;
+	}
+	return (bits & wait_bits) != 0;
+}
+
+rtos_event_group_t rtos_event_group_create(void)
+{
+	struct rtos_posix_event_group *group;
+
+	group = (struct rtos_posix_event_group *)rtos_mem_zmalloc(sizeof(struct rtos_posix_event_group));
+	if (group == NULL) {
+		return NULL;
+	}
+
+	INIT_LIST_HEAD(&group->waiters);
+	return (rtos_event_group_t)group;
+}
+
+void rtos_event_group_delete(rtos_event_group_t xEventGroup)
+{
+	struct rtos_posix_event_group *group = (struct rtos_posix_event_group *)xEventGroup;
+	struct rtos_posix_task *task;
+
+	if (group == NULL) {
+		return;
+	}
+
+	/* waiting tasks are released with no bits set, as vEventGroupDelete() does */
+	rtos_posix_lock();
+	while (!list_empty(&group->waiters)) {
+		task = list_first_entry(&group->waiters, struct rtos_posix_task, node);
+		task->event_result = 0;
+		rtos_posix_wake(task);
+	}
+	rtos_posix_unlock();
+
+	rtos_mem_free(group);
+}
+
+static rtos_event_bits_t rtos_posix_event_wait(struct rtos_posix_event_group *group, rtos_event_bits_t wait_bits,
+		uint8_t flags, uint32_t wait_ms)
+{
+	struct rtos_posix_task *self = rtos_posix_self();
+	rtos_event_bits_t ret;
+
+	if (rtos_posix_event_match(group->bits, wait_bits, flags)) {
+		ret = group->bits;
+		if (flags & RTOS_POSIX_EVENT_CLEAR) {
+			group->bits &= ~wait_bits;
+		}
+		return ret;
+	}
+
+	if (wait_ms == 0) {
+		return group->bits;
+	}
+
+	/* the setter checks the condition and writes the bits that satisfied it to event_result */
+	self->event_bits = wait_bits;
+	self->event_flags = flags;
+	if (rtos_posix_block(&group->waiters, rtos_posix_deadline(wait_ms)) == RTK_SUCCESS) {
+		return self->event_result;
+	}
+	return group->bits;
+}
+
+rtos_event_bits_t rtos_event_group_wait_bits(rtos_event_group_t xEventGroup,
+		const rtos_event_bits_t uxBitsToWaitFor, const long xClearOnExit,
+		const long xWaitForAllBits, uint32_t MsToWait)
+{
+	struct rtos_posix_event_group *group = (struct rtos_posix_event_group *)xEventGroup;
+	rtos_event_bits_t ret;
+	uint8_t flags = 0;
+
+	if (group == NULL || uxBitsToWaitFor == 0) {
+		return 0;
+	}
+
+	if (xClearOnExit) {
+		flags |= RTOS_POSIX_EVENT_CLEAR;
+	}
+	if (xWaitForAllBits) {
+		flags |= RTOS_POSIX_EVENT_WAIT_ALL;
+	}
+
+	rtos_posix_lock();
+	ret = rtos_posix_event_wait(group, uxBitsToWaitFor, flags, MsToWait);
+	rtos_posix_unlock();
+
+	return ret;
+}
+
+rtos_event_bits_t rtos_event_group_clear_bits(rtos_event_group_t xEventGroup,
+		const rtos_event_bits_t uxBitsToClear)
+{
+	struct rtos_posix_event_group *group = (struct rtos_posix_event_group *)xEventGroup;
+	rtos_event_bits_t ret;
+
+	if (group == NULL) {
+		return 0;
+	}
+
+	rtos_posix_lock();
+	ret = group->bits;
+	group->bits &= ~uxBitsToClear;
+	rtos_posix_unlock();
+
+	return ret;
+}
+
+int rtos_event_group_clear_bits_from_isr(rtos_event_group_t xEventGroup,
+		const rtos_event_bits_t uxBitsToClear)
+{
+	if (xEventGroup == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_event_group_clear_bits(xEventGroup, uxBitsToClear);
+	return RTK_SUCCESS;
+}
+
+static rtos_event_bits_t rtos_posix_event_set(struct rtos_posix_event_group *group, rtos_event_bits_t set_bits)
+{
+	struct rtos_posix_task *task;
+	struct list_head *pos, *n;
+	rtos_event_bits_t clear = 0;
+
+	group->bits |= set_bits;
+
+	/* every satisfied waiter is released, clear-on-exit bits are cleared once all have seen them */
+	list_for_each_safe(pos, n, &group->waiters) {
+		task = list_entry(pos, struct rtos_posix_task, node);
+		if (!rtos_posix_event_match(group->bits, task->event_bits, task->event_flags)) {
+			continue;
+		}
+		if (task->event_flags & RTOS_POSIX_EVENT_CLEAR) {
+			clear |= task->event_bits;
+		}
+		task->event_result = group->bits;
+		rtos_posix_wake(task);
+	}
+	group->bits &= ~clear;
+
+	return group->bits;
+}
+
+rtos_event_bits_t rtos_event_group_set_bits(rtos_event_group_t xEventGroup,
+		const rtos_event_bits_t uxBitsToSet)
+{
+	struct rtos_posix_event_group *group = (struct rtos_posix_event_group *)xEventGroup;
+	rtos_event_bits_t ret;
+
+	if (group == NULL) {
+		return 0;
+	}
+
+	rtos_posix_lock();
+	ret = rtos_posix_event_set(group, uxBitsToSet);
+	rtos_posix_unlock();
+
+	return ret;
+}
+
+int rtos_event_group_set_bits_from_isr(rtos_event_group_t xEventGroup,
+									   const rtos_event_bits_t uxBitsToSet)
+{
+	if (xEventGroup == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_event_group_set_bits(xEventGroup, uxBitsToSet);
+	return RTK_SUCCESS;
+}
+
+rtos_event_bits_t rtos_event_group_get_bits(rtos_event_group_t xEventGroup)
+{
+	struct rtos_posix_event_group *group = (struct rtos_posix_event_group *)xEventGroup;
+
+	return group ? __atomic_load_n(&group->bits, __ATOMIC_RELAXED) : 0;
+}
+
+rtos_event_bits_t rtos_event_group_sync(rtos_event_group_t xEventGroup, const rtos_event_bits_t uxBitsToSet,
+										const rtos_event_bits_t uxBitsToWaitFor, uint32_t MsToWait)
+{
+	struct rtos_posix_event_group *group = (struct rtos_posix_event_group *)xEventGroup;
+	rtos_event_bits_t ret;
+
+	if (group == NULL || uxBitsToWaitFor == 0) {
+		return 0;
+	}
+
+	/* set and wait is atomic, the last task to arrive releases the others */
+	rtos_posix_lock();
+	ret = group->bits | uxBitsToSet;
+	rtos_posix_event_set(group, uxBitsToSet);
+	if ((ret & uxBitsToWaitFor) == uxBitsToWaitFor) {
+		/* waiters released by our bits may have cleared them already */
+		group->bits &= ~uxBitsToWaitFor;
+	} else {
+		ret = rtos_posix_event_wait(group, uxBitsToWaitFor, RTOS_POSIX_EVENT_WAIT_ALL | RTOS_POSIX_EVENT_CLEAR, MsToWait);
+	}
+	rtos_posix_unlock();
+
+	return ret;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include "os_wrapper_posix.h"
+
+/* every block carries its size so the simulated heap can account for it, the header keeps
+ * the payload aligned like the target heap does */
+#define RTOS_POSIX_MEM_HDR		32
+
+static uint32_t rtos_posix_heap_used;
+static uint32_t rtos_posix_heap_min_free = RTOS_POSIX_HEAP_SIZE;
+
+void rtos_mem_init(void)
+{
+}
+
+void *rtos_mem_malloc(uint32_t size)
+{
+	uint32_t used, free_size;
+	void *p;
+
+	used = __atomic_add_fetch(&rtos_posix_heap_used, size, __ATOMIC_RELAXED);
+	if (used > RTOS_POSIX_HEAP_SIZE || used < size) {
+		__atomic_sub_fetch(&rtos_posix_heap_used, size, __ATOMIC_RELAXED);
+		return NULL;
+	}
+
+	if (posix_memalign(&p, RTOS_POSIX_MEM_HDR, (size_t)size + RTOS_POSIX_MEM_HDR) != 0) {
+		__atomic_sub_fetch(&rtos_posix_heap_used, size, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	*(uint32_t *)p = size;
+
+	free_size = RTOS_POSIX_HEAP_SIZE - used;
+	for (used = __atomic_load_n(&rtos_posix_heap_min_free, __ATOMIC_RELAXED); free_size < used;) {
+		if (__atomic_compare_exchange_n(&rtos_posix_heap_min_free, &used, free_size, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+
+	return (uint8_t *)p + RTOS_POSIX_MEM_HDR;
+}
+
+void *rtos_mem_zmalloc(uint32_t size)
+{
+	void *pbuf = NULL;
+
+	pbuf = rtos_mem_malloc(size);
+	if (pbuf != NULL) {
+		memset(pbuf, 0, size);
+	}
+
+	return pbuf;
+}
+
+void *rtos_mem_calloc(uint32_t elementNum, uint32_t elementSize)
+{
+	uint32_t sz = elementNum * elementSize;
+	return rtos_mem_zmalloc(sz);
+}
+
+void *rtos_mem_realloc(void *pbuf, uint32_t size)
+{
+	uint32_t old_size;
+	void *p;
+
+	if (pbuf == NULL) {
+		return rtos_mem_malloc(size);
+	}
+	if (size == 0) {
+		rtos_mem_free(pbuf);
+		return NULL;
+	}
+
+	p = rtos_mem_malloc(size);
+	if (p == NULL) {
+		return NULL;
+	}
+	old_size = *(uint32_t *)((uint8_t *)pbuf - RTOS_POSIX_MEM_HDR);
+	memcpy(p, pbuf, old_size < size ? old_size : size);
+	rtos_mem_free(pbuf);
+
+	return p;
+}
+
+void rtos_mem_free(void *pbuf)
+{
+	uint8_t *p;
+
+	if (pbuf == NULL) {
+		return;
+	}
+
+	p = (uint8_t *)pbuf - RTOS_POSIX_MEM_HDR;
+	__atomic_sub_fetch(&rtos_posix_heap_used, *(uint32_t *)p, __ATOMIC_RELAXED);
+	free(p);
+}
+
+uint32_t rtos_mem_get_free_heap_size(void)
+{
+	return RTOS_POSIX_HEAP_SIZE - __atomic_load_n(&rtos_posix_heap_used, __ATOMIC_RELAXED);
+}
+
+uint32_t rtos_mem_get_minimum_ever_free_heap_size(void)
+{
+	return __atomic_load_n(&rtos_posix_heap_min_free, __ATOMIC_RELAXED);
+}
+
+/* one host heap, the memory types only exist on the target */
+void *rtos_heap_types_malloc(uint32_t size, MALLOC_TYPES type)
+{
+	(void) type;
+	return rtos_mem_malloc(size);
+}
+
+void *rtos_heap_types_zmalloc(uint32_t size, MALLOC_TYPES type)
+{
+	(void) type;
+	return rtos_mem_zmalloc(size);
+}
+
+void *rtos_heap_types_calloc(uint32_t elementNum, uint32_t elementSize, MALLOC_TYPES type)
+{
+	(void) type;
+	return rtos_mem_calloc(elementNum, elementSize);
+}
+
+void *rtos_heap_types_realloc(void *pbuf, uint32_t size, MALLOC_TYPES type)
+{
+	(void) type;
+	return rtos_mem_realloc(pbuf, size);
+}
+
+void rtos_heap_types_free(void *pbuf)
+{
+	rtos_mem_free(pbuf);
+}
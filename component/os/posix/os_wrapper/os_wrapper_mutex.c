@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "os_wrapper_posix.h"
+
+struct rtos_posix_mutex {
+	struct rtos_posix_task *owner;
+	uint32_t count;
+	uint8_t recursive;
+	struct list_head waiters;
+};
+
+static int rtos_posix_mutex_create(rtos_mutex_t *pp_handle, uint8_t recursive)
+{
+	struct rtos_posix_mutex *mutex;
+
+	if (pp_handle == NULL) {
+		return RTK_FAIL;
+	}
+
+	mutex = (struct rtos_posix_mutex *)rtos_mem_zmalloc(sizeof(struct rtos_posix_mutex));
+	if (mutex == NULL) {
+		return RTK_FAIL;
+	}
+
+	mutex->recursive = recursive;
+	INIT_LIST_HEAD(&mutex->waiters);
+	rtos_posix_component_count(RTOS_POSIX_COMPONENT_MUTEX, 1);
+
+	*pp_handle = (rtos_mutex_t)mutex;
+	return RTK_SUCCESS;
+}
+
+static int rtos_posix_mutex_delete(rtos_mutex_t p_handle)
+{
+	struct rtos_posix_mutex *mutex = (struct rtos_posix_mutex *)p_handle;
+
+	if (mutex == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	if (!list_empty(&mutex->waiters)) {
+		RTOS_POSIX_LOG("delete mutex %p with waiting tasks\n", (void *)mutex);
+	}
+	if (mutex->owner) {
+		mutex->owner->mutexes_held--;
+	}
+	rtos_posix_unlock();
+
+	rtos_posix_component_count(RTOS_POSIX_COMPONENT_MUTEX, -1);
+	rtos_mem_free(mutex);
+	return RTK_SUCCESS;
+}
+
+static int rtos_posix_mutex_take(rtos_mutex_t p_handle, uint32_t wait_ms)
+{
+	struct rtos_posix_mutex *mutex = (struct rtos_posix_mutex *)p_handle;
+	struct rtos_posix_task *self;
+	int ret = RTK_SUCCESS;
+
+	if (mutex == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	self = rtos_posix_self();
+
+	if (mutex->owner == NULL) {
+		mutex->owner = self;
+		mutex->count = 1;
+		self->mutexes_held++;
+	} else if (mutex->owner == self && mutex->recursive) {
+		mutex->count++;
+	} else if (wait_ms == 0 || mutex->owner == self) {
+		ret = RTK_FAIL;
+	} else {
+		/* priority inheritance: the owner runs at least at the priority of its highest waiter */
+		if (mutex->owner->priority < self->priority) {
+			rtos_posix_set_priority(mutex->owner, self->priority);
+		}
+		/* rtos_posix_mutex_give() makes us the owner before waking us up */
+		ret = rtos_posix_block(&mutex->waiters, rtos_posix_deadline(wait_ms));
+	}
+	rtos_posix_unlock();
+
+	return ret;
+}
+
+static int rtos_posix_mutex_give(rtos_mutex_t p_handle)
+{
+	struct rtos_posix_mutex *mutex = (struct rtos_posix_mutex *)p_handle;
+	struct rtos_posix_task *self;
+	struct rtos_posix_task *next;
+
+	if (mutex == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	self = rtos_posix_self();
+
+	if (mutex->owner != self) {
+		rtos_posix_unlock();
+		return RTK_FAIL;
+	}
+
+	if (--mutex->count) {
+		rtos_posix_unlock();
+		return RTK_SUCCESS;
+	}
+
+	/* disinherit once the last mutex is released, like FreeRTOS */
+	if (--self->mutexes_held == 0 && self->priority != self->base_priority) {
+		rtos_posix_set_priority(self, self->base_priority);
+	}
+
+	mutex->owner = NULL;
+	if (!list_empty(&mutex->waiters)) {
+		next = list_first_entry(&mutex->waiters, struct rtos_posix_task, node);
+		mutex->owner = next;
+		mutex->count = 1;
+		next->mutexes_held++;
+		rtos_posix_wake(next);
+		/* the new owner inherits from the tasks still waiting */
+		if (!list_empty(&mutex->waiters) &&
+			list_first_entry(&mutex->waiters, struct rtos_posix_task, node)->priority > next->priority) {
+			rtos_posix_set_priority(next, list_first_entry(&mutex->waiters, struct rtos_posix_task, node)->priority);
+		}
+	}
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+/* no static pools on the host, static objects are allocated like dynamic ones */
+int rtos_mutex_create_static(rtos_mutex_t *pp_handle)
+{
+	return rtos_mutex_create(pp_handle);
+}
+
+int rtos_mutex_delete_static(rtos_mutex_t p_handle)
+{
+	return rtos_mutex_delete(p_handle);
+}
+
+int rtos_mutex_recursive_create_static(rtos_mutex_t *pp_handle)
+{
+	return rtos_mutex_recursive_create(pp_handle);
+}
+
+int rtos_mutex_recursive_delete_static(rtos_mutex_t p_handle)
+{
+	return rtos_mutex_recursive_delete(p_handle);
+}
+
+int rtos_mutex_create(rtos_mutex_t *pp_handle)
+{
+	return rtos_posix_mutex_create(pp_handle, 0);
+}
+
+int rtos_mutex_delete(rtos_mutex_t p_handle)
+{
+	return rtos_posix_mutex_delete(p_handle);
+}
+
+int rtos_mutex_take(rtos_mutex_t p_handle, uint32_t wait_ms)
+{
+	return rtos_posix_mutex_take(p_handle, wait_ms);
+}
+
+int rtos_mutex_give(rtos_mutex_t p_handle)
+{
+	return rtos_posix_mutex_give(p_handle);
+}
+
+int rtos_mutex_recursive_create(rtos_mutex_t *pp_handle)
+{
+	return rtos_posix_mutex_create(pp_handle, 1);
+}
+
+int rtos_mutex_recursive_delete(rtos_mutex_t p_handle)
+{
+	return rtos_posix_mutex_delete(p_handle);
+}
+
+int rtos_mutex_recursive_take(rtos_mutex_t p_handle, uint32_t wait_ms)
+{
+	return rtos_posix_mutex_take(p_handle, wait_ms);
+}
+
+int rtos_mutex_recursive_give(rtos_mutex_t p_handle)
+{
+	return rtos_posix_mutex_give(p_handle);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __OS_WRAPPER_POSIX_H__
+#define __OS_WRAPPER_POSIX_H__
+
+#include <pthread.h>
+#include "dlist.h"
+#include "os_wrapper.h"
+#include "os_wrapper_specific.h"
+
+/*
+ * Internal kernel of the pthread port.
+ * Every object (semaphore, mutex, queue, event group, timer) is plain data protected by one kernel lock,
+ * like FreeRTOS objects are protected by its critical section. A task that has to wait is queued on the
+ * wait list of the object, sorted by priority, and sleeps in rtos_posix_block(). rtos_posix_wake() is the
+ * only way out besides the timeout. Both the threaded and the deterministic scheduler are behind these
+ * two calls, so objects do not know which one is running.
+ */
+
+#define RTOS_POSIX_WAIT_FOREVER			UINT64_MAX
+#define RTOS_POSIX_TASK_NAME_LEN		16
+#define RTOS_POSIX_LOCAL_STORAGE_NUM	5
+
+#define RTOS_POSIX_LOG(fmt, ...)		printf("[OS] " fmt, ##__VA_ARGS__)
+
+enum rtos_posix_task_state {
+	RTOS_POSIX_TASK_READY = 0,
+	RTOS_POSIX_TASK_BLOCKED,
+	RTOS_POSIX_TASK_SUSPENDED,
+	RTOS_POSIX_TASK_DELETED,
+};
+
+#define RTOS_POSIX_EVENT_WAIT_ALL		0x1
+#define RTOS_POSIX_EVENT_CLEAR			0x2
+
+struct rtos_posix_task {
+	struct list_head node;			/* wait list of an object, or ready list in deterministic mode */
+	struct list_head all;			/* rtos_posix_tasks */
+	pthread_t thread;
+	pthread_cond_t cond;
+	char name[RTOS_POSIX_TASK_NAME_LEN];
+	rtos_task_function_t routine;
+	void *param;
+	uint16_t base_priority;
+	uint16_t priority;				/* base_priority or the one inherited through a mutex */
+	uint32_t mutexes_held;
+	uint8_t state;
+	uint8_t adopted;				/* thread not created by rtos_task_create, e.g. main */
+	uint8_t woken;
+	uint8_t suspend_req;
+	uint8_t delete_req;
+	struct list_head *wait_list;	/* list the task is queued on while blocked */
+	uint64_t deadline;
+	/* event group wait context, filled by the waiter and answered by the setter */
+	rtos_event_bits_t event_bits;
+	rtos_event_bits_t event_result;
+	uint8_t event_flags;
+	void *local_storage[RTOS_POSIX_LOCAL_STORAGE_NUM];
+};
+
+void rtos_posix_lock(void);
+void rtos_posix_unlock(void);
+
+struct rtos_posix_task *rtos_posix_self(void);
+uint64_t rtos_posix_now_ns(void);
+uint64_t rtos_posix_deadline(uint32_t wait_ms);
+
+int rtos_posix_block(struct list_head *wait_list, uint64_t deadline);
+void rtos_posix_wake(struct rtos_posix_task *task);
+int rtos_posix_wake_first(struct list_head *wait_list);
+void rtos_posix_set_priority(struct rtos_posix_task *task, uint16_t priority);
+
+void rtos_posix_time_advance(uint64_t ns);
+
+void rtos_posix_component_count(int type, int delta);
+
+#define RTOS_POSIX_COMPONENT_MUTEX		1
+#define RTOS_POSIX_COMPONENT_SEMA		2
+#define RTOS_POSIX_COMPONENT_TIMER		3
+
+#endif
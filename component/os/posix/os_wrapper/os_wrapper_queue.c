@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "os_wrapper_posix.h"
+
+struct rtos_posix_queue {
+	uint8_t *buf;
+	uint32_t msg_num;
+	uint32_t msg_size;
+	uint32_t head;			/* next message to receive */
+	uint32_t count;
+	struct list_head senders;
+	struct list_head receivers;
+};
+
+int rtos_queue_create(rtos_queue_t *pp_handle, uint32_t msg_num, uint32_t msg_size)
+{
+	struct rtos_posix_queue *queue;
+
+	if (pp_handle == NULL || msg_num == 0 || msg_size == 0) {
+		return RTK_FAIL;
+	}
+
+	queue = (struct rtos_posix_queue *)rtos_mem_zmalloc(sizeof(struct rtos_posix_queue) + msg_num * msg_size);
+	if (queue == NULL) {
+		return RTK_FAIL;
+	}
+
+	queue->buf = (uint8_t *)(queue + 1);
+	queue->msg_num = msg_num;
+	queue->msg_size = msg_size;
+	INIT_LIST_HEAD(&queue->senders);
+	INIT_LIST_HEAD(&queue->receivers);
+
+	*pp_handle = (rtos_queue_t)queue;
+	return RTK_SUCCESS;
+}
+
+int rtos_queue_delete(rtos_queue_t p_handle)
+{
+	struct rtos_posix_queue *queue = (struct rtos_posix_queue *)p_handle;
+
+	if (queue == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	if (queue->count) {
+		RTOS_POSIX_LOG("delete queue %p with %u messages\n", (void *)queue, (unsigned)queue->count);
+	}
+	if (!list_empty(&queue->senders) || !list_empty(&queue->receivers)) {
+		RTOS_POSIX_LOG("delete queue %p with waiting tasks\n", (void *)queue);
+	}
+	rtos_posix_unlock();
+
+	rtos_mem_free(queue);
+	return RTK_SUCCESS;
+}
+
+uint32_t rtos_queue_message_waiting(rtos_queue_t p_handle)
+{
+	struct rtos_posix_queue *queue = (struct rtos_posix_queue *)p_handle;
+
+	return queue ? __atomic_load_n(&queue->count, __ATOMIC_RELAXED) : 0;
+}
+
+/* a woken waiter retries with its original deadline, another task may have been faster */
+static int rtos_posix_queue_send(struct rtos_posix_queue *queue, void *p_msg, uint32_t wait_ms, int to_front)
+{
+	uint64_t deadline = 0;
+	uint32_t idx;
+
+	if (queue == NULL || p_msg == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	while (queue->count == queue->msg_num) {
+		if (wait_ms == 0) {
+			rtos_posix_unlock();
+			return RTK_FAIL;
+		}
+		if (deadline == 0) {
+			deadline = rtos_posix_deadline(wait_ms);
+		}
+		if (rtos_posix_block(&queue->senders, deadline) != RTK_SUCCESS) {
+			rtos_posix_unlock();
+			return RTK_FAIL;
+		}
+	}
+
+	if (to_front) {
+		queue->head = (queue->head + queue->msg_num - 1) % queue->msg_num;
+		idx = queue->head;
+	} else {
+		idx = (queue->head + queue->count) % queue->msg_num;
+	}
+	memcpy(queue->buf + idx * queue->msg_size, p_msg, queue->msg_size);
+	queue->count++;
+
+	rtos_posix_wake_first(&queue->receivers);
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+static int rtos_posix_queue_receive(struct rtos_posix_queue *queue, void *p_msg, uint32_t wait_ms, int peek)
+{
+	uint64_t deadline = 0;
+
+	if (queue == NULL || p_msg == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	while (queue->count == 0) {
+		if (wait_ms == 0) {
+			rtos_posix_unlock();
+			return RTK_FAIL;
+		}
+		if (deadline == 0) {
+			deadline = rtos_posix_deadline(wait_ms);
+		}
+		if (rtos_posix_block(&queue->receivers, deadline) != RTK_SUCCESS) {
+			rtos_posix_unlock();
+			return RTK_FAIL;
+		}
+	}
+
+	memcpy(p_msg, queue->buf + queue->head * queue->msg_size, queue->msg_size);
+	if (peek) {
+		/* the message stays, pass the wake-up on to the next reader */
+		rtos_posix_wake_first(&queue->receivers);
+	} else {
+		queue->head = (queue->head + 1) % queue->msg_num;
+		queue->count--;
+		rtos_posix_wake_first(&queue->senders);
+	}
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+int rtos_queue_send(rtos_queue_t p_handle, void *p_msg, uint32_t wait_ms)
+{
+	return rtos_posix_queue_send((struct rtos_posix_queue *)p_handle, p_msg, wait_ms, 0);
+}
+
+int rtos_queue_send_to_front(rtos_queue_t p_handle, void *p_msg, uint32_t wait_ms)
+{
+	return rtos_posix_queue_send((struct rtos_posix_queue *)p_handle, p_msg, wait_ms, 1);
+}
+
+int rtos_queue_receive(rtos_queue_t p_handle, void *p_msg, uint32_t wait_ms)
+{
+	return rtos_posix_queue_receive((struct rtos_posix_queue *)p_handle, p_msg, wait_ms, 0);
+}
+
+int rtos_queue_peek(rtos_queue_t p_handle, void *p_msg, uint32_t wait_ms)
+{
+	return rtos_posix_queue_receive((struct rtos_posix_queue *)p_handle, p_msg, wait_ms, 1);
+}
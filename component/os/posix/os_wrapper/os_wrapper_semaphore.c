@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "os_wrapper_posix.h"
+
+struct rtos_posix_sema {
+	uint32_t count;
+	uint32_t max_count;
+	struct list_head waiters;
+};
+
+/* no static pools on the host, static objects are allocated like dynamic ones */
+int rtos_sema_create_static(rtos_sema_t *pp_handle, uint32_t init_count, uint32_t max_count)
+{
+	return rtos_sema_create(pp_handle, init_count, max_count);
+}
+
+int rtos_sema_create_binary_static(rtos_sema_t *pp_handle)
+{
+	return rtos_sema_create_binary(pp_handle);
+}
+
+int rtos_sema_delete_static(rtos_sema_t p_handle)
+{
+	return rtos_sema_delete(p_handle);
+}
+
+int rtos_sema_create(rtos_sema_t *pp_handle, uint32_t init_count, uint32_t max_count)
+{
+	struct rtos_posix_sema *sema;
+
+	if (pp_handle == NULL || max_count == 0 || init_count > max_count) {
+		return RTK_FAIL;
+	}
+
+	sema = (struct rtos_posix_sema *)rtos_mem_zmalloc(sizeof(struct rtos_posix_sema));
+	if (sema == NULL) {
+		return RTK_FAIL;
+	}
+
+	sema->count = init_count;
+	sema->max_count = max_count;
+	INIT_LIST_HEAD(&sema->waiters);
+	rtos_posix_component_count(RTOS_POSIX_COMPONENT_SEMA, 1);
+
+	*pp_handle = (rtos_sema_t)sema;
+	return RTK_SUCCESS;
+}
+
+int rtos_sema_create_binary(rtos_sema_t *pp_handle)
+{
+	return rtos_sema_create(pp_handle, 0, 1);
+}
+
+int rtos_sema_delete(rtos_sema_t p_handle)
+{
+	struct rtos_posix_sema *sema = (struct rtos_posix_sema *)p_handle;
+
+	if (sema == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	if (!list_empty(&sema->waiters)) {
+		RTOS_POSIX_LOG("delete semaphore %p with waiting tasks\n", (void *)sema);
+	}
+	rtos_posix_unlock();
+
+	rtos_posix_component_count(RTOS_POSIX_COMPONENT_SEMA, -1);
+	rtos_mem_free(sema);
+	return RTK_SUCCESS;
+}
+
+int rtos_sema_take(rtos_sema_t p_handle, uint32_t timeout_ms)
+{
+	struct rtos_posix_sema *sema = (struct rtos_posix_sema *)p_handle;
+	int ret = RTK_SUCCESS;
+
+	if (sema == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	if (sema->count) {
+		sema->count--;
+	} else if (timeout_ms == 0) {
+		ret = RTK_FAIL;
+	} else {
+		/* a give while we wait hands its count over directly */
+		ret = rtos_posix_block(&sema->waiters, rtos_posix_deadline(timeout_ms));
+	}
+	rtos_posix_unlock();
+
+	return ret;
+}
+
+int rtos_sema_give(rtos_sema_t p_handle)
+{
+	struct rtos_posix_sema *sema = (struct rtos_posix_sema *)p_handle;
+	int ret = RTK_SUCCESS;
+
+	if (sema == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	if (rtos_posix_wake_first(&sema->waiters)) {
+		/* count passed to the highest priority waiter */
+	} else if (sema->count < sema->max_count) {
+		sema->count++;
+	} else {
+		ret = RTK_FAIL;
+	}
+	rtos_posix_unlock();
+
+	return ret;
+}
+
+uint32_t rtos_sema_get_count(rtos_sema_t p_handle)
+{
+	struct rtos_posix_sema *sema = (struct rtos_posix_sema *)p_handle;
+
+	return sema ? __atomic_load_n(&sema->count, __ATOMIC_RELAXED) : 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "os_wrapper_posix.h"
+
+/* there are no static pools on the host, every object counts as a dynamic one */
+static uint32_t rtos_posix_mutex_num, rtos_posix_mutex_max;
+static uint32_t rtos_posix_sema_num, rtos_posix_sema_max;
+static uint32_t rtos_posix_timer_num, rtos_posix_timer_max;
+
+void rtos_posix_component_count(int type, int delta)
+{
+	uint32_t *num, *max;
+
+	switch (type) {
+	case RTOS_POSIX_COMPONENT_MUTEX:
+		num = &rtos_posix_mutex_num;
+		max = &rtos_posix_mutex_max;
+		break;
+	case RTOS_POSIX_COMPONENT_SEMA:
+		num = &rtos_posix_sema_num;
+		max = &rtos_posix_sema_max;
+		break;
+	case RTOS_POSIX_COMPONENT_TIMER:
+		num = &rtos_posix_timer_num;
+		max = &rtos_posix_timer_max;
+		break;
+	default:
+		return;
+	}
+
+	rtos_posix_lock();
+	*num += delta;
+	if (*num > *max) {
+		*max = *num;
+	}
+	rtos_posix_unlock();
+}
+
+void rtos_static_get_component_status(struct component_status *comp_status)
+{
+	memset(comp_status, 0, sizeof(struct component_status));
+
+	rtos_posix_lock();
+	comp_status->mutex_dynamic_num = rtos_posix_mutex_num;
+	comp_status->mutex_max_buf_used_num = rtos_posix_mutex_max;
+	comp_status->sema_dynamic_num = rtos_posix_sema_num;
+	comp_status->sema_max_buf_used_num = rtos_posix_sema_max;
+	comp_status->timer_dynamic_num = rtos_posix_timer_num;
+	comp_status->timer_max_buf_used_num = rtos_posix_timer_max;
+	rtos_posix_unlock();
+}
@@ -0,0 +1,840 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include "os_wrapper_posix.h"
+
+#define RTOS_POSIX_DET()	(rtos_posix_mode == RTOS_POSIX_SCHED_DETERMINISTIC)
+
+static pthread_once_t rtos_posix_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t rtos_posix_kernel = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t rtos_posix_main_cond;		/* rtos_sched_start() sleeps here */
+static __thread struct rtos_posix_task *rtos_posix_tls_self;
+
+static LIST_HEAD(rtos_posix_tasks);
+static struct list_head rtos_posix_ready[RTOS_TASK_MAX_PRIORITIES];	/* deterministic mode only */
+static struct rtos_posix_task *rtos_posix_current;					/* deterministic mode only */
+
+static int rtos_posix_mode = -1;
+static int rtos_posix_sched_state = RTOS_SCHED_NOT_STARTED;
+static int rtos_posix_sched_done;
+static uint32_t rtos_posix_sched_suspended;
+static uint32_t rtos_posix_task_num;
+static int rtos_posix_rt_fallback;
+static uint64_t rtos_posix_epoch_ns;
+static uint64_t rtos_posix_virtual_ns;
+static uint64_t rtos_posix_switches;
+
+static uint64_t rtos_posix_clock_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void rtos_posix_cond_init(pthread_cond_t *cond)
+{
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+static void rtos_posix_init(void)
+{
+	const char *env;
+	int i;
+
+	rtos_posix_cond_init(&rtos_posix_main_cond);
+	for (i = 0; i < RTOS_TASK_MAX_PRIORITIES; i++) {
+		INIT_LIST_HEAD(&rtos_posix_ready[i]);
+	}
+	rtos_posix_epoch_ns = rtos_posix_clock_ns();
+
+	if (rtos_posix_mode < 0) {
+		env = getenv("RTOS_POSIX_SCHED");
+		if (env && strcmp(env, "det") == 0) {
+			rtos_posix_mode = RTOS_POSIX_SCHED_DETERMINISTIC;
+		} else if (env && strcmp(env, "rt") == 0) {
+			rtos_posix_mode = RTOS_POSIX_SCHED_RT;
+		} else {
+			rtos_posix_mode = RTOS_POSIX_SCHED_THREAD;
+		}
+	}
+}
+
+int rtos_posix_set_sched_mode(int mode)
+{
+	int ret = RTK_SUCCESS;
+
+	if (mode < RTOS_POSIX_SCHED_THREAD || mode > RTOS_POSIX_SCHED_DETERMINISTIC) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	if (rtos_posix_task_num || rtos_posix_sched_state != RTOS_SCHED_NOT_STARTED) {
+		ret = RTK_FAIL;
+	} else {
+		rtos_posix_mode = mode;
+	}
+	pthread_mutex_unlock(&rtos_posix_kernel);
+
+	return ret;
+}
+
+int rtos_posix_get_sched_mode(void)
+{
+	pthread_once(&rtos_posix_once, rtos_posix_init);
+	return rtos_posix_mode;
+}
+
+uint64_t rtos_posix_get_switch_count(void)
+{
+	return __atomic_load_n(&rtos_posix_switches, __ATOMIC_RELAXED);
+}
+
+struct rtos_posix_task *rtos_posix_self(void)
+{
+	struct rtos_posix_task *task = rtos_posix_tls_self;
+
+	if (task) {
+		return task;
+	}
+
+	/* a thread that was not created by rtos_task_create(), e.g. main. It gets a handle so that
+	 * rtos_* calls work, but is never scheduled by the deterministic scheduler. */
+	task = (struct rtos_posix_task *)calloc(1, sizeof(struct rtos_posix_task));
+	if (task == NULL) {
+		abort();
+	}
+	strncpy(task->name, "main", RTOS_POSIX_TASK_NAME_LEN - 1);
+	task->thread = pthread_self();
+	task->adopted = 1;
+	INIT_LIST_HEAD(&task->node);
+	INIT_LIST_HEAD(&task->all);
+	rtos_posix_cond_init(&task->cond);
+	rtos_posix_tls_self = task;
+
+	return task;
+}
+
+uint64_t rtos_posix_now_ns(void)
+{
+	pthread_once(&rtos_posix_once, rtos_posix_init);
+
+	if (RTOS_POSIX_DET()) {
+		return __atomic_load_n(&rtos_posix_virtual_ns, __ATOMIC_RELAXED);
+	}
+	return rtos_posix_clock_ns() - rtos_posix_epoch_ns;
+}
+
+uint64_t rtos_posix_deadline(uint32_t wait_ms)
+{
+	if (wait_ms == RTOS_MAX_DELAY) {
+		return RTOS_POSIX_WAIT_FOREVER;
+	}
+	return rtos_posix_now_ns() + (uint64_t)wait_ms * 1000000ULL;
+}
+
+/* waiters are sorted by priority, FIFO within a priority, like FreeRTOS event lists */
+static void rtos_posix_enqueue(struct list_head *wait_list, struct rtos_posix_task *task)
+{
+	struct list_head *pos;
+
+	list_for_each(pos, wait_list) {
+		if (list_entry(pos, struct rtos_posix_task, node)->priority < task->priority) {
+			break;
+		}
+	}
+	list_add_tail(&task->node, pos);
+}
+
+/* deterministic mode: ready every blocked task whose timeout has passed */
+static void rtos_posix_expire(void)
+{
+	struct rtos_posix_task *task;
+	struct list_head *pos;
+
+	list_for_each(pos, &rtos_posix_tasks) {
+		task = list_entry(pos, struct rtos_posix_task, all);
+		if (task->state != RTOS_POSIX_TASK_BLOCKED || task->deadline > rtos_posix_virtual_ns) {
+			continue;
+		}
+		if (task->wait_list) {
+			list_del_init(&task->node);
+			task->wait_list = NULL;
+		}
+		task->woken = 0;
+		task->state = RTOS_POSIX_TASK_READY;
+		list_add_tail(&task->node, &rtos_posix_ready[task->priority]);
+	}
+}
+
+/* deterministic mode: highest priority ready task, advancing virtual time while nothing is ready */
+static struct rtos_posix_task *rtos_posix_pick(void)
+{
+	struct rtos_posix_task *task;
+	struct list_head *pos;
+	uint64_t earliest;
+	int prio;
+
+	for (;;) {
+		for (prio = RTOS_TASK_MAX_PRIORITIES - 1; prio >= 0; prio--) {
+			while (!list_empty(&rtos_posix_ready[prio])) {
+				task = list_first_entry(&rtos_posix_ready[prio], struct rtos_posix_task, node);
+				list_del_init(&task->node);
+				if (task->suspend_req) {
+					task->state = RTOS_POSIX_TASK_SUSPENDED;
+					continue;
+				}
+				return task;
+			}
+		}
+
+		earliest = RTOS_POSIX_WAIT_FOREVER;
+		list_for_each(pos, &rtos_posix_tasks) {
+			task = list_entry(pos, struct rtos_posix_task, all);
+			if (task->state == RTOS_POSIX_TASK_BLOCKED && task->deadline < earliest) {
+				earliest = task->deadline;
+			}
+		}
+		if (earliest == RTOS_POSIX_WAIT_FOREVER) {
+			return NULL;
+		}
+		if (earliest > rtos_posix_virtual_ns) {
+			__atomic_store_n(&rtos_posix_virtual_ns, earliest, __ATOMIC_RELAXED);
+		}
+		rtos_posix_expire();
+	}
+}
+
+/* deterministic mode: hand the CPU to the next task. When nothing can ever run again the
+ * simulation is over and rtos_sched_start() returns. */
+static void rtos_posix_dispatch(struct rtos_posix_task *self)
+{
+	struct rtos_posix_task *next = rtos_posix_pick();
+
+	if (next != self) {
+		rtos_posix_switches++;
+	}
+	rtos_posix_current = next;
+	if (next == NULL) {
+		rtos_posix_sched_done = 1;
+		pthread_cond_signal(&rtos_posix_main_cond);
+	} else if (next != self) {
+		pthread_cond_signal(&next->cond);
+	}
+}
+
+static void rtos_posix_switch(struct rtos_posix_task *self)
+{
+	rtos_posix_dispatch(self);
+	while (rtos_posix_current != self && !self->delete_req) {
+		pthread_cond_wait(&self->cond, &rtos_posix_kernel);
+	}
+}
+
+static void rtos_posix_exit(struct rtos_posix_task *self)
+{
+	list_del(&self->all);
+	rtos_posix_task_num--;
+	self->state = RTOS_POSIX_TASK_DELETED;
+	if (RTOS_POSIX_DET() && rtos_posix_current == self) {
+		rtos_posix_dispatch(self);
+	}
+
+	rtos_posix_tls_self = NULL;
+	pthread_cond_destroy(&self->cond);
+	rtos_mem_free(self);
+	pthread_mutex_unlock(&rtos_posix_kernel);
+	pthread_exit(NULL);
+}
+
+/* pending delete / suspend requests of the calling task are served here */
+static void rtos_posix_checkpoint(struct rtos_posix_task *self)
+{
+	if (self->delete_req) {
+		rtos_posix_exit(self);
+	}
+
+	while (self->suspend_req) {
+		self->state = RTOS_POSIX_TASK_SUSPENDED;
+		if (RTOS_POSIX_DET()) {
+			rtos_posix_switch(self);
+		} else {
+			pthread_cond_wait(&self->cond, &rtos_posix_kernel);
+		}
+		if (self->delete_req) {
+			rtos_posix_exit(self);
+		}
+	}
+	self->state = RTOS_POSIX_TASK_READY;
+}
+
+void rtos_posix_lock(void)
+{
+	pthread_once(&rtos_posix_once, rtos_posix_init);
+	pthread_mutex_lock(&rtos_posix_kernel);
+}
+
+static int rtos_posix_ready_above(uint16_t priority)
+{
+	int prio;
+
+	for (prio = RTOS_TASK_MAX_PRIORITIES - 1; prio > priority; prio--) {
+		if (!list_empty(&rtos_posix_ready[prio])) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void rtos_posix_unlock(void)
+{
+	struct rtos_posix_task *self = rtos_posix_tls_self;
+
+	/* deterministic mode: preempt in favour of a higher priority task made ready by this call */
+	if (RTOS_POSIX_DET() && self && self == rtos_posix_current && rtos_posix_sched_suspended == 0 &&
+		rtos_get_critical_state() == 0 && rtos_posix_ready_above(self->priority)) {
+		/* a preempted task resumes first within its priority */
+		list_add(&self->node, &rtos_posix_ready[self->priority]);
+		rtos_posix_switch(self);
+		rtos_posix_checkpoint(self);
+	}
+
+	pthread_mutex_unlock(&rtos_posix_kernel);
+}
+
+int rtos_posix_block(struct list_head *wait_list, uint64_t deadline)
+{
+	struct rtos_posix_task *self = rtos_posix_self();
+	struct timespec ts;
+	uint64_t abs_ns;
+	int ret;
+
+	if (deadline != RTOS_POSIX_WAIT_FOREVER && deadline <= rtos_posix_now_ns()) {
+		return RTK_FAIL;
+	}
+
+	if (RTOS_POSIX_DET() && self != rtos_posix_current) {
+		/* not a scheduled task (main before rtos_sched_start()): nobody else can run to wake it,
+		 * plain delays just consume virtual time */
+		if (wait_list == NULL && deadline != RTOS_POSIX_WAIT_FOREVER) {
+			__atomic_store_n(&rtos_posix_virtual_ns, deadline, __ATOMIC_RELAXED);
+			rtos_posix_expire();
+		} else {
+			RTOS_POSIX_LOG("%s: blocking call outside a scheduled task fails in deterministic mode\n", self->name);
+		}
+		return RTK_FAIL;
+	}
+
+	self->woken = 0;
+	self->deadline = deadline;
+	self->state = RTOS_POSIX_TASK_BLOCKED;
+	self->wait_list = wait_list;
+	if (wait_list) {
+		rtos_posix_enqueue(wait_list, self);
+	}
+
+	if (RTOS_POSIX_DET()) {
+		rtos_posix_switch(self);
+	} else {
+		abs_ns = rtos_posix_epoch_ns + deadline;
+		ts.tv_sec = abs_ns / 1000000000ULL;
+		ts.tv_nsec = abs_ns % 1000000000ULL;
+		while (!self->woken && !self->delete_req) {
+			if (deadline == RTOS_POSIX_WAIT_FOREVER) {
+				pthread_cond_wait(&self->cond, &rtos_posix_kernel);
+			} else if (pthread_cond_timedwait(&self->cond, &rtos_posix_kernel, &ts) == ETIMEDOUT) {
+				break;
+			}
+		}
+	}
+
+	if (self->wait_list) {
+		list_del_init(&self->node);
+		self->wait_list = NULL;
+	}
+	ret = self->woken ? RTK_SUCCESS : RTK_FAIL;
+	rtos_posix_checkpoint(self);
+
+	return ret;
+}
+
+void rtos_posix_wake(struct rtos_posix_task *task)
+{
+	if (task->wait_list) {
+		list_del_init(&task->node);
+		task->wait_list = NULL;
+	}
+	task->woken = 1;
+
+	if (RTOS_POSIX_DET()) {
+		if (task->state == RTOS_POSIX_TASK_BLOCKED) {
+			task->state = RTOS_POSIX_TASK_READY;
+			list_add_tail(&task->node, &rtos_posix_ready[task->priority]);
+		}
+	} else {
+		pthread_cond_signal(&task->cond);
+	}
+}
+
+int rtos_posix_wake_first(struct list_head *wait_list)
+{
+	if (list_empty(wait_list)) {
+		return 0;
+	}
+
+	rtos_posix_wake(list_first_entry(wait_list, struct rtos_posix_task, node));
+	return 1;
+}
+
+void rtos_posix_set_priority(struct rtos_posix_task *task, uint16_t priority)
+{
+	struct sched_param param;
+
+	task->priority = priority;
+
+	if (task->wait_list) {
+		list_del(&task->node);
+		rtos_posix_enqueue(task->wait_list, task);
+	} else if (RTOS_POSIX_DET() && task->state == RTOS_POSIX_TASK_READY && !task->adopted &&
+			   task != rtos_posix_current && !list_empty(&task->node)) {
+		list_del(&task->node);
+		list_add_tail(&task->node, &rtos_posix_ready[priority]);
+	}
+
+	if (rtos_posix_mode == RTOS_POSIX_SCHED_RT && !rtos_posix_rt_fallback && !task->adopted) {
+		param.sched_priority = sched_get_priority_min(SCHED_FIFO) + priority;
+		pthread_setschedparam(task->thread, SCHED_FIFO, &param);
+	}
+}
+
+void rtos_posix_time_advance(uint64_t ns)
+{
+	rtos_posix_lock();
+	__atomic_store_n(&rtos_posix_virtual_ns, rtos_posix_virtual_ns + ns, __ATOMIC_RELAXED);
+	rtos_posix_expire();
+	rtos_posix_unlock();
+}
+
+static void *rtos_posix_task_entry(void *arg)
+{
+	struct rtos_posix_task *self = (struct rtos_posix_task *)arg;
+
+	rtos_posix_tls_self = self;
+
+	/* wait for rtos_sched_start(), in deterministic mode also for the first turn */
+	pthread_mutex_lock(&rtos_posix_kernel);
+	while (!self->delete_req && (rtos_posix_sched_state == RTOS_SCHED_NOT_STARTED ||
+								 (RTOS_POSIX_DET() && rtos_posix_current != self))) {
+		pthread_cond_wait(&self->cond, &rtos_posix_kernel);
+	}
+	rtos_posix_checkpoint(self);
+	pthread_mutex_unlock(&rtos_posix_kernel);
+
+	self->routine(self->param);
+
+	/* FreeRTOS tasks must not return, take it as deleting itself */
+	rtos_task_delete(NULL);
+	return NULL;
+}
+
+static int rtos_posix_thread_create(struct rtos_posix_task *task, size_t stack_size)
+{
+	pthread_attr_t attr;
+	struct sched_param param;
+	cpu_set_t cpus;
+	int rt = (rtos_posix_mode == RTOS_POSIX_SCHED_RT && !rtos_posix_rt_fallback);
+	int ret;
+
+	for (;;) {
+		pthread_attr_init(&attr);
+		pthread_attr_setstacksize(&attr, stack_size);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		if (rt) {
+			/* one core and fixed priorities, the same preemption rules as FreeRTOS on a single core */
+			pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+			pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+			param.sched_priority = sched_get_priority_min(SCHED_FIFO) + task->priority;
+			pthread_attr_setschedparam(&attr, &param);
+			CPU_ZERO(&cpus);
+			CPU_SET(0, &cpus);
+			pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+		}
+
+		ret = pthread_create(&task->thread, &attr, rtos_posix_task_entry, task);
+		pthread_attr_destroy(&attr);
+
+		if (ret == EPERM && rt) {
+			RTOS_POSIX_LOG("SCHED_FIFO not permitted, tasks use the default policy\n");
+			rtos_posix_rt_fallback = 1;
+			rt = 0;
+			continue;
+		}
+		return ret;
+	}
+}
+
+int rtos_sched_start(void)
+{
+	struct list_head *pos;
+
+	rtos_posix_lock();
+	if (rtos_posix_sched_state != RTOS_SCHED_NOT_STARTED) {
+		pthread_mutex_unlock(&rtos_posix_kernel);
+		return RTK_SUCCESS;
+	}
+
+	rtos_posix_sched_state = RTOS_SCHED_RUNNING;
+	rtos_posix_sched_done = 0;
+
+	if (RTOS_POSIX_DET()) {
+		rtos_posix_dispatch(NULL);
+	} else {
+		list_for_each(pos, &rtos_posix_tasks) {
+			pthread_cond_signal(&list_entry(pos, struct rtos_posix_task, all)->cond);
+		}
+	}
+
+	/* the calling thread becomes the idle context until the scheduler ends */
+	while (!rtos_posix_sched_done) {
+		pthread_cond_wait(&rtos_posix_main_cond, &rtos_posix_kernel);
+	}
+	pthread_mutex_unlock(&rtos_posix_kernel);
+
+	return RTK_SUCCESS;
+}
+
+int rtos_sched_stop(void)
+{
+	struct rtos_posix_task *self = rtos_posix_tls_self;
+
+	rtos_posix_lock();
+	rtos_posix_sched_done = 1;
+	pthread_cond_signal(&rtos_posix_main_cond);
+
+	/* deterministic mode: nothing runs after the scheduler stops, park the caller */
+	if (RTOS_POSIX_DET() && self && self == rtos_posix_current) {
+		rtos_posix_current = NULL;
+		while (rtos_posix_current != self) {
+			pthread_cond_wait(&self->cond, &rtos_posix_kernel);
+		}
+	}
+	pthread_mutex_unlock(&rtos_posix_kernel);
+
+	return RTK_SUCCESS;
+}
+
+int rtos_sched_suspend(void)
+{
+	/* host threads can not be frozen, in threaded modes this only excludes critical sections */
+	if (!RTOS_POSIX_DET()) {
+		__rtos_critical_enter_os();
+	}
+	rtos_posix_lock();
+	rtos_posix_sched_suspended++;
+	pthread_mutex_unlock(&rtos_posix_kernel);
+
+	return RTK_SUCCESS;
+}
+
+int rtos_sched_resume(void)
+{
+	rtos_posix_lock();
+	if (rtos_posix_sched_suspended) {
+		rtos_posix_sched_suspended--;
+	}
+	rtos_posix_unlock();
+	if (!RTOS_POSIX_DET()) {
+		__rtos_critical_exit_os();
+	}
+
+	return RTK_SUCCESS;
+}
+
+int rtos_sched_get_state(void)
+{
+	if (rtos_posix_sched_state == RTOS_SCHED_NOT_STARTED) {
+		return RTOS_SCHED_NOT_STARTED;
+	}
+	return rtos_posix_sched_suspended ? RTOS_SCHED_SUSPENDED : RTOS_SCHED_RUNNING;
+}
+
+int rtos_task_create(rtos_task_t *pp_handle, const char *p_name, rtos_task_function_t p_routine,
+					 void *p_param, size_t stack_size_in_byte, uint16_t priority)
+{
+	struct rtos_posix_task *task;
+	size_t stack_size;
+
+	if (p_routine == NULL) {
+		return RTK_FAIL;
+	}
+
+	task = (struct rtos_posix_task *)rtos_mem_zmalloc(sizeof(struct rtos_posix_task));
+	if (task == NULL) {
+		return RTK_FAIL;
+	}
+
+	if (priority >= RTOS_TASK_MAX_PRIORITIES) {
+		priority = RTOS_TASK_MAX_PRIORITIES - 1;
+	}
+	strncpy(task->name, p_name ? p_name : "", RTOS_POSIX_TASK_NAME_LEN - 1);
+	task->routine = p_routine;
+	task->param = p_param;
+	task->base_priority = priority;
+	task->priority = priority;
+	task->state = RTOS_POSIX_TASK_READY;
+	INIT_LIST_HEAD(&task->node);
+	rtos_posix_cond_init(&task->cond);
+
+	stack_size = stack_size_in_byte * RTOS_POSIX_STACK_SCALE;
+	if (stack_size < RTOS_POSIX_MIN_STACK_SIZE) {
+		stack_size = RTOS_POSIX_MIN_STACK_SIZE;
+	}
+	if (stack_size < (size_t)PTHREAD_STACK_MIN) {
+		stack_size = PTHREAD_STACK_MIN;
+	}
+
+	rtos_posix_lock();
+	list_add_tail(&task->all, &rtos_posix_tasks);
+	rtos_posix_task_num++;
+	if (RTOS_POSIX_DET()) {
+		list_add_tail(&task->node, &rtos_posix_ready[priority]);
+	}
+
+	if (rtos_posix_thread_create(task, stack_size) != 0) {
+		list_del(&task->all);
+		list_del(&task->node);
+		rtos_posix_task_num--;
+		pthread_mutex_unlock(&rtos_posix_kernel);
+		pthread_cond_destroy(&task->cond);
+		rtos_mem_free(task);
+		return RTK_FAIL;
+	}
+
+	/* set before the new task can preempt the caller, as FreeRTOS does */
+	if (pp_handle) {
+		*pp_handle = (rtos_task_t)task;
+	}
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+int rtos_task_delete(rtos_task_t p_handle)
+{
+	struct rtos_posix_task *self;
+	struct rtos_posix_task *task;
+
+	rtos_posix_lock();
+	self = rtos_posix_self();
+	task = p_handle ? (struct rtos_posix_task *)p_handle : self;
+
+	if (task == self) {
+		if (self->adopted) {
+			pthread_mutex_unlock(&rtos_posix_kernel);
+			return RTK_FAIL;
+		}
+		rtos_posix_exit(self);
+	}
+
+	/* the task leaves at its next kernel call. A blocked task is woken up for it, while running
+	 * user code in a threaded mode it can not be stopped before. */
+	task->delete_req = 1;
+	if (task->wait_list) {
+		list_del_init(&task->node);
+		task->wait_list = NULL;
+	} else if (RTOS_POSIX_DET() && !list_empty(&task->node)) {
+		list_del_init(&task->node);
+	}
+	pthread_cond_signal(&task->cond);
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+int rtos_task_suspend(rtos_task_t p_handle)
+{
+	struct rtos_posix_task *self;
+	struct rtos_posix_task *task;
+
+	rtos_posix_lock();
+	self = rtos_posix_self();
+	task = p_handle ? (struct rtos_posix_task *)p_handle : self;
+
+	task->suspend_req = 1;
+	if (task == self) {
+		rtos_posix_checkpoint(self);
+	} else if (RTOS_POSIX_DET() && task->state == RTOS_POSIX_TASK_READY && !list_empty(&task->node)) {
+		list_del_init(&task->node);
+		task->state = RTOS_POSIX_TASK_SUSPENDED;
+	}
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+int rtos_task_resume(rtos_task_t p_handle)
+{
+	struct rtos_posix_task *task = (struct rtos_posix_task *)p_handle;
+
+	if (task == NULL) {
+		return RTK_SUCCESS;
+	}
+
+	rtos_posix_lock();
+	task->suspend_req = 0;
+	if (task->state == RTOS_POSIX_TASK_SUSPENDED) {
+		if (RTOS_POSIX_DET()) {
+			task->state = RTOS_POSIX_TASK_READY;
+			list_add_tail(&task->node, &rtos_posix_ready[task->priority]);
+		} else {
+			pthread_cond_signal(&task->cond);
+		}
+	}
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+int rtos_task_yield(void)
+{
+	struct rtos_posix_task *self;
+
+	if (!RTOS_POSIX_DET()) {
+		sched_yield();
+		return RTK_SUCCESS;
+	}
+
+	rtos_posix_lock();
+	self = rtos_posix_self();
+	if (self == rtos_posix_current) {
+		list_add_tail(&self->node, &rtos_posix_ready[self->priority]);
+		rtos_posix_switch(self);
+		rtos_posix_checkpoint(self);
+	}
+	pthread_mutex_unlock(&rtos_posix_kernel);
+
+	return RTK_SUCCESS;
+}
+
+rtos_task_t rtos_task_handle_get(void)
+{
+	return (rtos_task_t)rtos_posix_self();
+}
+
+char *rtos_task_name_get(rtos_task_t p_handle)
+{
+	struct rtos_posix_task *task = p_handle ? (struct rtos_posix_task *)p_handle : rtos_posix_self();
+
+	return task->name;
+}
+
+uint32_t rtos_task_priority_get(rtos_task_t p_handle)
+{
+	struct rtos_posix_task *task = p_handle ? (struct rtos_posix_task *)p_handle : rtos_posix_self();
+
+	return task->priority;
+}
+
+int rtos_task_priority_set(rtos_task_t p_handle, uint16_t priority)
+{
+	struct rtos_posix_task *task;
+
+	if (priority >= RTOS_TASK_MAX_PRIORITIES) {
+		priority = RTOS_TASK_MAX_PRIORITIES - 1;
+	}
+
+	rtos_posix_lock();
+	task = p_handle ? (struct rtos_posix_task *)p_handle : rtos_posix_self();
+	task->base_priority = priority;
+	/* an inherited priority is kept until the task releases its mutexes */
+	if (task->mutexes_held == 0 || priority > task->priority) {
+		rtos_posix_set_priority(task, priority);
+	}
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+void rtos_task_out_current_status(void)
+{
+	static const char state_name[] = {'R', 'B', 'S', 'D'};
+	struct rtos_posix_task *task;
+	struct list_head *pos;
+
+	rtos_posix_lock();
+	printf("%-16s %-5s %-4s %-4s\n", "Name", "State", "Prio", "Base");
+	list_for_each(pos, &rtos_posix_tasks) {
+		task = list_entry(pos, struct rtos_posix_task, all);
+		printf("%-16s %-5c %-4u %-4u\n", task->name,
+			   (RTOS_POSIX_DET() && task == rtos_posix_current) ? 'X' : state_name[task->state],
+			   task->priority, task->base_priority);
+	}
+	pthread_mutex_unlock(&rtos_posix_kernel);
+}
+
+void rtos_create_secure_context(uint32_t size)
+{
+	(void) size;
+}
+
+void rtos_task_set_thread_local_storage_pointer(rtos_task_t p_handle, uint16_t index, void *p_param)
+{
+	struct rtos_posix_task *task = p_handle ? (struct rtos_posix_task *)p_handle : rtos_posix_self();
+
+	if (index < RTOS_POSIX_LOCAL_STORAGE_NUM) {
+		task->local_storage[index] = p_param;
+	}
+}
+
+void *rtos_task_get_thread_local_storage_pointer(rtos_task_t p_handle, uint16_t index)
+{
+	struct rtos_posix_task *task = p_handle ? (struct rtos_posix_task *)p_handle : rtos_posix_self();
+
+	if (index < RTOS_POSIX_LOCAL_STORAGE_NUM) {
+		return task->local_storage[index];
+	}
+	return NULL;
+}
+
+void rtos_task_set_time_out_state(rtos_time_out_t *const p_rtos_time_out)
+{
+	uint64_t now_ms = rtos_time_get_current_system_time_ms_64bit();
+
+	p_rtos_time_out->over_flow_count = (uint32_t)(now_ms >> 32);
+	p_rtos_time_out->time_on_entering = (uint32_t)now_ms;
+}
+
+int rtos_task_check_for_time_out(rtos_time_out_t *const p_rtos_time_out, uint32_t *p_ms_to_wait)
+{
+	uint64_t start_ms = ((uint64_t)p_rtos_time_out->over_flow_count << 32) | p_rtos_time_out->time_on_entering;
+	uint64_t elapsed = rtos_time_get_current_system_time_ms_64bit() - start_ms;
+
+	if (*p_ms_to_wait == RTOS_MAX_DELAY) {
+		return FALSE;
+	}
+
+	if (elapsed < *p_ms_to_wait) {
+		/* some block time remains, restart the measurement from now */
+		*p_ms_to_wait -= (uint32_t)elapsed;
+		rtos_task_set_time_out_state(p_rtos_time_out);
+		return FALSE;
+	}
+
+	*p_ms_to_wait = 0;
+	return TRUE;
+}
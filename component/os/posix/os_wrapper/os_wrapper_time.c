@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "os_wrapper_posix.h"
+
+void rtos_time_delay_ms(uint32_t ms)
+{
+	if (ms == 0) {
+		rtos_task_yield();
+		return;
+	}
+
+	rtos_posix_lock();
+	rtos_posix_block(NULL, rtos_posix_deadline(ms));
+	rtos_posix_unlock();
+}
+
+void rtos_time_delay_us(uint32_t us)
+{
+	uint64_t end;
+
+	/* a busy wait on the target, in deterministic mode it only consumes virtual time */
+	if (rtos_posix_get_sched_mode() == RTOS_POSIX_SCHED_DETERMINISTIC) {
+		rtos_posix_time_advance((uint64_t)us * 1000ULL);
+		return;
+	}
+
+	end = rtos_posix_now_ns() + (uint64_t)us * 1000ULL;
+	while (rtos_posix_now_ns() < end);
+}
+
+uint32_t rtos_time_get_current_system_time_ms(void)
+{
+	return (uint32_t)(rtos_posix_now_ns() / 1000000ULL);
+}
+
+uint64_t rtos_time_get_current_system_time_ms_64bit(void)
+{
+	return rtos_posix_now_ns() / 1000000ULL;
+}
+
+uint32_t rtos_time_get_current_pended_time_ms(void)
+{
+	return 0;
+}
+
+uint64_t rtos_time_get_current_system_time_us(void)
+{
+	return rtos_posix_now_ns() / 1000ULL;
+}
+
+uint64_t rtos_time_get_current_system_time_ns(void)
+{
+	return rtos_posix_now_ns();
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2024 Realtek Semiconductor Corp.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "os_wrapper_posix.h"
+
+#define RTOS_POSIX_TIMER_TASK_PRIORITY		(RTOS_TASK_MAX_PRIORITIES - 1)
+#define RTOS_POSIX_TIMER_TASK_STACK_SIZE	4096
+
+struct rtos_posix_timer {
+	struct list_head node;			/* rtos_posix_timer_active, sorted by expiry */
+	const char *name;
+	uint32_t id;
+	uint64_t period_ns;
+	uint64_t expiry;
+	uint8_t reload;
+	uint8_t active;
+	uint8_t running;				/* callback in progress */
+	uint8_t deleted;				/* deleted from its own callback, freed when it returns */
+	void (*callback)(void *);
+};
+
+/* all timers are served by one task, like the FreeRTOS timer service task */
+static pthread_once_t rtos_posix_timer_once = PTHREAD_ONCE_INIT;
+static LIST_HEAD(rtos_posix_timer_active);
+static LIST_HEAD(rtos_posix_timer_waiter);
+
+static void rtos_posix_timer_insert(struct rtos_posix_timer *timer)
+{
+	struct list_head *pos;
+
+	list_for_each(pos, &rtos_posix_timer_active) {
+		if (list_entry(pos, struct rtos_posix_timer, node)->expiry > timer->expiry) {
+			break;
+		}
+	}
+	list_add_tail(&timer->node, pos);
+	timer->active = 1;
+
+	if (rtos_posix_timer_active.next == &timer->node) {
+		rtos_posix_wake_first(&rtos_posix_timer_waiter);
+	}
+}
+
+static void rtos_posix_timer_remove(struct rtos_posix_timer *timer)
+{
+	if (timer->active) {
+		list_del_init(&timer->node);
+		timer->active = 0;
+	}
+}
+
+static void rtos_posix_timer_task(void *param)
+{
+	struct rtos_posix_timer *timer;
+	uint64_t now;
+
+	(void) param;
+
+	rtos_posix_lock();
+	for (;;) {
+		if (list_empty(&rtos_posix_timer_active)) {
+			rtos_posix_block(&rtos_posix_timer_waiter, RTOS_POSIX_WAIT_FOREVER);
+			continue;
+		}
+
+		timer = list_first_entry(&rtos_posix_timer_active, struct rtos_posix_timer, node);
+		now = rtos_posix_now_ns();
+		if (timer->expiry > now) {
+			rtos_posix_block(&rtos_posix_timer_waiter, timer->expiry);
+			continue;
+		}
+
+		rtos_posix_timer_remove(timer);
+		if (timer->reload) {
+			/* periodic timers keep their phase, missed periods are not replayed */
+			timer->expiry += timer->period_ns;
+			if (timer->expiry <= now) {
+				timer->expiry = now + timer->period_ns;
+			}
+			rtos_posix_timer_insert(timer);
+		}
+
+		timer->running = 1;
+		rtos_posix_unlock();
+		timer->callback((void *)timer);
+		rtos_posix_lock();
+		timer->running = 0;
+
+		if (timer->deleted) {
+			rtos_mem_free(timer);
+		}
+	}
+}
+
+static void rtos_posix_timer_init(void)
+{
+	if (rtos_task_create(NULL, "Tmr Svc", rtos_posix_timer_task, NULL, RTOS_POSIX_TIMER_TASK_STACK_SIZE,
+						 RTOS_POSIX_TIMER_TASK_PRIORITY) != RTK_SUCCESS) {
+		RTOS_POSIX_LOG("timer task create fail\n");
+	}
+}
+
+/* no static pools on the host, static objects are allocated like dynamic ones */
+int rtos_timer_create_static(rtos_timer_t *pp_handle, const char *p_timer_name, uint32_t timer_id,
+							 uint32_t interval_ms, uint8_t reload, void (*p_timer_callback)(void *))
+{
+	return rtos_timer_create(pp_handle, p_timer_name, timer_id, interval_ms, reload, p_timer_callback);
+}
+
+int rtos_timer_delete_static(rtos_timer_t p_handle, uint32_t wait_ms)
+{
+	return rtos_timer_delete(p_handle, wait_ms);
+}
+
+int rtos_timer_create(rtos_timer_t *pp_handle, const char *p_timer_name, uint32_t timer_id,
+					  uint32_t interval_ms, uint8_t reload, void (*p_timer_callback)(void *))
+{
+	struct rtos_posix_timer *timer;
+
+	if (pp_handle == NULL || p_timer_callback == NULL || interval_ms == 0) {
+		return RTK_FAIL;
+	}
+
+	pthread_once(&rtos_posix_timer_once, rtos_posix_timer_init);
+
+	timer = (struct rtos_posix_timer *)rtos_mem_zmalloc(sizeof(struct rtos_posix_timer));
+	if (timer == NULL) {
+		return RTK_FAIL;
+	}
+
+	timer->name = p_timer_name;
+	timer->id = timer_id;
+	timer->period_ns = (uint64_t)interval_ms * 1000000ULL;
+	timer->reload = reload;
+	timer->callback = p_timer_callback;
+	INIT_LIST_HEAD(&timer->node);
+	rtos_posix_component_count(RTOS_POSIX_COMPONENT_TIMER, 1);
+
+	*pp_handle = (rtos_timer_t)timer;
+	return RTK_SUCCESS;
+}
+
+int rtos_timer_delete(rtos_timer_t p_handle, uint32_t wait_ms)
+{
+	struct rtos_posix_timer *timer = (struct rtos_posix_timer *)p_handle;
+
+	(void) wait_ms;
+
+	if (timer == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	rtos_posix_timer_remove(timer);
+	if (timer->running) {
+		timer->deleted = 1;
+	} else {
+		rtos_mem_free(timer);
+	}
+	rtos_posix_unlock();
+
+	rtos_posix_component_count(RTOS_POSIX_COMPONENT_TIMER, -1);
+	return RTK_SUCCESS;
+}
+
+int rtos_timer_start(rtos_timer_t p_handle, uint32_t wait_ms)
+{
+	struct rtos_posix_timer *timer = (struct rtos_posix_timer *)p_handle;
+
+	(void) wait_ms;
+
+	if (timer == NULL) {
+		return RTK_FAIL;
+	}
+
+	/* starting an active timer restarts it, as xTimerStart() does */
+	rtos_posix_lock();
+	rtos_posix_timer_remove(timer);
+	timer->expiry = rtos_posix_now_ns() + timer->period_ns;
+	rtos_posix_timer_insert(timer);
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+int rtos_timer_stop(rtos_timer_t p_handle, uint32_t wait_ms)
+{
+	struct rtos_posix_timer *timer = (struct rtos_posix_timer *)p_handle;
+
+	(void) wait_ms;
+
+	if (timer == NULL) {
+		return RTK_FAIL;
+	}
+
+	rtos_posix_lock();
+	rtos_posix_timer_remove(timer);
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+int rtos_timer_change_period(rtos_timer_t p_handle, uint32_t interval_ms, uint32_t wait_ms)
+{
+	struct rtos_posix_timer *timer = (struct rtos_posix_timer *)p_handle;
+
+	(void) wait_ms;
+
+	if (timer == NULL || interval_ms == 0) {
+		return RTK_FAIL;
+	}
+
+	/* like xTimerChangePeriod(), a dormant timer is started as well */
+	rtos_posix_lock();
+	rtos_posix_timer_remove(timer);
+	timer->period_ns = (uint64_t)interval_ms * 1000000ULL;
+	timer->expiry = rtos_posix_now_ns() + timer->period_ns;
+	rtos_posix_timer_insert(timer);
+	rtos_posix_unlock();
+
+	return RTK_SUCCESS;
+}
+
+uint32_t rtos_timer_is_timer_active(rtos_timer_t p_handle)
+{
+	struct rtos_posix_timer *timer = (struct rtos_posix_timer *)p_handle;
+
+	return timer ? timer->active : 0;
+}
+
+uint32_t rtos_timer_get_id(rtos_timer_t p_handle)
+{
+	struct rtos_posix_timer *timer = (struct rtos_posix_timer *)p_handle;
+
+	return timer ? timer->id : 0;
+}
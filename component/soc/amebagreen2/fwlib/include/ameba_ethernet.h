@@ -2774,6 +2774,7 @@ u8 *Ethernet_GetRXPktInfo(ETH_InitTypeDef *ETH_InitStruct, u32 *rx_len);
 void Ethernet_UpdateRXDESC(ETH_InitTypeDef *ETH_InitStruct);
 u8 *Ethernet_GetTXPktInfo(ETH_InitTypeDef *ETH_InitStruct);
 void Ethernet_UpdateTXDESCAndSend(ETH_InitTypeDef *ETH_InitStruct, u32 size);
+u32 Ethernet_UpdateTXDESCSGAndSend(ETH_InitTypeDef *ETH_InitStruct, u8 **buf, u32 *size, u32 num);
 
 extern void ethernet_mii_init(void);
 extern int link_is_up;
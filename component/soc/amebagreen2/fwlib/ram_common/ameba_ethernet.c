@@ -313,6 +313,75 @@ void Ethernet_UpdateTXDESCAndSend(ETH_InitTypeDef *ETH_InitStruct, u32 size)
 	}
 }
 
+/**
+ *  @brief Fill consecutive tx descriptors with the segments of one pkt and send it.
+ *
+ *  @param[in]  ETH_InitStruct The pointer to ETH_InitTypeDef.
+ *  @param[in]  buf The segment addresses, referred by tx descriptors directly.
+ *  @param[in]  size The segment sizes.
+ *  @param[in]  num The number of segments.
+ *
+ *  @returns    The number of tx descriptors used, 0 if not enough descriptors are available.
+ *  @note       The segments must stay valid until HW clears OWN bit of the descriptors.
+ */
+u32 Ethernet_UpdateTXDESCSGAndSend(ETH_InitTypeDef *ETH_InitStruct, u8 **buf, u32 *size, u32 num)
+{
+	ETHERNET_TypeDef *RMII = ((ETHERNET_TypeDef *) RMII_REG_BASE);
+	u8 first_idx, tx_idx;
+	u32 i, dw1;
+
+	if ((ETH_InitStruct == NULL) || (num == 0) || (num > ETH_InitStruct->ETH_TxDescNum)) {
+		RTK_LOGE(TAG, "Invalid parameter !!\r\n");
+		return 0;
+	}
+
+	first_idx = ETH_InitStruct->ETH_TxDescCurrentNum;
+
+	for (i = 0, tx_idx = first_idx; i < num; i++) {
+		if (((u32)(ETH_InitStruct->ETH_TxDesc[tx_idx].dw1)) & FEMAC_TX_DSC_BIT_OWN) {
+			RMII->ETH_ISR_AND_IMR |= BIT_ISR_TOK_TI;
+			return 0;
+		}
+		tx_idx = (tx_idx == ((ETH_InitStruct->ETH_TxDescNum) - 1)) ? 0 : (tx_idx + 1);
+	}
+
+	for (i = 0, tx_idx = first_idx; i < num; i++) {
+		DCache_Clean((u32)buf[i], size[i]);
+
+		ETH_InitStruct->ETH_TxDesc[tx_idx].addr = (u32)buf[i];
+		ETH_InitStruct->ETH_TxDesc[tx_idx].dw2 = 0;
+		ETH_InitStruct->ETH_TxDesc[tx_idx].dw3 = 0;
+		ETH_InitStruct->ETH_TxDesc[tx_idx].dw4 = 0;
+
+		dw1 = FEMAC_TX_DSC_BIT_IPCS | FEMAC_TX_DSC_BIT_L4CS | FEMAC_TX_DSC_BIT_CRC | FEMAC_TX_DSC_BIT_SIZE(size[i]);
+		if (i == 0) {
+			dw1 |= FEMAC_TX_DSC_BIT_FS;
+		} else {
+			/* first descriptor is handed over last, HW never sees a partial pkt */
+			dw1 |= FEMAC_TX_DSC_BIT_OWN;
+		}
+		if (i == (num - 1)) {
+			dw1 |= FEMAC_TX_DSC_BIT_LS;
+		}
+		if (tx_idx == ((ETH_InitStruct->ETH_TxDescNum) - 1)) {
+			dw1 |= FEMAC_TX_DSC_BIT_EOR;
+		}
+		ETH_InitStruct->ETH_TxDesc[tx_idx].dw1 = dw1;
+
+		tx_idx = (tx_idx == ((ETH_InitStruct->ETH_TxDescNum) - 1)) ? 0 : (tx_idx + 1);
+	}
+
+	__DSB();
+	ETH_InitStruct->ETH_TxDesc[first_idx].dw1 |= FEMAC_TX_DSC_BIT_OWN;
+
+	RMII->ETH_ISR_AND_IMR |= BIT_ISR_TOK_TI;
+	RMII->ETH_ETHER_IO_CMD |= BIT_TXFN1ST;
+
+	ETH_InitStruct->ETH_TxDescCurrentNum = tx_idx;
+
+	return num;
+}
+
 /**
  *  @brief Get current rx pkt buf address
  *
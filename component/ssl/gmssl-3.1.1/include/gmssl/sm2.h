@@ -140,6 +140,28 @@ int sm2_fast_sign(const sm2_z256_t fast_private, SM2_SIGN_PRE_COMP *pre_comp,
 int sm2_fast_verify(const SM2_Z256_POINT point_table[16],
 	const uint8_t dgst[32], const SM2_SIGNATURE *sig);
 
+// verify with a long-lived public key, about 33KB, build once and share between verifications
+typedef struct {
+	SM2_Z256_POINT public_key;
+	SM2_Z256_FIXED_POINT_TABLE public_point_table;
+} SM2_VERIFY_PRE_COMP;
+
+int sm2_verify_pre_compute(SM2_VERIFY_PRE_COMP *pre_comp, const SM2_KEY *key);
+int sm2_do_verify_ex(const SM2_VERIFY_PRE_COMP *pre_comp, const uint8_t dgst[32], const SM2_SIGNATURE *sig);
+
+typedef struct {
+	const SM2_KEY *key;
+	const SM2_VERIFY_PRE_COMP *pre_comp; // optional, used instead of key
+	const uint8_t *dgst;
+	const SM2_SIGNATURE *sig;
+} SM2_VERIFY_BATCH_ITEM;
+
+/*
+return 1 if all signatures are valid, 0 if any is not, -1 on error
+results[i] = 1 or 0 for each item, items with the same key in a row share one point table
+*/
+int sm2_do_verify_batch(const SM2_VERIFY_BATCH_ITEM *items, size_t num, int *results);
+
 
 #define SM2_MIN_SIGNATURE_SIZE 8
 #define SM2_MAX_SIGNATURE_SIZE 72
@@ -148,6 +170,7 @@ int sm2_signature_from_der(SM2_SIGNATURE *sig, const uint8_t **in, size_t *inlen
 int sm2_signature_print(FILE *fp, int fmt, int ind, const char *label, const uint8_t *sig, size_t siglen);
 int sm2_sign(const SM2_KEY *key, const uint8_t dgst[32], uint8_t *sig, size_t *siglen);
 int sm2_verify(const SM2_KEY *key, const uint8_t dgst[32], const uint8_t *sig, size_t siglen);
+int sm2_verify_ex(const SM2_VERIFY_PRE_COMP *pre_comp, const uint8_t dgst[32], const uint8_t *sig, size_t siglen);
 
 enum {
 	SM2_signature_compact_size = 70,
@@ -191,9 +214,12 @@ typedef struct {
 	SM3_CTX saved_sm3_ctx;
 	SM2_KEY key;
 	SM2_Z256_POINT public_point_table[16];
+	const SM2_VERIFY_PRE_COMP *pre_comp;
 } SM2_VERIFY_CTX;
 
 int sm2_verify_init(SM2_VERIFY_CTX *ctx, const SM2_KEY *key, const char *id, size_t idlen);
+// pre_comp must outlive ctx
+int sm2_verify_init_ex(SM2_VERIFY_CTX *ctx, const SM2_VERIFY_PRE_COMP *pre_comp, const char *id, size_t idlen);
 int sm2_verify_update(SM2_VERIFY_CTX *ctx, const uint8_t *data, size_t datalen);
 int sm2_verify_finish(SM2_VERIFY_CTX *ctx, const uint8_t *sig, size_t siglen);
 int sm2_verify_reset(SM2_VERIFY_CTX *ctx);
@@ -116,6 +116,15 @@ void sm2_z256_point_mul_ex(SM2_Z256_POINT *R, const sm2_z256_t k, const SM2_Z256
 void sm2_z256_point_mul(SM2_Z256_POINT *R, const sm2_z256_t k, const SM2_Z256_POINT *P);
 void sm2_z256_point_mul_sum(SM2_Z256_POINT *R, const sm2_z256_t t, const SM2_Z256_POINT *P, const sm2_z256_t s);
 
+// k * P for a long-lived P, T[i][j] = (j + 1) * 16^i * P, 4-bit booth windows need 65 rows
+#define SM2_Z256_FIXED_POINT_ROWS 65
+typedef struct {
+	SM2_Z256_AFFINE_POINT T[SM2_Z256_FIXED_POINT_ROWS][8];
+} SM2_Z256_FIXED_POINT_TABLE;
+
+void sm2_z256_point_mul_fixed_pre_compute(const SM2_Z256_POINT *P, SM2_Z256_FIXED_POINT_TABLE *table);
+void sm2_z256_point_mul_fixed(SM2_Z256_POINT *R, const sm2_z256_t k, const SM2_Z256_FIXED_POINT_TABLE *table);
+
 
 const uint64_t *sm2_z256_prime(void);
 const uint64_t *sm2_z256_order(void);
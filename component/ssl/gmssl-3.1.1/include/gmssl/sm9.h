@@ -118,6 +118,16 @@ typedef struct {
 int sm9_do_sign(const SM9_SIGN_KEY *key, const SM3_CTX *sm3_ctx, SM9_SIGNATURE *sig);
 int sm9_do_verify(const SM9_SIGN_MASTER_KEY *mpk, const char *id, size_t idlen, const SM3_CTX *sm3_ctx, const SM9_SIGNATURE *sig);
 
+// g = e(P1, Ppubs) of a master public key as a fixed-base table, for signing and verifying under this Ppubs
+typedef struct {
+	sm9_z256_fp12_t g_table[SM9_Z256_FP12_POW_TABLE_SIZE];
+} SM9_SIGN_PRE_COMP;
+
+int sm9_sign_pre_compute(SM9_SIGN_PRE_COMP *pre_comp, const SM9_Z256_TWIST_POINT *Ppubs);
+int sm9_do_sign_ex(const SM9_SIGN_KEY *key, const SM9_SIGN_PRE_COMP *pre_comp, const SM3_CTX *sm3_ctx, SM9_SIGNATURE *sig);
+int sm9_do_verify_ex(const SM9_SIGN_MASTER_KEY *mpk, const SM9_SIGN_PRE_COMP *pre_comp,
+	const char *id, size_t idlen, const SM3_CTX *sm3_ctx, const SM9_SIGNATURE *sig);
+
 #define SM9_SIGNATURE_SIZE 104
 int sm9_signature_to_der(const SM9_SIGNATURE *sig, uint8_t **out, size_t *outlen);
 int sm9_signature_from_der(SM9_SIGNATURE *sig, const uint8_t **in, size_t *inlen);
@@ -134,6 +144,10 @@ int sm9_verify_init(SM9_SIGN_CTX *ctx);
 int sm9_verify_update(SM9_SIGN_CTX *ctx, const uint8_t *data, size_t datalen);
 int sm9_verify_finish(SM9_SIGN_CTX *ctx, const uint8_t *sig, size_t siglen,
 	const SM9_SIGN_MASTER_KEY *mpk, const char *id, size_t idlen);
+int sm9_sign_finish_ex(SM9_SIGN_CTX *ctx, const SM9_SIGN_KEY *key, const SM9_SIGN_PRE_COMP *pre_comp,
+	uint8_t *sig, size_t *siglen);
+int sm9_verify_finish_ex(SM9_SIGN_CTX *ctx, const uint8_t *sig, size_t siglen,
+	const SM9_SIGN_MASTER_KEY *mpk, const SM9_SIGN_PRE_COMP *pre_comp, const char *id, size_t idlen);
 
 
 
@@ -222,6 +236,32 @@ int sm9_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 int sm9_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen,
 	const uint8_t *in, size_t inlen, uint8_t *out, size_t *outlen);
 
+// g = e(Ppube, P2) of a master public key as a fixed-base table, for encryption and key exchange
+typedef struct {
+	sm9_z256_fp12_t g_table[SM9_Z256_FP12_POW_TABLE_SIZE];
+} SM9_ENC_PRE_COMP;
+
+// Miller loop lines of the private key de, for decryption and key exchange
+typedef struct {
+	SM9_Z256_PAIRING_LINES de_lines;
+} SM9_ENC_KEY_PRE_COMP;
+
+int sm9_enc_pre_compute(SM9_ENC_PRE_COMP *pre_comp, const SM9_Z256_POINT *Ppube);
+int sm9_enc_key_pre_compute(SM9_ENC_KEY_PRE_COMP *pre_comp, const SM9_ENC_KEY *key);
+
+int sm9_kem_encrypt_ex(const SM9_ENC_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *pre_comp,
+	const char *id, size_t idlen, size_t klen, uint8_t *kbuf, SM9_Z256_POINT *C);
+int sm9_kem_decrypt_ex(const SM9_ENC_KEY *key, const SM9_ENC_KEY_PRE_COMP *pre_comp,
+	const char *id, size_t idlen, const SM9_Z256_POINT *C, size_t klen, uint8_t *kbuf);
+int sm9_do_encrypt_ex(const SM9_ENC_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const uint8_t *in, size_t inlen, SM9_Z256_POINT *C1, uint8_t *c2, uint8_t c3[SM3_HMAC_SIZE]);
+int sm9_do_decrypt_ex(const SM9_ENC_KEY *key, const SM9_ENC_KEY_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const SM9_Z256_POINT *C1, const uint8_t *c2, size_t c2len, const uint8_t c3[SM3_HMAC_SIZE], uint8_t *out);
+int sm9_encrypt_ex(const SM9_ENC_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const uint8_t *in, size_t inlen, uint8_t *out, size_t *outlen);
+int sm9_decrypt_ex(const SM9_ENC_KEY *key, const SM9_ENC_KEY_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const uint8_t *in, size_t inlen, uint8_t *out, size_t *outlen);
+
 
 // SM9 Key Exchange (To be continued)
 #define SM9_EXCH_MASTER_KEY SM9_ENC_MASTER_KEY
@@ -236,6 +276,15 @@ int sm9_exch_step_2A(const SM9_EXCH_MASTER_KEY *mpk, const char *idA, size_t idA
 	const SM9_EXCH_KEY *key, const sm9_z256_t rA, const SM9_Z256_POINT *RA, const SM9_Z256_POINT *RB, uint8_t *sk, size_t klen);
 int sm9_exch_step_2B();
 
+int sm9_exch_step_1B_ex(const SM9_EXCH_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *mpk_pre_comp,
+	const char *idA, size_t idAlen, const char *idB, size_t idBlen,
+	const SM9_EXCH_KEY *key, const SM9_ENC_KEY_PRE_COMP *key_pre_comp,
+	const SM9_Z256_POINT *RA, SM9_Z256_POINT *RB, uint8_t *sk, size_t klen);
+int sm9_exch_step_2A_ex(const SM9_EXCH_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *mpk_pre_comp,
+	const char *idA, size_t idAlen, const char *idB, size_t idBlen,
+	const SM9_EXCH_KEY *key, const SM9_ENC_KEY_PRE_COMP *key_pre_comp,
+	const sm9_z256_t rA, const SM9_Z256_POINT *RA, const SM9_Z256_POINT *RB, uint8_t *sk, size_t klen);
+
 
 #ifdef  __cplusplus
 }
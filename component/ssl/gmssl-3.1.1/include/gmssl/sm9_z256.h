@@ -153,6 +153,11 @@ void sm9_z256_fp12_mul(sm9_z256_fp12_t r, const sm9_z256_fp12_t a, const sm9_z25
 void sm9_z256_fp12_sqr(sm9_z256_fp12_t r, const sm9_z256_fp12_t a);
 void sm9_z256_fp12_inv(sm9_z256_fp12_t r, const sm9_z256_fp12_t a);
 void sm9_z256_fp12_pow(sm9_z256_fp12_t r, const sm9_z256_fp12_t a, const sm9_z256_t k);
+
+// fixed-base exponentiation, table[i] = a^(16^i)
+#define SM9_Z256_FP12_POW_TABLE_SIZE 64
+void sm9_z256_fp12_pow_pre_compute(sm9_z256_fp12_t table[SM9_Z256_FP12_POW_TABLE_SIZE], const sm9_z256_fp12_t a);
+void sm9_z256_fp12_pow_table(sm9_z256_fp12_t r, const sm9_z256_fp12_t table[SM9_Z256_FP12_POW_TABLE_SIZE], const sm9_z256_t k);
 void sm9_z256_fp12_frobenius(sm9_z256_fp12_t r, const sm9_z256_fp12_t x);
 void sm9_z256_fp12_frobenius2(sm9_z256_fp12_t r, const sm9_z256_fp12_t x);
 void sm9_z256_fp12_frobenius3(sm9_z256_fp12_t r, const sm9_z256_fp12_t x);
@@ -240,6 +245,16 @@ void sm9_z256_final_exponent_hard_part(sm9_z256_fp12_t r, const sm9_z256_fp12_t
 void sm9_z256_final_exponent(sm9_z256_fp12_t r, const sm9_z256_fp12_t f);
 void sm9_z256_pairing(sm9_z256_fp12_t r, const SM9_Z256_TWIST_POINT *Q, const SM9_Z256_POINT *P);
 
+// Miller loop lines of a fixed Q, 65 tangents, 10 additions and 2 Frobenius lines
+#define SM9_Z256_PAIRING_LINES_NUM 77
+
+typedef struct {
+	sm9_z256_fp2_t lw[SM9_Z256_PAIRING_LINES_NUM][3];
+} SM9_Z256_PAIRING_LINES;
+
+void sm9_z256_pairing_lines_pre_compute(SM9_Z256_PAIRING_LINES *lines, const SM9_Z256_TWIST_POINT *Q);
+void sm9_z256_pairing_with_lines(sm9_z256_fp12_t r, const SM9_Z256_PAIRING_LINES *lines, const SM9_Z256_POINT *P);
+
 
 #ifdef  __cplusplus
 }
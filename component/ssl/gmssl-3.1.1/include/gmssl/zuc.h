@@ -41,6 +41,24 @@ void zuc_generate_keystream(ZUC_STATE *state, size_t nwords, ZUC_UINT32 *words);
 ZUC_UINT32 zuc_generate_keyword(ZUC_STATE *state);
 void zuc_encrypt(ZUC_STATE *state, const uint8_t *in, size_t inlen, uint8_t *out);
 
+/*
+ * Independent ZUC or ZUC-256 keystreams generated side by side, one lane per stream. The
+ * state is laid out lane by lane for each LFSR cell, 4, 8 or 16 lanes fill SIMD registers.
+ * Each lane starts from a state set by zuc_init() or zuc256_init().
+ */
+# define ZUC_MULTI_MAX_LANES	16
+
+typedef struct {
+	ZUC_UINT31 LFSR[16][ZUC_MULTI_MAX_LANES];
+	ZUC_UINT32 R1[ZUC_MULTI_MAX_LANES];
+	ZUC_UINT32 R2[ZUC_MULTI_MAX_LANES];
+	size_t lanes;
+	size_t pos; // LFSR[(pos + i) % 16] is s_i
+} ZUC_MULTI_STATE;
+
+int zuc_multi_init(ZUC_MULTI_STATE *state, const ZUC_STATE *lanes, size_t nlanes);
+void zuc_multi_generate_keystream(ZUC_MULTI_STATE *state, size_t nwords, ZUC_UINT32 *keystream[]);
+
 typedef struct ZUC_MAC_CTX_st {
 	ZUC_UINT31 LFSR[16];
 	ZUC_UINT32 R1;
@@ -205,6 +205,41 @@ int sm2_fast_sign(const sm2_z256_t fast_private, SM2_SIGN_PRE_COMP *pre_comp,
 	return 1;
 }
 
+/*
+check r == e + x (mod n) for R = (X : Y : Z) without the inversion of Z,
+x = X/Z^2 is in [0, p), so x is either r - e or r - e + n (only if < p)
+*/
+static int sm2_verify_check_point(const SM2_Z256_POINT *R, const sm2_z256_t e, const sm2_z256_t r)
+{
+	sm2_z256_t x;
+	sm2_z256_t z2;
+	sm2_z256_t t;
+
+	if (sm2_z256_is_zero(R->Z)) {
+		return 0;
+	}
+	sm2_z256_modp_mont_sqr(z2, R->Z);
+
+	// x = r - e (mod n)
+	sm2_z256_modn_sub(x, r, e);
+	sm2_z256_modp_to_mont(x, t);
+	sm2_z256_modp_mont_mul(t, t, z2);
+	if (sm2_z256_equ(t, R->X)) {
+		return 1;
+	}
+
+	// x = r - e + n
+	if (sm2_z256_add(x, x, sm2_z256_order()) == 0
+		&& sm2_z256_cmp(x, sm2_z256_prime()) < 0) {
+		sm2_z256_modp_to_mont(x, t);
+		sm2_z256_modp_mont_mul(t, t, z2);
+		if (sm2_z256_equ(t, R->X)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
 int sm2_fast_verify(const SM2_Z256_POINT point_table[16], const uint8_t dgst[32], const SM2_SIGNATURE *sig)
 {
 	SM2_Z256_POINT R;
@@ -212,7 +247,6 @@ int sm2_fast_verify(const SM2_Z256_POINT point_table[16], const uint8_t dgst[32]
 	sm2_z256_t r;
 	sm2_z256_t s;
 	sm2_z256_t e;
-	sm2_z256_t x;
 	sm2_z256_t t;
 
 	// check r, s in [1, n-1]
@@ -246,7 +280,6 @@ int sm2_fast_verify(const SM2_Z256_POINT point_table[16], const uint8_t dgst[32]
 	sm2_z256_point_mul_generator(&R, s);
 	sm2_z256_point_mul_ex(&T, t, point_table);
 	sm2_z256_point_add(&R, &R, &T);
-	sm2_z256_point_get_xy(&R, x, NULL);
 
 	// e = H(M)
 	sm2_z256_from_bytes(e, dgst);
@@ -254,14 +287,8 @@ int sm2_fast_verify(const SM2_Z256_POINT point_table[16], const uint8_t dgst[32]
 		sm2_z256_sub(e, e, sm2_z256_order());
 	}
 
-	// r' = e + x (mod n)
-	if (sm2_z256_cmp(x, sm2_z256_order()) >= 0) {
-		sm2_z256_sub(x, x, sm2_z256_order());
-	}
-	sm2_z256_modn_add(e, e, x);
-
-	// check if r == r'
-	if (sm2_z256_cmp(e, r) != 0) {
+	// check if r == e + x (mod n)
+	if (sm2_verify_check_point(&R, e, r) != 1) {
 		error_print();
 		return -1;
 	}
@@ -275,7 +302,6 @@ int sm2_do_verify(const SM2_KEY *key, const uint8_t dgst[32], const SM2_SIGNATUR
 	sm2_z256_t r;
 	sm2_z256_t s;
 	sm2_z256_t e;
-	sm2_z256_t x;
 	sm2_z256_t t;
 
 	// check r, s in [1, n-1]
@@ -309,7 +335,6 @@ int sm2_do_verify(const SM2_KEY *key, const uint8_t dgst[32], const SM2_SIGNATUR
 	sm2_z256_point_mul_generator(&R, s);
 	sm2_z256_point_mul(&T, t, &key->public_key);
 	sm2_z256_point_add(&R, &R, &T);
-	sm2_z256_point_get_xy(&R, x, NULL);
 
 	// e = H(M)
 	sm2_z256_from_bytes(e, dgst);
@@ -317,20 +342,138 @@ int sm2_do_verify(const SM2_KEY *key, const uint8_t dgst[32], const SM2_SIGNATUR
 		sm2_z256_sub(e, e, sm2_z256_order());
 	}
 
-	// r' = e + x (mod n)
-	if (sm2_z256_cmp(x, sm2_z256_order()) >= 0) {
-		sm2_z256_sub(x, x, sm2_z256_order());
+	// check if r == e + x (mod n)
+	if (sm2_verify_check_point(&R, e, r) != 1) {
+		error_print();
+		return -1;
 	}
-	sm2_z256_modn_add(e, e, x);
+	return 1;
+}
 
-	// check if r == r'
-	if (sm2_z256_cmp(e, r) != 0) {
+int sm2_verify_pre_compute(SM2_VERIFY_PRE_COMP *pre_comp, const SM2_KEY *key)
+{
+	if (!pre_comp || !key) {
 		error_print();
 		return -1;
 	}
+	if (sm2_z256_is_zero(key->public_key.Z)) {
+		error_print();
+		return -1;
+	}
+	pre_comp->public_key = key->public_key;
+	sm2_z256_point_mul_fixed_pre_compute(&key->public_key, &pre_comp->public_point_table);
 	return 1;
 }
 
+// r, s in [1, n-1], t = r + s (mod n) != 0, e = H(M) (mod n)
+static int sm2_verify_get_scalars(const uint8_t dgst[32], const SM2_SIGNATURE *sig,
+	sm2_z256_t e, sm2_z256_t r, sm2_z256_t s, sm2_z256_t t)
+{
+	sm2_z256_from_bytes(r, sig->r);
+	if (sm2_z256_is_zero(r) == 1 || sm2_z256_cmp(r, sm2_z256_order()) >= 0) {
+		return 0;
+	}
+	sm2_z256_from_bytes(s, sig->s);
+	if (sm2_z256_is_zero(s) == 1 || sm2_z256_cmp(s, sm2_z256_order()) >= 0) {
+		return 0;
+	}
+	sm2_z256_modn_add(t, r, s);
+	if (sm2_z256_is_zero(t)) {
+		return 0;
+	}
+	sm2_z256_from_bytes(e, dgst);
+	if (sm2_z256_cmp(e, sm2_z256_order()) >= 0) {
+		sm2_z256_sub(e, e, sm2_z256_order());
+	}
+	return 1;
+}
+
+int sm2_do_verify_ex(const SM2_VERIFY_PRE_COMP *pre_comp, const uint8_t dgst[32], const SM2_SIGNATURE *sig)
+{
+	SM2_Z256_POINT R;
+	SM2_Z256_POINT T;
+	sm2_z256_t r;
+	sm2_z256_t s;
+	sm2_z256_t e;
+	sm2_z256_t t;
+
+	if (sm2_verify_get_scalars(dgst, sig, e, r, s, t) != 1) {
+		error_print();
+		return -1;
+	}
+
+	// Q(x,y) = s * G + t * P
+	sm2_z256_point_mul_generator(&R, s);
+	sm2_z256_point_mul_fixed(&T, t, &pre_comp->public_point_table);
+	sm2_z256_point_add(&R, &R, &T);
+
+	if (sm2_verify_check_point(&R, e, r) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+/*
+SM2 signatures keep only x of the point s * G + t * P, not its y, so a random linear combination
+of the verification equations can not be checked without guessing the sign of every point.
+Every item is verified on its own, items with the same key in a row share one point table
+*/
+int sm2_do_verify_batch(const SM2_VERIFY_BATCH_ITEM *items, size_t num, int *results)
+{
+	SM2_Z256_POINT point_table[16];
+	const SM2_Z256_POINT *table_key = NULL;
+	SM2_Z256_POINT R;
+	SM2_Z256_POINT T;
+	sm2_z256_t r;
+	sm2_z256_t s;
+	sm2_z256_t e;
+	sm2_z256_t t;
+	int ret = 1;
+	size_t i;
+
+	if (!items || !results) {
+		error_print();
+		return -1;
+	}
+	for (i = 0; i < num; i++) {
+		if ((!items[i].key && !items[i].pre_comp) || !items[i].dgst || !items[i].sig) {
+			error_print();
+			return -1;
+		}
+	}
+
+	for (i = 0; i < num; i++) {
+		const SM2_VERIFY_BATCH_ITEM *item = &items[i];
+
+		results[i] = 0;
+		if (sm2_verify_get_scalars(item->dgst, item->sig, e, r, s, t) != 1) {
+			ret = 0;
+			continue;
+		}
+
+		sm2_z256_point_mul_generator(&R, s);
+		if (item->pre_comp) {
+			sm2_z256_point_mul_fixed(&T, t, &item->pre_comp->public_point_table);
+		} else {
+			if (!table_key || memcmp(table_key, &item->key->public_key, sizeof(SM2_Z256_POINT)) != 0) {
+				sm2_z256_point_mul_pre_compute(&item->key->public_key, point_table);
+				table_key = &item->key->public_key;
+			}
+			sm2_z256_point_mul_ex(&T, t, point_table);
+		}
+		sm2_z256_point_add(&R, &R, &T);
+
+		if (sm2_verify_check_point(&R, e, r) != 1) {
+			ret = 0;
+			continue;
+		}
+		results[i] = 1;
+	}
+
+	return ret;
+}
+
 int sm2_signature_to_der(const SM2_SIGNATURE *sig, uint8_t **out, size_t *outlen)
 {
 	size_t len = 0;
@@ -466,6 +609,27 @@ int sm2_verify(const SM2_KEY *key, const uint8_t dgst[32], const uint8_t *sigbuf
 	return 1;
 }
 
+int sm2_verify_ex(const SM2_VERIFY_PRE_COMP *pre_comp, const uint8_t dgst[32], const uint8_t *sigbuf, size_t siglen)
+{
+	SM2_SIGNATURE sig;
+
+	if (!pre_comp || !dgst || !sigbuf || !siglen) {
+		error_print();
+		return -1;
+	}
+
+	if (sm2_signature_from_der(&sig, &sigbuf, &siglen) != 1
+		|| asn1_length_is_zero(siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	if (sm2_do_verify_ex(pre_comp, dgst, &sig) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
 int sm2_compute_z(uint8_t z[32], const SM2_Z256_POINT *pub, const char *id, size_t idlen)
 {
 	SM3_CTX ctx;
@@ -633,6 +797,38 @@ int sm2_verify_init(SM2_VERIFY_CTX *ctx, const SM2_KEY *key, const char *id, siz
 	}
 
 	sm2_z256_point_mul_pre_compute(&key->public_key, ctx->public_point_table);
+	ctx->pre_comp = NULL;
+
+	return 1;
+}
+
+int sm2_verify_init_ex(SM2_VERIFY_CTX *ctx, const SM2_VERIFY_PRE_COMP *pre_comp, const char *id, size_t idlen)
+{
+	if (!ctx || !pre_comp) {
+		error_print();
+		return -1;
+	}
+
+	sm3_init(&ctx->sm3_ctx);
+	if (id) {
+		uint8_t z[SM3_DIGEST_SIZE];
+
+		if (idlen <= 0 || idlen > SM2_MAX_ID_LENGTH) {
+			error_print();
+			return -1;
+		}
+		sm2_compute_z(z, &pre_comp->public_key, id, idlen);
+		sm3_update(&ctx->sm3_ctx, z, sizeof(z));
+	}
+	ctx->saved_sm3_ctx = ctx->sm3_ctx;
+
+	if (sm2_key_set_public_key(&ctx->key, &pre_comp->public_key) != 1) {
+		error_print();
+		return -1;
+	}
+
+	// the fixed point table of pre_comp replaces public_point_table
+	ctx->pre_comp = pre_comp;
 
 	return 1;
 }
@@ -667,7 +863,12 @@ int sm2_verify_finish(SM2_VERIFY_CTX *ctx, const uint8_t *sigbuf, size_t siglen)
 
 	sm3_finish(&ctx->sm3_ctx, dgst);
 
-	if (sm2_fast_verify(ctx->public_point_table, dgst, &sig) != 1) {
+	if (ctx->pre_comp) {
+		if (sm2_do_verify_ex(ctx->pre_comp, dgst, &sig) != 1) {
+			error_print();
+			return -1;
+		}
+	} else if (sm2_fast_verify(ctx->public_point_table, dgst, &sig) != 1) {
 		error_print();
 		return -1;
 	}
@@ -1625,6 +1625,93 @@ void sm2_z256_point_mul_sum(SM2_Z256_POINT *R, const uint64_t t[4], const SM2_Z2
 	sm2_z256_point_add(R, R, &Q);
 }
 
+// rows converted to affine with one inversion, 65 = 13 * 5
+#define SM2_Z256_FIXED_POINT_GROUP_ROWS 5
+
+void sm2_z256_point_mul_fixed_pre_compute(const SM2_Z256_POINT *P, SM2_Z256_FIXED_POINT_TABLE *table)
+{
+	SM2_Z256_POINT B = *P;
+	SM2_Z256_POINT Q[8];
+	sm2_z256_t Z[SM2_Z256_FIXED_POINT_GROUP_ROWS * 8];
+	sm2_z256_t f[SM2_Z256_FIXED_POINT_GROUP_ROWS * 8];
+	sm2_z256_t z_inv;
+	sm2_z256_t t;
+	SM2_Z256_AFFINE_POINT *A;
+	int g, i, j, n;
+
+	for (g = 0; g < SM2_Z256_FIXED_POINT_ROWS; g += SM2_Z256_FIXED_POINT_GROUP_ROWS) {
+		A = &table->T[g][0];
+
+		// Jacobian (X, Y) written to the table, Z kept aside
+		for (i = 0; i < SM2_Z256_FIXED_POINT_GROUP_ROWS; i++) {
+			Q[0] = B;
+			sm2_z256_point_dbl(&Q[1], &B);
+			for (j = 2; j < 8; j++) {
+				sm2_z256_point_add(&Q[j], &Q[j - 1], &B);
+			}
+			sm2_z256_point_dbl(&B, &Q[7]);
+
+			for (j = 0; j < 8; j++) {
+				sm2_z256_copy(A[i * 8 + j].x, Q[j].X);
+				sm2_z256_copy(A[i * 8 + j].y, Q[j].Y);
+				sm2_z256_copy(Z[i * 8 + j], Q[j].Z);
+			}
+		}
+
+		// Montgomery's Trick, f[i] = Z[0] * ... * Z[i]
+		n = SM2_Z256_FIXED_POINT_GROUP_ROWS * 8;
+		sm2_z256_copy(f[0], Z[0]);
+		for (i = 1; i < n; i++) {
+			sm2_z256_modp_mont_mul(f[i], f[i - 1], Z[i]);
+		}
+		sm2_z256_modp_mont_inv(t, f[n - 1]);
+
+		// t = (Z[0] * ... * Z[i])^-1, Z[i]^-1 = t * f[i - 1]
+		for (i = n - 1; i >= 0; i--) {
+			if (i > 0) {
+				sm2_z256_modp_mont_mul(z_inv, t, f[i - 1]);
+				sm2_z256_modp_mont_mul(t, t, Z[i]);
+			} else {
+				sm2_z256_copy(z_inv, t);
+			}
+
+			// x = X * Z^-2, y = Y * Z^-3
+			sm2_z256_modp_mont_sqr(f[i], z_inv);
+			sm2_z256_modp_mont_mul(A[i].x, A[i].x, f[i]);
+			sm2_z256_modp_mont_mul(f[i], f[i], z_inv);
+			sm2_z256_modp_mont_mul(A[i].y, A[i].y, f[i]);
+		}
+	}
+}
+
+void sm2_z256_point_mul_fixed(SM2_Z256_POINT *R, const sm2_z256_t k, const SM2_Z256_FIXED_POINT_TABLE *table)
+{
+	size_t window_size = 4;
+	int R_infinity = 1;
+	int i;
+
+	for (i = SM2_Z256_FIXED_POINT_ROWS - 1; i >= 0; i--) {
+		int booth = sm2_z256_get_booth(k, window_size, i);
+
+		if (R_infinity) {
+			if (booth != 0) {
+				sm2_z256_point_copy_affine(R, &table->T[i][booth - 1]);
+				R_infinity = 0;
+			}
+		} else {
+			if (booth > 0) {
+				sm2_z256_point_add_affine(R, R, &table->T[i][booth - 1]);
+			} else if (booth < 0) {
+				sm2_z256_point_sub_affine(R, R, &table->T[i][-booth - 1]);
+			}
+		}
+	}
+
+	if (R_infinity) {
+		sm2_z256_point_set_infinity(R);
+	}
+}
+
 // point_at_infinity can not be encoded/decoded to/from bytes
 int sm2_z256_point_from_bytes(SM2_Z256_POINT *P, const uint8_t in[64])
 {
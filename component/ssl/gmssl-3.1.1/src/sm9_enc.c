@@ -19,19 +19,49 @@
 #include <gmssl/error.h>
 
 
+int sm9_enc_pre_compute(SM9_ENC_PRE_COMP *pre_comp, const SM9_Z256_POINT *Ppube)
+{
+	sm9_z256_fp12_t g;
+
+	// g = e(Ppube, P2)
+	sm9_z256_pairing(g, sm9_z256_twist_generator(), Ppube);
+	sm9_z256_fp12_pow_pre_compute(pre_comp->g_table, g);
+	return 1;
+}
+
+int sm9_enc_key_pre_compute(SM9_ENC_KEY_PRE_COMP *pre_comp, const SM9_ENC_KEY *key)
+{
+	sm9_z256_pairing_lines_pre_compute(&pre_comp->de_lines, &key->de);
+	return 1;
+}
+
 int sm9_kem_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 	size_t klen, uint8_t *kbuf, SM9_Z256_POINT *C)
+{
+	return sm9_kem_encrypt_ex(mpk, NULL, id, idlen, klen, kbuf, C);
+}
+
+// pre_comp must be computed from mpk->Ppube, or NULL
+int sm9_kem_encrypt_ex(const SM9_ENC_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *pre_comp,
+	const char *id, size_t idlen, size_t klen, uint8_t *kbuf, SM9_Z256_POINT *C)
 {
 	sm9_z256_t r;
+	sm9_z256_fp12_t g;
 	sm9_z256_fp12_t w;
+	SM9_Z256_POINT Q;
 	uint8_t wbuf[32 * 12];
 	uint8_t cbuf[65];
 	SM3_KDF_CTX kdf_ctx;
 
 	// A1: Q = H1(ID||hid,N) * P1 + Ppube
 	sm9_z256_hash1(r, id, idlen, SM9_HID_ENC);
-	sm9_z256_point_mul(C, r, sm9_z256_generator());
-	sm9_z256_point_add(C, C, &mpk->Ppube);
+	sm9_z256_point_mul(&Q, r, sm9_z256_generator());
+	sm9_z256_point_add(&Q, &Q, &mpk->Ppube);
+
+	// A4: g = e(Ppube, P2)
+	if (!pre_comp) {
+		sm9_z256_pairing(g, sm9_z256_twist_generator(), &mpk->Ppube);
+	}
 
 	do {
 		// A2: rand r in [1, N-1]
@@ -41,14 +71,15 @@ int sm9_kem_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 		}
 
 		// A3: C1 = r * Q
-		sm9_z256_point_mul(C, r, C);
+		sm9_z256_point_mul(C, r, &Q);
 		sm9_z256_point_to_uncompressed_octets(C, cbuf);
 
-		// A4: g = e(Ppube, P2)
-		sm9_z256_pairing(w, sm9_z256_twist_generator(), &mpk->Ppube);
-
 		// A5: w = g^r
-		sm9_z256_fp12_pow(w, w, r);
+		if (pre_comp) {
+			sm9_z256_fp12_pow_table(w, pre_comp->g_table, r);
+		} else {
+			sm9_z256_fp12_pow(w, g, r);
+		}
 		sm9_z256_fp12_to_bytes(w, wbuf);
 
 		// A6: K = KDF(C || w || ID_B, klen), if K == 0, goto A2
@@ -71,6 +102,13 @@ int sm9_kem_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 
 int sm9_kem_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen, const SM9_Z256_POINT *C,
 	size_t klen, uint8_t *kbuf)
+{
+	return sm9_kem_decrypt_ex(key, NULL, id, idlen, C, klen, kbuf);
+}
+
+// pre_comp must be computed from key, or NULL
+int sm9_kem_decrypt_ex(const SM9_ENC_KEY *key, const SM9_ENC_KEY_PRE_COMP *pre_comp,
+	const char *id, size_t idlen, const SM9_Z256_POINT *C, size_t klen, uint8_t *kbuf)
 {
 	sm9_z256_fp12_t w;
 	uint8_t wbuf[32 * 12];
@@ -81,7 +119,11 @@ int sm9_kem_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen, const
 	sm9_z256_point_to_uncompressed_octets(C, cbuf);
 
 	// B2: w = e(C, de);
-	sm9_z256_pairing(w, &key->de, C);
+	if (pre_comp) {
+		sm9_z256_pairing_with_lines(w, &pre_comp->de_lines, C);
+	} else {
+		sm9_z256_pairing(w, &key->de, C);
+	}
 	sm9_z256_fp12_to_bytes(w, wbuf);
 
 	// B3: K = KDF(C || w || ID, klen)
@@ -107,11 +149,17 @@ int sm9_kem_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen, const
 int sm9_do_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 	const uint8_t *in, size_t inlen,
 	SM9_Z256_POINT *C1, uint8_t *c2, uint8_t c3[SM3_HMAC_SIZE])
+{
+	return sm9_do_encrypt_ex(mpk, NULL, id, idlen, in, inlen, C1, c2, c3);
+}
+
+int sm9_do_encrypt_ex(const SM9_ENC_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const uint8_t *in, size_t inlen, SM9_Z256_POINT *C1, uint8_t *c2, uint8_t c3[SM3_HMAC_SIZE])
 {
 	SM3_HMAC_CTX hmac_ctx;
 	uint8_t K[SM9_MAX_PLAINTEXT_SIZE + 32];
 
-	if (sm9_kem_encrypt(mpk, id, idlen, sizeof(K), K, C1) != 1) {
+	if (sm9_kem_encrypt_ex(mpk, pre_comp, id, idlen, sizeof(K), K, C1) != 1) {
 		error_print();
 		return -1;
 	}
@@ -128,6 +176,12 @@ int sm9_do_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 int sm9_do_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen,
 	const SM9_Z256_POINT *C1, const uint8_t *c2, size_t c2len, const uint8_t c3[SM3_HMAC_SIZE],
 	uint8_t *out)
+{
+	return sm9_do_decrypt_ex(key, NULL, id, idlen, C1, c2, c2len, c3, out);
+}
+
+int sm9_do_decrypt_ex(const SM9_ENC_KEY *key, const SM9_ENC_KEY_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const SM9_Z256_POINT *C1, const uint8_t *c2, size_t c2len, const uint8_t c3[SM3_HMAC_SIZE], uint8_t *out)
 {
 	SM3_HMAC_CTX hmac_ctx;
 	uint8_t k[SM9_MAX_PLAINTEXT_SIZE + SM3_HMAC_SIZE];
@@ -138,7 +192,7 @@ int sm9_do_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen,
 		return -1;
 	}
 
-	if (sm9_kem_decrypt(key, id, idlen, C1, sizeof(k), k) != 1) {
+	if (sm9_kem_decrypt_ex(key, pre_comp, id, idlen, C1, sizeof(k), k) != 1) {
 		error_print();
 		return -1;
 	}
@@ -240,6 +294,12 @@ int sm9_ciphertext_from_der(SM9_Z256_POINT *C1, const uint8_t **c2, size_t *c2le
 
 int sm9_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 	const uint8_t *in, size_t inlen, uint8_t *out, size_t *outlen)
+{
+	return sm9_encrypt_ex(mpk, NULL, id, idlen, in, inlen, out, outlen);
+}
+
+int sm9_encrypt_ex(const SM9_ENC_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const uint8_t *in, size_t inlen, uint8_t *out, size_t *outlen)
 {
 	SM9_Z256_POINT C1;
 	uint8_t c2[SM9_MAX_PLAINTEXT_SIZE];
@@ -250,7 +310,7 @@ int sm9_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 		return -1;
 	}
 
-	if (sm9_do_encrypt(mpk, id, idlen, in, inlen, &C1, c2, c3) != 1) {
+	if (sm9_do_encrypt_ex(mpk, pre_comp, id, idlen, in, inlen, &C1, c2, c3) != 1) {
 		error_print();
 		return -1;
 	}
@@ -264,6 +324,12 @@ int sm9_encrypt(const SM9_ENC_MASTER_KEY *mpk, const char *id, size_t idlen,
 
 int sm9_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen,
 	const uint8_t *in, size_t inlen, uint8_t *out, size_t *outlen)
+{
+	return sm9_decrypt_ex(key, NULL, id, idlen, in, inlen, out, outlen);
+}
+
+int sm9_decrypt_ex(const SM9_ENC_KEY *key, const SM9_ENC_KEY_PRE_COMP *pre_comp, const char *id, size_t idlen,
+	const uint8_t *in, size_t inlen, uint8_t *out, size_t *outlen)
 {
 	SM9_Z256_POINT C1;
 	const uint8_t *c2;
@@ -279,7 +345,7 @@ int sm9_decrypt(const SM9_ENC_KEY *key, const char *id, size_t idlen,
 	if (!out) {
 		return 1;
 	}
-	if (sm9_do_decrypt(key, id, idlen, &C1, c2, c2len, c3, out) != 1) {
+	if (sm9_do_decrypt_ex(key, pre_comp, id, idlen, &C1, c2, c2len, c3, out) != 1) {
 		error_print();
 		return -1;
 	}
@@ -44,6 +44,15 @@ int sm9_exch_step_1A(const SM9_EXCH_MASTER_KEY *mpk, const char *idB, size_t idB
 
 int sm9_exch_step_1B(const SM9_EXCH_MASTER_KEY *mpk, const char *idA, size_t idAlen, const char *idB, size_t idBlen,
 	const SM9_EXCH_KEY *key, const SM9_Z256_POINT *RA, SM9_Z256_POINT *RB, uint8_t *sk, size_t klen)
+{
+	return sm9_exch_step_1B_ex(mpk, NULL, idA, idAlen, idB, idBlen, key, NULL, RA, RB, sk, klen);
+}
+
+// mpk_pre_comp must be computed from mpk->Ppube and key_pre_comp from key, or NULL
+int sm9_exch_step_1B_ex(const SM9_EXCH_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *mpk_pre_comp,
+	const char *idA, size_t idAlen, const char *idB, size_t idBlen,
+	const SM9_EXCH_KEY *key, const SM9_ENC_KEY_PRE_COMP *key_pre_comp,
+	const SM9_Z256_POINT *RA, SM9_Z256_POINT *RB, uint8_t *sk, size_t klen)
 {
 	sm9_z256_t rB;
 	sm9_z256_fp12_t G1, G2, G3;
@@ -74,9 +83,17 @@ int sm9_exch_step_1B(const SM9_EXCH_MASTER_KEY *mpk, const char *idA, size_t idA
 			error_print();
 			return -1;
 		}
-		sm9_z256_pairing(G1, &key->de, RA);
-		sm9_z256_pairing(G2, sm9_z256_twist_generator(), &mpk->Ppube);
-		sm9_z256_fp12_pow(G2, G2, rB);
+		if (key_pre_comp) {
+			sm9_z256_pairing_with_lines(G1, &key_pre_comp->de_lines, RA);
+		} else {
+			sm9_z256_pairing(G1, &key->de, RA);
+		}
+		if (mpk_pre_comp) {
+			sm9_z256_fp12_pow_table(G2, mpk_pre_comp->g_table, rB);
+		} else {
+			sm9_z256_pairing(G2, sm9_z256_twist_generator(), &mpk->Ppube);
+			sm9_z256_fp12_pow(G2, G2, rB);
+		}
 		sm9_z256_fp12_pow(G3, G1, rB);
 
 		sm9_z256_point_to_uncompressed_octets(RA, ta);
@@ -117,6 +134,15 @@ int sm9_exch_step_1B(const SM9_EXCH_MASTER_KEY *mpk, const char *idA, size_t idA
 
 int sm9_exch_step_2A(const SM9_EXCH_MASTER_KEY *mpk, const char *idA, size_t idAlen, const char *idB, size_t idBlen,
 	const SM9_EXCH_KEY *key, const sm9_z256_t rA, const SM9_Z256_POINT *RA, const SM9_Z256_POINT *RB, uint8_t *sk, size_t klen)
+{
+	return sm9_exch_step_2A_ex(mpk, NULL, idA, idAlen, idB, idBlen, key, NULL, rA, RA, RB, sk, klen);
+}
+
+// mpk_pre_comp must be computed from mpk->Ppube and key_pre_comp from key, or NULL
+int sm9_exch_step_2A_ex(const SM9_EXCH_MASTER_KEY *mpk, const SM9_ENC_PRE_COMP *mpk_pre_comp,
+	const char *idA, size_t idAlen, const char *idB, size_t idBlen,
+	const SM9_EXCH_KEY *key, const SM9_ENC_KEY_PRE_COMP *key_pre_comp,
+	const sm9_z256_t rA, const SM9_Z256_POINT *RA, const SM9_Z256_POINT *RB, uint8_t *sk, size_t klen)
 {
 	sm9_z256_t r;
 	sm9_z256_fp12_t G1, G2, G3;
@@ -130,9 +156,17 @@ int sm9_exch_step_2A(const SM9_EXCH_MASTER_KEY *mpk, const char *idA, size_t idA
 			error_print();
 			return -1;
 		}
-		sm9_z256_pairing(G1, sm9_z256_twist_generator(), &mpk->Ppube);
-		sm9_z256_fp12_pow(G1, G1, rA);
-		sm9_z256_pairing(G2, &key->de, RB);
+		if (mpk_pre_comp) {
+			sm9_z256_fp12_pow_table(G1, mpk_pre_comp->g_table, rA);
+		} else {
+			sm9_z256_pairing(G1, sm9_z256_twist_generator(), &mpk->Ppube);
+			sm9_z256_fp12_pow(G1, G1, rA);
+		}
+		if (key_pre_comp) {
+			sm9_z256_pairing_with_lines(G2, &key_pre_comp->de_lines, RB);
+		} else {
+			sm9_z256_pairing(G2, &key->de, RB);
+		}
 		sm9_z256_fp12_pow(G3, G2, rA);
 
 		sm9_z256_point_to_uncompressed_octets(RA, ta);
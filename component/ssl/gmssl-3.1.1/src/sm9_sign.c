@@ -90,10 +90,16 @@ int sm9_sign_update(SM9_SIGN_CTX *ctx, const uint8_t *data, size_t datalen)
 }
 
 int sm9_sign_finish(SM9_SIGN_CTX *ctx, const SM9_SIGN_KEY *key, uint8_t *sig, size_t *siglen)
+{
+	return sm9_sign_finish_ex(ctx, key, NULL, sig, siglen);
+}
+
+int sm9_sign_finish_ex(SM9_SIGN_CTX *ctx, const SM9_SIGN_KEY *key, const SM9_SIGN_PRE_COMP *pre_comp,
+	uint8_t *sig, size_t *siglen)
 {
 	SM9_SIGNATURE signature;
 
-	if (sm9_do_sign(key, &ctx->sm3_ctx, &signature) != 1) {
+	if (sm9_do_sign_ex(key, pre_comp, &ctx->sm3_ctx, &signature) != 1) {
 		error_print();
 		return -1;
 	}
@@ -105,19 +111,38 @@ int sm9_sign_finish(SM9_SIGN_CTX *ctx, const SM9_SIGN_KEY *key, uint8_t *sig, si
 	return 1;
 }
 
+int sm9_sign_pre_compute(SM9_SIGN_PRE_COMP *pre_comp, const SM9_Z256_TWIST_POINT *Ppubs)
+{
+	sm9_z256_fp12_t g;
+
+	// g = e(P1, Ppubs)
+	sm9_z256_pairing(g, Ppubs, sm9_z256_generator());
+	sm9_z256_fp12_pow_pre_compute(pre_comp->g_table, g);
+	return 1;
+}
+
 int sm9_do_sign(const SM9_SIGN_KEY *key, const SM3_CTX *sm3_ctx, SM9_SIGNATURE *sig)
+{
+	return sm9_do_sign_ex(key, NULL, sm3_ctx, sig);
+}
+
+// pre_comp must be computed from key->Ppubs, or NULL
+int sm9_do_sign_ex(const SM9_SIGN_KEY *key, const SM9_SIGN_PRE_COMP *pre_comp, const SM3_CTX *sm3_ctx, SM9_SIGNATURE *sig)
 {
 	sm9_z256_t r;
 	sm9_z256_fp12_t g;
+	sm9_z256_fp12_t w;
 	uint8_t wbuf[32 * 12];
-	SM3_CTX ctx = *sm3_ctx;
+	SM3_CTX ctx;
 	SM3_CTX tmp_ctx;
 	uint8_t ct1[4] = {0,0,0,1};
 	uint8_t ct2[4] = {0,0,0,2};
 	uint8_t Ha[64];
 
 	// A1: g = e(P1, Ppubs)
-	sm9_z256_pairing(g, &key->Ppubs, sm9_z256_generator());
+	if (!pre_comp) {
+		sm9_z256_pairing(g, &key->Ppubs, sm9_z256_generator());
+	}
 
 	do {
 		// A2: rand r in [1, N-1]
@@ -130,10 +155,15 @@ int sm9_do_sign(const SM9_SIGN_KEY *key, const SM3_CTX *sm3_ctx, SM9_SIGNATURE *
 		//sm9_z256_from_hex(r, "00033C8616B06704813203DFD00965022ED15975C662337AED648835DC4B1CBE");
 
 		// A3: w = g^r
-		sm9_z256_fp12_pow(g, g, r);
-		sm9_z256_fp12_to_bytes(g, wbuf);
+		if (pre_comp) {
+			sm9_z256_fp12_pow_table(w, pre_comp->g_table, r);
+		} else {
+			sm9_z256_fp12_pow(w, g, r);
+		}
+		sm9_z256_fp12_to_bytes(w, wbuf);
 
 		// A4: h = H2(M || w, N)
+		ctx = *sm3_ctx;
 		sm3_update(&ctx, wbuf, sizeof(wbuf));
 		tmp_ctx = ctx;
 		sm3_update(&ctx, ct1, sizeof(ct1));
@@ -151,7 +181,7 @@ int sm9_do_sign(const SM9_SIGN_KEY *key, const SM3_CTX *sm3_ctx, SM9_SIGNATURE *
 	sm9_z256_point_mul(&sig->S, r, &key->ds);
 
 	gmssl_secure_clear(&r, sizeof(r));
-	gmssl_secure_clear(&g, sizeof(g));
+	gmssl_secure_clear(&w, sizeof(w));
 	gmssl_secure_clear(wbuf, sizeof(wbuf));
 	gmssl_secure_clear(&tmp_ctx, sizeof(tmp_ctx));
 	gmssl_secure_clear(Ha, sizeof(Ha));
@@ -175,6 +205,12 @@ int sm9_verify_update(SM9_SIGN_CTX *ctx, const uint8_t *data, size_t datalen)
 
 int sm9_verify_finish(SM9_SIGN_CTX *ctx, const uint8_t *sig, size_t siglen,
 	const SM9_SIGN_MASTER_KEY *mpk, const char *id, size_t idlen)
+{
+	return sm9_verify_finish_ex(ctx, sig, siglen, mpk, NULL, id, idlen);
+}
+
+int sm9_verify_finish_ex(SM9_SIGN_CTX *ctx, const uint8_t *sig, size_t siglen,
+	const SM9_SIGN_MASTER_KEY *mpk, const SM9_SIGN_PRE_COMP *pre_comp, const char *id, size_t idlen)
 {
 	int ret;
 	SM9_SIGNATURE signature;
@@ -185,7 +221,7 @@ int sm9_verify_finish(SM9_SIGN_CTX *ctx, const uint8_t *sig, size_t siglen,
 		return -1;
 	}
 
-	if ((ret = sm9_do_verify(mpk, id, idlen, &ctx->sm3_ctx, &signature)) < 0) {
+	if ((ret = sm9_do_verify_ex(mpk, pre_comp, id, idlen, &ctx->sm3_ctx, &signature)) < 0) {
 		error_print();
 		return -1;
 	}
@@ -194,6 +230,13 @@ int sm9_verify_finish(SM9_SIGN_CTX *ctx, const uint8_t *sig, size_t siglen,
 
 int sm9_do_verify(const SM9_SIGN_MASTER_KEY *mpk, const char *id, size_t idlen,
 	const SM3_CTX *sm3_ctx, const SM9_SIGNATURE *sig)
+{
+	return sm9_do_verify_ex(mpk, NULL, id, idlen, sm3_ctx, sig);
+}
+
+// pre_comp must be computed from mpk->Ppubs, or NULL
+int sm9_do_verify_ex(const SM9_SIGN_MASTER_KEY *mpk, const SM9_SIGN_PRE_COMP *pre_comp,
+	const char *id, size_t idlen, const SM3_CTX *sm3_ctx, const SM9_SIGNATURE *sig)
 {
 	sm9_z256_t h1;
 	sm9_z256_t h2;
@@ -214,10 +257,13 @@ int sm9_do_verify(const SM9_SIGN_MASTER_KEY *mpk, const char *id, size_t idlen,
 	// B2: check S in G1
 
 	// B3: g = e(P1, Ppubs)
-	sm9_z256_pairing(g, &mpk->Ppubs, sm9_z256_generator());
-
 	// B4: t = g^h
-	sm9_z256_fp12_pow(t, g, sig->h);
+	if (pre_comp) {
+		sm9_z256_fp12_pow_table(t, pre_comp->g_table, sig->h);
+	} else {
+		sm9_z256_pairing(g, &mpk->Ppubs, sm9_z256_generator());
+		sm9_z256_fp12_pow(t, g, sig->h);
+	}
 
 	// B5: h1 = H1(ID || hid, N)
 	sm9_z256_hash1(h1, id, idlen, SM9_HID_SIGN);
@@ -414,7 +414,7 @@ int sm9_z256_print(FILE *fp, int ind, int fmt, const char *label, const sm9_z256
 }
 
 
-#ifndef ENABLE_SM9_ARM64
+#if !defined(ENABLE_SM9_ARM64) && !defined(ENABLE_SM9_AMD64)
 void sm9_z256_modp_add(sm9_z256_t r, const sm9_z256_t a, const sm9_z256_t b)
 {
 	uint64_t c;
@@ -489,6 +489,8 @@ const uint64_t SM9_Z256_P_PRIME[4] = {
 
 #if defined(ENABLE_SM9_ARM64)
 	// src/sm9_z256_armv8.S
+#elif defined(ENABLE_SM9_AMD64)
+	// src/sm9_z256_amd64.S
 #elif defined(ENABLE_SM9_Z256_NEON)
 #include <arm_neon.h>
 
@@ -684,7 +686,7 @@ void sm9_z256_modp_mont_mul(uint64_t r[4], const uint64_t a[4], const uint64_t b
 #endif // ENABLE_SM9_ARM64
 
 
-#ifndef ENABLE_SM9_ARM64
+#if !defined(ENABLE_SM9_ARM64) && !defined(ENABLE_SM9_AMD64)
 void sm9_z256_modp_to_mont(sm9_z256_t r, const sm9_z256_t a)
 {
 	sm9_z256_modp_mont_mul(r, a, SM9_Z256_MODP_2e512);
@@ -1614,6 +1616,68 @@ void sm9_z256_fp12_pow(sm9_z256_fp12_t r, const sm9_z256_fp12_t a, const sm9_z25
 	sm9_z256_fp12_copy(r, t);
 }
 
+// table[i] = a^(16^i)
+void sm9_z256_fp12_pow_pre_compute(sm9_z256_fp12_t table[SM9_Z256_FP12_POW_TABLE_SIZE], const sm9_z256_fp12_t a)
+{
+	int i;
+
+	sm9_z256_fp12_copy(table[0], a);
+	for (i = 1; i < SM9_Z256_FP12_POW_TABLE_SIZE; i++) {
+		sm9_z256_fp12_sqr(table[i], table[i - 1]);
+		sm9_z256_fp12_sqr(table[i], table[i]);
+		sm9_z256_fp12_sqr(table[i], table[i]);
+		sm9_z256_fp12_sqr(table[i], table[i]);
+	}
+}
+
+// k = sum(k_i * 16^i), a^k = prod(b_d) for d = 15..1, b_d = prod(table[i]) for all k_i >= d
+// about 79 multiplications without squaring, instead of 256 squarings and 128 multiplications
+void sm9_z256_fp12_pow_table(sm9_z256_fp12_t r, const sm9_z256_fp12_t table[SM9_Z256_FP12_POW_TABLE_SIZE], const sm9_z256_t k)
+{
+	sm9_z256_fp12_t a;
+	sm9_z256_fp12_t b;
+	uint8_t digits[SM9_Z256_FP12_POW_TABLE_SIZE];
+	int a_is_one = 1;
+	int b_is_one = 1;
+	int i, d;
+
+	for (i = 0; i < SM9_Z256_FP12_POW_TABLE_SIZE; i++) {
+		digits[i] = (k[i / 16] >> ((i % 16) * 4)) & 0xf;
+	}
+
+	for (d = 15; d > 0; d--) {
+		for (i = 0; i < SM9_Z256_FP12_POW_TABLE_SIZE; i++) {
+			if (digits[i] != d) {
+				continue;
+			}
+			if (b_is_one) {
+				sm9_z256_fp12_copy(b, table[i]);
+				b_is_one = 0;
+			} else {
+				sm9_z256_fp12_mul(b, b, table[i]);
+			}
+		}
+		if (b_is_one) {
+			continue;
+		}
+		if (a_is_one) {
+			sm9_z256_fp12_copy(a, b);
+			a_is_one = 0;
+		} else {
+			sm9_z256_fp12_mul(a, a, b);
+		}
+	}
+
+	if (a_is_one) {
+		sm9_z256_fp12_set_one(r);
+	} else {
+		sm9_z256_fp12_copy(r, a);
+	}
+	gmssl_secure_clear(digits, sizeof(digits));
+	gmssl_secure_clear(a, sizeof(a));
+	gmssl_secure_clear(b, sizeof(b));
+}
+
 void sm9_z256_fp2_conjugate(sm9_z256_fp2_t r, const sm9_z256_fp2_t a)
 {
 	sm9_z256_copy(r[0], a[0]);
@@ -2891,9 +2955,11 @@ void sm9_z256_fp12_line_mul(sm9_z256_fp12_t r, const sm9_z256_fp12_t a, const sm
 	sm9_z256_fp4_copy(r[2], r2);
 }
 
+static const char *sm9_z256_pairing_abits = "00100000000000000000000000000000000000010000101100020200101000020";
+
 void sm9_z256_pairing(sm9_z256_fp12_t r, const SM9_Z256_TWIST_POINT *Q, const SM9_Z256_POINT *P)
 {
-	const char *abits = "00100000000000000000000000000000000000010000101100020200101000020";
+	const char *abits = sm9_z256_pairing_abits;
 
 	SM9_Z256_TWIST_POINT T;
 	SM9_Z256_TWIST_POINT Q1;
@@ -2951,6 +3017,92 @@ void sm9_z256_pairing(sm9_z256_fp12_t r, const SM9_Z256_TWIST_POINT *Q, const SM
 	sm9_z256_final_exponent(r, r);
 }
 
+// The lines of the Miller loop only depend on Q, except lw[1] and lw[2] which are multiplied
+// by x and y of P. Evaluating them at P = (1, 1) keeps these factors out of the coefficients.
+void sm9_z256_pairing_lines_pre_compute(SM9_Z256_PAIRING_LINES *lines, const SM9_Z256_TWIST_POINT *Q)
+{
+	const char *abits = sm9_z256_pairing_abits;
+
+	SM9_Z256_TWIST_POINT T;
+	SM9_Z256_TWIST_POINT Q1;
+	SM9_Z256_TWIST_POINT Q2;
+	SM9_Z256_AFFINE_POINT one;
+	sm9_z256_fp2_t pre[5];
+	size_t i, n = 0;
+
+	sm9_z256_copy(one.X, SM9_Z256_MODP_MONT_ONE);
+	sm9_z256_copy(one.Y, SM9_Z256_MODP_MONT_ONE);
+
+	sm9_z256_fp2_copy(T.X, Q->X);
+	sm9_z256_fp2_copy(T.Y, Q->Y);
+	sm9_z256_fp2_copy(T.Z, Q->Z);
+
+	sm9_z256_twist_point_neg(&Q1, Q);
+
+	sm9_z256_fp2_sqr(pre[0], Q->Y);
+	sm9_z256_fp2_mul(pre[4], Q->X, Q->Z);
+	sm9_z256_fp2_dbl(pre[4], pre[4]);
+	sm9_z256_fp2_sqr(pre[1], Q->Z);
+	sm9_z256_fp2_mul(pre[1], pre[1], Q->Z);
+	sm9_z256_fp2_dbl(pre[2], pre[1]);
+	sm9_z256_fp2_dbl(pre[3], pre[1]);
+	sm9_z256_fp2_neg(pre[3], pre[3]);
+
+	for (i = 0; i < strlen(abits); i++) {
+		sm9_z256_eval_g_tangent(&T, lines->lw[n++], &T, &one);
+
+		if (abits[i] == '1') {
+			sm9_z256_eval_g_line(&T, lines->lw[n++], pre, &T, Q, &one);
+		} else if (abits[i] == '2') {
+			sm9_z256_eval_g_line(&T, lines->lw[n++], pre, &T, &Q1, &one);
+		}
+	}
+
+	sm9_z256_twist_point_pi1(&Q1, Q);
+	sm9_z256_twist_point_neg_pi2(&Q2, Q);
+
+	sm9_z256_eval_g_line_no_pre(&T, lines->lw[n++], &T, &Q1, &one);
+	sm9_z256_eval_g_line_no_pre(&T, lines->lw[n++], &T, &Q2, &one);
+
+	assert(n == SM9_Z256_PAIRING_LINES_NUM);
+}
+
+static void sm9_z256_fp12_lines_mul(sm9_z256_fp12_t r, const sm9_z256_fp2_t line[3], const SM9_Z256_AFFINE_POINT *P)
+{
+	sm9_z256_fp2_t lw[3];
+
+	sm9_z256_fp2_copy(lw[0], line[0]);
+	sm9_z256_fp2_mul_fp(lw[1], line[1], P->X);
+	sm9_z256_fp2_mul_fp(lw[2], line[2], P->Y);
+	sm9_z256_fp12_line_mul(r, r, lw);
+}
+
+void sm9_z256_pairing_with_lines(sm9_z256_fp12_t r, const SM9_Z256_PAIRING_LINES *lines, const SM9_Z256_POINT *P)
+{
+	const char *abits = sm9_z256_pairing_abits;
+
+	SM9_Z256_AFFINE_POINT P_;
+	size_t i, n = 0;
+
+	sm9_z256_point_to_affine(&P_, P);
+
+	sm9_z256_fp12_set_one(r);
+
+	for (i = 0; i < strlen(abits); i++) {
+		sm9_z256_fp12_sqr(r, r);
+		sm9_z256_fp12_lines_mul(r, lines->lw[n++], &P_);
+
+		if (abits[i] != '0') {
+			sm9_z256_fp12_lines_mul(r, lines->lw[n++], &P_);
+		}
+	}
+
+	sm9_z256_fp12_lines_mul(r, lines->lw[n++], &P_);
+	sm9_z256_fp12_lines_mul(r, lines->lw[n++], &P_);
+
+	sm9_z256_final_exponent(r, r);
+}
+
 void sm9_z256_modn_add(sm9_z256_t r, const sm9_z256_t a, const sm9_z256_t b)
 {
 	uint64_t c;
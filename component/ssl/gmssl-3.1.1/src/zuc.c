@@ -13,6 +13,10 @@
 #include <gmssl/zuc.h>
 #include <gmssl/mem.h>
 #include <gmssl/endian.h>
+#include <gmssl/error.h>
+#if defined(ENABLE_ZUC_PCLMUL) || defined(ENABLE_ZUC_AVX2)
+#include <immintrin.h>
+#endif
 
 
 static const ZUC_UINT15 KD[16] = {
@@ -20,7 +24,8 @@ static const ZUC_UINT15 KD[16] = {
 	0x4D78,0x2F13,0x6BC4,0x1AF1,0x5E26,0x3C4D,0x789A,0x47AC,
 };
 
-static const uint8_t S0[256] = {
+// three bytes of room after the last entry for a 32-bit gather
+static const uint8_t S0[256 + 3] = {
 	0x3e,0x72,0x5b,0x47,0xca,0xe0,0x00,0x33,0x04,0xd1,0x54,0x98,0x09,0xb9,0x6d,0xcb,
 	0x7b,0x1b,0xf9,0x32,0xaf,0x9d,0x6a,0xa5,0xb8,0x2d,0xfc,0x1d,0x08,0x53,0x03,0x90,
 	0x4d,0x4e,0x84,0x99,0xe4,0xce,0xd9,0x91,0xdd,0xb6,0x85,0x48,0x8b,0x29,0x6e,0xac,
@@ -39,7 +44,7 @@ static const uint8_t S0[256] = {
 	0x8d,0x27,0x1a,0xdb,0x81,0xb3,0xa0,0xf4,0x45,0x7a,0x19,0xdf,0xee,0x78,0x34,0x60,
 };
 
-static const uint8_t S1[256] = {
+static const uint8_t S1[256 + 3] = {
 	0x55,0xc2,0x63,0x71,0x3b,0xc8,0x47,0x86,0x9f,0x3c,0xda,0x5b,0x29,0xaa,0xfd,0x77,
 	0x8c,0xc5,0x94,0x0c,0xa6,0x1a,0x13,0x00,0xe3,0xa8,0x16,0x72,0x40,0xf9,0xf8,0x42,
 	0x44,0x26,0x68,0x96,0x81,0xd9,0x45,0x3e,0x10,0x76,0xc6,0xa7,0x8b,0x39,0x43,0xe1,
@@ -350,6 +355,214 @@ void zuc_encrypt(ZUC_STATE *state, const uint8_t *in, size_t inlen, uint8_t *out
 	state->R2 = R2;
 }
 
+int zuc_multi_init(ZUC_MULTI_STATE *state, const ZUC_STATE *lanes, size_t nlanes)
+{
+	size_t i, l;
+
+	if (!state || !lanes || !nlanes || nlanes > ZUC_MULTI_MAX_LANES) {
+		error_print();
+		return -1;
+	}
+	memset(state, 0, sizeof(*state));
+	for (l = 0; l < nlanes; l++) {
+		for (i = 0; i < 16; i++) {
+			state->LFSR[i][l] = lanes[l].LFSR[i];
+		}
+		state->R1[l] = lanes[l].R1;
+		state->R2[l] = lanes[l].R2;
+	}
+	state->lanes = nlanes;
+	state->pos = 0;
+	return 1;
+}
+
+/*
+ * The lanes of one keyword are independent, the inner loop over them has no carried state.
+ * The LFSR is not shifted, pos moves instead and s_15 is written over the old s_0.
+ */
+static void zuc_multi_generate_lanes(ZUC_MULTI_STATE *state, size_t l, size_t lanes, size_t nwords, ZUC_UINT32 *keystream[])
+{
+	ZUC_UINT32 *R1 = state->R1;
+	ZUC_UINT32 *R2 = state->R2;
+	ZUC_UINT31 *s0, *s2, *s4, *s5, *s7, *s9, *s10, *s11, *s13, *s14, *s15;
+	uint32_t X0, X1, X2, X3;
+	uint32_t W1, W2, U, V;
+	uint64_t a;
+	size_t pos = state->pos;
+	size_t i, k;
+
+	for (i = 0; i < nwords; i++) {
+		s0 = state->LFSR[pos];
+		s2 = state->LFSR[(pos + 2) & 15];
+		s4 = state->LFSR[(pos + 4) & 15];
+		s5 = state->LFSR[(pos + 5) & 15];
+		s7 = state->LFSR[(pos + 7) & 15];
+		s9 = state->LFSR[(pos + 9) & 15];
+		s10 = state->LFSR[(pos + 10) & 15];
+		s11 = state->LFSR[(pos + 11) & 15];
+		s13 = state->LFSR[(pos + 13) & 15];
+		s14 = state->LFSR[(pos + 14) & 15];
+		s15 = state->LFSR[(pos + 15) & 15];
+
+		for (k = l; k < lanes; k++) {
+			X0 = ((s15[k] & 0x7FFF8000) <<  1) | (s14[k] & 0xFFFF);
+			X1 = ((s11[k] & 0x0000FFFF) << 16) | (s9[k] >> 15);
+			X2 = ((s7[k] & 0x0000FFFF) << 16) | (s5[k] >> 15);
+			X3 = ((s2[k] & 0x0000FFFF) << 16) | (s0[k] >> 15);
+
+			keystream[k][i] = X3 ^ ((X0 ^ R1[k]) + R2[k]);
+
+			W1 = R1[k] + X1;
+			W2 = R2[k] ^ X2;
+			U = L1((W1 << 16) | (W2 >> 16));
+			V = L2((W2 << 16) | (W1 >> 16));
+			R1[k] = MAKEU32(S0[U >> 24], S1[(U >> 16) & 0xFF], S0[(U >> 8) & 0xFF], S1[U & 0xFF]);
+			R2[k] = MAKEU32(S0[V >> 24], S1[(V >> 16) & 0xFF], S0[(V >> 8) & 0xFF], S1[V & 0xFF]);
+
+			a = s0[k];
+			a += ((uint64_t)s0[k]) <<  8;
+			a += ((uint64_t)s4[k]) << 20;
+			a += ((uint64_t)s10[k]) << 21;
+			a += ((uint64_t)s13[k]) << 17;
+			a += ((uint64_t)s15[k]) << 15;
+			a = (a & 0x7fffffff) + (a >> 31);
+			s0[k] = (uint32_t)((a & 0x7fffffff) + (a >> 31));
+		}
+		pos = (pos + 1) & 15;
+	}
+}
+
+#if defined(ENABLE_ZUC_AVX2)
+#define ROT32_X8(a,k)	_mm256_or_si256(_mm256_slli_epi32(a, k), _mm256_srli_epi32(a, 32 - (k)))
+#define ROT31_X8(a,k)	_mm256_and_si256(_mm256_or_si256(_mm256_slli_epi32(a, k), _mm256_srli_epi32(a, 31 - (k))), M31)
+#define ADD31_X8(a,b)	a = _mm256_add_epi32(a, b); a = _mm256_add_epi32(_mm256_and_si256(a, M31), _mm256_srli_epi32(a, 31))
+#define SBOX_X8(S,x,n)	_mm256_and_si256(_mm256_i32gather_epi32((const int *)(S), _mm256_and_si256(_mm256_srli_epi32(x, n), MFF), 1), MFF)
+#define LOAD_X8(k)	_mm256_loadu_si256((const __m256i *)(state->LFSR[(pos + (k)) & 15] + l))
+
+// eight lanes from l on, in the order of zuc_multi_generate_lanes()
+static void zuc_multi_generate_x8_avx2(ZUC_MULTI_STATE *state, size_t l, size_t nwords, ZUC_UINT32 *keystream[])
+{
+	const __m256i M31 = _mm256_set1_epi32(0x7fffffff);
+	const __m256i M16 = _mm256_set1_epi32(0xffff);
+	const __m256i MFF = _mm256_set1_epi32(0xff);
+	const __m256i MX0 = _mm256_set1_epi32(0x7fff8000);
+	__m256i R1 = _mm256_loadu_si256((const __m256i *)(state->R1 + l));
+	__m256i R2 = _mm256_loadu_si256((const __m256i *)(state->R2 + l));
+	__m256i s0, s15, X0, X1, X2, X3, W1, W2, U, V, Z;
+	uint32_t z[8];
+	size_t pos = state->pos;
+	size_t i, k;
+
+	for (i = 0; i < nwords; i++) {
+		s0 = LOAD_X8(0);
+		s15 = LOAD_X8(15);
+		X0 = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(s15, MX0), 1), _mm256_and_si256(LOAD_X8(14), M16));
+		X1 = _mm256_or_si256(_mm256_slli_epi32(LOAD_X8(11), 16), _mm256_srli_epi32(LOAD_X8(9), 15));
+		X2 = _mm256_or_si256(_mm256_slli_epi32(LOAD_X8(7), 16), _mm256_srli_epi32(LOAD_X8(5), 15));
+		X3 = _mm256_or_si256(_mm256_slli_epi32(LOAD_X8(2), 16), _mm256_srli_epi32(s0, 15));
+
+		Z = _mm256_xor_si256(X3, _mm256_add_epi32(_mm256_xor_si256(X0, R1), R2));
+
+		W1 = _mm256_add_epi32(R1, X1);
+		W2 = _mm256_xor_si256(R2, X2);
+		U = _mm256_or_si256(_mm256_slli_epi32(W1, 16), _mm256_srli_epi32(W2, 16));
+		V = _mm256_or_si256(_mm256_slli_epi32(W2, 16), _mm256_srli_epi32(W1, 16));
+		U = _mm256_xor_si256(_mm256_xor_si256(U, ROT32_X8(U, 2)),
+			_mm256_xor_si256(_mm256_xor_si256(ROT32_X8(U, 10), ROT32_X8(U, 18)), ROT32_X8(U, 24)));
+		V = _mm256_xor_si256(_mm256_xor_si256(V, ROT32_X8(V, 8)),
+			_mm256_xor_si256(_mm256_xor_si256(ROT32_X8(V, 14), ROT32_X8(V, 22)), ROT32_X8(V, 30)));
+		R1 = _mm256_or_si256(
+			_mm256_or_si256(_mm256_slli_epi32(SBOX_X8(S0, U, 24), 24), _mm256_slli_epi32(SBOX_X8(S1, U, 16), 16)),
+			_mm256_or_si256(_mm256_slli_epi32(SBOX_X8(S0, U, 8), 8), SBOX_X8(S1, U, 0)));
+		R2 = _mm256_or_si256(
+			_mm256_or_si256(_mm256_slli_epi32(SBOX_X8(S0, V, 24), 24), _mm256_slli_epi32(SBOX_X8(S1, V, 16), 16)),
+			_mm256_or_si256(_mm256_slli_epi32(SBOX_X8(S0, V, 8), 8), SBOX_X8(S1, V, 0)));
+
+		// every term is in [1, 2^31 - 1], so is each partial sum
+		V = s0;
+		ADD31_X8(V, ROT31_X8(s0, 8));
+		ADD31_X8(V, ROT31_X8(LOAD_X8(4), 20));
+		ADD31_X8(V, ROT31_X8(LOAD_X8(10), 21));
+		ADD31_X8(V, ROT31_X8(LOAD_X8(13), 17));
+		ADD31_X8(V, ROT31_X8(s15, 15));
+		_mm256_storeu_si256((__m256i *)(state->LFSR[pos] + l), V);
+
+		_mm256_storeu_si256((__m256i *)z, Z);
+		for (k = 0; k < 8; k++) {
+			keystream[l + k][i] = z[k];
+		}
+		pos = (pos + 1) & 15;
+	}
+
+	_mm256_storeu_si256((__m256i *)(state->R1 + l), R1);
+	_mm256_storeu_si256((__m256i *)(state->R2 + l), R2);
+}
+#endif
+
+void zuc_multi_generate_keystream(ZUC_MULTI_STATE *state, size_t nwords, ZUC_UINT32 *keystream[])
+{
+	size_t l = 0;
+
+#if defined(ENABLE_ZUC_AVX2)
+	for (; l + 8 <= state->lanes; l += 8) {
+		zuc_multi_generate_x8_avx2(state, l, nwords, keystream);
+	}
+#endif
+	if (l < state->lanes) {
+		zuc_multi_generate_lanes(state, l, state->lanes, nwords, keystream);
+	}
+	state->pos = (state->pos + nwords) & 15;
+}
+
+/*
+ * EIA3 folds bit j of a message word, counted from the most significant bit, into the tag as
+ * the 32 keystream bits starting at bit j. With K = K0 || K1 that is the high word of K << j, so
+ * one word adds bits 32..63 of the carry-less product of K and the bit reversed message word.
+ */
+#if defined(ENABLE_ZUC_PCLMUL)
+static ZUC_UINT32 zuc_mac_word(ZUC_UINT32 M, ZUC_UINT32 K0, ZUC_UINT32 K1)
+{
+	__m128i K = _mm_cvtsi64_si128((long long)(((uint64_t)K0 << 32) | K1));
+	__m128i R;
+
+	M = (M << 16) | (M >> 16);
+	M = ((M & 0x00ff00ff) << 8) | ((M >> 8) & 0x00ff00ff);
+	M = ((M & 0x0f0f0f0f) << 4) | ((M >> 4) & 0x0f0f0f0f);
+	M = ((M & 0x33333333) << 2) | ((M >> 2) & 0x33333333);
+	M = ((M & 0x55555555) << 1) | ((M >> 1) & 0x55555555);
+
+	R = _mm_clmulepi64_si128(K, _mm_cvtsi32_si128((int)M), 0x00);
+	return (ZUC_UINT32)((uint64_t)_mm_cvtsi128_si64(R) >> 32);
+}
+#else
+// four message bits per lookup in a table of K << 0..3
+static ZUC_UINT32 zuc_mac_word(ZUC_UINT32 M, ZUC_UINT32 K0, ZUC_UINT32 K1)
+{
+	uint64_t K = ((uint64_t)K0 << 32) | K1;
+	uint64_t tab[16];
+	uint64_t R;
+	int i;
+
+	tab[0] = 0;
+	tab[1] = K << 3;
+	tab[2] = K << 2;
+	tab[3] = tab[2] ^ tab[1];
+	tab[4] = K << 1;
+	tab[5] = tab[4] ^ tab[1];
+	tab[6] = tab[4] ^ tab[2];
+	tab[7] = tab[4] ^ tab[3];
+	for (i = 0; i < 8; i++) {
+		tab[8 + i] = K ^ tab[i];
+	}
+
+	R = tab[M >> 28];
+	for (i = 1; i < 8; i++) {
+		R ^= tab[(M >> (28 - 4 * i)) & 0xf] << (4 * i);
+	}
+	return (ZUC_UINT32)(R >> 32);
+}
+#endif
+
 void zuc_mac_init(ZUC_MAC_CTX *ctx, const uint8_t key[16], const uint8_t iv[16])
 {
 	memset(ctx, 0, sizeof(*ctx));
@@ -367,7 +580,6 @@ void zuc_mac_update(ZUC_MAC_CTX *ctx, const uint8_t *data, size_t len)
 	ZUC_UINT32 R2 = ctx->R2;
 	ZUC_UINT32 X0, X1, X2, X3;
 	ZUC_UINT32 W1, W2, U, V;
-	size_t i;
 
 	if (!data || !len) {
 		return;
@@ -389,14 +601,8 @@ void zuc_mac_update(ZUC_MAC_CTX *ctx, const uint8_t *data, size_t len)
 		K1 = X3 ^ F(X0, X1, X2);
 		LFSRWithWorkMode();
 
-		for (i = 0; i < 32; i++) {
-			if (M & 0x80000000) {
-				T ^= K0;
-			}
-			M <<= 1;
-			K0 = (K0 << 1) | (K1 >> 31);
-			K1 <<= 1;
-		}
+		T ^= zuc_mac_word(M, K0, K1);
+		K0 = K1;
 
 		data += num;
 		len -= num;
@@ -409,14 +615,8 @@ void zuc_mac_update(ZUC_MAC_CTX *ctx, const uint8_t *data, size_t len)
 		K1 = X3 ^ F(X0, X1, X2);
 		LFSRWithWorkMode();
 
-		for (i = 0; i < 32; i++) {
-			if (M & 0x80000000) {
-				T ^= K0;
-			}
-			M <<= 1;
-			K0 = (K0 << 1) | (K1 >> 31);
-			K1 <<= 1;
-		}
+		T ^= zuc_mac_word(M, K0, K1);
+		K0 = K1;
 
 		data += 4;
 		len -= 4;
@@ -442,7 +642,6 @@ void zuc_mac_finish(ZUC_MAC_CTX *ctx, const uint8_t *data, size_t nbits, uint8_t
 	ZUC_UINT32 R2;
 	ZUC_UINT32 X0, X1, X2, X3;
 	ZUC_UINT32 W1, W2, U, V;
-	size_t i;
 
 	if (!data)
 		nbits = 0;
@@ -462,19 +661,15 @@ void zuc_mac_finish(ZUC_MAC_CTX *ctx, const uint8_t *data, size_t nbits, uint8_t
 		ctx->buf[ctx->buflen] = *data;
 
 	if (ctx->buflen || nbits) {
-		M = GETU32(ctx->buf);
+		// 1 to 31 bits left, the bytes behind them are stale
+		nbits += ctx->buflen * 8;
+		M = GETU32(ctx->buf) & ~(0xffffffff >> nbits);
 		BitReconstruction4(X0, X1, X2, X3);
 		K1 = X3 ^ F(X0, X1, X2);
 		LFSRWithWorkMode();
 
-		for (i = 0; i < ctx->buflen * 8 + nbits; i++) {
-			if (M & 0x80000000) {
-				T ^= K0;
-			}
-			M <<= 1;
-			K0 = (K0 << 1) | (K1 >> 31);
-			K1 <<= 1;
-		}
+		T ^= zuc_mac_word(M, K0, K1);
+		K0 = (K0 << nbits) | (K1 >> (32 - nbits));
 	}
 
 	T ^= K0;
@@ -593,11 +788,33 @@ void zuc256_mac_init(ZUC256_MAC_CTX *ctx, const uint8_t key[32],
 	ctx->macbits = (macbits/32) * 32;
 }
 
+// fold nbits (1 to 32) bits of M into every tag word and move the keystream window past them
+static void zuc256_mac_word(ZUC256_MAC_CTX *ctx, ZUC_UINT32 M, ZUC_UINT32 K1, size_t nbits)
+{
+	size_t n = ctx->macbits / 32;
+	size_t j;
+
+	for (j = 0; j < n - 1; j++) {
+		ctx->T[j] ^= zuc_mac_word(M, ctx->K0[j], ctx->K0[j + 1]);
+	}
+	ctx->T[j] ^= zuc_mac_word(M, ctx->K0[j], K1);
+
+	if (nbits == 32) {
+		for (j = 0; j < n - 1; j++) {
+			ctx->K0[j] = ctx->K0[j + 1];
+		}
+		ctx->K0[j] = K1;
+		return;
+	}
+	for (j = 0; j < n - 1; j++) {
+		ctx->K0[j] = (ctx->K0[j] << nbits) | (ctx->K0[j + 1] >> (32 - nbits));
+	}
+	ctx->K0[j] = (ctx->K0[j] << nbits) | (K1 >> (32 - nbits));
+}
+
 void zuc256_mac_update(ZUC256_MAC_CTX *ctx, const uint8_t *data, size_t len)
 {
 	ZUC_UINT32 K1, M;
-	size_t n = ctx->macbits / 32;
-	size_t i, j;
 
 	if (!data || !len) {
 		return;
@@ -617,19 +834,7 @@ void zuc256_mac_update(ZUC256_MAC_CTX *ctx, const uint8_t *data, size_t len)
 
 		K1 = zuc256_generate_keyword((ZUC256_STATE *)ctx);
 
-		for (i = 0; i < 32; i++) {
-			if (M & 0x80000000) {
-				for (j = 0; j < n; j++) {
-					ctx->T[j] ^= ctx->K0[j];
-				}
-			}
-			M <<= 1;
-			for (j = 0; j < n - 1; j++) {
-				ctx->K0[j] = (ctx->K0[j] << 1) | (ctx->K0[j + 1] >> 31);
-			}
-			ctx->K0[j] = (ctx->K0[j] << 1) | (K1 >> 31);
-			K1 <<= 1;
-		}
+		zuc256_mac_word(ctx, M, K1, 32);
 
 		data += num;
 		len -= num;
@@ -639,19 +844,7 @@ void zuc256_mac_update(ZUC256_MAC_CTX *ctx, const uint8_t *data, size_t len)
 		M = GETU32(data);
 		K1 = zuc256_generate_keyword((ZUC256_STATE *)ctx);
 
-		for (i = 0; i < 32; i++) {
-			if (M & 0x80000000) {
-				for (j = 0; j < n; j++) {
-					ctx->T[j] ^= ctx->K0[j];
-				}
-			}
-			M <<= 1;
-			for (j = 0; j < n - 1; j++) {
-				ctx->K0[j] = (ctx->K0[j] << 1) | (ctx->K0[j + 1] >> 31);
-			}
-			ctx->K0[j] = (ctx->K0[j] << 1) | (K1 >> 31);
-			K1 <<= 1;
-		}
+		zuc256_mac_word(ctx, M, K1, 32);
 
 		data += 4;
 		len -= 4;
@@ -667,7 +860,7 @@ void zuc256_mac_finish(ZUC256_MAC_CTX *ctx, const uint8_t *data, size_t nbits, u
 {
 	ZUC_UINT32 K1, M;
 	size_t n = ctx->macbits/32;
-	size_t i, j;
+	size_t j;
 
 
 	if (!data)
@@ -683,23 +876,11 @@ void zuc256_mac_finish(ZUC256_MAC_CTX *ctx, const uint8_t *data, size_t nbits, u
 		ctx->buf[ctx->buflen] = *data;
 
 	if (ctx->buflen || nbits) {
-		M = GETU32(ctx->buf);
+		// 1 to 31 bits left, the bytes behind them are stale
+		nbits += ctx->buflen * 8;
+		M = GETU32(ctx->buf) & ~(0xffffffff >> nbits);
 		K1 = zuc256_generate_keyword((ZUC256_STATE *)ctx);
-
-
-		for (i = 0; i < ctx->buflen * 8 + nbits; i++) {
-			if (M & 0x80000000) {
-				for (j = 0; j < n; j++) {
-					ctx->T[j] ^= ctx->K0[j];
-				}
-			}
-			M <<= 1;
-			for (j = 0; j < n - 1; j++) {
-				ctx->K0[j] = (ctx->K0[j] << 1) | (ctx->K0[j + 1] >> 31);
-			}
-			ctx->K0[j] = (ctx->K0[j] << 1) | (K1 >> 31);
-			K1 <<= 1;
-		}
+		zuc256_mac_word(ctx, M, K1, nbits);
 	}
 
 	for (j = 0; j < n; j++) {
@@ -142,6 +142,152 @@ static int test_sm2_fast_sign(void)
 	return 1;
 }
 
+static int test_sm2_verify_pre_comp(void)
+{
+	static SM2_VERIFY_PRE_COMP pre_comp;
+	SM2_KEY sm2_key;
+	SM2_VERIFY_CTX vrfy_ctx;
+	SM2_SIGN_CTX sign_ctx;
+	uint8_t dgst[32];
+	uint8_t msg[100];
+	uint8_t sig[SM2_MAX_SIGNATURE_SIZE];
+	size_t siglen;
+	SM2_SIGNATURE bad_sig;
+	size_t i;
+
+	if (sm2_key_generate(&sm2_key) != 1) {
+		error_print();
+		return -1;
+	}
+	if (sm2_verify_pre_compute(&pre_comp, &sm2_key) != 1) {
+		error_print();
+		return -1;
+	}
+
+	for (i = 0; i < TEST_COUNT; i++) {
+
+		rand_bytes(dgst, 32);
+
+		if (sm2_sign(&sm2_key, dgst, sig, &siglen) != 1) {
+			error_print();
+			return -1;
+		}
+		if (sm2_verify_ex(&pre_comp, dgst, sig, siglen) != 1) {
+			error_print();
+			return -1;
+		}
+		dgst[i % 32] ^= 0x01;
+		if (sm2_verify_ex(&pre_comp, dgst, sig, siglen) == 1) {
+			error_print();
+			return -1;
+		}
+	}
+
+	// r = n, out of range
+	memset(&bad_sig, 0, sizeof(bad_sig));
+	sm2_z256_to_bytes(sm2_z256_order(), bad_sig.r);
+	bad_sig.s[31] = 1;
+	if (sm2_do_verify_ex(&pre_comp, dgst, &bad_sig) == 1) {
+		error_print();
+		return -1;
+	}
+
+	// ctx with pre_comp
+	rand_bytes(msg, sizeof(msg));
+	if (sm2_sign_init(&sign_ctx, &sm2_key, SM2_DEFAULT_ID, SM2_DEFAULT_ID_LENGTH) != 1
+		|| sm2_sign_update(&sign_ctx, msg, sizeof(msg)) != 1
+		|| sm2_sign_finish(&sign_ctx, sig, &siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	if (sm2_verify_init_ex(&vrfy_ctx, &pre_comp, SM2_DEFAULT_ID, SM2_DEFAULT_ID_LENGTH) != 1
+		|| sm2_verify_update(&vrfy_ctx, msg, sizeof(msg)) != 1
+		|| sm2_verify_finish(&vrfy_ctx, sig, siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	if (sm2_verify_reset(&vrfy_ctx) != 1
+		|| sm2_verify_update(&vrfy_ctx, msg, sizeof(msg) - 1) != 1
+		|| sm2_verify_finish(&vrfy_ctx, sig, siglen) == 1) {
+		error_print();
+		return -1;
+	}
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+}
+
+static int test_sm2_verify_batch(void)
+{
+	static SM2_VERIFY_PRE_COMP pre_comp;
+	SM2_KEY keys[3];
+	uint8_t dgsts[TEST_COUNT][32];
+	SM2_SIGNATURE sigs[TEST_COUNT];
+	SM2_VERIFY_BATCH_ITEM items[TEST_COUNT];
+	int results[TEST_COUNT];
+	int expected[TEST_COUNT];
+	size_t i;
+
+	for (i = 0; i < sizeof(keys)/sizeof(keys[0]); i++) {
+		if (sm2_key_generate(&keys[i]) != 1) {
+			error_print();
+			return -1;
+		}
+	}
+	if (sm2_verify_pre_compute(&pre_comp, &keys[2]) != 1) {
+		error_print();
+		return -1;
+	}
+
+	// runs of the same key, the last key with pre_comp
+	for (i = 0; i < TEST_COUNT; i++) {
+		const SM2_KEY *key = &keys[(i / 3) % 3];
+
+		rand_bytes(dgsts[i], 32);
+		if (sm2_do_sign(key, dgsts[i], &sigs[i]) != 1) {
+			error_print();
+			return -1;
+		}
+		items[i].key = key;
+		items[i].pre_comp = key == &keys[2] ? &pre_comp : NULL;
+		items[i].dgst = dgsts[i];
+		items[i].sig = &sigs[i];
+		expected[i] = 1;
+	}
+
+	if (sm2_do_verify_batch(items, TEST_COUNT, results) != 1) {
+		error_print();
+		return -1;
+	}
+	for (i = 0; i < TEST_COUNT; i++) {
+		if (results[i] != 1) {
+			error_print();
+			return -1;
+		}
+	}
+
+	// wrong digest, wrong key, wrong signature, r = 0
+	dgsts[1][0] ^= 0x01; expected[1] = 0;
+	items[4].key = &keys[0]; expected[4] = 0;
+	sigs[8].s[31] ^= 0x01; expected[8] = 0;
+	memset(sigs[13].r, 0, 32); expected[13] = 0;
+
+	if (sm2_do_verify_batch(items, TEST_COUNT, results) != 0) {
+		error_print();
+		return -1;
+	}
+	for (i = 0; i < TEST_COUNT; i++) {
+		if (results[i] != expected[i]) {
+			fprintf(stderr, "%s: item %zu\n", __FUNCTION__, i);
+			error_print();
+			return -1;
+		}
+	}
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+}
+
 static int test_sm2_sign(void)
 {
 	SM2_KEY sm2_key;
@@ -211,6 +357,68 @@ static int speed_sm2_sign_ctx(void)
 	return 1;
 }
 
+static int speed_sm2_verify_batch(void)
+{
+	static SM2_VERIFY_PRE_COMP pre_comp;
+	SM2_KEY sm2_key;
+	uint8_t dgst[32];
+	SM2_SIGNATURE sig;
+	SM2_VERIFY_BATCH_ITEM items[16];
+	int results[16];
+	clock_t start, end;
+	double seconds;
+	int i;
+
+	sm2_key_generate(&sm2_key);
+	sm2_verify_pre_compute(&pre_comp, &sm2_key);
+	rand_bytes(dgst, sizeof(dgst));
+	sm2_do_sign(&sm2_key, dgst, &sig);
+
+	for (i = 0; i < 16; i++) {
+		items[i].key = &sm2_key;
+		items[i].pre_comp = NULL;
+		items[i].dgst = dgst;
+		items[i].sig = &sig;
+	}
+
+	start = clock();
+	for (i = 0; i < 1024; i++) {
+		if (sm2_do_verify(&sm2_key, dgst, &sig) != 1) {
+			error_print();
+			return -1;
+		}
+	}
+	end = clock();
+	seconds = (double)(end - start)/CLOCKS_PER_SEC;
+	printf("%s: sm2_do_verify %f verifies per second\n", __FUNCTION__, 1024/seconds);
+
+	start = clock();
+	for (i = 0; i < 1024/16; i++) {
+		if (sm2_do_verify_batch(items, 16, results) != 1) {
+			error_print();
+			return -1;
+		}
+	}
+	end = clock();
+	seconds = (double)(end - start)/CLOCKS_PER_SEC;
+	printf("%s: sm2_do_verify_batch %f verifies per second\n", __FUNCTION__, 1024/seconds);
+
+	for (i = 0; i < 16; i++) {
+		items[i].pre_comp = &pre_comp;
+	}
+	start = clock();
+	for (i = 0; i < 1024/16; i++) {
+		if (sm2_do_verify_batch(items, 16, results) != 1) {
+			error_print();
+			return -1;
+		}
+	}
+	end = clock();
+	seconds = (double)(end - start)/CLOCKS_PER_SEC;
+	printf("%s: sm2_do_verify_batch with pre_comp %f verifies per second\n", __FUNCTION__, 1024/seconds);
+	return 1;
+}
+
 static int test_sm2_sign_ctx(void)
 {
 	int ret;
@@ -334,11 +542,14 @@ int main(void)
 	if (test_sm2_signature() != 1) goto err;
 	if (test_sm2_do_sign() != 1) goto err;
 	if (test_sm2_fast_sign() != 1) goto err;
+	if (test_sm2_verify_pre_comp() != 1) goto err;
+	if (test_sm2_verify_batch() != 1) goto err;
 	if (test_sm2_sign() != 1) goto err;
 	if (test_sm2_sign_ctx() != 1) goto err;
 	if (test_sm2_sign_reset() != 1) goto err;
 #if ENABLE_TEST_SPEED
 	if (speed_sm2_sign_ctx() != 1) goto err;
+	if (speed_sm2_verify_batch() != 1) goto err;
 #endif
 	printf("%s all tests passed\n", __FILE__);
 	return 0;
@@ -859,6 +859,53 @@ static int test_sm2_z256_point_mul_generator(void)
 	return 1;
 }
 
+static int test_sm2_z256_point_mul_fixed(void)
+{
+	static SM2_Z256_FIXED_POINT_TABLE table;
+	SM2_Z256_POINT P;
+	SM2_Z256_POINT R;
+	SM2_Z256_POINT Q;
+	uint64_t k[4];
+	size_t i, j;
+
+	for (i = 0; i < 2; i++) {
+
+		// P = G in affine form, then a random point in jacobian form
+		if (i == 0) {
+			sm2_z256_set_one(k);
+			sm2_z256_point_mul_generator(&P, k);
+		} else {
+			sm2_z256_rand_range(k, sm2_z256_order());
+			sm2_z256_point_mul_generator(&P, k);
+			sm2_z256_point_dbl(&P, &P);
+		}
+		sm2_z256_point_mul_fixed_pre_compute(&P, &table);
+
+		for (j = 0; j < 20; j++) {
+			switch (j) {
+			case 0: sm2_z256_set_zero(k); break;
+			case 1: sm2_z256_set_one(k); break;
+			case 2: sm2_z256_copy(k, sm2_z256_order_minus_one()); break;
+			case 3: k[0] = k[1] = k[2] = k[3] = 0x8888888888888888; break;
+			case 4: k[0] = k[1] = k[2] = k[3] = 0xffffffffffffffff; break;
+			default: sm2_z256_rand_range(k, sm2_z256_order());
+			}
+
+			sm2_z256_point_mul_fixed(&R, k, &table);
+			sm2_z256_point_mul(&Q, k, &P);
+
+			if (sm2_z256_point_equ(&R, &Q) != 1) {
+				fprintf(stderr, "%s: error, case %zu/%zu\n", __FUNCTION__, i, j);
+				error_print();
+				return -1;
+			}
+		}
+	}
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+}
+
 static int test_sm2_z256_point_equ(void)
 {
 	struct {
@@ -958,6 +1005,7 @@ int main(void)
 	if (test_sm2_z256_point_get_xy() != 1) goto err;
 	if (test_sm2_z256_point_add_conjugate() != 1) goto err;
 	if (test_sm2_z256_point_mul_generator() != 1) goto err;
+	if (test_sm2_z256_point_mul_fixed() != 1) goto err;
 	if (test_sm2_z256_point_from_hash() != 1) goto err;
 	if (test_sm2_z256_point_from_x_bytes() != 1) goto err;
 
@@ -663,6 +663,84 @@ err:
 	return -1;
 }
 
+int test_sm9_z256_fp12_pow_table()
+{
+	static sm9_z256_fp12_t table[SM9_Z256_FP12_POW_TABLE_SIZE];
+	sm9_z256_fp12_t x;
+	sm9_z256_fp12_t r;
+	sm9_z256_fp12_t s;
+	sm9_z256_t k;
+	const sm9_z256_t two = {2, 0, 0, 0};
+	int i, j = 1;
+
+	sm9_z256_fp12_rand(x);
+	sm9_z256_fp12_pow_pre_compute(table, x);
+
+	// k = 0, 1, 15, 16, 0x1111..., N - 2, random
+	for (i = 0; i < 16; i++) {
+		switch (i) {
+		case 0: sm9_z256_set_zero(k); break;
+		case 1: sm9_z256_set_one(k); break;
+		case 2: sm9_z256_set_zero(k); k[0] = 15; break;
+		case 3: sm9_z256_set_zero(k); k[0] = 16; break;
+		case 4: k[0] = k[1] = k[2] = 0x1111111111111111; k[3] = 0x0111111111111111; break;
+		case 5: sm9_z256_sub(k, sm9_z256_order(), two); break;
+		default: sm9_z256_rand_range(k, sm9_z256_order());
+		}
+		sm9_z256_fp12_pow(r, x, k);
+		sm9_z256_fp12_pow_table(s, (const sm9_z256_fp12_t *)table, k);
+		if (!sm9_z256_fp12_equ(r, s)) goto err; ++j;
+	}
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+err:
+	printf("%s test %d failed\n", __FUNCTION__, j);
+	error_print();
+	return -1;
+}
+
+int test_sm9_z256_pairing_lines()
+{
+	static SM9_Z256_PAIRING_LINES lines;
+	SM9_Z256_TWIST_POINT p;
+	SM9_Z256_POINT q;
+	sm9_z256_fp12_t r;
+	sm9_z256_fp12_t s;
+	sm9_z256_t k;
+	int i, j = 1;
+
+	sm9_z256_twist_point_from_hex(&p, hex_deB);
+	sm9_z256_pairing_lines_pre_compute(&lines, &p);
+
+	sm9_z256_point_from_hex(&q, hex_RA);
+	sm9_z256_pairing_with_lines(r, &lines, &q); sm9_z256_fp12_from_hex(s, hex_pairing2); if (!sm9_z256_fp12_equ(r, s)) goto err; ++j;
+
+	// points not in affine form
+	for (i = 0; i < 4; i++) {
+		sm9_z256_rand_range(k, sm9_z256_order());
+		sm9_z256_point_mul_generator(&q, k);
+		sm9_z256_pairing(r, &p, &q);
+		sm9_z256_pairing_with_lines(s, &lines, &q);
+		if (!sm9_z256_fp12_equ(r, s)) goto err; ++j;
+	}
+
+	// Q not in affine form
+	sm9_z256_rand_range(k, sm9_z256_order());
+	sm9_z256_twist_point_mul_generator(&p, k);
+	sm9_z256_pairing_lines_pre_compute(&lines, &p);
+	sm9_z256_pairing(r, &p, &q);
+	sm9_z256_pairing_with_lines(s, &lines, &q);
+	if (!sm9_z256_fp12_equ(r, s)) goto err; ++j;
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+err:
+	printf("%s test %d failed\n", __FUNCTION__, j);
+	error_print();
+	return -1;
+}
+
 #define hex_ks		"000130E78459D78545CB54C587E02CF480CE0B66340F319F348A1D5B1F2DC5F4"
 
 #define hex_ds \
@@ -832,6 +910,100 @@ err:
 	return -1;
 }
 
+int test_sm9_z256_pre_comp()
+{
+	static SM9_SIGN_PRE_COMP sign_pre_comp;
+	static SM9_ENC_PRE_COMP enc_pre_comp;
+	static SM9_ENC_KEY_PRE_COMP key_pre_comp;
+	static SM9_ENC_KEY_PRE_COMP keyA_pre_comp;
+	static SM9_ENC_KEY_PRE_COMP keyB_pre_comp;
+	SM9_SIGN_MASTER_KEY sign_msk;
+	SM9_SIGN_KEY sign_key;
+	SM9_SIGN_CTX ctx;
+	SM9_ENC_MASTER_KEY enc_msk;
+	SM9_ENC_KEY enc_key;
+	SM9_EXCH_MASTER_KEY exch_msk;
+	SM9_EXCH_KEY keyA, keyB;
+	SM9_Z256_POINT RA, RB;
+	sm9_z256_t rA;
+	uint8_t sig[SM9_SIGNATURE_SIZE];
+	size_t siglen;
+	uint8_t out[SM9_MAX_CIPHERTEXT_SIZE];
+	size_t outlen;
+	uint8_t dec[20];
+	size_t declen;
+	uint8_t skA[16], skB[16], sk[16];
+	int j = 1;
+
+	uint8_t data[20] = {0x43, 0x68, 0x69, 0x6E, 0x65, 0x73, 0x65, 0x20, 0x49, 0x42, 0x53, 0x20, 0x73, 0x74, 0x61, 0x6E, 0x64, 0x61, 0x72, 0x64};
+	uint8_t idA[5] = {0x41, 0x6C, 0x69, 0x63, 0x65};
+	uint8_t idB[3] = {0x42, 0x6F, 0x62};
+
+	// sign with and without pre_comp, verify with the other one
+	sm9_z256_from_hex(sign_msk.ks, hex_ks); sm9_z256_twist_point_mul_generator(&(sign_msk.Ppubs), sign_msk.ks);
+	if (sm9_sign_master_key_extract_key(&sign_msk, (char *)idA, sizeof(idA), &sign_key) != 1) goto err; ++j;
+	if (sm9_sign_pre_compute(&sign_pre_comp, &sign_msk.Ppubs) != 1) goto err; ++j;
+
+	sm9_sign_init(&ctx);
+	sm9_sign_update(&ctx, data, sizeof(data));
+	if (sm9_sign_finish_ex(&ctx, &sign_key, &sign_pre_comp, sig, &siglen) != 1) goto err; ++j;
+	sm9_verify_init(&ctx);
+	sm9_verify_update(&ctx, data, sizeof(data));
+	if (sm9_verify_finish(&ctx, sig, siglen, &sign_msk, (char *)idA, sizeof(idA)) != 1) goto err; ++j;
+
+	sm9_sign_init(&ctx);
+	sm9_sign_update(&ctx, data, sizeof(data));
+	if (sm9_sign_finish(&ctx, &sign_key, sig, &siglen) != 1) goto err; ++j;
+	sm9_verify_init(&ctx);
+	sm9_verify_update(&ctx, data, sizeof(data));
+	if (sm9_verify_finish_ex(&ctx, sig, siglen, &sign_msk, &sign_pre_comp, (char *)idA, sizeof(idA)) != 1) goto err; ++j;
+
+	sm9_verify_init(&ctx);
+	sm9_verify_update(&ctx, data, sizeof(data) - 1);
+	if (sm9_verify_finish_ex(&ctx, sig, siglen, &sign_msk, &sign_pre_comp, (char *)idA, sizeof(idA)) != 0) goto err; ++j;
+
+	// encrypt with and without pre_comp, decrypt with the other one
+	sm9_z256_from_hex(enc_msk.ke, hex_ke);
+	sm9_z256_point_mul_generator(&(enc_msk.Ppube), enc_msk.ke);
+	if (sm9_enc_master_key_extract_key(&enc_msk, (char *)idB, sizeof(idB), &enc_key) != 1) goto err; ++j;
+	if (sm9_enc_pre_compute(&enc_pre_comp, &enc_msk.Ppube) != 1) goto err; ++j;
+	if (sm9_enc_key_pre_compute(&key_pre_comp, &enc_key) != 1) goto err; ++j;
+
+	if (sm9_encrypt_ex(&enc_msk, &enc_pre_comp, (char *)idB, sizeof(idB), data, sizeof(data), out, &outlen) != 1) goto err; ++j;
+	if (sm9_decrypt(&enc_key, (char *)idB, sizeof(idB), out, outlen, dec, &declen) != 1) goto err; ++j;
+	if (declen != sizeof(data) || memcmp(data, dec, sizeof(data)) != 0) goto err; ++j;
+
+	if (sm9_encrypt(&enc_msk, (char *)idB, sizeof(idB), data, sizeof(data), out, &outlen) != 1) goto err; ++j;
+	if (sm9_decrypt_ex(&enc_key, &key_pre_comp, (char *)idB, sizeof(idB), out, outlen, dec, &declen) != 1) goto err; ++j;
+	if (declen != sizeof(data) || memcmp(data, dec, sizeof(data)) != 0) goto err; ++j;
+
+	// key exchange, the random numbers are fixed in sm9_exch.c, so the keys must equal the ones without pre_comp
+	sm9_z256_from_hex(exch_msk.ke, hex_kex);
+	sm9_z256_point_mul_generator(&(exch_msk.Ppube), exch_msk.ke);
+	if (sm9_exch_master_key_extract_key(&exch_msk, (char *)idA, sizeof(idA), &keyA) != 1) goto err; ++j;
+	if (sm9_exch_master_key_extract_key(&exch_msk, (char *)idB, sizeof(idB), &keyB) != 1) goto err; ++j;
+	if (sm9_enc_pre_compute(&enc_pre_comp, &exch_msk.Ppube) != 1) goto err; ++j;
+	if (sm9_enc_key_pre_compute(&keyA_pre_comp, &keyA) != 1) goto err; ++j;
+	if (sm9_enc_key_pre_compute(&keyB_pre_comp, &keyB) != 1) goto err; ++j;
+
+	if (sm9_exch_step_1A(&exch_msk, (char *)idB, sizeof(idB), &RA, rA) != 1) goto err; ++j;
+	if (sm9_exch_step_1B_ex(&exch_msk, &enc_pre_comp, (char *)idA, sizeof(idA), (char *)idB, sizeof(idB),
+		&keyB, &keyB_pre_comp, &RA, &RB, skB, sizeof(skB)) != 1) goto err; ++j;
+	if (sm9_exch_step_2A_ex(&exch_msk, &enc_pre_comp, (char *)idA, sizeof(idA), (char *)idB, sizeof(idB),
+		&keyA, &keyA_pre_comp, rA, &RA, &RB, skA, sizeof(skA)) != 1) goto err; ++j;
+	if (memcmp(skA, skB, sizeof(skA)) != 0) goto err; ++j;
+	if (sm9_exch_step_2A(&exch_msk, (char *)idA, sizeof(idA), (char *)idB, sizeof(idB),
+		&keyA, rA, &RA, &RB, sk, sizeof(sk)) != 1) goto err; ++j;
+	if (memcmp(sk, skA, sizeof(sk)) != 0) goto err; ++j;
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+err:
+	printf("%s test %d failed\n", __FUNCTION__, j);
+	error_print();
+	return -1;
+}
+
 int main(void) {
 	if (test_sm9_z256_fp() != 1) goto err;
 	if (test_sm9_z256_fn() != 1) goto err;
@@ -841,10 +1013,13 @@ int main(void) {
 	if (test_sm9_z256_point() != 1) goto err;
 	if (test_sm9_z256_twist_point() != 1) goto err;
 	if (test_sm9_z256_pairing() != 1) goto err;
+	if (test_sm9_z256_fp12_pow_table() != 1) goto err;
+	if (test_sm9_z256_pairing_lines() != 1) goto err;
 	if (test_sm9_z256_sign() != 1) goto err;
 	if (test_sm9_z256_ciphertext() != 1) goto err;
 	if (test_sm9_z256_encrypt() != 1) goto err;
 	if (test_sm9_z256_exchange() != 1) goto err;
+	if (test_sm9_z256_pre_comp() != 1) goto err;
 	if (test_sm9_z256_pairing_speed() != 1) goto err;
 
 	printf("%s all tests passed\n", __FILE__);
@@ -13,6 +13,8 @@
 #include <stdlib.h>
 #include <time.h>
 #include <gmssl/zuc.h>
+#include <gmssl/rand.h>
+#include <gmssl/endian.h>
 #include <gmssl/error.h>
 
 
@@ -467,6 +469,220 @@ static int test_zuc256_mac(void)
 	return 1;
 }
 
+// bit by bit folding of EIA3, as the MAC was computed before it took a word per step
+static void zuc_mac_bitwise(ZUC_MAC_CTX *ctx, const uint8_t *data, size_t nbits, uint8_t mac[4])
+{
+	ZUC_UINT32 T = ctx->T;
+	ZUC_UINT32 K0 = ctx->K0;
+	ZUC_UINT32 K1 = 0;
+	size_t i;
+
+	for (i = 0; i < nbits; i++) {
+		if (i % 32 == 0) {
+			K1 = zuc_generate_keyword((ZUC_STATE *)ctx);
+		}
+		if (data[i / 8] & (0x80 >> (i % 8))) {
+			T ^= K0;
+		}
+		K0 = (K0 << 1) | (K1 >> 31);
+		K1 <<= 1;
+	}
+	T ^= K0;
+	T ^= zuc_generate_keyword((ZUC_STATE *)ctx);
+	PUTU32(mac, T);
+}
+
+static void zuc256_mac_bitwise(ZUC256_MAC_CTX *ctx, const uint8_t *data, size_t nbits, uint8_t *mac)
+{
+	size_t n = ctx->macbits / 32;
+	ZUC_UINT32 K1 = 0;
+	size_t i, j;
+
+	for (i = 0; i < nbits; i++) {
+		if (i % 32 == 0) {
+			K1 = zuc256_generate_keyword((ZUC256_STATE *)ctx);
+		}
+		if (data[i / 8] & (0x80 >> (i % 8))) {
+			for (j = 0; j < n; j++) {
+				ctx->T[j] ^= ctx->K0[j];
+			}
+		}
+		for (j = 0; j < n - 1; j++) {
+			ctx->K0[j] = (ctx->K0[j] << 1) | (ctx->K0[j + 1] >> 31);
+		}
+		ctx->K0[j] = (ctx->K0[j] << 1) | (K1 >> 31);
+		K1 <<= 1;
+	}
+	for (j = 0; j < n; j++) {
+		PUTU32(mac + 4 * j, ctx->T[j] ^ ctx->K0[j]);
+	}
+}
+
+static int test_zuc_mac_bitwise(void)
+{
+	// keys and IVs of the GM/T 0001.3-2012 vectors, then random ones
+	uint8_t key[4][16] = {
+		{0},
+		{0xc9, 0xe6, 0xce, 0xc4, 0x60, 0x7c, 0x72, 0xdb,
+		 0x00, 0x0a, 0xef, 0xa8, 0x83, 0x85, 0xab, 0x0a},
+		{0x6b, 0x8b, 0x08, 0xee, 0x79, 0xe0, 0xb5, 0x98,
+		 0x2d, 0x6d, 0x12, 0x8e, 0xa9, 0xf2, 0x20, 0xcb},
+	};
+	uint8_t iv[4][16] = {
+		{0},
+		{0xa9, 0x40, 0x59, 0xda, 0x50, 0x00, 0x00, 0x00,
+		 0x29, 0x40, 0x59, 0xda, 0x50, 0x00, 0x80, 0x00},
+		{0x56, 0x1e, 0xb2, 0xdd, 0xe0, 0x00, 0x00, 0x00,
+		 0x56, 0x1e, 0xb2, 0xdd, 0xe0, 0x00, 0x00, 0x00},
+	};
+	uint8_t key256[32];
+	uint8_t iv256[23];
+	size_t nbits[] = {0, 1, 7, 8, 31, 32, 33, 63, 64, 65, 100, 255, 256, 0x241, 0x1626, 8000};
+	int macbits[] = {32, 64, 128};
+	uint8_t msg[1000];
+	uint8_t mac[16];
+	uint8_t ref[16];
+	size_t i, j, k, len, off, n;
+
+	rand_bytes(key[3], sizeof(key[3]));
+	rand_bytes(iv[3], sizeof(iv[3]));
+	rand_bytes(key256, sizeof(key256));
+	rand_bytes(iv256, sizeof(iv256));
+	for (off = 0; off < sizeof(msg); off += 250) {
+		rand_bytes(msg + off, 250);
+	}
+
+	for (i = 0; i < sizeof(key)/sizeof(key[0]); i++) {
+		for (j = 0; j < sizeof(nbits)/sizeof(nbits[0]); j++) {
+			ZUC_MAC_CTX ctx;
+
+			zuc_mac_init(&ctx, key[i], iv[i]);
+			zuc_mac_bitwise(&ctx, msg, nbits[j], ref);
+
+			// whole bytes in pieces of 1 to 9 bytes, so the buffered word is exercised
+			zuc_mac_init(&ctx, key[i], iv[i]);
+			len = nbits[j] / 8;
+			for (off = 0; off < len; off += n) {
+				n = 1 + (off * 7 + j) % 9;
+				if (n > len - off) {
+					n = len - off;
+				}
+				zuc_mac_update(&ctx, msg + off, n);
+			}
+			zuc_mac_finish(&ctx, msg + len, nbits[j] % 8, mac);
+			if (memcmp(mac, ref, 4) != 0) {
+				printf("zuc mac key %zu, %zu bits differs from the bitwise one\n", i, nbits[j]);
+				error_print();
+				return -1;
+			}
+		}
+	}
+
+	for (k = 0; k < sizeof(macbits)/sizeof(macbits[0]); k++) {
+		for (j = 0; j < sizeof(nbits)/sizeof(nbits[0]); j++) {
+			ZUC256_MAC_CTX ctx;
+
+			zuc256_mac_init(&ctx, key256, iv256, macbits[k]);
+			zuc256_mac_bitwise(&ctx, msg, nbits[j], ref);
+
+			zuc256_mac_init(&ctx, key256, iv256, macbits[k]);
+			len = nbits[j] / 8;
+			for (off = 0; off < len; off += n) {
+				n = 1 + (off * 5 + j) % 11;
+				if (n > len - off) {
+					n = len - off;
+				}
+				zuc256_mac_update(&ctx, msg + off, n);
+			}
+			zuc256_mac_finish(&ctx, msg + len, nbits[j] % 8, mac);
+			if (memcmp(mac, ref, macbits[k] / 8) != 0) {
+				printf("zuc256 %d-bit mac, %zu bits differs from the bitwise one\n", macbits[k], nbits[j]);
+				error_print();
+				return -1;
+			}
+		}
+	}
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+}
+
+static int test_zuc_multi(void)
+{
+	// lanes 0 to 2 run the keys of test_zuc()
+	uint8_t key[ZUC_MULTI_MAX_LANES][32] = {
+		{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+		{0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff},
+		{0x3d,0x4c,0x4b,0xe9,0x6a,0x82,0xfd,0xae,0xb5,0x8f,0x64,0x1d,0xb1,0x7b,0x45,0x5b},
+	};
+	uint8_t iv[ZUC_MULTI_MAX_LANES][23] = {
+		{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+		{0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff},
+		{0x84,0x31,0x9a,0xa8,0xde,0x69,0x15,0xca,0x1f,0x6b,0xda,0x6b,0xfb,0xd8,0xc7,0x66},
+	};
+	uint32_t first[3][2] = {
+		{0x27bede74, 0x018082da},
+		{0x0657cfa0, 0x7096398b},
+		{0x14f1c272, 0x3279c419},
+	};
+	size_t lanes[] = {1, 3, 4, 8, 9, 16};
+	size_t chunks[] = {2, 1, 5, 16, 37, 100};
+	ZUC_STATE state[ZUC_MULTI_MAX_LANES];
+	ZUC_MULTI_STATE multi;
+	uint32_t buf[ZUC_MULTI_MAX_LANES][100];
+	uint32_t ref[100];
+	uint32_t *out[ZUC_MULTI_MAX_LANES];
+	size_t i, j, l;
+
+	for (l = 3; l < ZUC_MULTI_MAX_LANES; l++) {
+		rand_bytes(key[l], sizeof(key[l]));
+		rand_bytes(iv[l], sizeof(iv[l]));
+	}
+	for (l = 0; l < ZUC_MULTI_MAX_LANES; l++) {
+		out[l] = buf[l];
+	}
+
+	if (zuc_multi_init(&multi, state, 0) != -1
+		|| zuc_multi_init(&multi, state, ZUC_MULTI_MAX_LANES + 1) != -1) {
+		error_print();
+		return -1;
+	}
+
+	for (i = 0; i < sizeof(lanes)/sizeof(lanes[0]); i++) {
+		// ZUC-256 from lane 8 on, the streams are independent
+		for (l = 0; l < lanes[i]; l++) {
+			if (l < 8) {
+				zuc_init(&state[l], key[l], iv[l]);
+			} else {
+				zuc256_init(&state[l], key[l], iv[l]);
+			}
+		}
+		if (zuc_multi_init(&multi, state, lanes[i]) != 1) {
+			error_print();
+			return -1;
+		}
+
+		for (j = 0; j < sizeof(chunks)/sizeof(chunks[0]); j++) {
+			zuc_multi_generate_keystream(&multi, chunks[j], out);
+			for (l = 0; l < lanes[i]; l++) {
+				zuc_generate_keystream(&state[l], chunks[j], ref);
+				if (memcmp(buf[l], ref, chunks[j] * sizeof(uint32_t)) != 0) {
+					printf("zuc %zu lanes, lane %zu differs from zuc_generate_keystream()\n", lanes[i], l);
+					error_print();
+					return -1;
+				}
+				if (j == 0 && l < 3 && (buf[l][0] != first[l][0] || buf[l][1] != first[l][1])) {
+					error_print();
+					return -1;
+				}
+			}
+		}
+	}
+
+	printf("%s() ok\n", __FUNCTION__);
+	return 1;
+}
+
 static int speed_zuc_generate_keystream(void)
 {
 	ZUC_STATE zuc_state;
@@ -522,6 +738,78 @@ static int speed_zuc_encrypt(void)
 	return 1;
 }
 
+static int speed_zuc_mac(void)
+{
+	ZUC_MAC_CTX ctx;
+	uint8_t key[16] = {0};
+	uint8_t iv[16] = {0};
+	uint32_t align_buf[1024];
+	uint8_t *buf = (uint8_t *)align_buf;
+	uint8_t mac[4];
+	clock_t begin, end;
+	double seconds;
+	int i;
+
+	memset(align_buf, 0x5a, sizeof(align_buf));
+	zuc_mac_init(&ctx, key, iv);
+	begin = clock();
+	for (i = 0; i < 4096; i++) {
+		zuc_mac_update(&ctx, buf, 4096);
+	}
+	end = clock();
+	zuc_mac_finish(&ctx, NULL, 0, mac);
+
+	seconds = (double)(end - begin)/CLOCKS_PER_SEC;
+	fprintf(stderr, "%s: %f-MiB per second\n", __FUNCTION__, 16/seconds);
+
+	zuc_mac_init(&ctx, key, iv);
+	begin = clock();
+	for (i = 0; i < 256; i++) {
+		zuc_mac_bitwise(&ctx, buf, 4096 * 8, mac);
+	}
+	end = clock();
+
+	seconds = (double)(end - begin)/CLOCKS_PER_SEC;
+	fprintf(stderr, "%s: bitwise %f-MiB per second\n", __FUNCTION__, 1/seconds);
+
+	return 1;
+}
+
+static int speed_zuc_multi_generate_keystream(void)
+{
+	ZUC_STATE state[ZUC_MULTI_MAX_LANES];
+	ZUC_MULTI_STATE multi;
+	uint8_t key[16] = {0};
+	uint8_t iv[16] = {0};
+	uint32_t buf[ZUC_MULTI_MAX_LANES][256];
+	uint32_t *out[ZUC_MULTI_MAX_LANES];
+	size_t lanes[] = {4, 8, 16};
+	clock_t begin, end;
+	double seconds;
+	size_t i, l;
+	int j;
+
+	for (l = 0; l < ZUC_MULTI_MAX_LANES; l++) {
+		iv[0] = (uint8_t)l;
+		zuc_init(&state[l], key, iv);
+		out[l] = buf[l];
+	}
+
+	for (i = 0; i < sizeof(lanes)/sizeof(lanes[0]); i++) {
+		zuc_multi_init(&multi, state, lanes[i]);
+		begin = clock();
+		for (j = 0; j < 16384 / (int)lanes[i]; j++) {
+			zuc_multi_generate_keystream(&multi, 256, out);
+		}
+		end = clock();
+
+		seconds = (double)(end - begin)/CLOCKS_PER_SEC;
+		fprintf(stderr, "%s: %zu lanes %f-MiB per second\n", __FUNCTION__, lanes[i], 16/seconds);
+	}
+
+	return 1;
+}
+
 int main(void)
 {
 	if (test_zuc() != 1) goto err;
@@ -529,9 +817,13 @@ int main(void)
 	if (test_zuc_eia() != 1) goto err;
 	if (test_zuc256() != 1) goto err;
 	if (test_zuc256_mac() != 1) goto err;
+	if (test_zuc_mac_bitwise() != 1) goto err;
+	if (test_zuc_multi() != 1) goto err;
 #if ENABLE_TEST_SPEED
 	if (speed_zuc_generate_keystream() != 1) goto err;
 	if (speed_zuc_encrypt() != 1) goto err;
+	if (speed_zuc_mac() != 1) goto err;
+	if (speed_zuc_multi_generate_keystream() != 1) goto err;
 #endif
 	printf("%s all tests passed\n", __FILE__);
 	return 0;
@@ -15,6 +15,7 @@
 
 extern int version_main(int argc, char **argv);
 extern int rand_main(int argc, char **argv);
+extern int speed_main(int argc, char **argv);
 extern int certgen_main(int argc, char **argv);
 extern int certparse_main(int argc, char **argv);
 extern int certverify_main(int argc, char **argv);
@@ -86,6 +87,7 @@ static const char *options =
 	"  help              Print this help message\n"
 	"  version           Print version\n"
 	"  rand              Generate random bytes\n"
+	"  speed             Benchmark algorithms and print throughput\n"
 	"  sm2keygen         Generate SM2 keypair\n"
 	"  sm2sign           Generate SM2 signature\n"
 	"  sm2verify         Verify SM2 signature\n"
@@ -174,6 +176,8 @@ int main(int argc, char **argv)
 			return version_main(argc, argv);
 		} else if (!strcmp(*argv, "rand")) {
 			return rand_main(argc, argv);
+		} else if (!strcmp(*argv, "speed")) {
+			return speed_main(argc, argv);
 		} else if (!strcmp(*argv, "certgen")) {
 			return certgen_main(argc, argv);
 		} else if (!strcmp(*argv, "certparse")) {
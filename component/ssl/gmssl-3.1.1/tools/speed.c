@@ -0,0 +1,1016 @@
+/*
+ *  Copyright 2014-2024 The GmSSL Project. All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the License); you may
+ *  not use this file except in compliance with the License.
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <gmssl/sm2.h>
+#include <gmssl/sm3.h>
+#include <gmssl/sm4.h>
+#include <gmssl/sm9.h>
+#include <gmssl/zuc.h>
+#include <gmssl/aes.h>
+#include <gmssl/sha2.h>
+#include <gmssl/chacha20.h>
+#include <gmssl/mem.h>
+#include <gmssl/rand.h>
+#include <gmssl/version.h>
+#include <gmssl/error.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define SPEED_HAVE_PTHREAD 1
+#include <pthread.h>
+#endif
+
+
+static const char *usage = "[-algs alg,...] [-sizes num,...] [-seconds num] [-threads num] [-backend name] [-json] [-out file]\n";
+
+static const char *options =
+"Options\n"
+"\n"
+"    -algs alg,...       Comma separated algorithms to benchmark, default all\n"
+"    -sizes num,...      Comma separated buffer sizes in bytes for symmetric algorithms\n"
+"                        default 16,64,256,1024,8192,16384\n"
+"    -seconds num        Seconds to run every algorithm/size pair, default 1\n"
+"    -threads num        Number of concurrent threads, default 1\n"
+"    -backend name       Fail unless the named SM2/SM3/SM4/SM9/GHASH/ZUC backend is compiled in\n"
+"    -json               Output machine-readable JSON\n"
+"    -out file           Output file, default stdout\n"
+"\n"
+"Algorithms\n"
+"\n"
+"    sm3 sm3_hmac sm4_ecb sm4_cbc sm4_ctr sm4_gcm sm4_xts zuc zuc_eia3 aes128_ctr\n"
+"    aes128_gcm sha256 sha512 chacha20 sm2_sign sm2_verify sm2_verify_pre sm2_encrypt\n"
+"    sm2_decrypt\n"
+"    sm9_sign sm9_verify sm9_encrypt sm9_decrypt sm9_sign_pre sm9_verify_pre\n"
+"    sm9_encrypt_pre sm9_decrypt_pre\n"
+"\n"
+"Examples\n"
+"\n"
+"    $ gmssl speed -algs sm4_ctr,sm4_gcm -sizes 1024,16384 -seconds 3\n"
+"    $ gmssl speed -algs sm2_sign,sm2_verify -threads 4 -json -out speed.json\n"
+"\n";
+
+
+#define SPEED_MAX_SIZES		16
+#define SPEED_MAX_THREADS	64
+#define SPEED_MAX_BUF_SIZE	(1024 * 1024)
+#define SPEED_TIME_CHECK_MASK	63
+
+static const char *speed_backends[] = {
+#if defined(ENABLE_SM4_AESNI_AVX)
+	"sm4_aesni_avx",
+#elif defined(ENABLE_SM4_AVX2)
+	"sm4_avx2",
+#elif defined(ENABLE_SM4_CE)
+	"sm4_ce",
+#elif defined(ENABLE_SM4_ARM64)
+	"sm4_arm64",
+#else
+	"sm4_c",
+#endif
+#if defined(ENABLE_SM3_AVX_BMI2)
+	"sm3_avx_bmi2",
+#elif defined(ENABLE_SM3_ARM64)
+	"sm3_arm64",
+#else
+	"sm3_c",
+#endif
+#if defined(ENABLE_SM2_AMD64)
+	"sm2_amd64",
+#elif defined(ENABLE_SM2_ARM64)
+	"sm2_arm64",
+#elif defined(ENABLE_SM2_Z256_NEON)
+	"sm2_neon",
+#else
+	"sm2_c",
+#endif
+#if defined(ENABLE_SM9_ARM64)
+	"sm9_arm64",
+#elif defined(ENABLE_SM9_AMD64)
+	"sm9_amd64",
+#elif defined(ENABLE_SM9_Z256_NEON)
+	"sm9_neon",
+#else
+	"sm9_c",
+#endif
+#if defined(ENABLE_GMUL_ARM64)
+	"ghash_arm64",
+#else
+	"ghash_c",
+#endif
+#if defined(ENABLE_ZUC_PCLMUL)
+	"zuc_mac_pclmul",
+#else
+	"zuc_mac_c",
+#endif
+#if defined(ENABLE_ZUC_AVX2)
+	"zuc_multi_avx2",
+#else
+	"zuc_multi_c",
+#endif
+};
+
+typedef struct {
+	SM4_KEY sm4_key;
+	SM4_KEY sm4_key2;
+	SM3_HMAC_CTX sm3_hmac_ctx;
+	ZUC_STATE zuc_state;
+	AES_KEY aes_key;
+	CHACHA20_STATE chacha20_state;
+	SM2_KEY sm2_key;
+	uint8_t sm2_sig[SM2_MAX_SIGNATURE_SIZE];
+	size_t sm2_siglen;
+	SM2_VERIFY_PRE_COMP sm2_verify_pre_comp;
+	uint8_t sm2_ciphertext[SM2_MAX_CIPHERTEXT_SIZE];
+	size_t sm2_ciphertext_len;
+	SM9_SIGN_MASTER_KEY sm9_sign_master;
+	SM9_SIGN_KEY sm9_sign_key;
+	uint8_t sm9_sig[SM9_SIGNATURE_SIZE];
+	size_t sm9_siglen;
+	SM9_ENC_MASTER_KEY sm9_enc_master;
+	SM9_ENC_KEY sm9_enc_key;
+	uint8_t sm9_ciphertext[SM9_MAX_CIPHERTEXT_SIZE];
+	size_t sm9_ciphertext_len;
+	SM9_SIGN_PRE_COMP sm9_sign_pre_comp;
+	SM9_ENC_PRE_COMP sm9_enc_pre_comp;
+	SM9_ENC_KEY_PRE_COMP sm9_enc_key_pre_comp;
+	uint8_t key[32];
+	uint8_t iv[32];
+	uint8_t dgst[64];
+} SPEED_CTX;
+
+typedef struct {
+	const char *name;
+	int bulk; // 1: throughput over a buffer, 0: operations per second
+	int (*setup)(SPEED_CTX *ctx);
+	int (*run)(SPEED_CTX *ctx, uint8_t *buf, size_t len);
+} SPEED_ALG;
+
+static const char *speed_sm9_id = "Alice";
+
+
+static int setup_sm4(SPEED_CTX *ctx)
+{
+	sm4_set_encrypt_key(&ctx->sm4_key, ctx->key);
+	sm4_set_encrypt_key(&ctx->sm4_key2, ctx->key + 16);
+	return 1;
+}
+
+static int run_sm3(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	SM3_CTX sm3_ctx;
+	sm3_init(&sm3_ctx);
+	sm3_update(&sm3_ctx, buf, len);
+	sm3_finish(&sm3_ctx, ctx->dgst);
+	return 1;
+}
+
+static int run_sm3_hmac(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	sm3_hmac_init(&ctx->sm3_hmac_ctx, ctx->key, 16);
+	sm3_hmac_update(&ctx->sm3_hmac_ctx, buf, len);
+	sm3_hmac_finish(&ctx->sm3_hmac_ctx, ctx->dgst);
+	return 1;
+}
+
+static int run_sm4_ecb(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	sm4_encrypt_blocks(&ctx->sm4_key, buf, len/SM4_BLOCK_SIZE, buf);
+	return 1;
+}
+
+static int run_sm4_cbc(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	sm4_cbc_encrypt_blocks(&ctx->sm4_key, ctx->iv, buf, len/SM4_BLOCK_SIZE, buf);
+	return 1;
+}
+
+static int run_sm4_ctr(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	sm4_ctr_encrypt(&ctx->sm4_key, ctx->iv, buf, len, buf);
+	return 1;
+}
+
+static int run_sm4_gcm(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	if (sm4_gcm_encrypt(&ctx->sm4_key, ctx->iv, SM4_GCM_DEFAULT_IV_SIZE, NULL, 0,
+		buf, len, buf, SM4_GCM_DEFAULT_TAG_SIZE, ctx->dgst) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+#ifdef ENABLE_SM4_XTS
+static int run_sm4_xts(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	if (sm4_xts_encrypt(&ctx->sm4_key, &ctx->sm4_key2, ctx->iv, buf, len, buf) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+#endif
+
+static int setup_zuc(SPEED_CTX *ctx)
+{
+	zuc_init(&ctx->zuc_state, ctx->key, ctx->iv);
+	return 1;
+}
+
+static int run_zuc(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	zuc_encrypt(&ctx->zuc_state, buf, len, buf);
+	return 1;
+}
+
+static int run_zuc_eia3(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	ZUC_MAC_CTX mac_ctx;
+	zuc_mac_init(&mac_ctx, ctx->key, ctx->iv);
+	zuc_mac_update(&mac_ctx, buf, len);
+	zuc_mac_finish(&mac_ctx, NULL, 0, ctx->dgst);
+	return 1;
+}
+
+#ifdef ENABLE_AES
+static int setup_aes(SPEED_CTX *ctx)
+{
+	if (aes_set_encrypt_key(&ctx->aes_key, ctx->key, 16) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_aes_ctr(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	aes_ctr_encrypt(&ctx->aes_key, ctx->iv, buf, len, buf);
+	return 1;
+}
+
+static int run_aes_gcm(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	if (aes_gcm_encrypt(&ctx->aes_key, ctx->iv, 12, NULL, 0, buf, len, buf, 16, ctx->dgst) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+#endif
+
+#ifdef ENABLE_SHA2
+static int run_sha256(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	SHA256_CTX sha256_ctx;
+	sha256_init(&sha256_ctx);
+	sha256_update(&sha256_ctx, buf, len);
+	sha256_finish(&sha256_ctx, ctx->dgst);
+	return 1;
+}
+
+static int run_sha512(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	SHA512_CTX sha512_ctx;
+	sha512_init(&sha512_ctx);
+	sha512_update(&sha512_ctx, buf, len);
+	sha512_finish(&sha512_ctx, ctx->dgst);
+	return 1;
+}
+#endif
+
+#ifdef ENABLE_CHACHA20
+static int setup_chacha20(SPEED_CTX *ctx)
+{
+	chacha20_init(&ctx->chacha20_state, ctx->key, ctx->iv, 1);
+	return 1;
+}
+
+static int run_chacha20(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	// output keystream only, the XOR with plaintext is negligible
+	chacha20_generate_keystream(&ctx->chacha20_state, len/64, buf);
+	return 1;
+}
+#endif
+
+static int setup_sm2(SPEED_CTX *ctx)
+{
+	if (sm2_key_generate(&ctx->sm2_key) != 1
+		|| sm2_sign(&ctx->sm2_key, ctx->dgst, ctx->sm2_sig, &ctx->sm2_siglen) != 1
+		|| sm2_encrypt(&ctx->sm2_key, ctx->key, 32, ctx->sm2_ciphertext, &ctx->sm2_ciphertext_len) != 1
+		|| sm2_verify_pre_compute(&ctx->sm2_verify_pre_comp, &ctx->sm2_key) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm2_sign(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	uint8_t sig[SM2_MAX_SIGNATURE_SIZE];
+	size_t siglen;
+	(void)buf;
+	(void)len;
+	if (sm2_sign(&ctx->sm2_key, ctx->dgst, sig, &siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm2_verify(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	(void)buf;
+	(void)len;
+	if (sm2_verify(&ctx->sm2_key, ctx->dgst, ctx->sm2_sig, ctx->sm2_siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm2_verify_pre(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	(void)buf;
+	(void)len;
+	if (sm2_verify_ex(&ctx->sm2_verify_pre_comp, ctx->dgst, ctx->sm2_sig, ctx->sm2_siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm2_encrypt(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	uint8_t out[SM2_MAX_CIPHERTEXT_SIZE];
+	size_t outlen;
+	(void)buf;
+	(void)len;
+	if (sm2_encrypt(&ctx->sm2_key, ctx->key, 32, out, &outlen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm2_decrypt(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	uint8_t out[SM2_MAX_PLAINTEXT_SIZE];
+	size_t outlen;
+	(void)buf;
+	(void)len;
+	if (sm2_decrypt(&ctx->sm2_key, ctx->sm2_ciphertext, ctx->sm2_ciphertext_len, out, &outlen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int setup_sm9(SPEED_CTX *ctx)
+{
+	SM9_SIGN_CTX sign_ctx;
+	size_t idlen = strlen(speed_sm9_id);
+
+	if (sm9_sign_master_key_generate(&ctx->sm9_sign_master) != 1
+		|| sm9_sign_master_key_extract_key(&ctx->sm9_sign_master, speed_sm9_id, idlen, &ctx->sm9_sign_key) != 1
+		|| sm9_enc_master_key_generate(&ctx->sm9_enc_master) != 1
+		|| sm9_enc_master_key_extract_key(&ctx->sm9_enc_master, speed_sm9_id, idlen, &ctx->sm9_enc_key) != 1) {
+		error_print();
+		return -1;
+	}
+	if (sm9_sign_init(&sign_ctx) != 1
+		|| sm9_sign_update(&sign_ctx, ctx->dgst, 32) != 1
+		|| sm9_sign_finish(&sign_ctx, &ctx->sm9_sign_key, ctx->sm9_sig, &ctx->sm9_siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	if (sm9_encrypt(&ctx->sm9_enc_master, speed_sm9_id, idlen, ctx->key, 32,
+		ctx->sm9_ciphertext, &ctx->sm9_ciphertext_len) != 1) {
+		error_print();
+		return -1;
+	}
+	if (sm9_sign_pre_compute(&ctx->sm9_sign_pre_comp, &ctx->sm9_sign_master.Ppubs) != 1
+		|| sm9_enc_pre_compute(&ctx->sm9_enc_pre_comp, &ctx->sm9_enc_master.Ppube) != 1
+		|| sm9_enc_key_pre_compute(&ctx->sm9_enc_key_pre_comp, &ctx->sm9_enc_key) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_sign(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	SM9_SIGN_CTX sign_ctx;
+	uint8_t sig[SM9_SIGNATURE_SIZE];
+	size_t siglen;
+	(void)buf;
+	(void)len;
+
+	if (sm9_sign_init(&sign_ctx) != 1
+		|| sm9_sign_update(&sign_ctx, ctx->dgst, 32) != 1
+		|| sm9_sign_finish(&sign_ctx, &ctx->sm9_sign_key, sig, &siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_verify(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	SM9_SIGN_CTX verify_ctx;
+	(void)buf;
+	(void)len;
+
+	if (sm9_verify_init(&verify_ctx) != 1
+		|| sm9_verify_update(&verify_ctx, ctx->dgst, 32) != 1
+		|| sm9_verify_finish(&verify_ctx, ctx->sm9_sig, ctx->sm9_siglen,
+			&ctx->sm9_sign_master, speed_sm9_id, strlen(speed_sm9_id)) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_encrypt(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	uint8_t out[SM9_MAX_CIPHERTEXT_SIZE];
+	size_t outlen;
+	(void)buf;
+	(void)len;
+
+	if (sm9_encrypt(&ctx->sm9_enc_master, speed_sm9_id, strlen(speed_sm9_id),
+		ctx->key, 32, out, &outlen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_decrypt(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	uint8_t out[SM9_MAX_PLAINTEXT_SIZE];
+	size_t outlen;
+	(void)buf;
+	(void)len;
+
+	if (sm9_decrypt(&ctx->sm9_enc_key, speed_sm9_id, strlen(speed_sm9_id),
+		ctx->sm9_ciphertext, ctx->sm9_ciphertext_len, out, &outlen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_sign_pre(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	SM9_SIGN_CTX sign_ctx;
+	uint8_t sig[SM9_SIGNATURE_SIZE];
+	size_t siglen;
+	(void)buf;
+	(void)len;
+
+	if (sm9_sign_init(&sign_ctx) != 1
+		|| sm9_sign_update(&sign_ctx, ctx->dgst, 32) != 1
+		|| sm9_sign_finish_ex(&sign_ctx, &ctx->sm9_sign_key, &ctx->sm9_sign_pre_comp, sig, &siglen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_verify_pre(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	SM9_SIGN_CTX verify_ctx;
+	(void)buf;
+	(void)len;
+
+	if (sm9_verify_init(&verify_ctx) != 1
+		|| sm9_verify_update(&verify_ctx, ctx->dgst, 32) != 1
+		|| sm9_verify_finish_ex(&verify_ctx, ctx->sm9_sig, ctx->sm9_siglen,
+			&ctx->sm9_sign_master, &ctx->sm9_sign_pre_comp, speed_sm9_id, strlen(speed_sm9_id)) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_encrypt_pre(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	uint8_t out[SM9_MAX_CIPHERTEXT_SIZE];
+	size_t outlen;
+	(void)buf;
+	(void)len;
+
+	if (sm9_encrypt_ex(&ctx->sm9_enc_master, &ctx->sm9_enc_pre_comp, speed_sm9_id, strlen(speed_sm9_id),
+		ctx->key, 32, out, &outlen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int run_sm9_decrypt_pre(SPEED_CTX *ctx, uint8_t *buf, size_t len)
+{
+	uint8_t out[SM9_MAX_PLAINTEXT_SIZE];
+	size_t outlen;
+	(void)buf;
+	(void)len;
+
+	if (sm9_decrypt_ex(&ctx->sm9_enc_key, &ctx->sm9_enc_key_pre_comp, speed_sm9_id, strlen(speed_sm9_id),
+		ctx->sm9_ciphertext, ctx->sm9_ciphertext_len, out, &outlen) != 1) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static const SPEED_ALG speed_algs[] = {
+	{ "sm3",		1, NULL,		run_sm3 },
+	{ "sm3_hmac",		1, NULL,		run_sm3_hmac },
+	{ "sm4_ecb",		1, setup_sm4,		run_sm4_ecb },
+	{ "sm4_cbc",		1, setup_sm4,		run_sm4_cbc },
+	{ "sm4_ctr",		1, setup_sm4,		run_sm4_ctr },
+	{ "sm4_gcm",		1, setup_sm4,		run_sm4_gcm },
+#ifdef ENABLE_SM4_XTS
+	{ "sm4_xts",		1, setup_sm4,		run_sm4_xts },
+#endif
+	{ "zuc",		1, setup_zuc,		run_zuc },
+	{ "zuc_eia3",		1, NULL,		run_zuc_eia3 },
+#ifdef ENABLE_AES
+	{ "aes128_ctr",		1, setup_aes,		run_aes_ctr },
+	{ "aes128_gcm",		1, setup_aes,		run_aes_gcm },
+#endif
+#ifdef ENABLE_SHA2
+	{ "sha256",		1, NULL,		run_sha256 },
+	{ "sha512",		1, NULL,		run_sha512 },
+#endif
+#ifdef ENABLE_CHACHA20
+	{ "chacha20",		1, setup_chacha20,	run_chacha20 },
+#endif
+	{ "sm2_sign",		0, setup_sm2,		run_sm2_sign },
+	{ "sm2_verify",		0, setup_sm2,		run_sm2_verify },
+	{ "sm2_verify_pre",	0, setup_sm2,		run_sm2_verify_pre },
+	{ "sm2_encrypt",	0, setup_sm2,		run_sm2_encrypt },
+	{ "sm2_decrypt",	0, setup_sm2,		run_sm2_decrypt },
+	{ "sm9_sign",		0, setup_sm9,		run_sm9_sign },
+	{ "sm9_verify",		0, setup_sm9,		run_sm9_verify },
+	{ "sm9_encrypt",	0, setup_sm9,		run_sm9_encrypt },
+	{ "sm9_decrypt",	0, setup_sm9,		run_sm9_decrypt },
+	{ "sm9_sign_pre",	0, setup_sm9,		run_sm9_sign_pre },
+	{ "sm9_verify_pre",	0, setup_sm9,		run_sm9_verify_pre },
+	{ "sm9_encrypt_pre",	0, setup_sm9,		run_sm9_encrypt_pre },
+	{ "sm9_decrypt_pre",	0, setup_sm9,		run_sm9_decrypt_pre },
+};
+
+#define SPEED_NUM_ALGS	(sizeof(speed_algs)/sizeof(speed_algs[0]))
+
+
+static double speed_now(void)
+{
+#ifdef SPEED_HAVE_PTHREAD
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec/1e9;
+#else
+	return (double)clock()/CLOCKS_PER_SEC;
+#endif
+}
+
+// All jobs finish their setup before the clock starts, so key generation and SM9 precomputation
+// of the slower threads are not counted against the faster ones.
+typedef struct {
+#ifdef SPEED_HAVE_PTHREAD
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+#endif
+	int waiting;
+	int total;
+	double begin;
+} SPEED_GATE;
+
+typedef struct {
+	const SPEED_ALG *alg;
+	size_t size;
+	double seconds;
+	SPEED_GATE *gate;
+	uint64_t ops;
+	double end;
+	int ret;
+} SPEED_JOB;
+
+static void speed_gate_open(SPEED_GATE *gate)
+{
+	gate->begin = speed_now();
+#ifdef SPEED_HAVE_PTHREAD
+	pthread_cond_broadcast(&gate->cond);
+#endif
+}
+
+static double speed_gate_wait(SPEED_GATE *gate)
+{
+	double begin;
+
+#ifdef SPEED_HAVE_PTHREAD
+	pthread_mutex_lock(&gate->lock);
+	if (++gate->waiting == gate->total) {
+		speed_gate_open(gate);
+	}
+	while (gate->waiting < gate->total) {
+		pthread_cond_wait(&gate->cond, &gate->lock);
+	}
+	begin = gate->begin;
+	pthread_mutex_unlock(&gate->lock);
+#else
+	gate->waiting++;
+	speed_gate_open(gate);
+	begin = gate->begin;
+#endif
+	return begin;
+}
+
+// a job that could not be started never reaches the gate
+static void speed_gate_leave(SPEED_GATE *gate, int count)
+{
+#ifdef SPEED_HAVE_PTHREAD
+	pthread_mutex_lock(&gate->lock);
+	gate->total -= count;
+	if (gate->waiting == gate->total) {
+		speed_gate_open(gate);
+	}
+	pthread_mutex_unlock(&gate->lock);
+#else
+	gate->total -= count;
+#endif
+}
+
+static void *speed_job_run(void *arg)
+{
+	SPEED_JOB *job = (SPEED_JOB *)arg;
+	SPEED_CTX *ctx = NULL;
+	uint8_t *buf = NULL;
+	double deadline;
+	uint64_t ops = 0;
+	int ready = 0;
+
+	job->ret = -1;
+	if (!(ctx = (SPEED_CTX *)malloc(sizeof(SPEED_CTX)))
+		|| !(buf = (uint8_t *)malloc(job->size ? job->size : 1))) {
+		error_print();
+		goto wait;
+	}
+	memset(ctx, 0, sizeof(SPEED_CTX));
+	if (rand_bytes(ctx->key, sizeof(ctx->key)) != 1
+		|| rand_bytes(ctx->iv, sizeof(ctx->iv)) != 1
+		|| rand_bytes(ctx->dgst, sizeof(ctx->dgst)) != 1) {
+		error_print();
+		goto wait;
+	}
+	memset(buf, 0x5a, job->size ? job->size : 1);
+	if (job->alg->setup && job->alg->setup(ctx) != 1) {
+		error_print();
+		goto wait;
+	}
+	ready = 1;
+
+wait:
+	// a failed job still has to arrive, or the others would wait for it forever
+	deadline = speed_gate_wait(job->gate) + job->seconds;
+	if (!ready) {
+		goto end;
+	}
+	for (;;) {
+		if (job->alg->run(ctx, buf, job->size) != 1) {
+			error_print();
+			goto end;
+		}
+		ops++;
+		if (!job->alg->bulk || job->size >= 1024 || (ops & SPEED_TIME_CHECK_MASK) == 0) {
+			if ((job->end = speed_now()) >= deadline) {
+				break;
+			}
+		}
+	}
+	job->ops = ops;
+	job->ret = 1;
+end:
+	if (ctx) {
+		gmssl_secure_clear(ctx, sizeof(SPEED_CTX));
+		free(ctx);
+	}
+	if (buf) free(buf);
+	return NULL;
+}
+
+static int speed_run(const SPEED_ALG *alg, size_t size, double seconds, int threads,
+	uint64_t *ops, double *elapsed)
+{
+	SPEED_JOB jobs[SPEED_MAX_THREADS];
+	SPEED_GATE gate;
+	double end;
+	int i;
+
+	memset(&gate, 0, sizeof(gate));
+	gate.total = threads;
+	for (i = 0; i < threads; i++) {
+		jobs[i].alg = alg;
+		jobs[i].size = size;
+		jobs[i].seconds = seconds;
+		jobs[i].gate = &gate;
+		jobs[i].ops = 0;
+		jobs[i].end = 0;
+		jobs[i].ret = -1;
+	}
+
+#ifdef SPEED_HAVE_PTHREAD
+	{
+		pthread_t tids[SPEED_MAX_THREADS];
+		int started = 0;
+
+		pthread_mutex_init(&gate.lock, NULL);
+		pthread_cond_init(&gate.cond, NULL);
+		for (i = 1; i < threads; i++) {
+			if (pthread_create(&tids[i], NULL, speed_job_run, &jobs[i]) != 0) {
+				error_print();
+				speed_gate_leave(&gate, threads - i);
+				break;
+			}
+			started++;
+		}
+		speed_job_run(&jobs[0]);
+		for (i = 1; i <= started; i++) {
+			pthread_join(tids[i], NULL);
+		}
+		pthread_cond_destroy(&gate.cond);
+		pthread_mutex_destroy(&gate.lock);
+	}
+#else
+	speed_gate_leave(&gate, threads - 1);
+	speed_job_run(&jobs[0]);
+#endif
+
+	// from the gate to the last job to stop
+	*ops = 0;
+	end = gate.begin;
+	for (i = 0; i < threads; i++) {
+		if (jobs[i].ret != 1) {
+			error_print();
+			return -1;
+		}
+		*ops += jobs[i].ops;
+		if (jobs[i].end > end) {
+			end = jobs[i].end;
+		}
+	}
+	*elapsed = end - gate.begin;
+	return 1;
+}
+
+static int speed_parse_sizes(const char *str, size_t *sizes, size_t *sizes_cnt)
+{
+	char *end;
+	long val;
+
+	*sizes_cnt = 0;
+	while (*str) {
+		val = strtol(str, &end, 10);
+		if (end == str || val <= 0 || val > SPEED_MAX_BUF_SIZE || *sizes_cnt >= SPEED_MAX_SIZES) {
+			error_print();
+			return -1;
+		}
+		sizes[(*sizes_cnt)++] = (size_t)val;
+		str = end;
+		if (*str == ',') str++;
+	}
+	if (!*sizes_cnt) {
+		error_print();
+		return -1;
+	}
+	return 1;
+}
+
+static int speed_alg_selected(const char *algs, const char *name)
+{
+	size_t namelen = strlen(name);
+	const char *p = algs;
+
+	if (!algs) {
+		return 1;
+	}
+	while (*p) {
+		const char *q = strchr(p, ',');
+		size_t len = q ? (size_t)(q - p) : strlen(p);
+		if (len == namelen && !memcmp(p, name, len)) {
+			return 1;
+		}
+		if (!q) break;
+		p = q + 1;
+	}
+	return 0;
+}
+
+// returns the first name in algs that is not in speed_algs, NULL when all are known
+static const char *speed_unknown_alg(const char *algs, size_t *namelen)
+{
+	const char *p = algs;
+	size_t i;
+
+	for (;;) {
+		const char *q = strchr(p, ',');
+		size_t len = q ? (size_t)(q - p) : strlen(p);
+		for (i = 0; i < SPEED_NUM_ALGS; i++) {
+			if (len == strlen(speed_algs[i].name) && !memcmp(p, speed_algs[i].name, len)) {
+				break;
+			}
+		}
+		if (i == SPEED_NUM_ALGS) {
+			*namelen = len;
+			return p;
+		}
+		if (!q) break;
+		p = q + 1;
+	}
+	return NULL;
+}
+
+static int speed_backend_enabled(const char *name)
+{
+	size_t i;
+	for (i = 0; i < sizeof(speed_backends)/sizeof(speed_backends[0]); i++) {
+		if (!strcmp(speed_backends[i], name)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int speed_main(int argc, char **argv)
+{
+	int ret = 1;
+	char *prog = argv[0];
+	char *algs = NULL;
+	char *outfile = NULL;
+	FILE *outfp = stdout;
+	size_t sizes[SPEED_MAX_SIZES] = { 16, 64, 256, 1024, 8192, 16384 };
+	size_t sizes_cnt = 6;
+	double seconds = 1;
+	int threads = 1;
+	int json = 0;
+	int first = 1;
+	size_t i, j;
+
+	argc--;
+	argv++;
+
+	while (argc > 0) {
+		if (!strcmp(*argv, "-help")) {
+			printf("usage: gmssl %s %s\n", prog, usage);
+			printf("%s\n", options);
+			ret = 0;
+			goto end;
+		} else if (!strcmp(*argv, "-algs")) {
+			if (--argc < 1) goto bad;
+			algs = *(++argv);
+			{
+				size_t namelen;
+				const char *name = speed_unknown_alg(algs, &namelen);
+				if (name) {
+					fprintf(stderr, "gmssl %s: unknown algorithm '%.*s' in '-algs'\n", prog, (int)namelen, name);
+					goto end;
+				}
+			}
+		} else if (!strcmp(*argv, "-sizes")) {
+			if (--argc < 1) goto bad;
+			if (speed_parse_sizes(*(++argv), sizes, &sizes_cnt) != 1) {
+				fprintf(stderr, "gmssl %s: invalid '-sizes' value\n", prog);
+				goto end;
+			}
+		} else if (!strcmp(*argv, "-seconds")) {
+			if (--argc < 1) goto bad;
+			seconds = atof(*(++argv));
+			if (seconds <= 0) {
+				fprintf(stderr, "gmssl %s: invalid '-seconds' value\n", prog);
+				goto end;
+			}
+		} else if (!strcmp(*argv, "-threads")) {
+			if (--argc < 1) goto bad;
+			threads = atoi(*(++argv));
+			if (threads < 1 || threads > SPEED_MAX_THREADS) {
+				fprintf(stderr, "gmssl %s: '-threads' should be in [1, %d]\n", prog, SPEED_MAX_THREADS);
+				goto end;
+			}
+#ifndef SPEED_HAVE_PTHREAD
+			if (threads > 1) {
+				fprintf(stderr, "gmssl %s: multiple threads not supported on this platform\n", prog);
+				goto end;
+			}
+#endif
+		} else if (!strcmp(*argv, "-backend")) {
+			if (--argc < 1) goto bad;
+			if (!speed_backend_enabled(*(++argv))) {
+				fprintf(stderr, "gmssl %s: backend '%s' not compiled in\n", prog, *argv);
+				goto end;
+			}
+		} else if (!strcmp(*argv, "-json")) {
+			json = 1;
+		} else if (!strcmp(*argv, "-out")) {
+			if (--argc < 1) goto bad;
+			outfile = *(++argv);
+			if (!(outfp = fopen(outfile, "wb"))) {
+				fprintf(stderr, "gmssl %s: open '%s' failure : %s\n", prog, outfile, strerror(errno));
+				goto end;
+			}
+		} else {
+			fprintf(stderr, "gmssl %s: illegal option '%s'\n", prog, *argv);
+			goto end;
+bad:
+			fprintf(stderr, "gmssl %s: '%s' option value missing\n", prog, *argv);
+			goto end;
+		}
+
+		argc--;
+		argv++;
+	}
+
+	if (json) {
+		fprintf(outfp, "{\n  \"version\": \"%s\",\n  \"threads\": %d,\n  \"seconds\": %g,\n  \"backends\": [",
+			gmssl_version_str(), threads, seconds);
+		for (i = 0; i < sizeof(speed_backends)/sizeof(speed_backends[0]); i++) {
+			fprintf(outfp, "%s\"%s\"", i ? ", " : "", speed_backends[i]);
+		}
+		fprintf(outfp, "],\n  \"results\": [");
+	} else {
+		fprintf(outfp, "%s, threads %d, backends:", gmssl_version_str(), threads);
+		for (i = 0; i < sizeof(speed_backends)/sizeof(speed_backends[0]); i++) {
+			fprintf(outfp, " %s", speed_backends[i]);
+		}
+		fprintf(outfp, "\n");
+	}
+
+	for (i = 0; i < SPEED_NUM_ALGS; i++) {
+		const SPEED_ALG *alg = &speed_algs[i];
+		size_t nsizes = alg->bulk ? sizes_cnt : 1;
+
+		if (!speed_alg_selected(algs, alg->name)) {
+			continue;
+		}
+		for (j = 0; j < nsizes; j++) {
+			size_t size = alg->bulk ? sizes[j] : 0;
+			uint64_t ops;
+			double elapsed;
+
+			// block ciphers in ECB/CBC and chacha20 keystream only handle full blocks
+			if (alg->bulk && size % 64 && !strcmp(alg->name, "chacha20")) {
+				continue;
+			}
+			if (alg->bulk && size % SM4_BLOCK_SIZE
+				&& (!strcmp(alg->name, "sm4_ecb") || !strcmp(alg->name, "sm4_cbc"))) {
+				continue;
+			}
+			if (speed_run(alg, size, seconds, threads, &ops, &elapsed) != 1) {
+				fprintf(stderr, "gmssl %s: %s failed\n", prog, alg->name);
+				goto end;
+			}
+
+			if (json) {
+				fprintf(outfp, "%s\n    { \"alg\": \"%s\", ", first ? "" : ",", alg->name);
+				if (alg->bulk) {
+					fprintf(outfp, "\"size\": %zu, \"ops\": %llu, \"elapsed\": %.6f, \"bytes_per_sec\": %.0f }",
+						size, (unsigned long long)ops, elapsed, (double)ops * size / elapsed);
+				} else {
+					fprintf(outfp, "\"ops\": %llu, \"elapsed\": %.6f, \"ops_per_sec\": %.1f }",
+						(unsigned long long)ops, elapsed, (double)ops / elapsed);
+				}
+			} else {
+				if (alg->bulk) {
+					fprintf(outfp, "%-15s %8zu bytes: %12.2f MiB/s\n",
+						alg->name, size, (double)ops * size / elapsed / (1024 * 1024));
+				} else {
+					fprintf(outfp, "%-15s %14s: %12.1f ops/s\n",
+						alg->name, "", (double)ops / elapsed);
+				}
+			}
+			fflush(outfp);
+			first = 0;
+		}
+	}
+
+	if (json) {
+		fprintf(outfp, "\n  ]\n}\n");
+	}
+	ret = 0;
+
+end:
+	if (outfile && outfp) fclose(outfp);
+	return ret;
+}
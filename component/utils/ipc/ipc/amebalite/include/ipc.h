@@ -85,5 +85,7 @@ typedef struct {
 int32_t IPC_Message_Queue_Init(void);
 int32_t IPC_Message_Queue_Send(uint32_t id, uint8_t *buf, uint32_t size, int32_t timeout);
 int32_t IPC_Message_Queue_Recv(uint32_t id, uint8_t *buf, uint32_t *size);
+int32_t IPC_Message_Queue_Reserve(uint32_t id, uint32_t size, int32_t timeout, uint8_t **buf);
+int32_t IPC_Message_Queue_Commit(uint32_t id, uint32_t size);
 
 #endif //IPC_MESSAGE_H
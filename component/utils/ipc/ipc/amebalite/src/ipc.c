@@ -125,25 +125,9 @@ int32_t IPC_Message_Queue_Init(void)
 }
 #endif
 
-int32_t IPC_Message_Queue_Send(uint32_t id, uint8_t *buf, uint32_t size, int32_t timeout)
+static int32_t IPC_Message_Queue_Wait_Space(MessageInfo *info, uint32_t size, int32_t timeout)
 {
-	MessageInfo *info;
-	uint32_t segment_len = 0;
 	uint32_t remain_bytes = 0;
-	uint32_t end_addr;
-
-	if (id > IPC_ID_NUM) {
-		IPC_LOGE("id: %d IPC_INVALID_CH\n", (int)id);
-		return IPC_INVALID_CH;
-	}
-
-	if (!size || !buf) {
-		IPC_LOGE("id: %d, invalid size or buf\n", (int)id);
-		return IPC_INVALID_SIZE;
-	}
-
-	info = (MessageInfo *)(g_ipc_buffer + id * sizeof(MessageInfo));
-	DCache_Invalidate((uint32_t)info, sizeof(MessageInfo));
 
 	do {
 		uint32_t rptr;
@@ -166,6 +150,46 @@ int32_t IPC_Message_Queue_Send(uint32_t id, uint8_t *buf, uint32_t size, int32_t
 		rtos_time_delay_ms(1);
 		DCache_Invalidate((uint32_t)&info->rptr, BYTE_ALIGNMENT);
 	} while (timeout > 0 || timeout == WAIT_FOREVER);
+	return IPC_SUCCESS;
+}
+
+static void IPC_Message_Queue_Notify(MessageInfo *info, uint32_t id)
+{
+	uint8_t channel = 0;
+	if (info->dir & 0x00000001) {
+		channel = IPC_TX_TRAN_1;
+	} else {
+		channel = IPC_TX_TRAN_0;
+	}
+	IPC_MSG_STRUCT ipc_message = { 0 };
+	ipc_message.msg = id;
+	ipc_message.msg_type = IPC_USER_POINT;
+	ipc_send_message(info->dir, channel, &ipc_message);
+	IPC_LOGV("ipc_send_message: %d, channel=%d\n", (int)info->dir, channel);
+}
+
+int32_t IPC_Message_Queue_Send(uint32_t id, uint8_t *buf, uint32_t size, int32_t timeout)
+{
+	MessageInfo *info;
+	uint32_t segment_len = 0;
+	uint32_t end_addr;
+
+	if (id > IPC_ID_NUM) {
+		IPC_LOGE("id: %d IPC_INVALID_CH\n", (int)id);
+		return IPC_INVALID_CH;
+	}
+
+	if (!size || !buf) {
+		IPC_LOGE("id: %d, invalid size or buf\n", (int)id);
+		return IPC_INVALID_SIZE;
+	}
+
+	info = (MessageInfo *)(g_ipc_buffer + id * sizeof(MessageInfo));
+	DCache_Invalidate((uint32_t)info, sizeof(MessageInfo));
+
+	if (IPC_Message_Queue_Wait_Space(info, size, timeout) != IPC_SUCCESS) {
+		return IPC_TX_TIMEOUT;
+	}
 
 	end_addr = info->addr + info->len;
 	if (info->wptr + size > end_addr) {
@@ -181,17 +205,64 @@ int32_t IPC_Message_Queue_Send(uint32_t id, uint8_t *buf, uint32_t size, int32_t
 		info->wptr += size;
 	}
 	DCache_Clean((uint32_t) & (info->wptr), BYTE_ALIGNMENT);
-	uint8_t channel = 0;
-	if (info->dir & 0x00000001) {
-		channel = IPC_TX_TRAN_1;
-	} else {
-		channel = IPC_TX_TRAN_0;
+	IPC_Message_Queue_Notify(info, id);
+	return IPC_SUCCESS;
+}
+
+/*
+ * Reserve size contiguous bytes at the write pointer so the caller can build
+ * a message in place. Returns IPC_INVALID_SIZE when the space would wrap
+ * around the end of the ring, the caller then falls back to
+ * IPC_Message_Queue_Send. The caller must serialize Reserve/Commit pairs and
+ * Send on the same id.
+ */
+int32_t IPC_Message_Queue_Reserve(uint32_t id, uint32_t size, int32_t timeout, uint8_t **buf)
+{
+	MessageInfo *info;
+
+	if (id > IPC_ID_NUM) {
+		IPC_LOGE("id: %d IPC_INVALID_CH\n", (int)id);
+		return IPC_INVALID_CH;
 	}
-	IPC_MSG_STRUCT ipc_message = { 0 };
-	ipc_message.msg = id;
-	ipc_message.msg_type = IPC_USER_POINT;
-	ipc_send_message(info->dir, channel, &ipc_message);
-	IPC_LOGV("ipc_send_message: %d, channel=%d\n", (int)info->dir, channel);
+
+	if (!size || !buf) {
+		IPC_LOGE("id: %d, invalid size or buf\n", (int)id);
+		return IPC_INVALID_SIZE;
+	}
+
+	info = (MessageInfo *)(g_ipc_buffer + id * sizeof(MessageInfo));
+	DCache_Invalidate((uint32_t)info, sizeof(MessageInfo));
+
+	if (info->wptr + size > info->addr + info->len) {
+		return IPC_INVALID_SIZE;
+	}
+
+	if (IPC_Message_Queue_Wait_Space(info, size, timeout) != IPC_SUCCESS) {
+		return IPC_TX_TIMEOUT;
+	}
+
+	*buf = (uint8_t *)info->wptr;
+	return IPC_SUCCESS;
+}
+
+/*
+ * Publish size bytes written into the space returned by
+ * IPC_Message_Queue_Reserve, size must not exceed the reserved size.
+ */
+int32_t IPC_Message_Queue_Commit(uint32_t id, uint32_t size)
+{
+	MessageInfo *info;
+
+	if (id > IPC_ID_NUM) {
+		IPC_LOGE("id: %d IPC_INVALID_CH\n", (int)id);
+		return IPC_INVALID_CH;
+	}
+
+	info = (MessageInfo *)(g_ipc_buffer + id * sizeof(MessageInfo));
+	DCache_Clean(info->wptr, size);
+	info->wptr += size;
+	DCache_Clean((uint32_t) & (info->wptr), BYTE_ALIGNMENT);
+	IPC_Message_Queue_Notify(info, id);
 	return IPC_SUCCESS;
 }
 
@@ -87,6 +87,34 @@ struct RPCHwManager {
 	 * @version 1.0
 	 */
 	int32_t (*ReadBuffer)(int32_t id, int32_t opt, uint8_t *buf, int size);
+
+	/**
+	 * @brief Reserve contiguous space in the write queue to encode a message in place.
+	 *
+	 * @param fd The write ipc queue id.
+	 * @param opt The option for set BLOCK_MODE or others.
+	 * @param buf Returns the pointer of the reserved space.
+	 * @param size The size to reserve.
+	 * @return Returns <b>0</b> if the space is reserved, the caller must then call CommitBuffer;
+	 * returns a negative value if no contiguous space is available, the caller falls back to WriteBuffer.
+	 *
+	 * @since 1.0
+	 * @version 1.0
+	 */
+	int32_t (*ReserveBuffer)(int32_t id, int32_t opt, uint8_t **buf, int size);
+
+	/**
+	 * @brief Publish the data written into the space returned by ReserveBuffer.
+	 *
+	 * @param fd The write ipc queue id.
+	 * @param opt The option for set BLOCK_MODE or others.
+	 * @param size The written size, no more than the reserved size.
+	 * @return Returns the written size if the data is published successfully;
+	 *
+	 * @since 1.0
+	 * @version 1.0
+	 */
+	int32_t (*CommitBuffer)(int32_t id, int32_t opt, int size);
 };
 
 typedef struct RPCHwManager RPCHwManager;
@@ -51,6 +51,18 @@ static int32_t WriteBuffer(int32_t id, int32_t opt, uint8_t *buf, int size)
 	return (res == RPC_SUCCESS) ? size : res;
 }
 
+static int32_t ReserveBuffer(int32_t id, int32_t opt, uint8_t **buf, int size)
+{
+	return IPC_Message_Queue_Reserve(IPC_ID_NUM - id - 1, (uint32_t)size, ((opt & BLOCK_MODE) ? WAIT_FOREVER : WAIT_TIME_OUT), buf);
+}
+
+static int32_t CommitBuffer(int32_t id, int32_t opt, int size)
+{
+	(void)opt;
+	int32_t res = IPC_Message_Queue_Commit(IPC_ID_NUM - id - 1, (uint32_t)size);
+	return (res == RPC_SUCCESS) ? size : res;
+}
+
 struct RPCHwManager *GetRPCHwManager(void)
 {
 	RPC_LOGI("GetRPCHwManager\n");
@@ -66,6 +78,8 @@ struct RPCHwManager *GetRPCHwManager(void)
 
 	rpc_manager->WriteBuffer = WriteBuffer;
 	rpc_manager->ReadBuffer = ReadBuffer;
+	rpc_manager->ReserveBuffer = ReserveBuffer;
+	rpc_manager->CommitBuffer = CommitBuffer;
 	return rpc_manager;
 }
 
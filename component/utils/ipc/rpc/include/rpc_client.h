@@ -22,14 +22,65 @@
 extern "C" {
 #endif
 
+// Maximum calls in flight across all tasks for the asynchronous API
+#define RPC_MAX_PENDING_CALLS 32
+// Staging size of an RPC_BATCH, messages are appended until it is full
+#define RPC_BATCH_SIZE 512
+
+typedef struct RPC_CALL RPC_CALL;
+typedef struct RPC_BATCH RPC_BATCH;
+typedef void (*RPC_CallDone)(RPC_CALL *call, void *user_data);
+
+/*
+ * Completion handle of an asynchronous call.
+ * token carries the slot index and a sequence number, it is sent in
+ * RPC_STRUCT.task_id and echoed back by the server in the reply.
+ */
+struct RPC_CALL {
+	u_long      token;          // 0 when the slot is free
+	caddr_t     result;         // reply buffer, must stay valid until completion
+	long        result_size;
+	xdrproc_t   xdr_result;     // decode the reply in place when not NULL
+	RPC_CallDone done;          // called from the receiver task on completion
+	void        *user_data;
+	RPC_Sem     sem;            // created again each time the slot is allocated
+	int32_t     sem_inited;
+	volatile int32_t completed;
+	volatile int32_t status;    // RPC_SUCCESS, or why the call failed once completed
+	volatile long busy;         // receiver task completing the call, 0 otherwise
+	RPC_BATCH   *batch;         // batch the call is queued in until it is flushed
+};
+
+struct RPC_BATCH {
+	int32_t     send_mode;
+	int32_t     size;
+	u_long      count;
+	char        buf[RPC_BATCH_SIZE] __attribute__((aligned(4)));
+};
+
 int32_t WaitReply(void);
 
+void RPC_InitClient(void);
+
 RPC_STRUCT RPC_PrepareCall(CLNT_STRUCT *clnt, int32_t result);
 
 int32_t RPC_ClientCall(RPC_STRUCT *rpc, u_long procedure_id, int32_t opt, xdrproc_t xdr_args, caddr_t args_ptr, long args_size);
 
 void RPC_DeInitClient(void);
 
+RPC_CALL *RPC_ClientCallAsync(CLNT_STRUCT *clnt, u_long procedure_id, xdrproc_t xdr_args, caddr_t args_ptr, long args_size,
+							  caddr_t result, long result_size, xdrproc_t xdr_result, RPC_CallDone done, void *user_data, RPC_BATCH *batch);
+
+int32_t RPC_CallWait(RPC_CALL *call, uint32_t ms);
+
+int32_t RPC_CallIsDone(RPC_CALL *call);
+
+void RPC_CallRelease(RPC_CALL *call);
+
+void RPC_BatchInit(RPC_BATCH *batch, int32_t send_mode);
+
+int32_t RPC_BatchFlush(RPC_BATCH *batch);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,8 +23,26 @@
 extern "C" {
 #endif
 
+// messages whose encoded size fits are staged on the caller's stack
+// when the transport cannot reserve ring space
+#define RPC_STACK_MSG_SIZE 128
+
+typedef bool_t (*RPC_BodyEncoder)(XDR *xdrs, void *ctx);
+
+typedef struct RPC_STATS RPC_STATS;
+struct RPC_STATS {
+	u_long messages;        // messages written
+	u_long zero_copy;       // messages encoded in place in the shared ring
+	u_long heap_staged;     // messages staged through rpc_malloc
+	u_long bytes_copied;    // bytes copied from a staging buffer into the ring
+};
+
 bool_t xdr_RPC_STRUCT(XDR *xdrs, RPC_STRUCT *objp);
 RPCHwManager *GetRPCManager(void);
+int32_t RPC_EncodeMessage(char *mem, RPC_STRUCT *rpc, RPC_BodyEncoder encode, void *ctx, u_long max_body);
+int32_t RPC_WriteEncoded(int32_t opt, char *buf, int32_t size, u_long messages);
+int32_t RPC_WriteMessage(int32_t opt, RPC_STRUCT *rpc, RPC_BodyEncoder encode, void *ctx, u_long max_body);
+void RPC_GetStats(RPC_STATS *stats);
 
 #ifdef __cplusplus
 }
@@ -43,6 +43,7 @@ typedef struct RPC_INIT_STRUCT RPC_INIT_STRUCT;
 struct RPC_INIT_STRUCT {
 	int32_t task_size;
 	int32_t priority;
+	int32_t handler_threads;    // receiver/handler tasks per channel, 0 for default
 };
 
 typedef struct CLNT_STRUCT CLNT_STRUCT;
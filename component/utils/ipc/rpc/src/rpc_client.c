@@ -30,11 +30,20 @@ struct LockInfo {
 };
 
 
+// low bit set distinguishes async call tokens from (aligned) task handles
+#define RPC_TOKEN_ASYNC     0x1UL
+#define RPC_TOKEN_SLOT(t)   (((t) >> 1) & 0x7F)
+#define RPC_TOKEN_SEQ_SHIFT 8
+
 static struct THREAD_STRUCT *g_ClientStruct = NULL;
 static int32_t g_ClientThreadRunning = 0;
 LockInfo g_Locks[MAX_TASK];
 static int32_t g_lockCount = 0;
 
+static RPC_CALL g_Calls[RPC_MAX_PENDING_CALLS];
+static u_long g_CallSeq = 0;
+static RPC_Mutex g_CallLock;
+
 void SigInit(long taskId)
 {
 	if (g_lockCount < MAX_TASK) {
@@ -71,114 +80,429 @@ void SigDel(long taskId)
 	}
 }
 
+/*
+ * claim the async call identified by token for completion,
+ * the slot is found directly from the token, the sequence number
+ * guards against a stale reply for a released slot.
+ * A claimed call keeps its slot and result buffer until PutCall,
+ * RPC_CallRelease from another task waits for it.
+ */
+static RPC_CALL *GetCall(u_long token)
+{
+	u_long slot = RPC_TOKEN_SLOT(token);
+	RPC_CALL *call = NULL;
+
+	RPC_MutexLock(&g_CallLock);
+	if (slot < RPC_MAX_PENDING_CALLS && g_Calls[slot].token == token) {
+		call = &g_Calls[slot];
+		call->busy = (long) rtos_task_handle_get();
+	}
+	RPC_MutexUnlock(&g_CallLock);
+	if (call == NULL) {
+		RPC_LOGE("<<%s stale reply token %lu.\n", __FUNCTION__, token);
+	}
+	return call;
+}
+
+static void PutCall(RPC_CALL *call)
+{
+	RPC_MutexLock(&g_CallLock);
+	call->busy = 0;
+	RPC_MutexUnlock(&g_CallLock);
+}
+
+/*
+ * the reply is decoded into a scratch copy first,
+ * call->result is only overwritten once the decode succeeded.
+ */
+static int32_t DecodeResult(RPC_CALL *call)
+{
+	char stack_buf[RPC_STACK_MSG_SIZE] __attribute__((aligned(4)));
+	char *decoded = stack_buf;
+	int32_t ret = RPC_SUCCESS;
+	XDR xdrs;
+
+	if (call->result_size > RPC_STACK_MSG_SIZE) {
+		decoded = rpc_malloc(call->result_size);
+		if (decoded == NULL) {
+			return RPC_NO_MEMORY;
+		}
+	}
+	memset(decoded, 0, call->result_size);
+	xdrmem_create(&xdrs, (char *)call->result, call->result_size, XDR_DECODE);
+	if ((*call->xdr_result)(&xdrs, decoded)) {
+		memcpy(call->result, decoded, call->result_size);
+	} else {
+		RPC_LOGE("<<%s decode reply fail.\n", __FUNCTION__);
+		ret = RPC_ERROR;
+	}
+	if (decoded != stack_buf) {
+		rpc_free(decoded);
+	}
+	return ret;
+}
+
+/*
+ * the call must be claimed by the caller (busy set), status is RPC_SUCCESS
+ * when the reply is in call->result, the semaphore is always posted.
+ */
+static void CompleteCall(RPC_CALL *call, int32_t status)
+{
+	if (status == RPC_SUCCESS && call->xdr_result && call->result) {
+		status = DecodeResult(call);
+	}
+	call->status = status;
+	call->completed = 1;
+	if (call->done) {
+		call->done(call, call->user_data);
+	}
+	RPC_SemPost(&call->sem);
+}
+
+/*
+ * read size bytes of the reply body into buf, at most buf_size of them are kept,
+ * the rest is read into a scratch buffer and dropped.
+ */
+static int32_t ReadReplyBody(int32_t channel_id, int32_t opt, uint8_t *buf, u_long buf_size, u_long size)
+{
+	uint8_t scratch[32];
+	u_long keep = (buf && size > buf_size) ? buf_size : (buf ? size : 0);
+	u_long len;
+
+	if (keep && GetRPCManager()->ReadBuffer(channel_id, opt, buf, keep) != (int32_t)keep) {
+		return RPC_ERROR;
+	}
+	for (size -= keep; size; size -= len) {
+		len = size > sizeof(scratch) ? sizeof(scratch) : size;
+		if (GetRPCManager()->ReadBuffer(channel_id, opt, scratch, len) != (int32_t)len) {
+			return RPC_ERROR;
+		}
+	}
+	return RPC_SUCCESS;
+}
+
 /*
  * Registered Reply Handler,
  * only use in BLOCK_MODE,
  * responsible for wake up the client task, and copy the result parameter
+ * the token is decoded first, the result is read straight from the ring into
+ * the result buffer of a blocked task or of an async call still holding its slot,
+ * the reply of a released async call is dropped.
  */
 static void ReplyHandler(RPC_STRUCT *rpc, int32_t opt, RPC_Mutex *mutex, char *param_buf)
 {
 	XDR xdrs;
-	char *buf;
+	char task_buf[sizeof(u_long)];
 	u_long result_taskID;
+	u_long result_size = rpc->parameter_size - sizeof(u_long);
+	int32_t channel_id = (opt & 0xF0) >> 4;
+	RPC_CALL *call = NULL;
+	uint8_t *result_buf;
+	u_long result_buf_size;
+	int32_t ret;
 	RPC_LOGD("<<%s Enter.\n", __FUNCTION__);
-	if (param_buf == NULL) {
-		//RPC_LOGD("param_buf is NULL will read buffer.\n");
-		buf = rpc_malloc(rpc->parameter_size);
-		if (buf == NULL) {
-			RPC_MutexUnlock(mutex);
-			return;
+	if (rpc->parameter_size < sizeof(u_long)) {
+		RPC_LOGE("reply too short \n");
+		if (param_buf == NULL) {
+			ReadReplyBody(channel_id, opt, NULL, 0, rpc->parameter_size);
 		}
-
-		int32_t channel_id = (opt & 0xF0) >> 4;
-		int32_t result = GetRPCManager()->ReadBuffer(channel_id, opt, (uint8_t *)buf, rpc->parameter_size);
-		if (result < 0 || (u_long)result != rpc->parameter_size) {
+		RPC_MutexUnlock(mutex);
+		return;
+	}
+	if (param_buf == NULL) {
+		if (GetRPCManager()->ReadBuffer(channel_id, opt, (uint8_t *)task_buf, sizeof(u_long)) != (int32_t)sizeof(u_long)) {
 			RPC_LOGE("read ring buffer error \n");
-			rpc_free(buf);
 			RPC_MutexUnlock(mutex);
 			return;
 		}
 	} else {
-		buf = param_buf;
+		memcpy(task_buf, param_buf, sizeof(u_long));
 	}
 
-	RPC_MutexUnlock(mutex);
-	// decode the taskID.
-	xdrmem_create(&xdrs, buf, sizeof(u_long), XDR_DECODE);
+	// decode the taskID before the result is copied anywhere.
+	xdrmem_create(&xdrs, task_buf, sizeof(u_long), XDR_DECODE);
 	if (!xdr_u_long(&xdrs, &result_taskID)) {
 		RPC_LOGD("xdr_u_long false...\n");
-		return;
+		result_taskID = 0;
+	}
+
+	if (result_taskID == 0) {
+		// nobody to deliver to, drop the result
+		result_buf = NULL;
+		result_buf_size = 0;
+	} else if (result_taskID & RPC_TOKEN_ASYNC) {
+		call = GetCall(result_taskID);
+		result_buf = call ? (uint8_t *)call->result : NULL;
+		result_buf_size = call ? (u_long)call->result_size : 0;
+	} else {
+		// the task is blocked in WaitReply, its result buffer is rpc->context
+		result_buf = (uint8_t *)rpc->context;
+		result_buf_size = result_size;
 	}
-	buf += sizeof(u_long);
 
-	// copy the result parameter and wake up the task by taskID.
-	memcpy((char *)rpc->context, buf, (rpc->parameter_size - sizeof(u_long)));
-	buf -= sizeof(u_long); //modified by ycyang
 	if (param_buf == NULL) {
-		rpc_free(buf);
+		ret = ReadReplyBody(channel_id, opt, result_buf, result_buf_size, result_size);
+	} else {
+		if (result_buf) {
+			memcpy(result_buf, param_buf + sizeof(u_long), result_size > result_buf_size ? result_buf_size : result_size);
+		}
+		ret = RPC_SUCCESS;
+	}
+	RPC_MutexUnlock(mutex);
+
+	if (ret != RPC_SUCCESS) {
+		RPC_LOGE("read ring buffer error \n");
 	}
 
-	SigDel((long)result_taskID);
+	if (call) {
+		CompleteCall(call, ret);
+		PutCall(call);
+	} else if (ret == RPC_SUCCESS && result_taskID && !(result_taskID & RPC_TOKEN_ASYNC)) {
+		SigDel((long)result_taskID);
+	}
+}
+
+typedef struct ARGS_STRUCT ARGS_STRUCT;
+struct ARGS_STRUCT {
+	xdrproc_t xdr_args;
+	caddr_t args_ptr;
+};
+
+static bool_t EncodeArgs(XDR *xdrs, void *ctx)
+{
+	ARGS_STRUCT *args = (ARGS_STRUCT *)ctx;
+	return (*args->xdr_args)(xdrs, args->args_ptr);
 }
 
 int32_t RPC_ClientCall(RPC_STRUCT *rpc, u_long procedure_id, int32_t opt, xdrproc_t xdr_args, caddr_t args_ptr, long args_size)
 {
-	XDR xdrs;
-	char *mem_ToShm;         // Memory start address for writing to Share-memory
-	int32_t size_ToShm = 0;      // size of memory for writing to Share-memory
-	int32_t cnt;                 // number of bytes writed to Share-memory
+	ARGS_STRUCT args;
 	RPC_LOGD(">>%s Enter.program_id=%d, procedure_id=%d\n", __FUNCTION__, (int)rpc->program_id, (int)procedure_id);
 	// assign RPC_STRUCT's value
 	rpc->procedure_id = procedure_id;
-	/*
-	    * prepare continuous memory for sending to share-memory
-	    *    start  ---------------
-	    *           |  RPC_STRUCT |
-	    *           |-------------|
-	    *           | user's args |
-	    *           |-------------|
-	    */
-	// prepare XDR's memory location of ARGS
-	// because we need args_size after XDR
-	// so we do this first.
-	mem_ToShm = rpc_malloc(sizeof(RPC_STRUCT) + args_size);
-	mem_ToShm += sizeof(RPC_STRUCT);
-
-
-	xdrmem_create(&xdrs, (char *)mem_ToShm, args_size, XDR_ENCODE);
-	if ((*xdr_args)(&xdrs, args_ptr) == 0) {
-		RPC_LOGE("XDR error \n");
-		return RPC_ERROR;
-	}
-
-	rpc->parameter_size = xdr_getpos(&xdrs);
-	size_ToShm += rpc->parameter_size;
-	mem_ToShm -= sizeof(RPC_STRUCT);
+	args.xdr_args = xdr_args;
+	args.args_ptr = args_ptr;
 
-	// prepare XDR's memory location of RPC_STRUCT
-	xdrmem_create(&xdrs, (char *)mem_ToShm, sizeof(RPC_STRUCT), XDR_ENCODE);
-	if (xdr_RPC_STRUCT(&xdrs, rpc) == 0) {
-		RPC_LOGE(" XDR_RPC_STRUCT error \n");
-		return RPC_ERROR;
-	}
-	size_ToShm += xdr_getpos(&xdrs);
-
-	int32_t channel_id = (opt & 0x0E) >> 1;
 #if RPC_DEBUG
-	RPC_LOGD("RPC_ClientCall channel_id=%ld, opt=%x\n", channel_id, opt);
+	RPC_LOGD("RPC_ClientCall channel_id=%ld, opt=%x\n", (opt & 0x0E) >> 1, opt);
 #endif
-	cnt = GetRPCManager()->WriteBuffer(channel_id, opt, (uint8_t *)mem_ToShm, size_ToShm);
-	rpc_free(mem_ToShm);
-
 	// if writeRingBuf error,
 	// return to the user send error,
 	// we dont re-send it.
-	if (cnt == size_ToShm) {
-		return RPC_SUCCESS;
-	} else {
-		RPC_LOGD("cnt: %d, size_ToShm: %d\n", (int)cnt, (int)size_ToShm);
+	return RPC_WriteMessage(opt, rpc, EncodeArgs, &args, args_size);
+}
+
+static RPC_CALL *AllocCall(void)
+{
+	RPC_CALL *call = NULL;
+
+	RPC_MutexLock(&g_CallLock);
+	for (int i = 0; i < RPC_MAX_PENDING_CALLS; i++) {
+		// a slot released from its done callback is free once the receiver puts it
+		if (g_Calls[i].token == 0 && g_Calls[i].busy == 0) {
+			call = &g_Calls[i];
+			g_CallSeq++;
+			call->token = (g_CallSeq << RPC_TOKEN_SEQ_SHIFT) | ((u_long)i << 1) | RPC_TOKEN_ASYNC;
+			// a fresh semaphore, the previous call may have left posts or a timed out wait in it
+			if (call->sem_inited) {
+				RPC_SemDestroy(&call->sem);
+			}
+			RPC_SemInit(&call->sem, 0);
+			call->sem_inited = 1;
+			call->completed = 0;
+			call->status = RPC_SUCCESS;
+			call->batch = NULL;
+			break;
+		}
+	}
+	RPC_MutexUnlock(&g_CallLock);
+
+	if (call == NULL) {
+		RPC_LOGE("<<%s pending calls are full.\n", __FUNCTION__);
+	}
+	return call;
+}
+
+/*
+ * Issue a call without blocking the caller.
+ * The reply is written into result (which must stay valid until completion)
+ * and optionally decoded in place with xdr_result. Completion is signalled
+ * through done, RPC_CallWait or RPC_CallIsDone; the handle must then be
+ * released with RPC_CallRelease.
+ * With a batch the message is appended to it and sent by RPC_BatchFlush,
+ * the batch is flushed first when the message does not fit or was queued
+ * with another send mode. If that flush fails NULL is returned.
+ * For NONBLOCK_MODE clients no reply is expected and NULL is returned on success.
+ */
+RPC_CALL *RPC_ClientCallAsync(CLNT_STRUCT *clnt, u_long procedure_id, xdrproc_t xdr_args, caddr_t args_ptr, long args_size,
+							  caddr_t result, long result_size, xdrproc_t xdr_result, RPC_CallDone done, void *user_data, RPC_BATCH *batch)
+{
+	RPC_STRUCT rpc;
+	RPC_CALL *call = NULL;
+	ARGS_STRUCT args;
+	int32_t ret;
+
+	rpc.program_id = clnt->program_id;
+	rpc.version_id = clnt->version_id;
+	rpc.procedure_id = procedure_id;
+	rpc.context = (u_int)result;
+	rpc.parameter_size = 0;
+	rpc.task_id = 0;
+
+	if (clnt->send_mode & BLOCK_MODE) {
+		call = AllocCall();
+		if (call == NULL) {
+			return NULL;
+		}
+		call->result = result;
+		call->result_size = result_size;
+		call->xdr_result = xdr_result;
+		call->done = done;
+		call->user_data = user_data;
+		rpc.task_id = call->token;
+	}
+
+	args.xdr_args = xdr_args;
+	args.args_ptr = args_ptr;
+
+	if (batch) {
+		if (batch->size && (batch->send_mode != clnt->send_mode ||
+							batch->size + (int32_t)(sizeof(RPC_STRUCT) + args_size) > RPC_BATCH_SIZE)) {
+			if (RPC_BatchFlush(batch) != RPC_SUCCESS) {
+				goto fail;
+			}
+		}
+		// the whole batch goes out with a single send mode, the one of its messages
+		batch->send_mode = clnt->send_mode;
+		if (batch->size + (int32_t)(sizeof(RPC_STRUCT) + args_size) <= RPC_BATCH_SIZE) {
+			ret = RPC_EncodeMessage(batch->buf + batch->size, &rpc, EncodeArgs, &args, args_size);
+			if (ret > 0) {
+				batch->size += ret;
+				batch->count++;
+				if (call) {
+					call->batch = batch;
+				}
+				return call;
+			}
+			goto fail;
+		}
+	}
+
+	if (RPC_WriteMessage(clnt->send_mode, &rpc, EncodeArgs, &args, args_size) == RPC_SUCCESS) {
+		return call;
+	}
+
+fail:
+	if (call) {
+		RPC_CallRelease(call);
+	}
+	return NULL;
+}
+
+/*
+ * wait for the call to complete, ms is RPC_SEM_WAIT_FOREVER to wait forever,
+ * returns the status the call completed with.
+ */
+int32_t RPC_CallWait(RPC_CALL *call, uint32_t ms)
+{
+	if (call == NULL) {
 		return RPC_ERROR;
 	}
+	if (RPC_SemWait(&call->sem, ms) != 0) {
+		return RPC_RX_TIMEOUT;
+	}
+	// keep the semaphore count for a later RPC_CallWait on the same handle
+	RPC_SemPost(&call->sem);
+	return call->status;
+}
+
+int32_t RPC_CallIsDone(RPC_CALL *call)
+{
+	return call ? call->completed : 0;
+}
+
+/*
+ * release the completion handle,
+ * a reply arriving after release is dropped by the token check.
+ * When the receiver is completing the call, wait for it to be done
+ * with the result buffer, unless called from the done callback.
+ */
+void RPC_CallRelease(RPC_CALL *call)
+{
+	long self = (long) rtos_task_handle_get();
+	bool_t wait;
+
+	if (call == NULL) {
+		return;
+	}
+	RPC_MutexLock(&g_CallLock);
+	wait = call->busy && call->busy != self;
+	if (!wait) {
+		call->token = 0;
+	}
+	RPC_MutexUnlock(&g_CallLock);
+
+	if (wait) {
+		// CompleteCall posts the semaphore once it is done with the result buffer,
+		// the token is kept until then so the slot cannot be allocated again meanwhile
+		RPC_SemWait(&call->sem, RPC_SEM_WAIT_FOREVER);
+		RPC_MutexLock(&g_CallLock);
+		call->token = 0;
+		RPC_MutexUnlock(&g_CallLock);
+	}
+}
+
+void RPC_BatchInit(RPC_BATCH *batch, int32_t send_mode)
+{
+	batch->send_mode = send_mode;
+	batch->size = 0;
+	batch->count = 0;
+}
+
+/*
+ * detach the calls queued in batch from it,
+ * when the batch could not be sent they are completed with status.
+ */
+static void FinishBatchCalls(RPC_BATCH *batch, int32_t status)
+{
+	long self = (long) rtos_task_handle_get();
+
+	for (int i = 0; i < RPC_MAX_PENDING_CALLS; i++) {
+		RPC_CALL *call = NULL;
+
+		RPC_MutexLock(&g_CallLock);
+		if (g_Calls[i].token && g_Calls[i].batch == batch) {
+			g_Calls[i].batch = NULL;
+			if (status != RPC_SUCCESS) {
+				call = &g_Calls[i];
+				call->busy = self;
+			}
+		}
+		RPC_MutexUnlock(&g_CallLock);
+
+		if (call) {
+			CompleteCall(call, status);
+			PutCall(call);
+		}
+	}
+}
+
+/*
+ * send all messages of the batch with a single ring write,
+ * the receiver parses them one by one as separate calls.
+ * On failure the queued calls are completed with the error.
+ */
+int32_t RPC_BatchFlush(RPC_BATCH *batch)
+{
+	int32_t ret = RPC_SUCCESS;
+
+	if (batch->size) {
+		ret = RPC_WriteEncoded(batch->send_mode, batch->buf, batch->size, batch->count);
+		FinishBatchCalls(batch, ret);
+	}
+	batch->size = 0;
+	batch->count = 0;
+	return ret;
 }
 
 RPC_STRUCT RPC_PrepareCall(CLNT_STRUCT *clnt, int32_t result)
@@ -219,6 +543,14 @@ int32_t WaitReply(void)
 	return RPC_SUCCESS;
 }
 
+/*
+ * init the async call slots, before any task may issue a call
+ */
+void RPC_InitClient(void)
+{
+	RPC_MutexInit(&g_CallLock);
+}
+
 void RPC_DeInitClient(void)
 {
 	RPC_LOGD("***RPC_DeInitClient...\n");
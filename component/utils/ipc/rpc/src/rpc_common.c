@@ -56,6 +56,12 @@ static RPCHwManager *g_rpc_manager = NULL;
 static RPC_Mutex g_lock;
 static bool g_inited = false;
 static RPC_INIT_STRUCT g_init_param;
+/* channel_id is taken from bits 1..3 of opt */
+#define RPC_CHANNEL_NUM     8
+/* serializes reserve/encode/commit per channel, a full queue only blocks its own channel */
+static RPC_Mutex g_write_lock[RPC_CHANNEL_NUM];
+static RPC_Mutex g_stats_lock;
+static RPC_STATS g_stats;
 
 /*
  * XDR type of struct RPC_STRUCT
@@ -155,6 +161,11 @@ void ipc_app_init(int32_t task_size, int32_t priority, int32_t log_enable)
 int32_t RPC_Init(RPC_INIT_STRUCT *init_param)
 {
 	RPC_MutexInit(&g_lock);
+	for (int i = 0; i < RPC_CHANNEL_NUM; i++) {
+		RPC_MutexInit(&g_write_lock[i]);
+	}
+	RPC_MutexInit(&g_stats_lock);
+	RPC_InitClient();
 	if (rtos_task_create(NULL, ((const char *)"RPC_InitThread"), RPC_InitThread, init_param, 1024 * 4, 1) != RTK_SUCCESS) {
 		RPC_LOGE("\n\r%s rtos_task_create(RPC_InitThread) failed", __FUNCTION__);
 	}
@@ -172,6 +183,10 @@ void RPC_DeInit(void)
 	}
 	RPC_MutexUnlock(&g_lock);
 	RPC_MutexDestroy(&g_lock);
+	for (int i = 0; i < RPC_CHANNEL_NUM; i++) {
+		RPC_MutexDestroy(&g_write_lock[i]);
+	}
+	RPC_MutexDestroy(&g_stats_lock);
 }
 
 RPCHwManager *GetRPCManager(void)
@@ -192,3 +207,124 @@ int32_t RPC_IsInited(void)
 	RPC_MutexUnlock(&g_lock);
 	return ret;
 }
+
+/*
+ * encode one message into mem
+ *    start  ---------------
+ *           |  RPC_STRUCT |
+ *           |-------------|
+ *           |    body     |   <- produced by encode, at most max_body bytes
+ *           |-------------|
+ * rpc->parameter_size is updated with the encoded body size.
+ * Returns the total encoded size, or RPC_ERROR.
+ */
+int32_t RPC_EncodeMessage(char *mem, RPC_STRUCT *rpc, RPC_BodyEncoder encode, void *ctx, u_long max_body)
+{
+	XDR xdrs;
+
+	xdrmem_create(&xdrs, mem + sizeof(RPC_STRUCT), max_body, XDR_ENCODE);
+	if ((*encode)(&xdrs, ctx) == 0) {
+		RPC_LOGE("XDR error \n");
+		return RPC_ERROR;
+	}
+	rpc->parameter_size = xdr_getpos(&xdrs);
+
+	xdrmem_create(&xdrs, mem, sizeof(RPC_STRUCT), XDR_ENCODE);
+	if (xdr_RPC_STRUCT(&xdrs, rpc) == 0) {
+		RPC_LOGE(" XDR_RPC_STRUCT error \n");
+		return RPC_ERROR;
+	}
+	return xdr_getpos(&xdrs) + rpc->parameter_size;
+}
+
+/*
+ * write one message to share-memory
+ * The message is XDR-encoded straight into the ring when the transport can
+ * reserve contiguous space, otherwise it is staged on the stack (or heap if
+ * too large) and copied by WriteBuffer.
+ */
+int32_t RPC_WriteMessage(int32_t opt, RPC_STRUCT *rpc, RPC_BodyEncoder encode, void *ctx, u_long max_body)
+{
+	RPCHwManager *manager = GetRPCManager();
+	int32_t channel_id = (opt & 0x0E) >> 1;
+	int32_t size_max = sizeof(RPC_STRUCT) + max_body;
+	int32_t size_ToShm;
+	int32_t cnt = RPC_ERROR;
+	char stack_buf[RPC_STACK_MSG_SIZE] __attribute__((aligned(4)));
+	char *mem_ToShm = NULL;
+	bool_t zero_copy = FALSE;
+
+	RPC_MutexLock(&g_write_lock[channel_id]);
+	if (manager->ReserveBuffer &&
+		manager->ReserveBuffer(channel_id, opt, (uint8_t **)&mem_ToShm, size_max) == RPC_SUCCESS) {
+		zero_copy = TRUE;
+	} else if (size_max <= RPC_STACK_MSG_SIZE) {
+		mem_ToShm = stack_buf;
+	} else {
+		mem_ToShm = rpc_malloc(size_max);
+		if (mem_ToShm == NULL) {
+			RPC_LOGE("alloc memory fail\n");
+			RPC_MutexUnlock(&g_write_lock[channel_id]);
+			return RPC_NO_MEMORY;
+		}
+	}
+
+	// on encode failure nothing is committed, a reservation is simply reused by the next write
+	size_ToShm = RPC_EncodeMessage(mem_ToShm, rpc, encode, ctx, max_body);
+	if (size_ToShm > 0) {
+		if (zero_copy) {
+			cnt = manager->CommitBuffer(channel_id, opt, size_ToShm);
+		} else {
+			cnt = manager->WriteBuffer(channel_id, opt, (uint8_t *)mem_ToShm, size_ToShm);
+		}
+		if (cnt != size_ToShm) {
+			RPC_LOGD("cnt: %d, size_ToShm: %d\n", (int)cnt, (int)size_ToShm);
+			cnt = RPC_ERROR;
+		}
+	}
+	RPC_MutexUnlock(&g_write_lock[channel_id]);
+
+	if (size_ToShm > 0) {
+		RPC_MutexLock(&g_stats_lock);
+		if (zero_copy) {
+			g_stats.zero_copy++;
+		} else {
+			g_stats.bytes_copied += size_ToShm;
+			if (mem_ToShm != stack_buf) {
+				g_stats.heap_staged++;
+			}
+		}
+		g_stats.messages++;
+		RPC_MutexUnlock(&g_stats_lock);
+	}
+	if (!zero_copy && mem_ToShm != stack_buf) {
+		rpc_free(mem_ToShm);
+	}
+	return (cnt == RPC_ERROR) ? RPC_ERROR : RPC_SUCCESS;
+}
+
+/*
+ * write already encoded messages, e.g. a batch, to share-memory in one transfer
+ */
+int32_t RPC_WriteEncoded(int32_t opt, char *buf, int32_t size, u_long messages)
+{
+	int32_t channel_id = (opt & 0x0E) >> 1;
+	int32_t cnt;
+
+	RPC_MutexLock(&g_write_lock[channel_id]);
+	cnt = GetRPCManager()->WriteBuffer(channel_id, opt, (uint8_t *)buf, size);
+	RPC_MutexUnlock(&g_write_lock[channel_id]);
+
+	RPC_MutexLock(&g_stats_lock);
+	g_stats.messages += messages;
+	g_stats.bytes_copied += size;
+	RPC_MutexUnlock(&g_stats_lock);
+	return (cnt == size) ? RPC_SUCCESS : RPC_ERROR;
+}
+
+void RPC_GetStats(RPC_STATS *stats)
+{
+	RPC_MutexLock(&g_stats_lock);
+	*stats = g_stats;
+	RPC_MutexUnlock(&g_stats_lock);
+}
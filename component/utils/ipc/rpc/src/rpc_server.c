@@ -21,7 +21,8 @@
 #include "rpc_server.h"
 
 
-#define NUM_HANDLER_THREADS 4
+#define NUM_HANDLER_THREADS 8
+#define DEFAULT_HANDLER_THREADS_PER_CHANNEL 2
 static int32_t g_ServerThreadRunning = 0;
 rtos_task_t g_receiver_threads[NUM_HANDLER_THREADS];
 static int32_t g_thread_count = 0;
@@ -97,16 +98,28 @@ int32_t RPC_GetArgs(RPC_STRUCT *rpc, xdrproc_t xdr_argument, caddr_t argument, i
 {
 	XDR xdrs;
 	char *buf;
+	char stack_buf[RPC_STACK_MSG_SIZE] __attribute__((aligned(4)));
 
 	// according to the parameter size recording in RPC_STRUCT
 	// read the packet's body from ring buffer.
+	// small bodies are read onto the stack to avoid an allocation per call
 	if (param_buf == NULL) {
-		buf = rpc_malloc(rpc->parameter_size);
+		if (rpc->parameter_size <= RPC_STACK_MSG_SIZE) {
+			buf = stack_buf;
+		} else {
+			buf = rpc_malloc(rpc->parameter_size);
+			if (buf == NULL) {
+				RPC_LOGE("alloc memory fail\n");
+				return 0;
+			}
+		}
 		int32_t channel_id = (opt & 0xF0) >> 4;
 		RPC_LOGD("RPC_GetArgs will read buffer opt=%d, channel_id=%d\n", (int)opt, (int)channel_id);
 		if (GetRPCManager()->ReadBuffer(channel_id, opt, (uint8_t *)buf, rpc->parameter_size) != (int32_t) rpc->parameter_size) {
 			RPC_LOGE("read ring buffer error \n");
-			rpc_free(buf);
+			if (buf != stack_buf) {
+				rpc_free(buf);
+			}
 			return 0;
 		}
 	} else {
@@ -120,12 +133,12 @@ int32_t RPC_GetArgs(RPC_STRUCT *rpc, xdrproc_t xdr_argument, caddr_t argument, i
 	if ((*xdr_argument)(&xdrs, argument)) {
 		xdrs.x_op = XDR_FREE;
 		(*xdr_argument)(&xdrs, argument);
-		if (param_buf == NULL) {
+		if (param_buf == NULL && buf != stack_buf) {
 			rpc_free(buf);
 		}
 		return 1;
 	} else {
-		if (param_buf == NULL) {
+		if (param_buf == NULL && buf != stack_buf) {
 			rpc_free(buf);
 		}
 		return 0;
@@ -194,13 +207,21 @@ int32_t RPC_InitProxy(struct REG_STRUCT *reg, int32_t channel_id, RPC_INIT_STRUC
 		g_ServerThreadRunning = 1;
 	}
 
+	// every receiver task reads one request and runs its handler,
+	// the channel mutex is released once the arguments are read,
+	// so the tasks of a channel form a pool serving pipelined calls.
+	int32_t handler_threads = DEFAULT_HANDLER_THREADS_PER_CHANNEL;
+	if (init_param && init_param->handler_threads > 0) {
+		handler_threads = init_param->handler_threads;
+	}
+
 	RPC_LOGD("%s Enter, program_id=%lu, channel_id=%d, g_thread_count=%d\n", __FUNCTION__, reg->program_id, (int)channel_id, (int)g_thread_count);
-	if (g_thread_count >= NUM_HANDLER_THREADS) {
+	if (g_thread_count + handler_threads > NUM_HANDLER_THREADS) {
 		return -1;
 	}
 	RPC_Mutex *pMutex = rpc_malloc(sizeof(RPC_Mutex));
 	RPC_MutexInit(pMutex);
-	for (uint8_t i = 0; i < 2; i++) {
+	for (int32_t i = 0; i < handler_threads; i++) {
 		THREAD_STRUCT *serverStruct = rpc_malloc(sizeof(THREAD_STRUCT));
 		serverStruct->reg_ptr = reg;
 		serverStruct->mutex = pMutex;
@@ -222,6 +243,24 @@ int32_t RPC_InitProxy(struct REG_STRUCT *reg, int32_t channel_id, RPC_INIT_STRUC
 }
 
 
+typedef struct REPLY_STRUCT REPLY_STRUCT;
+struct REPLY_STRUCT {
+	u_long req_taskID;
+	char *reply_param;
+	xdrproc_t xdr_result;
+};
+
+static bool_t EncodeReply(XDR *xdrs, void *ctx)
+{
+	REPLY_STRUCT *reply = (REPLY_STRUCT *)ctx;
+	if (!xdr_u_long(xdrs, &reply->req_taskID)) {
+		RPC_LOGD("get xdr_u_long error...\n");
+		return FALSE;
+	}
+	(*reply->xdr_result)(xdrs, reply->reply_param);
+	return TRUE;
+}
+
 /*
  * The function apply to server proxy
  * used to send the reply back
@@ -229,9 +268,7 @@ int32_t RPC_InitProxy(struct REG_STRUCT *reg, int32_t channel_id, RPC_INIT_STRUC
 void RPC_SendReply(u_long req_taskID, int32_t req_context, char *reply_param, u_long param_size, xdrproc_t xdr_result, int32_t opt)
 {
 	RPC_STRUCT rpc;
-	XDR xdrs;
-	char *mem_ToShm;        // mem start addr for writing to share memory
-	int32_t size_ToShm = 0 ;    // total mem size for writing to share memory
+	REPLY_STRUCT reply;
 
 	// when reply, RPC's context must be the parameter addr we want to reply.
 	RPC_LOGD(">>>%s Enter. opt=%d\n", __FUNCTION__, (int)opt);
@@ -249,33 +286,11 @@ void RPC_SendReply(u_long req_taskID, int32_t req_context, char *reply_param, u_
 	//               ----------------
 	//               |  Reply para. |
 	//               ----------------
-	mem_ToShm = rpc_malloc(sizeof(RPC_STRUCT) + sizeof(u_long) + param_size);
-	mem_ToShm += sizeof(RPC_STRUCT);
-
-	// TaskID
-	xdrmem_create(&xdrs, mem_ToShm, sizeof(u_long), XDR_ENCODE);
-	if (!xdr_u_long(&xdrs, &req_taskID)) {
-		RPC_LOGD("get xdr_u_long error...\n");
-		return;
-	}
-	size_ToShm += sizeof(u_long);
-	mem_ToShm += size_ToShm;
-
-	// Reply Parameter
-	xdrmem_create(&xdrs, mem_ToShm, param_size, XDR_ENCODE);
-	(*xdr_result)(&xdrs, reply_param);
-	size_ToShm += xdr_getpos(&xdrs);
-	rpc.parameter_size = size_ToShm;
-	mem_ToShm -= (sizeof(u_long) + sizeof(RPC_STRUCT));
-
-	// RPC_STRUCT
-	xdrmem_create(&xdrs, mem_ToShm, sizeof(RPC_STRUCT), XDR_ENCODE);
-	xdr_RPC_STRUCT(&xdrs, &rpc);
-	size_ToShm += xdr_getpos(&xdrs);
-	int32_t channel_id = (opt & 0x0E) >> 1;
-	RPC_LOGD("RPC_SendReply channel_id=%d, opt=%d\n", (int)channel_id, (int)opt);
-	GetRPCManager()->WriteBuffer(channel_id, opt, (uint8_t *)mem_ToShm, size_ToShm);
-	rpc_free(mem_ToShm);
+	reply.req_taskID = req_taskID;
+	reply.reply_param = reply_param;
+	reply.xdr_result = xdr_result;
+	RPC_LOGD("RPC_SendReply channel_id=%d, opt=%d\n", (int)((opt & 0x0E) >> 1), (int)opt);
+	RPC_WriteMessage(opt, &rpc, EncodeReply, &reply, sizeof(u_long) + param_size);
 }
 
 void RPC_DeInitServer(void)
@@ -143,8 +143,10 @@ int whc_host_xmit_init(void);
 int whc_host_xmit_deinit(void);
 int whc_host_xmit_pending_q_num(void);
 void whc_host_xmit_wakeup_thread(void);
+void whc_host_xmit_complete(struct sk_buff *pskb);
 void whc_host_recv_notify(void);
 int whc_host_recv_process(struct sk_buff *pskb);
+void whc_host_recv_napi_enqueue(struct sk_buff *pskb);
 void whc_host_recv_init(void);
 void whc_host_recv_deinit(void);
 int whc_fullmac_host_event_init(struct whc_device *idev);
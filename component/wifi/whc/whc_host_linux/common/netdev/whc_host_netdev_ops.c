@@ -461,7 +461,7 @@ int rtw_nan_iface_alloc(struct wiphy *wiphy,
 	}
 
 	/* alloc and init netdev */
-	ndev = alloc_etherdev_mq(sizeof(struct netdev_priv_t), 1);
+	ndev = alloc_etherdev_mq(sizeof(struct netdev_priv_t), WHC_TX_QUEUE_NUM);
 	if (!ndev) {
 		goto exit;
 	}
@@ -585,7 +585,7 @@ int rtw_ndev_alloc(void)
 
 	for (i = 0; i < TOTAL_IFACE_NUM; i++) {
 		/* alloc and init netdev */
-		ndev = alloc_etherdev_mq(sizeof(struct netdev_priv_t), 1);
+		ndev = alloc_etherdev_mq(sizeof(struct netdev_priv_t), WHC_TX_QUEUE_NUM);
 		if (!ndev) {
 			goto fail;
 		}
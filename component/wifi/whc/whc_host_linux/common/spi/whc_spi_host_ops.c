@@ -127,19 +127,20 @@ void whc_spi_host_recv_data_process(void *intf_priv)
 			dev_err(&spidev->dev, "could not transfer : %d\n", rc);
 			kfree_skb(pskb);
 
+			/* the tx packet is dropped, still complete it so BQL and the tx queue do not stall */
+			if (p_node != NULL) {
+				whc_host_xmit_complete(tx_skb);
+				dev_kfree_skb(tx_skb);
+				kfree(p_node);
+			}
 			goto exit;
 		}
 
 		//print_hex_dump_bytes("whc_spi_host_recv_data_process: ", DUMP_PREFIX_NONE, tr->rx_buf, tr->len);
 
-		/* wake tx queue if need */
+		/* report tx done and wake tx queue if need */
 		if (p_node != NULL) {
-			if (whc_host_xmit_pending_q_num() < QUEUE_WAKE_THRES) {
-				netif_tx_wake_all_queues(global_idev.pndev[0]);
-				if (global_idev.pndev[1]) {
-					netif_tx_wake_all_queues(global_idev.pndev[1]);
-				}
-			}
+			whc_host_xmit_complete(tx_skb);
 
 			/* release the memory for this message. */
 			dev_kfree_skb(tx_skb);
@@ -30,17 +30,35 @@ struct event_priv_t {
 	u8					b_waiting_for_ret: 1;
 };
 
+struct rx_stats_t {
+	u64					rx_pkts; /* data pkts queued to NAPI */
+	u32					napi_polls;
+	u32					budget_exhausted; /* polls that used up the whole budget */
+	u32					queue_full; /* times rx thread waited for NAPI to drain */
+	u32					max_queue_len;
+};
+
 struct recv_priv_t {
 	struct task_struct			*rx_thread;
 	struct semaphore			rx_sema;
+
+	/* data pkts are handed to stack by NAPI, other msgs are still handled in rx thread. */
+	struct net_device			*napi_dev; /* dummy netdev which napi attaches to */
+	struct napi_struct			napi;
+	struct sk_buff_head			rx_queue;
+	wait_queue_head_t			rx_queue_wq; /* rx thread waits here when rx_queue is full */
+	int					napi_budget;
+	struct rx_stats_t			stats;
+
 	u8					initialized: 1;
 };
 
 struct xmit_priv_t {
-	struct list_head		queue_head; /* msg queue */
+	struct list_head		queue_head[WHC_TX_QUEUE_NUM]; /* msg queue per netdev tx queue(AC) */
 	spinlock_t				lock; /* queue lock */
 
-	atomic_t				msg_num;
+	atomic_t				msg_num; /* total pending msg num */
+	atomic_t				ac_msg_num[WHC_TX_QUEUE_NUM]; /* pending msg num per tx queue */
 
 	struct task_struct 		*tx_thread;
 	struct semaphore 		tx_sema;
@@ -12,6 +12,59 @@ int whc_host_recv_process(struct sk_buff *pskb)
 	return ret;
 }
 
+/* queue a data pkt whose skb->dev and protocol are set, NAPI poll will hand it to stack. */
+void whc_host_recv_napi_enqueue(struct sk_buff *pskb)
+{
+	struct recv_priv_t *recv_priv = &global_idev.recv_priv;
+	u32 qlen;
+
+	skb_queue_tail(&recv_priv->rx_queue, pskb);
+
+	recv_priv->stats.rx_pkts++;
+	qlen = skb_queue_len(&recv_priv->rx_queue);
+	if (qlen > recv_priv->stats.max_queue_len) {
+		recv_priv->stats.max_queue_len = qlen;
+	}
+
+	/* called from rx thread, disable bh so that softirq runs poll right after schedule */
+	local_bh_disable();
+	napi_schedule(&recv_priv->napi);
+	local_bh_enable();
+}
+
+static int whc_host_recv_napi_poll(struct napi_struct *napi, int budget)
+{
+	struct recv_priv_t *recv_priv = container_of(napi, struct recv_priv_t, napi);
+	struct sk_buff *pskb;
+	int quota = min(budget, recv_priv->napi_budget);
+	int work_done = 0;
+
+	recv_priv->stats.napi_polls++;
+
+	while ((work_done < quota) && ((pskb = skb_dequeue(&recv_priv->rx_queue)) != NULL)) {
+		napi_gro_receive(napi, pskb);
+		work_done++;
+	}
+
+	if (work_done == quota) {
+		recv_priv->stats.budget_exhausted++;
+	}
+
+	/* let rx thread read bus again */
+	if (skb_queue_len(&recv_priv->rx_queue) < WHC_RX_QUEUE_LOW) {
+		wake_up(&recv_priv->rx_queue_wq);
+	}
+
+	/* quota may be less than budget, reschedule if pkts are left after complete */
+	if ((work_done < budget) && napi_complete_done(napi, work_done)) {
+		if (!skb_queue_empty(&recv_priv->rx_queue)) {
+			napi_schedule(napi);
+		}
+	}
+
+	return work_done;
+}
+
 static int whc_host_recv_thread(void *data)
 {
 	int ret = 0;
@@ -23,16 +76,75 @@ static int whc_host_recv_thread(void *data)
 		/* wait for sema*/
 		ret = down_interruptible(&recv_priv->rx_sema);
 
+		/* hold off bus rx until NAPI drains, device keeps pkts in its own buffer meanwhile */
+		if (skb_queue_len(&recv_priv->rx_queue) >= WHC_RX_QUEUE_HIGH) {
+			recv_priv->stats.queue_full++;
+			wait_event_interruptible(recv_priv->rx_queue_wq,
+									 (skb_queue_len(&recv_priv->rx_queue) < WHC_RX_QUEUE_LOW) || kthread_should_stop());
+		}
+
 		whc_host_recv_data_process(global_idev.intf_priv);
 	}
 
 	return ret;
 }
 
+static int whc_host_recv_napi_init(struct recv_priv_t *recv_priv)
+{
+#if (KERNEL_VERSION(6, 10, 0) <= LINUX_VERSION_CODE)
+	recv_priv->napi_dev = alloc_netdev_dummy(0);
+#else
+	recv_priv->napi_dev = kzalloc(sizeof(struct net_device), GFP_KERNEL);
+	if (recv_priv->napi_dev) {
+		init_dummy_netdev(recv_priv->napi_dev);
+	}
+#endif
+	if (recv_priv->napi_dev == NULL) {
+		return -ENOMEM;
+	}
+
+	skb_queue_head_init(&recv_priv->rx_queue);
+	init_waitqueue_head(&recv_priv->rx_queue_wq);
+	recv_priv->napi_budget = WHC_RX_NAPI_BUDGET;
+	memset(&recv_priv->stats, 0, sizeof(struct rx_stats_t));
+
+#if (KERNEL_VERSION(5, 19, 0) <= LINUX_VERSION_CODE)
+	netif_napi_add_weight(recv_priv->napi_dev, &recv_priv->napi, whc_host_recv_napi_poll, WHC_RX_NAPI_BUDGET);
+#else
+	netif_napi_add(recv_priv->napi_dev, &recv_priv->napi, whc_host_recv_napi_poll, WHC_RX_NAPI_BUDGET);
+#endif
+	napi_enable(&recv_priv->napi);
+
+	return 0;
+}
+
+static void whc_host_recv_napi_deinit(struct recv_priv_t *recv_priv)
+{
+	if (recv_priv->napi_dev == NULL) {
+		return;
+	}
+
+	napi_disable(&recv_priv->napi);
+	netif_napi_del(&recv_priv->napi);
+	skb_queue_purge(&recv_priv->rx_queue);
+
+#if (KERNEL_VERSION(6, 10, 0) <= LINUX_VERSION_CODE)
+	free_netdev(recv_priv->napi_dev);
+#else
+	kfree(recv_priv->napi_dev);
+#endif
+	recv_priv->napi_dev = NULL;
+}
+
 void whc_host_recv_init(void)
 {
 	struct recv_priv_t *recv_priv = &global_idev.recv_priv;
 
+	if (whc_host_recv_napi_init(recv_priv)) {
+		dev_err(global_idev.fullmac_dev, "FAIL to init rx napi!\n");
+		return;
+	}
+
 	/* Create Rx thread */
 	sema_init(&recv_priv->rx_sema, 0);
 
@@ -51,8 +163,11 @@ void whc_host_recv_deinit(void)
 
 	if (recv_priv->rx_thread) {
 		up(&recv_priv->rx_sema);
+		wake_up(&recv_priv->rx_queue_wq);
 		kthread_stop(recv_priv->rx_thread);
 		recv_priv->rx_thread = NULL;
 	}
+
+	whc_host_recv_napi_deinit(recv_priv);
 }
 
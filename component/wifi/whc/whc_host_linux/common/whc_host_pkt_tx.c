@@ -1,20 +1,40 @@
 #include <whc_host_linux.h>
 
-static int whc_host_enqueue_tx_packet(struct xmit_priv_t *xmit_priv, struct whc_msg_node *p_node)
+static int whc_host_enqueue_tx_packet(struct xmit_priv_t *xmit_priv, struct whc_msg_node *p_node, u16 qidx)
 {
 	/* enqueue msg */
 	spin_lock(&(xmit_priv->lock));
-	list_add_tail(&(p_node->list), &(xmit_priv->queue_head));
+	list_add_tail(&(p_node->list), &(xmit_priv->queue_head[qidx]));
+	atomic_inc(&xmit_priv->ac_msg_num[qidx]);
 	atomic_inc(&xmit_priv->msg_num);
 	spin_unlock(&(xmit_priv->lock));
 
 	return 0;
 }
 
+/* take the first node of the highest priority non-empty queue, caller holds xmit_priv->lock */
+static struct whc_msg_node *__whc_host_dequeue_tx_packet(struct xmit_priv_t *xmit_priv)
+{
+	struct whc_msg_node *p_node;
+	int i;
+
+	/* queue 0 is AC_VO, serve it first */
+	for (i = 0; i < WHC_TX_QUEUE_NUM; i++) {
+		if (list_empty(&(xmit_priv->queue_head[i])) == false) {
+			p_node = list_first_entry(&(xmit_priv->queue_head[i]), struct whc_msg_node, list);
+			list_del(&(p_node->list));
+			atomic_dec(&xmit_priv->ac_msg_num[i]);
+			atomic_dec(&xmit_priv->msg_num);
+			return p_node;
+		}
+	}
+
+	return NULL;
+}
+
 struct whc_msg_node *whc_host_dequeue_tx_packet(struct xmit_priv_t *xmit_priv)
 {
 	struct whc_msg_node *p_node;
-	struct list_head *plist, *phead;
 
 	if (xmit_priv->initialized == 0) {
 		return NULL;
@@ -22,20 +42,30 @@ struct whc_msg_node *whc_host_dequeue_tx_packet(struct xmit_priv_t *xmit_priv)
 
 	/* stop interrupt interrupting this process to cause dead lock. */
 	spin_lock_irq(&(xmit_priv->lock));
+	p_node = __whc_host_dequeue_tx_packet(xmit_priv);
+	spin_unlock_irq(&(xmit_priv->lock));
 
-	if (list_empty(&(xmit_priv->queue_head)) == true) {
-		p_node = NULL;
-	} else {
-		phead = &(xmit_priv->queue_head);
-		plist = phead->next;
-		p_node = list_entry(plist, struct whc_msg_node, list);
-		list_del(&(p_node->list));
-		atomic_dec(&xmit_priv->msg_num);
+	return p_node;
+}
+
+/* move up to max_num pkts onto batch list in priority order, return the number moved */
+static int whc_host_dequeue_tx_batch(struct xmit_priv_t *xmit_priv, struct list_head *batch, int max_num)
+{
+	struct whc_msg_node *p_node;
+	int num = 0;
+
+	if (xmit_priv->initialized == 0) {
+		return 0;
 	}
 
+	spin_lock_irq(&(xmit_priv->lock));
+	while ((num < max_num) && ((p_node = __whc_host_dequeue_tx_packet(xmit_priv)) != NULL)) {
+		list_add_tail(&(p_node->list), batch);
+		num++;
+	}
 	spin_unlock_irq(&(xmit_priv->lock));
 
-	return p_node;
+	return num;
 }
 
 int whc_host_xmit_pending_q_num(void)
@@ -52,40 +82,72 @@ void whc_host_xmit_wakeup_thread(void)
 	up(&xmit_priv->tx_sema);
 }
 
+/* report bytes handed to bus to BQL, and wake this AC on all ports if its queue drained */
+static void whc_host_xmit_done(int idx, u16 qidx, u32 bytes)
+{
+	struct xmit_priv_t *xmit_priv = &global_idev.xmit_priv;
+	int i;
+
+	if (global_idev.pndev[idx]) {
+		netdev_tx_completed_queue(netdev_get_tx_queue(global_idev.pndev[idx], qidx), 1, bytes);
+	}
+
+	/* wake tx queue if need */
+	if (atomic_read(&xmit_priv->ac_msg_num[qidx]) < QUEUE_WAKE_THRES) {
+		for (i = 0; i < WHC_MAX_NET_PORT_NUM; i++) {
+			if (global_idev.pndev[i] && qidx < global_idev.pndev[i]->real_num_tx_queues) {
+				netif_wake_subqueue(global_idev.pndev[i], qidx);
+			}
+		}
+	}
+}
+
+void whc_host_xmit_complete(struct sk_buff *pskb)
+{
+	struct whc_msg_info *msg = (struct whc_msg_info *)(pskb->data + SIZE_TX_DESC);
+
+	whc_host_xmit_done(msg->wlan_idx, skb_get_queue_mapping(pskb), msg->data_len);
+}
+
 int whc_host_xmit_thread(void *data)
 {
 	struct xmit_priv_t *xmit_priv = (struct xmit_priv_t *)data;
-	struct whc_msg_node *p_node = NULL;
+	struct whc_msg_node *p_node = NULL, *p_next;
+	struct whc_msg_info *msg;
 	struct sk_buff *pskb;
+	LIST_HEAD(batch);
 	int ret = 0;
-	int i = 0;
+	int idx;
+	u16 qidx;
+	u32 bytes;
 
 	while (!kthread_should_stop()) {
 
 		/* wait for smea */
 		ret = down_interruptible(&xmit_priv->tx_sema);
 
-		/* dequeue msg node */
-		while ((!global_idev.mlme_priv.b_in_scan) && ((p_node = whc_host_dequeue_tx_packet(xmit_priv)) != NULL)) {
+		/* dequeue a batch of msg nodes under one lock, then send them without holding it */
+		while ((!global_idev.mlme_priv.b_in_scan) && whc_host_dequeue_tx_batch(xmit_priv, &batch, WHC_TX_BATCH_NUM)) {
+			list_for_each_entry_safe(p_node, p_next, &batch, list) {
+				list_del(&(p_node->list));
+				pskb = p_node->msg;
 
-			pskb = p_node->msg;
+				/* skb may be freed by bus once sent, record what tx done needs first */
+				msg = (struct whc_msg_info *)(pskb->data + SIZE_TX_DESC);
+				idx = msg->wlan_idx;
+				bytes = msg->data_len;
+				qidx = skb_get_queue_mapping(pskb);
 
-			/* send to NP*/
-			whc_host_send_data(pskb->data, pskb->len, pskb);
+				/* send to NP*/
+				whc_host_send_data(pskb->data, pskb->len, pskb);
 
-			/* wake tx queue if need */
-			if (whc_host_xmit_pending_q_num() < QUEUE_WAKE_THRES) {
-				for (i = 0; i < WHC_MAX_NET_PORT_NUM; i++) {
-					if (global_idev.pndev[i]) {
-						netif_tx_wake_all_queues(global_idev.pndev[i]);
-					}
-				}
-			}
+				whc_host_xmit_done(idx, qidx, bytes);
 #ifndef CONFIG_INIC_USB_ASYNC_SEND
-			/* release the memory for this message. */
-			dev_kfree_skb(pskb);
+				/* release the memory for this message. */
+				dev_kfree_skb(pskb);
 #endif
-			kfree(p_node);
+				kfree(p_node);
+			}
 		}
 	}
 
@@ -101,6 +163,7 @@ int whc_host_xmit_entry(int idx, struct sk_buff *pskb)
 	struct net_device_stats *pstats = &global_idev.stats[idx];
 	struct net_device *pndev = global_idev.pndev[idx];
 	struct whc_msg_node *p_node = NULL;
+	u16 qidx = skb_get_queue_mapping(pskb);
 	u32 need_headroom, pad_len;
 
 	if (!global_idev.host_init_done) {
@@ -108,9 +171,10 @@ int whc_host_xmit_entry(int idx, struct sk_buff *pskb)
 		return -1;
 	}
 
-	if (whc_host_xmit_pending_q_num() >= QUEUE_STOP_THRES) {
-		netif_tx_stop_all_queues(pndev);
-		if (whc_host_xmit_pending_q_num() >= PKT_DROP_THRES) {
+	/* flow control per AC, so that a full BE queue does not hold back VO/VI */
+	if (atomic_read(&xmit_priv->ac_msg_num[qidx]) >= QUEUE_STOP_THRES) {
+		netif_stop_subqueue(pndev, qidx);
+		if (atomic_read(&xmit_priv->ac_msg_num[qidx]) >= PKT_DROP_THRES) {
 			dev_warn(global_idev.fullmac_dev, "buffered too much pkts, drop!\n");
 			b_dropped = true;
 			goto exit;
@@ -141,10 +205,17 @@ int whc_host_xmit_entry(int idx, struct sk_buff *pskb)
 	msg->pad_len = pad_len;
 
 	/* enqueue pkt */
-	p_node = kzalloc(sizeof(struct whc_msg_node), GFP_KERNEL);
-	p_node ->msg = pskb;
+	p_node = kzalloc(sizeof(struct whc_msg_node), GFP_ATOMIC);
+	if (p_node == NULL) {
+		/* netdev will requeue this skb, give back the headroom */
+		skb_pull(pskb, need_headroom);
+		b_dropped = true;
+		goto exit;
+	}
+	p_node->msg = pskb;
 
-	whc_host_enqueue_tx_packet(xmit_priv, p_node);
+	netdev_tx_sent_queue(netdev_get_tx_queue(pndev, qidx), msg->data_len);
+	whc_host_enqueue_tx_packet(xmit_priv, p_node, qidx);
 
 	/* up sema to notify xmit thread */
 	up(&xmit_priv->tx_sema);
@@ -166,11 +237,15 @@ exit:
 int whc_host_xmit_init(void)
 {
 	struct xmit_priv_t *xmit_priv = &global_idev.xmit_priv;
+	int i;
 
 	sema_init(&xmit_priv->tx_sema, 0);
 	spin_lock_init(&xmit_priv->lock);
 
-	INIT_LIST_HEAD(&xmit_priv->queue_head);
+	for (i = 0; i < WHC_TX_QUEUE_NUM; i++) {
+		INIT_LIST_HEAD(&xmit_priv->queue_head[i]);
+		atomic_set(&xmit_priv->ac_msg_num[i], 0);
+	}
 	atomic_set(&xmit_priv->msg_num, 0);
 
 	xmit_priv->tx_thread = kthread_run(whc_host_xmit_thread, xmit_priv, "RTW_TX_THREAD");
@@ -189,6 +264,7 @@ int whc_host_xmit_deinit(void)
 {
 	struct xmit_priv_t *xmit_priv = &global_idev.xmit_priv;
 	struct whc_msg_node *p_node = NULL;
+	int i, j;
 
 	/* stop xmit_buf_thread */
 	if (xmit_priv->tx_thread) {
@@ -200,8 +276,17 @@ int whc_host_xmit_deinit(void)
 	/* de initialize queue */
 	while ((p_node = whc_host_dequeue_tx_packet(xmit_priv)) != NULL) {
 		/* release the memory */
+		dev_kfree_skb(p_node->msg);
 		kfree(p_node);
-		kfree(p_node->msg);
+	}
+
+	/* dropped pkts never reach tx done, restart BQL accounting */
+	for (i = 0; i < WHC_MAX_NET_PORT_NUM; i++) {
+		if (global_idev.pndev[i]) {
+			for (j = 0; j < WHC_TX_QUEUE_NUM; j++) {
+				netdev_tx_reset_queue(netdev_get_tx_queue(global_idev.pndev[i], j));
+			}
+		}
 	}
 
 	return 0;
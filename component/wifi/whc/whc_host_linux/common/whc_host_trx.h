@@ -31,6 +31,17 @@
 #define QUEUE_STOP_THRES	7
 #define QUEUE_WAKE_THRES	4
 
+/* netdev tx queues, one per WMM AC, see rtw_ndev_select_queue */
+#define WHC_TX_QUEUE_NUM	4
+/* max pkts moved from tx queues to bus under one lock by xmit thread */
+#define WHC_TX_BATCH_NUM	8
+
+/* default rx pkts handed to stack per NAPI poll, can be lowered by proc rx_napi_budget */
+#define WHC_RX_NAPI_BUDGET	NAPI_POLL_WEIGHT
+/* rx thread stops reading bus when this many pkts wait for NAPI, resumes below low */
+#define WHC_RX_QUEUE_HIGH	256
+#define WHC_RX_QUEUE_LOW	64
+
 #ifndef CONFIG_FULLMAC_HCI_IPC
 /* internal pkt tx: from user space to dev by cmd path */
 void whc_host_send_cmd_data(u8 *buf, u32 len);
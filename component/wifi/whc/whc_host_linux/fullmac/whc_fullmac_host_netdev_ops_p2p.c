@@ -95,7 +95,7 @@ int whc_fullmac_host_ndev_p2p_register(enum nl80211_iftype type, const char *nam
 	u8 dev_addr[ETH_ALEN] = {0};
 
 	/*step1: alloc netdev*/
-	ndev = alloc_etherdev_mq(sizeof(struct netdev_priv_t), 1);
+	ndev = alloc_etherdev_mq(sizeof(struct netdev_priv_t), WHC_TX_QUEUE_NUM);
 	if (!ndev) {
 		goto dev_fail;
 	}
@@ -42,7 +42,6 @@ static int whc_fullmac_host_add_key_ops(struct wiphy *wiphy, struct net_device *
 {
 	struct rtw_crypt_info *crypt;
 	int ret = 0;
-	struct xmit_priv_t *xmit_priv = &global_idev.xmit_priv;
 	u8 is_mp = 0;
 	u8 wlan_idx;
 	struct rtw_wpa_4way_status	rpt_4way = {0};
@@ -102,7 +101,7 @@ static int whc_fullmac_host_add_key_ops(struct wiphy *wiphy, struct net_device *
 #ifndef CONFIG_FULLMAC_HCI_IPC
 	if (pairwise) {	/*https://jira.realtek.com/browse/RSWLANDIOT-9403*/
 		while (1) {
-			if (list_empty(&(xmit_priv->queue_head)) == true) {
+			if (whc_host_xmit_pending_q_num() == 0) {
 				break;
 			}
 			msleep(1);
@@ -35,12 +35,11 @@ static void whc_host_recv_pkts(struct sk_buff *pskb)
 	pskb->protocol = eth_type_trans(pskb, global_idev.pndev[wlan_idx]);
 	pskb->ip_summed = CHECKSUM_NONE;
 
-	if (netif_rx(pskb) == NET_RX_SUCCESS) {
-		pstats->rx_packets++;
-		pstats->rx_bytes += pskb->len;
-	} else {
-		pstats->rx_dropped++;
-	}
+	pstats->rx_packets++;
+	pstats->rx_bytes += pskb->len;
+
+	/* hand to stack in NAPI context, so GRO can merge the pkts of one poll */
+	whc_host_recv_napi_enqueue(pskb);
 
 	return;
 }
@@ -205,6 +205,49 @@ static int proc_read_mp_fw(struct seq_file *m, void *v)
 
 	return ret;
 }
+
+#ifndef CONFIG_FULLMAC_HCI_IPC
+static int proc_read_rx_stats(struct seq_file *m, void *v)
+{
+	struct recv_priv_t *recv_priv = &global_idev.recv_priv;
+
+	seq_printf(m, "rx_pkts: %llu\n", recv_priv->stats.rx_pkts);
+	seq_printf(m, "napi_polls: %u\n", recv_priv->stats.napi_polls);
+	seq_printf(m, "budget_exhausted: %u\n", recv_priv->stats.budget_exhausted);
+	seq_printf(m, "queue_full: %u\n", recv_priv->stats.queue_full);
+	seq_printf(m, "queue_len: %u\n", skb_queue_len(&recv_priv->rx_queue));
+	seq_printf(m, "max_queue_len: %u\n", recv_priv->stats.max_queue_len);
+
+	return 0;
+}
+
+static int proc_read_rx_napi_budget(struct seq_file *m, void *v)
+{
+	seq_printf(m, "%d\n", global_idev.recv_priv.napi_budget);
+
+	return 0;
+}
+
+static ssize_t proc_write_rx_napi_budget(struct file *file, const char __user *buffer, size_t count, loff_t *pos, void *data)
+{
+	char tmp[32] = {0};
+	int budget;
+
+	if (count >= sizeof(tmp)) {
+		return -EFAULT;
+	}
+
+	if (buffer && !copy_from_user(tmp, buffer, count)) {
+		if ((sscanf(tmp, "%d", &budget) != 1) || (budget < 1) || (budget > WHC_RX_NAPI_BUDGET)) {
+			dev_err(global_idev.fullmac_dev, "rx napi budget range is [1, %d]!", WHC_RX_NAPI_BUDGET);
+			return -EINVAL;
+		}
+		global_idev.recv_priv.napi_budget = budget;
+	}
+
+	return count;
+}
+#endif
 /*
 * rtw_ndev_ap_proc
 */
@@ -382,6 +425,10 @@ const struct rtw_proc_hdl ndev_sta_proc_hdls[] = {
 	RTW_PROC_HDL_SSEQ("antdiv_mode", proc_read_antdiv_mode, NULL),
 	RTW_PROC_HDL_SSEQ("current_ant", proc_read_curr_ant, NULL),
 	RTW_PROC_HDL_SSEQ("mp_fw", proc_read_mp_fw, NULL),
+#ifndef CONFIG_FULLMAC_HCI_IPC
+	RTW_PROC_HDL_SSEQ("rx_stats", proc_read_rx_stats, NULL),
+	RTW_PROC_HDL_SSEQ("rx_napi_budget", proc_read_rx_napi_budget, proc_write_rx_napi_budget),
+#endif
 
 #if defined(CONFIG_WHC_WIFI_API_PATH)
 #ifdef CONFIG_FULLMAC_HCI_SDIO
@@ -2,6 +2,14 @@
 
 struct whc_spi_host_priv_t spi_host_priv = {0};
 
+/* one transfer is in flight at a time, so a few descriptors cover all senders */
+static struct whc_txbuf_info_t spi_tx_desc_pool[WHC_SPI_TX_DESC_NUM];
+static u32 spi_tx_desc_used;
+
+/* rx dma writes to one buffer while the previous msg is processed in the other */
+static u8 spi_rx_buf_pool[WHC_SPI_RX_BUF_NUM][SPI_BUFSZ] ALIGNMTO(CACHE_LINE_SIZE);
+static u8 spi_rx_buf_idx;
+
 extern struct event_priv_t event_priv;
 int whc_host_init_done;
 
@@ -92,6 +100,53 @@ bool whc_spi_host_rxgdma_init(
 	return TRUE;
 }
 
+/**
+ * @brief  get a tx descriptor, from pool if any is free, or else from heap.
+ * @param  none.
+ * @return zeroed descriptor, NULL if no memory.
+ */
+struct whc_txbuf_info_t *whc_spi_host_txdesc_alloc(void)
+{
+	struct whc_txbuf_info_t *inic_tx = NULL;
+	u32 i;
+
+	rtos_critical_enter(RTOS_CRITICAL_WIFI);
+	for (i = 0; i < WHC_SPI_TX_DESC_NUM; i++) {
+		if ((spi_tx_desc_used & BIT(i)) == 0) {
+			spi_tx_desc_used |= BIT(i);
+			inic_tx = &spi_tx_desc_pool[i];
+			break;
+		}
+	}
+	rtos_critical_exit(RTOS_CRITICAL_WIFI);
+
+	if (inic_tx) {
+		memset(inic_tx, 0, sizeof(struct whc_txbuf_info_t));
+	} else {
+		inic_tx = (struct whc_txbuf_info_t *)rtos_mem_zmalloc(sizeof(struct whc_txbuf_info_t));
+	}
+
+	return inic_tx;
+}
+
+void whc_spi_host_txdesc_free(struct whc_txbuf_info_t *inic_tx)
+{
+	if ((inic_tx >= &spi_tx_desc_pool[0]) && (inic_tx < &spi_tx_desc_pool[WHC_SPI_TX_DESC_NUM])) {
+		rtos_critical_enter(RTOS_CRITICAL_WIFI);
+		spi_tx_desc_used &= ~BIT(inic_tx - spi_tx_desc_pool);
+		rtos_critical_exit(RTOS_CRITICAL_WIFI);
+	} else {
+		rtos_mem_free((u8 *)inic_tx);
+	}
+}
+
+static u8 *whc_spi_host_rx_buf_next(void)
+{
+	spi_rx_buf_idx = (spi_rx_buf_idx + 1) % WHC_SPI_RX_BUF_NUM;
+
+	return spi_rx_buf_pool[spi_rx_buf_idx];
+}
+
 void whc_spi_host_rx_handler(u8 *buf)
 {
 	struct whc_msg_info *msg_info = (struct whc_msg_info *)buf;
@@ -141,8 +196,8 @@ int whc_spi_host_recv_process(void)
 	int counter = 0;
 #endif
 
-	/* disable gdma channel */
-	spi_host_priv.rx_buf = rtos_mem_zmalloc(SPI_BUFSZ);
+	/* restart rx dma on the other pool buffer, recv_msg stays valid until next rx done */
+	spi_host_priv.rx_buf = whc_spi_host_rx_buf_next();
 	DCache_CleanInvalidate((u32)spi_host_priv.rx_buf, SPI_BUFSZ);
 	GDMA_SetDstAddr(GDMA_InitStruct->GDMA_Index, GDMA_InitStruct->GDMA_ChNum, (u32)spi_host_priv.rx_buf);
 	GDMA_Cmd(GDMA_InitStruct->GDMA_Index, GDMA_InitStruct->GDMA_ChNum, ENABLE);
@@ -190,7 +245,7 @@ int whc_spi_host_recv_process(void)
 		}
 		break;
 	case WHC_CUST_EVT:
-		whc_host_recv_cust_evt(spi_host_priv.rx_buf + SIZE_RX_DESC);
+		whc_host_recv_cust_evt(recv_msg + SIZE_RX_DESC);
 		break;
 #endif
 
@@ -212,7 +267,6 @@ int whc_spi_host_recv_process(void)
 		break;
 	}
 
-	rtos_mem_free(recv_msg);
 	return ret;
 }
 
@@ -450,7 +504,7 @@ void whc_spi_host_dma_tx_done_cb(void)
 	} else {
 		rtos_mem_free((u8 *)inic_tx->ptr);
 	}
-	rtos_mem_free((u8 *)inic_tx);
+	whc_spi_host_txdesc_free(inic_tx);
 
 	spi_host_priv.txbuf_info = NULL;
 }
@@ -507,7 +561,8 @@ static void whc_spi_host_spi_init(void)
 	SSI_InitStructMaster.SPI_ClockDivider = SPI_CLOCK_DIVIDER;
 	SSI_Init(WHC_SPI_DEV, &SSI_InitStructMaster);
 
-	spi_host_priv.rx_buf = rtos_mem_zmalloc(SPI_BUFSZ);
+	spi_rx_buf_idx = 0;
+	spi_host_priv.rx_buf = spi_rx_buf_pool[0];
 	DCache_CleanInvalidate((u32)spi_host_priv.rx_buf, SPI_BUFSZ);
 	whc_spi_host_rxgdma_init(index, &(spi_host_priv.SSIRxGdmaInitStruct), (void *)WHC_SPI_RXDMA, (IRQ_FUN) whc_spi_host_rxdma_irq_handler, spi_host_priv.rx_buf,
 							 SPI_BUFSZ);
@@ -633,7 +688,12 @@ void whc_spi_host_send_to_dev_internal(u8 *buf, u8 *buf_alloc, u16 len)
 	struct whc_txbuf_info_t *inic_tx;
 
 	/* construct struct whc_buf_info & whc_buf_info_t */
-	inic_tx = (struct whc_txbuf_info_t *)rtos_mem_zmalloc(sizeof(struct whc_txbuf_info_t));
+	inic_tx = whc_spi_host_txdesc_alloc();
+	if (inic_tx == NULL) {
+		RTK_LOGE(TAG_WLAN_INIC, "%s mem fail \r\n", __func__);
+		rtos_mem_free(buf_alloc);
+		return;
+	}
 
 	inic_tx->txbuf_info.buf_allocated = inic_tx->txbuf_info.buf_addr = (u32)buf;
 	inic_tx->txbuf_info.size_allocated = inic_tx->txbuf_info.buf_size = len;
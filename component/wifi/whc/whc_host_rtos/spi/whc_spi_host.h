@@ -98,6 +98,10 @@ enum whc_spi_dma_type {
 #define SPI_BUFSZ		(SPI_DMA_ALIGN(MAXIMUM_ETHERNET_PACKET_SIZE + sizeof(struct whc_msg_info)))
 #define SPI_SKB_RSVD_LEN	N_BYTE_ALIGMENT(SKB_WLAN_TX_EXTRA_LEN - sizeof(struct whc_msg_info), 4)
 
+/* tx descriptors and rx dma buffers are taken from these pools instead of heap per transfer */
+#define WHC_SPI_TX_DESC_NUM		4
+#define WHC_SPI_RX_BUF_NUM		2
+
 #define WIFI_STACK_SIZE_INIC_RX_REQ_TASK		    (268 + 128 + CONTEXT_SAVE_SIZE)
 #define WIFI_STACK_WHC_SPI_HOST_RXDMA_IRQ_TASK		4096 //TODO
 #define WIFI_STACK_WHC_SPI_HOST_TXDMA_IRQ_TASK		(168 + 128 + CONTEXT_SAVE_SIZE)
@@ -107,6 +111,8 @@ static inline void set_host_rdy_pin(u8 status)
 	GPIO_WriteBit(HOST_READY_PIN, status);
 }
 
+struct whc_txbuf_info_t *whc_spi_host_txdesc_alloc(void);
+void whc_spi_host_txdesc_free(struct whc_txbuf_info_t *inic_tx);
 void whc_spi_host_send_data(struct whc_buf_info *pbuf);
 void whc_spi_host_send_to_dev_internal(u8 *buf, u8 *buf_alloc, u16 len);
 void whc_spi_host_init(void);
@@ -48,9 +48,8 @@ void whc_host_deinit_skb(void)
 		rtos_mem_free((void *)spi_host_priv.dummy_tx_buf);
 	}
 
-	if (spi_host_priv.rx_buf) {
-		rtos_mem_free((void *)spi_host_priv.rx_buf);
-	}
+	/* rx_buf points into the static rx buffer pool, nothing to free */
+	spi_host_priv.rx_buf = NULL;
 	return;
 }
 
@@ -67,27 +66,37 @@ int whc_spi_host_send(int idx, struct eth_drv_sg *sg_list, int sg_len,
 	int ret = RTK_SUCCESS, i = 0;
 	int pad_len = 0;
 	struct whc_msg_info *msg;
-	struct whc_txbuf_info_t *inic_tx = rtos_mem_zmalloc(sizeof(struct whc_txbuf_info_t));
+	struct whc_txbuf_info_t *inic_tx;
+	u8 *ptr;
 
 	if (!whc_host_init_done) {
 		RTK_LOGS(TAG_WLAN_INIC, RTK_LOG_ERROR, "Host trx err: wifi not init\n");
 		return -RTK_ERR_WIFI_NOT_INIT;
 	}
 
-	rtos_mutex_take(spi_host_priv.host_send, 0xFFFFFFFF);
+	if (total_len > MAXIMUM_ETHERNET_PACKET_SIZE) {
+		RTK_LOGE(TAG_WLAN_INIC, "%s: len(%d) > MAXIMUM_ETHERNET_PACKET_SIZE !\n\r", __func__, total_len);
+		return -RTK_ERR_BUFFER_OVERFLOW;
+	}
+
+	rtos_sema_take(spi_host_priv.host_send, 0xFFFFFFFF);
 
-	u8 *ptr = &(tx_buf[used_buf_num][0]);
+	ptr = &(tx_buf[used_buf_num][0]);
 
 	if (*ptr != 0) {
 		RTK_LOGE(TAG_WLAN_INIC, "%s fail buf busy !\n\r", __func__);
-		return -RTK_ERR_WIFI_TX_BUF_FULL;
+		ret = -RTK_ERR_WIFI_TX_BUF_FULL;
+		goto exit;
 	}
 
-	if (total_len > MAXIMUM_ETHERNET_PACKET_SIZE) {
-		RTK_LOGE(TAG_WLAN_INIC, "%s: len(%d) > MAXIMUM_ETHERNET_PACKET_SIZE !\n\r", __func__, total_len);
-		return -RTK_ERR_BUFFER_OVERFLOW;
+	inic_tx = whc_spi_host_txdesc_alloc();
+	if (inic_tx == NULL) {
+		ret = -RTK_ERR_NOMEM;
+		goto exit;
 	}
 
+	/* first byte marks the buf busy until tx dma done */
+	*ptr = 1;
 	ptr += 4;
 	pad_len = ((u32)ptr - sizeof(struct whc_msg_info)) % DEV_DMA_ALIGN;
 	msg = (struct whc_msg_info *)(ptr);
@@ -115,9 +124,9 @@ int whc_spi_host_send(int idx, struct eth_drv_sg *sg_list, int sg_len,
 	whc_spi_host_send_data(&inic_tx->txbuf_info);
 
 	used_buf_num = (used_buf_num + 1) % fix_tx_buf_num;
+exit:
 	rtos_sema_give(spi_host_priv.host_send);
 
-	//rtos_mem_free(inic_tx);
 	return ret;
 }
 
@@ -135,13 +144,13 @@ void whc_spi_host_send_to_dev(u8 *buf, u32 len)
 	struct whc_txbuf_info_t *inic_tx;
 
 	/* construct struct whc_buf_info & whc_buf_info_t */
-	inic_tx = (struct whc_txbuf_info_t *)rtos_mem_zmalloc(sizeof(struct whc_txbuf_info_t));
+	inic_tx = whc_spi_host_txdesc_alloc();
 	txbuf = rtos_mem_zmalloc(txsize);
 
 	if ((txbuf == NULL) || (inic_tx == NULL)) {
 		RTK_LOGE(TAG_WLAN_INIC, "%s mem fail \r\n", __func__);
 		if (inic_tx) {
-			rtos_mem_free(inic_tx);
+			whc_spi_host_txdesc_free(inic_tx);
 		}
 
 		if (txbuf) {